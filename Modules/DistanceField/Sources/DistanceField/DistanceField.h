@@ -0,0 +1,27 @@
+#pragma once
+
+#include <Base/BaseTypes.h>
+
+namespace DistanceField
+{
+/**
+    Maps signed distance in input texels (positive inside the glyph) to alpha.
+    Distances beyond `scaledSpread` are clamped to 0 or 255.
+*/
+DAVA::uint8 DistanceToAlpha(DAVA::float32 distance, DAVA::int32 scaledSpread);
+
+/**
+    Reference algorithm: for every output pixel scans (2 * spread * scale)^2 window of the input
+    looking for the nearest texel of opposite value. Input texel is inside if it is not zero.
+    Output has (inWidth / scale) x (inHeight / scale) pixels.
+*/
+void BuildBruteForce(const DAVA::uint8* inputBuf, DAVA::int32 inWidth, DAVA::int32 inHeight, DAVA::int32 scale, DAVA::int32 spread, DAVA::Vector<DAVA::uint8>& outBuf);
+
+/**
+    Exact Euclidean distance transform (Felzenszwalb and Huttenlocher), linear in the number of input texels.
+    Input is glyph coverage, texels covered by at least a half are inside. Distance to the nearest texel of opposite
+    class is corrected by that texel's coverage, which gives sub-texel edge position for anti-aliased input.
+    Output has (inWidth / scale) x (inHeight / scale) pixels.
+*/
+void BuildEdt(const DAVA::uint8* inputBuf, DAVA::int32 inWidth, DAVA::int32 inHeight, DAVA::int32 scale, DAVA::int32 spread, DAVA::Vector<DAVA::uint8>& outBuf);
+}
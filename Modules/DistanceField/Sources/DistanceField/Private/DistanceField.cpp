@@ -0,0 +1,225 @@
+#include "DistanceField/DistanceField.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+using namespace DAVA;
+
+namespace DistanceFieldDetails
+{
+static const float32 INF = 1e20f;
+static const uint8 INSIDE_THRESHOLD = 128;
+
+// 1D squared distance transform of sampled function `f` with index of the nearest sample.
+// Lower envelope of parabolas rooted at finite samples is built in the first pass and sampled in the second one.
+// `v` must hold `n` elements and `z` must hold `n + 1` elements.
+void Transform1D(const float32* f, int32 n, float32* d, int32* nearest, int32* v, float32* z)
+{
+    int32 k = -1;
+    for (int32 q = 0; q < n; ++q)
+    {
+        if (f[q] >= INF)
+        {
+            continue;
+        }
+
+        if (k < 0)
+        {
+            k = 0;
+            v[0] = q;
+            z[0] = -INF;
+            z[1] = INF;
+            continue;
+        }
+
+        float32 s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+        while (s <= z[k])
+        {
+            --k;
+            s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+        }
+
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = INF;
+    }
+
+    if (k < 0)
+    {
+        fill(d, d + n, INF);
+        fill(nearest, nearest + n, -1);
+        return;
+    }
+
+    k = 0;
+    for (int32 q = 0; q < n; ++q)
+    {
+        while (z[k + 1] < q)
+        {
+            ++k;
+        }
+
+        int32 dq = q - v[k];
+        d[q] = static_cast<float32>(dq * dq) + f[v[k]];
+        nearest[q] = v[k];
+    }
+}
+
+// 1D squared distance to the nearest feature texel of binary row. Forward sweep finds the nearest feature on the left,
+// backward sweep the nearest one on the right, which is cheaper than the general transform for the first pass.
+void TransformBinary1D(const uint8* row, int32 n, bool featureIsInside, float32* d, int32* nearest)
+{
+    int32 last = -1;
+    for (int32 q = 0; q < n; ++q)
+    {
+        if ((row[q] >= INSIDE_THRESHOLD) == featureIsInside)
+        {
+            last = q;
+        }
+        nearest[q] = last;
+    }
+
+    last = -1;
+    for (int32 q = n - 1; q >= 0; --q)
+    {
+        if ((row[q] >= INSIDE_THRESHOLD) == featureIsInside)
+        {
+            last = q;
+        }
+        if (last >= 0 && (nearest[q] < 0 || last - q < q - nearest[q]))
+        {
+            nearest[q] = last;
+        }
+
+        int32 dq = q - nearest[q];
+        d[q] = (nearest[q] < 0) ? INF : static_cast<float32>(dq * dq);
+    }
+}
+}
+
+namespace DistanceField
+{
+uint8 DistanceToAlpha(float32 distance, int32 scaledSpread)
+{
+    auto alpha = 0.5f + 0.5f * (distance / scaledSpread);
+    alpha = min(1.f, max(0.f, alpha));
+    return static_cast<uint8>(alpha * 0xff);
+}
+
+void BuildBruteForce(const uint8* inputBuf, int32 inWidth, int32 inHeight, int32 scale, int32 spread, Vector<uint8>& outBuf)
+{
+    auto outWidth = inWidth / scale;
+    auto outHeight = inHeight / scale;
+    auto scaledSpread = spread * scale;
+
+    outBuf.resize(outWidth * outHeight);
+
+    for (auto y = 0; y < outHeight; ++y)
+    {
+        for (auto x = 0; x < outWidth; ++x)
+        {
+            auto centerX = x * scale + scale / 2;
+            auto centerY = y * scale + scale / 2;
+            auto baseVal = inputBuf[centerY * inWidth + centerX] != 0;
+
+            auto startX = max(0, centerX - scaledSpread);
+            auto endX = min(inWidth - 1, centerX + scaledSpread);
+            auto startY = max(0, centerY - scaledSpread);
+            auto endY = min(inHeight - 1, centerY + scaledSpread);
+
+            auto minSquareDist = scaledSpread * scaledSpread;
+
+            for (auto j = startY; j <= endY; ++j)
+            {
+                for (auto i = startX; i <= endX; ++i)
+                {
+                    auto curVal = inputBuf[j * inWidth + i] != 0;
+                    if (baseVal != curVal)
+                    {
+                        auto dx = centerX - i;
+                        auto dy = centerY - j;
+                        minSquareDist = min(minSquareDist, dx * dx + dy * dy);
+                    }
+                }
+            }
+
+            auto minDist = min(sqrtf(static_cast<float32>(minSquareDist)), static_cast<float32>(scaledSpread));
+            outBuf[y * outWidth + x] = DistanceToAlpha(baseVal ? minDist : -minDist, scaledSpread);
+        }
+    }
+}
+
+void BuildEdt(const uint8* inputBuf, int32 inWidth, int32 inHeight, int32 scale, int32 spread, Vector<uint8>& outBuf)
+{
+    using namespace DistanceFieldDetails;
+
+    auto outWidth = inWidth / scale;
+    auto outHeight = inHeight / scale;
+    auto scaledSpread = spread * scale;
+
+    outBuf.resize(outWidth * outHeight);
+    if (outBuf.empty())
+    {
+        return;
+    }
+
+    auto maxSize = max(inWidth, inHeight);
+    Vector<float32> f(maxSize);
+    Vector<int32> v(maxSize);
+    Vector<float32> z(maxSize + 1);
+
+    // Index 0 - distances to inside texels, index 1 - distances to outside texels.
+    // Row pass scans the whole input with contiguous access, but keeps results only for columns which contain output samples.
+    // Column pass is done for these columns only.
+    Vector<float32> sampleRowDist[2] = { Vector<float32>(outWidth * inHeight), Vector<float32>(outWidth * inHeight) };
+    Vector<int32> sampleRowNearest[2] = { Vector<int32>(outWidth * inHeight), Vector<int32>(outWidth * inHeight) };
+    for (auto cls = 0; cls < 2; ++cls)
+    {
+        auto featureIsInside = (cls == 0);
+        for (auto y = 0; y < inHeight; ++y)
+        {
+            TransformBinary1D(inputBuf + y * inWidth, inWidth, featureIsInside, f.data(), v.data());
+            for (auto x = 0; x < outWidth; ++x)
+            {
+                auto centerX = x * scale + scale / 2;
+                sampleRowDist[cls][x * inHeight + y] = f[centerX];
+                sampleRowNearest[cls][x * inHeight + y] = v[centerX];
+            }
+        }
+    }
+
+    Vector<float32> columnDist[2] = { Vector<float32>(inHeight), Vector<float32>(inHeight) };
+    Vector<int32> columnNearest[2] = { Vector<int32>(inHeight), Vector<int32>(inHeight) };
+    for (auto x = 0; x < outWidth; ++x)
+    {
+        auto centerX = x * scale + scale / 2;
+        for (auto cls = 0; cls < 2; ++cls)
+        {
+            Transform1D(&sampleRowDist[cls][x * inHeight], inHeight, columnDist[cls].data(), columnNearest[cls].data(), v.data(), z.data());
+        }
+
+        for (auto y = 0; y < outHeight; ++y)
+        {
+            auto centerY = y * scale + scale / 2;
+            auto isInside = inputBuf[centerY * inWidth + centerX] >= INSIDE_THRESHOLD;
+            auto cls = isInside ? 1 : 0;
+
+            auto distance = static_cast<float32>(scaledSpread);
+            auto squareDist = columnDist[cls][centerY];
+            if (squareDist < INF)
+            {
+                // Edge crosses the nearest opposite texel: the more it is covered, the closer the edge is to its center
+                auto nearestY = columnNearest[cls][centerY];
+                auto nearestX = sampleRowNearest[cls][x * inHeight + nearestY];
+                auto coverage = inputBuf[nearestY * inWidth + nearestX] / 255.f;
+                auto edgeOffset = isInside ? coverage - 0.5f : 0.5f - coverage;
+                distance = min(distance, max(0.f, sqrtf(squareDist) + edgeOffset));
+            }
+
+            outBuf[y * outWidth + x] = DistanceToAlpha(isInside ? distance : -distance, scaledSpread);
+        }
+    }
+}
+}
@@ -0,0 +1,175 @@
+#include "DistanceField/DistanceField.h"
+
+#include "Functional/Function.h"
+#include "Logger/Logger.h"
+#include "Time/SystemTimer.h"
+#include "UnitTests/UnitTests.h"
+
+#include <cmath>
+
+using namespace DAVA;
+
+namespace DistanceFieldTestDetails
+{
+// FontGenerator defaults
+const int32 SCALE = 16;
+const int32 SPREAD = 2;
+const int32 GLYPH_SIZE = 32;
+
+using Shape = Function<bool(float32, float32)>;
+
+// Ring, vertical bar and slanted stroke inside of size x size square: round, straight and diagonal edges of typical glyph
+Vector<Shape> CreateShapes(int32 size)
+{
+    float32 center = size * 0.5f;
+    return {
+        [=](float32 x, float32 y) {
+            float32 r = std::sqrt((x - center) * (x - center) + (y - center) * (y - center));
+            return r < size * 0.4f && r > size * 0.25f;
+        },
+        [=](float32 x, float32 y) {
+            return x > size * 0.2f && x < size * 0.45f && y > size * 0.1f && y < size * 0.9f;
+        },
+        [=](float32 x, float32 y) {
+            return std::abs((x - center) - (y - center) * 0.4f) < size * 0.08f && y > size * 0.1f && y < size * 0.9f;
+        }
+    };
+}
+
+// Coverage of every texel, with 4x4 supersampling if `antialiased`, like FreeType renders glyphs
+Vector<uint8> Rasterize(const Shape& shape, int32 size, bool antialiased)
+{
+    const int32 samples = antialiased ? 4 : 1;
+    Vector<uint8> buf(size * size);
+    for (int32 y = 0; y < size; ++y)
+    {
+        for (int32 x = 0; x < size; ++x)
+        {
+            int32 covered = 0;
+            for (int32 j = 0; j < samples; ++j)
+            {
+                for (int32 i = 0; i < samples; ++i)
+                {
+                    covered += shape(x + (i + 0.5f) / samples, y + (j + 0.5f) / samples) ? 1 : 0;
+                }
+            }
+            buf[y * size + x] = static_cast<uint8>(covered * 255 / (samples * samples));
+        }
+    }
+    return buf;
+}
+
+void CompareWithBruteForce(const Shape& shape, int32 size, bool antialiased, int32& maxDifference, float32& meanDifference)
+{
+    // Reference is built from monochrome glyph, as FontGenerator does with `verify` parameter
+    Vector<uint8> monochrome = Rasterize(shape, size, false);
+    Vector<uint8> input = antialiased ? Rasterize(shape, size, true) : monochrome;
+
+    Vector<uint8> reference;
+    Vector<uint8> result;
+    DistanceField::BuildBruteForce(monochrome.data(), size, size, SCALE, SPREAD, reference);
+    DistanceField::BuildEdt(input.data(), size, size, SCALE, SPREAD, result);
+
+    maxDifference = 0;
+    int64 differenceSum = 0;
+    for (size_t i = 0; i < reference.size(); ++i)
+    {
+        int32 diff = std::abs(static_cast<int32>(reference[i]) - static_cast<int32>(result[i]));
+        maxDifference = std::max(maxDifference, diff);
+        differenceSum += diff;
+    }
+    meanDifference = static_cast<float32>(differenceSum) / reference.size();
+}
+}
+
+DAVA_TESTCLASS (DistanceFieldTest)
+{
+    DAVA_TEST (MonochromeGlyphsTest)
+    {
+        using namespace DistanceFieldTestDetails;
+
+        // Edt measures distance to the edge between texels, brute force - to the center of the nearest opposite texel,
+        // so results differ by up to a half of input texel
+        const int32 size = GLYPH_SIZE * SCALE;
+        for (const Shape& shape : CreateShapes(size))
+        {
+            int32 maxDifference = 0;
+            float32 meanDifference = 0.0f;
+            CompareWithBruteForce(shape, size, false, maxDifference, meanDifference);
+            TEST_VERIFY(maxDifference <= 4);
+            TEST_VERIFY(meanDifference < 2.0f);
+        }
+    }
+
+    DAVA_TEST (AntialiasedGlyphsTest)
+    {
+        using namespace DistanceFieldTestDetails;
+
+        const int32 size = GLYPH_SIZE * SCALE;
+        for (const Shape& shape : CreateShapes(size))
+        {
+            int32 maxDifference = 0;
+            float32 meanDifference = 0.0f;
+            CompareWithBruteForce(shape, size, true, maxDifference, meanDifference);
+            TEST_VERIFY(maxDifference <= 8);
+            TEST_VERIFY(meanDifference < 1.0f);
+        }
+    }
+
+    DAVA_TEST (DegenerateInputTest)
+    {
+        using namespace DistanceFieldTestDetails;
+
+        const int32 size = 4 * SCALE;
+        Vector<uint8> empty(size * size, 0);
+        Vector<uint8> full(size * size, 255);
+        Vector<uint8> result;
+
+        DistanceField::BuildEdt(empty.data(), size, size, SCALE, SPREAD, result);
+        TEST_VERIFY(result.size() == 16);
+        TEST_VERIFY(std::all_of(result.begin(), result.end(), [](uint8 a) { return a == 0; }));
+
+        DistanceField::BuildEdt(full.data(), size, size, SCALE, SPREAD, result);
+        TEST_VERIFY(result.size() == 16);
+        TEST_VERIFY(std::all_of(result.begin(), result.end(), [](uint8 a) { return a == 255; }));
+
+        // glyph smaller than one output pixel
+        DistanceField::BuildEdt(full.data(), SCALE - 1, SCALE - 1, SCALE, SPREAD, result);
+        TEST_VERIFY(result.empty());
+    }
+
+    DAVA_TEST (BuildBenchmark)
+    {
+        using namespace DistanceFieldTestDetails;
+
+        // Fixed synthetic glyphs, so timings are comparable between runs and machines
+        const int32 glyphsCount = 60;
+        const int32 size = GLYPH_SIZE * SCALE;
+        Vector<Vector<uint8>> glyphs;
+        for (const Shape& shape : CreateShapes(size))
+        {
+            glyphs.push_back(Rasterize(shape, size, true));
+        }
+
+        for (int32 spread : { SPREAD, 4 * SPREAD })
+        {
+            Vector<uint8> result;
+            int64 startTime = SystemTimer::GetUs();
+            for (int32 i = 0; i < glyphsCount; ++i)
+            {
+                DistanceField::BuildEdt(glyphs[i % glyphs.size()].data(), size, size, SCALE, spread, result);
+            }
+            int64 edtTime = SystemTimer::GetUs() - startTime;
+
+            startTime = SystemTimer::GetUs();
+            for (int32 i = 0; i < glyphsCount; ++i)
+            {
+                DistanceField::BuildBruteForce(glyphs[i % glyphs.size()].data(), size, size, SCALE, spread, result);
+            }
+            int64 bruteForceTime = SystemTimer::GetUs() - startTime;
+
+            Logger::Info("Distance field benchmark (%d glyphs %dx%d, scale %d, spread %d): edt %lld us, brute force %lld us",
+                         glyphsCount, GLYPH_SIZE, GLYPH_SIZE, SCALE, spread, edtTime, bruteForceTime);
+        }
+    }
+};
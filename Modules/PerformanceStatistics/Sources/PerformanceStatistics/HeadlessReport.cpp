@@ -0,0 +1,196 @@
+#include "PerformanceStatistics/HeadlessReport.h"
+#include "PerformanceStatistics/SampleStatistics.h"
+
+#include "FileSystem/YamlEmitter.h"
+#include "FileSystem/YamlNode.h"
+#include "FileSystem/YamlParser.h"
+#include "Logger/Logger.h"
+
+#include <algorithm>
+
+using namespace DAVA;
+
+const String HeadlessReport::FRAME_TIME = "FrameTime";
+const String HeadlessReport::ALLOCATIONS = "Allocations";
+
+namespace HeadlessReportDetails
+{
+RefPtr<YamlNode> CreateMetricNode(const Vector<float32>& samples)
+{
+    SampleStatistics::Summary summary = SampleStatistics::Summarize(samples);
+
+    RefPtr<YamlNode> node = YamlNode::CreateMapNode();
+    node->Add("count", static_cast<int32>(summary.count));
+    node->Add("min", summary.min);
+    node->Add("max", summary.max);
+    node->Add("mean", summary.mean);
+    node->Add("stddev", summary.stddev);
+    node->Add("median", summary.median);
+    node->Add("p95", summary.p95);
+    node->Add("p99", summary.p99);
+
+    RefPtr<YamlNode> samplesNode = YamlNode::CreateArrayNode(YamlNode::AR_FLOW_REPRESENTATION);
+    for (float32 s : samples)
+    {
+        samplesNode->Add(s);
+    }
+    node->Add("samples", samplesNode);
+
+    return node;
+}
+
+void ReadSamples(const YamlNode* metricNode, Vector<float32>& samples)
+{
+    const YamlNode* samplesNode = (metricNode != nullptr) ? metricNode->Get("samples") : nullptr;
+    if (samplesNode != nullptr)
+    {
+        for (const RefPtr<YamlNode>& s : samplesNode->AsVector())
+        {
+            samples.push_back(s->AsFloat());
+        }
+    }
+}
+
+uint32 CompareMetric(const String& testName, const String& metricName, const Vector<float32>& baseline, const Vector<float32>& current, uint32 blockSize, float64 alpha, float32 minRelativeChange)
+{
+    Vector<float32> baselineBlocks = SampleStatistics::BlockMedians(baseline, blockSize);
+    Vector<float32> currentBlocks = SampleStatistics::BlockMedians(current, blockSize);
+    if (baselineBlocks.empty() || currentBlocks.empty())
+    {
+        return 0;
+    }
+
+    SampleStatistics::Comparison cmp = SampleStatistics::Compare(baselineBlocks, currentBlocks, alpha, minRelativeChange);
+    bool regression = cmp.significant && cmp.relativeChange > 0.0f;
+
+    const char* verdict = cmp.significant ? (regression ? "REGRESSION" : "improvement") : "no significant difference";
+    Logger::Info("%s / %s: median %f -> %f (%+.2f%%), p = %.4f over %u vs %u blocks: %s",
+                 testName.c_str(), metricName.c_str(), cmp.baselineMedian, cmp.currentMedian, cmp.relativeChange * 100.0f, cmp.pValue,
+                 static_cast<uint32>(baselineBlocks.size()), static_cast<uint32>(currentBlocks.size()), verdict);
+
+    return regression ? 1 : 0;
+}
+}
+
+void HeadlessReport::AddResult(TestResult&& result)
+{
+    results.push_back(std::move(result));
+}
+
+const Vector<HeadlessReport::TestResult>& HeadlessReport::GetResults() const
+{
+    return results;
+}
+
+bool HeadlessReport::Save(const FilePath& path) const
+{
+    using namespace HeadlessReportDetails;
+
+    RefPtr<YamlNode> root = YamlNode::CreateMapNode();
+    RefPtr<YamlNode> testsNode = YamlNode::CreateArrayNode(YamlNode::AR_BLOCK_REPRESENTATION);
+
+    for (const TestResult& result : results)
+    {
+        RefPtr<YamlNode> testNode = YamlNode::CreateMapNode();
+        testNode->Add("name", result.testName);
+        testNode->Add(FRAME_TIME, CreateMetricNode(result.frameTimes));
+        if (!result.allocations.empty())
+        {
+            testNode->Add(ALLOCATIONS, CreateMetricNode(result.allocations));
+        }
+
+        RefPtr<YamlNode> markersNode = YamlNode::CreateMapNode();
+        for (const auto& marker : result.markerTimes)
+        {
+            markersNode->Add(marker.first, CreateMetricNode(marker.second));
+        }
+        testNode->Add("markers", markersNode);
+
+        testsNode->Add(testNode);
+    }
+    root->Add("tests", testsNode);
+
+    return YamlEmitter::SaveToYamlFile(path, root.Get());
+}
+
+bool HeadlessReport::Load(const FilePath& path)
+{
+    using namespace HeadlessReportDetails;
+
+    results.clear();
+
+    RefPtr<YamlParser> parser = YamlParser::Create(path);
+    if (!parser || parser->GetRootNode() == nullptr)
+    {
+        return false;
+    }
+
+    const YamlNode* testsNode = parser->GetRootNode()->Get("tests");
+    if (testsNode == nullptr)
+    {
+        return false;
+    }
+
+    for (const RefPtr<YamlNode>& testNode : testsNode->AsVector())
+    {
+        TestResult result;
+        const YamlNode* nameNode = testNode->Get("name");
+        result.testName = (nameNode != nullptr) ? nameNode->AsString() : String();
+
+        ReadSamples(testNode->Get(FRAME_TIME), result.frameTimes);
+        ReadSamples(testNode->Get(ALLOCATIONS), result.allocations);
+
+        const YamlNode* markersNode = testNode->Get("markers");
+        if (markersNode != nullptr)
+        {
+            for (const auto& marker : markersNode->AsMap())
+            {
+                ReadSamples(marker.second.Get(), result.markerTimes[marker.first]);
+            }
+        }
+
+        results.push_back(std::move(result));
+    }
+
+    return true;
+}
+
+uint32 HeadlessReport::CompareWithBaseline(const HeadlessReport& baseline, uint32 blockSize, float64 alpha, float32 minRelativeChange) const
+{
+    using namespace HeadlessReportDetails;
+
+    uint32 regressions = 0;
+    for (const TestResult& result : results)
+    {
+        auto sameName = [&result](const TestResult& r) {
+            return r.testName == result.testName;
+        };
+
+        if (std::count_if(results.begin(), results.end(), sameName) > 1 || std::count_if(baseline.results.begin(), baseline.results.end(), sameName) > 1)
+        {
+            Logger::Error("%s: several results with the same name, can't compare", result.testName.c_str());
+            continue;
+        }
+
+        auto baselineIt = std::find_if(baseline.results.begin(), baseline.results.end(), sameName);
+        if (baselineIt == baseline.results.end())
+        {
+            Logger::Warning("%s: no baseline", result.testName.c_str());
+            continue;
+        }
+
+        regressions += CompareMetric(result.testName, FRAME_TIME, baselineIt->frameTimes, result.frameTimes, blockSize, alpha, minRelativeChange);
+        regressions += CompareMetric(result.testName, ALLOCATIONS, baselineIt->allocations, result.allocations, blockSize, alpha, minRelativeChange);
+
+        for (const auto& marker : result.markerTimes)
+        {
+            auto baselineMarkerIt = baselineIt->markerTimes.find(marker.first);
+            if (baselineMarkerIt != baselineIt->markerTimes.end())
+            {
+                regressions += CompareMetric(result.testName, marker.first, baselineMarkerIt->second, marker.second, blockSize, alpha, minRelativeChange);
+            }
+        }
+    }
+
+    return regressions;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Base/BaseTypes.h"
+#include "FileSystem/FilePath.h"
+
+/**
+    Machine-readable results of headless performance run.
+    Stored as yaml with summary and raw samples of every metric, raw samples are used for comparison against a baseline.
+*/
+class HeadlessReport
+{
+public:
+    struct TestResult
+    {
+        DAVA::String testName; ///< Unique name of test run (test name and scene name), results are matched with baseline by it
+        DAVA::Vector<DAVA::float32> frameTimes; ///< Main thread CPU time of every measured frame, ms
+        DAVA::Vector<DAVA::float32> allocations; ///< Heap allocations count of every measured frame, empty if memory profiler is disabled
+        DAVA::Map<DAVA::String, DAVA::Vector<DAVA::float32>> markerTimes; ///< ProfilerCPU marker name -> time of every measured frame, us
+    };
+
+    void AddResult(TestResult&& result);
+    const DAVA::Vector<TestResult>& GetResults() const;
+
+    bool Save(const DAVA::FilePath& path) const;
+    bool Load(const DAVA::FilePath& path);
+
+    /**
+        Compare every metric of every test with `baseline`, log the comparison and
+        return number of metrics with statistically significant regression.
+        Per-frame samples are compared by medians of consecutive `blockSize`-frame blocks, as neighbouring frames are not independent.
+    */
+    DAVA::uint32 CompareWithBaseline(const HeadlessReport& baseline, DAVA::uint32 blockSize, DAVA::float64 alpha, DAVA::float32 minRelativeChange) const;
+
+    static const DAVA::String FRAME_TIME;
+    static const DAVA::String ALLOCATIONS;
+
+private:
+    DAVA::Vector<TestResult> results;
+};
@@ -0,0 +1,155 @@
+#include "PerformanceStatistics/SampleStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SampleStatistics
+{
+using namespace DAVA;
+
+Summary Summarize(const Vector<float32>& samples)
+{
+    Summary summary;
+    if (samples.empty())
+    {
+        return summary;
+    }
+
+    Vector<float32> sorted(samples);
+    std::sort(sorted.begin(), sorted.end());
+
+    float64 sum = 0.0;
+    for (float32 s : sorted)
+    {
+        sum += s;
+    }
+    float64 mean = sum / sorted.size();
+
+    float64 variance = 0.0;
+    for (float32 s : sorted)
+    {
+        variance += (s - mean) * (s - mean);
+    }
+    variance = sorted.size() > 1 ? variance / (sorted.size() - 1) : 0.0;
+
+    summary.count = static_cast<uint32>(sorted.size());
+    summary.min = sorted.front();
+    summary.max = sorted.back();
+    summary.mean = static_cast<float32>(mean);
+    summary.stddev = static_cast<float32>(std::sqrt(variance));
+    summary.median = Percentile(sorted, 0.5f);
+    summary.p95 = Percentile(sorted, 0.95f);
+    summary.p99 = Percentile(sorted, 0.99f);
+    return summary;
+}
+
+float32 Percentile(const Vector<float32>& sortedSamples, float32 p)
+{
+    if (sortedSamples.empty())
+    {
+        return 0.0f;
+    }
+
+    float32 rank = p * (sortedSamples.size() - 1);
+    size_t lower = static_cast<size_t>(std::floor(rank));
+    size_t upper = std::min(lower + 1, sortedSamples.size() - 1);
+    float32 fraction = rank - lower;
+    return sortedSamples[lower] + (sortedSamples[upper] - sortedSamples[lower]) * fraction;
+}
+
+Vector<float32> BlockMedians(const Vector<float32>& samples, uint32 blockSize)
+{
+    if (blockSize <= 1)
+    {
+        return samples;
+    }
+
+    Vector<float32> medians;
+    Vector<float32> block;
+    for (size_t begin = 0; begin + blockSize <= samples.size(); begin += blockSize)
+    {
+        block.assign(samples.begin() + begin, samples.begin() + begin + blockSize);
+        std::sort(block.begin(), block.end());
+        medians.push_back(Percentile(block, 0.5f));
+    }
+    return medians;
+}
+
+Comparison Compare(const Vector<float32>& baseline, const Vector<float32>& current, float64 alpha, float32 minRelativeChange)
+{
+    Comparison result;
+    result.baselineMedian = Summarize(baseline).median;
+    result.currentMedian = Summarize(current).median;
+    if (result.baselineMedian > 0.0f)
+    {
+        result.relativeChange = (result.currentMedian - result.baselineMedian) / result.baselineMedian;
+    }
+
+    if (baseline.size() < 2 || current.size() < 2)
+    {
+        return result;
+    }
+
+    struct RankedSample
+    {
+        float32 value;
+        bool isBaseline;
+    };
+
+    Vector<RankedSample> all;
+    all.reserve(baseline.size() + current.size());
+    for (float32 s : baseline)
+    {
+        all.push_back({ s, true });
+    }
+    for (float32 s : current)
+    {
+        all.push_back({ s, false });
+    }
+    std::sort(all.begin(), all.end(), [](const RankedSample& l, const RankedSample& r) { return l.value < r.value; });
+
+    // Average ranks for ties and accumulate tie correction term
+    float64 baselineRankSum = 0.0;
+    float64 tieCorrection = 0.0;
+    size_t i = 0;
+    while (i < all.size())
+    {
+        size_t j = i + 1;
+        while (j < all.size() && all[j].value == all[i].value)
+        {
+            ++j;
+        }
+
+        float64 averageRank = (i + 1 + j) * 0.5;
+        for (size_t k = i; k < j; ++k)
+        {
+            if (all[k].isBaseline)
+            {
+                baselineRankSum += averageRank;
+            }
+        }
+
+        float64 tieSize = static_cast<float64>(j - i);
+        tieCorrection += tieSize * tieSize * tieSize - tieSize;
+        i = j;
+    }
+
+    float64 n1 = static_cast<float64>(baseline.size());
+    float64 n2 = static_cast<float64>(current.size());
+    float64 n = n1 + n2;
+    float64 u = baselineRankSum - n1 * (n1 + 1.0) * 0.5;
+    float64 meanU = n1 * n2 * 0.5;
+    float64 varianceU = n1 * n2 / 12.0 * ((n + 1.0) - tieCorrection / (n * (n - 1.0)));
+
+    if (varianceU > 0.0)
+    {
+        // Continuity correction
+        float64 z = (std::abs(u - meanU) - 0.5) / std::sqrt(varianceU);
+        z = std::max(z, 0.0);
+        result.pValue = std::erfc(z / std::sqrt(2.0));
+    }
+
+    result.significant = result.pValue < alpha && std::abs(result.relativeChange) >= minRelativeChange;
+    return result;
+}
+}
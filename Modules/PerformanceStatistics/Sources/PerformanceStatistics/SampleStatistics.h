@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Base/BaseTypes.h"
+
+namespace SampleStatistics
+{
+using DAVA::float32;
+using DAVA::float64;
+using DAVA::uint32;
+
+struct Summary
+{
+    uint32 count = 0;
+    float32 min = 0.0f;
+    float32 max = 0.0f;
+    float32 mean = 0.0f;
+    float32 stddev = 0.0f;
+    float32 median = 0.0f;
+    float32 p95 = 0.0f;
+    float32 p99 = 0.0f;
+};
+
+struct Comparison
+{
+    float32 baselineMedian = 0.0f;
+    float32 currentMedian = 0.0f;
+    float32 relativeChange = 0.0f; ///< (current - baseline) / baseline, by medians
+    float64 pValue = 1.0; ///< Two-sided p-value of Mann-Whitney U test
+    bool significant = false; ///< pValue < alpha and |relativeChange| >= minRelativeChange
+};
+
+/** Compute summary of `samples`. Percentiles are calculated with linear interpolation between closest ranks. */
+Summary Summarize(const DAVA::Vector<float32>& samples);
+
+/** Return `p`-th percentile (p in [0, 1]) of already sorted `samples`. */
+float32 Percentile(const DAVA::Vector<float32>& sortedSamples, float32 p);
+
+/**
+    Split `samples` into consecutive blocks of `blockSize` samples and return median of every block.
+    Trailing incomplete block is dropped. `blockSize` of 0 or 1 returns `samples` as is.
+    Per-frame samples are strongly autocorrelated (caching, streaming, thermal state), so they are not independent observations
+    and should be blocked before `Compare`: medians of long enough blocks are close to independent.
+*/
+DAVA::Vector<float32> BlockMedians(const DAVA::Vector<float32>& samples, uint32 blockSize);
+
+/**
+    Compare two sets of samples with Mann-Whitney U test (normal approximation with tie correction).
+    Rank test is used as frame times are not normally distributed and have long tails.
+    The test assumes independent samples, pass per-run aggregates or `BlockMedians` of per-frame samples rather than raw frames.
+    Difference is reported as significant only if it is statistically significant at `alpha` level and
+    relative change of medians is at least `minRelativeChange`.
+    Sets with less than two samples are never reported as different, as normal approximation is meaningless for them.
+*/
+Comparison Compare(const DAVA::Vector<float32>& baseline, const DAVA::Vector<float32>& current, float64 alpha, float32 minRelativeChange);
+}
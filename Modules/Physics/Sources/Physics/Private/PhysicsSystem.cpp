@@ -28,6 +28,7 @@
 #include <Scene3D/Entity.h>
 #include <Entity/Component.h>
 
+#include <Base/FrameAllocator.h>
 #include <Base/Type.h>
 #include <Engine/Engine.h>
 #include <Engine/EngineContext.h>
@@ -93,6 +94,19 @@ void UpdateShapeLocalPose(physx::PxShape* shape, const Matrix4& m)
     shape->setLocalPose(physx::PxTransform(PhysicsMath::Vector3ToPxVec3(position), PhysicsMath::QuaternionToPxQuat(rotation)));
 }
 
+// Same as PhysicsUtils::GetShapeComponents(entity)[0], but without building temporary vector
+CollisionShapeComponent* GetFirstShapeComponent(Entity* entity, const Vector<const Type*>& shapeComponents)
+{
+    for (const Type* shapeType : shapeComponents)
+    {
+        if (entity->GetComponentCount(shapeType) > 0)
+        {
+            return static_cast<CollisionShapeComponent*>(entity->GetComponent(shapeType, 0));
+        }
+    }
+    return nullptr;
+}
+
 bool IsCollisionShapeType(const Type* componentType)
 {
     PhysicsModule* module = GetEngineContext()->moduleManager->GetModule<PhysicsModule>();
@@ -666,6 +680,9 @@ bool PhysicsSystem::FetchResults(bool waitForFetchFinish)
         physx::PxU32 actorsCount = 0;
         physx::PxActor** actors = physicsScene->getActiveActors(actorsCount);
 
+        const Vector<const Type*>& shapeComponents = GetEngineContext()->moduleManager->GetModule<PhysicsModule>()->GetShapeComponentTypes();
+        FrameVector<Entity*> children;
+
         for (physx::PxU32 i = 0; i < actorsCount; ++i)
         {
             physx::PxActor* actor = actors[i];
@@ -686,19 +703,17 @@ bool PhysicsSystem::FetchResults(bool waitForFetchFinish)
                 TransformComponent* entityTransform = entity->GetComponent<TransformComponent>();
                 entityTransform->SetWorldMatrix(scaleMatrix * PhysicsMath::PxMat44ToMatrix4(rigidActor->getGlobalPose()));
 
-                Vector<Entity*> children;
+                children.clear();
                 entity->GetChildEntitiesWithCondition(children, [component](Entity* e) { return PhysicsSystemDetail::GetParentPhysicsComponent(e) == component; });
 
                 for (Entity* child : children)
                 {
                     DVASSERT(child != nullptr);
 
-                    Vector<CollisionShapeComponent*> shapes = PhysicsUtils::GetShapeComponents(child);
-                    if (shapes.size() > 0)
+                    // Update entity using just first shape for now
+                    CollisionShapeComponent* shape = PhysicsSystemDetail::GetFirstShapeComponent(child, shapeComponents);
+                    if (shape != nullptr)
                     {
-                        // Update entity using just first shape for now
-                        CollisionShapeComponent* shape = shapes[0];
-
                         Matrix4 scaleMatrix = Matrix4::MakeScale(shape->scale);
                         TransformComponent* childTransform = child->GetComponent<TransformComponent>();
                         childTransform->SetLocalMatrix(scaleMatrix * PhysicsMath::PxMat44ToMatrix4(shape->GetPxShape()->getLocalPose()));
@@ -62,6 +62,8 @@ public:
     static const String Width;
     static const String Height;
     static const String Camera;
+    static const String SectorSize;
+    static const String MergeMeshes;
 
     static const String Validate;
     static const String Count;
@@ -56,6 +56,8 @@ const String OptionName::AssetCacheTimeout("-t");
 const String OptionName::Width("-width");
 const String OptionName::Height("-height");
 const String OptionName::Camera("-camera");
+const String OptionName::SectorSize("-sectorsize");
+const String OptionName::MergeMeshes("-mergemeshes");
 
 const String OptionName::Validate("-validate");
 const String OptionName::Count("-count");
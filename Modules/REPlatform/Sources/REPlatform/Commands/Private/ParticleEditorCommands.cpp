@@ -28,7 +28,8 @@ Map<ForceType, String> forceNames =
   { ForceType::VORTEX, "Vortex" },
   { ForceType::GRAVITY, "Gravity" },
   { ForceType::POINT_GRAVITY, "Point Gravity" },
-  { ForceType::PLANE_COLLISION, "Plane Collision" }
+  { ForceType::PLANE_COLLISION, "Plane Collision" },
+  { ForceType::SCENE_COLLISION, "Scene Collision" }
 };
 
 void AddNewForceToLayer(ParticleLayer* layer, ParticleForce::eType forceType)
@@ -88,7 +88,7 @@ void SelectionSystem::UpdateGroupSelectionMode()
     DVASSERT(engine != nullptr);
     const EngineContext* engineContext = engine->GetContext();
     DVASSERT(engineContext != nullptr);
-    if (engineContext->inputSystem == nullptr)
+    if (engine->IsConsoleMode())
     {
         return;
     }
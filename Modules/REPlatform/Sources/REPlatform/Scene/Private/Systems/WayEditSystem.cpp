@@ -686,8 +686,7 @@ bool WayEditSystem::AllowChangeSelectionReplacingCurrent(const SelectableGroup&
 {
     Engine* engine = Engine::Instance();
     DVASSERT(engine != nullptr);
-    const EngineContext* engineContext = engine->GetContext();
-    if (engineContext->inputSystem == nullptr)
+    if (engine->IsConsoleMode())
     {
         return true;
     }
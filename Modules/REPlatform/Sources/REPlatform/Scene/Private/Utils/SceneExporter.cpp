@@ -26,6 +26,7 @@
 #include <Scene3D/Components/ParticleEffectComponent.h>
 #include <Scene3D/Components/SlotComponent.h>
 #include <Scene3D/Components/CustomPropertiesComponent.h>
+#include <Scene3D/Converters/StaticMeshMerger.h>
 #include <Scene3D/SceneFile/VersionInfo.h>
 #include <Scene3D/Systems/SlotSystem.h>
 #include <Utils/MD5.h>
@@ -43,7 +44,7 @@ const uint32 EXPORTER_VERSION = 1;
 const uint32 LINKS_PARSER_VERSION = 2;
 const String LINKS_NAME = "links.txt";
 
-void CalculateSceneKey(const FilePath& scenePathname, const String& sceneLink, AssetCache::CacheItemKey& key, uint32 optimize)
+void CalculateSceneKey(const FilePath& scenePathname, const String& sceneLink, AssetCache::CacheItemKey& key, uint32 optimize, uint32 mergeMeshes)
 {
     using namespace DAVA;
 
@@ -64,6 +65,7 @@ void CalculateSceneKey(const FilePath& scenePathname, const String& sceneLink, A
         params += Format("ExporterVersion: %u", EXPORTER_VERSION);
         params += Format("LinksParserVersion: %u", LINKS_PARSER_VERSION);
         params += Format("Optimized: %u", optimize);
+        params += Format("MergedMeshes: %u", mergeMeshes);
         for (int32 linkType = 0; linkType < SceneExporter::OBJECT_COUNT; ++linkType)
         {
             params += Format("LinkType: %d", linkType);
@@ -470,7 +472,7 @@ bool SceneExporter::ExportSceneObject(const ExportedObject& sceneObject)
     AssetCache::CacheItemKey cacheKey;
     if (cacheClient != nullptr && cacheClient->IsConnected())
     { //request Scene from cache
-        SceneExporterCache::CalculateSceneKey(scenePathname, sceneObject.relativePathname, cacheKey, static_cast<uint32>(exportingParams.optimizeOnExport));
+        SceneExporterCache::CalculateSceneKey(scenePathname, sceneObject.relativePathname, cacheKey, static_cast<uint32>(exportingParams.optimizeOnExport), static_cast<uint32>(exportingParams.mergeStaticMeshes));
 
         AssetCache::CachedItemValue retrievedData;
         AssetCache::Error requested = cacheClient->RequestFromCacheSynchronously(cacheKey, &retrievedData);
@@ -1177,6 +1179,11 @@ const Array<SceneExporter::ExportedObjectDesc, SceneExporter::OBJECT_COUNT>& Sce
 void SceneExporter::CollectObjects(Scene* scene, Vector<ExportedObjectCollection>& exportedObjects)
 {
     SceneExporterDetails::PrepareSceneToExport(scene, exportingParams.optimizeOnExport);
+    if (exportingParams.mergeStaticMeshes)
+    {
+        StaticMeshMerger merger;
+        merger.MergeMeshes(scene);
+    }
 
     SceneExporterDetails::CollectHeightmapPathname(scene, exportingParams.dataSourceFolder, exportedObjects[eExportedObjectType::OBJECT_HEIGHTMAP]); //must be first
     SceneExporterDetails::CollectTextureDescriptors(scene, exportingParams.dataSourceFolder, exportedObjects[eExportedObjectType::OBJECT_TEXTURE]);
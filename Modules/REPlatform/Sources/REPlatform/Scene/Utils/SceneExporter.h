@@ -77,6 +77,7 @@ public:
         String filenamesTag;
 
         bool optimizeOnExport = false;
+        bool mergeStaticMeshes = false; //merge static meshes with same materials into MergedMeshRenderObject's
     };
 
     SceneExporter() = default;
@@ -5,7 +5,7 @@
 #include <FileSystem/FileSystem.h>
 #include <FileSystem/File.h>
 #include <FileSystem/FilePath.h>
-#include <FileSystem/FileList.h>
+#include <FileSystem/DirectoryWalker.h>
 #include <FileSystem/Private/PackFormatSpec.h>
 #include <FileSystem/Private/PackMetaData.h>
 #include <Utils/UTF8Utils.h>
@@ -43,34 +43,15 @@ struct CollectedFile
 
 void CollectAllFilesInDirectory(const FilePath& dirPath, const String& dirArchivePath, bool addHidden, Vector<CollectedFile>& collectedFiles)
 {
-    ScopedPtr<FileList> fileList(new FileList(dirPath, addHidden));
-    for (uint32 file = 0; file < fileList->GetCount(); ++file)
-    {
-        if (fileList->IsNavigationDirectory(file))
-        {
-            continue;
-        }
-
-        if (fileList->IsDirectory(file))
-        {
-            String directoryName = fileList->GetFilename(file);
-            FilePath subDirAbsolute = dirPath + (directoryName + '/');
-            String subDirArchive = dirArchivePath + (directoryName + '/');
-            CollectAllFilesInDirectory(subDirAbsolute, subDirArchive, addHidden, collectedFiles);
-        }
-        else
-        {
-            if (fileList->IsHidden(file) && addHidden == false)
-            {
-                continue;
-            }
-
-            CollectedFile collectedFile;
-            collectedFile.absPath = fileList->GetPathname(file);
-            collectedFile.archivePath = dirArchivePath + fileList->GetFilename(file);
-            collectedFiles.push_back(collectedFile);
-        }
-    }
+    DirectoryWalker::Options options;
+    options.includeHidden = addHidden;
+
+    DirectoryWalker::Walk(dirPath, options, [&](const DirectoryWalker::Entry& entry) {
+        CollectedFile collectedFile;
+        collectedFile.absPath = dirPath + entry.relativePath;
+        collectedFile.archivePath = dirArchivePath + entry.relativePath;
+        collectedFiles.push_back(collectedFile);
+    });
 }
 
 bool WriteHeaderBlock(File* outputFile, const PackFormat::PackFile::FooterBlock& footer)
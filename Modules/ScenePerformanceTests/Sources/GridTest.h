@@ -25,6 +25,9 @@ struct GridTestSample
     DAVA::float32 cos = 0.0f;
     DAVA::float32 fps = 0.0f;
     DAVA::FilePath screenshotPath;
+    DAVA::uint32 cellX = 0;
+    DAVA::uint32 cellY = 0;
+    DAVA::Map<DAVA::String, DAVA::float32> metrics; ///< CPU-side metrics by name, filled by HeadlessGridTest
 };
 
 struct GridTestResult
@@ -61,6 +64,9 @@ public:
     explicit GridTest(DAVA::Engine& engine, GridTestListener* listener, Mode mode = ModeDefault);
     ~GridTest();
 
+    /** Fills `result` with samples over landscape of `scene`. Returns false if scene has no landscape. */
+    static bool CreateSamples(DAVA::Scene* scene, GridTestResult& result);
+
     bool Start(const DAVA::ScopedPtr<DAVA::UI3DView>& s);
     void Stop();
 
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "GridTest.h"
+
+#include <Base/BaseTypes.h>
+#include <FileSystem/FilePath.h>
+#include <Render/Image/Image.h>
+
+/**
+    Allowed growth of metric against baseline.
+    `metric` is either exact metric name or prefix ending with '*', e.g. "time.*".
+    Sample regresses if its value exceeds baseline by more than `maxRelativeIncrease` of baseline value
+    and by more than `minAbsoluteIncrease`, the latter filters out noise of small values.
+*/
+struct GridTestThreshold
+{
+    DAVA::String metric;
+    DAVA::float32 maxRelativeIncrease = 0.f;
+    DAVA::float32 minAbsoluteIncrease = 0.f;
+};
+
+struct GridTestRegression
+{
+    DAVA::String metric;
+    DAVA::uint32 sampleIndex = 0;
+    DAVA::float32 baselineValue = 0.f;
+    DAVA::float32 value = 0.f;
+};
+
+/**
+    Machine-readable report of grid test metrics.
+
+    Report is CSV file with one row per sample: sample index, grid cell, camera angle and position,
+    followed by values of all metrics. Heatmap is image of landscape grid, each cell is colored by maximum
+    of metric over sample angles, from green (zero) to red (maximum over all cells).
+*/
+namespace GridTestReport
+{
+bool Save(const GridTestResult& result, const DAVA::FilePath& path);
+bool Load(const DAVA::FilePath& path, GridTestResult& result);
+
+DAVA::Vector<DAVA::String> GetMetricNames(const GridTestResult& result);
+
+DAVA::Image* CreateHeatmap(const GridTestResult& result, const DAVA::String& metric, DAVA::uint32 cellSize = 32);
+/** Saves heatmap of every metric to `folder` as "heatmap_<metric>.png". */
+bool SaveHeatmaps(const GridTestResult& result, const DAVA::FilePath& folder);
+
+/**
+    Compares metrics of `result` against `baseline` and fills `regressions` with samples exceeding thresholds.
+    Metrics without matching threshold are not checked. Returns false if reports have different samples.
+*/
+bool Compare(const GridTestResult& baseline, const GridTestResult& result, const DAVA::Vector<GridTestThreshold>& thresholds, DAVA::Vector<GridTestRegression>& regressions);
+}
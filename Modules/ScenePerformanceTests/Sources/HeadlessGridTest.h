@@ -0,0 +1,54 @@
+#pragma once
+
+#include "GridTest.h"
+
+#include <Base/BaseTypes.h>
+#include <Scene3D/Scene.h>
+
+/**
+    Grid test without window, for console applications running on null renderer.
+
+    Walks camera over the same grid as `GridTest`, but instead of FPS and screenshots collects CPU-side metrics
+    into `GridTestSample::metrics`, averaged over `measuredFrames` frames of every sample:
+    - "visibleRenderObjects", "renderPackets", "triangles", "materialParamBinds" and "batches.<render layer>",
+      which are deterministic for the same scene and require engine built with render stats (DAVA_USE_RENDERSTATS);
+    - "time.culling", "time.sceneUpdate", "time.sceneDraw" and "time.<scene system>" in microseconds,
+      taken from global CPU profiler.
+
+    `Run` updates and draws scene itself and wraps every frame in Renderer::BeginFrame/EndFrame,
+    so it should not be called while engine draws windows.
+*/
+class HeadlessGridTest final
+{
+public:
+    struct Settings
+    {
+        DAVA::uint32 warmupFrames = 2;
+        DAVA::uint32 measuredFrames = 4;
+        DAVA::float32 frameDelta = 1.f / 60.f;
+    };
+
+    explicit HeadlessGridTest(DAVA::Scene* scene);
+
+    void SetSettings(const Settings& settings);
+    const Settings& GetSettings() const;
+
+    bool Run(GridTestResult& result);
+
+private:
+    void DrawFrame();
+    void CollectMetrics(DAVA::Map<DAVA::String, DAVA::float32>& metrics) const;
+
+    DAVA::Scene* scene = nullptr;
+    Settings settings;
+};
+
+inline void HeadlessGridTest::SetSettings(const Settings& settings_)
+{
+    settings = settings_;
+}
+
+inline const HeadlessGridTest::Settings& HeadlessGridTest::GetSettings() const
+{
+    return settings;
+}
@@ -266,60 +266,13 @@ bool GridTestImpl::Start(const DAVA::ScopedPtr<DAVA::UI3DView>& view)
         return false;
     }
 
-    DAVA::Landscape* landscape = FindLandscape(scene);
-    if (!landscape)
+    ClearResults();
+    if (!GridTest::CreateSamples(scene, result))
     {
         Logger::Warning("Grid test needs landscape in scene to be started");
         return false;
     }
 
-    ClearResults();
-    result.samples.reserve(GRID_SIZE * GRID_SIZE * ANGLE_COUNT);
-
-    float32 landscapeSize = landscape->GetLandscapeSize();
-    float32 step = landscapeSize / (GRID_SIZE + 1);
-    float32 sceneMin = -landscapeSize / 2;
-    float32 sceneMax = landscapeSize / 2;
-
-    result.sceneSize = landscapeSize;
-    result.sceneMin = sceneMin;
-    result.sceneMax = sceneMax;
-    result.gridStep = step;
-    result.sampleAngleDegrees = ANGLE_STEP_DEGREES;
-
-    float32 xMin = sceneMin + step;
-    float32 xMax = sceneMax - step;
-    float32 yMin = sceneMin + step;
-
-    bool invertedDirection = false;
-    float32 yPos = yMin;
-    for (uint32 y = 0; y < GRID_SIZE; ++y, yPos += step)
-    {
-        float32 xPos = invertedDirection ? xMax : xMin;
-        float32 xInc = invertedDirection ? -step : step;
-        for (uint32 x = 0; x < GRID_SIZE; ++x, xPos += xInc)
-        {
-            float32 angle = 0.1f;
-            for (uint32 n = 0; n < ANGLE_COUNT; ++n, angle += ANGLE_STEP_DEGREES)
-            {
-                result.samples.push_back(GridTestSample());
-                GridTestSample& testPosition = result.samples.back();
-
-                testPosition.pos.x = xPos;
-                testPosition.pos.y = yPos;
-
-                float32 landscapeHeight = 0.f;
-                landscape->GetHeightAtPoint(testPosition.pos, landscapeHeight);
-                testPosition.pos.z = landscapeHeight + ELEVATION_ABOVE_LANDSCAPE;
-
-                testPosition.angle = angle;
-                SinCosFast(DegToRad(angle), testPosition.sine, testPosition.cos);
-            }
-        }
-
-        invertedDirection = !invertedDirection;
-    }
-
     SetState(GridTest::StateRunning);
 
     if (mode == GridTest::ModeGenerateReport)
@@ -498,6 +451,70 @@ void GridTestImpl::SetState(GridTest::State newState)
     }
 }
 
+bool GridTest::CreateSamples(DAVA::Scene* scene, GridTestResult& result)
+{
+    using namespace GridTestDetails;
+    using namespace DAVA;
+
+    Landscape* landscape = FindLandscape(scene);
+    if (!landscape)
+    {
+        return false;
+    }
+
+    result.samples.clear();
+    result.samples.reserve(GRID_SIZE * GRID_SIZE * ANGLE_COUNT);
+
+    float32 landscapeSize = landscape->GetLandscapeSize();
+    float32 step = landscapeSize / (GRID_SIZE + 1);
+    float32 sceneMin = -landscapeSize / 2;
+    float32 sceneMax = landscapeSize / 2;
+
+    result.sceneSize = landscapeSize;
+    result.sceneMin = sceneMin;
+    result.sceneMax = sceneMax;
+    result.gridStep = step;
+    result.sampleAngleDegrees = ANGLE_STEP_DEGREES;
+
+    float32 xMin = sceneMin + step;
+    float32 xMax = sceneMax - step;
+    float32 yMin = sceneMin + step;
+
+    bool invertedDirection = false;
+    float32 yPos = yMin;
+    for (uint32 y = 0; y < GRID_SIZE; ++y, yPos += step)
+    {
+        float32 xPos = invertedDirection ? xMax : xMin;
+        float32 xInc = invertedDirection ? -step : step;
+        for (uint32 x = 0; x < GRID_SIZE; ++x, xPos += xInc)
+        {
+            uint32 cellX = invertedDirection ? GRID_SIZE - 1 - x : x;
+            float32 angle = 0.1f;
+            for (uint32 n = 0; n < ANGLE_COUNT; ++n, angle += ANGLE_STEP_DEGREES)
+            {
+                result.samples.push_back(GridTestSample());
+                GridTestSample& testPosition = result.samples.back();
+
+                testPosition.cellX = cellX;
+                testPosition.cellY = y;
+                testPosition.pos.x = xPos;
+                testPosition.pos.y = yPos;
+
+                float32 landscapeHeight = 0.f;
+                landscape->GetHeightAtPoint(testPosition.pos, landscapeHeight);
+                testPosition.pos.z = landscapeHeight + ELEVATION_ABOVE_LANDSCAPE;
+
+                testPosition.angle = angle;
+                SinCosFast(DegToRad(angle), testPosition.sine, testPosition.cos);
+            }
+        }
+
+        invertedDirection = !invertedDirection;
+    }
+
+    return true;
+}
+
 GridTest::GridTest(DAVA::Engine& engine, GridTestListener* listener, Mode mode)
     : impl(new GridTestImpl(engine, listener, mode))
 {
@@ -0,0 +1,271 @@
+#include "GridTestReport.h"
+
+#include <FileSystem/File.h>
+#include <FileSystem/FileSystem.h>
+#include <Logger/Logger.h>
+#include <Utils/StringFormat.h>
+#include <Utils/Utils.h>
+
+#include <cstdlib>
+
+namespace GridTestReportDetails
+{
+using namespace DAVA;
+
+const char* const SAMPLE_COLUMNS[] = { "index", "cellX", "cellY", "angle", "x", "y", "z" };
+const uint32 SAMPLE_COLUMNS_COUNT = static_cast<uint32>(sizeof(SAMPLE_COLUMNS) / sizeof(SAMPLE_COLUMNS[0]));
+
+const uint32 EMPTY_CELL_COLOR = 0xff404040;
+const uint32 CELL_BORDER_COLOR = 0xff202020;
+
+uint32 HeatColor(float32 t)
+{
+    t = Clamp(t, 0.f, 1.f);
+    uint32 r = static_cast<uint32>(Min(1.f, 2.f * t) * 255.f);
+    uint32 g = static_cast<uint32>(Min(1.f, 2.f * (1.f - t)) * 255.f);
+    return 0xff000000 | (g << 8) | r;
+}
+
+const GridTestThreshold* FindThreshold(const Vector<GridTestThreshold>& thresholds, const String& metric)
+{
+    for (const GridTestThreshold& threshold : thresholds)
+    {
+        const String& name = threshold.metric;
+        if (!name.empty() && name.back() == '*')
+        {
+            if (metric.compare(0, name.size() - 1, name, 0, name.size() - 1) == 0)
+                return &threshold;
+        }
+        else if (name == metric)
+        {
+            return &threshold;
+        }
+    }
+    return nullptr;
+}
+}
+
+namespace GridTestReport
+{
+using namespace DAVA;
+
+bool Save(const GridTestResult& result, const FilePath& path)
+{
+    using namespace GridTestReportDetails;
+
+    ScopedPtr<File> file(File::Create(path, File::CREATE | File::WRITE));
+    if (!file)
+    {
+        Logger::Error("[GridTestReport] Can't create report %s", path.GetAbsolutePathname().c_str());
+        return false;
+    }
+
+    Vector<String> metrics = GetMetricNames(result);
+
+    String header;
+    for (const char* column : SAMPLE_COLUMNS)
+    {
+        header += header.empty() ? column : String(",") + column;
+    }
+    for (const String& metric : metrics)
+    {
+        header += "," + metric;
+    }
+    file->WriteLine(header);
+
+    for (size_t i = 0; i < result.samples.size(); ++i)
+    {
+        const GridTestSample& sample = result.samples[i];
+        String line = Format("%u,%u,%u,%.1f,%.3f,%.3f,%.3f", static_cast<uint32>(i), sample.cellX, sample.cellY, sample.angle, sample.pos.x, sample.pos.y, sample.pos.z);
+        for (const String& metric : metrics)
+        {
+            auto it = sample.metrics.find(metric);
+            line += Format(",%.3f", it != sample.metrics.end() ? it->second : 0.f);
+        }
+        file->WriteLine(line);
+    }
+
+    return true;
+}
+
+bool Load(const FilePath& path, GridTestResult& result)
+{
+    using namespace GridTestReportDetails;
+
+    ScopedPtr<File> file(File::Create(path, File::OPEN | File::READ));
+    if (!file)
+    {
+        Logger::Error("[GridTestReport] Can't open report %s", path.GetAbsolutePathname().c_str());
+        return false;
+    }
+
+    Vector<String> header;
+    Split(file->ReadLine(), ",", header, false, true);
+    if (header.size() < SAMPLE_COLUMNS_COUNT || header[0] != SAMPLE_COLUMNS[0])
+    {
+        Logger::Error("[GridTestReport] Report %s has wrong header", path.GetAbsolutePathname().c_str());
+        return false;
+    }
+
+    result.samples.clear();
+    while (!file->IsEof())
+    {
+        String line = file->ReadLine();
+        if (line.empty())
+            continue;
+
+        Vector<String> values;
+        Split(line, ",", values, false, true);
+        if (values.size() != header.size())
+        {
+            Logger::Error("[GridTestReport] Report %s has wrong line %u", path.GetAbsolutePathname().c_str(), static_cast<uint32>(result.samples.size() + 1));
+            return false;
+        }
+
+        GridTestSample sample;
+        sample.cellX = static_cast<uint32>(std::strtoul(values[1].c_str(), nullptr, 10));
+        sample.cellY = static_cast<uint32>(std::strtoul(values[2].c_str(), nullptr, 10));
+        sample.angle = std::strtof(values[3].c_str(), nullptr);
+        sample.pos = Vector3(std::strtof(values[4].c_str(), nullptr), std::strtof(values[5].c_str(), nullptr), std::strtof(values[6].c_str(), nullptr));
+        SinCosFast(DegToRad(sample.angle), sample.sine, sample.cos);
+        for (size_t i = SAMPLE_COLUMNS_COUNT; i < header.size(); ++i)
+        {
+            sample.metrics[header[i]] = std::strtof(values[i].c_str(), nullptr);
+        }
+        result.samples.push_back(sample);
+    }
+
+    return true;
+}
+
+Vector<String> GetMetricNames(const GridTestResult& result)
+{
+    Set<String> names;
+    for (const GridTestSample& sample : result.samples)
+    {
+        for (const auto& metric : sample.metrics)
+        {
+            names.insert(metric.first);
+        }
+    }
+    return Vector<String>(names.begin(), names.end());
+}
+
+Image* CreateHeatmap(const GridTestResult& result, const String& metric, uint32 cellSize)
+{
+    using namespace GridTestReportDetails;
+
+    DVASSERT(cellSize > 1);
+
+    uint32 gridWidth = 0;
+    uint32 gridHeight = 0;
+    for (const GridTestSample& sample : result.samples)
+    {
+        gridWidth = Max(gridWidth, sample.cellX + 1);
+        gridHeight = Max(gridHeight, sample.cellY + 1);
+    }
+    if (gridWidth == 0 || gridHeight == 0)
+        return nullptr;
+
+    // cell value is maximum over sample angles
+    Vector<float32> cells(gridWidth * gridHeight, -1.f);
+    float32 maxValue = 0.f;
+    for (const GridTestSample& sample : result.samples)
+    {
+        auto it = sample.metrics.find(metric);
+        if (it != sample.metrics.end())
+        {
+            float32& cell = cells[sample.cellX + sample.cellY * gridWidth];
+            cell = Max(cell, it->second);
+            maxValue = Max(maxValue, it->second);
+        }
+    }
+
+    Image* image = Image::Create(gridWidth * cellSize, gridHeight * cellSize, FORMAT_RGBA8888);
+    uint32* pixels = reinterpret_cast<uint32*>(image->data);
+    for (uint32 y = 0; y < image->height; ++y)
+    {
+        // cells with greater Y are on top of image
+        uint32 cellY = gridHeight - 1 - y / cellSize;
+        for (uint32 x = 0; x < image->width; ++x)
+        {
+            uint32 cellX = x / cellSize;
+            float32 value = cells[cellX + cellY * gridWidth];
+
+            uint32 color = EMPTY_CELL_COLOR;
+            if (x % cellSize == 0 || y % cellSize == 0)
+                color = CELL_BORDER_COLOR;
+            else if (value >= 0.f)
+                color = HeatColor(maxValue > 0.f ? value / maxValue : 0.f);
+
+            pixels[x + y * image->width] = color;
+        }
+    }
+
+    return image;
+}
+
+bool SaveHeatmaps(const GridTestResult& result, const FilePath& folder)
+{
+    bool saved = true;
+    for (const String& metric : GetMetricNames(result))
+    {
+        String fileName = metric;
+        std::replace_if(fileName.begin(), fileName.end(), [](char c) { return !isalnum(static_cast<unsigned char>(c)) && c != '.'; }, '_');
+
+        ScopedPtr<Image> heatmap(CreateHeatmap(result, metric));
+        if (!heatmap || !heatmap->Save(folder + Format("heatmap_%s.png", fileName.c_str())))
+        {
+            Logger::Error("[GridTestReport] Can't save heatmap of %s", metric.c_str());
+            saved = false;
+        }
+    }
+    return saved;
+}
+
+bool Compare(const GridTestResult& baseline, const GridTestResult& result, const Vector<GridTestThreshold>& thresholds, Vector<GridTestRegression>& regressions)
+{
+    using namespace GridTestReportDetails;
+
+    regressions.clear();
+
+    if (baseline.samples.size() != result.samples.size())
+    {
+        Logger::Error("[GridTestReport] Reports have different samples count: %u and %u", static_cast<uint32>(baseline.samples.size()), static_cast<uint32>(result.samples.size()));
+        return false;
+    }
+
+    for (uint32 i = 0; i < static_cast<uint32>(result.samples.size()); ++i)
+    {
+        const GridTestSample& baselineSample = baseline.samples[i];
+        const GridTestSample& sample = result.samples[i];
+        if (baselineSample.cellX != sample.cellX || baselineSample.cellY != sample.cellY || !FLOAT_EQUAL_EPS(baselineSample.angle, sample.angle, 0.1f))
+        {
+            Logger::Error("[GridTestReport] Reports have different sample %u", i);
+            return false;
+        }
+
+        for (const auto& metric : sample.metrics)
+        {
+            const GridTestThreshold* threshold = FindThreshold(thresholds, metric.first);
+            if (threshold == nullptr)
+                continue;
+
+            auto baselineMetric = baselineSample.metrics.find(metric.first);
+            float32 baselineValue = baselineMetric != baselineSample.metrics.end() ? baselineMetric->second : 0.f;
+            float32 increase = metric.second - baselineValue;
+            if (increase > threshold->minAbsoluteIncrease && increase > baselineValue * threshold->maxRelativeIncrease)
+            {
+                GridTestRegression regression;
+                regression.metric = metric.first;
+                regression.sampleIndex = i;
+                regression.baselineValue = baselineValue;
+                regression.value = metric.second;
+                regressions.push_back(regression);
+            }
+        }
+    }
+
+    return true;
+}
+}
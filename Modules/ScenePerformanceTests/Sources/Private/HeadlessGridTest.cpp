@@ -0,0 +1,157 @@
+#include "HeadlessGridTest.h"
+
+#include <Base/ScopedPtr.h>
+#include <Debug/ProfilerCPU.h>
+#include <Debug/ProfilerMarkerNames.h>
+#include <Logger/Logger.h>
+#include <Render/Highlevel/Camera.h>
+#include <Render/Renderer.h>
+
+namespace HeadlessGridTestDetails
+{
+using namespace DAVA;
+
+const char* const* GetSystemMarkers(uint32& count)
+{
+    static const char* const markers[] =
+    {
+      ProfilerCPUMarkerName::SCENE_STATIC_OCCLUSION_SYSTEM,
+      ProfilerCPUMarkerName::SCENE_ANIMATION_SYSTEM,
+      ProfilerCPUMarkerName::SCENE_UPDATE_SYSTEM_PRE_TRANSFORM,
+      ProfilerCPUMarkerName::SCENE_UPDATE_SYSTEM_POST_TRANSFORM,
+      ProfilerCPUMarkerName::SCENE_TRANSFORM_SYSTEM,
+      ProfilerCPUMarkerName::SCENE_LOD_SYSTEM,
+      ProfilerCPUMarkerName::SCENE_SWITCH_SYSTEM,
+      ProfilerCPUMarkerName::SCENE_PARTICLE_SYSTEM,
+      ProfilerCPUMarkerName::SCENE_SOUND_UPDATE_SYSTEM,
+      ProfilerCPUMarkerName::SCENE_RENDER_UPDATE_SYSTEM,
+      ProfilerCPUMarkerName::SCENE_ACTION_UPDATE_SYSTEM,
+      ProfilerCPUMarkerName::SCENE_LANDSCAPE_SYSTEM,
+      ProfilerCPUMarkerName::SCENE_FOLIAGE_SYSTEM,
+      ProfilerCPUMarkerName::SCENE_SPEEDTREE_SYSTEM,
+      ProfilerCPUMarkerName::SCENE_WIND_SYSTEM,
+      ProfilerCPUMarkerName::SCENE_WAVE_SYSTEM,
+      ProfilerCPUMarkerName::SCENE_SKELETON_SYSTEM,
+      ProfilerCPUMarkerName::SCENE_MOTION_SYSTEM,
+      ProfilerCPUMarkerName::SCENE_GEODECAL_SYSTEM
+    };
+
+    count = static_cast<uint32>(sizeof(markers) / sizeof(markers[0]));
+    return markers;
+}
+}
+
+HeadlessGridTest::HeadlessGridTest(DAVA::Scene* scene_)
+    : scene(scene_)
+{
+    DVASSERT(scene != nullptr);
+}
+
+bool HeadlessGridTest::Run(GridTestResult& result)
+{
+    using namespace DAVA;
+
+    if (!GridTest::CreateSamples(scene, result))
+    {
+        Logger::Error("[HeadlessGridTest] Grid test needs landscape in scene");
+        return false;
+    }
+
+    Camera* camera = scene->GetCurrentCamera();
+    if (camera == nullptr)
+    {
+        ScopedPtr<Camera> sceneCamera(new Camera());
+        sceneCamera->SetupPerspective(70.f, 16.f / 9.f, 1.f, 5000.f);
+        sceneCamera->SetUp(Vector3(0.f, 0.f, 1.f));
+        scene->AddCamera(sceneCamera);
+        scene->SetCurrentCamera(sceneCamera);
+        camera = sceneCamera;
+    }
+
+    ProfilerCPU* profiler = ProfilerCPU::globalProfiler;
+    bool profilerStarted = profiler != nullptr && !profiler->IsStarted();
+    if (profilerStarted)
+    {
+        profiler->Start();
+    }
+
+    uint32 measuredFrames = Max(settings.measuredFrames, 1U);
+    for (GridTestSample& sample : result.samples)
+    {
+        camera->SetPosition(sample.pos);
+        camera->SetDirection(Vector3(sample.cos, sample.sine, 0.f));
+
+        for (uint32 frame = 0; frame < settings.warmupFrames; ++frame)
+        {
+            DrawFrame();
+        }
+
+        sample.metrics.clear();
+        Map<String, float32> frameMetrics;
+        for (uint32 frame = 0; frame < measuredFrames; ++frame)
+        {
+            DrawFrame();
+            CollectMetrics(frameMetrics);
+            for (const auto& metric : frameMetrics)
+            {
+                sample.metrics[metric.first] += metric.second / measuredFrames;
+            }
+        }
+    }
+
+    if (profilerStarted)
+    {
+        profiler->Stop();
+    }
+
+    Logger::Info("[HeadlessGridTest] %u samples measured", static_cast<uint32>(result.samples.size()));
+    return true;
+}
+
+void HeadlessGridTest::DrawFrame()
+{
+    using namespace DAVA;
+
+    Renderer::BeginFrame();
+    scene->Update(settings.frameDelta);
+    Renderer::GetRenderStats().Reset();
+    scene->Draw();
+    Renderer::EndFrame();
+}
+
+void HeadlessGridTest::CollectMetrics(DAVA::Map<DAVA::String, DAVA::float32>& metrics) const
+{
+    using namespace DAVA;
+
+    metrics.clear();
+
+    const RenderStats& stats = Renderer::GetRenderStats();
+    metrics["visibleRenderObjects"] = static_cast<float32>(stats.visibleRenderObjects);
+    metrics["renderPackets"] = static_cast<float32>(stats.renderPackets3d);
+    metrics["triangles"] = static_cast<float32>(stats.triangles3d);
+    metrics["materialParamBinds"] = static_cast<float32>(stats.materialParamBindCount);
+    for (const auto& layer : stats.layerBatches)
+    {
+        metrics[String("batches.") + layer.first.c_str()] = static_cast<float32>(layer.second);
+    }
+
+    ProfilerCPU* profiler = ProfilerCPU::globalProfiler;
+    if (profiler != nullptr && profiler->IsStarted())
+    {
+        metrics["time.culling"] = static_cast<float32>(profiler->GetLastCounterTime(ProfilerCPUMarkerName::RENDER_PASS_PREPARE_ARRAYS));
+        metrics["time.sceneUpdate"] = static_cast<float32>(profiler->GetLastCounterTime(ProfilerCPUMarkerName::SCENE_UPDATE));
+        metrics["time.sceneDraw"] = static_cast<float32>(profiler->GetLastCounterTime(ProfilerCPUMarkerName::SCENE_DRAW));
+
+        uint32 markersCount = 0;
+        const char* const* markers = HeadlessGridTestDetails::GetSystemMarkers(markersCount);
+        for (uint32 i = 0; i < markersCount; ++i)
+        {
+            // systems missing in scene are not reported
+            uint64 time = profiler->GetLastCounterTime(markers[i]);
+            if (time > 0)
+            {
+                metrics[String("time.") + markers[i]] = static_cast<float32>(time);
+            }
+        }
+    }
+}
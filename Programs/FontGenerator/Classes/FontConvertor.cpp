@@ -1,9 +1,16 @@
 #include "FontConvertor.h"
+#include "DistanceField/DistanceField.h"
 #include "TtfFont.h"
 
 #include "BinPacker/BinPacker.hpp"
 #include "LodePng/lodepng.h"
 
+#include <Concurrency/Atomic.h>
+#include <Concurrency/LockGuard.h>
+#include <Concurrency/Mutex.h>
+#include <Concurrency/Thread.h>
+#include <Platform/DeviceInfo.h>
+#include <Time/SystemTimer.h>
 #include <Utils/UTF8Utils.h>
 
 #include <assert.h>
@@ -28,6 +35,9 @@ FontConvertor::Params::Params()
     , textureSize(-1)
     , charmap(-1)
     , output(TYPE_DISTANCE_FIELD)
+    , algorithm(ALGORITHM_INVALID)
+    , threads(-1)
+    , verifyTolerance(-1)
 {
 }
 
@@ -42,6 +52,8 @@ FontConvertor::Params FontConvertor::Params::GetDefault()
     params.spread = 2;
     params.textureSize = 512;
     params.charmap = 0;
+    params.algorithm = ALGORITHM_EDT;
+    params.threads = DeviceInfo::GetCpuCount();
 
     return params;
 }
@@ -78,6 +90,20 @@ FontConvertor::eOutputType FontConvertor::TypeFromString(const String& str)
     return FontConvertor::TYPE_INVALID;
 }
 
+FontConvertor::eDistanceFieldAlgorithm FontConvertor::AlgorithmFromString(const String& str)
+{
+    if (str == "edt")
+    {
+        return FontConvertor::ALGORITHM_EDT;
+    }
+    else if (str == "bruteforce")
+    {
+        return FontConvertor::ALGORITHM_BRUTE_FORCE;
+    }
+
+    return FontConvertor::ALGORITHM_INVALID;
+}
+
 FontConvertor::FontConvertor()
     : font(new TtfFont())
 {
@@ -125,6 +151,14 @@ void FontConvertor::InitWithParams(Params _params)
     {
         _params.output = def.output;
     }
+    if (_params.algorithm <= ALGORITHM_INVALID || _params.algorithm >= ALGORITHMS_COUNT)
+    {
+        _params.algorithm = def.algorithm;
+    }
+    if (_params.threads <= 0)
+    {
+        _params.threads = max(1, def.threads);
+    }
 
     params = _params;
 
@@ -190,7 +224,10 @@ bool FontConvertor::Convert()
     cout << " Done" << endl;
 
     FillKerning();
-    GenerateOutputImage();
+    if (!GenerateOutputImage())
+    {
+        return false;
+    }
     GenerateFontDescription();
 
     return true;
@@ -496,161 +533,68 @@ bool FontConvertor::AdjustTextureSize(int32& size)
     return true;
 }
 
-void FontConvertor::GenerateOutputImage()
+bool FontConvertor::GenerateOutputImage()
 {
     cout << "Converting..." << endl;
 
-    auto oldSize = font->GetSize();
-    font->SetSize(params.fontSize * params.scale);
-    auto& face = font->GetFace();
-
     Vector<uint8> imgData(4 * params.textureSize * params.textureSize, 0);
 
-    auto percentDone = 0;
-
-    int i = 0;
-    auto iter = charGlyphPairs.begin();
-    const auto iterEnd = charGlyphPairs.end();
-    for (; iter != iterEnd; ++iter)
-    {
-        int glyphIndex = iter->second;
-
-        auto err = FT_Load_Glyph(face, glyphIndex, 0);
-        if (!err)
+    // FreeType face can't be used from several threads, so every worker renders glyphs with its own font instance.
+    // Each glyph is written to its own rect of the image, so result doesn't depend on threads count.
+    auto glyphsCount = static_cast<int32>(charGlyphPairs.size());
+    auto threadsCount = max(1, min(params.threads, glyphsCount));
+
+    Atomic<int32> nextGlyph(0);
+    Atomic<int32> convertedCount(0);
+    Atomic<int32> finishedCount(0);
+    Atomic<int32> failedCount(0);
+    Mutex differenceMutex;
+    GlyphDifference difference;
+
+    auto worker = [&]() {
+        TtfFont glyphFont;
+        if (glyphFont.Init(params.filename))
         {
-            uint8* charBuf = nullptr;
-            auto charWidth = 0;
-            auto charHeight = 0;
+            glyphFont.SetCharMap(params.charmap);
+            glyphFont.SetSize(params.fontSize * params.scale);
 
-            if (iter->first == NOT_DEF_CHAR) // Draw NOT_DEF_CHAR
+            GlyphDifference threadDifference;
+            for (auto index = nextGlyph++; index < glyphsCount; index = nextGlyph++)
             {
-                auto leading = static_cast<float32>(face->size->metrics.height + face->size->metrics.descender) / 64.f;
-                auto glyphWidth = static_cast<int32>(face->glyph->advance.x) / 64;
-                auto glyphHeight = static_cast<int32>(leading * 0.75f);
-
-                //	oversize the holding buffer by spread value to be filled in with distance blur
-                charWidth = glyphWidth + params.scale * (params.spread * 2);
-                charHeight = glyphHeight + params.scale * (params.spread * 2);
+                ConvertGlyph(&glyphFont, charGlyphPairs[index].first, charGlyphPairs[index].second, imgData, threadDifference);
+                ++convertedCount;
+            }
 
-                charBuf = new uint8[charWidth * charHeight];
-                memset(charBuf, 0, sizeof(uint8) * charWidth * charHeight);
+            LockGuard<Mutex> lock(differenceMutex);
+            difference.maxDifference = max(difference.maxDifference, threadDifference.maxDifference);
+            difference.differenceSum += threadDifference.differenceSum;
+            difference.pixelsCount += threadDifference.pixelsCount;
+            difference.glyphsAboveTolerance += threadDifference.glyphsAboveTolerance;
+        }
+        else
+        {
+            ++failedCount;
+        }
+        ++finishedCount;
+    };
 
-                // Draw NOT_DEF_CHAR as rect
-                auto lineWidth = min(charWidth, charHeight);
-                lineWidth = max(1, lineWidth / 8);
-                for (auto j = 0; j < glyphHeight; ++j)
-                {
-                    for (auto i = 0; i < lineWidth; ++i)
-                    {
-                        auto y = (j + params.scale * params.spread) * charWidth;
-                        auto x = i + params.scale * params.spread;
-
-                        charBuf[y + x] = 255;
-                        charBuf[y + (charWidth - 1) - x] = 255;
-                    }
-                }
-                auto maxY = (charHeight - 1) * charWidth;
-                for (auto i = 0; i < glyphWidth; ++i)
-                {
-                    for (auto j = 0; j < lineWidth; ++j)
-                    {
-                        auto y = (j + params.scale * params.spread) * charWidth;
-                        auto x = i + params.scale * params.spread;
-
-                        charBuf[y + x] = 255;
-                        charBuf[maxY - y + x] = 255;
-                    }
-                }
-            }
-            else
-            {
-                err = FT_Render_Glyph(face->glyph, params.output == TYPE_DISTANCE_FIELD ? FT_RENDER_MODE_MONO : FT_RENDER_MODE_NORMAL);
-                if (!err)
-                {
-                    auto glyphWidth = face->glyph->bitmap.width;
-                    auto glyphHeight = face->glyph->bitmap.rows;
-
-                    // Oversize the holding buffer by spread value to be filled in with distance blur
-                    charWidth = glyphWidth + params.scale * (params.spread * 2);
-                    charHeight = glyphHeight + params.scale * (params.spread * 2);
-
-                    charBuf = new uint8[charWidth * charHeight];
-                    memset(charBuf, 0, sizeof(uint8) * charWidth * charHeight);
-
-                    // Copy the glyph into the buffer to be smoothed
-                    auto glyphPitch = face->glyph->bitmap.pitch;
-                    auto& glyphBuf = face->glyph->bitmap.buffer;
-
-                    if (params.output == TYPE_DISTANCE_FIELD)
-                    {
-                        for (auto j = 0U; j < glyphHeight; ++j)
-                        {
-                            for (auto i = 0U; i < glyphWidth; ++i)
-                            {
-                                //check if corresponding bit is set
-                                auto glyphVal = glyphBuf[j * glyphPitch + (i >> 3)];
-                                auto val = (glyphVal >> (7 - (i & 7))) & 1;
-
-                                auto x = i + params.scale * params.spread;
-                                auto y = (j + params.scale * params.spread) * charWidth;
-                                charBuf[y + x] = 255 * val;
-                            }
-                        }
-                    }
-                    else //params.output == TYPE_GRAPHIC
-                    {
-                        for (auto j = 0U; j < glyphHeight; ++j)
-                        {
-                            for (auto i = 0U; i < glyphWidth; ++i)
-                            {
-                                auto x = i + params.scale * params.spread;
-                                auto y = (j + params.scale * params.spread) * charWidth;
-                                charBuf[y + x] = glyphBuf[j * glyphPitch + i];
-                            }
-                        }
-                    }
-                }
-            }
+    auto startTime = SystemTimer::GetMs();
 
-            auto& desc = chars[iter->first];
-            if (params.output == TYPE_DISTANCE_FIELD)
-            {
-                auto* distanceBuf = BuildDistanceField(charBuf, charWidth, charHeight);
-                for (auto i = 0; i < desc.height; ++i)
-                {
-                    auto offset = ((desc.y + i) * params.textureSize + desc.x) * 4;
-                    for (auto j = 0; j < desc.width; ++j)
-                    {
-                        imgData[offset + 0] = 0xff;
-                        imgData[offset + 1] = 0xff;
-                        imgData[offset + 2] = 0xff;
-                        imgData[offset + 3] = distanceBuf[i * desc.width + j];
-                        offset += 4;
-                    }
-                }
-                delete[] distanceBuf;
-            }
-            else //params.output == TYPE_GRAPHIC
-            {
-                for (auto i = 0; i < desc.height; ++i)
-                {
-                    auto offset = ((desc.y + i) * params.textureSize + desc.x) * 4;
-                    for (auto j = 0; j < desc.width; ++j)
-                    {
-                        imgData[offset + 0] = 0xff;
-                        imgData[offset + 1] = 0xff;
-                        imgData[offset + 2] = 0xff;
-                        imgData[offset + 3] = charBuf[i * desc.width + j];
-                        offset += 4;
-                    }
-                }
-            }
+    Vector<Thread*> threads;
+    for (auto i = 0; i < threadsCount; ++i)
+    {
+        Thread* thread = Thread::Create(worker);
+        thread->SetName("FontConvertor");
+        thread->Start();
+        threads.push_back(thread);
+    }
 
-            delete[] charBuf;
-        }
+    auto percentDone = 0;
+    while (finishedCount.Get() < threadsCount)
+    {
+        Thread::Sleep(100);
 
-        // Calculate process
-        auto p = static_cast<int32>(floor((static_cast<float32>(i++) / charGlyphPairs.size()) * 100.f));
+        auto p = static_cast<int32>(floor((static_cast<float32>(convertedCount.Get()) / glyphsCount) * 100.f));
         if (p > percentDone)
         {
             cout << setw(3) << p << "% converted" << endl;
@@ -658,8 +602,19 @@ void FontConvertor::GenerateOutputImage()
         }
     }
 
-    font->SetSize(oldSize);
-    cout << " Done" << endl;
+    for (Thread* thread : threads)
+    {
+        thread->Join();
+        SafeRelease(thread);
+    }
+
+    cout << " Done: " << convertedCount.Get() << " glyphs in " << (SystemTimer::GetMs() - startTime) << " ms, " << threadsCount << " threads" << endl;
+
+    if (failedCount.Get() > 0)
+    {
+        cerr << "Error: font can't be opened by converting thread" << endl;
+        return false;
+    }
 
     cout << "Storing image...";
     Vector<uint8> buffer;
@@ -668,70 +623,205 @@ void FontConvertor::GenerateOutputImage()
     encoder.encode(buffer, imgData, params.textureSize, params.textureSize);
     LodePNG::saveFile(buffer, params.filename + ".png");
     cout << " Done" << endl;
+
+    if (params.output == TYPE_DISTANCE_FIELD && params.verifyTolerance >= 0)
+    {
+        auto meanDifference = difference.pixelsCount > 0 ? static_cast<float64>(difference.differenceSum) / difference.pixelsCount : 0.0;
+        cout << "Difference from brute force distance field: max " << difference.maxDifference << ", mean " << meanDifference;
+        cout << ", " << difference.glyphsAboveTolerance << " glyphs above tolerance " << params.verifyTolerance << endl;
+
+        if (difference.maxDifference > params.verifyTolerance)
+        {
+            cerr << "Error: distance field differs from reference more than allowed" << endl;
+            return false;
+        }
+    }
+
+    return true;
 }
 
-uint8* FontConvertor::BuildDistanceField(const uint8* inputBuf, int32 inWidth, int32 inHeight)
+bool FontConvertor::IsMonochromeRender() const
 {
-    auto outWidth = inWidth / params.scale;
-    auto outHeight = inHeight / params.scale;
+    return params.output == TYPE_DISTANCE_FIELD && params.algorithm == ALGORITHM_BRUTE_FORCE;
+}
 
-    auto* outBuf = new uint8[outWidth * outHeight];
+bool FontConvertor::RasterizeGlyph(TtfFont* glyphFont, int32 charId, int32 glyphIndex, bool monochrome, Vector<uint8>& charBuf, int32& charWidth, int32& charHeight) const
+{
+    auto& face = glyphFont->GetFace();
+
+    auto err = FT_Load_Glyph(face, glyphIndex, 0);
+    if (err)
+    {
+        return false;
+    }
 
-    for (auto y = 0; y < outHeight; ++y)
+    if (charId == NOT_DEF_CHAR) // Draw NOT_DEF_CHAR
     {
-        for (auto x = 0; x < outWidth; ++x)
+        auto leading = static_cast<float32>(face->size->metrics.height + face->size->metrics.descender) / 64.f;
+        auto glyphWidth = static_cast<int32>(face->glyph->advance.x) / 64;
+        auto glyphHeight = static_cast<int32>(leading * 0.75f);
+
+        //	oversize the holding buffer by spread value to be filled in with distance blur
+        charWidth = glyphWidth + params.scale * (params.spread * 2);
+        charHeight = glyphHeight + params.scale * (params.spread * 2);
+
+        charBuf.assign(charWidth * charHeight, 0);
+
+        // Draw NOT_DEF_CHAR as rect
+        auto lineWidth = min(charWidth, charHeight);
+        lineWidth = max(1, lineWidth / 8);
+        for (auto j = 0; j < glyphHeight; ++j)
         {
-            auto centerX = x * params.scale + params.scale / 2;
-            auto centerY = y * params.scale + params.scale / 2;
+            for (auto i = 0; i < lineWidth; ++i)
+            {
+                auto y = (j + params.scale * params.spread) * charWidth;
+                auto x = i + params.scale * params.spread;
+
+                charBuf[y + x] = 255;
+                charBuf[y + (charWidth - 1) - x] = 255;
+            }
+        }
+        auto maxY = (charHeight - 1) * charWidth;
+        for (auto i = 0; i < glyphWidth; ++i)
+        {
+            for (auto j = 0; j < lineWidth; ++j)
+            {
+                auto y = (j + params.scale * params.spread) * charWidth;
+                auto x = i + params.scale * params.spread;
 
-            auto dist = FindSignedDistance(centerX, centerY, inputBuf, inWidth, inHeight);
-            outBuf[y * outWidth + x] = DistanceToAlpha(dist);
+                charBuf[y + x] = 255;
+                charBuf[maxY - y + x] = 255;
+            }
         }
+
+        return true;
     }
 
-    return outBuf;
-}
+    err = FT_Render_Glyph(face->glyph, monochrome ? FT_RENDER_MODE_MONO : FT_RENDER_MODE_NORMAL);
+    if (err)
+    {
+        return false;
+    }
 
-uint8 FontConvertor::DistanceToAlpha(float32 distance)
-{
-    auto alpha = 0.5f + 0.5f * (distance / (params.spread * params.scale));
-    alpha = min(1.f, max(0.f, alpha));
-    return static_cast<uint8>(alpha * 0xff);
+    auto glyphWidth = face->glyph->bitmap.width;
+    auto glyphHeight = face->glyph->bitmap.rows;
+
+    // Oversize the holding buffer by spread value to be filled in with distance blur
+    charWidth = glyphWidth + params.scale * (params.spread * 2);
+    charHeight = glyphHeight + params.scale * (params.spread * 2);
+
+    charBuf.assign(charWidth * charHeight, 0);
+
+    // Copy the glyph into the buffer to be smoothed
+    auto glyphPitch = face->glyph->bitmap.pitch;
+    auto& glyphBuf = face->glyph->bitmap.buffer;
+
+    for (auto j = 0U; j < glyphHeight; ++j)
+    {
+        for (auto i = 0U; i < glyphWidth; ++i)
+        {
+            auto x = i + params.scale * params.spread;
+            auto y = (j + params.scale * params.spread) * charWidth;
+
+            if (monochrome)
+            {
+                //check if corresponding bit is set
+                auto glyphVal = glyphBuf[j * glyphPitch + (i >> 3)];
+                auto val = (glyphVal >> (7 - (i & 7))) & 1;
+                charBuf[y + x] = 255 * val;
+            }
+            else
+            {
+                charBuf[y + x] = glyphBuf[j * glyphPitch + i];
+            }
+        }
+    }
+
+    return true;
 }
 
-float32 FontConvertor::FindSignedDistance(int32 centerX, int32 centerY, const uint8* inputBuf, int32 width, int32 height)
+void FontConvertor::ConvertGlyph(TtfFont* glyphFont, int32 charId, int32 glyphIndex, Vector<uint8>& imgData, GlyphDifference& difference) const
 {
-    auto baseVal = inputBuf[centerY * width + centerX] != 0;
-    auto scaledSpread = params.spread * params.scale;
+    auto descIt = chars.find(charId);
+    if (descIt == chars.end())
+    {
+        return;
+    }
+    const auto& desc = descIt->second;
 
-    auto startX = max(0, centerX - scaledSpread);
-    auto endX = min(width - 1, centerX + scaledSpread);
-    auto startY = max(0, centerY - scaledSpread);
-    auto endY = min(height - 1, centerY + scaledSpread);
+    Vector<uint8> charBuf;
+    auto charWidth = 0;
+    auto charHeight = 0;
+    if (!RasterizeGlyph(glyphFont, charId, glyphIndex, IsMonochromeRender(), charBuf, charWidth, charHeight))
+    {
+        return;
+    }
 
-    auto minSquareDist = scaledSpread * scaledSpread;
+    const uint8* alphaBuf = charBuf.data();
+    auto alphaWidth = charWidth;
+    auto alphaHeight = charHeight;
 
-    for (auto y = startY; y <= endY; ++y)
+    Vector<uint8> distanceBuf;
+    if (params.output == TYPE_DISTANCE_FIELD)
     {
-        for (auto x = startX; x <= endX; ++x)
+        if (params.algorithm == ALGORITHM_EDT)
         {
-            auto curVal = inputBuf[y * width + x] != 0;
-            if (baseVal != curVal)
-            {
-                auto dx = centerX - x;
-                auto dy = centerY - y;
-                auto squareDist = dx * dx + dy * dy;
+            DistanceField::BuildEdt(charBuf.data(), charWidth, charHeight, params.scale, params.spread, distanceBuf);
+        }
+        else
+        {
+            DistanceField::BuildBruteForce(charBuf.data(), charWidth, charHeight, params.scale, params.spread, distanceBuf);
+        }
 
-                if (squareDist < minSquareDist)
+        alphaBuf = distanceBuf.data();
+        alphaWidth = charWidth / params.scale;
+        alphaHeight = charHeight / params.scale;
+
+        Vector<uint8> referenceCharBuf;
+        auto referenceWidth = 0;
+        auto referenceHeight = 0;
+        if (params.verifyTolerance >= 0 && RasterizeGlyph(glyphFont, charId, glyphIndex, true, referenceCharBuf, referenceWidth, referenceHeight))
+        {
+            Vector<uint8> referenceBuf;
+            DistanceField::BuildBruteForce(referenceCharBuf.data(), referenceWidth, referenceHeight, params.scale, params.spread, referenceBuf);
+            referenceWidth /= params.scale;
+            referenceHeight /= params.scale;
+
+            // Anti-aliased bitmap can be a texel bigger than monochrome one, so only common part is compared
+            auto glyphMaxDifference = 0;
+            for (auto i = 0; i < min(alphaHeight, referenceHeight); ++i)
+            {
+                for (auto j = 0; j < min(alphaWidth, referenceWidth); ++j)
                 {
-                    minSquareDist = squareDist;
+                    auto diff = abs(static_cast<int32>(distanceBuf[i * alphaWidth + j]) - static_cast<int32>(referenceBuf[i * referenceWidth + j]));
+                    glyphMaxDifference = max(glyphMaxDifference, diff);
+                    difference.differenceSum += diff;
+                    ++difference.pixelsCount;
                 }
             }
+
+            difference.maxDifference = max(difference.maxDifference, glyphMaxDifference);
+            if (glyphMaxDifference > params.verifyTolerance)
+            {
+                ++difference.glyphsAboveTolerance;
+            }
         }
     }
 
-    auto minDist = sqrtf(static_cast<float32>(minSquareDist));
-    return (baseVal ? 1.f : -1.f) * min(minDist, static_cast<float32>(scaledSpread));
+    auto width = min(desc.width, alphaWidth);
+    auto height = min(desc.height, alphaHeight);
+    for (auto i = 0; i < height; ++i)
+    {
+        auto offset = ((desc.y + i) * params.textureSize + desc.x) * 4;
+        for (auto j = 0; j < width; ++j)
+        {
+            imgData[offset + 0] = 0xff;
+            imgData[offset + 1] = 0xff;
+            imgData[offset + 2] = 0xff;
+            imgData[offset + 3] = alphaBuf[i * alphaWidth + j];
+            offset += 4;
+        }
+    }
 }
 
 bool FontConvertor::GeneratePackedList(int32 fontSize, int32 textureSize)
@@ -739,7 +829,7 @@ bool FontConvertor::GeneratePackedList(int32 fontSize, int32 textureSize)
     chars.clear();
 
     Vector<int32> rectInfo;
-    auto renderMode = params.output == TYPE_DISTANCE_FIELD ? FT_RENDER_MODE_MONO : FT_RENDER_MODE_NORMAL;
+    auto renderMode = IsMonochromeRender() ? FT_RENDER_MODE_MONO : FT_RENDER_MODE_NORMAL;
 
     auto oldSize = font->GetSize();
     font->SetSize(fontSize * params.scale);
@@ -22,6 +22,14 @@ public:
         TYPES_COUNT
     };
 
+    enum eDistanceFieldAlgorithm
+    {
+        ALGORITHM_INVALID = -1,
+        ALGORITHM_EDT = 0, // exact distance transform over anti-aliased glyph
+        ALGORITHM_BRUTE_FORCE, // window search over monochrome glyph, reference for verification
+        ALGORITHMS_COUNT
+    };
+
     struct Params
     {
         eModes mode;
@@ -34,6 +42,9 @@ public:
         DAVA::int32 fontSize;
         DAVA::int32 textureSize;
         DAVA::int32 charmap;
+        eDistanceFieldAlgorithm algorithm;
+        DAVA::int32 threads;
+        DAVA::int32 verifyTolerance; // compare distance field with brute force one if not negative
 
         Params();
         static Params GetDefault();
@@ -49,6 +60,7 @@ public:
 
     static eModes ModeFromString(const DAVA::String& str);
     static eOutputType TypeFromString(const DAVA::String& str);
+    static eDistanceFieldAlgorithm AlgorithmFromString(const DAVA::String& str);
 
     bool Convert();
 
@@ -66,6 +78,14 @@ private:
         DAVA::Map<DAVA::int32, DAVA::float32> kernings;
     };
 
+    struct GlyphDifference
+    {
+        DAVA::int32 maxDifference = 0;
+        DAVA::uint64 differenceSum = 0;
+        DAVA::uint64 pixelsCount = 0;
+        DAVA::int32 glyphsAboveTolerance = 0;
+    };
+
 private:
     Params params;
     TtfFont* font;
@@ -79,12 +99,12 @@ private:
     void LoadCharList(DAVA::Vector<DAVA::int32>& charList);
 
     bool GeneratePackedList(DAVA::int32 fontSize, DAVA::int32 textureSize);
-    void GenerateOutputImage();
+    bool GenerateOutputImage();
     void GenerateFontDescription();
 
-    DAVA::uint8* BuildDistanceField(const DAVA::uint8* inputBuf, DAVA::int32 inWidth, DAVA::int32 inHeight);
-    DAVA::float32 FindSignedDistance(DAVA::int32 centerX, DAVA::int32 centerY, const DAVA::uint8* inputBuf, DAVA::int32 width, DAVA::int32 height);
-    DAVA::uint8 DistanceToAlpha(DAVA::float32 distance);
+    bool IsMonochromeRender() const;
+    bool RasterizeGlyph(TtfFont* glyphFont, DAVA::int32 charId, DAVA::int32 glyphIndex, bool monochrome, DAVA::Vector<DAVA::uint8>& charBuf, DAVA::int32& charWidth, DAVA::int32& charHeight) const;
+    void ConvertGlyph(TtfFont* glyphFont, DAVA::int32 charId, DAVA::int32 glyphIndex, DAVA::Vector<DAVA::uint8>& imgData, GlyphDifference& difference) const;
 
     bool AdjustFontSize(DAVA::int32& size);
     bool AdjustTextureSize(DAVA::int32& size);
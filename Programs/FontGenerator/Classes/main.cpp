@@ -58,6 +58,22 @@ void Usage()
     cout << "         dff - distance field font" << endl;
     cout << "         gf - anti-aliasing graphic font" << endl;
     cout << endl;
+    cout << "dfalgorithm=(edt | bruteforce) - distance field algorithm. Default: edt" << endl;
+    cout << "         edt - linear time euclidean distance transform of anti-aliased glyph" << endl;
+    cout << "         bruteforce - window search over monochrome glyph, slow" << endl;
+    cout << endl;
+    cout << "threads=N - number of converting threads. Default: number of CPU cores" << endl;
+    cout << "            Result doesn't depend on threads count" << endl;
+    cout << endl;
+    cout << "verify=N - compares every distance field glyph with bruteforce result" << endl;
+    cout << "           Fails if any alpha value differs by more than N" << endl;
+    cout << "           Example of regression test: fontgenerator font=arial.ttf verify=16" << endl;
+    cout << endl;
+    cout << "Conversion time is printed, so big font can be used as a benchmark:" << endl;
+    cout << "fontgenerator font=cjk_font.ttf maxchar=20000 fontsize=24 texturesize=4096" << endl;
+    cout << "Reproducible accuracy tests and benchmark on synthetic glyphs are in UnitTests:" << endl;
+    cout << "UnitTests -only_test DistanceFieldTest" << endl;
+    cout << endl;
     cout << endl;
 }
 
@@ -124,6 +140,18 @@ int DAVAMain(Vector<String> cmdline)
             {
                 params.output = FontConvertor::TypeFromString(val[1]);
             }
+            else if (val[0] == "dfalgorithm")
+            {
+                params.algorithm = FontConvertor::AlgorithmFromString(val[1]);
+            }
+            else if (val[0] == "threads")
+            {
+                params.threads = stoi(val[1]);
+            }
+            else if (val[0] == "verify")
+            {
+                params.verifyTolerance = stoi(val[1]);
+            }
             else
             {
                 cout << "Invalid token: " << val[0] << endl;
@@ -0,0 +1,189 @@
+#include "HeadlessFlowController.h"
+#include "Infrastructure/GameCore.h"
+
+#include "Debug/ProfilerCPU.h"
+#include "Debug/ProfilerMarkerNames.h"
+#include "MemoryManager/MemoryManager.h"
+#include "Render/Renderer.h"
+
+namespace HeadlessFlowControllerDetails
+{
+bool GetAllocationsCount(uint32& count)
+{
+#if defined(DAVA_MEMORY_PROFILING_ENABLE)
+    MemoryManager* memoryManager = MemoryManager::Instance();
+    Vector<uint8> buffer(memoryManager->CalcCurStatSize());
+    memoryManager->GetCurStat(0, buffer.data(), static_cast<uint32>(buffer.size()));
+
+    const MMCurStat* stat = reinterpret_cast<const MMCurStat*>(buffer.data());
+    count = stat->statGeneral.nextBlockNo;
+    return true;
+#else
+    count = 0;
+    return false;
+#endif
+}
+}
+
+const Vector<const char*> HeadlessFlowController::PROFILER_MARKERS =
+{
+  ProfilerCPUMarkerName::SCENE_UPDATE,
+  ProfilerCPUMarkerName::SCENE_DRAW,
+  ProfilerCPUMarkerName::SCENE_TRANSFORM_SYSTEM,
+  ProfilerCPUMarkerName::SCENE_LOD_SYSTEM,
+  ProfilerCPUMarkerName::SCENE_SWITCH_SYSTEM,
+  ProfilerCPUMarkerName::SCENE_PARTICLE_SYSTEM,
+  ProfilerCPUMarkerName::SCENE_RENDER_UPDATE_SYSTEM,
+  ProfilerCPUMarkerName::SCENE_ANIMATION_SYSTEM,
+  ProfilerCPUMarkerName::SCENE_SKELETON_SYSTEM,
+  ProfilerCPUMarkerName::SCENE_MOTION_SYSTEM,
+  ProfilerCPUMarkerName::SCENE_LANDSCAPE_SYSTEM,
+  ProfilerCPUMarkerName::SCENE_FOLIAGE_SYSTEM,
+  ProfilerCPUMarkerName::SCENE_SPEEDTREE_SYSTEM,
+  ProfilerCPUMarkerName::SCENE_WIND_SYSTEM,
+  ProfilerCPUMarkerName::SCENE_WAVE_SYSTEM,
+  ProfilerCPUMarkerName::RENDER_PASS_PREPARE_ARRAYS,
+  ProfilerCPUMarkerName::RENDER_PASS_DRAW_LAYERS,
+  ProfilerCPUMarkerName::RENDER_PREPARE_LANDSCAPE,
+};
+
+HeadlessFlowController::HeadlessFlowController(const Settings& settings_)
+    : settings(settings_)
+{
+}
+
+void HeadlessFlowController::Init(const Vector<BaseTest*>& testChain_)
+{
+    TestFlowController::Init(testChain_);
+
+    for (BaseTest* test : testChain)
+    {
+        BaseTest::TestParams params = test->GetParams();
+        params.targetFramesCount = settings.warmupFrames + settings.measuredFrames;
+        params.targetFrameDelta = settings.frameDelta;
+        params.targetTime = 0;
+        params.startTime = 0;
+        params.endTime = std::numeric_limits<int32>::max();
+        test->MergeParams(params);
+    }
+}
+
+void HeadlessFlowController::Update(float32 delta)
+{
+    using namespace HeadlessFlowControllerDetails;
+
+    if (finished)
+    {
+        return;
+    }
+
+    if (currentTestIndex == testChain.size())
+    {
+        FinishAll();
+        return;
+    }
+
+    BaseTest* test = testChain[currentTestIndex];
+    if (!currentTestStarted)
+    {
+        StartTest(test);
+    }
+
+    uint32 allocationsBefore = 0;
+    bool hasAllocations = GetAllocationsCount(allocationsBefore);
+
+    int64 frameStart = SystemTimer::GetUs();
+    Renderer::BeginFrame();
+    test->UpdateHeadless(settings.frameDelta);
+    Renderer::EndFrame();
+    int64 frameTime = SystemTimer::GetUs() - frameStart;
+
+    uint32 allocationsAfter = 0;
+    GetAllocationsCount(allocationsAfter);
+
+    uint32 testFrame = static_cast<uint32>(test->GetTestFrameNumber());
+    if (testFrame > settings.warmupFrames)
+    {
+        currentResult.frameTimes.push_back(frameTime / 1000.0f);
+        if (hasAllocations)
+        {
+            currentResult.allocations.push_back(static_cast<float32>(allocationsAfter - allocationsBefore));
+        }
+
+        for (const char* marker : PROFILER_MARKERS)
+        {
+            uint64 markerTime = ProfilerCPU::globalProfiler->GetLastCounterTime(marker);
+            if (markerTime > 0)
+            {
+                currentResult.markerTimes[marker].push_back(static_cast<float32>(markerTime));
+            }
+        }
+    }
+
+    if (test->IsFinished())
+    {
+        FinishTest(test);
+    }
+}
+
+void HeadlessFlowController::StartTest(BaseTest* test)
+{
+    Random::Instance()->Seed(settings.randomSeed);
+
+    test->LoadHeadless(settings.viewportSize);
+    test->OnStart();
+
+    currentResult = HeadlessReport::TestResult();
+    // Scene name shown in UI may be overridden (e.g. by MaterialsTest) and is not unique
+    currentResult.testName = test->GetTestName() + ": " + test->GetParams().sceneName;
+    currentTestStarted = true;
+
+    ProfilerCPU::globalProfiler->Start();
+}
+
+void HeadlessFlowController::FinishTest(BaseTest* test)
+{
+    ProfilerCPU::globalProfiler->Stop();
+
+    test->OnFinish();
+    test->UnloadHeadless();
+
+    report.AddResult(std::move(currentResult));
+
+    currentTestStarted = false;
+    currentTestIndex++;
+}
+
+void HeadlessFlowController::FinishAll()
+{
+    finished = true;
+
+    if (!report.Save(settings.outputPath))
+    {
+        Logger::Error("Can't save results to %s", settings.outputPath.GetAbsolutePathname().c_str());
+    }
+    else
+    {
+        Logger::Info("Results saved to %s", settings.outputPath.GetAbsolutePathname().c_str());
+    }
+
+    int32 exitCode = 0;
+    if (!settings.baselinePath.IsEmpty())
+    {
+        HeadlessReport baseline;
+        if (baseline.Load(settings.baselinePath))
+        {
+            uint32 regressions = report.CompareWithBaseline(baseline, settings.comparisonBlockFrames, settings.significanceLevel, settings.minRelativeChange);
+            Logger::Info("Significant regressions: %u", regressions);
+            exitCode = regressions > 0 ? 1 : 0;
+        }
+        else
+        {
+            Logger::Error("Can't load baseline %s", settings.baselinePath.GetAbsolutePathname().c_str());
+            exitCode = 1;
+        }
+    }
+
+    Logger::Info("Finish all tests.");
+    GameCore::Instance()->Quit(exitCode);
+}
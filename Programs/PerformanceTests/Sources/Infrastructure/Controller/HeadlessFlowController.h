@@ -0,0 +1,53 @@
+#pragma once
+
+#include "TestFlowController.h"
+#include "PerformanceStatistics/HeadlessReport.h"
+
+/**
+    Runs test chain without window and UI on Null renderer (console mode).
+    Every test is run with fixed frame delta and random seed, first `warmupFrames` frames are excluded from statistics.
+    Per-frame CPU time, allocations count and ProfilerCPU markers are collected into `HeadlessReport`,
+    which is saved to `outputPath` and compared against report stored at `baselinePath` if it is set.
+    Comparison is done on medians of `comparisonBlockFrames`-frame blocks, so default 600 measured frames give 20 observations per metric.
+*/
+class HeadlessFlowController : public TestFlowController
+{
+public:
+    struct Settings
+    {
+        uint32 warmupFrames = 60;
+        uint32 measuredFrames = 600;
+        float32 frameDelta = 1.0f / 60.0f;
+        uint32 randomSeed = 0;
+        Size2i viewportSize = Size2i(1024, 768);
+
+        FilePath outputPath = "~doc:/PerformanceResults.yaml";
+        FilePath baselinePath;
+        uint32 comparisonBlockFrames = 30;
+        float64 significanceLevel = 0.01;
+        float32 minRelativeChange = 0.02f;
+    };
+
+    HeadlessFlowController(const Settings& settings);
+
+    void Init(const Vector<BaseTest*>& testChain) override;
+    void Update(float32 delta) override;
+
+    void BeginFrame() override{};
+    void EndFrame() override{};
+
+    static const Vector<const char*> PROFILER_MARKERS;
+
+private:
+    void StartTest(BaseTest* test);
+    void FinishTest(BaseTest* test);
+    void FinishAll();
+
+    Settings settings;
+    HeadlessReport report;
+    HeadlessReport::TestResult currentResult;
+
+    uint32 currentTestIndex = 0;
+    bool currentTestStarted = false;
+    bool finished = false;
+};
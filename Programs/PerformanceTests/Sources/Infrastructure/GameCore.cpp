@@ -27,14 +27,25 @@ GameCore::GameCore(DAVA::Engine& e)
     DVASSERT(instance == nullptr);
     instance = this;
 
+    // Headless mode runs in console mode on Null renderer, where only `update` signal is emitted
+    headless = engine.IsConsoleMode();
+
     engine.gameLoopStarted.Connect(this, &GameCore::OnAppStarted);
     engine.gameLoopStopped.Connect(this, &GameCore::OnAppFinished);
-    engine.windowCreated.Connect(this, &GameCore::OnWindowCreated);
-    engine.suspended.Connect(this, &GameCore::OnSuspend);
-    engine.resumed.Connect(this, &GameCore::OnResume);
-    engine.beginFrame.Connect(this, &GameCore::BeginFrame);
-    engine.endFrame.Connect(this, &GameCore::EndFrame);
     engine.cleanup.Connect(this, &GameCore::Cleanup);
+
+    if (headless)
+    {
+        engine.update.Connect(this, &GameCore::Update);
+    }
+    else
+    {
+        engine.windowCreated.Connect(this, &GameCore::OnWindowCreated);
+        engine.suspended.Connect(this, &GameCore::OnSuspend);
+        engine.resumed.Connect(this, &GameCore::OnResume);
+        engine.beginFrame.Connect(this, &GameCore::BeginFrame);
+        engine.endFrame.Connect(this, &GameCore::EndFrame);
+    }
 }
 
 void GameCore::OnAppStarted()
@@ -93,6 +104,11 @@ void GameCore::EndFrame()
     testFlowController->EndFrame();
 }
 
+void GameCore::Update(float32 delta)
+{
+    testFlowController->Update(delta);
+}
+
 void GameCore::RegisterTests()
 {
     // material test
@@ -121,7 +137,12 @@ void GameCore::RegisterTests()
         testChain.push_back(new UniversalTest(params));
     }
 
-    // loading test
+    // loading test measures loading time rather than per-frame cost, so it is not run headless
+    if (headless)
+    {
+        return;
+    }
+
     scenes.clear();
     LoadMaps(LoadingTest::TEST_NAME, scenes);
 
@@ -209,7 +230,27 @@ void GameCore::InitScreenController()
         testForRun = CommandLineParser::Instance()->GetCommandParamAdditional("-test", 0);
     }
 
-    if (chooserFound)
+    if (headless)
+    {
+        HeadlessFlowController::Settings settings;
+        ReadHeadlessSettings(settings);
+
+        if (!testForRun.empty())
+        {
+            auto removeIt = std::remove_if(testChain.begin(), testChain.end(), [&testForRun](BaseTest* test) {
+                bool remove = test->GetSceneName() != testForRun && test->GetTestName() != testForRun;
+                if (remove)
+                {
+                    test->Release();
+                }
+                return remove;
+            });
+            testChain.erase(removeIt, testChain.end());
+        }
+
+        testFlowController = std::unique_ptr<HeadlessFlowController>(new HeadlessFlowController(settings));
+    }
+    else if (chooserFound)
     {
         testFlowController = std::unique_ptr<SingleTestFlowController>(new SingleTestFlowController("", defaultTestParams, !withoutUIFound));
     }
@@ -334,9 +375,71 @@ void GameCore::ReadSingleTestParams(BaseTest::TestParams& params)
     Logger::Info(DAVA::Format("Max delta : %f", params.maxDelta).c_str());
 }
 
-void GameCore::Quit()
+void GameCore::ReadHeadlessSettings(HeadlessFlowController::Settings& settings)
 {
-    engine.QuitAsync(0);
+    CommandLineParser* parser = CommandLineParser::Instance();
+
+    if (parser->CommandIsFound("-headless-warmup"))
+    {
+        settings.warmupFrames = static_cast<uint32>(std::max(0, std::atoi(parser->GetCommandParamAdditional("-headless-warmup", 0).c_str())));
+    }
+
+    if (parser->CommandIsFound("-headless-frames"))
+    {
+        int32 frames = std::atoi(parser->GetCommandParamAdditional("-headless-frames", 0).c_str());
+        if (frames <= 0)
+        {
+            Logger::Error("Incorrect params. Headless frames count <= 0");
+            GameCore::Instance()->Quit(1);
+        }
+        else
+        {
+            settings.measuredFrames = static_cast<uint32>(frames);
+        }
+    }
+
+    if (parser->CommandIsFound("-frame-delta"))
+    {
+        float32 frameDelta = static_cast<float32>(std::atof(parser->GetCommandParamAdditional("-frame-delta", 0).c_str()));
+        if (frameDelta > 0.0f)
+        {
+            settings.frameDelta = frameDelta;
+        }
+    }
+
+    if (parser->CommandIsFound("-headless-output"))
+    {
+        settings.outputPath = parser->GetCommandParamAdditional("-headless-output", 0);
+    }
+
+    if (parser->CommandIsFound("-headless-baseline"))
+    {
+        settings.baselinePath = parser->GetCommandParamAdditional("-headless-baseline", 0);
+    }
+
+    if (parser->CommandIsFound("-headless-block-frames"))
+    {
+        settings.comparisonBlockFrames = static_cast<uint32>(std::max(0, std::atoi(parser->GetCommandParamAdditional("-headless-block-frames", 0).c_str())));
+    }
+
+    if (parser->CommandIsFound("-headless-alpha"))
+    {
+        settings.significanceLevel = std::atof(parser->GetCommandParamAdditional("-headless-alpha", 0).c_str());
+    }
+
+    if (parser->CommandIsFound("-headless-min-change"))
+    {
+        settings.minRelativeChange = static_cast<float32>(std::atof(parser->GetCommandParamAdditional("-headless-min-change", 0).c_str()));
+    }
+
+    Logger::Info(DAVA::Format("Headless warmup frames : %u", settings.warmupFrames).c_str());
+    Logger::Info(DAVA::Format("Headless measured frames : %u", settings.measuredFrames).c_str());
+    Logger::Info(DAVA::Format("Headless frame delta : %f", settings.frameDelta).c_str());
+}
+
+void GameCore::Quit(int32 exitCode)
+{
+    engine.QuitAsync(exitCode);
 }
 
 GameCore* GameCore::instance = nullptr;
@@ -381,6 +484,8 @@ KeyedArchive* CreateOptions()
 
 int DAVAMain(DAVA::Vector<DAVA::String> cmdline)
 {
+    bool headless = std::find(cmdline.begin(), cmdline.end(), "-headless") != cmdline.end();
+
     Assert::AddHandler(Assert::DefaultLoggerHandler);
 
     Vector<String> modules =
@@ -392,7 +497,16 @@ int DAVAMain(DAVA::Vector<DAVA::String> cmdline)
       "DownloadManager",
     };
     DAVA::Engine e;
-    e.Init(eEngineRunMode::GUI_STANDALONE, modules, CreateOptions());
+    if (headless)
+    {
+        KeyedArchive* appOptions = CreateOptions();
+        appOptions->SetInt32("renderer", rhi::RHI_NULL_RENDERER);
+        e.Init(eEngineRunMode::CONSOLE_MODE, modules, appOptions);
+    }
+    else
+    {
+        e.Init(eEngineRunMode::GUI_STANDALONE, modules, CreateOptions());
+    }
 
     GameCore core(e);
     return e.Run();
@@ -7,6 +7,7 @@
 #include "Infrastructure/Controller/TestFlowController.h"
 #include "Infrastructure/Controller/TestChainFlowController.h"
 #include "Infrastructure/Controller/SingleTestFlowController.h"
+#include "Infrastructure/Controller/HeadlessFlowController.h"
 #include "Infrastructure/Settings/GraphicsDetect.h"
 
 #include "Functional/TrackedObject.h"
@@ -35,13 +36,15 @@ public:
 
     void BeginFrame();
     void EndFrame();
+    void Update(float32 delta);
 
-    void Quit();
+    void Quit(int32 exitCode = 0);
 
 private:
     void InitScreenController();
     void RegisterTests();
     void ReadSingleTestParams(BaseTest::TestParams& params);
+    void ReadHeadlessSettings(HeadlessFlowController::Settings& settings);
     void LoadMaps(const String& testName, Vector<std::pair<String, String>>& maps);
     void Cleanup();
 
@@ -53,6 +56,8 @@ private:
     TeamcityPerformanceTestsOutput teamCityOutput;
     BaseTest::TestParams defaultTestParams;
 
+    bool headless = false;
+
     DAVA::Engine& engine;
     static GameCore* instance;
 };
@@ -38,7 +38,10 @@ void BaseTest::LoadResources()
 
     AddControl(sceneView);
 
-    CreateUI();
+    if (!headless)
+    {
+        CreateUI();
+    }
 }
 
 void BaseTest::UnloadResources()
@@ -52,6 +55,37 @@ void BaseTest::UnloadResources()
     uiRoot->RemoveAllControls();
 }
 
+void BaseTest::LoadHeadless(const Size2i& viewportSize)
+{
+    headless = true;
+    uiRoot->SetVisibilityFlag(false);
+
+    LoadResources();
+
+    scene->SetMainPassProperties(PRIORITY_MAIN_3D, Rect(0.0f, 0.0f, static_cast<float32>(viewportSize.dx), static_cast<float32>(viewportSize.dy)),
+                                 viewportSize.dx, viewportSize.dy, PixelFormat::FORMAT_RGBA8888);
+}
+
+void BaseTest::UnloadHeadless()
+{
+    UnloadResources();
+}
+
+void BaseTest::UpdateHeadless(float32 timeElapsed)
+{
+    DVASSERT(headless);
+
+    BeginFrame();
+    Update(timeElapsed);
+
+    if (frameNumber > FRAME_OFFSET)
+    {
+        scene->Update(currentFrameDelta);
+        scene->Draw();
+    }
+    EndFrame();
+}
+
 void BaseTest::CreateUI()
 {
     UIYamlLoader::LoadFonts("~res:/UI/Fonts/fonts.yaml");
@@ -99,6 +99,15 @@ public:
     const Vector<FrameInfo>& GetFramesInfo() const;
     float32 GetCurrentFrameDelta() const;
 
+    /**
+        Headless mode is used when there is no window (console mode on Null renderer).
+        Test resources are loaded without UI, scene is updated and drawn directly by `UpdateHeadless`.
+    */
+    void LoadHeadless(const Size2i& viewportSize);
+    void UnloadHeadless();
+    void UpdateHeadless(float32 timeElapsed);
+    bool IsHeadless() const;
+
     static const uint32 FRAME_OFFSET;
 
 protected:
@@ -151,6 +160,8 @@ private:
 
     uint32 maxAllocatedMemory;
     UICustomUpdateDeltaComponent* sceneCustomDeltaComponent;
+
+    bool headless = false;
 };
 
 inline const Vector<BaseTest::FrameInfo>& BaseTest::GetFramesInfo() const
@@ -226,4 +237,9 @@ inline float32 BaseTest::GetCurrentFrameDelta() const
     return currentFrameDelta;
 }
 
+inline bool BaseTest::IsHeadless() const
+{
+    return headless;
+}
+
 #endif
@@ -16,7 +16,7 @@ DAVA::ConsoleModule::eFrameResult ConsoleHelpTool::OnFrameInternal()
 
 void ConsoleHelpTool::ShowHelpInternal()
 {
-    DAVA::Logger::Info("List of available commands: -sceneexporter, -scenesaver, -texdescriptor, -staticocclusion, -beast, -dump, -imagesplitter, -version, -sceneimagedump, -help");
+    DAVA::Logger::Info("List of available commands: -sceneexporter, -scenesaver, -texdescriptor, -staticocclusion, -beast, -dump, -imagesplitter, -version, -sceneimagedump, -scenesectors, -help");
 
     DAVA::Logger::Info("\t-sceneexporter - set of tools to prepare resources for game");
     DAVA::Logger::Info("\t-scenesaver - set of tools to save, resave or save scenes with references");
@@ -28,6 +28,7 @@ void ConsoleHelpTool::ShowHelpInternal()
     DAVA::Logger::Info("\t-imagesplitter - set of tools to split or merge images");
     DAVA::Logger::Info("\t-version - show the version info of the current build of ResourceEditor");
     DAVA::Logger::Info("\t-sceneimagedump - tool for save screenshots from camera");
+    DAVA::Logger::Info("\t-scenesectors - tool for splitting map into sector scenes for streaming");
     DAVA::Logger::Info("\t-help - show this help");
 
     DAVA::Logger::Info("\nSee \'ResourceEditor <command> -h\' to read about a specific command.");
@@ -7,7 +7,7 @@
 
 #include <algorithm>
 
-bool ResourceDependency::GetDependencies(const DAVA::Vector<DAVA::FilePath>& resourcePathes, DAVA::Map<DAVA::FilePath, DAVA::Set<DAVA::FilePath>>& dependencyMap, DAVA::int32 requestedType)
+bool ResourceDependency::GetDependencies(const DAVA::Vector<DAVA::FilePath>& resourcePathes, DAVA::Map<DAVA::FilePath, DAVA::Set<DAVA::FilePath>>& dependencyMap, DAVA::int32 requestedType, DAVA::SceneReferencesCache* sceneCache)
 {
     using namespace DAVA;
 
@@ -20,7 +20,7 @@ bool ResourceDependency::GetDependencies(const DAVA::Vector<DAVA::FilePath>& res
         }
         else if (path.IsEqualToExtension(".sc2"))
         {
-            result = SceneDependency::GetDependencies(path, dependencyMap[path], requestedType);
+            result = SceneDependency::GetDependencies(path, dependencyMap[path], requestedType, sceneCache);
         }
         else if (path.IsEqualToExtension(".yaml") || path.IsEqualToExtension(".xml"))
         {
@@ -3,8 +3,13 @@
 #include <Base/BaseTypes.h>
 #include <FileSystem/FilePath.h>
 
+namespace DAVA
+{
+class SceneReferencesCache;
+}
+
 class ResourceDependency final
 {
 public:
-    static bool GetDependencies(const DAVA::Vector<DAVA::FilePath>& resourcePathes, DAVA::Map<DAVA::FilePath, DAVA::Set<DAVA::FilePath>>& dependencyMap, DAVA::int32 requestedType);
+    static bool GetDependencies(const DAVA::Vector<DAVA::FilePath>& resourcePathes, DAVA::Map<DAVA::FilePath, DAVA::Set<DAVA::FilePath>>& dependencyMap, DAVA::int32 requestedType, DAVA::SceneReferencesCache* sceneCache = nullptr);
 };
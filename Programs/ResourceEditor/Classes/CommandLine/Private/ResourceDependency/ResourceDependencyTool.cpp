@@ -13,9 +13,11 @@
 #include <FileSystem/FileSystem.h>
 #include <Logger/Logger.h>
 #include <Render/GPUFamilyDescriptor.h>
+#include <Scene3D/SceneFile/SceneReferences.h>
 #include <Utils/Utils.h>
 
 #include <iostream>
+#include <memory>
 
 namespace ResourceDependencyToolDetails
 {
@@ -47,6 +49,7 @@ ResourceDependencyTool::ResourceDependencyTool(const DAVA::Vector<DAVA::String>&
     options.AddOption("--list", VariantType(String()), "Path to file with list of resources (*.tex, *.sc2, etc) files");
     options.AddOption("--type", VariantType(String()), "Could be \'d\' or \'c\'. \'d\' means dependency for downloading, \'c\' - dependency for convertion");
     options.AddOption("--outfile", VariantType(String()), "Path to result file");
+    options.AddOption("--cache", VariantType(String()), "Path to cache of scene references, scenes not changed since previous run are not scanned again");
     options.AddOption("--version", VariantType(false), "Print tool version");
 }
 
@@ -110,6 +113,8 @@ bool ResourceDependencyTool::PostInitInternal()
         return false;
     }
 
+    cacheFile = options.GetOption("--cache").AsString();
+
     return true;
 }
 
@@ -124,9 +129,21 @@ DAVA::ConsoleModule::eFrameResult ResourceDependencyTool::OnFrameInternal()
     }
     else // dependency
     {
+        std::unique_ptr<SceneReferencesCache> sceneCache;
+        if (cacheFile.IsEmpty() == false)
+        {
+            sceneCache.reset(new SceneReferencesCache());
+            sceneCache->Load(cacheFile);
+        }
+
         Map<FilePath, Set<FilePath>> dependencyMap;
-        if (ResourceDependency::GetDependencies(resources, dependencyMap, mode) == true)
+        if (ResourceDependency::GetDependencies(resources, dependencyMap, mode, sceneCache.get()) == true)
         {
+            if (sceneCache && sceneCache->Save(cacheFile) == false)
+            {
+                Logger::Warning("Cannot save scene references cache to %s", cacheFile.GetStringValue().c_str());
+            }
+
             GetEngineContext()->fileSystem->CreateDirectory(outFile.GetDirectory(), true);
             ScopedPtr<File> file(File::Create(outFile, File::WRITE | File::CREATE));
             if (file)
@@ -186,6 +203,7 @@ void ResourceDependencyTool::ShowHelpInternal()
     Logger::Info("Examples:");
     Logger::Info("\tresourceDependency --file absolute_path_to_resource --outfile absolute_path_to_outfile --type \'c\'|\'d' --> to get dependency of resource(*.tex, *.sc2, etc)");
     Logger::Info("\tresourceDependency --list absolute_path_to_file_with_list_of_resources --outfile absolute_path_to_outfile --type \'c\'|\'d' --> to get dependency of all resources in list(*.tex, *.sc2, etc)");
+    Logger::Info("\tresourceDependency --list absolute_path_to_file_with_list_of_resources --outfile absolute_path_to_outfile --type \'d\' --cache absolute_path_to_cache --> to reuse references of unchanged scenes from previous runs");
 }
 
 DECL_TARC_MODULE(ResourceDependencyTool);
@@ -3,8 +3,13 @@
 #include <Base/BaseTypes.h>
 #include <FileSystem/FilePath.h>
 
+namespace DAVA
+{
+class SceneReferencesCache;
+}
+
 class SceneDependency final
 {
 public:
-    static bool GetDependencies(const DAVA::FilePath& scenePath, DAVA::Set<DAVA::FilePath>& dependencies, DAVA::int32 requestedType);
+    static bool GetDependencies(const DAVA::FilePath& scenePath, DAVA::Set<DAVA::FilePath>& dependencies, DAVA::int32 requestedType, DAVA::SceneReferencesCache* cache = nullptr);
 };
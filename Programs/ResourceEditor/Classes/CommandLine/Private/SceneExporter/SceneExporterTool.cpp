@@ -228,6 +228,7 @@ SceneExporterTool::SceneExporterTool(const DAVA::Vector<DAVA::String>& commandLi
 
     options.AddOption(OptionName::SaveNormals, VariantType(false), "Disable removing of normals from vertexes");
     options.AddOption(OptionName::HDTextures, VariantType(false), "Use 0-mip level as texture.hd.ext");
+    options.AddOption(OptionName::MergeMeshes, VariantType(false), "Merge static meshes with same materials to reduce draw calls");
 
     options.AddOption(OptionName::Tag, VariantType(String("")), "Tag for filenames, example: .china. Will export texture.china.tex instead of texture.tex");
 
@@ -316,6 +317,7 @@ bool SceneExporterTool::PostInitInternal()
 
     const bool saveNormals = options.GetOption(OptionName::SaveNormals).AsBool();
     exportingParams.optimizeOnExport = !saveNormals;
+    exportingParams.mergeStaticMeshes = options.GetOption(OptionName::MergeMeshes).AsBool();
 
     useAssetCache = options.GetOption(OptionName::UseAssetCache).AsBool();
     if (useAssetCache)
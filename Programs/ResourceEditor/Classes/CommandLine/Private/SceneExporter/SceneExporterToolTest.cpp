@@ -12,8 +12,13 @@
 #include <FileSystem/YamlEmitter.h>
 #include <FileSystem/FilePath.h>
 #include <FileSystem/FileList.h>
+#include <Math/Transform.h>
 #include <Render/GPUFamilyDescriptor.h>
+#include <Render/Highlevel/MergedMeshRenderObject.h>
 #include <Render/TextureDescriptor.h>
+#include <Scene3D/Components/ComponentHelpers.h>
+#include <Scene3D/Components/RenderComponent.h>
+#include <Scene3D/Components/TransformComponent.h>
 #include <Entity/ComponentManager.h>
 #include <Engine/Engine.h>
 
@@ -220,6 +225,75 @@ DAVA_TARC_TESTCLASS(SceneExporterToolTest)
         CommandLineModuleTestUtils::ClearTestFolder(SETestDetail::projectStr);
     }
 
+    DAVA_TEST (ExportSceneMergeMeshesTest)
+    {
+        using namespace DAVA;
+
+        std::unique_ptr<CommandLineModuleTestUtils::TextureLoadingGuard> guard = CommandLineModuleTestUtils::CreateTextureGuard({ eGPUFamily::GPU_ORIGIN });
+        CommandLineModuleTestUtils::CreateProjectInfrastructure(SETestDetail::projectStr);
+
+        const uint32 boxesCount = 8;
+        {
+            CommandLineModuleTestUtils::SceneBuilder builder(SETestDetail::scenePathnameStr, SETestDetail::projectStr);
+            builder.AddCamera();
+
+            CommandLineModuleTestUtils::SceneBuilder::BoxBuilder boxBuilder;
+            for (uint32 i = 0; i < boxesCount; ++i)
+            {
+                boxBuilder.Reset()
+                .Create(SETestDetail::scenePathnameStr, "box", CommandLineModuleTestUtils::SceneBuilder::tagDefault)
+                .SetTextureColor(32)
+                .AddRenderComponent();
+                GetTransformComponent(boxBuilder.GetBox())->SetLocalTransform(Transform(Vector3(4.f * i, 0.f, 0.f)));
+                boxBuilder.AddToScene(builder);
+            }
+        }
+
+        FilePath dataPath = SETestDetail::projectStr + "Data/3d/";
+        FilePath dataSourcePath = SETestDetail::projectStr + "DataSource/3d/";
+        String sceneRelativePathname = FilePath(SETestDetail::scenePathnameStr).GetRelativePathname(dataSourcePath);
+
+        Vector<String> cmdLine =
+        {
+          "ResourceEditor",
+          "-sceneexporter",
+          "-indir",
+          dataSourcePath.GetAbsolutePathname(),
+          "-outdir",
+          dataPath.GetAbsolutePathname(),
+          "-processfile",
+          sceneRelativePathname,
+          "-gpu",
+          "origin",
+          "-mergemeshes"
+        };
+
+        std::unique_ptr<CommandLineModule> tool = std::make_unique<SceneExporterTool>(cmdLine);
+        DAVA::ConsoleModuleTestExecution::ExecuteModule(tool.get());
+
+        TestExportedScene(dataPath + sceneRelativePathname);
+
+        ScopedPtr<Scene> scene(new Scene());
+        TEST_VERIFY(scene->LoadScene(dataPath + sceneRelativePathname) == DAVA::SceneFileV2::eError::ERROR_NO_ERROR);
+
+        Vector<Entity*> renderEntities;
+        scene->GetChildEntitiesWithComponent(renderEntities, Type::Instance<RenderComponent>());
+        TEST_VERIFY(renderEntities.size() == 1);
+        if (renderEntities.size() == 1)
+        {
+            MergedMeshRenderObject* merged = dynamic_cast<MergedMeshRenderObject*>(GetRenderObject(renderEntities[0]));
+            TEST_VERIFY(merged != nullptr);
+            if (merged != nullptr)
+            {
+                TEST_VERIFY(merged->GetRenderBatchCount() == 1);
+                TEST_VERIFY(merged->GetSubRanges(0).size() == boxesCount);
+                TEST_VERIFY(merged->GetRenderBatch(0)->GetPolygonGroup()->GetIndexCount() == static_cast<int32>(boxesCount * 6));
+            }
+        }
+
+        CommandLineModuleTestUtils::ClearTestFolder(SETestDetail::projectStr);
+    }
+
     DAVA_TEST (ExportTextureTest)
     {
         using namespace DAVA;
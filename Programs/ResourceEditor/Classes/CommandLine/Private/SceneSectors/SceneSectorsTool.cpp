@@ -0,0 +1,98 @@
+#include "Classes/CommandLine/SceneSectorsTool.h"
+
+#include <REPlatform/CommandLine/OptionName.h>
+
+#include <TArc/Utils/ModuleCollection.h>
+
+#include <Base/RefPtr.h>
+#include <Logger/Logger.h>
+#include <Scene3D/Scene.h>
+#include <Scene3D/Streaming/SectorsManifest.h>
+#include <Scene3D/Streaming/SectorsPartitioner.h>
+
+SceneSectorsTool::SceneSectorsTool(const DAVA::Vector<DAVA::String>& commandLine)
+    : CommandLineModule(commandLine, "-scenesectors")
+{
+    using namespace DAVA;
+
+    options.AddOption(OptionName::ProcessFile, VariantType(String("")), "Full pathname to scene file *.sc2");
+    options.AddOption(OptionName::OutDir, VariantType(String("")), "Full pathname to folder for sector scenes and manifest");
+    options.AddOption(OptionName::SectorSize, VariantType(uint32(256)), "Size of sector in meters");
+}
+
+bool SceneSectorsTool::PostInitInternal()
+{
+    using namespace DAVA;
+
+    scenePathname = options.GetOption(OptionName::ProcessFile).AsString();
+    if (scenePathname.IsEmpty())
+    {
+        Logger::Error("Filename was not set");
+        return false;
+    }
+
+    outFolder = options.GetOption(OptionName::OutDir).AsString();
+    if (outFolder.IsEmpty())
+    {
+        Logger::Error("Output folder was not set");
+        return false;
+    }
+    outFolder.MakeDirectoryPathname();
+
+    sectorSize = options.GetOption(OptionName::SectorSize).AsUInt32();
+    if (sectorSize == 0)
+    {
+        Logger::Error("Sector size should be positive");
+        return false;
+    }
+
+    return true;
+}
+
+DAVA::ConsoleModule::eFrameResult SceneSectorsTool::OnFrameInternal()
+{
+    using namespace DAVA;
+
+    RefPtr<Scene> scene(new Scene());
+    if (scene->LoadScene(scenePathname) != SceneFileV2::eError::ERROR_NO_ERROR)
+    {
+        Logger::Error("Cannot load scene %s", scenePathname.GetAbsolutePathname().c_str());
+        result = Result::RESULT_ERROR;
+        return eFrameResult::FINISHED;
+    }
+
+    SectorsPartitioner::Settings settings;
+    settings.sectorSize = static_cast<float32>(sectorSize);
+    settings.maxEntitySize = static_cast<float32>(sectorSize);
+    settings.sectorFilePrefix = scenePathname.GetBasename();
+
+    SectorsManifest manifest;
+    FilePath manifestPath = outFolder + scenePathname.GetBasename() + ".sectors";
+    if (!SectorsPartitioner::Partition(scene.Get(), manifestPath, settings, &manifest))
+    {
+        Logger::Error("Cannot partition scene %s", scenePathname.GetAbsolutePathname().c_str());
+        result = Result::RESULT_ERROR;
+        return eFrameResult::FINISHED;
+    }
+
+    uint64 sectorsSize = 0;
+    for (const SectorsManifest::Sector& sector : manifest.sectors)
+    {
+        sectorsSize += sector.fileSize;
+    }
+    Logger::Info("Scene %s was split into %u sectors (%dx%d grid), %llu bytes in sectors, base scene: %s",
+                 scenePathname.GetFilename().c_str(), static_cast<uint32>(manifest.sectors.size()), manifest.columns, manifest.rows,
+                 sectorsSize, manifest.baseSceneName.empty() ? "none" : manifest.baseSceneName.c_str());
+
+    return eFrameResult::FINISHED;
+}
+
+void SceneSectorsTool::ShowHelpInternal()
+{
+    CommandLineModule::ShowHelpInternal();
+
+    DAVA::Logger::Info("Examples:");
+    DAVA::Logger::Info("\t-scenesectors -processfile /Users/Test/DataSource/3d/Maps/map.sc2 -outdir /Users/Test/DataSource/3d/Maps/map_sectors/ -sectorsize 256");
+}
+
+DECL_TARC_MODULE(SceneSectorsTool);
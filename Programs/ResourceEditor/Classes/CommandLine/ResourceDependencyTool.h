@@ -19,6 +19,7 @@ private:
 
     DAVA::Vector<DAVA::FilePath> resources;
     DAVA::FilePath outFile;
+    DAVA::FilePath cacheFile;
 
     DAVA::int32 mode = 0;
 
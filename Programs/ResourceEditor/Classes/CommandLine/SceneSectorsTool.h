@@ -0,0 +1,28 @@
+#pragma once
+
+#include <REPlatform/Global/CommandLineModule.h>
+
+#include <FileSystem/FilePath.h>
+#include <Reflection/ReflectionRegistrator.h>
+
+class SceneSectorsTool : public DAVA::CommandLineModule
+{
+public:
+    SceneSectorsTool(const DAVA::Vector<DAVA::String>& commandLine);
+
+protected:
+    bool PostInitInternal() override;
+    eFrameResult OnFrameInternal() override;
+    void ShowHelpInternal() override;
+
+    DAVA::FilePath scenePathname;
+    DAVA::FilePath outFolder;
+    DAVA::uint32 sectorSize = 0;
+
+    DAVA_VIRTUAL_REFLECTION_IN_PLACE(SceneSectorsTool, DAVA::CommandLineModule)
+    {
+        DAVA::ReflectionRegistrator<SceneSectorsTool>::Begin()[DAVA::M::CommandName("-scenesectors")]
+        .ConstructorByPointer<DAVA::Vector<DAVA::String>>()
+        .End();
+    }
+};
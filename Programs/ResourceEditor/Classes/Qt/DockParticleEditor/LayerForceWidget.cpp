@@ -52,7 +52,8 @@ DAVA::Map<DAVA::ParticleForce::eType, QString> forceTypes =
   { DAVA::ParticleForce::eType::GRAVITY, "Gravity" },
   { DAVA::ParticleForce::eType::WIND, "Wind" },
   { DAVA::ParticleForce::eType::POINT_GRAVITY, "Point Gravity" },
-  { DAVA::ParticleForce::eType::PLANE_COLLISION, "Plane Collision" }
+  { DAVA::ParticleForce::eType::PLANE_COLLISION, "Plane Collision" },
+  { DAVA::ParticleForce::eType::SCENE_COLLISION, "Scene Collision" }
 };
 
 template <typename T, typename U, size_t sz>
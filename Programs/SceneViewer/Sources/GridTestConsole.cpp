@@ -0,0 +1,149 @@
+#include "GridTestConsole.h"
+
+#ifdef WITH_SCENE_PERFORMANCE_TESTS
+#include <GridTestReport.h>
+#include <HeadlessGridTest.h>
+
+#include <DocDirSetup/DocDirSetup.h>
+
+#include <CommandLine/ProgramOptions.h>
+#include <Engine/Engine.h>
+#include <FileSystem/FileSystem.h>
+#include <Logger/Logger.h>
+#include <Render/2D/Systems/VirtualCoordinatesSystem.h>
+#include <Render/RHI/rhi_Public.h>
+#include <Scene3D/Scene.h>
+#include <Scene3D/SceneFileV2.h>
+#include <Scene3D/Systems/QualitySettingsSystem.h>
+#include <UI/UIControlSystem.h>
+
+#include <cstdlib>
+
+namespace GridTestConsoleDetails
+{
+using namespace DAVA;
+
+enum eReturnCode : int
+{
+    SUCCESS = 0,
+    ERROR = 1,
+    REGRESSION = 2
+};
+
+// Time metrics smaller than this are not reported as regressions, microseconds
+const float32 MIN_TIME_INCREASE = 100.f;
+
+int Process(Engine& engine)
+{
+    ProgramOptions options("--gridtest");
+    options.AddOption("--scene", VariantType(String()), "Path to scene (*.sc2) with landscape");
+    options.AddOption("--report", VariantType(String("~doc:/PerformanceReports/GridTestHeadless/")), "Path to output folder for report and heatmaps");
+    options.AddOption("--baseline", VariantType(String()), "Path to baseline report to compare with");
+    options.AddOption("--threshold", VariantType(String("0.05")), "Allowed relative increase of count metrics");
+    options.AddOption("--timethreshold", VariantType(String("0.5")), "Allowed relative increase of time metrics");
+
+    if (!options.Parse(engine.GetCommandLine()))
+    {
+        Logger::Error("Wrong command line. Usage:\n%s", options.GetUsageString().c_str());
+        return ERROR;
+    }
+
+    FilePath scenePath = options.GetOption("--scene").AsString();
+    FilePath reportFolder = options.GetOption("--report").AsString();
+    reportFolder.MakeDirectoryPathname();
+    String baselinePath = options.GetOption("--baseline").AsString();
+
+    // Scene may contain sprites, which are loaded for current virtual resolution
+    engine.GetContext()->uiControlSystem->vcs->RegisterAvailableResourceSize(1024, 768, "Gfx");
+
+    if (scenePath.IsEmpty() || !scenePath.IsEqualToExtension(".sc2"))
+    {
+        Logger::Error("Scene path is empty or is not *.sc2 file");
+        return ERROR;
+    }
+
+    ScopedPtr<Scene> scene(new Scene());
+    if (scene->LoadScene(scenePath) != SceneFileV2::ERROR_NO_ERROR)
+    {
+        Logger::Error("Can't load scene %s", scenePath.GetAbsolutePathname().c_str());
+        return ERROR;
+    }
+
+    GridTestResult result;
+    HeadlessGridTest gridTest(scene);
+    if (!gridTest.Run(result))
+    {
+        return ERROR;
+    }
+
+    engine.GetContext()->fileSystem->CreateDirectory(reportFolder, true);
+    if (!GridTestReport::Save(result, reportFolder + "report.csv") || !GridTestReport::SaveHeatmaps(result, reportFolder))
+    {
+        return ERROR;
+    }
+    Logger::Info("Report is saved to %s", reportFolder.GetAbsolutePathname().c_str());
+
+    if (baselinePath.empty())
+    {
+        return SUCCESS;
+    }
+
+    GridTestResult baseline;
+    if (!GridTestReport::Load(baselinePath, baseline))
+    {
+        return ERROR;
+    }
+
+    float32 threshold = std::strtof(options.GetOption("--threshold").AsString().c_str(), nullptr);
+    float32 timeThreshold = std::strtof(options.GetOption("--timethreshold").AsString().c_str(), nullptr);
+    Vector<GridTestThreshold> thresholds =
+    {
+      { "time.*", timeThreshold, MIN_TIME_INCREASE },
+      { "*", threshold, 0.f }
+    };
+
+    Vector<GridTestRegression> regressions;
+    if (!GridTestReport::Compare(baseline, result, thresholds, regressions))
+    {
+        return ERROR;
+    }
+
+    for (const GridTestRegression& regression : regressions)
+    {
+        const GridTestSample& sample = result.samples[regression.sampleIndex];
+        Logger::Error("Regression of %s in sample %u (cell %u.%u, angle %.0f): %.1f -> %.1f", regression.metric.c_str(), regression.sampleIndex,
+                      sample.cellX, sample.cellY, sample.angle, regression.baselineValue, regression.value);
+    }
+
+    Logger::Info("%u regressions against baseline %s", static_cast<uint32>(regressions.size()), baselinePath.c_str());
+    return regressions.empty() ? SUCCESS : REGRESSION;
+}
+}
+
+int RunGridTestConsole(const DAVA::Vector<DAVA::String>& modules)
+{
+    using namespace DAVA;
+
+    KeyedArchive* appOptions = new KeyedArchive();
+    appOptions->SetInt32("renderer", rhi::RHI_NULL_RENDERER);
+
+    Engine e;
+    e.Init(eEngineRunMode::CONSOLE_MODE, modules, appOptions);
+
+    const EngineContext* context = e.GetContext();
+    DocumentsDirectorySetup::SetApplicationDocDirectory(context->fileSystem, "SceneViewer");
+    context->logger->SetLogLevel(Logger::LEVEL_INFO);
+    context->logger->EnableConsoleMode();
+
+    QualitySettingsSystem::Instance()->Load("~res:/SceneViewer/quality.yaml");
+
+    e.update.Connect([&e](float32)
+                     {
+                         int retCode = GridTestConsoleDetails::Process(e);
+                         e.QuitAsync(retCode);
+                     });
+
+    return e.Run();
+}
+
+#endif
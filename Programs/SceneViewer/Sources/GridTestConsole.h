@@ -0,0 +1,14 @@
+#pragma once
+
+#include <Base/BaseTypes.h>
+
+/**
+    Runs headless grid test from command line on null renderer and returns process exit code:
+
+    SceneViewer --gridtest --scene <scene.sc2> [--report <folder>] [--baseline <report.csv>]
+                [--threshold <relative increase>] [--timethreshold <relative increase>]
+
+    Report and heatmaps are written to report folder. If baseline report is passed, exit code is not zero
+    when any count metric grows over `threshold` or any time metric grows over `timethreshold`.
+*/
+int RunGridTestConsole(const DAVA::Vector<DAVA::String>& modules);
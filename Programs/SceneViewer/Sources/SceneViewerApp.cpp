@@ -2,6 +2,7 @@
 #include "UIScreens/ViewSceneScreen.h"
 #include "UIScreens/PerformanceResultsScreen.h"
 #include "Quality/QualityPreferences.h"
+#include "GridTestConsole.h"
 
 #include <DocDirSetup/DocDirSetup.h>
 #include <LoggerService/ServiceInfo.h>
@@ -312,6 +313,14 @@ int DAVAMain(DAVA::Vector<DAVA::String> cmdline)
       "SoundSystem",
       "DownloadManager",
     };
+
+#ifdef WITH_SCENE_PERFORMANCE_TESTS
+    if (cmdline.size() > 1 && cmdline[1] == "--gridtest")
+    {
+        return RunGridTestConsole(modules);
+    }
+#endif
+
     DAVA::Engine e;
     e.Init(DAVA::eEngineRunMode::GUI_STANDALONE, modules, CreateOptions());
 
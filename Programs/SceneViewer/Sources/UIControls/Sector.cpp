@@ -74,6 +74,8 @@ Sector::Sector(const DAVA::Vector2& centerPoint, DAVA::float32 startAngle, DAVA:
     borderColor = fillColorPrimary;
     borderColor.a += 0.2f;
     SetMode(mode);
+    // Sector is hit by its polygon which may be outside of control rect
+    SetInputCulling(false);
 }
 
 void Sector::SetMode(Sector::Mode newMode)
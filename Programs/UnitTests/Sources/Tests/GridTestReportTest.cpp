@@ -0,0 +1,169 @@
+#include <DAVAEngine.h>
+#include <UnitTests/UnitTests.h>
+
+#if defined(WITH_SCENE_PERFORMANCE_TESTS)
+
+#include <GridTestReport.h>
+
+#include <Engine/EngineContext.h>
+#include <FileSystem/FileSystem.h>
+
+namespace GridTestReportTestDetails
+{
+using namespace DAVA;
+
+const uint32 GRID_SIZE = 4;
+const uint32 ANGLE_COUNT = 4;
+
+// Samples in the same order as grid test walks them, packets grow to the north-east corner
+GridTestResult CreateResult()
+{
+    GridTestResult result;
+    for (uint32 y = 0; y < GRID_SIZE; ++y)
+    {
+        for (uint32 x = 0; x < GRID_SIZE; ++x)
+        {
+            uint32 cellX = (y % 2 == 0) ? x : GRID_SIZE - 1 - x;
+            for (uint32 n = 0; n < ANGLE_COUNT; ++n)
+            {
+                GridTestSample sample;
+                sample.cellX = cellX;
+                sample.cellY = y;
+                sample.angle = 0.1f + n * 360.f / ANGLE_COUNT;
+                sample.pos = Vector3(cellX * 100.f, y * 100.f, 10.f);
+                sample.metrics["renderPackets"] = static_cast<float32>((cellX + y) * 100 + n);
+                sample.metrics["batches.OpaqueRenderLayer"] = static_cast<float32>((cellX + y) * 50);
+                sample.metrics["time.culling"] = 200.f + n;
+                result.samples.push_back(sample);
+            }
+        }
+    }
+    return result;
+}
+}
+
+DAVA_TESTCLASS (GridTestReportTest)
+{
+    const DAVA::FilePath folder = "~doc:/TestData/GridTestReportTest/";
+
+    GridTestReportTest()
+    {
+        DAVA::GetEngineContext()->fileSystem->DeleteDirectory(folder, true);
+        DAVA::GetEngineContext()->fileSystem->CreateDirectory(folder, true);
+    }
+
+    ~GridTestReportTest()
+    {
+        DAVA::GetEngineContext()->fileSystem->DeleteDirectory(folder, true);
+    }
+
+    DAVA_TEST (SaveLoadTest)
+    {
+        using namespace DAVA;
+        using namespace GridTestReportTestDetails;
+
+        GridTestResult result = CreateResult();
+        TEST_VERIFY(GridTestReport::Save(result, folder + "report.csv"));
+
+        GridTestResult loaded;
+        TEST_VERIFY(GridTestReport::Load(folder + "report.csv", loaded));
+        TEST_VERIFY(loaded.samples.size() == result.samples.size());
+        TEST_VERIFY(GridTestReport::GetMetricNames(loaded) == GridTestReport::GetMetricNames(result));
+
+        for (size_t i = 0; i < loaded.samples.size(); ++i)
+        {
+            const GridTestSample& expected = result.samples[i];
+            const GridTestSample& sample = loaded.samples[i];
+            TEST_VERIFY(sample.cellX == expected.cellX && sample.cellY == expected.cellY);
+            TEST_VERIFY(FLOAT_EQUAL_EPS(sample.angle, expected.angle, 0.01f));
+            TEST_VERIFY(sample.metrics == expected.metrics);
+        }
+
+        TEST_VERIFY(!GridTestReport::Load(folder + "missing.csv", loaded));
+    }
+
+    DAVA_TEST (DiffTest)
+    {
+        using namespace DAVA;
+        using namespace GridTestReportTestDetails;
+
+        GridTestResult baselineResult = CreateResult();
+        GridTestResult currentResult = CreateResult();
+
+        Vector<GridTestSample>& samples = currentResult.samples;
+        samples[5].metrics["renderPackets"] *= 1.2f; // regression
+        samples[6].metrics["renderPackets"] *= 1.02f; // within threshold
+        samples[7].metrics["batches.OpaqueRenderLayer"] += 50.f; // regression
+        samples[8].metrics["time.culling"] += 50.f; // below noise level
+        samples[9].metrics["time.culling"] += 400.f; // regression
+        samples[10].metrics["renderPackets"] *= 0.5f; // improvement
+
+        // both reports go through files, as in console tool
+        TEST_VERIFY(GridTestReport::Save(baselineResult, folder + "baseline.csv"));
+        TEST_VERIFY(GridTestReport::Save(currentResult, folder + "current.csv"));
+
+        GridTestResult baseline;
+        GridTestResult current;
+        TEST_VERIFY(GridTestReport::Load(folder + "baseline.csv", baseline));
+        TEST_VERIFY(GridTestReport::Load(folder + "current.csv", current));
+
+        Vector<GridTestThreshold> thresholds =
+        {
+          { "time.*", 0.5f, 100.f },
+          { "*", 0.05f, 0.f }
+        };
+
+        Vector<GridTestRegression> regressions;
+        TEST_VERIFY(GridTestReport::Compare(baseline, baseline, thresholds, regressions));
+        TEST_VERIFY(regressions.empty());
+
+        TEST_VERIFY(GridTestReport::Compare(baseline, current, thresholds, regressions));
+        TEST_VERIFY(regressions.size() == 3);
+
+        Set<std::pair<uint32, String>> found;
+        for (const GridTestRegression& regression : regressions)
+        {
+            found.emplace(regression.sampleIndex, regression.metric);
+            TEST_VERIFY(regression.value > regression.baselineValue);
+        }
+        TEST_VERIFY(found.count({ 5, "renderPackets" }) == 1);
+        TEST_VERIFY(found.count({ 7, "batches.OpaqueRenderLayer" }) == 1);
+        TEST_VERIFY(found.count({ 9, "time.culling" }) == 1);
+
+        // only metrics with thresholds are checked
+        TEST_VERIFY(GridTestReport::Compare(baseline, current, { { "time.*", 0.5f, 100.f } }, regressions));
+        TEST_VERIFY(regressions.size() == 1);
+
+        // reports of different grids can't be compared
+        current.samples.pop_back();
+        TEST_VERIFY(!GridTestReport::Compare(baseline, current, thresholds, regressions));
+    }
+
+    DAVA_TEST (HeatmapTest)
+    {
+        using namespace DAVA;
+        using namespace GridTestReportTestDetails;
+
+        const uint32 cellSize = 8;
+        GridTestResult result = CreateResult();
+
+        ScopedPtr<Image> heatmap(GridTestReport::CreateHeatmap(result, "renderPackets", cellSize));
+        TEST_VERIFY(heatmap);
+        TEST_VERIFY(heatmap->GetWidth() == GRID_SIZE * cellSize && heatmap->GetHeight() == GRID_SIZE * cellSize);
+
+        // cell (0, 0) is cold and at the bottom-left, cell (GRID_SIZE - 1, GRID_SIZE - 1) is hottest and at the top-right
+        const uint32* pixels = reinterpret_cast<const uint32*>(heatmap->GetData());
+        uint32 coldPixel = pixels[cellSize / 2 + (heatmap->GetHeight() - cellSize / 2) * heatmap->GetWidth()];
+        uint32 hotPixel = pixels[heatmap->GetWidth() - cellSize / 2 + (cellSize / 2) * heatmap->GetWidth()];
+        TEST_VERIFY((coldPixel & 0xff) < ((coldPixel >> 8) & 0xff)); // more green than red
+        TEST_VERIFY(hotPixel == 0xff0000ff); // pure red
+
+        TEST_VERIFY(GridTestReport::SaveHeatmaps(result, folder));
+        for (const char* fileName : { "heatmap_renderPackets.png", "heatmap_batches.OpaqueRenderLayer.png", "heatmap_time.culling.png" })
+        {
+            TEST_VERIFY(GetEngineContext()->fileSystem->Exists(folder + fileName));
+        }
+    }
+};
+
+#endif
@@ -81,6 +81,95 @@ DAVA_TESTCLASS (JobManagerTest)
         TEST_VERIFY((testData.ownedMainJobsVar == JOBS_COUNT));
     }
 
+    DAVA_TEST (TestMainJobsTimeBudget)
+    {
+        JobManager* jobManager = GetEngineContext()->jobManager;
+
+        const float32 budget = 0.004f;
+        const float32 jobCost = 0.0005f;
+        const uint32 highJobsCount = 20;
+        const uint32 normalJobsCount = 400;
+        const uint32 lowJobsCount = 100;
+        const uint32 promotedJobsCount = 10;
+
+        auto busyWait = [](float32 seconds) {
+            int64 end = SystemTimer::GetUs() + static_cast<int64>(seconds * 1000000.0f);
+            while (SystemTimer::GetUs() < end)
+            {
+            }
+        };
+
+        Vector<uint32> highOrder;
+        Vector<uint32> normalOrder;
+        Vector<uint32> lowOrder;
+        Vector<uint32> lowJobIds;
+
+        jobManager->SetMainJobsTimeBudget(budget);
+
+        // jobs created from main thread with JOB_MAINLAZY are queued like jobs from other threads
+        for (uint32 i = 0; i < normalJobsCount; ++i)
+        {
+            jobManager->CreateMainJob([&, i]() { busyWait(jobCost); normalOrder.push_back(i); }, JobManager::JOB_MAINLAZY, JobManager::JOB_PRIORITY_NORMAL, jobCost);
+        }
+        for (uint32 i = 0; i < lowJobsCount; ++i)
+        {
+            lowJobIds.push_back(jobManager->CreateMainJob([&, i]() { busyWait(jobCost); lowOrder.push_back(i); }, JobManager::JOB_MAINLAZY, JobManager::JOB_PRIORITY_LOW, jobCost));
+        }
+        for (uint32 i = 0; i < highJobsCount; ++i)
+        {
+            jobManager->CreateMainJob([&, i]() { highOrder.push_back(i); }, JobManager::JOB_MAINLAZY, JobManager::JOB_PRIORITY_HIGH);
+        }
+        jobManager->ResetMainJobsStats();
+
+        // waiting for job promotes it together with preceding jobs of the same priority
+        jobManager->WaitMainJobID(lowJobIds[promotedJobsCount - 1]);
+        TEST_VERIFY(!jobManager->HasMainJobID(lowJobIds[promotedJobsCount - 1]));
+        TEST_VERIFY(jobManager->HasMainJobID(lowJobIds[promotedJobsCount]));
+        TEST_VERIFY(highOrder.size() == highJobsCount);
+        TEST_VERIFY(lowOrder.size() == promotedJobsCount);
+        TEST_VERIFY(normalOrder.size() < normalJobsCount);
+
+        // flooded queue is spread over frames within budget. Every job takes at least its cost hint,
+        // so budget accounting never lets more than budget / cost jobs into a frame, however loaded machine is.
+        // Time of frames depends on machine load and is only logged
+        const uint32 maxJobsPerFrame = static_cast<uint32>(budget / jobCost + 0.5f);
+        uint32 framesCount = 1;
+        float32 maxFrameTime = 0.0f;
+        while (jobManager->HasMainJobs() && framesCount < 10000)
+        {
+            jobManager->Update();
+            ++framesCount;
+
+            const JobManager::MainJobsStats& stats = jobManager->GetMainJobsStats();
+            TEST_VERIFY(stats.executedJobs > 0);
+            TEST_VERIFY(stats.executedJobs <= maxJobsPerFrame);
+            maxFrameTime = Max(maxFrameTime, stats.executionTime);
+        }
+
+        TEST_VERIFY(!jobManager->HasMainJobs());
+        TEST_VERIFY(normalOrder.size() == normalJobsCount);
+        TEST_VERIFY(lowOrder.size() == lowJobsCount);
+        TEST_VERIFY(framesCount >= (normalJobsCount + lowJobsCount - promotedJobsCount) / maxJobsPerFrame);
+
+        // order is preserved within priority
+        for (const Vector<uint32>* order : { &highOrder, &normalOrder, &lowOrder })
+        {
+            for (size_t i = 0; i < order->size(); ++i)
+            {
+                TEST_VERIFY((*order)[i] == i);
+            }
+        }
+
+        const JobManager::MainJobsStats& stats = jobManager->GetMainJobsStats();
+        TEST_VERIFY(stats.queueDepth == 0);
+        TEST_VERIFY(stats.maxQueueDepth >= normalJobsCount);
+
+        Logger::Info("Main jobs budget %.1f ms: %u jobs executed in %u frames, max frame jobs time %.2f ms",
+                     budget * 1000.0f, highJobsCount + normalJobsCount + lowJobsCount, framesCount, maxFrameTime * 1000.0f);
+
+        jobManager->SetMainJobsTimeBudget(0.0f);
+    }
+
     DAVA_TEST (TestWorkerJobs)
     {
         // TODO:
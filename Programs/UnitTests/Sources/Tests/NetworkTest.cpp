@@ -7,6 +7,9 @@
 #include "Network/NetConfig.h"
 #include "Network/NetService.h"
 #include "Network/NetCore.h"
+#include "Network/ServiceRegistrar.h"
+#include "Network/Private/ITransport.h"
+#include "Network/Private/ProtoDriver.h"
 
 #if !defined(DAVA_NETWORK_DISABLE)
 
@@ -25,6 +28,34 @@ struct Parcel
     }
 };
 
+// Transport that keeps bytes written by ProtoDriver instead of sending them
+class TestRecordingTransport : public IClientTransport
+{
+public:
+    int32 Start(IClientListener* listener) override
+    {
+        return 0;
+    }
+    void Stop() override
+    {
+    }
+    void Reset() override
+    {
+    }
+    int32 Send(const Buffer* buffers, size_t bufferCount) override
+    {
+        for (size_t i = 0; i < bufferCount; ++i)
+        {
+            const uint8* data = reinterpret_cast<const uint8*>(buffers[i].base);
+            sentBytes.insert(sentBytes.end(), data, data + buffers[i].len);
+        }
+        return sendError;
+    }
+
+    Vector<uint8> sentBytes;
+    int32 sendError = 0;
+};
+
 class TestEchoServer : public DAVA::Net::NetService
 {
 public:
@@ -232,6 +263,146 @@ private:
     size_t pendingDelivered = 0; // Parcel index expected to be confirmed as delivered
 };
 
+// Bulk transfer which shares connection with ping-pong of small messages
+class TestBulkClient : public DAVA::Net::NetService
+{
+public:
+    static const size_t PACKET_SIZE = 1024 * 1024;
+    static const size_t PACKET_COUNT = 64;
+    static const size_t PACKETS_IN_FLIGHT = 4;
+
+    TestBulkClient()
+        : data(PACKET_SIZE, 'B')
+    {
+    }
+
+    void ChannelOpen() override
+    {
+        startTime = SystemTimer::GetUs();
+        for (size_t i = 0; i < PACKETS_IN_FLIGHT; ++i)
+        {
+            SendPacket();
+        }
+    }
+    void OnPacketDelivered(const std::shared_ptr<IChannel>& channel, uint32 packetId) override
+    {
+        deliveredCount += 1;
+        if (sentCount < PACKET_COUNT)
+        {
+            SendPacket();
+        }
+        else if (deliveredCount == PACKET_COUNT)
+        {
+            elapsedTime = SystemTimer::GetUs() - startTime;
+        }
+    }
+
+    bool IsTestDone() const
+    {
+        return deliveredCount == PACKET_COUNT;
+    }
+
+    float64 GetThroughputMBs() const
+    {
+        return (PACKET_SIZE * PACKET_COUNT) / (1024.0 * 1024.0) / (Max<int64>(elapsedTime, 1) / 1000000.0);
+    }
+
+private:
+    void SendPacket()
+    {
+        sentCount += 1;
+        Send(data.data(), data.size());
+    }
+
+    Vector<uint8> data;
+    size_t sentCount = 0;
+    size_t deliveredCount = 0;
+    int64 startTime = 0;
+    int64 elapsedTime = 0;
+};
+
+class TestBulkServer : public DAVA::Net::NetService
+{
+public:
+    void OnPacketReceived(const std::shared_ptr<IChannel>& channel, const void* buffer, size_t length) override
+    {
+        bytesRecieved += length;
+    }
+
+    size_t BytesRecieved() const
+    {
+        return bytesRecieved;
+    }
+
+private:
+    size_t bytesRecieved = 0;
+};
+
+class TestPingClient : public DAVA::Net::NetService
+{
+public:
+    void ChannelOpen() override
+    {
+        SendPing();
+    }
+    void OnPacketReceived(const std::shared_ptr<IChannel>& channel, const void* buffer, size_t length) override
+    {
+        latencies.push_back(SystemTimer::GetUs() - pingTime);
+        if (!stopped)
+        {
+            SendPing();
+        }
+    }
+
+    void Stop()
+    {
+        stopped = true;
+    }
+
+    // Round trip time percentile in microseconds
+    int64 GetLatencyUs(float32 percentile) const
+    {
+        if (latencies.empty())
+        {
+            return 0;
+        }
+        Vector<int64> sorted(latencies);
+        std::sort(sorted.begin(), sorted.end());
+        return sorted[static_cast<size_t>(percentile * (sorted.size() - 1))];
+    }
+
+    size_t PingCount() const
+    {
+        return latencies.size();
+    }
+
+private:
+    void SendPing()
+    {
+        pingTime = SystemTimer::GetUs();
+        Send(&pingTime);
+    }
+
+    bool stopped = false;
+    int64 pingTime = 0;
+    Vector<int64> latencies;
+};
+
+class TestPingServer : public DAVA::Net::NetService
+{
+public:
+    void OnPacketReceived(const std::shared_ptr<IChannel>& channel, const void* buffer, size_t length) override
+    {
+        // Only one ping is in flight, so single buffer is enough
+        DVASSERT(length == sizeof(echo));
+        Memcpy(&echo, buffer, sizeof(echo));
+        Send(&echo);
+    }
+
+private:
+    int64 echo = 0;
+};
+
 DAVA_TESTCLASS (NetworkTest)
 {
     //BEGIN_FILES_COVERED_BY_TESTS( )
@@ -244,7 +415,9 @@ DAVA_TESTCLASS (NetworkTest)
 
     enum eServiceTypes
     {
-        SERVICE_ECHO = 1000
+        SERVICE_ECHO = 1000,
+        SERVICE_BULK,
+        SERVICE_PING
     };
 
     enum
@@ -254,11 +427,18 @@ DAVA_TESTCLASS (NetworkTest)
     };
 
     static const uint16 ECHO_PORT = 55101;
+    static const uint16 BENCHMARK_PORT = 55102;
 
     bool echoTestDone = false;
     TestEchoServer echoServer;
     TestEchoClient echoClient;
 
+    bool benchmarkDone = false;
+    TestBulkServer bulkServer;
+    TestBulkClient bulkClient;
+    TestPingServer pingServer;
+    TestPingClient pingClient;
+
     NetCore::TrackId serverId = NetCore::INVALID_TRACK_ID;
     NetCore::TrackId clientId = NetCore::INVALID_TRACK_ID;
 
@@ -278,6 +458,17 @@ DAVA_TESTCLASS (NetworkTest)
                 TEST_VERIFY(echoServer.BytesRecieved() == echoClient.BytesRecieved());
             }
         }
+        else if (testName == "TestChannelsBenchmark" && !benchmarkDone && bulkClient.IsTestDone())
+        {
+            pingClient.Stop();
+            benchmarkDone = true;
+
+            TEST_VERIFY(bulkServer.BytesRecieved() == TestBulkClient::PACKET_SIZE * TestBulkClient::PACKET_COUNT);
+            TEST_VERIFY(pingClient.PingCount() > 0);
+            Logger::Info("Network channels benchmark: bulk %.1f MB/s; small message round trip %lld us median, %lld us p95, %lld us p99, %lld us max (%u samples)",
+                         bulkClient.GetThroughputMBs(), pingClient.GetLatencyUs(0.5f), pingClient.GetLatencyUs(0.95f),
+                         pingClient.GetLatencyUs(0.99f), pingClient.GetLatencyUs(1.f), static_cast<uint32>(pingClient.PingCount()));
+        }
 
         TestClass::Update(timeElapsed, testName);
     }
@@ -295,6 +486,13 @@ DAVA_TESTCLASS (NetworkTest)
             serverId = NetCore::INVALID_TRACK_ID;
             clientId = NetCore::INVALID_TRACK_ID;
         }
+        else if (testName == "TestChannelsBenchmark")
+        {
+            NetCore::Instance()->DestroyControllerBlocked(serverId);
+            NetCore::Instance()->DestroyControllerBlocked(clientId);
+            serverId = NetCore::INVALID_TRACK_ID;
+            clientId = NetCore::INVALID_TRACK_ID;
+        }
 
         TestClass::TearDown(testName);
     }
@@ -305,6 +503,10 @@ DAVA_TESTCLASS (NetworkTest)
         {
             return echoTestDone;
         }
+        else if (testName == "TestChannelsBenchmark")
+        {
+            return benchmarkDone;
+        }
         return true;
     }
 
@@ -374,6 +576,70 @@ DAVA_TESTCLASS (NetworkTest)
         TEST_VERIFY(3 == config2.Services().size());
     }
 
+    DAVA_TEST (TestProtocolVersion)
+    {
+        ServiceRegistrar registrar;
+        TestRecordingTransport transport;
+        const uint32 channelId = SERVICE_ECHO;
+
+        ProtoDriver driver(NetCore::Instance()->Loop(), SERVER_ROLE, registrar, nullptr);
+        driver.SetTransport(&transport, &channelId, 1);
+        driver.OnConnected(Endpoint(ECHO_PORT));
+
+        // Protocol version goes in first frame
+        ProtoDecoder decoder;
+        ProtoDecoder::DecodeResult result;
+        TEST_VERIFY(ProtoDecoder::DECODE_OK == decoder.Decode(transport.sentBytes.data(), transport.sentBytes.size(), &result));
+        TEST_VERIFY(TYPE_HELLO == result.type);
+        TEST_VERIFY(PROTO_VERSION == result.packetId);
+
+        // Connection is dropped if peer sends frames without version or with other version
+        ProtoHeader header;
+        decoder.EncodeControlFrame(&header, TYPE_PING, 0, 0);
+        TEST_VERIFY(false == driver.OnDataReceived(&header, sizeof(header)));
+        decoder.EncodeControlFrame(&header, TYPE_HELLO, 0, PROTO_VERSION + 1);
+        TEST_VERIFY(false == driver.OnDataReceived(&header, sizeof(header)));
+
+        decoder.EncodeControlFrame(&header, TYPE_HELLO, 0, PROTO_VERSION);
+        TEST_VERIFY(true == driver.OnDataReceived(&header, sizeof(header)));
+        decoder.EncodeControlFrame(&header, TYPE_PING, 0, 0);
+        TEST_VERIFY(true == driver.OnDataReceived(&header, sizeof(header)));
+
+        driver.OnDisconnected("");
+    }
+
+    DAVA_TEST (TestSendFailure)
+    {
+        ServiceRegistrar registrar;
+        TestRecordingTransport transport;
+        transport.sendError = -1;
+        const uint32 channelId = SERVICE_ECHO;
+
+        ProtoDriver driver(NetCore::Instance()->Loop(), SERVER_ROLE, registrar, nullptr);
+        driver.SetTransport(&transport, &channelId, 1);
+        driver.OnConnected(Endpoint(ECHO_PORT));
+
+        // Failed write is not retried and driver asks to reset connection
+        size_t writtenSize = transport.sentBytes.size();
+        TEST_VERIFY(writtenSize > 0);
+        TEST_VERIFY(false == driver.OnTimeout());
+        TEST_VERIFY(transport.sentBytes.size() == writtenSize);
+
+        ProtoDecoder decoder;
+        ProtoHeader header;
+        decoder.EncodeControlFrame(&header, TYPE_HELLO, 0, PROTO_VERSION);
+        TEST_VERIFY(false == driver.OnDataReceived(&header, sizeof(header)));
+
+        // New connection starts from clean state
+        driver.OnDisconnected("");
+        transport.sendError = 0;
+        driver.OnConnected(Endpoint(ECHO_PORT));
+        TEST_VERIFY(transport.sentBytes.size() > writtenSize);
+        TEST_VERIFY(true == driver.OnDataReceived(&header, sizeof(header)));
+
+        driver.OnDisconnected("");
+    }
+
     DAVA_TEST (TestEcho)
     {
         NetCore::Instance()->RegisterService(SERVICE_ECHO, MakeFunction(this, &NetworkTest::CreateEcho), MakeFunction(this, &NetworkTest::DeleteEcho));
@@ -389,6 +655,33 @@ DAVA_TESTCLASS (NetworkTest)
         clientId = NetCore::Instance()->CreateController(clientConfig, reinterpret_cast<void*>(ECHO_CLIENT_CONTEXT));
     }
 
+    DAVA_TEST (TestChannelsBenchmark)
+    {
+        // Both services share one connection: small messages should not wait behind bulk transfer
+        NetCore::Instance()->RegisterService(SERVICE_BULK, MakeFunction(this, &NetworkTest::CreateBenchmarkService), MakeFunction(this, &NetworkTest::DeleteEcho));
+        NetCore::Instance()->RegisterService(SERVICE_PING, MakeFunction(this, &NetworkTest::CreateBenchmarkService), MakeFunction(this, &NetworkTest::DeleteEcho));
+
+        NetConfig serverConfig(SERVER_ROLE);
+        serverConfig.AddTransport(TRANSPORT_TCP, Endpoint(BENCHMARK_PORT));
+        serverConfig.AddService(SERVICE_BULK);
+        serverConfig.AddService(SERVICE_PING);
+
+        NetConfig clientConfig = serverConfig.Mirror(IPAddress("127.0.0.1"));
+
+        serverId = NetCore::Instance()->CreateController(serverConfig, reinterpret_cast<void*>(ECHO_SERVER_CONTEXT));
+        clientId = NetCore::Instance()->CreateController(clientConfig, reinterpret_cast<void*>(ECHO_CLIENT_CONTEXT));
+    }
+
+    IChannelListener* CreateBenchmarkService(uint32 serviceId, void* context)
+    {
+        bool isServer = (ECHO_SERVER_CONTEXT == reinterpret_cast<intptr_t>(context));
+        if (SERVICE_BULK == serviceId)
+            return isServer ? static_cast<IChannelListener*>(&bulkServer) : &bulkClient;
+        else if (SERVICE_PING == serviceId)
+            return isServer ? static_cast<IChannelListener*>(&pingServer) : &pingClient;
+        return nullptr;
+    }
+
     IChannelListener* CreateEcho(uint32 serviceId, void* context)
     {
         if (ECHO_SERVER_CONTEXT == reinterpret_cast<intptr_t>(context))
@@ -0,0 +1,224 @@
+#include <DAVAEngine.h>
+#include <UnitTests/UnitTests.h>
+
+#include <PerformanceStatistics/HeadlessReport.h>
+#include <PerformanceStatistics/SampleStatistics.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace SampleStatisticsTestDetails
+{
+using namespace DAVA;
+
+const float64 ALPHA = 0.05;
+const float32 MIN_RELATIVE_CHANGE = 0.05f;
+const uint32 BLOCK_SIZE = 30;
+
+// Frame-time-like samples: 10 ms with deterministic spread
+Vector<float32> CreateSamples(uint32 count, float32 offset)
+{
+    Vector<float32> samples;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        samples.push_back(10.0f + offset + static_cast<float32>((i * 7) % count) / count);
+    }
+    return samples;
+}
+
+// Samples with slow periodic drift (2 ms amplitude, 300 frames period) on top of per-frame spread
+Vector<float32> CreateDriftingSamples(uint32 count, float32 offset)
+{
+    Vector<float32> samples;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        float32 drift = 2.0f * std::sin(2.0f * PI * i / 300.0f);
+        samples.push_back(10.0f + offset + drift + static_cast<float32>((i * 7) % 50) / 50);
+    }
+    return samples;
+}
+
+HeadlessReport::TestResult CreateResult(const String& testName, float32 offset)
+{
+    HeadlessReport::TestResult result;
+    result.testName = testName;
+    result.frameTimes = CreateSamples(300, offset);
+    return result;
+}
+}
+
+DAVA_TESTCLASS (SampleStatisticsTest)
+{
+    DAVA_TEST (IdenticalSamplesTest)
+    {
+        using namespace DAVA;
+        using namespace SampleStatisticsTestDetails;
+
+        Vector<float32> samples = CreateSamples(50, 0.0f);
+        SampleStatistics::Comparison cmp = SampleStatistics::Compare(samples, samples, ALPHA, MIN_RELATIVE_CHANGE);
+        TEST_VERIFY(cmp.baselineMedian == cmp.currentMedian);
+        TEST_VERIFY(cmp.relativeChange == 0.0f);
+        TEST_VERIFY(cmp.pValue > 0.99);
+        TEST_VERIFY(!cmp.significant);
+    }
+
+    DAVA_TEST (ShiftedSamplesTest)
+    {
+        using namespace DAVA;
+        using namespace SampleStatisticsTestDetails;
+
+        Vector<float32> baseline = CreateSamples(50, 0.0f);
+        Vector<float32> slower = CreateSamples(50, 2.0f);
+
+        SampleStatistics::Comparison cmp = SampleStatistics::Compare(baseline, slower, ALPHA, MIN_RELATIVE_CHANGE);
+        TEST_VERIFY(cmp.pValue < 1e-6);
+        TEST_VERIFY(cmp.relativeChange > 0.15f && cmp.relativeChange < 0.25f);
+        TEST_VERIFY(cmp.significant);
+
+        cmp = SampleStatistics::Compare(slower, baseline, ALPHA, MIN_RELATIVE_CHANGE);
+        TEST_VERIFY(cmp.pValue < 1e-6);
+        TEST_VERIFY(cmp.relativeChange < 0.0f);
+        TEST_VERIFY(cmp.significant);
+
+        // statistically significant, but too small to be reported
+        Vector<float32> slightlySlower = CreateSamples(50, 0.2f);
+        cmp = SampleStatistics::Compare(baseline, slightlySlower, ALPHA, MIN_RELATIVE_CHANGE);
+        TEST_VERIFY(cmp.pValue < ALPHA);
+        TEST_VERIFY(!cmp.significant);
+    }
+
+    DAVA_TEST (TiesTest)
+    {
+        using namespace DAVA;
+        using namespace SampleStatisticsTestDetails;
+
+        // all samples are tied: no variance, no difference
+        Vector<float32> constant(20, 16.6f);
+        SampleStatistics::Comparison cmp = SampleStatistics::Compare(constant, constant, ALPHA, MIN_RELATIVE_CHANGE);
+        TEST_VERIFY(cmp.pValue == 1.0);
+        TEST_VERIFY(!cmp.significant);
+
+        // reference value with tie correction and continuity correction (W = 2, p = 0.02689)
+        Vector<float32> baseline = { 1.0f, 1.0f, 1.0f, 2.0f, 2.0f };
+        Vector<float32> current = { 2.0f, 2.0f, 3.0f, 3.0f, 3.0f };
+        cmp = SampleStatistics::Compare(baseline, current, ALPHA, MIN_RELATIVE_CHANGE);
+        TEST_VERIFY(std::abs(cmp.pValue - 0.026888) < 1e-4);
+        TEST_VERIFY(cmp.relativeChange == 2.0f);
+        TEST_VERIFY(cmp.significant);
+
+        // result does not depend on samples order
+        std::reverse(current.begin(), current.end());
+        SampleStatistics::Comparison reversed = SampleStatistics::Compare(baseline, current, ALPHA, MIN_RELATIVE_CHANGE);
+        TEST_VERIFY(reversed.pValue == cmp.pValue);
+    }
+
+    DAVA_TEST (SmallSetsTest)
+    {
+        using namespace DAVA;
+        using namespace SampleStatisticsTestDetails;
+
+        Vector<float32> samples = CreateSamples(50, 0.0f);
+        Vector<float32> empty;
+        Vector<float32> one = { 20.0f };
+
+        SampleStatistics::Comparison cmp = SampleStatistics::Compare(empty, samples, ALPHA, MIN_RELATIVE_CHANGE);
+        TEST_VERIFY(cmp.baselineMedian == 0.0f);
+        TEST_VERIFY(cmp.relativeChange == 0.0f);
+        TEST_VERIFY(cmp.pValue == 1.0);
+        TEST_VERIFY(!cmp.significant);
+
+        cmp = SampleStatistics::Compare(samples, empty, ALPHA, MIN_RELATIVE_CHANGE);
+        TEST_VERIFY(cmp.pValue == 1.0);
+        TEST_VERIFY(!cmp.significant);
+
+        cmp = SampleStatistics::Compare(empty, empty, ALPHA, MIN_RELATIVE_CHANGE);
+        TEST_VERIFY(cmp.pValue == 1.0);
+        TEST_VERIFY(!cmp.significant);
+
+        // single sample is twice slower, but can't be told from noise
+        cmp = SampleStatistics::Compare(samples, one, ALPHA, MIN_RELATIVE_CHANGE);
+        TEST_VERIFY(cmp.currentMedian == 20.0f);
+        TEST_VERIFY(cmp.relativeChange > 0.5f);
+        TEST_VERIFY(cmp.pValue == 1.0);
+        TEST_VERIFY(!cmp.significant);
+
+        cmp = SampleStatistics::Compare(one, one, ALPHA, MIN_RELATIVE_CHANGE);
+        TEST_VERIFY(cmp.pValue == 1.0);
+        TEST_VERIFY(!cmp.significant);
+
+        SampleStatistics::Summary summary = SampleStatistics::Summarize(one);
+        TEST_VERIFY(summary.count == 1);
+        TEST_VERIFY(summary.median == 20.0f && summary.p99 == 20.0f);
+        TEST_VERIFY(summary.stddev == 0.0f);
+    }
+
+    DAVA_TEST (BlockMediansTest)
+    {
+        using namespace DAVA;
+        using namespace SampleStatisticsTestDetails;
+
+        Vector<float32> samples = { 3.0f, 1.0f, 2.0f, 10.0f, 30.0f, 20.0f, 100.0f };
+        Vector<float32> medians = SampleStatistics::BlockMedians(samples, 3);
+        TEST_VERIFY(medians == Vector<float32>({ 2.0f, 20.0f }));
+
+        TEST_VERIFY(SampleStatistics::BlockMedians(samples, 1) == samples);
+        TEST_VERIFY(SampleStatistics::BlockMedians(samples, 0) == samples);
+        TEST_VERIFY(SampleStatistics::BlockMedians(samples, 8).empty());
+    }
+
+    DAVA_TEST (AutocorrelatedSamplesTest)
+    {
+        using namespace DAVA;
+        using namespace SampleStatisticsTestDetails;
+
+        // 3% shift is much smaller than slow drift within a run: neighbouring frames are not independent observations,
+        // so raw per-frame comparison overestimates significance
+        Vector<float32> baseline = CreateDriftingSamples(600, 0.0f);
+        Vector<float32> current = CreateDriftingSamples(600, 0.3f);
+        const float64 alpha = 0.01;
+        const float32 minRelativeChange = 0.02f;
+
+        SampleStatistics::Comparison raw = SampleStatistics::Compare(baseline, current, alpha, minRelativeChange);
+        TEST_VERIFY(raw.significant);
+
+        Vector<float32> baselineBlocks = SampleStatistics::BlockMedians(baseline, BLOCK_SIZE);
+        Vector<float32> currentBlocks = SampleStatistics::BlockMedians(current, BLOCK_SIZE);
+        TEST_VERIFY(baselineBlocks.size() == 20 && currentBlocks.size() == 20);
+
+        SampleStatistics::Comparison blocked = SampleStatistics::Compare(baselineBlocks, currentBlocks, alpha, minRelativeChange);
+        TEST_VERIFY(blocked.pValue > 0.1);
+        TEST_VERIFY(!blocked.significant);
+
+        // shift larger than the drift is still detected
+        Vector<float32> slower = CreateDriftingSamples(600, 5.0f);
+        blocked = SampleStatistics::Compare(baselineBlocks, SampleStatistics::BlockMedians(slower, BLOCK_SIZE), alpha, minRelativeChange);
+        TEST_VERIFY(blocked.significant);
+    }
+
+    DAVA_TEST (BaselineMatchingTest)
+    {
+        using namespace DAVA;
+        using namespace SampleStatisticsTestDetails;
+
+        // two tests on the same scene are matched with their own baselines
+        HeadlessReport baseline;
+        baseline.AddResult(CreateResult("MaterialsTest: city", 0.0f));
+        baseline.AddResult(CreateResult("UniversalTest: city", 5.0f));
+
+        HeadlessReport current;
+        current.AddResult(CreateResult("UniversalTest: city", 5.0f));
+        current.AddResult(CreateResult("MaterialsTest: city", 0.0f));
+        TEST_VERIFY(current.CompareWithBaseline(baseline, BLOCK_SIZE, ALPHA, MIN_RELATIVE_CHANGE) == 0);
+
+        HeadlessReport regressed;
+        regressed.AddResult(CreateResult("MaterialsTest: city", 2.0f));
+        regressed.AddResult(CreateResult("UniversalTest: city", 5.0f));
+        TEST_VERIFY(regressed.CompareWithBaseline(baseline, BLOCK_SIZE, ALPHA, MIN_RELATIVE_CHANGE) == 1);
+
+        // ambiguous results are not compared
+        HeadlessReport duplicated;
+        duplicated.AddResult(CreateResult("MaterialsTest: city", 2.0f));
+        duplicated.AddResult(CreateResult("MaterialsTest: city", 2.0f));
+        TEST_VERIFY(duplicated.CompareWithBaseline(baseline, BLOCK_SIZE, ALPHA, MIN_RELATIVE_CHANGE) == 0);
+    }
+};
@@ -0,0 +1,246 @@
+#include <DAVAEngine.h>
+#include <UnitTests/UnitTests.h>
+
+#include <FileSystem/FileSystem.h>
+#include <Render/Image/LibPVRHelper.h>
+#include <Render/ResourceRetentionCache.h>
+#include <Render/Texture.h>
+#include <Render/TextureDescriptor.h>
+#include <Time/SystemTimer.h>
+
+#include <memory>
+
+namespace TextureRetentionCacheTestDetails
+{
+using namespace DAVA;
+
+const String workingFolder("~doc:/TestData/TextureRetentionCacheTest/");
+const uint32 TEXTURES_COUNT = 100;
+const uint32 SCREEN_OPENINGS = 10;
+const eGPUFamily GPU = eGPUFamily::GPU_POWERVR_IOS;
+const PixelFormat FORMAT = PixelFormat::FORMAT_RGBA4444;
+
+FilePath GetTexturePathname(uint32 index)
+{
+    return FilePath(workingFolder + Format("texture%u.tex", index));
+}
+
+bool Prepare()
+{
+    if (FileSystem::Instance()->CreateDirectory(workingFolder, true) == FileSystem::DIRECTORY_CANT_CREATE)
+        return false;
+
+    LibPVRHelper helper;
+    for (uint32 i = 0; i < TEXTURES_COUNT; ++i)
+    {
+        std::unique_ptr<TextureDescriptor> descriptor(new TextureDescriptor());
+        descriptor->SetGenerateMipmaps(false);
+        descriptor->compression[GPU].format = FORMAT;
+        descriptor->compression[GPU].imageFormat = ImageFormat::IMAGE_FORMAT_PVR;
+        descriptor->pathname = GetTexturePathname(i);
+        descriptor->Save();
+
+        ScopedPtr<Image> image(Image::Create(64, 64, FORMAT));
+        eErrorCode writeResult = helper.WriteFile(descriptor->CreateMultiMipPathnameForGPU(GPU), { image }, FORMAT, ImageQuality::DEFAULT_IMAGE_QUALITY);
+        if (writeResult != eErrorCode::SUCCESS)
+            return false;
+    }
+
+    return true;
+}
+
+// Screen uses all textures while it is opened and releases them in the loading order on closing
+void OpenAndCloseScreen(Vector<Texture*>& textures)
+{
+    textures.resize(TEXTURES_COUNT);
+    for (uint32 i = 0; i < TEXTURES_COUNT; ++i)
+    {
+        textures[i] = Texture::CreateFromFile(GetTexturePathname(i));
+    }
+
+    for (Texture* texture : textures)
+    {
+        texture->Release();
+    }
+}
+
+int64 OpenAndCloseScreenRepeatedly()
+{
+    int64 startTime = SystemTimer::GetUs();
+
+    Vector<Texture*> textures;
+    for (uint32 i = 0; i < SCREEN_OPENINGS; ++i)
+    {
+        OpenAndCloseScreen(textures);
+    }
+
+    return SystemTimer::GetUs() - startTime;
+}
+}
+
+DAVA_TESTCLASS (TextureRetentionCacheTest)
+{
+    DAVA::Vector<DAVA::eGPUFamily> originalGPULoadingOrder;
+    DAVA::uint32 originalBudget = 0;
+    DAVA::uint32 textureDataSize = 0;
+    bool prepared = false;
+
+    TextureRetentionCacheTest()
+    {
+        using namespace DAVA;
+        using namespace TextureRetentionCacheTestDetails;
+
+        originalGPULoadingOrder = Texture::GetGPULoadingOrder();
+        originalBudget = Texture::GetRetentionCache().GetBudget();
+
+        prepared = Prepare();
+        Texture::SetGPULoadingOrder({ GPU });
+
+        ScopedPtr<Texture> texture(Texture::CreateFromFile(GetTexturePathname(0)));
+        prepared = prepared && !texture->IsPinkPlaceholder();
+        textureDataSize = texture->GetDataSize();
+    }
+
+    ~TextureRetentionCacheTest()
+    {
+        using namespace DAVA;
+        using namespace TextureRetentionCacheTestDetails;
+
+        ResourceRetentionCache& cache = Texture::GetRetentionCache();
+        cache.SetEnabled(false);
+        cache.SetBudget(originalBudget);
+        cache.ResetStats();
+        Texture::SetGPULoadingOrder(originalGPULoadingOrder);
+
+        FileSystem::Instance()->DeleteDirectory(workingFolder, true);
+    }
+
+    DAVA_TEST (OpenAndCloseScreenTest)
+    {
+        using namespace DAVA;
+        using namespace TextureRetentionCacheTestDetails;
+
+        TEST_VERIFY(prepared);
+
+        ResourceRetentionCache& cache = Texture::GetRetentionCache();
+        cache.SetBudget(TEXTURES_COUNT * textureDataSize);
+
+        cache.SetEnabled(false);
+        cache.ResetStats();
+        int64 timeWithoutCache = OpenAndCloseScreenRepeatedly();
+        ResourceRetentionCache::Stats statsWithoutCache = cache.GetStats();
+
+        TEST_VERIFY(statsWithoutCache.misses == TEXTURES_COUNT * SCREEN_OPENINGS);
+        TEST_VERIFY(statsWithoutCache.hits == 0);
+        TEST_VERIFY(statsWithoutCache.resourcesCount == 0);
+
+        cache.SetEnabled(true);
+        cache.ResetStats();
+        int64 timeWithCache = OpenAndCloseScreenRepeatedly();
+        ResourceRetentionCache::Stats statsWithCache = cache.GetStats();
+
+        // textures are loaded once and revived on every next opening
+        TEST_VERIFY(statsWithCache.misses == TEXTURES_COUNT);
+        TEST_VERIFY(statsWithCache.hits == TEXTURES_COUNT * (SCREEN_OPENINGS - 1));
+        TEST_VERIFY(statsWithCache.evictions == 0);
+        TEST_VERIFY(statsWithCache.resourcesCount == TEXTURES_COUNT);
+        TEST_VERIFY(statsWithCache.memory == TEXTURES_COUNT * textureDataSize);
+        TEST_VERIFY(statsWithCache.memoryByFormat.size() == 1);
+        TEST_VERIFY(statsWithCache.memoryByFormat[std::make_pair(GPU, FORMAT)] == statsWithCache.memory);
+
+        Logger::Info("[TextureRetentionCacheTest] %u screen openings with %u textures: without cache %u loads in %lld us, with cache %u loads in %lld us",
+                     SCREEN_OPENINGS, TEXTURES_COUNT, statsWithoutCache.misses, timeWithoutCache, statsWithCache.misses, timeWithCache);
+
+        // revived texture is the same object and is used as loaded one
+        Texture* retained = nullptr;
+        {
+            ScopedPtr<Texture> texture(Texture::CreateFromFile(GetTexturePathname(0)));
+            retained = texture;
+            TEST_VERIFY(texture->GetRetainCount() == 1);
+
+            ScopedPtr<Texture> mapped(Texture::Get(GetTexturePathname(0)));
+            TEST_VERIFY(mapped == retained);
+        }
+        ScopedPtr<Texture> revived(Texture::CreateFromFile(GetTexturePathname(0)));
+        TEST_VERIFY(revived == retained);
+
+        cache.SetEnabled(false);
+        TEST_VERIFY(cache.GetStats().resourcesCount == 0);
+    }
+
+    DAVA_TEST (BudgetTest)
+    {
+        using namespace DAVA;
+        using namespace TextureRetentionCacheTestDetails;
+
+        const uint32 retainedCount = TEXTURES_COUNT / 2;
+
+        ResourceRetentionCache& cache = Texture::GetRetentionCache();
+        cache.SetBudget(retainedCount * textureDataSize);
+        cache.SetEnabled(true);
+        cache.ResetStats();
+
+        Vector<Texture*> textures;
+        OpenAndCloseScreen(textures);
+
+        ResourceRetentionCache::Stats stats = cache.GetStats();
+        TEST_VERIFY(stats.resourcesCount == retainedCount);
+        TEST_VERIFY(stats.evictions == TEXTURES_COUNT - retainedCount);
+        TEST_VERIFY(stats.memory <= cache.GetBudget());
+
+        // first released textures were evicted
+        cache.ResetStats();
+        OpenAndCloseScreen(textures);
+        stats = cache.GetStats();
+        TEST_VERIFY(stats.misses == TEXTURES_COUNT - retainedCount);
+        TEST_VERIFY(stats.hits == retainedCount);
+
+        cache.SetBudget(0);
+        TEST_VERIFY(cache.GetStats().resourcesCount == 0);
+
+        cache.SetEnabled(false);
+    }
+
+    DAVA_TEST (InvalidationTest)
+    {
+        using namespace DAVA;
+        using namespace TextureRetentionCacheTestDetails;
+
+        ResourceRetentionCache& cache = Texture::GetRetentionCache();
+        cache.SetBudget(TEXTURES_COUNT * textureDataSize);
+        cache.SetEnabled(true);
+
+        Vector<Texture*> textures;
+        OpenAndCloseScreen(textures);
+        TEST_VERIFY(cache.GetStats().resourcesCount == TEXTURES_COUNT);
+
+        // retained textures were loaded for previous GPU
+        Texture::SetGPULoadingOrder({ GPU });
+        TEST_VERIFY(cache.GetStats().resourcesCount == 0);
+
+        OpenAndCloseScreen(textures);
+        TEST_VERIFY(cache.GetStats().resourcesCount == TEXTURES_COUNT);
+
+        // retained textures have filters of previous pixelization mode
+        Texture::SetPixelization(true);
+        TEST_VERIFY(cache.GetStats().resourcesCount == 0);
+        Texture::SetPixelization(false);
+
+        OpenAndCloseScreen(textures);
+        TEST_VERIFY(cache.GetStats().resourcesCount == TEXTURES_COUNT);
+
+        // reloaded texture keeps working after revival
+        {
+            ScopedPtr<Texture> texture(Texture::CreateFromFile(GetTexturePathname(1)));
+            texture->ReloadAs(GPU);
+            TEST_VERIFY(!texture->IsPinkPlaceholder());
+        }
+        ScopedPtr<Texture> texture(Texture::CreateFromFile(GetTexturePathname(1)));
+        TEST_VERIFY(texture->GetState() == Texture::STATE_VALID);
+
+        cache.Clear();
+        TEST_VERIFY(cache.GetStats().resourcesCount == 0);
+
+        cache.SetEnabled(false);
+    }
+};
@@ -0,0 +1,215 @@
+#include "Base/FrameAllocator.h"
+#include "Concurrency/LockGuard.h"
+#include "Concurrency/Mutex.h"
+#include "Concurrency/ThreadLocalPtr.h"
+
+#include <atomic>
+
+namespace DAVA
+{
+namespace FrameAllocatorDetails
+{
+std::atomic<uint32> frameIndex{ 1 };
+std::atomic<bool> enabled{ true };
+
+// Arenas are owned here, so memory of threads that have exited is released on shutdown
+Mutex arenasMutex;
+Vector<std::unique_ptr<FrameArena>> arenas;
+
+ThreadLocalPtr<FrameArena>& GetThreadArenaPtr()
+{
+    static ThreadLocalPtr<FrameArena> threadArena([](FrameArena*) {});
+    return threadArena;
+}
+
+size_t AlignOffset(const uint8* base, size_t offset, size_t alignment)
+{
+    uintptr_t address = reinterpret_cast<uintptr_t>(base) + offset;
+    uintptr_t aligned = (address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    return offset + static_cast<size_t>(aligned - address);
+}
+}
+
+FrameArena::FrameArena(size_t pageSize_)
+    : pageSize(pageSize_)
+    , frameIndex(FrameAllocator::GetFrameIndex())
+{
+}
+
+FrameArena::~FrameArena()
+{
+    for (Page& page : pages)
+    {
+        delete[] page.data;
+    }
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+    DVASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+    SyncFrame();
+
+    if (pages.empty())
+    {
+        AddPage(size + alignment);
+    }
+
+    size_t offset = FrameAllocatorDetails::AlignOffset(pages[currentPage].data, currentOffset, alignment);
+    while (offset + size > pages[currentPage].size)
+    {
+        usedInPreviousPages += pages[currentPage].size;
+        currentPage += 1;
+        currentOffset = 0;
+        if (currentPage == pages.size() || pages[currentPage].size < size + alignment)
+        {
+            AddPage(size + alignment);
+        }
+        offset = FrameAllocatorDetails::AlignOffset(pages[currentPage].data, 0, alignment);
+    }
+
+    void* result = pages[currentPage].data + offset;
+    currentOffset = offset + size;
+
+    statistics.usedBytes = usedInPreviousPages + currentOffset;
+    statistics.peakBytes = Max(statistics.peakBytes, statistics.usedBytes);
+    return result;
+}
+
+void FrameArena::Deallocate(void* ptr, size_t size)
+{
+    if (pages.empty() || ptr == nullptr)
+        return;
+
+    uint8* bytes = static_cast<uint8*>(ptr);
+    Page& page = pages[currentPage];
+    if (bytes + size == page.data + currentOffset)
+    {
+        currentOffset = static_cast<size_t>(bytes - page.data);
+        statistics.usedBytes = usedInPreviousPages + currentOffset;
+    }
+}
+
+FrameArena::Marker FrameArena::GetMarker()
+{
+    SyncFrame();
+
+    Marker marker;
+    marker.page = currentPage;
+    marker.offset = currentOffset;
+    marker.frameIndex = frameIndex;
+    return marker;
+}
+
+void FrameArena::Rewind(const Marker& marker)
+{
+    if (marker.frameIndex != frameIndex)
+    {
+        DVASSERT(false, "Frame arena marker is used after its frame has ended");
+        return;
+    }
+
+    DVASSERT(marker.page < currentPage || (marker.page == currentPage && marker.offset <= currentOffset));
+    while (currentPage > marker.page)
+    {
+        currentPage -= 1;
+        usedInPreviousPages -= pages[currentPage].size;
+    }
+    currentOffset = marker.offset;
+    statistics.usedBytes = usedInPreviousPages + currentOffset;
+}
+
+void FrameArena::Reset(uint32 frameIndex_)
+{
+#if defined(__DAVAENGINE_DEBUG__)
+    // make data of outlived pointers obviously broken
+    for (size_t i = 0; i <= currentPage && i < pages.size(); ++i)
+    {
+        size_t used = (i == currentPage) ? currentOffset : pages[i].size;
+        Memset(pages[i].data, 0xfe, used);
+    }
+#endif
+
+    frameIndex = frameIndex_;
+    currentPage = 0;
+    currentOffset = 0;
+    usedInPreviousPages = 0;
+    statistics.usedBytes = 0;
+}
+
+void FrameArena::SyncFrame()
+{
+    uint32 globalFrameIndex = FrameAllocator::GetFrameIndex();
+    if (frameIndex != globalFrameIndex)
+    {
+        Reset(globalFrameIndex);
+    }
+}
+
+void FrameArena::AddPage(size_t minSize)
+{
+    Page page;
+    page.size = Max(pageSize, minSize);
+    page.data = new uint8[page.size];
+
+    // keep filled pages before the current one, pages left from previous frames are reused later
+    if (currentPage < pages.size())
+    {
+        pages.insert(pages.begin() + currentPage, page);
+    }
+    else
+    {
+        currentPage = pages.size();
+        pages.push_back(page);
+    }
+
+    statistics.reservedBytes += page.size;
+    statistics.pageAllocations += 1;
+}
+
+FrameAllocator::ScopedMarker::ScopedMarker()
+    : arena(FrameAllocator::GetThreadArena())
+    , marker(arena->GetMarker())
+{
+}
+
+FrameAllocator::ScopedMarker::~ScopedMarker()
+{
+    arena->Rewind(marker);
+}
+
+void FrameAllocator::NextFrame()
+{
+    FrameAllocatorDetails::frameIndex += 1;
+}
+
+uint32 FrameAllocator::GetFrameIndex()
+{
+    return FrameAllocatorDetails::frameIndex.load(std::memory_order_relaxed);
+}
+
+FrameArena* FrameAllocator::GetThreadArena()
+{
+    ThreadLocalPtr<FrameArena>& threadArena = FrameAllocatorDetails::GetThreadArenaPtr();
+    FrameArena* arena = threadArena.Get();
+    if (arena == nullptr)
+    {
+        arena = new FrameArena();
+        threadArena.Reset(arena);
+
+        LockGuard<Mutex> lock(FrameAllocatorDetails::arenasMutex);
+        FrameAllocatorDetails::arenas.emplace_back(arena);
+    }
+    return arena;
+}
+
+void FrameAllocator::SetEnabled(bool enabled)
+{
+    FrameAllocatorDetails::enabled = enabled;
+}
+
+bool FrameAllocator::IsEnabled()
+{
+    return FrameAllocatorDetails::enabled.load(std::memory_order_relaxed);
+}
+}
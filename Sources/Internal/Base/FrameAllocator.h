@@ -0,0 +1,234 @@
+#pragma once
+
+#include "Base/BaseTypes.h"
+#include "Debug/DVAssert.h"
+
+#include <limits>
+#include <memory>
+
+namespace DAVA
+{
+/**
+    \brief Linear allocator for temporary data living not longer than one frame.
+
+    Memory is taken from pages which are kept between frames, so in steady state allocations
+    don't touch the general heap. Deallocation only rolls back the most recent allocation,
+    everything else is released at once when arena is reset at the beginning of the next frame.
+    Arena is not thread-safe, each thread uses its own one (see FrameAllocator::GetThreadArena).
+*/
+class FrameArena final
+{
+public:
+    static const size_t DEFAULT_PAGE_SIZE = 64 * 1024;
+
+    struct Marker
+    {
+        size_t page = 0;
+        size_t offset = 0;
+        uint32 frameIndex = 0;
+    };
+
+    struct Statistics
+    {
+        size_t usedBytes = 0; // bytes consumed in current frame, including tails of filled pages
+        size_t peakBytes = 0; // max bytes used in a single frame
+        size_t reservedBytes = 0; // size of all pages
+        uint32 pageAllocations = 0; // number of heap allocations made by arena
+    };
+
+    explicit FrameArena(size_t pageSize = DEFAULT_PAGE_SIZE);
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* Allocate(size_t size, size_t alignment);
+    /** Roll back allocation if it is the last one made from arena, otherwise do nothing. */
+    void Deallocate(void* ptr, size_t size);
+
+    Marker GetMarker();
+    void Rewind(const Marker& marker);
+
+    /** Release all allocations and bind arena to frame `frameIndex`. In debug builds released memory is filled with garbage. */
+    void Reset(uint32 frameIndex);
+    uint32 GetFrameIndex() const;
+
+    const Statistics& GetStatistics() const;
+
+private:
+    struct Page
+    {
+        uint8* data = nullptr;
+        size_t size = 0;
+    };
+
+    void SyncFrame();
+    void AddPage(size_t minSize);
+
+    Vector<Page> pages;
+    size_t pageSize = DEFAULT_PAGE_SIZE;
+    size_t currentPage = 0;
+    size_t currentOffset = 0;
+    size_t usedInPreviousPages = 0;
+    uint32 frameIndex = 0;
+    Statistics statistics;
+};
+
+/**
+    \brief Per-thread frame arenas.
+
+    Frame counter is advanced by engine once per frame, arena of each thread is reset lazily on its first
+    use in the new frame. Pointers and containers taken from arenas must not outlive the frame they were
+    created in; debug builds assert when a frame container is used in a later frame.
+    When disabled, FrameStlAllocator uses general heap, which allows memory tools to track frame containers.
+*/
+class FrameAllocator final
+{
+public:
+    /** Restore arena position on scope exit. */
+    class ScopedMarker final
+    {
+    public:
+        ScopedMarker();
+        ~ScopedMarker();
+
+        ScopedMarker(const ScopedMarker&) = delete;
+        ScopedMarker& operator=(const ScopedMarker&) = delete;
+
+    private:
+        FrameArena* arena = nullptr;
+        FrameArena::Marker marker;
+    };
+
+    static void NextFrame();
+    static uint32 GetFrameIndex();
+
+    static FrameArena* GetThreadArena();
+
+    static void SetEnabled(bool enabled);
+    static bool IsEnabled();
+};
+
+/**
+    \brief STL allocator adapter taking memory from the frame arena of the thread it was created on.
+*/
+template <typename T>
+class FrameStlAllocator
+{
+public:
+    using value_type = T;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using reference = T&;
+    using const_reference = const T&;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = FrameStlAllocator<U>;
+    };
+
+    FrameStlAllocator();
+    FrameStlAllocator(const FrameStlAllocator&) = default;
+    template <typename U>
+    FrameStlAllocator(const FrameStlAllocator<U>& other) DAVA_NOEXCEPT;
+
+    pointer allocate(size_type n);
+    void deallocate(pointer ptr, size_type n);
+
+    size_type max_size() const DAVA_NOEXCEPT
+    {
+        return std::numeric_limits<size_type>::max() / sizeof(T);
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* ptr, Args&&... args)
+    {
+        ::new (static_cast<void*>(ptr)) U(std::forward<Args>(args)...);
+    }
+
+    template <typename U>
+    void destroy(U* ptr)
+    {
+        ptr->~U();
+    }
+
+    FrameArena* arena = nullptr; // nullptr if frame allocator was disabled
+    uint32 frameIndex = 0;
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameStlAllocator<T>>;
+
+template <typename T>
+FrameStlAllocator<T>::FrameStlAllocator()
+{
+    if (FrameAllocator::IsEnabled())
+    {
+        arena = FrameAllocator::GetThreadArena();
+        frameIndex = FrameAllocator::GetFrameIndex();
+    }
+}
+
+template <typename T>
+template <typename U>
+FrameStlAllocator<T>::FrameStlAllocator(const FrameStlAllocator<U>& other) DAVA_NOEXCEPT
+    : arena(other.arena)
+    , frameIndex(other.frameIndex)
+{
+}
+
+template <typename T>
+typename FrameStlAllocator<T>::pointer FrameStlAllocator<T>::allocate(size_type n)
+{
+    if (arena == nullptr)
+    {
+        return static_cast<pointer>(::operator new(n * sizeof(T)));
+    }
+
+    DVASSERT(arena == FrameAllocator::GetThreadArena(), "Frame container is used from another thread");
+    DVASSERT(frameIndex == FrameAllocator::GetFrameIndex(), "Frame container is used after its frame has ended");
+    return static_cast<pointer>(arena->Allocate(n * sizeof(T), alignof(T)));
+}
+
+template <typename T>
+void FrameStlAllocator<T>::deallocate(pointer ptr, size_type n)
+{
+    if (arena == nullptr)
+    {
+        ::operator delete(ptr);
+    }
+    else if (frameIndex == arena->GetFrameIndex())
+    {
+        arena->Deallocate(ptr, n * sizeof(T));
+    }
+    else
+    {
+        DVASSERT(false, "Frame container is destroyed after its frame has ended");
+    }
+}
+
+template <typename T1, typename T2>
+inline bool operator==(const FrameStlAllocator<T1>& a, const FrameStlAllocator<T2>& b)
+{
+    return a.arena == b.arena;
+}
+
+template <typename T1, typename T2>
+inline bool operator!=(const FrameStlAllocator<T1>& a, const FrameStlAllocator<T2>& b)
+{
+    return a.arena != b.arena;
+}
+
+inline uint32 FrameArena::GetFrameIndex() const
+{
+    return frameIndex;
+}
+
+inline const FrameArena::Statistics& FrameArena::GetStatistics() const
+{
+    return statistics;
+}
+}
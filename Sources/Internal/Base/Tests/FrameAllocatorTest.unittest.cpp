@@ -0,0 +1,214 @@
+#include "UnitTests/UnitTests.h"
+
+#include "Base/FrameAllocator.h"
+#include "Base/ScopedPtr.h"
+#include "Logger/Logger.h"
+#include "Math/Transform.h"
+#include "MemoryManager/MemoryManager.h"
+#include "Render/3D/PolygonGroup.h"
+#include "Render/Highlevel/Camera.h"
+#include "Render/Highlevel/GeometryGenerator.h"
+#include "Render/Highlevel/Mesh.h"
+#include "Render/Material/NMaterial.h"
+#include "Render/Material/NMaterialNames.h"
+#include "Scene3D/Components/ComponentHelpers.h"
+#include "Scene3D/Components/RenderComponent.h"
+#include "Scene3D/Components/TransformComponent.h"
+#include "Scene3D/Entity.h"
+#include "Scene3D/Scene.h"
+#include "Time/SystemTimer.h"
+
+using namespace DAVA;
+
+namespace FrameAllocatorTestDetails
+{
+#if defined(DAVA_MEMORY_PROFILING_ENABLE)
+// Number of heap allocations made so far, heap allocations are tracked only by memory profiler
+uint32 GetHeapAllocationCounter(Vector<uint8>& statBuffer)
+{
+    MemoryManager* memoryManager = MemoryManager::Instance();
+    statBuffer.resize(memoryManager->CalcCurStatSize());
+    memoryManager->GetCurStat(0, statBuffer.data(), static_cast<uint32>(statBuffer.size()));
+    return reinterpret_cast<const MMCurStat*>(statBuffer.data())->statGeneral.nextBlockNo;
+}
+#endif
+
+void CreateScene(Scene* scene, int32 gridSize)
+{
+    Map<FastName, float32> options;
+    ScopedPtr<PolygonGroup> geometry(GeometryGenerator::GenerateBox(AABBox3(Vector3(-1.f, -1.f, 0.f), Vector3(1.f, 1.f, 2.f)), options));
+    ScopedPtr<NMaterial> parentMaterial(new NMaterial());
+    parentMaterial->SetFXName(NMaterialName::TEXTURED_OPAQUE);
+
+    for (int32 y = 0; y < gridSize; ++y)
+    {
+        for (int32 x = 0; x < gridSize; ++x)
+        {
+            ScopedPtr<NMaterial> material(new NMaterial());
+            material->SetParent(parentMaterial);
+
+            ScopedPtr<Mesh> mesh(new Mesh());
+            mesh->AddPolygonGroup(geometry, material);
+
+            ScopedPtr<Entity> entity(new Entity());
+            entity->AddComponent(new RenderComponent(mesh));
+            GetTransformComponent(entity)->SetLocalTransform(Transform(Vector3(x * 8.f, y * 8.f, 0.f)));
+            scene->AddNode(entity);
+        }
+    }
+
+    ScopedPtr<Camera> camera(new Camera());
+    camera->SetupPerspective(70.f, 1.f, 1.f, 300.f);
+    camera->SetUp(Vector3(0.f, 0.f, 1.f));
+    camera->SetPosition(Vector3(-10.f, -10.f, 30.f));
+    camera->SetTarget(Vector3(gridSize * 2.f, gridSize * 2.f, 0.f));
+    scene->AddCamera(camera);
+    scene->SetCurrentCamera(camera);
+}
+
+struct FrameStatistics
+{
+    int64 frameTimeUs = 0;
+    uint32 heapAllocations = 0; // 0 if memory profiling is disabled
+};
+
+FrameStatistics MeasureFrames(Scene* scene, uint32 framesCount)
+{
+    FrameStatistics result;
+#if defined(DAVA_MEMORY_PROFILING_ENABLE)
+    Vector<uint8> statBuffer;
+    GetHeapAllocationCounter(statBuffer);
+    uint32 startAllocations = GetHeapAllocationCounter(statBuffer);
+#endif
+
+    int64 startTime = SystemTimer::GetUs();
+    for (uint32 i = 0; i < framesCount; ++i)
+    {
+        FrameAllocator::NextFrame();
+        scene->Update(0.016f);
+        scene->Draw();
+    }
+    result.frameTimeUs = (SystemTimer::GetUs() - startTime) / framesCount;
+
+#if defined(DAVA_MEMORY_PROFILING_ENABLE)
+    result.heapAllocations = (GetHeapAllocationCounter(statBuffer) - startAllocations) / framesCount;
+#endif
+    return result;
+}
+}
+
+DAVA_TESTCLASS (FrameAllocatorTest)
+{
+    DAVA_TEST (ArenaTest)
+    {
+        FrameArena arena(1024);
+        arena.Reset(FrameAllocator::GetFrameIndex());
+
+        void* a = arena.Allocate(10, 1);
+        void* b = arena.Allocate(16, 16);
+        TEST_VERIFY(reinterpret_cast<uintptr_t>(b) % 16 == 0);
+        TEST_VERIFY(static_cast<uint8*>(b) >= static_cast<uint8*>(a) + 10);
+
+        // last allocation is rolled back
+        arena.Deallocate(b, 16);
+        void* c = arena.Allocate(16, 16);
+        TEST_VERIFY(b == c);
+
+        // not last allocation stays
+        arena.Deallocate(a, 10);
+        TEST_VERIFY(arena.Allocate(1, 1) != a);
+
+        FrameArena::Marker marker = arena.GetMarker();
+        size_t usedBytes = arena.GetStatistics().usedBytes;
+        arena.Allocate(600, 8);
+        arena.Allocate(600, 8); // doesn't fit to the first page
+        arena.Allocate(4096, 8); // bigger than page size
+        TEST_VERIFY(arena.GetStatistics().pageAllocations == 3);
+        arena.Rewind(marker);
+        TEST_VERIFY(arena.GetStatistics().usedBytes == usedBytes);
+
+        // pages are reused in the next frames
+        for (uint32 frame = 0; frame < 3; ++frame)
+        {
+            FrameAllocator::NextFrame();
+            arena.Allocate(600, 8);
+            arena.Allocate(600, 8);
+            arena.Allocate(4096, 8);
+            TEST_VERIFY(arena.GetFrameIndex() == FrameAllocator::GetFrameIndex());
+        }
+        TEST_VERIFY(arena.GetStatistics().pageAllocations == 3);
+        TEST_VERIFY(arena.GetStatistics().peakBytes >= 600 + 600 + 4096);
+    }
+
+    DAVA_TEST (FrameVectorTest)
+    {
+        FrameArena* arena = FrameAllocator::GetThreadArena();
+
+        uint32 pageAllocations = 0;
+        for (uint32 frame = 0; frame < 4; ++frame)
+        {
+            FrameAllocator::NextFrame();
+            {
+                FrameAllocator::ScopedMarker marker;
+
+                FrameVector<uint32> values;
+                for (uint32 i = 0; i < 10000; ++i)
+                {
+                    values.push_back(i);
+                }
+                TEST_VERIFY(values.size() == 10000 && values.back() == 9999);
+
+                FrameVector<Vector3> points(100, Vector3(1.f, 2.f, 3.f));
+                TEST_VERIFY(points[99] == Vector3(1.f, 2.f, 3.f));
+            }
+            TEST_VERIFY(arena->GetStatistics().usedBytes == 0);
+
+            if (frame == 0)
+            {
+                pageAllocations = arena->GetStatistics().pageAllocations;
+            }
+        }
+
+        // no heap allocations after the first frame
+        TEST_VERIFY(arena->GetStatistics().pageAllocations == pageAllocations);
+
+        FrameAllocator::SetEnabled(false);
+        FrameVector<uint32> heapValues(100, 1);
+        TEST_VERIFY(heapValues.get_allocator().arena == nullptr);
+        FrameAllocator::SetEnabled(true);
+    }
+
+    DAVA_TEST (FrameBenchmark)
+    {
+        using namespace FrameAllocatorTestDetails;
+
+        const int32 gridSize = 64;
+        const uint32 framesCount = 30;
+
+        ScopedPtr<Scene> scene(new Scene());
+        CreateScene(scene, gridSize);
+        MeasureFrames(scene, 2); // warm up
+
+        FrameAllocator::SetEnabled(false);
+        FrameStatistics heapFrames = MeasureFrames(scene, framesCount);
+        FrameAllocator::SetEnabled(true);
+        FrameStatistics arenaFrames = MeasureFrames(scene, framesCount);
+
+        const FrameArena::Statistics& arenaStats = FrameAllocator::GetThreadArena()->GetStatistics();
+
+#if defined(DAVA_MEMORY_PROFILING_ENABLE)
+        TEST_VERIFY(arenaFrames.heapAllocations <= heapFrames.heapAllocations);
+
+        Logger::Info("FrameAllocator benchmark (%d objects): heap containers %lld us/frame, %u allocations/frame; "
+                     "frame arena %lld us/frame, %u allocations/frame; arena peak %u bytes, %u pages",
+                     gridSize * gridSize, heapFrames.frameTimeUs, heapFrames.heapAllocations,
+                     arenaFrames.frameTimeUs, arenaFrames.heapAllocations,
+                     static_cast<uint32>(arenaStats.peakBytes), arenaStats.pageAllocations);
+#else
+        Logger::Warning("FrameAllocator benchmark: heap allocations are not counted, rebuild with DAVA_MEMORY_PROFILING_ENABLE to compare them");
+        Logger::Info("FrameAllocator benchmark (%d objects): heap containers %lld us/frame; frame arena %lld us/frame; arena peak %u bytes, %u pages",
+                     gridSize * gridSize, heapFrames.frameTimeUs, arenaFrames.frameTimeUs,
+                     static_cast<uint32>(arenaStats.peakBytes), arenaStats.pageAllocations);
+#endif
+    }
+};
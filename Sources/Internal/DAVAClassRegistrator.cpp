@@ -1,6 +1,7 @@
 #include "DAVAEngine.h"
 #include "DAVAClassRegistrator.h"
 #include "Render/Highlevel/ShadowVolume.h"
+#include "Render/Highlevel/MergedMeshRenderObject.h"
 #include "Engine/Engine.h"
 
 #if defined(__DAVAENGINE_PHYSICS_ENABLED__)
@@ -44,6 +45,7 @@ REGISTER_CLASS_WITH_NAMESPACE(Landscape, DAVA::);
 REGISTER_CLASS_WITH_NAMESPACE(AnimationData, DAVA::);
 REGISTER_CLASS_WITH_NAMESPACE(Light, DAVA::);
 REGISTER_CLASS_WITH_NAMESPACE(Mesh, DAVA::);
+REGISTER_CLASS_WITH_NAMESPACE(MergedMeshRenderObject, DAVA::);
 REGISTER_CLASS_WITH_NAMESPACE(SkinnedMesh, DAVA::);
 REGISTER_CLASS_WITH_NAMESPACE(SpeedTreeObject, DAVA::);
 REGISTER_CLASS_WITH_NAMESPACE(RenderBatch, DAVA::);
@@ -47,6 +47,17 @@ void DebugOverlayItemRenderStats::Draw()
             AddUIntStat("Material Param Bind", stats.materialParamBindCount);
         }
 
+        if (ImGui::CollapsingHeader("3D"))
+        {
+            AddUIntStat("Visible Render Objects", stats.visibleRenderObjects);
+            AddUIntStat("Packets", stats.renderPackets3d);
+            AddUIntStat("Triangles", stats.triangles3d);
+            for (const auto& layer : stats.layerBatches)
+            {
+                AddUIntStat(layer.first.c_str(), layer.second);
+            }
+        }
+
         if (ImGui::CollapsingHeader("2D"))
         {
             AddUIntStat("Batches", stats.batches2d);
@@ -27,6 +27,7 @@ const char* UI_RENDER_SYSTEM = "UIRenderSystem";
 
 const char* UI_TEXTBLOCK_RECALC_PARAMS = "UI::TextBlock::CalculateParams";
 const char* UI_TEXTBLOCK_PREPARE = "UI::TextBlock::Prepare";
+const char* UI_TEXTBLOCK_BATCH_LAYOUT = "UI::TextBlock::BatchLayout";
 
 //Scene
 const char* SCENE_UPDATE = "Scene::Update";
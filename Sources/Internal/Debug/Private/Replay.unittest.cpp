@@ -0,0 +1,586 @@
+#include "UnitTests/UnitTests.h"
+
+#include "Base/RefPtr.h"
+#include "Base/ScopedPtr.h"
+#include "Debug/ProfilerCPU.h"
+#include "Debug/Replay.h"
+#include "DeviceManager/DeviceManager.h"
+#include "Engine/Engine.h"
+#include "FileSystem/File.h"
+#include "FileSystem/FileSystem.h"
+#include "Input/ActionSystem.h"
+#include "Input/InputDevice.h"
+#include "Input/InputElements.h"
+#include "Input/InputEvent.h"
+#include "Input/InputSystem.h"
+#include "Logger/Logger.h"
+#include "Math/Vector.h"
+#include "Render/2D/Systems/VirtualCoordinatesSystem.h"
+#include "UI/UIControlSystem.h"
+#include "UI/UIEvent.h"
+#include "UI/UIScreen.h"
+#include "Utils/CRC32.h"
+#include "Utils/Random.h"
+
+using namespace DAVA;
+
+namespace ReplayTestDetails
+{
+const uint32 FRAMES_COUNT = 600;
+const uint32 CHECKPOINT_PERIOD = 30;
+
+// Ids which don't clash with live devices, so only recorded input can reach bindings to them
+const uint32 KEYBOARD_ID = 101;
+const uint32 MOUSE_ID = 102;
+const uint32 GAMEPAD_ID = 104;
+
+// Device which only provides id to recorded events
+class RecordedDevice final : public InputDevice
+{
+public:
+    explicit RecordedDevice(uint32 id)
+        : InputDevice(id)
+    {
+    }
+
+    bool IsElementSupported(eInputElements) const override
+    {
+        return true;
+    }
+
+    DigitalElementState GetDigitalElementState(eInputElements) const override
+    {
+        return DigitalElementState::Released();
+    }
+
+    AnalogElementState GetAnalogElementState(eInputElements) const override
+    {
+        return AnalogElementState();
+    }
+
+private:
+    void ResetState(Window*) override
+    {
+    }
+};
+
+// Sample game flow: menu where cursor is moved by keyboard, then battle where player is driven by gamepad
+// stick and enemies are spawned randomly
+class SampleFlow
+{
+public:
+    bool OnInput(const InputEvent& inputEvent)
+    {
+        if (inputEvent.deviceType == eInputDeviceTypes::KEYBOARD && inputEvent.elementId == eInputElements::NONE)
+        {
+            state.typedChars += inputEvent.keyboardEvent.charCode;
+        }
+        else if (inputEvent.elementId == eInputElements::KB_RIGHT && inputEvent.digitalState.IsJustPressed())
+        {
+            state.menuCursor += 1;
+        }
+        else if (inputEvent.elementId == eInputElements::KB_SPACE && inputEvent.digitalState.IsJustPressed())
+        {
+            state.inBattle = 1;
+            Replay::Instance()->AddMarker("battle_start");
+        }
+        else if (inputEvent.elementId == eInputElements::GAMEPAD_AXIS_LTHUMB)
+        {
+            stick = Vector2(inputEvent.analogState.x, inputEvent.analogState.y);
+        }
+        return false;
+    }
+
+    void Update(float32 frameDelta)
+    {
+        DAVA_PROFILER_CPU_SCOPE("SampleFlow::Update");
+
+        state.time += frameDelta;
+        if (state.inBattle != 0)
+        {
+            state.playerPosition += stick * (speed * frameDelta);
+            if (Random::Instance()->Rand(10) == 0)
+            {
+                state.enemies += 1;
+            }
+        }
+
+        // Imitate some work
+        for (uint32 i = 0; i < 2000; ++i)
+        {
+            state.work = state.work * 1664525u + 1013904223u;
+        }
+    }
+
+    uint32 GetStateHash() const
+    {
+        return CRC32::ForBuffer(&state, sizeof(state));
+    }
+
+    float32 speed = 10.f;
+
+private:
+    struct State
+    {
+        float32 time = 0.f;
+        Vector2 playerPosition;
+        uint32 typedChars = 0;
+        uint32 menuCursor = 0;
+        uint32 inBattle = 0;
+        uint32 enemies = 0;
+        uint32 work = 0;
+    };
+
+    State state;
+    Vector2 stick;
+};
+
+InputEvent MakeKeyEvent(InputDevice* keyboard, eInputElements element, DigitalElementState state)
+{
+    InputEvent inputEvent;
+    inputEvent.deviceType = eInputDeviceTypes::KEYBOARD;
+    inputEvent.device = keyboard;
+    inputEvent.elementId = element;
+    inputEvent.digitalState = state;
+    return inputEvent;
+}
+
+InputEvent MakeCharEvent(InputDevice* keyboard, char32_t charCode)
+{
+    InputEvent inputEvent;
+    inputEvent.deviceType = eInputDeviceTypes::KEYBOARD;
+    inputEvent.device = keyboard;
+    inputEvent.keyboardEvent.charCode = charCode;
+    return inputEvent;
+}
+
+InputEvent MakeStickEvent(InputDevice* gamepad, float32 x, float32 y)
+{
+    InputEvent inputEvent;
+    inputEvent.deviceType = eInputDeviceTypes::GAMEPAD;
+    inputEvent.device = gamepad;
+    inputEvent.elementId = eInputElements::GAMEPAD_AXIS_LTHUMB;
+    inputEvent.analogState = AnalogElementState(x, y, 0.f);
+    return inputEvent;
+}
+
+InputEvent MakeMouseEvent(InputDevice* mouse, eInputElements element, DigitalElementState state, const Vector2& position)
+{
+    InputEvent inputEvent;
+    inputEvent.deviceType = eInputDeviceTypes::MOUSE;
+    inputEvent.device = mouse;
+    inputEvent.elementId = element;
+    inputEvent.digitalState = state;
+    inputEvent.analogState = AnalogElementState(position.x, position.y, 0.f);
+    return inputEvent;
+}
+
+struct RecordedDevices
+{
+    RecordedDevice keyboard{ KEYBOARD_ID };
+    RecordedDevice mouse{ MOUSE_ID };
+    RecordedDevice gamepad{ GAMEPAD_ID };
+};
+
+// Events which platform would send on `frame` of sample flow
+Vector<InputEvent> GetFrameInput(RecordedDevices& devices, uint32 frame)
+{
+    Vector<InputEvent> result;
+    if (frame == 10)
+    {
+        result.push_back(MakeCharEvent(&devices.keyboard, 'd'));
+        result.push_back(MakeCharEvent(&devices.keyboard, 'a'));
+    }
+    else if (frame >= 20 && frame < 80 && frame % 20 == 0)
+    {
+        result.push_back(MakeKeyEvent(&devices.keyboard, eInputElements::KB_RIGHT, DigitalElementState::JustPressed()));
+        result.push_back(MakeKeyEvent(&devices.keyboard, eInputElements::KB_RIGHT, DigitalElementState::JustReleased()));
+    }
+    else if (frame == 100)
+    {
+        result.push_back(MakeKeyEvent(&devices.keyboard, eInputElements::KB_SPACE, DigitalElementState::JustPressed()));
+    }
+    else if (frame > 100 && frame % 7 == 0)
+    {
+        float32 angle = frame * 0.05f;
+        result.push_back(MakeStickEvent(&devices.gamepad, std::cos(angle), std::sin(angle)));
+    }
+    return result;
+}
+
+void Record(const FilePath& replayPath)
+{
+    Replay* replay = Replay::Instance();
+    TEST_VERIFY(replay->StartRecord(replayPath));
+
+    RecordedDevices devices;
+    SampleFlow flow;
+    for (uint32 frame = 0; frame < FRAMES_COUNT; ++frame)
+    {
+        // Real frame deltas are unstable
+        float32 frameDelta = replay->BeginFrame(0.016f + (frame % 5) * 0.001f);
+        for (const InputEvent& inputEvent : GetFrameInput(devices, frame))
+        {
+            replay->RecordInputEvent(inputEvent);
+            flow.OnInput(inputEvent);
+        }
+
+        flow.Update(frameDelta);
+        if (frame % CHECKPOINT_PERIOD == 0)
+        {
+            replay->AddCheckpoint("state", flow.GetStateHash());
+        }
+    }
+    replay->AddCheckpoint("final", flow.GetStateHash());
+    replay->StopRecord();
+}
+
+Replay::PlaybackReport Play(const FilePath& replayPath, const Replay::PlaybackSettings& settings, float32 speed)
+{
+    Replay* replay = Replay::Instance();
+
+    // Recorded input reaches the flow through `InputSystem` as live input does
+    SampleFlow flow;
+    flow.speed = speed;
+    InputSystem* inputSystem = GetEngineContext()->inputSystem;
+    uint32 inputToken = inputSystem->AddHandler(eInputDeviceTypes::CLASS_ALL, MakeFunction(&flow, &SampleFlow::OnInput));
+
+    TEST_VERIFY(replay->StartPlayback(replayPath, settings));
+
+    // Frame loop as engine does it, frame delta from system timer is replaced by recorded one
+    for (uint32 frame = 0; Replay::IsPlayback(); ++frame)
+    {
+        float32 frameDelta = replay->BeginFrame(1.f);
+        replay->DispatchFrameInput();
+        if (!Replay::IsPlayback())
+        {
+            break;
+        }
+
+        flow.Update(frameDelta);
+        if (frame % CHECKPOINT_PERIOD == 0)
+        {
+            replay->AddCheckpoint("state", flow.GetStateHash());
+        }
+        if (frame == FRAMES_COUNT - 1)
+        {
+            replay->AddCheckpoint("final", flow.GetStateHash());
+        }
+    }
+
+    inputSystem->RemoveHandler(inputToken);
+    return replay->GetPlaybackReport();
+}
+
+// Session which is played back by engine frames: keys and stick are polled by `ActionSystem`, mouse click goes to UI
+const uint32 INPUT_FRAMES_COUNT = 24;
+const uint32 KB_W_PRESSED_FRAME = 4;
+const uint32 KB_W_RELEASED_FRAME = 9;
+const uint32 KB_SPACE_PRESSED_FRAME = 6;
+const uint32 KB_SPACE_RELEASED_FRAME = 8;
+const uint32 STICK_FRAME = 10;
+// UI skips input for a few frames after screen is switched
+const uint32 MOUSE_MOVE_FRAME = 14;
+const uint32 MOUSE_PRESSED_FRAME = 15;
+const uint32 MOUSE_RELEASED_FRAME = 17;
+const Vector2 CLICK_POINT(100.f, 50.f);
+const Vector2 STICK_POSITION(0.5f, -0.25f);
+
+const FastName MOVE_ACTION("move");
+const FastName JUMP_ACTION("jump");
+const FastName AIM_ACTION("aim");
+
+Vector<InputEvent> GetSessionInput(RecordedDevices& devices, uint32 frame)
+{
+    Vector2 clickPoint = GetEngineContext()->uiControlSystem->vcs->ConvertVirtualToInput(CLICK_POINT);
+
+    Vector<InputEvent> result;
+    switch (frame)
+    {
+    case KB_W_PRESSED_FRAME:
+        result.push_back(MakeKeyEvent(&devices.keyboard, eInputElements::KB_W, DigitalElementState::JustPressed()));
+        break;
+    case KB_W_RELEASED_FRAME:
+        result.push_back(MakeKeyEvent(&devices.keyboard, eInputElements::KB_W, DigitalElementState::JustReleased()));
+        break;
+    case KB_SPACE_PRESSED_FRAME:
+        result.push_back(MakeKeyEvent(&devices.keyboard, eInputElements::KB_SPACE, DigitalElementState::JustPressed()));
+        break;
+    case KB_SPACE_RELEASED_FRAME:
+        result.push_back(MakeKeyEvent(&devices.keyboard, eInputElements::KB_SPACE, DigitalElementState::JustReleased()));
+        break;
+    case STICK_FRAME:
+        result.push_back(MakeStickEvent(&devices.gamepad, STICK_POSITION.x, STICK_POSITION.y));
+        break;
+    case MOUSE_MOVE_FRAME:
+        result.push_back(MakeMouseEvent(&devices.mouse, eInputElements::MOUSE_POSITION, DigitalElementState(), clickPoint));
+        break;
+    case MOUSE_PRESSED_FRAME:
+        result.push_back(MakeMouseEvent(&devices.mouse, eInputElements::MOUSE_LBUTTON, DigitalElementState::JustPressed(), Vector2()));
+        break;
+    case MOUSE_RELEASED_FRAME:
+        result.push_back(MakeMouseEvent(&devices.mouse, eInputElements::MOUSE_LBUTTON, DigitalElementState::JustReleased(), Vector2()));
+        break;
+    default:
+        break;
+    }
+    return result;
+}
+
+void RecordSession(const FilePath& replayPath)
+{
+    Replay* replay = Replay::Instance();
+    TEST_VERIFY(replay->StartRecord(replayPath));
+
+    RecordedDevices devices;
+    for (uint32 frame = 0; frame < INPUT_FRAMES_COUNT; ++frame)
+    {
+        replay->BeginFrame(0.016f);
+        for (const InputEvent& inputEvent : GetSessionInput(devices, frame))
+        {
+            replay->RecordInputEvent(inputEvent);
+        }
+    }
+    replay->StopRecord();
+}
+
+class ClickCountingScreen : public UIScreen
+{
+public:
+    void Input(UIEvent* currentInput) override
+    {
+        if (currentInput->phase == UIEvent::Phase::BEGAN)
+        {
+            beganCount += 1;
+            beganPoint = currentInput->point;
+        }
+        else if (currentInput->phase == UIEvent::Phase::ENDED)
+        {
+            endedCount += 1;
+        }
+    }
+
+    uint32 beganCount = 0;
+    uint32 endedCount = 0;
+    Vector2 beganPoint;
+
+protected:
+    ~ClickCountingScreen() override = default;
+};
+}
+
+DAVA_TESTCLASS (ReplayTest)
+{
+    FilePath testFolder;
+
+    // State of `PlaybackInputTest` which is played back by engine frames
+    bool inputPlaybackVerified = true;
+    RefPtr<ReplayTestDetails::ClickCountingScreen> screen;
+    Map<FastName, uint32> triggeredActions;
+    AnalogElementState lastAimState;
+    Map<uint32, uint32> dispatchedEvents;
+    uint32 inputHandlerToken = 0;
+
+    ReplayTest()
+    {
+        FileSystem* fs = GetEngineContext()->fileSystem;
+        testFolder = fs->GetTempDirectoryPath();
+        testFolder.MakeDirectoryPathname();
+        testFolder += "ReplayTest/";
+        fs->DeleteDirectory(testFolder, true);
+        fs->CreateDirectory(testFolder, true);
+    }
+
+    ~ReplayTest()
+    {
+        GetEngineContext()->fileSystem->DeleteDirectory(testFolder, true);
+    }
+
+    void Update(float32 timeElapsed, const String& testName) override
+    {
+        if (testName == "PlaybackInputTest" && !inputPlaybackVerified && !Replay::IsPlayback())
+        {
+            VerifyPlaybackInput();
+            inputPlaybackVerified = true;
+        }
+    }
+
+    bool TestComplete(const String& testName) const override
+    {
+        return testName != "PlaybackInputTest" || inputPlaybackVerified;
+    }
+
+    void OnActionTriggered(Action action)
+    {
+        triggeredActions[action.actionId] += 1;
+        if (action.actionId == ReplayTestDetails::AIM_ACTION)
+        {
+            lastAimState = action.analogState;
+        }
+    }
+
+    bool OnInputEvent(const InputEvent& inputEvent)
+    {
+        // Device of dispatched event reports the same state as the event itself
+        if (inputEvent.elementId == eInputElements::KB_SPACE)
+        {
+            TEST_VERIFY(inputEvent.device->GetDigitalElementState(eInputElements::KB_SPACE).IsPressed() == inputEvent.digitalState.IsPressed());
+        }
+        dispatchedEvents[inputEvent.device->GetId()] += 1;
+        return false;
+    }
+
+    void OnPlaybackFinished(const Replay::PlaybackReport&)
+    {
+        // Recorded devices are removed right after notification
+        GetEngineContext()->actionSystem->UnbindAllSets();
+    }
+
+    void VerifyPlaybackInput()
+    {
+        using namespace ReplayTestDetails;
+
+        const EngineContext* context = GetEngineContext();
+        context->actionSystem->ActionTriggered.Disconnect(this);
+        context->inputSystem->RemoveHandler(inputHandlerToken);
+        Replay::Instance()->playbackFinished.Disconnect(this);
+
+        // Key held for several frames is polled as pressed on every frame, just pressed state lasts for one frame
+        TEST_VERIFY(triggeredActions[MOVE_ACTION] == KB_W_RELEASED_FRAME - KB_W_PRESSED_FRAME);
+        TEST_VERIFY(triggeredActions[JUMP_ACTION] == 1);
+        TEST_VERIFY(triggeredActions[AIM_ACTION] == 1);
+        TEST_VERIFY(lastAimState.x == STICK_POSITION.x && lastAimState.y == STICK_POSITION.y);
+
+        TEST_VERIFY(dispatchedEvents[KEYBOARD_ID] == 4);
+        TEST_VERIFY(dispatchedEvents[GAMEPAD_ID] == 1);
+        TEST_VERIFY(dispatchedEvents[MOUSE_ID] == 3);
+
+        // Click position is taken from recorded mouse state
+        TEST_VERIFY(screen->beganCount == 1);
+        TEST_VERIFY(screen->endedCount == 1);
+        TEST_VERIFY(FLOAT_EQUAL_EPS(screen->beganPoint.x, CLICK_POINT.x, 1.f));
+        TEST_VERIFY(FLOAT_EQUAL_EPS(screen->beganPoint.y, CLICK_POINT.y, 1.f));
+
+        // Live devices are back
+        TEST_VERIFY(context->deviceManager->GetInputDevice(KEYBOARD_ID) == nullptr);
+
+        context->uiControlSystem->Reset();
+        screen = nullptr;
+    }
+
+    DAVA_TEST (RecordPlaybackTest)
+    {
+        using namespace ReplayTestDetails;
+
+        FilePath replayPath = testFolder + "session.rep";
+        Record(replayPath);
+
+        Replay::PlaybackSettings settings;
+        settings.reportPath = testFolder + "frames.csv";
+        settings.tracePath = testFolder + "trace.json";
+
+        Replay::PlaybackReport report = Play(replayPath, settings, 10.f);
+        TEST_VERIFY(report.divergences.empty());
+        TEST_VERIFY(report.recordedFramesCount == FRAMES_COUNT);
+        TEST_VERIFY(report.framesCount == FRAMES_COUNT);
+        TEST_VERIFY(GetEngineContext()->fileSystem->Exists(settings.reportPath));
+        // Trace is written only if profiler wasn't already started by application
+        TEST_VERIFY(GetEngineContext()->fileSystem->Exists(settings.tracePath) || ProfilerCPU::globalProfiler->IsStarted());
+
+        Logger::Info("Replay timing: %s", report.GetSummary().c_str());
+    }
+
+    DAVA_TEST (DivergenceTest)
+    {
+        using namespace ReplayTestDetails;
+
+        FilePath replayPath = testFolder + "session.rep";
+        Record(replayPath);
+
+        Replay::PlaybackSettings settings;
+        settings.captureProfilerTrace = false;
+
+        // Changed game logic makes the same input produce different state after battle start
+        Replay::PlaybackReport report = Play(replayPath, settings, 11.f);
+        TEST_VERIFY(!report.divergences.empty());
+        TEST_VERIFY(report.framesCount == FRAMES_COUNT);
+
+        settings.stopOnDivergence = true;
+        report = Play(replayPath, settings, 11.f);
+        TEST_VERIFY(report.divergences.size() == 1);
+        TEST_VERIFY(report.framesCount > 100 && report.framesCount < FRAMES_COUNT);
+
+        // Fixed timestep playback runs different simulation, so it is reported as well
+        settings.stopOnDivergence = false;
+        settings.fixedFrameDelta = 0.016f;
+        report = Play(replayPath, settings, 10.f);
+        TEST_VERIFY(!report.divergences.empty());
+
+        // Files of other format are rejected
+        FilePath brokenPath = testFolder + "broken.rep";
+        {
+            ScopedPtr<File> file(File::Create(brokenPath, File::CREATE | File::WRITE));
+            file->WriteLine("not a replay");
+        }
+        TEST_VERIFY(Replay::Instance()->StartPlayback(brokenPath, settings) == false);
+        TEST_VERIFY(!Replay::IsPlayback());
+    }
+
+    DAVA_TEST (PlaybackInputTest)
+    {
+        using namespace ReplayTestDetails;
+
+        const EngineContext* context = GetEngineContext();
+        if (context->actionSystem == nullptr || GetPrimaryWindow() == nullptr)
+        {
+            Logger::Info("Skipping PlaybackInputTest since there is no primary window");
+            return;
+        }
+
+        FilePath replayPath = testFolder + "input.rep";
+        RecordSession(replayPath);
+
+        screen = RefPtr<ClickCountingScreen>(new ClickCountingScreen());
+        context->uiControlSystem->SetScreen(screen.Get());
+        context->uiControlSystem->Update();
+
+        Replay::PlaybackSettings settings;
+        settings.captureProfilerTrace = false;
+        TEST_VERIFY(Replay::Instance()->StartPlayback(replayPath, settings));
+
+        // Recorded devices replace live ones for the time of playback
+        TEST_VERIFY(context->deviceManager->GetInputDevice(KEYBOARD_ID) != nullptr);
+        TEST_VERIFY(context->deviceManager->GetInputDevice(GAMEPAD_ID) != nullptr);
+
+        ActionSet set;
+
+        DigitalBinding move;
+        move.actionId = MOVE_ACTION;
+        move.digitalElements[0] = eInputElements::KB_W;
+        move.digitalStates[0] = DigitalElementState::Pressed();
+        set.digitalBindings.push_back(move);
+
+        DigitalBinding jump;
+        jump.actionId = JUMP_ACTION;
+        jump.digitalElements[0] = eInputElements::KB_SPACE;
+        jump.digitalStates[0] = DigitalElementState::JustPressed();
+        set.digitalBindings.push_back(jump);
+
+        AnalogBinding aim;
+        aim.actionId = AIM_ACTION;
+        aim.analogElementId = eInputElements::GAMEPAD_AXIS_LTHUMB;
+        set.analogBindings.push_back(aim);
+
+        triggeredActions.clear();
+        dispatchedEvents.clear();
+        lastAimState = AnalogElementState();
+
+        context->actionSystem->BindSet(set, KEYBOARD_ID, GAMEPAD_ID);
+        context->actionSystem->ActionTriggered.Connect(this, &ReplayTest::OnActionTriggered);
+        inputHandlerToken = context->inputSystem->AddHandler(eInputDeviceTypes::CLASS_ALL, MakeFunction(this, &ReplayTest::OnInputEvent));
+        Replay::Instance()->playbackFinished.Connect(this, &ReplayTest::OnPlaybackFinished);
+
+        // Session is played back by next engine frames and verified in `Update`
+        inputPlaybackVerified = false;
+    }
+};
@@ -0,0 +1,91 @@
+#include "Debug/Private/ReplayInputDevice.h"
+
+#include "Debug/DVAssert.h"
+#include "Input/InputElements.h"
+#include "Input/InputEvent.h"
+
+namespace DAVA
+{
+ReplayInputDevice::ReplayInputDevice(uint32 id, eInputDeviceTypes deviceType_)
+    : InputDevice(id)
+    , deviceType(deviceType_)
+{
+}
+
+void ReplayInputDevice::ApplyEvent(const InputEvent& inputEvent)
+{
+    // Char events duplicate key state, they don't change it
+    if (inputEvent.elementId == eInputElements::NONE || inputEvent.keyboardEvent.charCode > 0)
+    {
+        return;
+    }
+
+    if (GetInputElementInfo(inputEvent.elementId).type == eInputElementTypes::ANALOG)
+    {
+        analogStates[inputEvent.elementId] = inputEvent.analogState;
+        if (deviceType == eInputDeviceTypes::MOUSE)
+        {
+            isMouseRelative = inputEvent.mouseEvent.isRelative;
+        }
+    }
+    else
+    {
+        digitalStates[inputEvent.elementId] = inputEvent.digitalState;
+    }
+}
+
+void ReplayInputDevice::OnEndFrame()
+{
+    for (auto& p : digitalStates)
+    {
+        p.second.OnEndFrame();
+    }
+
+    if (deviceType == eInputDeviceTypes::MOUSE)
+    {
+        analogStates.erase(eInputElements::MOUSE_WHEEL);
+        if (isMouseRelative)
+        {
+            analogStates.erase(eInputElements::MOUSE_POSITION);
+        }
+    }
+}
+
+bool ReplayInputDevice::IsElementSupported(eInputElements elementId) const
+{
+    switch (deviceType)
+    {
+    case eInputDeviceTypes::KEYBOARD:
+        return IsKeyboardInputElement(elementId);
+    case eInputDeviceTypes::MOUSE:
+        return IsMouseInputElement(elementId);
+    case eInputDeviceTypes::GAMEPAD:
+        return IsGamepadInputElement(elementId);
+    case eInputDeviceTypes::TOUCH_SURFACE:
+        return IsTouchInputElement(elementId);
+    default:
+        return false;
+    }
+}
+
+DigitalElementState ReplayInputDevice::GetDigitalElementState(eInputElements elementId) const
+{
+    DVASSERT(IsElementSupported(elementId));
+
+    auto it = digitalStates.find(elementId);
+    return (it != digitalStates.end()) ? it->second : DigitalElementState::Released();
+}
+
+AnalogElementState ReplayInputDevice::GetAnalogElementState(eInputElements elementId) const
+{
+    DVASSERT(IsElementSupported(elementId));
+
+    auto it = analogStates.find(elementId);
+    return (it != analogStates.end()) ? it->second : AnalogElementState();
+}
+
+void ReplayInputDevice::ResetState(Window*)
+{
+    // Recorded session contains release events for the elements that were reset while recording
+}
+}
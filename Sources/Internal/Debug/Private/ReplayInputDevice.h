@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Engine/EngineTypes.h"
+#include "Input/InputDevice.h"
+
+namespace DAVA
+{
+struct InputEvent;
+
+/**
+    Input device whose state is driven by events played back by `Replay`.
+
+    During playback it replaces live device with the same id in `DeviceManager::GetInputDevice`,
+    so code that polls device state (e.g. `ActionSystem`) sees recorded input instead of live hardware.
+*/
+class ReplayInputDevice final : public InputDevice
+{
+public:
+    ReplayInputDevice(uint32 id, eInputDeviceTypes deviceType);
+
+    eInputDeviceTypes GetDeviceType() const;
+
+    /** Update state of the element with recorded `inputEvent`. */
+    void ApplyEvent(const InputEvent& inputEvent);
+
+    /** Promote JustPressed & JustReleased states and reset per-frame analog states, like live devices do at the end of frame. */
+    void OnEndFrame();
+
+    bool IsElementSupported(eInputElements elementId) const override;
+    DigitalElementState GetDigitalElementState(eInputElements elementId) const override;
+    AnalogElementState GetAnalogElementState(eInputElements elementId) const override;
+
+private:
+    void ResetState(Window* window) override;
+
+    const eInputDeviceTypes deviceType;
+    UnorderedMap<uint32, DigitalElementState> digitalStates;
+    UnorderedMap<uint32, AnalogElementState> analogStates;
+    bool isMouseRelative = false;
+};
+
+inline eInputDeviceTypes ReplayInputDevice::GetDeviceType() const
+{
+    return deviceType;
+}
+}
@@ -27,6 +27,7 @@ extern const char* UI_RENDER_SYSTEM;
 
 extern const char* UI_TEXTBLOCK_RECALC_PARAMS;
 extern const char* UI_TEXTBLOCK_PREPARE;
+extern const char* UI_TEXTBLOCK_BATCH_LAYOUT;
 
 //Scene
 extern const char* SCENE_UPDATE;
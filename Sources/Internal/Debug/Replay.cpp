@@ -1,219 +1,668 @@
 #include "Replay.h"
+#include "Base/ScopedPtr.h"
+#include "Debug/DVAssert.h"
+#include "Debug/Private/ReplayInputDevice.h"
+#include "Debug/ProfilerCPU.h"
+#include "Debug/TraceEvent.h"
+#include "DeviceManager/DeviceManager.h"
+#include "Engine/Engine.h"
 #include "FileSystem/File.h"
 #include "FileSystem/FileSystem.h"
-#include "FileSystem/FileList.h"
+#include "Input/InputElements.h"
+#include "Input/InputEvent.h"
+#include "Input/InputSystem.h"
+#include "Logger/Logger.h"
+#include "Time/SystemTimer.h"
 #include "Utils/Random.h"
-#include "Debug/DVAssert.h"
 #include "Utils/StringFormat.h"
-#include "Utils/Utils.h"
+
+#include <numeric>
 
 namespace DAVA
 {
-bool Replay::isRecord = false;
-bool Replay::isPlayback = false;
+namespace ReplayDetail
+{
+const uint32 FILE_MAGIC = 0x50455244; // "DREP"
+const size_t RECORD_FLUSH_SIZE = 64 * 1024;
+const size_t MAX_REPORTED_DIVERGENCES = 32;
+
+enum eEventFlags : uint8
+{
+    EVENT_PRESSED = 1 << 0,
+    EVENT_JUST_CHANGED = 1 << 1,
+    EVENT_ANALOG = 1 << 2,
+    EVENT_CHAR = 1 << 3,
+    EVENT_CHAR_REPEATED = 1 << 4,
+    EVENT_MOUSE_RELATIVE = 1 << 5
+};
+
+class Reader
+{
+public:
+    Reader(const Vector<uint8>& data_)
+        : data(data_)
+    {
+    }
+
+    template <typename T>
+    bool Read(T& value)
+    {
+        if (offset + sizeof(T) > data.size())
+        {
+            return false;
+        }
+        Memcpy(&value, data.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    bool ReadString(String& value)
+    {
+        uint16 length = 0;
+        if (!Read(length) || offset + length > data.size())
+        {
+            return false;
+        }
+        value.assign(reinterpret_cast<const char*>(data.data() + offset), length);
+        offset += length;
+        return true;
+    }
 
-Replay::Replay()
-    : file(0)
+    bool IsEnd() const
+    {
+        return offset >= data.size();
+    }
+
+private:
+    const Vector<uint8>& data;
+    size_t offset = 0;
+};
+
+DigitalElementState MakeDigitalState(uint8 flags)
 {
+    bool pressed = (flags & EVENT_PRESSED) != 0;
+    bool justChanged = (flags & EVENT_JUST_CHANGED) != 0;
+    if (pressed)
+    {
+        return justChanged ? DigitalElementState::JustPressed() : DigitalElementState::Pressed();
+    }
+    return justChanged ? DigitalElementState::JustReleased() : DigitalElementState::Released();
 }
+}
+
+const uint32 Replay::FORMAT_VERSION;
+
+bool Replay::isRecord = false;
+bool Replay::isPlayback = false;
+
+Replay::Replay() = default;
 
 Replay::~Replay()
 {
     StopRecord();
+    StopPlayback();
 }
 
-void Replay::StartRecord(const FilePath& dirName)
+bool Replay::StartRecord(const FilePath& replayPath)
 {
     DVASSERT(!isRecord);
     DVASSERT(!isPlayback);
+
+    recordFile = File::Create(replayPath, File::CREATE | File::WRITE);
+    if (recordFile == nullptr)
+    {
+        Logger::Error("[Replay] Can't create %s", replayPath.GetStringValue().c_str());
+        return false;
+    }
+
+    recordBuffer.clear();
+    Write(ReplayDetail::FILE_MAGIC);
+    Write(FORMAT_VERSION);
+
     isRecord = true;
     pauseReplay = false;
+    recordFrame = 0;
 
-    FileSystem::Instance()->DeleteDirectoryFiles(dirName, false);
-    FileSystem::Instance()->CreateDirectory(dirName);
+    // Session starts from recorded seed, playback gets it back in `StartPlayback`
+    if (Random::Instance() != nullptr)
+    {
+        Random::Instance()->Seed();
+    }
+    return true;
+}
 
-    FileList* list = new FileList("~doc:/");
-    int32 listSize = list->GetCount();
-    for (int32 i = 0; i < listSize; ++i)
+void Replay::StopRecord()
+{
+    if (isRecord)
+    {
+        FlushRecord();
+        isRecord = false;
+    }
+    SafeRelease(recordFile);
+}
+
+bool Replay::StartPlayback(const FilePath& replayPath)
+{
+    return StartPlayback(replayPath, PlaybackSettings());
+}
+
+bool Replay::StartPlayback(const FilePath& replayPath, const PlaybackSettings& settings)
+{
+    DVASSERT(!isRecord);
+    DVASSERT(!isPlayback);
+
+    Vector<uint8> data;
+    if (!FileSystem::Instance()->ReadFileContents(replayPath, data) || !ParseReplay(data))
     {
-        String fileName = list->GetFilename(i);
-        if (!list->IsNavigationDirectory(i) && !list->IsDirectory(i) && fileName != "LastReplay.rep")
+        Logger::Error("[Replay] Can't load %s", replayPath.GetStringValue().c_str());
+        return false;
+    }
+
+    playbackSettings = settings;
+    report = PlaybackReport();
+    report.recordedFramesCount = static_cast<uint32>(frames.size());
+    report.frameTimesUs.reserve(frames.size());
+    nextSeed = 0;
+    nextMarker = 0;
+    playFrame = 0;
+
+    isPlayback = true;
+    pauseReplay = false;
+    CreatePlaybackDevices();
+
+    profilerStarted = false;
+    if (playbackSettings.captureProfilerTrace && !ProfilerCPU::globalProfiler->IsStarted())
+    {
+        ProfilerCPU::globalProfiler->Start();
+        profilerStarted = true;
+    }
+
+    if (Random::Instance() != nullptr)
+    {
+        Random::Instance()->Seed();
+    }
+    return true;
+}
+
+void Replay::StopPlayback()
+{
+    if (isPlayback)
+    {
+        FinishPlayback();
+    }
+}
+
+void Replay::PauseReplay(bool isPause)
+{
+    pauseReplay = isPause;
+}
+
+bool Replay::ReplayPaused() const
+{
+    return pauseReplay;
+}
+
+float32 Replay::BeginFrame(float32 frameDelta)
+{
+    if (IsRecord())
+    {
+        Write(RECORD_FRAME);
+        Write(frameDelta);
+        recordFrame += 1;
+
+        if (recordBuffer.size() >= ReplayDetail::RECORD_FLUSH_SIZE)
         {
-            FileSystem::Instance()->CopyFile(list->GetPathname(i), dirName + fileName);
+            FlushRecord();
         }
+        return frameDelta;
     }
 
-    list->Release();
+    if (IsPlayback())
+    {
+        int64 frameStart = SystemTimer::GetUs();
+        if (playFrame > 0)
+        {
+            report.frameTimesUs.push_back(frameStart - frameStartUs);
+        }
+        frameStartUs = frameStart;
+
+        if (playFrame >= frames.size())
+        {
+            FinishPlayback();
+            return frameDelta;
+        }
 
-    FilePath filePath = dirName + "LastReplay.rep";
-    file = File::Create(filePath, File::CREATE | File::WRITE);
+        float32 fixedDelta = playbackSettings.fixedFrameDelta;
+        frameDelta = (fixedDelta > 0.f) ? fixedDelta : frames[playFrame].frameDelta;
+        playFrame += 1;
 
-    Random::Instance()->Seed();
+        SystemTimer::SetFrameDelta(frameDelta);
+    }
+    return frameDelta;
 }
 
-void Replay::StopRecord()
+void Replay::DispatchFrameInput()
 {
-    isRecord = false;
-    SafeRelease(file);
+    if (!IsPlayback() || playFrame == 0)
+    {
+        return;
+    }
+
+    using namespace ReplayDetail;
+
+    const RecordedFrame& frame = frames[playFrame - 1];
+    const EngineContext* context = GetEngineContext();
+    InputSystem* inputSystem = playbackSettings.dispatchToInputSystem ? context->inputSystem : nullptr;
+    Window* window = GetPrimaryWindow();
+
+    // Live devices promote their states at the end of frame, which is not emitted in console mode
+    for (ReplayInputDevice* device : playbackDevices)
+    {
+        device->OnEndFrame();
+    }
+
+    dispatchingInput = true;
+    for (uint32 i = frame.firstEvent, end = frame.firstEvent + frame.eventsCount; i < end; ++i)
+    {
+        const RecordedEvent& recorded = events[i];
+
+        InputEvent inputEvent;
+        inputEvent.window = window;
+        inputEvent.timestamp = recorded.timestamp;
+        inputEvent.deviceType = static_cast<eInputDeviceTypes>(recorded.deviceType);
+        ReplayInputDevice* device = FindPlaybackDevice(recorded.deviceId);
+        inputEvent.device = device;
+        inputEvent.elementId = static_cast<eInputElements>(recorded.elementId);
+        inputEvent.digitalState = MakeDigitalState(recorded.flags);
+        inputEvent.analogState = AnalogElementState(recorded.analog[0], recorded.analog[1], recorded.analog[2]);
+        if (inputEvent.deviceType == eInputDeviceTypes::MOUSE)
+        {
+            inputEvent.mouseEvent.isRelative = (recorded.flags & EVENT_MOUSE_RELATIVE) != 0;
+        }
+        else
+        {
+            inputEvent.keyboardEvent.charCode = static_cast<char32_t>(recorded.charCode);
+            inputEvent.keyboardEvent.charRepeated = (recorded.flags & EVENT_CHAR_REPEATED) != 0;
+        }
+
+        if (device != nullptr)
+        {
+            device->ApplyEvent(inputEvent);
+        }
+
+        // Handlers rely on valid device, so event without device is only reported to `inputEventPlayed`
+        if (inputSystem != nullptr && inputEvent.device != nullptr)
+        {
+            inputSystem->DispatchInputEvent(inputEvent);
+        }
+        inputEventPlayed.Emit(inputEvent);
+    }
+    dispatchingInput = false;
 }
 
-void Replay::RecordFrame(float32 frameTime)
+bool Replay::IsDispatchingInput() const
 {
-    //Logger::FrameworkDebug("[Replay::RecordFrame] %f", frameTime);
-    Write<int8>(VALUE_FRAMETIME);
-    Write(frameTime);
+    return dispatchingInput;
 }
 
-void Replay::RecordEventsCount(int32 eventsCount)
+void Replay::RecordInputEvent(const InputEvent& inputEvent)
 {
-    //Logger::FrameworkDebug("[Replay::RecordEventsCount] %d", eventsCount);
-    Write<int8>(VALUE_EVENTS_COUNT);
-    Write(eventsCount);
+    // Events out of frames can't be played back at the right time
+    if (recordFrame == 0)
+    {
+        return;
+    }
+
+    using namespace ReplayDetail;
+
+    uint8 flags = 0;
+    if (inputEvent.digitalState.IsPressed())
+    {
+        flags |= EVENT_PRESSED;
+    }
+    if (inputEvent.digitalState.IsJustPressed() || inputEvent.digitalState.IsJustReleased())
+    {
+        flags |= EVENT_JUST_CHANGED;
+    }
+    if (inputEvent.elementId != eInputElements::NONE && GetInputElementInfo(inputEvent.elementId).type == eInputElementTypes::ANALOG)
+    {
+        flags |= EVENT_ANALOG;
+    }
+    if (inputEvent.deviceType == eInputDeviceTypes::MOUSE)
+    {
+        flags |= inputEvent.mouseEvent.isRelative ? EVENT_MOUSE_RELATIVE : 0;
+    }
+    else if (inputEvent.deviceType == eInputDeviceTypes::KEYBOARD && inputEvent.keyboardEvent.charCode != 0)
+    {
+        flags |= EVENT_CHAR;
+        flags |= inputEvent.keyboardEvent.charRepeated ? EVENT_CHAR_REPEATED : 0;
+    }
+
+    Write(RECORD_INPUT);
+    Write(flags);
+    Write(static_cast<uint16>(inputEvent.deviceType));
+    Write((inputEvent.device != nullptr) ? inputEvent.device->GetId() : 0u);
+    Write(static_cast<uint32>(inputEvent.elementId));
+    Write(inputEvent.timestamp);
+    if (flags & EVENT_ANALOG)
+    {
+        Write(inputEvent.analogState.x);
+        Write(inputEvent.analogState.y);
+        Write(inputEvent.analogState.z);
+    }
+    if (flags & EVENT_CHAR)
+    {
+        Write(static_cast<uint32>(inputEvent.keyboardEvent.charCode));
+    }
 }
 
-void Replay::RecordEvent(const UIEvent* ev)
+void Replay::RecordSeed(uint32 seed)
 {
-    Write(ev->touchId); // union for (key, touch, gamepad...)
-    Write(ev->point.x);
-    Write(ev->point.y);
-    Write(ev->timestamp);
-    Write(ev->phase);
-    Write(ev->controlState);
-    Write(ev->tapCount);
-    Write(ev->device);
+    Write(RECORD_SEED);
+    Write(seed);
 }
 
-void Replay::RecordSeed(const uint32 seed)
+uint32 Replay::PlaySeed(uint32 seed)
 {
-    Write<int8>(VALUE_SEED);
-    Write(seed);
+    if (nextSeed < seeds.size())
+    {
+        return seeds[nextSeed++];
+    }
+
+    ReportDivergence(Format("frame %u: Random::Seed call was not recorded", playFrame));
+    return seed;
 }
 
-void Replay::StartPlayback(const FilePath& dirName)
+void Replay::AddMarker(const String& name)
 {
-    DVASSERT(!isRecord);
-    DVASSERT(!isPlayback);
-    pauseReplay = false;
-    isPlayback = true;
+    if (IsRecord())
+    {
+        Write(RECORD_MARKER);
+        WriteString(name);
+    }
+    else if (IsPlayback())
+    {
+        CheckMarker(name, 0, false);
+    }
+}
 
-    FileSystem::Instance()->DeleteDirectoryFiles("~doc:/", false);
-    FileList* list = new FileList(dirName);
-    int32 listSize = list->GetCount();
-    for (int32 i = 0; i < listSize; ++i)
+void Replay::AddCheckpoint(const String& name, uint32 stateHash)
+{
+    if (IsRecord())
     {
-        String fileName = list->GetFilename(i);
-        if (!list->IsNavigationDirectory(i) && !list->IsDirectory(i))
-        {
-            FilePath existingFile = dirName + fileName;
-            FilePath newFile("~doc:/" + fileName);
+        Write(RECORD_CHECKPOINT);
+        WriteString(name);
+        Write(stateHash);
+    }
+    else if (IsPlayback())
+    {
+        CheckMarker(name, stateHash, true);
+    }
+}
 
-            FileSystem::Instance()->CopyFile(existingFile, newFile);
-        }
+const Replay::PlaybackReport& Replay::GetPlaybackReport() const
+{
+    return report;
+}
+
+void Replay::CheckMarker(const String& name, uint32 stateHash, bool isCheckpoint)
+{
+    if (nextMarker >= markers.size())
+    {
+        ReportDivergence(Format("frame %u: marker '%s' was not recorded", playFrame, name.c_str()));
+        return;
     }
 
-    list->Release();
+    const RecordedMarker& recorded = markers[nextMarker++];
+    if (recorded.name != name || recorded.isCheckpoint != isCheckpoint)
+    {
+        ReportDivergence(Format("frame %u: marker '%s' reached instead of '%s'", playFrame, name.c_str(), recorded.name.c_str()));
+    }
+    else if (recorded.frame != playFrame)
+    {
+        ReportDivergence(Format("frame %u: marker '%s' was recorded on frame %u", playFrame, name.c_str(), recorded.frame));
+    }
+    else if (recorded.stateHash != stateHash)
+    {
+        ReportDivergence(Format("frame %u: checkpoint '%s' state hash 0x%08x differs from recorded 0x%08x", playFrame, name.c_str(), stateHash, recorded.stateHash));
+    }
+}
+
+void Replay::ReportDivergence(const String& message)
+{
+    if (report.divergences.size() < ReplayDetail::MAX_REPORTED_DIVERGENCES)
+    {
+        Logger::Warning("[Replay] Divergence at %s", message.c_str());
+    }
+    report.divergences.push_back(message);
 
-    skipType = false;
-    file = File::Create("~doc:/LastReplay.rep", File::OPEN | File::READ);
+    if (playbackSettings.stopOnDivergence)
+    {
+        FinishPlayback();
+    }
 }
 
-float32 Replay::PlayFrameTime()
+void Replay::FinishPlayback()
 {
-    if (!skipType)
+    isPlayback = false;
+
+    // Markers are not reached if playback is stopped earlier
+    if (playFrame >= frames.size())
+    {
+        for (size_t i = nextMarker; i < markers.size(); ++i)
+        {
+            report.divergences.push_back(Format("marker '%s' recorded on frame %u was not reached", markers[i].name.c_str(), markers[i].frame));
+        }
+    }
+
+    report.framesCount = static_cast<uint32>(report.frameTimesUs.size());
+
+    if (profilerStarted)
     {
-        int8 type = Read<int8>();
-        if (!isPlayback)
-            return 0.f;
-        while (VALUE_SEED == type)
+        ProfilerCPU::globalProfiler->Stop();
+        if (!playbackSettings.tracePath.IsEmpty())
         {
-            Random::Instance()->Seed(Read<uint32>());
-            if (!isPlayback)
-                return 0.f;
-            type = Read<int8>();
-            if (!isPlayback)
-                return 0.f;
+            TraceEvent::DumpJSON(ProfilerCPU::globalProfiler->GetTrace(), playbackSettings.tracePath);
         }
+        profilerStarted = false;
     }
-    else
+    if (!playbackSettings.reportPath.IsEmpty())
     {
-        skipType = false;
+        report.SaveCSV(playbackSettings.reportPath);
     }
-    float32 ret = Read<float32>();
-    if (!isPlayback)
-        return 0.f;
-    return ret;
+
+    Logger::Info("[Replay] %s", report.GetSummary().c_str());
+    playbackFinished.Emit(report);
+
+    // Destroyed after notification, so listeners can unbind from recorded devices first
+    DestroyPlaybackDevices();
 }
 
-int32 Replay::PlayEventsCount()
+void Replay::CreatePlaybackDevices()
 {
-    if (!skipType)
+    DeviceManager* deviceManager = GetEngineContext()->deviceManager;
+    if (deviceManager == nullptr)
     {
-        Read<int8>();
-        if (!isPlayback)
-            return 0;
+        return;
     }
-    else
+
+    for (const RecordedEvent& recorded : events)
     {
-        skipType = false;
+        if (recorded.deviceId != 0 && FindPlaybackDevice(recorded.deviceId) == nullptr)
+        {
+            ReplayInputDevice* device = new ReplayInputDevice(recorded.deviceId, static_cast<eInputDeviceTypes>(recorded.deviceType));
+            playbackDevices.push_back(device);
+            deviceManager->replayDevices.push_back(device);
+        }
     }
+}
 
-    int32 ret = Read<int32>();
-    if (!isPlayback)
-        return 0;
-    return ret;
+void Replay::DestroyPlaybackDevices()
+{
+    DeviceManager* deviceManager = GetEngineContext()->deviceManager;
+    if (deviceManager != nullptr)
+    {
+        deviceManager->replayDevices.clear();
+    }
+
+    for (ReplayInputDevice* device : playbackDevices)
+    {
+        delete device;
+    }
+    playbackDevices.clear();
+}
+
+ReplayInputDevice* Replay::FindPlaybackDevice(uint32 deviceId) const
+{
+    auto it = std::find_if(playbackDevices.begin(), playbackDevices.end(), [deviceId](ReplayInputDevice* device) { return device->GetId() == deviceId; });
+    return (it != playbackDevices.end()) ? *it : nullptr;
+}
+
+void Replay::FlushRecord()
+{
+    if (recordFile != nullptr && !recordBuffer.empty())
+    {
+        recordFile->Write(recordBuffer.data(), static_cast<uint32>(recordBuffer.size()));
+        recordFile->Flush();
+    }
+    recordBuffer.clear();
 }
 
-UIEvent Replay::PlayEvent()
+bool Replay::ParseReplay(const Vector<uint8>& data)
 {
-    UIEvent ev;
+    using namespace ReplayDetail;
+
+    frames.clear();
+    events.clear();
+    seeds.clear();
+    markers.clear();
+
+    Reader reader(data);
+    uint32 magic = 0;
+    uint32 version = 0;
+    if (!reader.Read(magic) || !reader.Read(version) || magic != FILE_MAGIC || version != FORMAT_VERSION)
+    {
+        Logger::Error("[Replay] Unsupported replay format");
+        return false;
+    }
 
-    ev.touchId = Read<uint32>();
-    if (!isPlayback)
-        return ev;
-    ev.point.x = Read<float32>();
-    if (!isPlayback)
-        return ev;
-    ev.point.y = Read<float32>();
-    if (!isPlayback)
-        return ev;
-    ev.timestamp = Read<float64>();
-    if (!isPlayback)
-        return ev;
-    ev.phase = static_cast<UIEvent::Phase>(Read<int32>());
-    if (!isPlayback)
-        return ev;
-    ev.controlState = Read<int32>();
-    if (!isPlayback)
-        return ev;
-    ev.tapCount = Read<uint32>();
-    if (!isPlayback)
-        return ev;
-    ev.device = Read<eInputDevices>();
-    if (!isPlayback)
-        return ev;
+    bool isValid = true;
+    while (isValid && !reader.IsEnd())
+    {
+        uint8 type = 0;
+        reader.Read(type);
+        switch (type)
+        {
+        case RECORD_FRAME:
+        {
+            RecordedFrame frame;
+            frame.firstEvent = static_cast<uint32>(events.size());
+            isValid = reader.Read(frame.frameDelta);
+            frames.push_back(frame);
+            break;
+        }
+        case RECORD_INPUT:
+        {
+            RecordedEvent event;
+            uint16 deviceType = 0;
+            isValid = reader.Read(event.flags) && reader.Read(deviceType) && reader.Read(event.deviceId) && reader.Read(event.elementId) && reader.Read(event.timestamp);
+            event.deviceType = deviceType;
+            event.analog[0] = event.analog[1] = event.analog[2] = 0.f;
+            if (isValid && (event.flags & EVENT_ANALOG))
+            {
+                isValid = reader.Read(event.analog[0]) && reader.Read(event.analog[1]) && reader.Read(event.analog[2]);
+            }
+            if (isValid && (event.flags & EVENT_CHAR))
+            {
+                isValid = reader.Read(event.charCode);
+            }
+            if (isValid && !frames.empty())
+            {
+                events.push_back(event);
+                frames.back().eventsCount += 1;
+            }
+            break;
+        }
+        case RECORD_SEED:
+        {
+            uint32 seed = 0;
+            isValid = reader.Read(seed);
+            seeds.push_back(seed);
+            break;
+        }
+        case RECORD_MARKER:
+        case RECORD_CHECKPOINT:
+        {
+            RecordedMarker marker;
+            marker.frame = static_cast<uint32>(frames.size());
+            marker.isCheckpoint = (type == RECORD_CHECKPOINT);
+            isValid = reader.ReadString(marker.name) && (!marker.isCheckpoint || reader.Read(marker.stateHash));
+            markers.push_back(marker);
+            break;
+        }
+        default:
+            isValid = false;
+            break;
+        }
+    }
 
-    return ev;
+    // Recording could be interrupted by crash, so truncated tail is dropped and the rest is played
+    if (!isValid)
+    {
+        Logger::Warning("[Replay] Replay is truncated after frame %u", static_cast<uint32>(frames.size()));
+    }
+    return true;
 }
 
-void Replay::PlaySeed()
+void Replay::WriteString(const String& value)
 {
+    DVASSERT(value.size() <= std::numeric_limits<uint16>::max());
+    Write(static_cast<uint16>(value.size()));
+    recordBuffer.insert(recordBuffer.end(), value.begin(), value.end());
 }
 
-bool Replay::IsEvent()
+int64 Replay::PlaybackReport::GetTotalTimeUs() const
 {
-    int8 type = Read<int8>();
-    while (VALUE_SEED == type)
+    return std::accumulate(frameTimesUs.begin(), frameTimesUs.end(), int64(0));
+}
+
+int64 Replay::PlaybackReport::GetPercentileUs(float32 percentile) const
+{
+    if (frameTimesUs.empty())
     {
-        Random::Instance()->Seed(Read<uint32>());
-        type = Read<int8>();
+        return 0;
     }
 
-    skipType = true;
-    return type == VALUE_EVENTS_COUNT;
+    Vector<int64> sorted(frameTimesUs);
+    size_t index = static_cast<size_t>(percentile * (sorted.size() - 1) + 0.5f);
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
 }
 
-void Replay::PauseReplay(bool isPause)
+String Replay::PlaybackReport::GetSummary() const
 {
-    pauseReplay = isPause;
+    int64 totalUs = GetTotalTimeUs();
+    int64 averageUs = (framesCount > 0) ? totalUs / framesCount : 0;
+    return Format("%u of %u frames played in %.1f ms: average %lld us, median %lld us, p95 %lld us, p99 %lld us, max %lld us; %u divergences",
+                  framesCount, recordedFramesCount, totalUs / 1000.0, averageUs,
+                  GetPercentileUs(0.5f), GetPercentileUs(0.95f), GetPercentileUs(0.99f), GetPercentileUs(1.f),
+                  static_cast<uint32>(divergences.size()));
+}
+
+bool Replay::PlaybackReport::SaveCSV(const FilePath& path) const
+{
+    ScopedPtr<File> file(File::Create(path, File::CREATE | File::WRITE));
+    if (!file)
+    {
+        Logger::Error("[Replay] Can't create %s", path.GetStringValue().c_str());
+        return false;
+    }
+
+    file->WriteLine("frame,cpu_us");
+    for (size_t i = 0; i < frameTimesUs.size(); ++i)
+    {
+        file->WriteLine(Format("%u,%lld", static_cast<uint32>(i), frameTimesUs[i]));
+    }
+    return true;
 }
 };
@@ -3,63 +3,190 @@
 
 #include "Base/Singleton.h"
 #include "Base/BaseTypes.h"
-#include "UI/UIEvent.h"
-#include "FileSystem/File.h"
-#include "Logger/Logger.h"
+#include "FileSystem/FilePath.h"
+#include "Functional/Signal.h"
 
 namespace DAVA
 {
 class File;
+class ReplayInputDevice;
+struct InputEvent;
+
+/**
+    \brief Records session to file and plays it back deterministically.
+
+    Replay file is a versioned binary stream of records: frame deltas, input events dispatched through `InputSystem`
+    (including keyboard chars and gamepad axes), `Random` seeds, app-defined markers and checkpoints.
+    Engine calls `BeginFrame` and `DispatchFrameInput` from its frame loop, so application code only has to start
+    recording or playback and optionally put markers and checkpoints at interesting points.
+
+    During playback live input is ignored, frame delta is taken from file (or `PlaybackSettings::fixedFrameDelta`)
+    and `Random::Seed` receives recorded seeds. Every recorded input device is replaced with a device driven by recorded
+    events (see `DeviceManager::GetInputDevice`), so systems that poll device state, like `ActionSystem`, get recorded input too. Checkpoint is a hash of some application state: if hash or order of
+    checkpoints differs from recorded ones, divergence is reported. Playback is not limited by wall clock, so in
+    console mode session is replayed as fast as possible and per-frame CPU time is collected to `PlaybackReport`.
+
+    Example:
+    \code
+    // record
+    Replay::Instance()->StartRecord("~doc:/battle.rep");
+    ...
+    Replay::Instance()->AddCheckpoint("battle_end", CRC32::ForBuffer(&battleState, sizeof(battleState)));
+    Replay::Instance()->StopRecord();
+
+    // playback, usually in console mode
+    Replay::PlaybackSettings settings;
+    settings.reportPath = "~doc:/battle_frames.csv";
+    settings.tracePath = "~doc:/battle_trace.json";
+    Replay::Instance()->playbackFinished.Connect([](const Replay::PlaybackReport& report) { Logger::Info("%s", report.GetSummary().c_str()); });
+    Replay::Instance()->StartPlayback("~doc:/battle.rep", settings);
+    \endcode
+*/
 class Replay : public Singleton<Replay>
 {
 public:
+    static const uint32 FORMAT_VERSION = 2;
+
+    struct PlaybackSettings
+    {
+        float32 fixedFrameDelta = 0.f; //!< Frame delta used instead of recorded ones if positive
+        bool stopOnDivergence = false;
+        bool dispatchToInputSystem = true; //!< Dispatch recorded events through `InputSystem`, `inputEventPlayed` is emitted anyway
+        bool captureProfilerTrace = true; //!< Start `ProfilerCPU::globalProfiler` for the time of playback
+        FilePath reportPath; //!< Per-frame CSV report written on finish if not empty
+        FilePath tracePath; //!< ProfilerCPU trace in JSON format written on finish if not empty
+    };
+
+    struct PlaybackReport
+    {
+        uint32 framesCount = 0;
+        uint32 recordedFramesCount = 0;
+        Vector<int64> frameTimesUs; //!< CPU time of each played frame
+        Vector<String> divergences;
+
+        int64 GetTotalTimeUs() const;
+        int64 GetPercentileUs(float32 percentile) const;
+        String GetSummary() const;
+        bool SaveCSV(const FilePath& path) const;
+    };
+
     static inline bool IsRecord();
     static inline bool IsPlayback();
 
     Replay();
     virtual ~Replay();
 
-    enum eValueType
-    {
-        VALUE_FRAMETIME = 0,
-        VALUE_EVENTS_COUNT,
-        VALUE_SEED
-    };
-
-    void StartRecord(const FilePath& dirName);
+    bool StartRecord(const FilePath& replayPath);
     void StopRecord();
-    void RecordFrame(float32 frameTime);
-    void RecordEventsCount(int32 eventsCount);
-    void RecordEvent(const UIEvent* ev);
-    void RecordSeed(const uint32 seed);
+
+    bool StartPlayback(const FilePath& replayPath);
+    bool StartPlayback(const FilePath& replayPath, const PlaybackSettings& settings);
+    void StopPlayback();
+
+    /** Pause recording or playback, e.g. while loading screen is shown. */
     void PauseReplay(bool isPause);
+    bool ReplayPaused() const;
 
-    void StartPlayback(const FilePath& dirName);
-    float32 PlayFrameTime();
-    int32 PlayEventsCount();
-    UIEvent PlayEvent();
-    void PlaySeed();
-    bool IsEvent();
+    /**
+        Start new frame: write `frameDelta` while recording or return frame delta which should be used instead of
+        `frameDelta` while playing back. Called by engine at the beginning of each frame.
+    */
+    float32 BeginFrame(float32 frameDelta);
 
-    bool ReplayPaused()
-    {
-        return pauseReplay;
-    }
+    /** Dispatch input events recorded for current frame. Called by engine after platform events are processed. */
+    void DispatchFrameInput();
+
+    /** Return true if replay is dispatching recorded input, i.e. `InputSystem` should let the event through. */
+    bool IsDispatchingInput() const;
+
+    void RecordInputEvent(const InputEvent& inputEvent);
+    void RecordSeed(uint32 seed);
+
+    /** Return recorded seed which should be used instead of `seed` during playback. */
+    uint32 PlaySeed(uint32 seed);
+
+    /** Put named marker to recording or check that the same marker is reached on the same frame during playback. */
+    void AddMarker(const String& name);
+
+    /** Same as `AddMarker` but also compares hash of application state with the recorded one. */
+    void AddCheckpoint(const String& name, uint32 stateHash);
+
+    const PlaybackReport& GetPlaybackReport() const;
+
+    Signal<const InputEvent&> inputEventPlayed;
+    Signal<const PlaybackReport&> playbackFinished;
 
 private:
-    static bool isRecord;
-    static bool isPlayback;
+    enum eRecordType : uint8
+    {
+        RECORD_FRAME = 1,
+        RECORD_INPUT,
+        RECORD_SEED,
+        RECORD_MARKER,
+        RECORD_CHECKPOINT
+    };
+
+    struct RecordedEvent
+    {
+        float64 timestamp = 0.0;
+        uint32 deviceType = 0;
+        uint32 deviceId = 0;
+        uint32 elementId = 0;
+        uint32 charCode = 0;
+        uint8 flags = 0;
+        float32 analog[3];
+    };
+
+    struct RecordedFrame
+    {
+        float32 frameDelta = 0.f;
+        uint32 firstEvent = 0;
+        uint32 eventsCount = 0;
+    };
+
+    struct RecordedMarker
+    {
+        String name;
+        uint32 frame = 0;
+        uint32 stateHash = 0;
+        bool isCheckpoint = false;
+    };
 
-    File* file;
+    void CheckMarker(const String& name, uint32 stateHash, bool isCheckpoint);
+    void ReportDivergence(const String& message);
+    void FinishPlayback();
+    void CreatePlaybackDevices();
+    void DestroyPlaybackDevices();
+    ReplayInputDevice* FindPlaybackDevice(uint32 deviceId) const;
+    void FlushRecord();
+    bool ParseReplay(const Vector<uint8>& data);
 
-    template <class T>
-    void Write(T value);
+    template <typename T>
+    void Write(const T& value);
+    void WriteString(const String& value);
 
-    template <class T>
-    T Read();
+    static bool isRecord;
+    static bool isPlayback;
 
-    bool skipType;
-    bool pauseReplay;
+    bool pauseReplay = false;
+    bool dispatchingInput = false;
+
+    File* recordFile = nullptr;
+    Vector<uint8> recordBuffer;
+    uint32 recordFrame = 0;
+
+    PlaybackSettings playbackSettings;
+    PlaybackReport report;
+    Vector<RecordedFrame> frames;
+    Vector<RecordedEvent> events;
+    Vector<uint32> seeds;
+    Vector<RecordedMarker> markers;
+    Vector<ReplayInputDevice*> playbackDevices;
+    size_t nextSeed = 0;
+    size_t nextMarker = 0;
+    uint32 playFrame = 0;
+    int64 frameStartUs = 0;
+    bool profilerStarted = false;
 };
 
 inline bool Replay::IsRecord()
@@ -72,25 +199,11 @@ inline bool Replay::IsPlayback()
     return (isPlayback && !Replay::Instance()->ReplayPaused());
 }
 
-template <class T>
-void Replay::Write(T value)
-{
-    file->Write(&value, sizeof(T));
-}
-
-template <class T>
-T Replay::Read()
+template <typename T>
+void Replay::Write(const T& value)
 {
-    T value;
-    file->Read(&value, sizeof(T));
-
-    if (file->GetPos() == file->GetSize())
-    {
-        isPlayback = false;
-        Logger::FrameworkDebug("replay ended");
-    }
-
-    return value;
+    const uint8* bytes = reinterpret_cast<const uint8*>(&value);
+    recordBuffer.insert(recordBuffer.end(), bytes, bytes + sizeof(T));
 }
 };
 
@@ -16,6 +16,7 @@ class Gamepad;
 class InputDevice;
 class Keyboard;
 class Mouse;
+class Replay;
 namespace Private
 {
 struct DeviceManagerImpl;
@@ -52,6 +53,11 @@ public:
 
     // Input methods
 
+    /**
+        Get input device with specified `id`.
+        During `Replay` playback devices driven by recorded input are returned instead of live ones,
+        while `GetGamepad`, `GetKeyboard`, `GetMouse` and `GetTouchScreen` always return live devices.
+    */
     InputDevice* GetInputDevice(uint32 id);
     Gamepad* GetGamepad();
     Keyboard* GetKeyboard();
@@ -88,11 +94,13 @@ private:
     Gamepad* gamepad = nullptr;
     TouchScreen* touchScreen = nullptr;
     Vector<InputDevice*> inputDevices;
+    Vector<InputDevice*> replayDevices; // Owned by `Replay`, override devices with the same ids
 
     std::unique_ptr<Private::DeviceManagerImpl> impl;
 
     friend class Private::EngineBackend;
     friend struct Private::DeviceManagerImpl;
+    friend class Replay;
 };
 
 inline const DisplayInfo& DeviceManager::GetPrimaryDisplay() const
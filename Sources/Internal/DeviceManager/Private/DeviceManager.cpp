@@ -152,6 +152,13 @@ void DeviceManager::OnEngineInited()
 
 InputDevice* DeviceManager::GetInputDevice(uint32 id)
 {
+    for (InputDevice* device : replayDevices)
+    {
+        if (device->GetId() == id)
+        {
+            return device;
+        }
+    }
     for (InputDevice* device : inputDevices)
     {
         if (device->GetId() == id)
@@ -46,6 +46,7 @@ class FastNameDB;
 class ReflectedTypeDB;
 
 class DebugOverlay;
+class Replay;
 class ImageConverter;
 
 namespace Net
@@ -114,6 +115,7 @@ public:
     ObjectFactory* objectFactory = nullptr;
 
     DebugOverlay* debugOverlay = nullptr;
+    Replay* replay = nullptr;
     ImageConverter* imageConverter = nullptr;
 };
 
@@ -16,6 +16,7 @@
 #include "ReflectionDeclaration/ReflectionDeclaration.h"
 #include "Autotesting/AutotestingSystem.h"
 #include "Base/AllocatorFactory.h"
+#include "Base/FrameAllocator.h"
 #include "Base/ObjectFactory.h"
 #include "Core/PerformanceSettings.h"
 #include "Debug/ProfilerCPU.h"
@@ -46,6 +47,7 @@
 #include "Platform/Steam.h"
 #include "PluginManager/PluginManager.h"
 #include "Render/2D/FontManager.h"
+#include "Render/2D/Sprite.h"
 #include "Render/2D/FTFont.h"
 #include "Render/2D/TextBlock.h"
 #include "Render/2D/Systems/RenderSystem2D.h"
@@ -54,6 +56,7 @@
 #include "Render/Image/ImageSystem.h"
 #include "Render/Image/ImageConverter.h"
 #include "Render/Renderer.h"
+#include "Render/Texture.h"
 #include "Render/RHI/rhi_ShaderSource.h"
 #include "Scene3D/SceneFile/VersionInfo.h"
 #include "Sound/SoundEvent.h"
@@ -327,6 +330,8 @@ void EngineBackend::RunConsole()
         {
             rhi::InitParam params{};
             Renderer::Initialize(rhi::RHI_NULL_RENDERER, params);
+            // Allow headless 2D rendering, e.g. to collect render stats in tests
+            context->renderSystem2D->Init();
         }
     }
 
@@ -372,6 +377,10 @@ void EngineBackend::OnEngineCleanup()
 
     engine->cleanup.Emit();
 
+    // Sprites are released first as they put their textures to texture retention cache
+    Sprite::GetRetentionCache().Clear();
+    Texture::GetRetentionCache().Clear();
+
     if (ImGui::IsInitialized())
         ImGui::Uninitialize();
 
@@ -415,19 +424,27 @@ void EngineBackend::DoEvents()
 
 void EngineBackend::OnFrameConsole()
 {
+    DAVA_PROFILER_CPU_SCOPE_WITH_FRAME_INDEX(ProfilerCPUMarkerName::ENGINE_ON_FRAME, globalFrameIndex);
+
     SystemTimer::StartFrame();
     float32 frameDelta = SystemTimer::GetFrameDelta();
+    if (Replay::IsRecord() || Replay::IsPlayback())
+    {
+        frameDelta = context->replay->BeginFrame(frameDelta);
+    }
     SystemTimer::ComputeRealFrameDelta();
     // TODO: UpdateGlobalTime is deprecated, remove later
     SystemTimer::UpdateGlobalTime(frameDelta);
 
     DoEvents();
+    context->replay->DispatchFrameInput();
     engine->update.Emit(frameDelta);
 
     // Notify memory profiler about new frame
     DAVA_MEMORY_PROFILER_UPDATE();
 
     globalFrameIndex += 1;
+    FrameAllocator::NextFrame();
 }
 
 int32 EngineBackend::OnFrame()
@@ -436,8 +453,13 @@ int32 EngineBackend::OnFrame()
 
     SystemTimer::StartFrame();
     float32 frameDelta = SystemTimer::GetFrameDelta();
+    if (Replay::IsRecord() || Replay::IsPlayback())
+    {
+        frameDelta = context->replay->BeginFrame(frameDelta);
+    }
 
     DoEvents();
+    context->replay->DispatchFrameInput();
     if (!appIsSuspended)
     {
         SystemTimer::ComputeRealFrameDelta();
@@ -472,6 +494,7 @@ int32 EngineBackend::OnFrame()
     DAVA_MEMORY_PROFILER_UPDATE();
 
     globalFrameIndex += 1;
+    FrameAllocator::NextFrame();
     return Renderer::GetDesiredFPS();
 }
 
@@ -506,6 +529,9 @@ void EngineBackend::UpdateAndDrawWindows(float32 frameDelta, bool drawOnly)
             w->Update(frameDelta);
         }
 
+        // Upload sprites packed into dynamic atlas pages during update
+        context->dynamicAtlasSystem->Update();
+
         {
             DAVA_PROFILER_CPU_SCOPE(ProfilerCPUMarkerName::ENGINE_DRAW_WINDOW);
             Renderer::GetRenderStats().Reset();
@@ -751,6 +777,9 @@ void EngineBackend::HandleLowMemory(const MainDispatcherEvent& e)
 {
     Logger::Info("EngineBackend::HandleLowMemory");
 
+    Sprite::GetRetentionCache().Clear();
+    Texture::GetRetentionCache().Clear();
+
     engine->lowMemory.Emit();
 }
 
@@ -941,9 +970,10 @@ void EngineBackend::CreateSubsystems(const Vector<String>& modules)
         }
     }
 
+    // Input system is also created in console mode to let `Replay` dispatch recorded input to raw input handlers
+    context->inputSystem = new InputSystem(engine);
     if (!IsConsoleMode())
     {
-        context->inputSystem = new InputSystem(engine);
         context->actionSystem = new ActionSystem();
         context->uiScreenManager = new UIScreenManager(context->uiControlSystem);
         context->localNotificationController = new LocalNotificationController();
@@ -965,6 +995,7 @@ void EngineBackend::CreateSubsystems(const Vector<String>& modules)
     context->analyticsCore = new Analytics::Core;
 
     context->inputListener = new InputBindingListener();
+    context->replay = new Replay();
 
 #ifdef __DAVAENGINE_AUTOTESTING__
     context->autotestingSystem = new AutotestingSystem();
@@ -1058,6 +1089,7 @@ void EngineBackend::DestroySubsystems()
     }
 
     SafeDelete(context->inputListener);
+    SafeDelete(context->replay);
 
     if (context->inputSystem != nullptr)
     {
@@ -0,0 +1,413 @@
+#include "FileSystem/DirectoryWalker.h"
+
+#include "Concurrency/ConditionVariable.h"
+#include "Concurrency/LockGuard.h"
+#include "Concurrency/Mutex.h"
+#include "Concurrency/UniqueLock.h"
+#include "Engine/Engine.h"
+#include "FileSystem/FileList.h"
+#include "Job/JobManager.h"
+#include "Utils/UTF8Utils.h"
+#include "Utils/Utils.h"
+
+#if defined(__DAVAENGINE_WINDOWS__)
+#include <io.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+
+namespace DAVA
+{
+namespace DirectoryWalkerDetails
+{
+struct DirNode;
+
+struct DirEntry
+{
+    String name;
+    uint64 size = 0;
+    uint64 modificationTime = 0;
+    bool isDirectory = false;
+    std::unique_ptr<DirNode> child;
+};
+
+struct DirNode
+{
+    String absolutePath;
+    String relativePath;
+    Vector<DirEntry> entries;
+};
+
+class WalkContext
+{
+public:
+    WalkContext(const DirectoryWalker::Options& options_)
+        : options(options_)
+    {
+    }
+
+    void Push(DirNode* node)
+    {
+        LockGuard<Mutex> lock(mutex);
+        queue.push_back(node);
+        ++pendingCount;
+    }
+
+    void Process()
+    {
+        UniqueLock<Mutex> lock(mutex);
+        while (true)
+        {
+            // idle threads sleep until directory being scanned adds subdirectories or the last one is finished
+            queueChanged.Wait(lock, [this]() { return !queue.empty() || pendingCount == 0; });
+            if (queue.empty())
+            {
+                break;
+            }
+
+            DirNode* node = queue.front();
+            queue.pop_front();
+
+            lock.Unlock();
+            Scan(node);
+            lock.Lock();
+        }
+    }
+
+    DirectoryWalker::Statistics GetStatistics()
+    {
+        LockGuard<Mutex> lock(mutex);
+        return statistics;
+    }
+
+private:
+    bool Accept(const DirNode* node, const String& name, bool isDirectory, bool isHidden) const
+    {
+        if (isHidden && !options.includeHidden)
+        {
+            return false;
+        }
+
+        if (std::find(options.excludeNames.begin(), options.excludeNames.end(), name) != options.excludeNames.end())
+        {
+            return false;
+        }
+
+        if (isDirectory)
+        {
+            if (!options.recursive && !options.includeDirectories)
+            {
+                return false;
+            }
+        }
+        else if (!options.extensions.empty())
+        {
+            String::size_type dotPos = name.rfind('.');
+            if (dotPos == String::npos)
+            {
+                return false;
+            }
+
+            String extension = name.substr(dotPos);
+            auto matches = [&extension](const String& ext) { return CompareCaseInsensitive(extension, ext) == 0; };
+            if (std::none_of(options.extensions.begin(), options.extensions.end(), matches))
+            {
+                return false;
+            }
+        }
+
+        if (options.filter)
+        {
+            String relativePath = node->relativePath + name;
+            if (isDirectory)
+            {
+                relativePath += '/';
+            }
+            return options.filter(relativePath, isDirectory);
+        }
+
+        return true;
+    }
+
+    void Scan(DirNode* node)
+    {
+        DirectoryWalker::Statistics nodeStatistics;
+        ReadDirectory(node, nodeStatistics);
+
+        // Same order as sorted FileList: directories first, then case-insensitive by name.
+        // Names that differ only in case are ordered byte-wise to keep result deterministic
+        std::sort(node->entries.begin(), node->entries.end(), [](const DirEntry& l, const DirEntry& r) {
+            if (l.isDirectory != r.isDirectory)
+            {
+                return l.isDirectory;
+            }
+
+            int32 result = CompareCaseInsensitive(l.name, r.name);
+            return (result != 0) ? (result < 0) : (l.name < r.name);
+        });
+
+        Vector<DirNode*> children;
+        for (DirEntry& entry : node->entries)
+        {
+            if (entry.isDirectory)
+            {
+                ++nodeStatistics.directoriesCount;
+                if (options.recursive)
+                {
+                    entry.child.reset(new DirNode());
+                    entry.child->absolutePath = node->absolutePath + entry.name + '/';
+                    entry.child->relativePath = node->relativePath + entry.name + '/';
+                    children.push_back(entry.child.get());
+                }
+            }
+            else
+            {
+                ++nodeStatistics.filesCount;
+            }
+        }
+
+        bool notify = false;
+        {
+            LockGuard<Mutex> lock(mutex);
+            queue.insert(queue.end(), children.begin(), children.end());
+
+            // children are counted together with decrement for this node, so waiting threads can't see zero while walk is not finished
+            pendingCount += static_cast<uint32>(children.size());
+            --pendingCount;
+            notify = !children.empty() || pendingCount == 0;
+
+            statistics.directoriesCount += nodeStatistics.directoriesCount;
+            statistics.filesCount += nodeStatistics.filesCount;
+            statistics.openCalls += nodeStatistics.openCalls;
+            statistics.statCalls += nodeStatistics.statCalls;
+        }
+
+        if (notify)
+        {
+            queueChanged.NotifyAll();
+        }
+    }
+
+#if defined(__DAVAENGINE_WINDOWS__)
+    void ReadDirectory(DirNode* node, DirectoryWalker::Statistics& nodeStatistics)
+    {
+        WideString searchPath = UTF8Utils::EncodeToWideString(node->absolutePath) + L'*';
+
+        struct _wfinddata64_t findData;
+        intptr_t handle = _wfindfirst64(searchPath.c_str(), &findData);
+        ++nodeStatistics.openCalls;
+        if (handle == -1)
+        {
+            return;
+        }
+
+        do
+        {
+            if (wcscmp(findData.name, L".") == 0 || wcscmp(findData.name, L"..") == 0)
+            {
+                continue;
+            }
+
+            String name = UTF8Utils::EncodeToUTF8(findData.name);
+            bool isDirectory = (findData.attrib & _A_SUBDIR) != 0;
+            bool isHidden = (findData.attrib & _A_HIDDEN) != 0;
+            if (Accept(node, name, isDirectory, isHidden))
+            {
+                DirEntry entry;
+                entry.name = std::move(name);
+                entry.isDirectory = isDirectory;
+                if (options.collectFileInfo && !isDirectory)
+                {
+                    entry.size = static_cast<uint64>(findData.size);
+                    entry.modificationTime = static_cast<uint64>(findData.time_write);
+                }
+                node->entries.push_back(std::move(entry));
+            }
+        } while (_wfindnext64(handle, &findData) == 0);
+
+        _findclose(handle);
+    }
+#else
+    void ReadDirectory(DirNode* node, DirectoryWalker::Statistics& nodeStatistics)
+    {
+        int fd = open(node->absolutePath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        ++nodeStatistics.openCalls;
+        DIR* dir = (fd >= 0) ? fdopendir(fd) : nullptr;
+        if (dir == nullptr)
+        {
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+#if defined(__DAVAENGINE_ANDROID__)
+            // directory may be packed into APK assets
+            ReadDirectoryWithFileList(node);
+#endif
+            return;
+        }
+
+        for (struct dirent* ent = readdir(dir); ent != nullptr; ent = readdir(dir))
+        {
+            const char* name = ent->d_name;
+            if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0)
+            {
+                continue;
+            }
+
+            struct stat st;
+            bool hasStat = false;
+            bool isDirectory = (ent->d_type == DT_DIR);
+            if (ent->d_type != DT_DIR && ent->d_type != DT_REG)
+            {
+                // symlinks and file systems that do not report entry type
+                ++nodeStatistics.statCalls;
+                if (fstatat(fd, name, &st, 0) != 0 || (!S_ISDIR(st.st_mode) && !S_ISREG(st.st_mode)))
+                {
+                    continue;
+                }
+                hasStat = true;
+                isDirectory = S_ISDIR(st.st_mode);
+            }
+
+            if (!Accept(node, name, isDirectory, name[0] == '.'))
+            {
+                continue;
+            }
+
+            DirEntry entry;
+            entry.name = name;
+            entry.isDirectory = isDirectory;
+            if (options.collectFileInfo && !isDirectory)
+            {
+                if (!hasStat)
+                {
+                    ++nodeStatistics.statCalls;
+                    hasStat = (fstatat(fd, name, &st, 0) == 0);
+                }
+
+                if (hasStat)
+                {
+                    entry.size = static_cast<uint64>(st.st_size);
+                    entry.modificationTime = static_cast<uint64>(st.st_mtime);
+                }
+            }
+            node->entries.push_back(std::move(entry));
+        }
+
+        closedir(dir);
+    }
+#endif
+
+#if defined(__DAVAENGINE_ANDROID__)
+    void ReadDirectoryWithFileList(DirNode* node)
+    {
+        ScopedPtr<FileList> fileList(new FileList(FilePath(node->absolutePath), options.includeHidden));
+        for (uint32 i = 0; i < fileList->GetCount(); ++i)
+        {
+            if (fileList->IsNavigationDirectory(i))
+            {
+                continue;
+            }
+
+            const String& name = fileList->GetFilename(i);
+            bool isDirectory = fileList->IsDirectory(i);
+            if (Accept(node, name, isDirectory, fileList->IsHidden(i)))
+            {
+                DirEntry entry;
+                entry.name = name;
+                entry.isDirectory = isDirectory;
+                entry.size = options.collectFileInfo ? fileList->GetFileSize(i) : 0;
+                node->entries.push_back(std::move(entry));
+            }
+        }
+    }
+#endif
+
+    const DirectoryWalker::Options options;
+
+    Mutex mutex;
+    ConditionVariable queueChanged;
+    Deque<DirNode*> queue;
+    uint32 pendingCount = 0; // queued and being scanned directories
+    DirectoryWalker::Statistics statistics;
+};
+
+void Emit(const DirNode* node, bool includeDirectories, const Function<void(const DirectoryWalker::Entry&)>& callback)
+{
+    DirectoryWalker::Entry result;
+    for (const DirEntry& entry : node->entries)
+    {
+        result.relativePath = node->relativePath + entry.name;
+        result.isDirectory = entry.isDirectory;
+        result.size = entry.size;
+        result.modificationTime = entry.modificationTime;
+
+        if (entry.isDirectory)
+        {
+            result.relativePath += '/';
+            if (includeDirectories)
+            {
+                callback(result);
+            }
+
+            if (entry.child)
+            {
+                Emit(entry.child.get(), includeDirectories, callback);
+            }
+        }
+        else
+        {
+            callback(result);
+        }
+    }
+}
+} // namespace DirectoryWalkerDetails
+
+Vector<DirectoryWalker::Entry> DirectoryWalker::Walk(const FilePath& root, const Options& options, Statistics* statistics)
+{
+    Vector<Entry> result;
+    Walk(root, options, [&result](const Entry& entry) { result.push_back(entry); }, statistics);
+    return result;
+}
+
+void DirectoryWalker::Walk(const FilePath& root, const Options& options, const Function<void(const Entry&)>& callback, Statistics* statistics)
+{
+    using namespace DirectoryWalkerDetails;
+
+    DVASSERT(root.IsDirectoryPathname());
+
+    DirNode rootNode;
+    rootNode.absolutePath = root.GetAbsolutePathname();
+    if (rootNode.absolutePath.empty() || rootNode.absolutePath.back() != '/')
+    {
+        rootNode.absolutePath += '/';
+    }
+
+    // Context is shared with worker jobs, as they may start or wake up after walk is finished
+    std::shared_ptr<WalkContext> context = std::make_shared<WalkContext>(options);
+    context->Push(&rootNode);
+
+    JobManager* jobManager = GetEngineContext()->jobManager;
+    if (options.parallel && options.recursive && jobManager != nullptr)
+    {
+        uint32 jobsCount = jobManager->GetWorkersCount();
+        for (uint32 i = 0; i < jobsCount; ++i)
+        {
+            jobManager->CreateWorkerJob([context]() { context->Process(); });
+        }
+    }
+    context->Process();
+
+    if (statistics != nullptr)
+    {
+        *statistics = context->GetStatistics();
+    }
+
+    Emit(&rootNode, options.includeDirectories, callback);
+}
+} // namespace DAVA
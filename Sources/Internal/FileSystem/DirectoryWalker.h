@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Base/BaseTypes.h"
+#include "FileSystem/FilePath.h"
+#include "Functional/Function.h"
+
+namespace DAVA
+{
+/**
+    \ingroup filesystem
+    \brief Fast recursive enumeration of directory contents.
+
+    Directories are read with as few system calls as possible: entry type is taken from directory listing,
+    and entries are stat'ed (relative to already opened directory) only if type is unknown or file sizes
+    and modification times are requested. Subdirectories are walked concurrently on `JobManager` worker
+    threads if job manager is available, calling thread always takes part in the walk.
+
+    Result does not depend on walk concurrency: entries of every directory are sorted as in `FileList::Sort`
+    (directories first, then names compared case-insensitively) and directories are expanded in place,
+    i.e. result is a depth-first pre-order traversal.
+
+    Example:
+    \code
+    DirectoryWalker::Options options;
+    options.includeHidden = false;
+    options.extensions = { ".png", ".psd" };
+    for (const DirectoryWalker::Entry& e : DirectoryWalker::Walk("~res:/Gfx/", options))
+    {
+        Logger::Info("%s", e.relativePath.c_str());
+    }
+    \endcode
+*/
+class DirectoryWalker
+{
+public:
+    struct Options
+    {
+        /** Walk into subdirectories. */
+        bool recursive = true;
+
+        /** Report hidden files and walk into hidden directories. */
+        bool includeHidden = true;
+
+        /** Report directories as separate entries (before their contents). */
+        bool includeDirectories = false;
+
+        /** Fill `Entry::size` and `Entry::modificationTime` for files. */
+        bool collectFileInfo = false;
+
+        /** Walk subdirectories on worker threads. */
+        bool parallel = true;
+
+        /** File or directory names that should be skipped, e.g. ".svn". */
+        Vector<String> excludeNames;
+
+        /** Extensions of files to report including leading dot, compared case-insensitively. Empty means all files. */
+        Vector<String> extensions;
+
+        /**
+            Custom filter that receives path relative to walk root and returns false to skip entry.
+            Skipped directory is not walked. Filter is called concurrently from several threads.
+        */
+        Function<bool(const String& relativePath, bool isDirectory)> filter;
+    };
+
+    struct Entry
+    {
+        /** Path relative to walk root, separated by '/'. Directory paths end with '/'. */
+        String relativePath;
+        uint64 size = 0;
+        uint64 modificationTime = 0;
+        bool isDirectory = false;
+    };
+
+    /** Counters of the last walk, mostly for profiling. */
+    struct Statistics
+    {
+        uint32 directoriesCount = 0;
+        uint32 filesCount = 0;
+        uint32 openCalls = 0;
+        uint32 statCalls = 0;
+    };
+
+    /** Walk directory `root` and return found entries. */
+    static Vector<Entry> Walk(const FilePath& root, const Options& options, Statistics* statistics = nullptr);
+
+    /** Walk directory `root` and call `callback` for every found entry from calling thread in the same order as `Walk` returns them. */
+    static void Walk(const FilePath& root, const Options& options, const Function<void(const Entry&)>& callback, Statistics* statistics = nullptr);
+};
+} // namespace DAVA
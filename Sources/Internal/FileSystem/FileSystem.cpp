@@ -5,6 +5,7 @@
 #include "Base/Exception.h"
 #include "Debug/Backtrace.h"
 
+#include "FileSystem/DirectoryWalker.h"
 #include "FileSystem/FileAPIHelper.h"
 #include "FileSystem/FileSystem.h"
 #include "FileSystem/FileSystemDelegate.h"
@@ -371,28 +372,13 @@ uint32 FileSystem::DeleteDirectoryFiles(const FilePath& path, bool isRecursive)
 
 Vector<FilePath> FileSystem::EnumerateFilesInDirectory(const FilePath& path, bool isRecursive)
 {
-    ScopedPtr<FileList> fileList(new FileList(path));
-    Vector<FilePath> result;
+    DirectoryWalker::Options options;
+    options.recursive = isRecursive;
 
-    for (uint32 i = 0; i < fileList->GetCount(); ++i)
-    {
-        if (fileList->IsNavigationDirectory(i))
-        {
-            continue;
-        }
-        else if (fileList->IsDirectory(i))
-        {
-            if (isRecursive)
-            {
-                Vector<FilePath> subDirList = EnumerateFilesInDirectory(fileList->GetPathname(i));
-                std::move(subDirList.begin(), subDirList.end(), std::back_inserter(result));
-            }
-        }
-        else
-        {
-            result.push_back(fileList->GetPathname(i));
-        }
-    }
+    Vector<FilePath> result;
+    DirectoryWalker::Walk(path, options, [&path, &result](const DirectoryWalker::Entry& entry) {
+        result.push_back(path + entry.relativePath);
+    });
 
     return result;
 }
@@ -0,0 +1,271 @@
+#include "UnitTests/UnitTests.h"
+
+#include "Base/ScopedPtr.h"
+#include "Engine/Engine.h"
+#include "FileSystem/DirectoryWalker.h"
+#include "FileSystem/File.h"
+#include "FileSystem/FileList.h"
+#include "FileSystem/FileSystem.h"
+#include "Logger/Logger.h"
+#include "Time/SystemTimer.h"
+#include "Utils/StringFormat.h"
+
+using namespace DAVA;
+
+namespace DirectoryWalkerTestDetails
+{
+void CreateTestFile(const FilePath& path, const String& content = String())
+{
+    ScopedPtr<File> file(File::Create(path, File::CREATE | File::WRITE));
+    if (!content.empty())
+    {
+        file->WriteString(content, false);
+    }
+}
+
+Vector<String> GetPaths(const Vector<DirectoryWalker::Entry>& entries)
+{
+    Vector<String> result;
+    for (const DirectoryWalker::Entry& e : entries)
+    {
+        result.push_back(e.relativePath);
+    }
+    return result;
+}
+
+// Recursive enumeration through FileList, as it was done before DirectoryWalker
+void EnumerateWithFileList(const FilePath& path, Vector<FilePath>& result, uint32& directoriesCount, bool sorted = false)
+{
+    ++directoriesCount;
+    ScopedPtr<FileList> fileList(new FileList(path));
+    if (sorted)
+    {
+        fileList->Sort();
+    }
+
+    for (uint32 i = 0; i < fileList->GetCount(); ++i)
+    {
+        if (fileList->IsNavigationDirectory(i))
+        {
+            continue;
+        }
+        else if (fileList->IsDirectory(i))
+        {
+            EnumerateWithFileList(fileList->GetPathname(i), result, directoriesCount, sorted);
+        }
+        else
+        {
+            result.push_back(fileList->GetPathname(i));
+        }
+    }
+}
+}
+
+DAVA_TESTCLASS (DirectoryWalkerTest)
+{
+    FilePath testFolder;
+
+    DirectoryWalkerTest()
+    {
+        FileSystem* fs = GetEngineContext()->fileSystem;
+        testFolder = fs->GetTempDirectoryPath();
+        testFolder.MakeDirectoryPathname();
+        testFolder += "DirectoryWalkerTest/";
+        fs->DeleteDirectory(testFolder, true);
+    }
+
+    ~DirectoryWalkerTest()
+    {
+        GetEngineContext()->fileSystem->DeleteDirectory(testFolder, true);
+    }
+
+    DAVA_TEST (WalkTest)
+    {
+        using namespace DirectoryWalkerTestDetails;
+
+        FileSystem* fs = GetEngineContext()->fileSystem;
+        FilePath root = testFolder + "walk/";
+        fs->CreateDirectory(root + "sub1/", true);
+        fs->CreateDirectory(root + "sub2/deep/", true);
+        fs->CreateDirectory(root + ".hiddendir/", true);
+
+        CreateTestFile(root + "b.txt", "12345");
+        CreateTestFile(root + "a.png");
+        CreateTestFile(root + "C.PNG");
+        CreateTestFile(root + ".hidden.png");
+        CreateTestFile(root + "sub1/y.txt");
+        CreateTestFile(root + "sub1/x.png");
+        CreateTestFile(root + "sub2/deep/w.png");
+        CreateTestFile(root + ".hiddendir/z.png");
+
+        DirectoryWalker::Options options;
+        options.includeHidden = false;
+        Vector<String> expected = { "sub1/x.png", "sub1/y.txt", "sub2/deep/w.png", "a.png", "b.txt", "C.PNG" };
+#if !defined(__DAVAENGINE_WINDOWS__)
+        TEST_VERIFY(GetPaths(DirectoryWalker::Walk(root, options)) == expected);
+
+        // names starting with dot are hidden on posix systems
+        options.includeHidden = true;
+        expected = { ".hiddendir/z.png", "sub1/x.png", "sub1/y.txt", "sub2/deep/w.png", ".hidden.png", "a.png", "b.txt", "C.PNG" };
+        TEST_VERIFY(GetPaths(DirectoryWalker::Walk(root, options)) == expected);
+        options.includeHidden = false;
+#endif
+
+        // result does not depend on walk concurrency
+        options.parallel = false;
+        Vector<String> sequential = GetPaths(DirectoryWalker::Walk(root, options));
+        options.parallel = true;
+        TEST_VERIFY(GetPaths(DirectoryWalker::Walk(root, options)) == sequential);
+
+        options.extensions = { ".png" };
+        options.excludeNames = { ".hiddendir", ".hidden.png" };
+        expected = { "sub1/x.png", "sub2/deep/w.png", "a.png", "C.PNG" };
+        TEST_VERIFY(GetPaths(DirectoryWalker::Walk(root, options)) == expected);
+
+        options.excludeNames = { "sub2", ".hiddendir", ".hidden.png" };
+        options.filter = [](const String& path, bool isDirectory) { return path != "a.png"; };
+        expected = { "sub1/x.png", "C.PNG" };
+        TEST_VERIFY(GetPaths(DirectoryWalker::Walk(root, options)) == expected);
+
+        DirectoryWalker::Options dirOptions;
+        dirOptions.includeDirectories = true;
+        dirOptions.excludeNames = { ".hiddendir", ".hidden.png" };
+        expected = { "sub1/", "sub1/x.png", "sub1/y.txt", "sub2/", "sub2/deep/", "sub2/deep/w.png", "a.png", "b.txt", "C.PNG" };
+        TEST_VERIFY(GetPaths(DirectoryWalker::Walk(root, dirOptions)) == expected);
+
+        dirOptions.recursive = false;
+        expected = { "sub1/", "sub2/", "a.png", "b.txt", "C.PNG" };
+        TEST_VERIFY(GetPaths(DirectoryWalker::Walk(root, dirOptions)) == expected);
+
+        DirectoryWalker::Options infoOptions;
+        infoOptions.collectFileInfo = true;
+        infoOptions.filter = [](const String& path, bool isDirectory) { return isDirectory || path == "b.txt"; };
+        DirectoryWalker::Statistics statistics;
+        Vector<DirectoryWalker::Entry> entries = DirectoryWalker::Walk(root, infoOptions, &statistics);
+        TEST_VERIFY(entries.size() == 1);
+        TEST_VERIFY(entries[0].size == 5);
+        TEST_VERIFY(entries[0].modificationTime > 0);
+        TEST_VERIFY(statistics.filesCount == 1);
+        TEST_VERIFY(statistics.directoriesCount == 4);
+
+        // FileSystem enumeration goes through walker
+        Vector<FilePath> files = fs->EnumerateFilesInDirectory(root, false);
+        Vector<FilePath> expectedFiles;
+        for (const DirectoryWalker::Entry& e : DirectoryWalker::Walk(root, dirOptions))
+        {
+            if (!e.isDirectory)
+            {
+                expectedFiles.push_back(root + e.relativePath);
+            }
+        }
+        expectedFiles.insert(expectedFiles.begin(), root + ".hidden.png");
+        TEST_VERIFY(files == expectedFiles);
+
+        // missing directory
+        TEST_VERIFY(DirectoryWalker::Walk(root + "missing/", options).empty());
+    }
+
+    DAVA_TEST (FileListOrderTest)
+    {
+        using namespace DirectoryWalkerTestDetails;
+
+        FileSystem* fs = GetEngineContext()->fileSystem;
+        FilePath root = testFolder + "order/";
+
+        // mixed-case names of files and directories, no names differing only in case
+        const Vector<String> directories = { "Beta/", "alpha/", "Delta/Sub/", "Delta/nested/", "epsilon/" };
+        const Vector<String> files = { "Gamma.txt", "delta.TXT", "Alpha.png", "beta_1.dat", "Beta_2.dat", "_Underscore.txt", "zeta",
+                                       "Beta/File.dat", "Beta/another.dat", "Beta/Zulu.dat", "alpha/B.txt", "alpha/a.txt",
+                                       "Delta/Sub/X.png", "Delta/Sub/y.png", "Delta/nested/Q", "Delta/p", "epsilon/E.txt" };
+        for (const String& dir : directories)
+        {
+            fs->CreateDirectory(root + dir, true);
+        }
+        for (const String& file : files)
+        {
+            CreateTestFile(root + file);
+        }
+
+        Vector<FilePath> fileListResult;
+        uint32 fileListDirectories = 0;
+        EnumerateWithFileList(root, fileListResult, fileListDirectories, true);
+        TEST_VERIFY(fileListResult.size() == files.size());
+
+        TEST_VERIFY(fs->EnumerateFilesInDirectory(root) == fileListResult);
+
+        for (bool parallel : { false, true })
+        {
+            DirectoryWalker::Options options;
+            options.parallel = parallel;
+
+            Vector<FilePath> walkerResult;
+            DirectoryWalker::Walk(root, options, [&root, &walkerResult](const DirectoryWalker::Entry& entry) {
+                walkerResult.push_back(root + entry.relativePath);
+            });
+            TEST_VERIFY(walkerResult == fileListResult);
+        }
+
+        fs->DeleteDirectory(root, true);
+    }
+
+    DAVA_TEST (WalkBenchmark)
+    {
+        using namespace DirectoryWalkerTestDetails;
+
+        const uint32 topDirectoriesCount = 200;
+        const uint32 subDirectoriesCount = 10;
+        const uint32 filesPerDirectory = 100;
+
+        FileSystem* fs = GetEngineContext()->fileSystem;
+        FilePath root = testFolder + "benchmark/";
+
+        int64 generateStart = SystemTimer::GetUs();
+        for (uint32 d = 0; d < topDirectoriesCount; ++d)
+        {
+            for (uint32 s = 0; s < subDirectoriesCount; ++s)
+            {
+                FilePath dir = root + Format("dir_%03u/sub_%02u/", d, s);
+                fs->CreateDirectory(dir, true);
+                for (uint32 f = 0; f < filesPerDirectory; ++f)
+                {
+                    CreateTestFile(dir + Format("file_%03u.dat", f));
+                }
+            }
+        }
+        int64 generateTime = SystemTimer::GetUs() - generateStart;
+        const uint32 filesCount = topDirectoriesCount * subDirectoriesCount * filesPerDirectory;
+
+        Vector<FilePath> fileListResult;
+        uint32 fileListDirectories = 0;
+        int64 fileListStart = SystemTimer::GetUs();
+        EnumerateWithFileList(root, fileListResult, fileListDirectories);
+        int64 fileListTime = SystemTimer::GetUs() - fileListStart;
+
+        DirectoryWalker::Options options;
+        options.parallel = false;
+        DirectoryWalker::Statistics sequentialStatistics;
+        int64 sequentialStart = SystemTimer::GetUs();
+        Vector<DirectoryWalker::Entry> sequentialResult = DirectoryWalker::Walk(root, options, &sequentialStatistics);
+        int64 sequentialTime = SystemTimer::GetUs() - sequentialStart;
+
+        options.parallel = true;
+        DirectoryWalker::Statistics parallelStatistics;
+        int64 parallelStart = SystemTimer::GetUs();
+        Vector<DirectoryWalker::Entry> parallelResult = DirectoryWalker::Walk(root, options, &parallelStatistics);
+        int64 parallelTime = SystemTimer::GetUs() - parallelStart;
+
+        TEST_VERIFY(fileListResult.size() == filesCount);
+        TEST_VERIFY(sequentialResult.size() == filesCount);
+        TEST_VERIFY(GetPaths(sequentialResult) == GetPaths(parallelResult));
+
+        // FileList opens every directory and stats every file by absolute path
+        uint32 fileListSyscalls = fileListDirectories + static_cast<uint32>(fileListResult.size());
+        Logger::Info("DirectoryWalker benchmark (%u files, generated in %lld us): FileList %lld us ~%u open/stat calls, "
+                     "walker %lld us %u open/stat calls, parallel walker %lld us %u open/stat calls",
+                     filesCount, generateTime, fileListTime, fileListSyscalls,
+                     sequentialTime, sequentialStatistics.openCalls + sequentialStatistics.statCalls,
+                     parallelTime, parallelStatistics.openCalls + parallelStatistics.statCalls);
+
+        fs->DeleteDirectory(root, true);
+    }
+};
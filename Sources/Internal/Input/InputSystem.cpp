@@ -1,5 +1,6 @@
 #include "Input/InputSystem.h"
 
+#include "Debug/Replay.h"
 #include "Engine/Engine.h"
 #include "Engine/Private/EngineBackend.h"
 #include "UI/UIControlSystem.h"
@@ -53,6 +54,16 @@ void InputSystem::RemoveHandler(uint32 token)
 
 void InputSystem::DispatchInputEvent(const InputEvent& inputEvent)
 {
+    if (Replay::IsPlayback() && !Replay::Instance()->IsDispatchingInput())
+    {
+        // Live input is ignored while recorded session is played back
+        return;
+    }
+    if (Replay::IsRecord())
+    {
+        Replay::Instance()->RecordInputEvent(inputEvent);
+    }
+
     bool handled = false;
     for (const InputHandler& h : handlers)
     {
@@ -87,6 +98,11 @@ void InputSystem::EndFrame()
 
 void InputSystem::HandleInputEvent(UIEvent* uie)
 {
+    if (Replay::IsPlayback())
+    {
+        return;
+    }
+
     bool handled = false;
     for (const InputHandler& h : handlers)
     {
@@ -8,13 +8,13 @@
 #include "Concurrency/UniqueLock.h"
 #include "Job/JobThread.h"
 #include "Platform/DeviceInfo.h"
+#include "Time/SystemTimer.h"
 
 namespace DAVA
 {
 JobManager::JobManager(Engine* e)
     : engine(e)
     , mainJobIDCounter(1)
-    , mainJobLastExecutedID(0)
     , workerDoneSem(0)
 {
     uint32 cpuCoresCount = DeviceInfo::GetCpuCount();
@@ -35,9 +35,11 @@ JobManager::~JobManager()
 
     {
         LockGuard<Mutex> guard(mainQueueMutex);
-        mainJobs.clear();
+        for (Deque<MainJob>& queue : mainJobs)
+        {
+            queue.clear();
+        }
     }
-    mainJobLastExecutedID = mainJobIDCounter;
     mainJobIDCounter = 0;
     mainCV.NotifyAll();
 
@@ -53,63 +55,116 @@ void JobManager::Update(float32 /*frameDelta*/)
 {
     DAVA_PROFILER_CPU_SCOPE(ProfilerCPUMarkerName::JOB_MANAGER);
 
-    bool hasFinishedJobs = false;
+    int64 startTime = SystemTimer::GetUs();
+    uint32 executedJobs = 0;
+    bool budgetedJobExecuted = false;
 
     mainQueueMutex.Lock();
-    if (!mainJobs.empty())
+    for (;;)
     {
-        // extract all jobs from queue
-        while (!mainJobs.empty())
-        {
-            curMainJob = mainJobs.front();
-            mainJobs.pop_front();
+        int32 priority = SelectMainJobsQueue(SystemTimer::GetUs() - startTime, budgetedJobExecuted);
+        if (priority == -1)
+            break;
 
-            if (curMainJob.type == JOB_MAINBG)
-            {
-                // TODO:
-                // need implementation
-                // be careful with job ID, because waiting depends on id order
-                // ...
+        curMainJob = mainJobs[priority].front();
+        mainJobs[priority].pop_front();
 
-                DVASSERT(false);
-            }
-
-            if (curMainJob.invokerThreadId != Thread::Id() && curMainJob.fn != nullptr)
-            {
-                // unlock queue mutex until function execution finished
-                mainQueueMutex.Unlock();
-                curMainJob.fn();
-                mainJobLastExecutedID = curMainJob.id;
-                mainQueueMutex.Lock();
-            }
-
-            curMainJob = MainJob();
+        if (curMainJob.invokerThreadId != Thread::Id() && curMainJob.fn != nullptr)
+        {
+            // unlock queue mutex until function execution finished
+            mainQueueMutex.Unlock();
+            int64 jobStartTime = SystemTimer::GetUs();
+            curMainJob.fn();
+            float32 jobTime = static_cast<float32>(SystemTimer::GetUs() - jobStartTime) / 1000000.0f;
+            averageMainJobTime = (executedJobs == 0 && averageMainJobTime == 0.0f) ? jobTime : averageMainJobTime * 0.9f + jobTime * 0.1f;
+            mainQueueMutex.Lock();
         }
 
-        hasFinishedJobs = true;
+        budgetedJobExecuted = budgetedJobExecuted || (priority != JOB_PRIORITY_HIGH);
+        ++executedJobs;
+        curMainJob = MainJob();
+    }
+
+    uint32 queueDepth = 0;
+    for (const Deque<MainJob>& queue : mainJobs)
+    {
+        queueDepth += static_cast<uint32>(queue.size());
     }
     mainQueueMutex.Unlock();
 
+    mainJobsStats.queueDepth = queueDepth;
+    mainJobsStats.maxQueueDepth = Max(mainJobsStats.maxQueueDepth, queueDepth);
+    mainJobsStats.executedJobs = executedJobs;
+    mainJobsStats.executionTime = static_cast<float32>(SystemTimer::GetUs() - startTime) / 1000000.0f;
+    mainJobsStats.maxExecutionTime = Max(mainJobsStats.maxExecutionTime, mainJobsStats.executionTime);
+
     // signal that jobs are finished
-    if (hasFinishedJobs)
+    if (executedJobs > 0)
     {
         LockGuard<Mutex> cvguard(mainCVMutex);
         mainCV.NotifyAll();
     }
 }
 
+int32 JobManager::SelectMainJobsQueue(int64 elapsedUs, bool budgetedJobExecuted) const
+{
+    if (!mainJobs[JOB_PRIORITY_HIGH].empty())
+        return JOB_PRIORITY_HIGH;
+
+    int64 budgetUs = static_cast<int64>(mainJobsTimeBudget * 1000000.0f);
+    for (int32 priority = JOB_PRIORITY_NORMAL; priority < JOB_PRIORITY_COUNT; ++priority)
+    {
+        const Deque<MainJob>& queue = mainJobs[priority];
+        if (queue.empty())
+            continue;
+
+        if (budgetUs <= 0)
+            return priority;
+
+        // first job is executed anyway to guarantee progress, next ones only if they are expected to fit into budget
+        float32 cost = (queue.front().costHint > 0.0f) ? queue.front().costHint : averageMainJobTime;
+        bool fits = elapsedUs + static_cast<int64>(cost * 1000000.0f) <= budgetUs;
+        return (!budgetedJobExecuted || fits) ? priority : -1;
+    }
+
+    return -1;
+}
+
+void JobManager::PromoteMainJobs(const Function<bool(const MainJob&)>& predicate)
+{
+    Deque<MainJob>& highQueue = mainJobs[JOB_PRIORITY_HIGH];
+    for (int32 priority = JOB_PRIORITY_NORMAL; priority < JOB_PRIORITY_COUNT; ++priority)
+    {
+        // promote jobs together with all preceding jobs of the same priority to keep execution order
+        Deque<MainJob>& queue = mainJobs[priority];
+        auto last = std::find_if(queue.rbegin(), queue.rend(), predicate);
+        if (last != queue.rend())
+        {
+            auto end = last.base();
+            highQueue.insert(highQueue.end(), queue.begin(), end);
+            queue.erase(queue.begin(), end);
+        }
+    }
+}
+
+void JobManager::ResetMainJobsStats()
+{
+    mainJobsStats.maxQueueDepth = mainJobsStats.queueDepth;
+    mainJobsStats.maxExecutionTime = mainJobsStats.executionTime;
+}
+
 uint32 JobManager::GetWorkersCount() const
 {
     return static_cast<uint32>(workerThreads.size());
 }
 
-uint32 JobManager::CreateMainJob(const Function<void()>& fn, eMainJobType mainJobType)
+uint32 JobManager::CreateMainJob(const Function<void()>& fn, eMainJobType mainJobType, eMainJobPriority priority, float32 costHint)
 {
     uint32 jobID = 0;
 
     // if we are already in main thread and requested job shouldn't executed lazy
-    // perform that job immediately
-    if (Thread::IsMainThread() && mainJobType != JOB_MAINLAZY)
+    // perform that job immediately, job that can be run in any thread is performed immediately too
+    if ((Thread::IsMainThread() && mainJobType != JOB_MAINLAZY) || mainJobType == JOB_MAINBG)
     {
         fn();
     }
@@ -123,11 +178,13 @@ uint32 JobManager::CreateMainJob(const Function<void()>& fn, eMainJobType mainJo
         job.fn = fn;
         job.invokerThreadId = Thread::GetCurrentId();
         job.type = mainJobType;
+        job.priority = priority;
+        job.costHint = costHint;
         job.id = jobID;
 
         {
             LockGuard<Mutex> guard(mainQueueMutex);
-            mainJobs.push_back(job);
+            mainJobs[priority].push_back(job);
         }
     }
 
@@ -136,6 +193,16 @@ uint32 JobManager::CreateMainJob(const Function<void()>& fn, eMainJobType mainJo
 
 void JobManager::WaitMainJobs(Thread::Id invokerThreadId /* = 0 */)
 {
+    if (Thread::Id() == invokerThreadId)
+    {
+        invokerThreadId = Thread::GetCurrentId();
+    }
+
+    {
+        LockGuard<Mutex> guard(mainQueueMutex);
+        PromoteMainJobs([invokerThreadId](const MainJob& job) { return job.invokerThreadId == invokerThreadId; });
+    }
+
     if (Thread::IsMainThread())
     {
         // if wait was invoked from main-thread
@@ -143,7 +210,7 @@ void JobManager::WaitMainJobs(Thread::Id invokerThreadId /* = 0 */)
         // we should immediately execute them
         if (HasMainJobs(invokerThreadId))
         {
-            // just run update, it will execute all of main-thread jobs
+            // just run update, it will execute all of high priority main-thread jobs
             Update();
 
             // assert is something goes wrong
@@ -167,6 +234,11 @@ void JobManager::WaitMainJobs(Thread::Id invokerThreadId /* = 0 */)
 
 void JobManager::WaitMainJobID(uint32 mainJobID)
 {
+    {
+        LockGuard<Mutex> guard(mainQueueMutex);
+        PromoteMainJobs([mainJobID](const MainJob& job) { return job.id == mainJobID; });
+    }
+
     if (Thread::IsMainThread())
     {
         // if wait was invoked from main-thread
@@ -174,7 +246,7 @@ void JobManager::WaitMainJobID(uint32 mainJobID)
         // we should immediately execute them
         if (HasMainJobID(mainJobID))
         {
-            // just run update, it will execute all of main-thread jobs
+            // just run update, it will execute all of high priority main-thread jobs
             Update();
 
             // assert is something goes wrong
@@ -214,11 +286,10 @@ bool JobManager::HasMainJobs(Thread::Id invokerThreadId /* = 0 */)
         }
         else
         {
-            Deque<MainJob>::const_iterator i = mainJobs.begin();
-            Deque<MainJob>::const_iterator end = mainJobs.end();
-            for (; i != end; ++i)
+            for (const Deque<MainJob>& queue : mainJobs)
             {
-                if (i->invokerThreadId == invokerThreadId)
+                auto found = std::find_if(queue.begin(), queue.end(), [invokerThreadId](const MainJob& job) { return job.invokerThreadId == invokerThreadId; });
+                if (found != queue.end())
                 {
                     ret = true;
                     break;
@@ -232,7 +303,22 @@ bool JobManager::HasMainJobs(Thread::Id invokerThreadId /* = 0 */)
 
 bool JobManager::HasMainJobID(uint32 mainJobID)
 {
-    return (mainJobID > mainJobLastExecutedID);
+    // jobs are executed out of creation order, so queue is searched instead of comparing with last executed id
+    if (mainJobID == 0)
+        return false;
+
+    LockGuard<Mutex> guard(mainQueueMutex);
+    if (curMainJob.id == mainJobID)
+        return true;
+
+    for (const Deque<MainJob>& queue : mainJobs)
+    {
+        auto found = std::find_if(queue.begin(), queue.end(), [mainJobID](const MainJob& job) { return job.id == mainJobID; });
+        if (found != queue.end())
+            return true;
+    }
+
+    return false;
 }
 
 void JobManager::CreateWorkerJob(const Function<void()>& fn)
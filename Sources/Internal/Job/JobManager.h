@@ -20,30 +20,63 @@ public:
     {
         JOB_MAIN = 0, ///< Run only in the main thread. If job is created from the main thread, function will be run immediately.
         JOB_MAINLAZY, ///< Run only in the main thread. If job is created from the main thread, function will be run on next update.
-        JOB_MAINBG, ///< Run in the main or background thread. !!!!!!! TODO: isn't implemented yet
+        JOB_MAINBG, ///< Run in the main or background thread. Function is run immediately in the thread it was created from, which may be a worker thread, so use JOB_MAIN for functions that require the main thread.
+    };
+
+    /*! Priority of main-thread job. Jobs with the same priority are executed in creation order. */
+    enum eMainJobPriority
+    {
+        JOB_PRIORITY_HIGH = 0, ///< Always executed in the next update, regardless of time budget.
+        JOB_PRIORITY_NORMAL, ///< Executed while time budget of update allows, otherwise left for next updates.
+        JOB_PRIORITY_LOW, ///< Executed when there are no normal priority jobs and time budget allows.
+
+        JOB_PRIORITY_COUNT
+    };
+
+    /*! Telemetry of main-thread jobs execution. */
+    struct MainJobsStats
+    {
+        uint32 queueDepth = 0; ///< Number of main-thread jobs left in the queue after last update.
+        uint32 maxQueueDepth = 0; ///< Max `queueDepth` since last `ResetMainJobsStats`.
+        uint32 executedJobs = 0; ///< Number of main-thread jobs executed in last update.
+        float32 executionTime = 0.0f; ///< Time of main-thread jobs execution in last update, in seconds.
+        float32 maxExecutionTime = 0.0f; ///< Max `executionTime` since last `ResetMainJobsStats`.
     };
 
 public:
     JobManager(Engine* e);
     virtual ~JobManager();
 
-    /*! This function should be called periodically from the main thread. All main-thread jobs added to the queue
-        will be performed inside this function. 
+    /*! This function should be called periodically from the main thread. Main-thread jobs added to the queue
+        will be performed inside this function: all high priority jobs and other jobs while time budget allows
+        (see `SetMainJobsTimeBudget`). At least one normal or low priority job is executed on every update,
+        even if budget is exhausted by high priority jobs, so queue always makes progress.
     */
     void Update(float32 frameDelta = 0.0f);
 
     /*! Add function to execute in the main-thread.
 		\param [in] fn Function to execute.
 		\param [in] mainJobType Type of execution. See ::eMainJobType for detailed description.
+		\param [in] priority Priority of execution. See ::eMainJobPriority for detailed description.
+		\param [in] costHint Expected execution time in seconds, 0 if unknown. Average time of executed jobs is used for unknown cost.
         \return id Created job id. This id can be used to wait until this job finished.
 	*/
-    uint32 CreateMainJob(const Function<void()>& fn, eMainJobType mainJobType = JOB_MAIN);
+    uint32 CreateMainJob(const Function<void()>& fn, eMainJobType mainJobType = JOB_MAIN, eMainJobPriority priority = JOB_PRIORITY_NORMAL, float32 costHint = 0.0f);
+
+    /*! Set time in seconds that `Update` may spend on normal and low priority jobs. 0 means no limit. */
+    void SetMainJobsTimeBudget(float32 seconds);
+    float32 GetMainJobsTimeBudget() const;
+
+    const MainJobsStats& GetMainJobsStats() const;
+    void ResetMainJobsStats();
 
     /*! Wait for the main-thread jobs, that were added from other thread with the given ID. 
+        Waited jobs and jobs queued before them with the same priority are promoted to high priority.
 		\param [in] invokerThreadId Thread ID. By default it is 0, which means that current thread ID will be taken.
 	*/
     void WaitMainJobs(Thread::Id invokerThreadId = Thread::Id());
 
+    /*! Wait for the main-thread job with given ID. Job and jobs queued before it with the same priority are promoted to high priority. */
     void WaitMainJobID(uint32 mainJobID);
 
     /*! Check in there are some main-thread jobs in the queue, that were added from thread with the given ID.
@@ -76,29 +109,54 @@ protected:
         MainJob()
             : id(0)
             , type(JOB_MAIN)
+            , priority(JOB_PRIORITY_NORMAL)
             , invokerThreadId(Thread::Id())
         {
         }
 
         uint32 id;
         eMainJobType type;
+        eMainJobPriority priority;
+        float32 costHint = 0.0f;
         Thread::Id invokerThreadId;
 
         Function<void()> fn;
     };
 
+    // Both functions should be called with locked mainQueueMutex
+    int32 SelectMainJobsQueue(int64 elapsedUs, bool budgetedJobExecuted) const;
+    void PromoteMainJobs(const Function<bool(const MainJob&)>& predicate);
+
     Engine* engine = nullptr;
     Atomic<uint32> mainJobIDCounter;
-    uint32 mainJobLastExecutedID;
 
     Mutex mainQueueMutex;
     Mutex mainCVMutex;
-    Deque<MainJob> mainJobs;
+    std::array<Deque<MainJob>, JOB_PRIORITY_COUNT> mainJobs;
     ConditionVariable mainCV;
     MainJob curMainJob;
 
+    float32 mainJobsTimeBudget = 0.0f;
+    float32 averageMainJobTime = 0.0f;
+    MainJobsStats mainJobsStats;
+
     Semaphore workerDoneSem;
     JobQueueWorker workerQueue;
     Vector<JobThread*> workerThreads;
 };
+
+inline void JobManager::SetMainJobsTimeBudget(float32 seconds)
+{
+    mainJobsTimeBudget = seconds;
+}
+
+inline float32 JobManager::GetMainJobsTimeBudget() const
+{
+    return mainJobsTimeBudget;
+}
+
+inline const JobManager::MainJobsStats& JobManager::GetMainJobsStats() const
+{
+    return mainJobsStats;
+}
 }
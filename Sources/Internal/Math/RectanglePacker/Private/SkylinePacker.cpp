@@ -0,0 +1,130 @@
+#include "Math/RectanglePacker/SkylinePacker.h"
+
+namespace DAVA
+{
+SkylinePacker::SkylinePacker(int32 width, int32 height)
+{
+    Reset(width, height);
+}
+
+void SkylinePacker::Reset(int32 width_, int32 height_)
+{
+    width = width_;
+    height = height_;
+    occupiedArea = 0;
+
+    skyline.clear();
+    Node node;
+    node.width = width;
+    skyline.push_back(node);
+}
+
+bool SkylinePacker::Insert(int32 rectWidth, int32 rectHeight, Rect2i& result)
+{
+    if (rectWidth <= 0 || rectHeight <= 0)
+    {
+        return false;
+    }
+
+    size_t bestIndex = skyline.size();
+    int32 bestBottom = std::numeric_limits<int32>::max();
+    int32 bestWidth = std::numeric_limits<int32>::max();
+    int32 bestY = 0;
+
+    for (size_t i = 0; i < skyline.size(); ++i)
+    {
+        int32 y = Fit(i, rectWidth, rectHeight);
+        if (y >= 0)
+        {
+            int32 bottom = y + rectHeight;
+            if (bottom < bestBottom || (bottom == bestBottom && skyline[i].width < bestWidth))
+            {
+                bestIndex = i;
+                bestBottom = bottom;
+                bestWidth = skyline[i].width;
+                bestY = y;
+            }
+        }
+    }
+
+    if (bestIndex == skyline.size())
+    {
+        return false;
+    }
+
+    result = Rect2i(skyline[bestIndex].x, bestY, rectWidth, rectHeight);
+    AddSkylineLevel(bestIndex, result);
+    return true;
+}
+
+int32 SkylinePacker::Fit(size_t index, int32 rectWidth, int32 rectHeight) const
+{
+    if (skyline[index].x + rectWidth > width)
+    {
+        return -1;
+    }
+
+    int32 y = skyline[index].y;
+    int32 widthLeft = rectWidth;
+    for (size_t i = index; widthLeft > 0; ++i)
+    {
+        DVASSERT(i < skyline.size());
+        y = std::max(y, skyline[i].y);
+        if (y + rectHeight > height)
+        {
+            return -1;
+        }
+        widthLeft -= skyline[i].width;
+    }
+    return y;
+}
+
+void SkylinePacker::AddSkylineLevel(size_t index, const Rect2i& rect)
+{
+    Node node;
+    node.x = rect.x;
+    node.y = rect.y + rect.dy;
+    node.width = rect.dx;
+    skyline.insert(skyline.begin() + index, node);
+
+    // Cut nodes covered by new one
+    for (size_t i = index + 1; i < skyline.size();)
+    {
+        const Node& prev = skyline[i - 1];
+        int32 prevRight = prev.x + prev.width;
+        if (skyline[i].x >= prevRight)
+        {
+            break;
+        }
+
+        int32 shrink = prevRight - skyline[i].x;
+        skyline[i].x += shrink;
+        skyline[i].width -= shrink;
+        if (skyline[i].width > 0)
+        {
+            break;
+        }
+        skyline.erase(skyline.begin() + i);
+    }
+
+    // Merge neighbour nodes with same level
+    for (size_t i = 0; i + 1 < skyline.size();)
+    {
+        if (skyline[i].y == skyline[i + 1].y)
+        {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    occupiedArea = 0;
+    for (const Node& n : skyline)
+    {
+        occupiedArea += static_cast<uint64>(n.y) * static_cast<uint64>(n.width);
+    }
+}
+}
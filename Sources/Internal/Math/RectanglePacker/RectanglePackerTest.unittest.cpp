@@ -5,6 +5,7 @@
 #include "Concurrency/Thread.h"
 #include "Engine/EngineContext.h"
 #include "Job/JobManager.h"
+#include "Math/RectanglePacker/SkylinePacker.h"
 #include "Render/2D/Systems/DynamicAtlasSystem.h"
 #include "Render/Texture.h"
 #include "Render/TextureDescriptor.h"
@@ -26,6 +27,7 @@ DAVA_TESTCLASS (RectanglePackerTest)
     FIND_FILES_IN_TARGET(DavaFramework)
     DECLARE_COVERED_FILES("RectanglePacker.cpp")
     DECLARE_COVERED_FILES("Spritesheet.cpp")
+    DECLARE_COVERED_FILES("SkylinePacker.cpp")
     END_FILES_COVERED_BY_TESTS();
 
     DAVA_TEST (BasicTest)
@@ -136,4 +138,46 @@ DAVA_TESTCLASS (RectanglePackerTest)
         TEST_VERIFY(packResult->resultSheets.size() == 1);
         TEST_VERIFY(packResult->resultErrors.size() == 1);
     }
+
+    DAVA_TEST (SkylineTest)
+    {
+        SkylinePacker packer(128, 128);
+
+        Vector<Rect2i> rects;
+        Rect2i rect;
+        TEST_VERIFY(packer.Insert(64, 32, rect));
+        TEST_VERIFY(rect == Rect2i(0, 0, 64, 32));
+        rects.push_back(rect);
+        TEST_VERIFY(packer.Insert(64, 16, rect));
+        TEST_VERIFY(rect == Rect2i(64, 0, 64, 16));
+        rects.push_back(rect);
+        // lowest place is on the right half
+        TEST_VERIFY(packer.Insert(32, 32, rect));
+        TEST_VERIFY(rect == Rect2i(64, 16, 32, 32));
+        rects.push_back(rect);
+        TEST_VERIFY(packer.Insert(128, 64, rect));
+        TEST_VERIFY(rect == Rect2i(0, 48, 128, 64));
+        rects.push_back(rect);
+
+        TEST_VERIFY(packer.Insert(129, 1, rect) == false);
+        TEST_VERIFY(packer.Insert(16, 17, rect) == false);
+        TEST_VERIFY(packer.Insert(16, 16, rect));
+        rects.push_back(rect);
+
+        for (size_t i = 0; i < rects.size(); ++i)
+        {
+            TEST_VERIFY(rects[i].x >= 0 && rects[i].y >= 0 && rects[i].x + rects[i].dx <= 128 && rects[i].y + rects[i].dy <= 128);
+            for (size_t j = i + 1; j < rects.size(); ++j)
+            {
+                Rect2i intersection = rects[i].Intersection(rects[j]);
+                TEST_VERIFY(intersection.dx <= 0 || intersection.dy <= 0);
+            }
+        }
+        TEST_VERIFY(packer.GetOccupiedArea() == 128 * 112 + 16 * 16);
+
+        packer.Reset(64, 64);
+        TEST_VERIFY(packer.GetOccupiedArea() == 0);
+        TEST_VERIFY(packer.Insert(64, 64, rect));
+        TEST_VERIFY(rect == Rect2i(0, 0, 64, 64));
+    }
 };
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Base/BaseTypes.h"
+#include "Math/Math2D.h"
+
+namespace DAVA
+{
+/**
+    Online rectangle allocator based on skyline bottom-left heuristic.
+    Rectangles are placed one by one without knowing the whole set, so it fits for runtime atlases
+    which are filled incrementally. Space of removed rectangles is not reused, owner should
+    move live rectangles to another sheet and `Reset` packer when sheet becomes too sparse.
+*/
+class SkylinePacker final
+{
+public:
+    SkylinePacker(int32 width = 0, int32 height = 0);
+
+    /** Forget all placed rectangles and set new sheet size. */
+    void Reset(int32 width, int32 height);
+
+    /** Find place for rectangle with specified size. Returns false if rectangle doesn't fit into free space. */
+    bool Insert(int32 width, int32 height, Rect2i& result);
+
+    int32 GetWidth() const;
+    int32 GetHeight() const;
+
+    /** Area under the skyline, i.e. area that can't be used for new rectangles. */
+    uint64 GetOccupiedArea() const;
+
+private:
+    struct Node
+    {
+        int32 x = 0;
+        int32 y = 0;
+        int32 width = 0;
+    };
+
+    /** Returns top of rectangle placed at node `index` or -1 if it doesn't fit. */
+    int32 Fit(size_t index, int32 width, int32 height) const;
+    void AddSkylineLevel(size_t index, const Rect2i& rect);
+
+    Vector<Node> skyline;
+    int32 width = 0;
+    int32 height = 0;
+    uint64 occupiedArea = 0;
+};
+
+inline int32 SkylinePacker::GetWidth() const
+{
+    return width;
+}
+
+inline int32 SkylinePacker::GetHeight() const
+{
+    return height;
+}
+
+inline uint64 SkylinePacker::GetOccupiedArea() const
+{
+    return occupiedArea;
+}
+}
@@ -7,9 +7,7 @@ namespace DAVA
 namespace Net
 {
 ProtoDecoder::ProtoDecoder()
-    : totalDataSize(0)
-    , accumulatedSize(0)
-    , curFrameSize(0)
+    : curFrameSize(0)
 {
 }
 
@@ -68,34 +66,41 @@ size_t ProtoDecoder::EncodeControlFrame(ProtoHeader* header, uint32 type, uint32
         header->channelId = channelId;
         header->packetId = packetId;
         break;
+    case TYPE_HELLO:
+        header->packetId = packetId;
+        break;
     }
     return sizeof(ProtoHeader);
 }
 
 ProtoDecoder::eDecodeStatus ProtoDecoder::ProcessDataFrame(ProtoHeader* header, DecodeResult* result)
 {
-    if (0 == totalDataSize)
+    PacketAccum& accum = accums[header->channelId];
+    if (0 == accum.totalDataSize)
     {
-        accumulatedSize = 0;
-        totalDataSize = static_cast<size_t>(header->totalSize);
-        if (accum.size() < totalDataSize)
-            accum.resize(totalDataSize);
+        accum.accumulatedSize = 0;
+        accum.totalDataSize = static_cast<size_t>(header->totalSize);
+        if (accum.data.size() < accum.totalDataSize)
+            accum.data.resize(accum.totalDataSize);
     }
-    // TODO: maybe I should compare channel ID and packet ID with initial values
+    // TODO: maybe I should compare packet ID with initial value
     DVASSERT(curFrameSize >= sizeof(ProtoHeader));
     size_type packetSize = curFrameSize - sizeof(ProtoHeader);
-    DVASSERT(accum.size() >= accumulatedSize + packetSize);
-    Memcpy(&*accum.begin() + accumulatedSize, curFrame + sizeof(ProtoHeader), packetSize);
-    accumulatedSize += packetSize;
-    if (accumulatedSize == totalDataSize)
+    if (accum.data.size() < accum.accumulatedSize + packetSize)
+    {
+        return DECODE_INVALID;
+    }
+    Memcpy(&*accum.data.begin() + accum.accumulatedSize, curFrame + sizeof(ProtoHeader), packetSize);
+    accum.accumulatedSize += packetSize;
+    if (accum.accumulatedSize == accum.totalDataSize)
     {
         result->type = TYPE_DATA;
         result->channelId = header->channelId;
         result->packetId = header->packetId;
-        result->dataSize = totalDataSize;
-        result->data = &*accum.begin();
+        result->dataSize = accum.totalDataSize;
+        result->data = &*accum.data.begin();
 
-        totalDataSize = 0;
+        accum.totalDataSize = 0;
         return DECODE_OK;
     }
     return DECODE_INCOMPLETE;
@@ -123,6 +128,9 @@ ProtoDecoder::eDecodeStatus ProtoDecoder::ProcessControlFrame(ProtoHeader* heade
         result->channelId = header->channelId;
         result->packetId = header->packetId;
         break;
+    case TYPE_HELLO:
+        result->packetId = header->packetId;
+        break;
     }
     // Always return DECODE_OK as frame type has been checked while gathering header
     return DECODE_OK;
@@ -43,9 +43,15 @@ private:
     eDecodeStatus CheckHeader(const ProtoHeader* header) const;
 
 private:
-    size_t totalDataSize;
-    size_t accumulatedSize;
-    Vector<uint8> accum;
+    // Frames of packets sent to different channels can be interleaved, so packets are gathered per channel
+    struct PacketAccum
+    {
+        size_t totalDataSize = 0;
+        size_t accumulatedSize = 0;
+        Vector<uint8> data;
+    };
+
+    UnorderedMap<uint32, PacketAccum> accums;
 
     uint8 curFrame[PROTO_MAX_FRAME_SIZE];
     size_t curFrameSize;
@@ -2,8 +2,10 @@
 #include <Debug/DVAssert.h>
 #include <Concurrency/Atomic.h>
 #include <Concurrency/LockGuard.h>
+#include <Logger/Logger.h>
 
 #include <Network/Base/IOLoop.h>
+#include <Network/Base/NetworkUtils.h>
 #include <Network/ServiceRegistrar.h>
 
 #include <Network/Private/ProtoDriver.h>
@@ -20,11 +22,10 @@ ProtoDriver::ProtoDriver(IOLoop* aLoop, eNetworkRole aRole, const ServiceRegistr
     , registrar(aRegistrar)
     , serviceContext(aServiceContext)
     , transport(NULL)
-    , whatIsSending()
     , pendingPong(false)
 {
     DVASSERT(loop != NULL);
-    Memset(&curPacket, 0, sizeof(curPacket));
+    sentPackets.reserve(MAX_FRAMES_PER_SEND);
 }
 
 ProtoDriver::~ProtoDriver()
@@ -51,38 +52,36 @@ void ProtoDriver::SendData(uint32 channelId, const void* buffer, size_t length,
 {
     DVASSERT(transport != NULL && buffer != NULL && length > 0);
 
+    std::shared_ptr<Channel>& ch = GetChannel(channelId);
+    DVASSERT(ch != nullptr);
+
     Packet packet;
     PreparePacket(&packet, channelId, buffer, length);
     if (outPacketId != NULL)
         *outPacketId = packet.packetId;
 
-    // This method may be invoked from different threads
-    if (true == senderLock.TryLock())
+    // This method may be invoked from different threads, frames are sent from IOLoop's thread
+    bool needPost = false;
     {
-        // TODO: consider optimization when called from IOLoop's thread
-        curPacket = packet;
-        loop->Post(MakeFunction(this, &ProtoDriver::SendCurPacket));
+        LockGuard<Mutex> lock(queueMutex);
+        ch->sendQueue.push_back(packet);
+        needPost = !sendPosted;
+        sendPosted = true;
     }
-    else
+    if (needPost)
     {
-        EnqueuePacket(&packet);
+        // TODO: consider optimization when called from IOLoop's thread
+        loop->Post(MakeFunction(this, &ProtoDriver::OnSendPosted));
     }
 }
 
 void ProtoDriver::SendControl(uint32 code, uint32 channelId, uint32 packetId)
 {
+    // No need for mutex locking as control frames are always sent from handlers
     ProtoHeader header;
     proto.EncodeControlFrame(&header, code, channelId, packetId);
-    if (true == senderLock.TryLock()) // Control frame can be sent directly without queueing
-    {
-        curControl = header;
-        SendCurControl();
-    }
-    else
-    {
-        // No need for mutex locking as control frames are always sent from handlers
-        controlQueue.push_back(header);
-    }
+    controlQueue.push_back(header);
+    SendFrames();
 }
 
 void ProtoDriver::ReleaseServices()
@@ -99,6 +98,10 @@ void ProtoDriver::ReleaseServices()
 
 void ProtoDriver::OnConnected(const Endpoint& endp)
 {
+    isConnected = true;
+    isVersionChecked = false;
+    isSendFailed = false;
+    SendControl(TYPE_HELLO, 0, PROTO_VERSION);
     if (SERVER_ROLE == role)
     {
         // In SERVER_ROLE only setup remote endpoints
@@ -124,6 +127,7 @@ void ProtoDriver::OnConnected(const Endpoint& endp)
 
 void ProtoDriver::OnDisconnected(const char* message)
 {
+    isConnected = false;
     for (std::shared_ptr<Channel>& channel : channels)
     {
         if (channel->service != nullptr && true == channel->confirmed)
@@ -137,6 +141,11 @@ void ProtoDriver::OnDisconnected(const char* message)
 
 bool ProtoDriver::OnDataReceived(const void* buffer, size_t length)
 {
+    if (true == isSendFailed)
+    {
+        return false;
+    }
+
     bool canContinue = true;
     ProtoDecoder::DecodeResult result;
     ProtoDecoder::eDecodeStatus status = ProtoDecoder::DECODE_INVALID;
@@ -146,6 +155,12 @@ bool ProtoDriver::OnDataReceived(const void* buffer, size_t length)
         status = proto.Decode(buffer, length, &result);
         if (ProtoDecoder::DECODE_OK == status)
         {
+            if (false == isVersionChecked && result.type != TYPE_HELLO)
+            {
+                Logger::Error("[ProtoDriver] Frame received before protocol version, remote side uses incompatible protocol");
+                return false;
+            }
+
             switch (result.type)
             {
             case TYPE_DATA:
@@ -171,6 +186,9 @@ bool ProtoDriver::OnDataReceived(const void* buffer, size_t length)
             case TYPE_DELIVERY_ACK:
                 canContinue = ProcessDeliveryAck(&result);
                 break;
+            case TYPE_HELLO:
+                canContinue = ProcessHello(&result);
+                break;
             }
         }
         DVASSERT(length >= result.decodedSize);
@@ -183,33 +201,28 @@ bool ProtoDriver::OnDataReceived(const void* buffer, size_t length)
 
 void ProtoDriver::OnSendComplete()
 {
-    if (SENDING_DATA_FRAME == whatIsSending)
+    isSending = false;
+
+    // New packets sent from callbacks are posted to IOLoop, so sentPackets is not modified here
+    for (const SentPacket& packet : sentPackets)
     {
-        curPacket.sentLength += curPacket.chunkLength;
-        if (curPacket.sentLength == curPacket.dataLength)
+        std::shared_ptr<Channel>& ch = channels[packet.channelIndex];
+        if (ch->service != nullptr)
         {
-            std::shared_ptr<Channel> ch = GetChannel(curPacket.channelId);
-            ch->service->OnPacketSent(ch, curPacket.data, curPacket.dataLength);
-            curPacket.data = NULL;
+            ch->service->OnPacketSent(ch, packet.data, packet.dataLength);
         }
     }
+    sentPackets.clear();
 
-    if (true == DequeueControl(&curControl)) // First send control packets if any
-    {
-        SendCurControl();
-    }
-    else if (curPacket.data != NULL || true == DequeuePacket(&curPacket)) // Send current packet further or send new packet
-    {
-        SendCurPacket();
-    }
-    else
-    {
-        senderLock.Unlock(); // Nothing to send, unlock sender
-    }
+    SendFrames();
 }
 
 bool ProtoDriver::OnTimeout()
 {
+    if (true == isSendFailed)
+    {
+        return false;
+    }
     if (false == pendingPong)
     {
         pendingPong = true;
@@ -293,13 +306,14 @@ bool ProtoDriver::ProcessChannelDeny(ProtoDecoder::DecodeResult* result)
 
 bool ProtoDriver::ProcessDeliveryAck(ProtoDecoder::DecodeResult* result)
 {
+    // Packets of different channels are interleaved, so their confirmations are ordered only within channel
     std::shared_ptr<Channel> ch = GetChannel(result->channelId);
     DVASSERT(ch != NULL && ch->service != NULL);
-    DVASSERT(false == pendingAckQueue.empty());
-    if (ch != NULL && ch->service != NULL && false == pendingAckQueue.empty())
+    DVASSERT(ch == NULL || false == ch->pendingAckQueue.empty());
+    if (ch != NULL && ch->service != NULL && false == ch->pendingAckQueue.empty())
     {
-        uint32 pendingId = pendingAckQueue.front();
-        pendingAckQueue.pop_front();
+        uint32 pendingId = ch->pendingAckQueue.front();
+        ch->pendingAckQueue.pop_front();
         DVASSERT(pendingId == result->packetId);
         if (pendingId == result->packetId)
         {
@@ -310,49 +324,160 @@ bool ProtoDriver::ProcessDeliveryAck(ProtoDecoder::DecodeResult* result)
     return false;
 }
 
+bool ProtoDriver::ProcessHello(ProtoDecoder::DecodeResult* result)
+{
+    if (result->packetId != PROTO_VERSION)
+    {
+        Logger::Error("[ProtoDriver] Protocol version mismatch: local %u, remote %u", PROTO_VERSION, result->packetId);
+        return false;
+    }
+    isVersionChecked = true;
+    return true;
+}
+
 void ProtoDriver::ClearQueues()
 {
-    if (curPacket.data != NULL)
+    // Return to services packets which were passed to transport and packets which are still in queues
+    Vector<SentPacket> unsent;
+    unsent.swap(sentPackets);
     {
-        std::shared_ptr<Channel> ch = GetChannel(curPacket.channelId);
-        ch->service->OnPacketSent(ch, curPacket.data, curPacket.dataLength);
+        LockGuard<Mutex> lock(queueMutex);
+        for (size_t i = 0, n = channels.size(); i < n; ++i)
+        {
+            Channel* ch = channels[i].get();
+            for (const Packet& packet : ch->sendQueue)
+            {
+                unsent.push_back(SentPacket{ i, packet.data, packet.dataLength });
+            }
+            ch->sendQueue.clear();
+            ch->deficit = 0;
+            ch->pendingAckQueue.clear();
+        }
+    }
+    controlQueue.clear();
+    nextChannel = 0;
+    channelVisited = false;
+    isSending = false;
 
-        curPacket.data = NULL;
+    for (const SentPacket& packet : unsent)
+    {
+        std::shared_ptr<Channel>& ch = channels[packet.channelIndex];
+        if (ch->service != nullptr)
+        {
+            ch->service->OnPacketSent(ch, packet.data, packet.dataLength);
+        }
     }
-    for (Deque<Packet>::iterator i = dataQueue.begin(), e = dataQueue.end(); i != e; ++i)
+}
+
+void ProtoDriver::OnSendPosted()
+{
     {
-        Packet& packet = *i;
-        std::shared_ptr<Channel> ch = GetChannel(packet.channelId);
-        ch->service->OnPacketSent(ch, packet.data, packet.dataLength);
+        LockGuard<Mutex> lock(queueMutex);
+        sendPosted = false;
     }
-    dataQueue.clear();
-    pendingAckQueue.clear();
-    controlQueue.clear();
-    senderLock.Unlock();
+    SendFrames();
 }
 
-void ProtoDriver::SendCurPacket()
+void ProtoDriver::SendFrames()
 {
-    DVASSERT(curPacket.sentLength < curPacket.dataLength);
+    if (true == isSending || true == isSendFailed || false == isConnected)
+    {
+        return;
+    }
 
-    whatIsSending = SENDING_DATA_FRAME;
-    curPacket.chunkLength = proto.EncodeDataFrame(&header, curPacket.channelId, curPacket.packetId, curPacket.dataLength, curPacket.sentLength);
+    size_t frameCount = 0;
+    size_t bufferCount = 0;
+    size_t batchSize = 0;
 
-    Buffer buffers[2];
-    buffers[0] = CreateBuffer(&header);
-    buffers[1] = CreateBuffer(curPacket.data + curPacket.sentLength, curPacket.chunkLength);
-    if (0 == transport->Send(buffers, 2) && 0 == curPacket.sentLength)
+    // Control frames are small and go first
+    while (false == controlQueue.empty() && frameCount < MAX_FRAMES_PER_SEND)
     {
-        pendingAckQueue.push_back(curPacket.packetId);
+        sendHeaders[frameCount] = controlQueue.front();
+        controlQueue.pop_front();
+        sendBuffers[bufferCount++] = CreateBuffer(&sendHeaders[frameCount]);
+        batchSize += sizeof(ProtoHeader);
+        frameCount += 1;
+    }
+
+    {
+        LockGuard<Mutex> lock(queueMutex);
+        ScheduleDataFrames(frameCount, bufferCount, batchSize);
+    }
+
+    if (bufferCount > 0)
+    {
+        isSending = true;
+        int32 error = transport->Send(sendBuffers.data(), bufferCount);
+        if (error != 0)
+        {
+            // Frames are already taken from queues and OnSendComplete will not be called, so connection can't be used anymore
+            Logger::Error("[ProtoDriver] Failed to send frames: %s", ErrorToString(error));
+            isSending = false;
+            isSendFailed = true;
+        }
     }
 }
 
-void ProtoDriver::SendCurControl()
+void ProtoDriver::ScheduleDataFrames(size_t& frameCount, size_t& bufferCount, size_t& batchSize)
 {
-    whatIsSending = SENDING_CONTROL_FRAME;
+    // Deficit round-robin: on each visit channel gets CHANNEL_QUANTUM bytes of credit and sends frames while
+    // credit allows. Visit is continued in next write operation if send window is exhausted.
+    size_t idleChannels = 0;
+    while (frameCount < MAX_FRAMES_PER_SEND && idleChannels < channels.size())
+    {
+        Channel* ch = channels[nextChannel].get();
+        if (ch->sendQueue.empty())
+        {
+            ch->deficit = 0;
+            idleChannels += 1;
+            NextChannel();
+            continue;
+        }
+
+        idleChannels = 0;
+        if (false == channelVisited)
+        {
+            ch->deficit += CHANNEL_QUANTUM;
+            channelVisited = true;
+        }
+
+        Packet& packet = ch->sendQueue.front();
+        size_t frameDataSize = Min(packet.dataLength - packet.sentLength, PROTO_MAX_FRAME_DATA_SIZE);
+        if (frameDataSize > ch->deficit)
+        {
+            NextChannel();
+            continue;
+        }
+        if (frameCount > 0 && batchSize + sizeof(ProtoHeader) + frameDataSize > SEND_WINDOW_SIZE)
+        {
+            break;
+        }
+
+        ProtoHeader* header = &sendHeaders[frameCount];
+        proto.EncodeDataFrame(header, packet.channelId, packet.packetId, packet.dataLength, packet.sentLength);
+        sendBuffers[bufferCount++] = CreateBuffer(header);
+        sendBuffers[bufferCount++] = CreateBuffer(packet.data + packet.sentLength, frameDataSize);
+        batchSize += sizeof(ProtoHeader) + frameDataSize;
+        frameCount += 1;
+        ch->deficit -= frameDataSize;
+
+        if (0 == packet.sentLength)
+        {
+            ch->pendingAckQueue.push_back(packet.packetId);
+        }
+        packet.sentLength += frameDataSize;
+        if (packet.sentLength == packet.dataLength)
+        {
+            sentPackets.push_back(SentPacket{ nextChannel, packet.data, packet.dataLength });
+            ch->sendQueue.pop_front();
+        }
+    }
+}
 
-    Buffer buffer = CreateBuffer(&curControl);
-    transport->Send(&buffer, 1);
+void ProtoDriver::NextChannel()
+{
+    nextChannel = (nextChannel + 1) % channels.size();
+    channelVisited = false;
 }
 
 void ProtoDriver::PreparePacket(Packet* packet, uint32 channelId, const void* buffer, size_t length)
@@ -365,43 +490,8 @@ void ProtoDriver::PreparePacket(Packet* packet, uint32 channelId, const void* bu
     packet->packetId = ++nextPacketId;
     packet->dataLength = length;
     packet->sentLength = 0;
-    packet->chunkLength = 0;
     packet->data = static_cast<uint8*>(const_cast<void*>(buffer));
 }
 
-bool ProtoDriver::EnqueuePacket(Packet* packet)
-{
-    bool queueWasEmpty = false;
-
-    LockGuard<Mutex> lock(queueMutex);
-    queueWasEmpty = dataQueue.empty();
-    dataQueue.push_back(*packet);
-    return queueWasEmpty;
-}
-
-bool ProtoDriver::DequeuePacket(Packet* dest)
-{
-    LockGuard<Mutex> lock(queueMutex);
-    if (false == dataQueue.empty())
-    {
-        *dest = dataQueue.front();
-        dataQueue.pop_front();
-        return true;
-    }
-    return false;
-}
-
-bool ProtoDriver::DequeueControl(ProtoHeader* dest)
-{
-    // No need for mutex locking as control packets are always dequeued from handler
-    if (false == controlQueue.empty())
-    {
-        *dest = controlQueue.front();
-        controlQueue.pop_front();
-        return true;
-    }
-    return false;
-}
-
 } // namespace Net
 } // namespace DAVA
@@ -1,9 +1,9 @@
 #ifndef __DAVAENGINE_PROTODRIVER_H__
 #define __DAVAENGINE_PROTODRIVER_H__
 
+#include <Base/Array.h>
 #include <Base/BaseTypes.h>
 #include <Concurrency/Mutex.h>
-#include <Concurrency/Spinlock.h>
 
 #include <Network/Base/Endpoint.h>
 #include <Network/NetworkCommon.h>
@@ -19,8 +19,29 @@ namespace Net
 class IOLoop;
 class ServiceRegistrar;
 
+/*
+ ProtoDriver multiplexes channels over one transport connection.
+
+ Outgoing data packets are kept in per-channel queues and split into frames of up to PROTO_MAX_FRAME_SIZE bytes.
+ Channels are served by deficit round-robin, so frames of different channels are interleaved and small packets
+ do not wait until big packet of other channel is transferred. Control frames are sent before data frames.
+ Several frames, up to SEND_WINDOW_SIZE bytes, are passed to transport in one write operation.
+ Packets of the same channel are sent and confirmed in order of SendData calls.
+
+ First frame sent by each side is TYPE_HELLO with PROTO_VERSION. Connection is reset if other side sends
+ different version or any other frame before TYPE_HELLO (e.g. peer built before versioning was introduced).
+ If transport fails to start write operation, driver stops sending and asks for connection reset
+ from next OnDataReceived or OnTimeout call; unsent packets are returned to services on disconnection.
+*/
 class ProtoDriver
 {
+    // Maximum number of bytes passed to transport in one write operation
+    static const size_t SEND_WINDOW_SIZE = 256 * 1024;
+    // Maximum number of frames passed to transport in one write operation, each frame takes two buffers
+    static const size_t MAX_FRAMES_PER_SEND = 32;
+    // Number of bytes channel is allowed to send on each round of deficit round-robin
+    static const size_t CHANNEL_QUANTUM = 16 * 1024;
+
 private:
     struct Packet
     {
@@ -28,8 +49,14 @@ private:
         uint32 packetId;
         uint8* data = nullptr; // Data
         size_t dataLength; //  and its length
-        size_t sentLength; // Number of bytes that have been already transfered
-        size_t chunkLength; // Number of bytes transfered during last operation
+        size_t sentLength; // Number of bytes that have been already passed to transport
+    };
+
+    struct SentPacket
+    {
+        size_t channelIndex;
+        uint8* data;
+        size_t dataLength;
     };
 
     struct Channel : public IChannel
@@ -45,12 +72,10 @@ private:
         Endpoint remoteEndpoint;
         ProtoDriver* driver = nullptr;
         IChannelListener* service = nullptr;
-    };
 
-    enum eSendingFrameType
-    {
-        SENDING_DATA_FRAME = false,
-        SENDING_CONTROL_FRAME = true
+        Deque<Packet> sendQueue; // Guarded by queueMutex
+        size_t deficit = 0; // Bytes channel can send in current round
+        Deque<uint32> pendingAckQueue; // Packets waiting for delivery confirmation
     };
 
 public:
@@ -77,16 +102,16 @@ private:
     bool ProcessChannelAllow(ProtoDecoder::DecodeResult* result);
     bool ProcessChannelDeny(ProtoDecoder::DecodeResult* result);
     bool ProcessDeliveryAck(ProtoDecoder::DecodeResult* result);
+    bool ProcessHello(ProtoDecoder::DecodeResult* result);
 
     void ClearQueues();
 
-    void SendCurPacket();
-    void SendCurControl();
+    void OnSendPosted();
+    void SendFrames();
+    void ScheduleDataFrames(size_t& frameCount, size_t& bufferCount, size_t& batchSize);
+    void NextChannel();
 
     void PreparePacket(Packet* packet, uint32 channelId, const void* buffer, size_t length);
-    bool EnqueuePacket(Packet* packet);
-    bool DequeuePacket(Packet* dest);
-    bool DequeueControl(ProtoHeader* dest);
 
 private:
     IOLoop* loop = nullptr;
@@ -96,20 +121,25 @@ private:
     IClientTransport* transport = nullptr;
     Vector<std::shared_ptr<Channel>> channels;
 
-    Spinlock senderLock;
     Mutex queueMutex;
-    eSendingFrameType whatIsSending;
+    bool sendPosted = false; // Guarded by queueMutex
+    bool isConnected = false;
+    bool isVersionChecked = false; // Other side has sent TYPE_HELLO with matching protocol version
+    bool isSending = false; // Transport write operation is in progress
+    bool isSendFailed = false; // Transport failed to start write operation, connection should be reset
     bool pendingPong;
 
-    Packet curPacket;
-    Deque<Packet> dataQueue;
-    Deque<uint32> pendingAckQueue;
+    size_t nextChannel = 0; // Channel visited by deficit round-robin
+    bool channelVisited = false; // Quantum has been added to channel's deficit in current visit
 
-    ProtoHeader curControl;
     Deque<ProtoHeader> controlQueue;
 
+    // Frames and packets of current write operation
+    Array<ProtoHeader, MAX_FRAMES_PER_SEND> sendHeaders;
+    Array<Buffer, MAX_FRAMES_PER_SEND * 2> sendBuffers;
+    Vector<SentPacket> sentPackets;
+
     ProtoDecoder proto;
-    ProtoHeader header;
 };
 
 //////////////////////////////////////////////////////////////////////////
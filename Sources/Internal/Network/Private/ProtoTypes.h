@@ -18,6 +18,11 @@ struct ProtoHeader
     uint32 totalSize = 0; // Total size of user data
 };
 
+// Version of wire format, peers exchange it in TYPE_HELLO frame on connection and disconnect if it differs.
+// Increment on every incompatible change of frame layout or frame ordering rules.
+// Version 2: frames of different channels are interleaved
+const uint32 PROTO_VERSION = 2;
+
 const size_t PROTO_MAX_FRAME_SIZE = 1024 * 64 - 1;
 const size_t PROTO_MAX_FRAME_DATA_SIZE = PROTO_MAX_FRAME_SIZE - sizeof(ProtoHeader);
 
@@ -30,10 +35,11 @@ enum eProtoFrameType
     TYPE_PING, // Control frame: keep-alive request
     TYPE_PONG, // Control frame: answer to PING frame
     TYPE_DELIVERY_ACK, // Control frame: user data packet delivered
+    TYPE_HELLO, // Control frame: first frame sent by each side, packetId field holds PROTO_VERSION
 
     TYPE_FIRST = TYPE_DATA,
     TYPE_CONTROL_FIRST = TYPE_CHANNEL_QUERY,
-    TYPE_LAST = TYPE_DELIVERY_ACK
+    TYPE_LAST = TYPE_HELLO
 };
 
 enum eProtoFrameFlags
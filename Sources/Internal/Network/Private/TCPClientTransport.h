@@ -63,7 +63,8 @@ private:
     static const size_t INBUF_SIZE = 10 * 1024;
     uint8 inbuf[INBUF_SIZE];
 
-    static const size_t SENDBUF_COUNT = 2;
+    // ProtoDriver passes several frames in one write operation, two buffers per frame
+    static const size_t SENDBUF_COUNT = 64;
     Buffer sendBuffers[SENDBUF_COUNT];
     size_t sendBufferCount;
 };
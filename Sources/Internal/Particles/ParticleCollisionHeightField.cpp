@@ -0,0 +1,250 @@
+#include "Particles/ParticleCollisionHeightField.h"
+
+#include "Render/3D/PolygonGroup.h"
+
+#include <limits>
+
+namespace DAVA
+{
+namespace ParticleCollisionHeightFieldDetails
+{
+const float32 EMPTY_CELL = std::numeric_limits<float32>::lowest();
+const float32 BARYCENTRIC_TOLERANCE = 1e-4f;
+}
+
+void ParticleCollisionHeightField::SetLandscape(Heightmap* heightmap_, const AABBox3& bbox)
+{
+    heightmap = RefPtr<Heightmap>::ConstructWithRetain(heightmap_);
+    landscapeBox = bbox;
+    if (heightmap_ == nullptr || heightmap_->Size() == 0)
+    {
+        heightmap = nullptr;
+        return;
+    }
+
+    float32 size = static_cast<float32>(heightmap_->Size());
+    Vector3 extents = bbox.max - bbox.min;
+    heightmapScale.x = (extents.x > 0.0f) ? size / extents.x : 0.0f;
+    heightmapScale.y = (extents.y > 0.0f) ? size / extents.y : 0.0f;
+    heightScale = extents.z / static_cast<float32>(Heightmap::MAX_VALUE);
+}
+
+void ParticleCollisionHeightField::ResetStaticGeometry(const AABBox3& area, float32 cellSize)
+{
+    using namespace ParticleCollisionHeightFieldDetails;
+
+    staticArea = area;
+    staticCellSize = std::max(cellSize, 0.01f);
+    staticWidth = std::max(static_cast<int32>(std::ceil((area.max.x - area.min.x) / staticCellSize)), 1);
+    staticHeight = std::max(static_cast<int32>(std::ceil((area.max.y - area.min.y) / staticCellSize)), 1);
+    staticSpans.assign(staticWidth * staticHeight, StaticSpan{ EMPTY_CELL, EMPTY_CELL });
+    staticCellsFilled = 0;
+}
+
+void ParticleCollisionHeightField::AddStaticTriangle(const Vector3& a, const Vector3& b, const Vector3& c)
+{
+    using namespace ParticleCollisionHeightFieldDetails;
+
+    if (staticSpans.empty())
+        return;
+
+    auto splat = [this](int32 cx, int32 cy, float32 z) {
+        StaticSpan& cell = staticSpans[cx + cy * staticWidth];
+        if (cell.top == EMPTY_CELL)
+        {
+            ++staticCellsFilled;
+            cell.bottom = z;
+            cell.top = z;
+        }
+        else
+        {
+            cell.bottom = std::min(cell.bottom, z);
+            cell.top = std::max(cell.top, z);
+        }
+    };
+
+    // Vertices are splatted as is, so triangles smaller than a cell and vertical walls still mark their cells.
+    for (const Vector3* v : { &a, &b, &c })
+    {
+        int32 cx, cy;
+        if (GetStaticCell(v->x, v->y, cx, cy))
+            splat(cx, cy, v->z);
+    }
+
+    float32 denominator = (b.y - c.y) * (a.x - c.x) + (c.x - b.x) * (a.y - c.y);
+    if (Abs(denominator) < EPSILON)
+        return;
+
+    float32 invDenominator = 1.0f / denominator;
+    int32 minX = Clamp(static_cast<int32>(std::floor((Min(Min(a.x, b.x), c.x) - staticArea.min.x) / staticCellSize)), 0, staticWidth - 1);
+    int32 maxX = Clamp(static_cast<int32>(std::floor((Max(Max(a.x, b.x), c.x) - staticArea.min.x) / staticCellSize)), 0, staticWidth - 1);
+    int32 minY = Clamp(static_cast<int32>(std::floor((Min(Min(a.y, b.y), c.y) - staticArea.min.y) / staticCellSize)), 0, staticHeight - 1);
+    int32 maxY = Clamp(static_cast<int32>(std::floor((Max(Max(a.y, b.y), c.y) - staticArea.min.y) / staticCellSize)), 0, staticHeight - 1);
+
+    for (int32 cy = minY; cy <= maxY; ++cy)
+    {
+        float32 y = staticArea.min.y + (static_cast<float32>(cy) + 0.5f) * staticCellSize;
+        for (int32 cx = minX; cx <= maxX; ++cx)
+        {
+            float32 x = staticArea.min.x + (static_cast<float32>(cx) + 0.5f) * staticCellSize;
+            float32 wa = ((b.y - c.y) * (x - c.x) + (c.x - b.x) * (y - c.y)) * invDenominator;
+            float32 wb = ((c.y - a.y) * (x - c.x) + (a.x - c.x) * (y - c.y)) * invDenominator;
+            float32 wc = 1.0f - wa - wb;
+            if (wa >= -BARYCENTRIC_TOLERANCE && wb >= -BARYCENTRIC_TOLERANCE && wc >= -BARYCENTRIC_TOLERANCE)
+            {
+                splat(cx, cy, wa * a.z + wb * b.z + wc * c.z);
+            }
+        }
+    }
+}
+
+void ParticleCollisionHeightField::AddStaticGeometry(PolygonGroup* polygonGroup, const Matrix4& worldTransform)
+{
+    if (polygonGroup->vertexArray == nullptr || polygonGroup->indexArray == nullptr || polygonGroup->GetPrimitiveType() != rhi::PRIMITIVE_TRIANGLELIST)
+    {
+        // Geometry data is released after upload, only bounds are left.
+        AABBox3 worldBox;
+        polygonGroup->GetBoundingBox().GetTransformedBox(worldTransform, worldBox);
+        AddStaticBox(worldBox);
+        return;
+    }
+
+    int32 indexCount = polygonGroup->GetIndexCount();
+    for (int32 i = 0; i + 2 < indexCount; i += 3)
+    {
+        uint16 indices[3];
+        polygonGroup->GetTriangleIndices(i, indices);
+
+        Vector3 v[3];
+        for (int32 k = 0; k < 3; ++k)
+        {
+            polygonGroup->GetCoord(indices[k], v[k]);
+            v[k] = v[k] * worldTransform;
+        }
+        AddStaticTriangle(v[0], v[1], v[2]);
+    }
+}
+
+void ParticleCollisionHeightField::AddStaticBox(const AABBox3& box)
+{
+    // Top and bottom faces, so cells get full vertical span of the box.
+    for (float32 z : { box.max.z, box.min.z })
+    {
+        Vector3 a(box.min.x, box.min.y, z);
+        Vector3 b(box.max.x, box.min.y, z);
+        Vector3 c(box.max.x, box.max.y, z);
+        Vector3 d(box.min.x, box.max.y, z);
+        AddStaticTriangle(a, b, c);
+        AddStaticTriangle(a, c, d);
+    }
+}
+
+bool ParticleCollisionHeightField::GetSurface(float32 x, float32 y, float32 fromHeight, Surface& surface, bool withLandscape, bool withStaticGeometry) const
+{
+    float32 landscapeHeight = 0.0f;
+    float32 staticHeight = 0.0f;
+    float32 staticBottom = 0.0f;
+    bool hasLandscape = withLandscape && GetLandscapeHeight(x, y, landscapeHeight);
+    bool hasStatic = withStaticGeometry && GetStaticHeight(x, y, staticHeight, nullptr, &staticBottom) && fromHeight >= staticBottom;
+
+    if (hasStatic && (!hasLandscape || staticHeight > landscapeHeight))
+    {
+        surface.isStaticGeometry = true;
+        return GetStaticHeight(x, y, surface.height, &surface.normal);
+    }
+
+    surface.isStaticGeometry = false;
+    return hasLandscape && GetLandscapeHeight(x, y, surface.height, &surface.normal);
+}
+
+bool ParticleCollisionHeightField::GetLandscapeHeight(float32 x, float32 y, float32& height, Vector3* normal) const
+{
+    if (heightmap.Get() == nullptr || x < landscapeBox.min.x || x > landscapeBox.max.x || y < landscapeBox.min.y || y > landscapeBox.max.y)
+        return false;
+
+    // Same sampling as Landscape::GetHeightAtPoint, but without per-call validation and Vector3 construction.
+    int32 size = heightmap->Size();
+    const uint16* data = heightmap->Data();
+
+    float32 fx = (x - landscapeBox.min.x) * heightmapScale.x;
+    float32 fy = (y - landscapeBox.min.y) * heightmapScale.y;
+    int32 x0 = std::min(static_cast<int32>(fx), size - 1);
+    int32 y0 = std::min(static_cast<int32>(fy), size - 1);
+    int32 x1 = std::min(x0 + 1, size - 1);
+    int32 y1 = std::min(y0 + 1, size - 1);
+
+    float32 h00 = static_cast<float32>(data[x0 + y0 * size]);
+    float32 h01 = static_cast<float32>(data[x1 + y0 * size]);
+    float32 h10 = static_cast<float32>(data[x0 + y1 * size]);
+    float32 h11 = static_cast<float32>(data[x1 + y1 * size]);
+
+    float32 dx = fx - static_cast<float32>(x0);
+    float32 dy = fy - static_cast<float32>(y0);
+    float32 h0 = h00 + (h01 - h00) * dx;
+    float32 h1 = h10 + (h11 - h10) * dx;
+    height = landscapeBox.min.z + (h0 + (h1 - h0) * dy) * heightScale;
+
+    if (normal != nullptr)
+    {
+        float32 dhdx = ((h01 - h00) * (1.0f - dy) + (h11 - h10) * dy) * heightScale * heightmapScale.x;
+        float32 dhdy = (h1 - h0) * heightScale * heightmapScale.y;
+        *normal = Normalize(Vector3(-dhdx, -dhdy, 1.0f));
+    }
+
+    return true;
+}
+
+bool ParticleCollisionHeightField::GetStaticHeight(float32 x, float32 y, float32& height, Vector3* normal, float32* bottom) const
+{
+    using namespace ParticleCollisionHeightFieldDetails;
+
+    int32 cx, cy;
+    if (staticCellsFilled == 0 || !GetStaticCell(x, y, cx, cy))
+        return false;
+
+    const StaticSpan& span = staticSpans[cx + cy * staticWidth];
+    if (span.top == EMPTY_CELL)
+        return false;
+
+    height = span.top;
+    if (bottom != nullptr)
+    {
+        *bottom = span.bottom;
+    }
+
+    if (normal != nullptr)
+    {
+        // Central differences over neighbour cells, empty cells are treated as flat continuation.
+        float32 left = GetStaticCellHeight(cx - 1, cy, height);
+        float32 right = GetStaticCellHeight(cx + 1, cy, height);
+        float32 bottom = GetStaticCellHeight(cx, cy - 1, height);
+        float32 top = GetStaticCellHeight(cx, cy + 1, height);
+        float32 dhdx = Clamp((right - left) / (2.0f * staticCellSize), -1.0f, 1.0f);
+        float32 dhdy = Clamp((top - bottom) / (2.0f * staticCellSize), -1.0f, 1.0f);
+        *normal = Normalize(Vector3(-dhdx, -dhdy, 1.0f));
+    }
+
+    return true;
+}
+
+bool ParticleCollisionHeightField::GetStaticCell(float32 x, float32 y, int32& cx, int32& cy) const
+{
+    if (x < staticArea.min.x || y < staticArea.min.y)
+        return false;
+
+    cx = static_cast<int32>((x - staticArea.min.x) / staticCellSize);
+    cy = static_cast<int32>((y - staticArea.min.y) / staticCellSize);
+    return cx < staticWidth && cy < staticHeight;
+}
+
+float32 ParticleCollisionHeightField::GetStaticCellHeight(int32 cx, int32 cy, float32 fallback) const
+{
+    using namespace ParticleCollisionHeightFieldDetails;
+
+    if (cx < 0 || cy < 0 || cx >= staticWidth || cy >= staticHeight)
+        return fallback;
+
+    float32 h = staticSpans[cx + cy * staticWidth].top;
+    return (h == EMPTY_CELL) ? fallback : h;
+}
+}
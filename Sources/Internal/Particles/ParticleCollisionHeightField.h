@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Base/BaseObject.h"
+#include "Base/BaseTypes.h"
+#include "Base/RefPtr.h"
+#include "Math/AABBox3.h"
+#include "Math/Matrix4.h"
+#include "Math/Vector.h"
+#include "Render/Highlevel/Heightmap.h"
+
+namespace DAVA
+{
+class PolygonGroup;
+
+/**
+    Cheap collision proxy for particles: landscape heightmap plus coarse height grid of static geometry.
+
+    Landscape is sampled directly from heightmap data with bilinear filtering. Static geometry is rasterized
+    into regular XY grid of `cellSize` cells over `area`, each cell keeps vertical span (lowest and highest point)
+    of geometry covering it. Span is solid only for points that come from above its bottom, so particles flying
+    under overhangs (bridges, roofs, tree crowns) are not pushed up on top of them.
+    Queries are read-only and may be issued from several threads at once.
+*/
+class ParticleCollisionHeightField : public BaseObject
+{
+public:
+    struct Surface
+    {
+        float32 height = 0.0f;
+        Vector3 normal = Vector3(0.0f, 0.0f, 1.0f);
+        bool isStaticGeometry = false;
+    };
+
+    ParticleCollisionHeightField() = default;
+
+    void SetLandscape(Heightmap* heightmap, const AABBox3& bbox);
+    bool HasLandscape() const;
+
+    /** Clears static geometry grid and allocates it for `area`. */
+    void ResetStaticGeometry(const AABBox3& area, float32 cellSize);
+    void AddStaticTriangle(const Vector3& a, const Vector3& b, const Vector3& c);
+    void AddStaticGeometry(PolygonGroup* polygonGroup, const Matrix4& worldTransform);
+    void AddStaticBox(const AABBox3& box);
+
+    const AABBox3& GetStaticArea() const;
+    float32 GetStaticCellSize() const;
+    bool HasStaticArea() const;
+    bool HasStaticGeometry() const;
+
+    /**
+        Returns false if there is no collision surface below or above point (x, y).
+        Static geometry spans with bottom above `fromHeight` (e.g. particle's previous height) are ignored.
+    */
+    bool GetSurface(float32 x, float32 y, float32 fromHeight, Surface& surface, bool withLandscape = true, bool withStaticGeometry = true) const;
+    bool GetLandscapeHeight(float32 x, float32 y, float32& height, Vector3* normal = nullptr) const;
+    /** Returns top of static geometry span at (x, y) in `height` and its bottom in `bottom` if it is not nullptr. */
+    bool GetStaticHeight(float32 x, float32 y, float32& height, Vector3* normal = nullptr, float32* bottom = nullptr) const;
+
+private:
+    struct StaticSpan
+    {
+        float32 bottom;
+        float32 top;
+    };
+
+    bool GetStaticCell(float32 x, float32 y, int32& cx, int32& cy) const;
+    float32 GetStaticCellHeight(int32 cx, int32 cy, float32 fallback) const;
+
+    RefPtr<Heightmap> heightmap;
+    AABBox3 landscapeBox;
+    Vector2 heightmapScale; // heightmap cells per unit
+    float32 heightScale = 0.0f;
+
+    AABBox3 staticArea;
+    float32 staticCellSize = 1.0f;
+    int32 staticWidth = 0;
+    int32 staticHeight = 0;
+    uint32 staticCellsFilled = 0;
+    Vector<StaticSpan> staticSpans;
+};
+
+inline bool ParticleCollisionHeightField::HasLandscape() const
+{
+    return heightmap.Get() != nullptr;
+}
+
+inline const AABBox3& ParticleCollisionHeightField::GetStaticArea() const
+{
+    return staticArea;
+}
+
+inline float32 ParticleCollisionHeightField::GetStaticCellSize() const
+{
+    return staticCellSize;
+}
+
+inline bool ParticleCollisionHeightField::HasStaticArea() const
+{
+    return !staticSpans.empty();
+}
+
+inline bool ParticleCollisionHeightField::HasStaticGeometry() const
+{
+    return staticCellsFilled > 0;
+}
+}
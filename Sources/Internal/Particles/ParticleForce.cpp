@@ -59,6 +59,13 @@ ParticleForce* ParticleForce::Clone()
     dst->pointGravityRadius = pointGravityRadius;
     dst->planeScale = planeScale;
     dst->reflectionChaos = reflectionChaos;
+    dst->collisionResponse = collisionResponse;
+    dst->collisionBounciness = collisionBounciness;
+    dst->collisionFriction = collisionFriction;
+    dst->collisionAreaSize = collisionAreaSize;
+    dst->collisionCellSize = collisionCellSize;
+    dst->collideWithLandscape = collideWithLandscape;
+    dst->collideWithStaticGeometry = collideWithStaticGeometry;
 
     dst->startTime = startTime;
     dst->endTime = endTime;
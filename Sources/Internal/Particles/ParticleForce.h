@@ -36,9 +36,17 @@ public:
         VORTEX,
         GRAVITY,
         POINT_GRAVITY,
-        PLANE_COLLISION
+        PLANE_COLLISION,
+        SCENE_COLLISION // Resolved by ParticleEffectSystem against landscape and static geometry.
     } type = eType::DRAG_FORCE;
 
+    enum class eCollisionResponse : uint8
+    {
+        BOUNCE,
+        STICK,
+        KILL
+    } collisionResponse = eCollisionResponse::BOUNCE;
+
     RefPtr<PropertyLine<Vector3>> forcePowerLine;
     RefPtr<PropertyLine<float32>> turbulenceLine;
 
@@ -61,6 +69,10 @@ public:
     float32 velocityThreshold = 0.3f;
     float32 startTime = 0.0f;
     float32 endTime = 15.0f;
+    float32 collisionBounciness = 0.5f; // Part of normal speed kept after bounce.
+    float32 collisionFriction = 0.2f; // Part of tangential speed lost on bounce.
+    float32 collisionAreaSize = 50.0f; // Size of static geometry height grid around effect.
+    float32 collisionCellSize = 1.0f;
 
     uint32 backwardTurbulenceProbability = 0;
     uint32 reflectionPercent = 100;
@@ -74,6 +86,8 @@ public:
     bool normalAsReflectionVector = true;
     bool randomizeReflectionForce = false;
     bool worldAlign = true;
+    bool collideWithLandscape = true;
+    bool collideWithStaticGeometry = false;
 
 public:
     ParticleForce(ParticleLayer* parent);
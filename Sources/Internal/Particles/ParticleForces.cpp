@@ -4,6 +4,7 @@
 #include <chrono>
 
 #include "Particles/Particle.h"
+#include "Particles/ParticleCollisionHeightField.h"
 #include "Particles/ParticleForce.h"
 #include "Math/MathHelpers.h"
 #include "Math/Noise.h"
@@ -255,12 +256,69 @@ void ParticleForces::ApplyForce(const ParticleForce* force, Vector3& velocity, V
     case ForceType::PLANE_COLLISION:
         ParticleForcesDetails::ApplyPlaneCollision(force, velocity, position, particle, prevPosition, forcePosition);
         break;
+    case ForceType::SCENE_COLLISION:
+        break; // Needs scene collision data, see ApplySceneCollision.
     default:
         DVASSERT(false, "Unsupported force.");
         break;
     }
 }
 
+bool ParticleForces::ApplySceneCollision(const ParticleForce* force, const ParticleCollisionHeightField* collision, Vector3& velocity, Vector3& position, const Vector3& prevPosition, Particle* particle, Vector3& hitNormal)
+{
+    using CollisionResponse = ParticleForce::eCollisionResponse;
+
+    ParticleCollisionHeightField::Surface surface;
+    // Static geometry is queried from previous height: particle that was under overhang stays under it.
+    if (!force->isActive || !collision->GetSurface(position.x, position.y, prevPosition.z, surface, force->collideWithLandscape, force->collideWithStaticGeometry) || position.z >= surface.height)
+        return false;
+
+    Vector3 normal = surface.normal;
+    Vector3 resolvedPosition(position.x, position.y, surface.height);
+    if (surface.isStaticGeometry)
+    {
+        // Particle above surface on previous step entered higher column from side: treat it as wall hit.
+        ParticleCollisionHeightField::Surface prevSurface;
+        Vector3 back(prevPosition.x - position.x, prevPosition.y - position.y, 0.0f);
+        if (collision->GetSurface(prevPosition.x, prevPosition.y, prevPosition.z, prevSurface, force->collideWithLandscape, force->collideWithStaticGeometry) && prevPosition.z >= prevSurface.height && prevPosition.z < surface.height && back.SquareLength() > EPSILON)
+        {
+            normal = Normalize(back);
+            resolvedPosition = prevPosition;
+        }
+    }
+
+    float32 normalSpeed = velocity.DotProduct(normal);
+    position = resolvedPosition;
+    if (normalSpeed >= 0.0f && force->collisionResponse != CollisionResponse::KILL)
+        return false;
+
+    bool isImpact = -normalSpeed > force->velocityThreshold;
+    switch (force->collisionResponse)
+    {
+    case CollisionResponse::KILL:
+        ParticleForcesDetails::KillParticle(particle);
+        isImpact = true;
+        break;
+    case CollisionResponse::STICK:
+        velocity = Vector3::Zero;
+        break;
+    case CollisionResponse::BOUNCE:
+    {
+        Vector3 normalVelocity = normal * normalSpeed;
+        Vector3 tangentVelocity = velocity - normalVelocity;
+        velocity = tangentVelocity * Clamp(1.0f - force->collisionFriction, 0.0f, 1.0f) - normalVelocity * force->collisionBounciness;
+        break;
+    }
+    default:
+        DVASSERT(false, "Unsupported collision response.");
+        break;
+    }
+
+    if (isImpact)
+        hitNormal = normal;
+    return isImpact;
+}
+
 void ParticleForcesUtils::GenerateSphereRandomVectors()
 {
     uint32 seed = static_cast<uint32>(std::chrono::system_clock::now().time_since_epoch().count());
@@ -5,6 +5,7 @@
 namespace DAVA
 {
 class ParticleForce;
+class ParticleCollisionHeightField;
 class Vector3;
 class Entity;
 struct Particle;
@@ -13,6 +14,13 @@ class ParticleForces
 {
 public:
     static void ApplyForce(const ParticleForce* force, Vector3& velocity, Vector3& position, float32 dt, float32 particleOverLife, float32 layerOverLife, const Vector3& down, Particle* particle, const Vector3& prevPosition, const Vector3& forcePosition);
+
+    /**
+        Resolves SCENE_COLLISION force in world space. Particle below collision surface is moved back onto it
+        and its velocity is changed according to force response. Returns true on impact, i.e. when particle
+        was killed or hit surface faster than force velocityThreshold; `hitNormal` is set in that case.
+    */
+    static bool ApplySceneCollision(const ParticleForce* force, const ParticleCollisionHeightField* collision, Vector3& velocity, Vector3& position, const Vector3& prevPosition, Particle* particle, Vector3& hitNormal);
 };
 
 class ParticleForcesUtils
@@ -20,6 +20,7 @@ DAVA_VIRTUAL_REFLECTION_IMPL(ParticleLayer)
 using ForceShape = ParticleForce::eShape;
 using ForceTimingType = ParticleForce::eTimingType;
 using ForceType = ParticleForce::eType;
+using ForceCollisionResponse = ParticleForce::eCollisionResponse;
 
 namespace ParticleLayerDetail
 {
@@ -52,16 +53,29 @@ struct ForceTypeMap
     ForceType elemType;
     String name;
 };
-const Array<ForceTypeMap, 6> forceTypesMap =
+const Array<ForceTypeMap, 7> forceTypesMap =
 { {
 { ForceType::DRAG_FORCE, "drag" },
 { ForceType::VORTEX, "vortex" },
 { ForceType::POINT_GRAVITY, "pointgr" },
 { ForceType::PLANE_COLLISION, "plncoll" },
+{ ForceType::SCENE_COLLISION, "scncoll" },
 { ForceType::GRAVITY, "grav" },
 { ForceType::WIND, "wind" }
 } };
 
+struct CollisionResponseMap
+{
+    ForceCollisionResponse elemType;
+    String name;
+};
+const Array<CollisionResponseMap, 3> collisionResponseMap =
+{ {
+{ ForceCollisionResponse::BOUNCE, "bounce" },
+{ ForceCollisionResponse::STICK, "stick" },
+{ ForceCollisionResponse::KILL, "kill" }
+} };
+
 template <typename T, typename U, size_t sz>
 T StringToType(const String& typeName, T defaultVal, const Array<U, sz> map)
 {
@@ -1342,6 +1356,30 @@ void ParticleLayer::SaveForcesToYamlNode(YamlNode* layerNode)
 
         forceDataName = Format("endTime%d", i);
         PropertyLineYamlWriter::WritePropertyValueToYamlNode<float32>(layerNode, forceDataName, currentForce->endTime);
+
+        if (currentForce->type == ForceType::SCENE_COLLISION)
+        {
+            forceDataName = Format("collisionResponse%d", i);
+            PropertyLineYamlWriter::WritePropertyValueToYamlNode<String>(layerNode, forceDataName, TypeToString(currentForce->collisionResponse, "bounce", collisionResponseMap));
+
+            forceDataName = Format("collisionBounciness%d", i);
+            PropertyLineYamlWriter::WritePropertyValueToYamlNode<float32>(layerNode, forceDataName, currentForce->collisionBounciness);
+
+            forceDataName = Format("collisionFriction%d", i);
+            PropertyLineYamlWriter::WritePropertyValueToYamlNode<float32>(layerNode, forceDataName, currentForce->collisionFriction);
+
+            forceDataName = Format("collisionAreaSize%d", i);
+            PropertyLineYamlWriter::WritePropertyValueToYamlNode<float32>(layerNode, forceDataName, currentForce->collisionAreaSize);
+
+            forceDataName = Format("collisionCellSize%d", i);
+            PropertyLineYamlWriter::WritePropertyValueToYamlNode<float32>(layerNode, forceDataName, currentForce->collisionCellSize);
+
+            forceDataName = Format("collideWithLandscape%d", i);
+            PropertyLineYamlWriter::WritePropertyValueToYamlNode<bool>(layerNode, forceDataName, currentForce->collideWithLandscape);
+
+            forceDataName = Format("collideWithStaticGeometry%d", i);
+            PropertyLineYamlWriter::WritePropertyValueToYamlNode<bool>(layerNode, forceDataName, currentForce->collideWithStaticGeometry);
+        }
     }
 }
 
@@ -1452,6 +1490,8 @@ void ParticleLayer::AddForce(ParticleForce* force)
         ++alterPositionForcesCount;
     if (force->type == ParticleForce::eType::PLANE_COLLISION)
         ++planeCollisionForcesCount;
+    if (force->type == ParticleForce::eType::SCENE_COLLISION)
+        ++sceneCollisionForcesCount;
 
     SafeRetain(force);
     particleForces.push_back(force);
@@ -1470,6 +1510,8 @@ void ParticleLayer::RemoveForce(ParticleForce* force)
             --alterPositionForcesCount;
         if (force->type == ParticleForce::eType::PLANE_COLLISION)
             --planeCollisionForcesCount;
+        if (force->type == ParticleForce::eType::SCENE_COLLISION)
+            --sceneCollisionForcesCount;
         SafeRelease(*iter);
         particleForces.erase(iter);
     }
@@ -1483,6 +1525,8 @@ void ParticleLayer::RemoveForce(int32 forceIndex)
             --alterPositionForcesCount;
         if (particleForces[forceIndex]->type == ParticleForce::eType::PLANE_COLLISION)
             --planeCollisionForcesCount;
+        if (particleForces[forceIndex]->type == ParticleForce::eType::SCENE_COLLISION)
+            --sceneCollisionForcesCount;
         SafeRelease(particleForces[forceIndex]);
         particleForces.erase(particleForces.begin() + forceIndex);
     }
@@ -1496,6 +1540,9 @@ void ParticleLayer::CleanupForces()
     }
 
     particleForces.clear();
+    alterPositionForcesCount = 0;
+    planeCollisionForcesCount = 0;
+    sceneCollisionForcesCount = 0;
 }
 
 void ParticleLayer::FillSizeOverlifeXY(RefPtr<PropertyLine<float32>> sizeOverLife)
@@ -1735,6 +1782,41 @@ void ParticleLayer::LoadForcesFromYaml(const YamlNode* node)
         if (windBiasNode)
             force->windBias = windBiasNode->AsFloat();
 
+        forceDataName = Format("collisionResponse%d", i);
+        const YamlNode* collisionResponseNode = node->Get(forceDataName);
+        if (collisionResponseNode)
+            force->collisionResponse = StringToType(collisionResponseNode->AsString(), ForceCollisionResponse::BOUNCE, collisionResponseMap);
+
+        forceDataName = Format("collisionBounciness%d", i);
+        const YamlNode* collisionBouncinessNode = node->Get(forceDataName);
+        if (collisionBouncinessNode)
+            force->collisionBounciness = collisionBouncinessNode->AsFloat();
+
+        forceDataName = Format("collisionFriction%d", i);
+        const YamlNode* collisionFrictionNode = node->Get(forceDataName);
+        if (collisionFrictionNode)
+            force->collisionFriction = collisionFrictionNode->AsFloat();
+
+        forceDataName = Format("collisionAreaSize%d", i);
+        const YamlNode* collisionAreaSizeNode = node->Get(forceDataName);
+        if (collisionAreaSizeNode)
+            force->collisionAreaSize = collisionAreaSizeNode->AsFloat();
+
+        forceDataName = Format("collisionCellSize%d", i);
+        const YamlNode* collisionCellSizeNode = node->Get(forceDataName);
+        if (collisionCellSizeNode)
+            force->collisionCellSize = collisionCellSizeNode->AsFloat();
+
+        forceDataName = Format("collideWithLandscape%d", i);
+        const YamlNode* collideWithLandscapeNode = node->Get(forceDataName);
+        if (collideWithLandscapeNode)
+            force->collideWithLandscape = collideWithLandscapeNode->AsBool();
+
+        forceDataName = Format("collideWithStaticGeometry%d", i);
+        const YamlNode* collideWithStaticGeometryNode = node->Get(forceDataName);
+        if (collideWithStaticGeometryNode)
+            force->collideWithStaticGeometry = collideWithStaticGeometryNode->AsBool();
+
         RefPtr<PropertyLine<Vector3>> forcePowerLine = PropertyLineYamlReader::CreatePropertyLine<Vector3>(node->Get(Format("dragForceLine%d", i)));
         force->forcePowerLine = forcePowerLine;
 
@@ -245,6 +245,7 @@ struct ParticleLayer : public BaseObject
     const Vector<ParticleForceSimplified*>& GetSimplifiedParticleForces();
     int8 GetAlterPositionForcesCount() const;
     int8 GetPlaneCollisiontForcesCount() const;
+    int8 GetSceneCollisionForcesCount() const;
 
 private:
     struct LayerTypeNamesInfo
@@ -254,6 +255,7 @@ private:
     };
     int8 alterPositionForcesCount = 0;
     int8 planeCollisionForcesCount = 0;
+    int8 sceneCollisionForcesCount = 0;
     static const LayerTypeNamesInfo layerTypeNamesInfoMap[];
 
     void FillSizeOverlifeXY(RefPtr<PropertyLine<float32>> sizeOverLife);
@@ -337,4 +339,9 @@ inline int8 ParticleLayer::GetPlaneCollisiontForcesCount() const
 {
     return planeCollisionForcesCount;
 }
+
+inline int8 ParticleLayer::GetSceneCollisionForcesCount() const
+{
+    return sceneCollisionForcesCount;
+}
 }
@@ -2,6 +2,7 @@
 
 #include "Math/MathConstants.h"
 #include "Render/DynamicBufferAllocator.h"
+#include "Render/Highlevel/RenderSystem.h"
 #include "Render/Renderer.h"
 #include "Time/SystemTimer.h"
 
@@ -53,6 +54,11 @@ ParticleRenderObject::~ParticleRenderObject()
 
 void ParticleRenderObject::PrepareToRender(Camera* camera)
 {
+    if (renderSystem != nullptr)
+    {
+        lastVisibleFrame = renderSystem->GetRenderFrameIndex();
+    }
+
     if (!Renderer::GetOptions()->IsOptionEnabled(RenderOptions::PARTICLES_PREPARE_BUFFERS))
         return;
 
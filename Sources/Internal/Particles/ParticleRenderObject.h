@@ -31,6 +31,7 @@ class ParticleRenderObject : public RenderObject
     uint32 sortingOffset;
 
     uint32 currRenderBatchId;
+    uint32 lastVisibleFrame = 0;
 
 public:
     ParticleRenderObject(ParticleEffectData* effect);
@@ -38,6 +39,9 @@ public:
 
     void PrepareToRender(Camera* camera) override;
 
+    /** Return RenderSystem frame index when object was prepared to render last time. */
+    uint32 GetLastVisibleFrame() const;
+
     void SetSortingOffset(uint32 offset);
 
     void BindDynamicParameters(Camera* camera, RenderBatch* batch) override;
@@ -109,4 +113,9 @@ inline bool ParticleRenderObject::CheckGroup(const ParticleGroup& group) const
 {
     return group.material && group.head && !group.layer->isDisabled && group.layer->sprite;
 }
+
+inline uint32 ParticleRenderObject::GetLastVisibleFrame() const
+{
+    return lastVisibleFrame;
+}
 }
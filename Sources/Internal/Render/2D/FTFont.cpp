@@ -54,7 +54,7 @@ private:
     struct Glyph
     {
         FT_UInt index = 0;
-        FT_Glyph image = nullptr; /* the glyph image */
+        FT_Glyph image = nullptr; /* own copy of the glyph image */
         FT_Pos delta = 0; /* delta caused by hinting */
 
         bool operator<(const Glyph& right) const
@@ -62,18 +62,19 @@ private:
             return image < right.image;
         };
     };
-    Vector<Glyph> glyphs;
 
     bool initialized = false;
 
-    void ClearString();
-    int32 LoadString(float32 size, const WideString& str);
-    void Prepare(FT_Face face, FT_Vector* advances);
+    void ClearString(Vector<Glyph>& glyphs);
+    int32 LoadString(float32 size, const WideString& str, Vector<Glyph>& glyphs);
+    void Prepare(FT_Face face, const Vector<Glyph>& glyphs, FT_Vector* advances);
 
     inline int32 FtRound(int32 val);
     inline int32 FtCeil(int32 val);
 
-    static Mutex drawStringMutex;
+    // Guards shared FreeType cache manager and rasterizer.
+    // Strings are measured on own copies of glyphs outside of this lock, so text layout can be done from several threads.
+    static Mutex ftCacheMutex;
     static const int32 ftToPixelShift; // Int value for shift to convert FT point to pixel
     static const float32 ftToPixelScale; // Float value to convert FT point to pixel
 };
@@ -244,7 +245,7 @@ DAVA::float32 FTFont::GetDescendScale() const
 
 ////////////////////////////////////////////////////////////////////////////////
 
-Mutex FTInternalFont::drawStringMutex;
+Mutex FTInternalFont::ftCacheMutex;
 
 /**
  /brief Wrap around FT_MulFix, because this function is written in assembler and
@@ -275,7 +276,7 @@ FTInternalFont::FTInternalFont(const FilePath& path)
 
 FTInternalFont::~FTInternalFont()
 {
-    ClearString();
+    LockGuard<Mutex> lock(ftCacheMutex);
     ftm->RemoveFace(this);
 }
 
@@ -346,8 +347,6 @@ Font::StringMetrics FTInternalFont::DrawString(const WideString& str, void* buff
         return Font::StringMetrics();
     }
 
-    drawStringMutex.Lock();
-
     bool drawNondefGlyph = Renderer::GetOptions()->IsOptionEnabled(RenderOptions::DRAW_NONDEF_GLYPH);
 
     size = GetEngineContext()->uiControlSystem->vcs->ConvertVirtualToPhysicalY(size); // increase size for high dpi screens
@@ -359,11 +358,16 @@ Font::StringMetrics FTInternalFont::DrawString(const WideString& str, void* buff
         offsetX = int32(GetEngineContext()->uiControlSystem->vcs->ConvertVirtualToPhysicalX(float32(offsetX)));
     }
 
+    // Rasterization uses shared FreeType renderer, so the lock is held for the whole call.
+    // For measurement the lock is released as soon as glyphs are copied from the cache.
+    ftCacheMutex.Lock();
+
     FT_Size ft_size = nullptr;
     FT_Error error = ftm->LookupSize(this, size, &ft_size);
 
     if (error != FT_Err_Ok)
     {
+        ftCacheMutex.Unlock();
         Logger::Error("[FTInternalFont::DrawString] LookupSize error %d", error);
         return Font::StringMetrics();
     }
@@ -376,10 +380,16 @@ Font::StringMetrics FTInternalFont::DrawString(const WideString& str, void* buff
     pen.y = offsetY << ftToPixelShift;
     pen.y -= FT_Pos(faceBboxYMin); //bring baseline up
 
-    int32 countSpace = LoadString(size, str);
+    Vector<Glyph> glyphs;
+    int32 countSpace = LoadString(size, str, glyphs);
     uint32 strLen = uint32(str.length());
     FT_Vector* advances = new FT_Vector[strLen];
-    Prepare(ft_size->face, advances);
+    Prepare(ft_size->face, glyphs, advances);
+
+    if (!realDraw)
+    {
+        ftCacheMutex.Unlock();
+    }
 
     float32 baseSize = (faceBboxYMax - faceBboxYMin) * ftToPixelScale;
     int32 multilineOffsetY = int32(std::ceil(baseSize)) + offsetY * 2;
@@ -409,31 +419,30 @@ Font::StringMetrics FTInternalFont::DrawString(const WideString& str, void* buff
         bool skipGlyph = true;
         if (glyph.image && (glyph.index != 0 || drawNondefGlyph))
         {
-            error = FT_Glyph_Copy(glyph.image, &image);
-            if (error == 0)
+            // Glyph is already copied from the cache, take ownership over it
+            std::swap(image, glyph.image);
+
+            // Make justify offsets only for visible glyphs
+            if (i > 0 && (justifyOffset > 0 || fixJustifyOffset > 0))
             {
-                // Make justify offsets only for visible glyphs
-                if (i > 0 && (justifyOffset > 0 || fixJustifyOffset > 0))
+                if (str[i - 1] == L' ')
                 {
-                    if (str[i - 1] == L' ')
-                    {
-                        advances[i].x += justifyOffset << ftToPixelShift; //Increase advance of character
-                    }
-                    if (fixJustifyOffset > 0)
-                    {
-                        fixJustifyOffset--;
-                        advances[i].x += 1 << ftToPixelShift; //Increase advance of character
-                    }
+                    advances[i].x += justifyOffset << ftToPixelShift; //Increase advance of character
+                }
+                if (fixJustifyOffset > 0)
+                {
+                    fixJustifyOffset--;
+                    advances[i].x += 1 << ftToPixelShift; //Increase advance of character
                 }
+            }
 
-                error = FT_Glyph_Transform(image, nullptr, &pen);
-                if (error == 0)
+            error = FT_Glyph_Transform(image, nullptr, &pen);
+            if (error == 0)
+            {
+                FT_Glyph_Get_CBox(image, FT_GLYPH_BBOX_PIXELS, &bbox);
+                if (realDraw)
                 {
-                    FT_Glyph_Get_CBox(image, FT_GLYPH_BBOX_PIXELS, &bbox);
-                    if (realDraw)
-                    {
-                        error = FT_Glyph_To_Bitmap(&image, FT_RENDER_MODE_NORMAL, 0, 1);
-                    }
+                    error = FT_Glyph_To_Bitmap(&image, FT_RENDER_MODE_NORMAL, 0, 1);
                 }
             }
             skipGlyph = error != 0;
@@ -551,7 +560,12 @@ Font::StringMetrics FTInternalFont::DrawString(const WideString& str, void* buff
     }
 
     SafeDeleteArray(advances);
-    drawStringMutex.Unlock();
+    ClearString(glyphs);
+
+    if (realDraw)
+    {
+        ftCacheMutex.Unlock();
+    }
 
     if (metrics.drawRect.x == 0x7fffffff || metrics.drawRect.y == 0x7fffffff) // Empty string
     {
@@ -590,6 +604,7 @@ bool FTInternalFont::IsCharAvaliable(char16 ch)
         return false;
     }
 
+    LockGuard<Mutex> lock(ftCacheMutex);
     uint32 index = ftm->LookupGlyphIndex(this, ch);
     return index != 0;
 }
@@ -602,18 +617,30 @@ uint32 FTInternalFont::GetFontHeight(float32 size, float32 ascendScale, float32
     }
 
     size = GetEngineContext()->uiControlSystem->vcs->ConvertVirtualToPhysicalY(size); // increase size for high dpi screens
-    FT_Size ft_size = nullptr;
-    if (ftm->LookupSize(this, size, &ft_size) == FT_Err_Ok)
+
+    int32 faceBboxYMin = 0;
+    int32 faceBboxYMax = 0;
+    FT_Error error = FT_Err_Ok;
+    {
+        LockGuard<Mutex> lock(ftCacheMutex);
+        FT_Size ft_size = nullptr;
+        error = ftm->LookupSize(this, size, &ft_size);
+        if (error == FT_Err_Ok)
+        {
+            faceBboxYMin = int32(FT_MulFix_Wrapper(ft_size->face->bbox.yMin, ft_size->metrics.y_scale) * descendScale); // draw offset
+            faceBboxYMax = int32(FT_MulFix_Wrapper(ft_size->face->bbox.yMax, ft_size->metrics.y_scale) * ascendScale); // baseline
+        }
+    }
+
+    if (error == FT_Err_Ok)
     {
-        int32 faceBboxYMin = int32(FT_MulFix_Wrapper(ft_size->face->bbox.yMin, ft_size->metrics.y_scale) * descendScale); // draw offset
-        int32 faceBboxYMax = int32(FT_MulFix_Wrapper(ft_size->face->bbox.yMax, ft_size->metrics.y_scale) * ascendScale); // baseline
         float32 height = std::ceil((faceBboxYMax - faceBboxYMin) * ftToPixelScale);
         return uint32(std::ceil(GetEngineContext()->uiControlSystem->vcs->ConvertPhysicalToVirtualX(height))); // cover height to virtual coordinates back
     }
     return 0;
 }
 
-void FTInternalFont::Prepare(FT_Face face, FT_Vector* advances)
+void FTInternalFont::Prepare(FT_Face face, const Vector<Glyph>& glyphs, FT_Vector* advances)
 {
     if (!initialized)
     {
@@ -627,7 +654,7 @@ void FTInternalFont::Prepare(FT_Face face, FT_Vector* advances)
 
     for (uint32 i = 0; i < size; ++i)
     {
-        Glyph& glyph = glyphs[i];
+        const Glyph& glyph = glyphs[i];
 
         advances[i] = glyph.image->advance;
         advances[i].x >>= 10; // Translate advances in
@@ -653,14 +680,22 @@ void FTInternalFont::Prepare(FT_Face face, FT_Vector* advances)
     }
 }
 
-void FTInternalFont::ClearString()
+void FTInternalFont::ClearString(Vector<Glyph>& glyphs)
 {
+    for (Glyph& glyph : glyphs)
+    {
+        if (glyph.image != nullptr)
+        {
+            FT_Done_Glyph(glyph.image);
+        }
+    }
     glyphs.clear();
 }
 
-int32 FTInternalFont::LoadString(float32 size, const WideString& str)
+int32 FTInternalFont::LoadString(float32 size, const WideString& str, Vector<Glyph>& glyphs)
 {
-    ClearString();
+    ClearString(glyphs);
+    glyphs.reserve(str.size());
 
     int32 spacesCount = 0;
     uint32 count = uint32(str.size());
@@ -673,7 +708,15 @@ int32 FTInternalFont::LoadString(float32 size, const WideString& str)
 
         Glyph glyph;
         glyph.index = ftm->LookupGlyphIndex(this, str[i]);
-        FT_Error error = ftm->LookupGlyph(this, size, glyph.index, &glyph.image);
+
+        // Cached image is valid only until next cache lookup, so keep own copy
+        FT_Glyph cachedImage = nullptr;
+        FT_Error error = ftm->LookupGlyph(this, size, glyph.index, &cachedImage);
+        if (error == FT_Err_Ok && FT_Glyph_Copy(cachedImage, &glyph.image) != 0)
+        {
+            glyph.image = nullptr;
+        }
+
         if (error != FT_Err_Ok)
         {
 #if defined(__DAVAENGINE_DEBUG__)
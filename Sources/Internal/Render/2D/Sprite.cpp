@@ -1,4 +1,5 @@
 #include "Render/2D/Sprite.h"
+#include "Concurrency/LockGuard.h"
 #include "Debug/DVAssert.h"
 #include "Engine/Engine.h"
 #include "FileSystem/File.h"
@@ -35,6 +36,7 @@ SpriteMap spriteMap;
 static int32 fboCounter = 0;
 
 Mutex Sprite::spriteMapMutex;
+ResourceRetentionCache Sprite::retentionCache;
 
 SpriteDrawState::SpriteDrawState()
 {
@@ -83,6 +85,15 @@ Sprite* Sprite::PureCreate(const FilePath& spriteName, Sprite* forPointer)
         return cachedSprite;
     }
 
+    if (forPointer == nullptr)
+    {
+        cachedSprite = TakeFromRetentionCache(spriteName);
+        if (cachedSprite)
+        {
+            return cachedSprite;
+        }
+    }
+
     int32 resourceSizeIndex = 0;
     File* spriteFile = GetSpriteFile(spriteName, resourceSizeIndex);
     if (!spriteFile)
@@ -130,6 +141,26 @@ Sprite* Sprite::GetSpriteFromMap(const FilePath& pathname)
     return ret;
 }
 
+Sprite* Sprite::TakeFromRetentionCache(const FilePath& pathname)
+{
+    LockGuard<Mutex> guard(spriteMapMutex);
+
+    // sprite could be loaded or taken by other thread after lookup in GetSpriteFromMap
+    SpriteMap::iterator it = spriteMap.find(FILEPATH_MAP_KEY(pathname));
+    if (it != spriteMap.end())
+    {
+        it->second->Retain();
+        return it->second;
+    }
+
+    Sprite* spr = static_cast<Sprite*>(retentionCache.Take(pathname));
+    if (spr != nullptr)
+    {
+        spriteMap[FILEPATH_MAP_KEY(pathname)] = spr;
+    }
+    return spr;
+}
+
 FilePath Sprite::GetScaledName(const FilePath& spriteName)
 {
     String pathname;
@@ -247,7 +278,7 @@ void Sprite::InitFromFile(File* file)
     if (GetEngineContext()->dynamicAtlasSystem->RegisterSprite(this))
     {
         // Sprite was added into system
-        // Texture will created in `DynamicAtlasSystem::EndAtlas()` call.
+        // Texture will created in `DynamicAtlasSystem::EndAtlas()` call or was already assigned in incremental mode.
     }
     else
     {
@@ -259,11 +290,14 @@ void Sprite::InitFromFile(File* file)
         }
     }
 
-    // Update default geometry
+    // Update default geometry, sprite packed into atlas page already has its geometry
     for (int32 i = 0; i < frameCount; i++)
     {
-        UpdateFrameGeometry(rectsAndOffsetsOriginal[i][eRectsAndOffsets::X_POSITION_IN_TEXTURE],
-                            rectsAndOffsetsOriginal[i][eRectsAndOffsets::Y_POSITION_IN_TEXTURE], i);
+        if (!inDynamicAtlas || textures[frameTextureIndex[i]] == nullptr)
+        {
+            UpdateFrameGeometry(rectsAndOffsetsOriginal[i][eRectsAndOffsets::X_POSITION_IN_TEXTURE],
+                                rectsAndOffsetsOriginal[i][eRectsAndOffsets::Y_POSITION_IN_TEXTURE], i);
+        }
     }
 
     if (!inDynamicAtlas)
@@ -372,6 +406,15 @@ Sprite* Sprite::CreateFromTexture(Texture* fromTexture, int32 textureRegionOffse
 
 Sprite* Sprite::CreateFromImage(Image* image, bool contentScaleIncluded /* = false*/, bool inVirtualSpace /* = false */)
 {
+    if (!inVirtualSpace)
+    {
+        Sprite* atlasSprite = GetEngineContext()->dynamicAtlasSystem->CreateSpriteFromImage(image, contentScaleIncluded);
+        if (atlasSprite != nullptr)
+        {
+            return atlasSprite;
+        }
+    }
+
     uint32 width = image->GetWidth();
     uint32 height = image->GetHeight();
 
@@ -600,12 +643,78 @@ void Sprite::Clear()
 Sprite::~Sprite()
 {
     spriteMapMutex.Lock();
-    spriteMap.erase(FILEPATH_MAP_KEY(relativePathname));
+    // map can already contain other sprite with the same path, if this one was evicted from retention cache
+    SpriteMap::iterator it = spriteMap.find(FILEPATH_MAP_KEY(relativePathname));
+    if (it != spriteMap.end() && it->second == this)
+    {
+        spriteMap.erase(it);
+    }
     spriteMapMutex.Unlock();
     GetEngineContext()->dynamicAtlasSystem->UnregisterSprite(this);
     Clear();
 }
 
+int32 Sprite::Release()
+{
+    if (GetRetainCount() == 1 && IsRetainable())
+    {
+        uint32 memory = GetTexturesDataSize();
+        bool retained = false;
+
+        spriteMapMutex.Lock();
+        SpriteMap::iterator it = spriteMap.find(FILEPATH_MAP_KEY(relativePathname));
+        if (it != spriteMap.end() && it->second == this)
+        {
+            retained = retentionCache.Put(relativePathname, this, memory, textures[0]->GetSourceFileGPUFamily(), textures[0]->GetFormat());
+            if (retained)
+            {
+                spriteMap.erase(it);
+            }
+        }
+        spriteMapMutex.Unlock();
+
+        if (retained)
+        {
+            // last reference is owned by retention cache now
+            retentionCache.Trim();
+            return 0;
+        }
+    }
+    return BaseObject::Release();
+}
+
+bool Sprite::IsRetainable() const
+{
+    if (type != SPRITE_FROM_FILE || textureCount == 0 || relativePathname.GetType() == FilePath::PATH_IN_MEMORY)
+    {
+        return false;
+    }
+
+    for (int32 i = 0; i < textureCount; ++i)
+    {
+        if (textures[i] == nullptr || textures[i]->IsPinkPlaceholder())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32 Sprite::GetTexturesDataSize() const
+{
+    uint32 dataSize = 0;
+    for (int32 i = 0; i < textureCount; ++i)
+    {
+        dataSize += textures[i]->GetDataSize();
+    }
+    return dataSize;
+}
+
+ResourceRetentionCache& Sprite::GetRetentionCache()
+{
+    return retentionCache;
+}
+
 Texture* Sprite::GetTexture() const
 {
     return textures[0];
@@ -875,6 +984,8 @@ void Sprite::ReloadSprites()
 
 void Sprite::ReloadSprites(eGPUFamily gpu)
 {
+    retentionCache.Clear();
+
     for (SpriteMap::iterator it = spriteMap.begin(); it != spriteMap.end(); ++it)
     {
         (it->second)->Reload(gpu);
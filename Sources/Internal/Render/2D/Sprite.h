@@ -7,6 +7,7 @@
 #include "Base/BaseTypes.h"
 #include "Base/BaseMath.h"
 #include "Render/RenderBase.h"
+#include "Render/ResourceRetentionCache.h"
 #include "FileSystem/FilePath.h"
 
 #include "Render/UniqueStateSet.h"
@@ -223,11 +224,25 @@ public:
     static void ReloadSprites();
     static void ReloadSprites(eGPUFamily gpu);
 
+    int32 Release() override;
+
+    /**
+	 \brief Cache of released sprites loaded from files, disabled by default.
+	 When cache is enabled, sprite released by all users is kept in it together with its textures
+	 and is returned by next Create or PureCreate of the same file instead of loading.
+	 Memory of sprite is memory of its textures. Cache is cleared on sprites reload and on low memory.
+	 */
+    static ResourceRetentionCache& GetRetentionCache();
+
 protected:
     Sprite();
     virtual ~Sprite();
 
     static Sprite* GetSpriteFromMap(const FilePath& pathname);
+    static Sprite* TakeFromRetentionCache(const FilePath& pathname);
+
+    bool IsRetainable() const;
+    uint32 GetTexturesDataSize() const;
     static FilePath GetScaledName(const FilePath& spriteName);
     static File* LoadLocalizedFile(const FilePath& spritePathname, FilePath& texturePath);
 
@@ -240,6 +255,7 @@ protected:
     void UpdateFrameGeometry(int32 x, int32 y, int32 frameIdx);
 
     static Mutex spriteMapMutex;
+    static ResourceRetentionCache retentionCache;
 
     enum eSpriteTransform
     {
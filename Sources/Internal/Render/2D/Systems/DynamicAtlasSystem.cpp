@@ -1,8 +1,12 @@
 #include "Render/2D/Systems/DynamicAtlasSystem.h"
 
+#include "Base/ScopedPtr.h"
+#include "Concurrency/Atomic.h"
 #include "Concurrency/LockGuard.h"
 #include "Concurrency/Mutex.h"
 #include "Concurrency/Thread.h"
+#include "Engine/Engine.h"
+#include "Job/JobManager.h"
 #include "Logger/Logger.h"
 #include "UI/UIControl.h"
 #include "UI/UIControlSystem.h"
@@ -16,6 +20,7 @@
 #include "Render/Texture.h"
 #include "Render/TextureDescriptor.h"
 #include "Render/2D/Sprite.h"
+#include "Render/2D/Systems/VirtualCoordinatesSystem.h"
 #include "Math/RectanglePacker/Spritesheet.h"
 #include "Time/SystemTimer.h"
 
@@ -37,6 +42,12 @@ std::shared_ptr<TextureDescriptor> GetDescriptorIfValid(const FilePath& textureN
 /** Load first mipmap texture image . */
 Image* LoadBaseMipImageForTexture(std::shared_ptr<TextureDescriptor>& texDescriptor);
 
+/** Return retained image in RGBA8888 format, converting it if required. */
+Image* GetRGBA8888Image(Image* image);
+
+/** Run composition on worker thread if job manager is available. */
+void RunComposition(const Function<void()>& fn);
+
 #ifdef DEBUG_DUMP_DYNAMIC_ATLASES
 /** Save image as file for debugging purpose */
 void DumpAtlasImage(Image* image);
@@ -76,6 +87,44 @@ struct DynamicAtlasSystem::AtlasRegion
     Vector<int32> sheetIndices;
 };
 
+struct DynamicAtlasSystem::AtlasPage
+{
+    const static int32 MARGIN = 1;
+
+    RefPtr<Texture> texture;
+    // Copy of page content, source for texture uploads and for moving regions between pages
+    RefPtr<Image> image;
+    SkylinePacker packer;
+    Vector<PageFrame*> frames;
+    // Area of live frames including margins
+    uint64 usedArea = 0;
+    // Count of frames being composed into page image on worker threads
+    Atomic<int32> pendingCompositions;
+    bool dirty = false;
+};
+
+struct DynamicAtlasSystem::PageFrame
+{
+    PageRegion* region = nullptr;
+    AtlasPage* page = nullptr;
+    // Frame rect in page without margins
+    Rect2i rect;
+
+    uint64 GetArea() const
+    {
+        return static_cast<uint64>(rect.dx + 2 * AtlasPage::MARGIN) * static_cast<uint64>(rect.dy + 2 * AtlasPage::MARGIN);
+    }
+};
+
+struct DynamicAtlasSystem::PageRegion
+{
+    // weak pointer
+    Sprite* sprite = nullptr;
+    // Size of texture part covered by geometry of sprite created from image, in texels
+    Vector2 textureExtent;
+    Vector<PageFrame> frames;
+};
+
 void DynamicAtlasSystem::DynamicAtlas::RemoveRegion(AtlasRegion* region)
 {
     auto atlasIt = std::find(region->atlases.begin(), region->atlases.end(), this);
@@ -118,7 +167,7 @@ DynamicAtlasSystem::DynamicAtlasSystem()
     // "maxrect_fast"
     rectanglePacker.SetAlgorithms({ PackingAlgorithm::ALG_MAXRECTS_BEST_AREA_FIT });
 
-    Renderer::GetSignals().needRestoreResources.Connect(this, &DynamicAtlasSystem::RebuildAll);
+    Renderer::GetSignals().needRestoreResources.Connect(this, &DynamicAtlasSystem::RestoreResources);
 }
 
 DynamicAtlasSystem::~DynamicAtlasSystem()
@@ -127,6 +176,14 @@ DynamicAtlasSystem::~DynamicAtlasSystem()
     LockGuard<Mutex> lock(systemMutex);
     ReleaseAllAtlases();
     regions.clear();
+
+    for (auto& it : pageRegions)
+    {
+        it.first->inDynamicAtlas = false;
+    }
+    pageRegions.clear();
+    evacuatingPage = nullptr;
+    pages.clear();
 }
 
 void DynamicAtlasSystem::BeginAtlas(const Vector<String>& whitePathsList_, const Vector<String>& blackPathsList_)
@@ -221,6 +278,10 @@ bool DynamicAtlasSystem::RegisterSprite(Sprite* sprite)
                 }
             }
         }
+        else if (incrementalPacking && state == IDLE && sprite->type == Sprite::eSpriteType::SPRITE_FROM_FILE)
+        {
+            return AddSpriteToPages(sprite);
+        }
     }
     return false;
 }
@@ -232,6 +293,20 @@ void DynamicAtlasSystem::UnregisterSprite(Sprite* sprite)
         LockGuard<Mutex> lock(systemMutex);
         if (sprite->inDynamicAtlas)
         {
+            auto pageRegionIt = pageRegions.find(sprite);
+            if (pageRegionIt != pageRegions.end())
+            {
+                sprite->inDynamicAtlas = false;
+                for (int32 textureIdx = 0; textureIdx < sprite->textureCount; textureIdx++)
+                {
+                    SafeRelease(sprite->textures[textureIdx]);
+                }
+
+                RemovePageRegion(pageRegionIt->second.get());
+                pageRegions.erase(pageRegionIt);
+                return;
+            }
+
             auto regionIt = std::find_if(regions.begin(), regions.end(), [&](auto& region) {
                 return region->sprite == sprite;
             });
@@ -272,6 +347,476 @@ void DynamicAtlasSystem::RebuildAll()
     PackSprites();
 }
 
+void DynamicAtlasSystem::RestoreResources()
+{
+    RebuildAll();
+
+    // Pages are restored from their images without repacking
+    LockGuard<Mutex> lock(systemMutex);
+    for (std::shared_ptr<AtlasPage>& page : pages)
+    {
+        page->dirty = true;
+    }
+}
+
+void DynamicAtlasSystem::SetIncrementalPackingEnabled(bool enabled)
+{
+    incrementalPacking = enabled;
+}
+
+bool DynamicAtlasSystem::IsIncrementalPackingEnabled() const
+{
+    return incrementalPacking;
+}
+
+void DynamicAtlasSystem::SetPageSize(uint32 size)
+{
+    pageSize = size;
+}
+
+uint32 DynamicAtlasSystem::GetPageSize() const
+{
+    return pageSize;
+}
+
+void DynamicAtlasSystem::SetDefragmentationBudget(uint32 framesPerUpdate)
+{
+    defragmentationBudget = framesPerUpdate;
+}
+
+uint32 DynamicAtlasSystem::GetDefragmentationBudget() const
+{
+    return defragmentationBudget;
+}
+
+DynamicAtlasSystem::PagesStatistics DynamicAtlasSystem::GetPagesStatistics() const
+{
+    LockGuard<Mutex> lock(systemMutex);
+    PagesStatistics statistics = pagesStatistics;
+    statistics.pagesCount = static_cast<uint32>(pages.size());
+    statistics.regionsCount = static_cast<uint32>(pageRegions.size());
+    for (const std::shared_ptr<AtlasPage>& page : pages)
+    {
+        statistics.texturesMemory += page->image->dataSize;
+    }
+    return statistics;
+}
+
+RefPtr<Image> DynamicAtlasSystem::GetPageImage(const Texture* texture) const
+{
+    LockGuard<Mutex> lock(systemMutex);
+    for (const std::shared_ptr<AtlasPage>& page : pages)
+    {
+        if (page->texture.Get() == texture)
+        {
+            // Page image is modified by packing, so caller gets a snapshot
+            return RefPtr<Image>(page->image->Clone());
+        }
+    }
+    return RefPtr<Image>();
+}
+
+Sprite* DynamicAtlasSystem::CreateSpriteFromImage(Image* image, bool contentScaleIncluded)
+{
+    PixelFormat format = image->GetPixelFormat();
+    if (incrementalPacking == false || (format != FORMAT_RGBA8888 && format != FORMAT_RGB888))
+    {
+        return nullptr;
+    }
+
+    int64 startTime = SystemTimer::GetUs();
+
+    // Part of texture covered by sprite geometry is calculated in the same way as in `Sprite::InitFromTexture`
+    VirtualCoordinatesSystem* vcs = GetEngineContext()->uiControlSystem->vcs;
+    Vector2 size(static_cast<float32>(image->GetWidth()), static_cast<float32>(image->GetHeight()));
+    Vector2 virtualSize = contentScaleIncluded ? vcs->ConvertPhysicalToVirtual(size) : size;
+    Vector2 extent(vcs->ConvertVirtualToPhysicalX(virtualSize.x), vcs->ConvertVirtualToPhysicalY(virtualSize.y));
+    int32 regionWidth = Max(static_cast<int32>(image->GetWidth()), static_cast<int32>(std::ceil(extent.x)));
+    int32 regionHeight = Max(static_cast<int32>(image->GetHeight()), static_cast<int32>(std::ceil(extent.y)));
+
+    LockGuard<Mutex> lock(systemMutex);
+
+    Rect2i rect;
+    std::shared_ptr<AtlasPage> page = AllocatePageRect(regionWidth, regionHeight, rect);
+    if (page == nullptr)
+    {
+        return nullptr;
+    }
+
+    Sprite* sprite = Sprite::CreateFromTexture(page->texture.Get(), 0, 0, size.x, size.y, contentScaleIncluded);
+    sprite->inDynamicAtlas = true;
+
+    std::unique_ptr<PageRegion> region(new PageRegion());
+    region->sprite = sprite;
+    region->textureExtent = extent;
+    region->frames.resize(1);
+
+    PageFrame& frame = region->frames[0];
+    frame.region = region.get();
+    frame.page = page.get();
+    frame.rect = rect;
+    page->frames.push_back(&frame);
+    page->usedArea += frame.GetArea();
+    page->dirty = true;
+
+    UpdateRegionSprite(region.get());
+    pageRegions[sprite] = std::move(region);
+
+    ++page->pendingCompositions;
+    RefPtr<Image> source(SafeRetain(image));
+    DynamicAtlasSystemDetails::RunComposition([page, source, rect]() {
+        ScopedPtr<Image> rgbaImage(DynamicAtlasSystemDetails::GetRGBA8888Image(source.Get()));
+        if (rgbaImage)
+        {
+            page->image->InsertImage(rgbaImage, rect.x, rect.y, 0, 0, rgbaImage->GetWidth(), rgbaImage->GetHeight());
+        }
+        --page->pendingCompositions;
+    });
+
+    pagesStatistics.insertsCount++;
+    pagesStatistics.insertsTimeUs += SystemTimer::GetUs() - startTime;
+    return sprite;
+}
+
+bool DynamicAtlasSystem::AddSpriteToPages(Sprite* sprite)
+{
+    std::shared_ptr<AtlasRegion> sourceRegion(CreateRegionIfSpriteHasValidFormat(sprite));
+    if (sourceRegion == nullptr)
+    {
+        return false;
+    }
+
+    int64 startTime = SystemTimer::GetUs();
+
+    LockGuard<Mutex> lock(systemMutex);
+    if (sprite->inDynamicAtlas)
+    {
+        return false;
+    }
+
+    const Vector<Rect2i>& frameRects = sourceRegion->spriteDef->frameRects;
+    std::unique_ptr<PageRegion> region(new PageRegion());
+    region->sprite = sprite;
+    region->frames.resize(frameRects.size());
+
+    Vector<std::shared_ptr<AtlasPage>> framePages(frameRects.size());
+    for (size_t frameIdx = 0; frameIdx < frameRects.size(); ++frameIdx)
+    {
+        PageFrame& frame = region->frames[frameIdx];
+        frame.region = region.get();
+        framePages[frameIdx] = AllocatePageRect(frameRects[frameIdx].dx, frameRects[frameIdx].dy, frame.rect);
+        if (framePages[frameIdx] == nullptr)
+        {
+            RemovePageRegion(region.get());
+            return false;
+        }
+
+        frame.page = framePages[frameIdx].get();
+        frame.page->frames.push_back(&frame);
+        frame.page->usedArea += frame.GetArea();
+        frame.page->dirty = true;
+    }
+
+    sprite->inDynamicAtlas = true;
+    UpdateRegionSprite(region.get());
+
+    Vector<Rect2i> pageRects;
+    for (const PageFrame& frame : region->frames)
+    {
+        ++frame.page->pendingCompositions;
+        pageRects.push_back(frame.rect);
+    }
+    pageRegions[sprite] = std::move(region);
+
+    DynamicAtlasSystemDetails::RunComposition([sourceRegion, framePages, pageRects]() {
+        Vector<RefPtr<Image>> images;
+        for (std::shared_ptr<TextureDescriptor>& textureDescriptor : sourceRegion->textureDescriptors)
+        {
+            // Image can be nullptr. It will check later.
+            images.emplace_back(DynamicAtlasSystemDetails::LoadBaseMipImageForTexture(textureDescriptor));
+        }
+
+        const Vector<Rect2i>& frameRects = sourceRegion->spriteDef->frameRects;
+        for (size_t frameIdx = 0; frameIdx < frameRects.size(); ++frameIdx)
+        {
+            const Rect2i& frameRect = frameRects[frameIdx];
+            const Rect2i& pageRect = pageRects[frameIdx];
+            RefPtr<Image> image = images[sourceRegion->frameTextureIndex[frameIdx]];
+            if (image != nullptr)
+            {
+                framePages[frameIdx]->image->InsertImage(image.Get(), pageRect.x, pageRect.y, frameRect.x, frameRect.y, frameRect.dx, frameRect.dy);
+            }
+            else
+            {
+                image = RefPtr<Image>(Image::Create(frameRect.dx, frameRect.dy, FORMAT_RGBA8888));
+                image->MakePink(false);
+                framePages[frameIdx]->image->InsertImage(image.Get(), pageRect.x, pageRect.y, 0, 0, frameRect.dx, frameRect.dy);
+            }
+            --framePages[frameIdx]->pendingCompositions;
+        }
+    });
+
+    pagesStatistics.insertsCount++;
+    pagesStatistics.insertsTimeUs += SystemTimer::GetUs() - startTime;
+    return true;
+}
+
+std::shared_ptr<DynamicAtlasSystem::AtlasPage> DynamicAtlasSystem::AllocatePageRect(int32 width, int32 height, Rect2i& rect)
+{
+    const int32 margin = AtlasPage::MARGIN;
+    const int32 allocatedWidth = width + 2 * margin;
+    const int32 allocatedHeight = height + 2 * margin;
+
+    Rect2i allocatedRect;
+    for (std::shared_ptr<AtlasPage>& page : pages)
+    {
+        if (page.get() != evacuatingPage && page->packer.Insert(allocatedWidth, allocatedHeight, allocatedRect))
+        {
+            rect = Rect2i(allocatedRect.x + margin, allocatedRect.y + margin, width, height);
+            return page;
+        }
+    }
+
+    if (allocatedWidth > static_cast<int32>(pageSize) || allocatedHeight > static_cast<int32>(pageSize))
+    {
+        return nullptr;
+    }
+
+    auto page = std::make_shared<AtlasPage>();
+    page->image = RefPtr<Image>(Image::Create(pageSize, pageSize, PixelFormat::FORMAT_RGBA8888));
+    Memset(page->image->data, 0, page->image->dataSize);
+    page->texture = RefPtr<Texture>(Texture::CreateFromData({ page->image.Get() }));
+    page->texture->texDescriptor->pathname = Format("memoryfile_dynamic_atlas_%d", atlasCounter);
+    atlasCounter++;
+    page->packer.Reset(pageSize, pageSize);
+    pages.push_back(page);
+
+    bool inserted = page->packer.Insert(allocatedWidth, allocatedHeight, allocatedRect);
+    DVASSERT(inserted);
+    rect = Rect2i(allocatedRect.x + margin, allocatedRect.y + margin, width, height);
+    return page;
+}
+
+void DynamicAtlasSystem::UpdateRegionSprite(PageRegion* region)
+{
+    Sprite* sprite = region->sprite;
+    DVASSERT(static_cast<int32>(region->frames.size()) == sprite->frameCount);
+
+    // Build sprite textures index
+    Vector<Texture*> textures;
+    for (int32 frameIdx = 0; frameIdx < sprite->frameCount; frameIdx++)
+    {
+        Texture* texture = region->frames[frameIdx].page->texture.Get();
+        auto it = std::find(textures.begin(), textures.end(), texture);
+        sprite->frameTextureIndex[frameIdx] = static_cast<int32>(std::distance(textures.begin(), it));
+        if (it == textures.end())
+        {
+            textures.push_back(texture);
+        }
+    }
+
+    for (int32 textureIdx = 0; textureIdx < sprite->textureCount; textureIdx++)
+    {
+        SafeRelease(sprite->textures[textureIdx]);
+    }
+    SafeDeleteArray(sprite->textures);
+    sprite->textureCount = static_cast<int32>(textures.size());
+    sprite->textures = new Texture*[textures.size()];
+    for (size_t textureIdx = 0; textureIdx < textures.size(); textureIdx++)
+    {
+        sprite->textures[textureIdx] = SafeRetain(textures[textureIdx]);
+    }
+
+    // Update frames geometry
+    for (int32 frameIdx = 0; frameIdx < sprite->frameCount; frameIdx++)
+    {
+        const PageFrame& frame = region->frames[frameIdx];
+        if (sprite->type == Sprite::eSpriteType::SPRITE_FROM_FILE)
+        {
+            sprite->UpdateFrameGeometry(frame.rect.x, frame.rect.y, frameIdx);
+        }
+        else
+        {
+            float32 pageWidth = static_cast<float32>(frame.page->texture->width);
+            float32 pageHeight = static_cast<float32>(frame.page->texture->height);
+            float32 x = static_cast<float32>(frame.rect.x);
+            float32 y = static_cast<float32>(frame.rect.y);
+
+            sprite->rectsAndOffsets[frameIdx][Sprite::eRectsAndOffsets::X_POSITION_IN_TEXTURE] = x;
+            sprite->rectsAndOffsets[frameIdx][Sprite::eRectsAndOffsets::Y_POSITION_IN_TEXTURE] = y;
+
+            float32* texCoord = sprite->texCoords[frameIdx];
+            float32 textureX = x / pageWidth;
+            float32 textureDX = (x + region->textureExtent.x) / pageWidth;
+            float32 textureY = y / pageHeight;
+            float32 textureDY = (y + region->textureExtent.y) / pageHeight;
+            texCoord[0] = textureX;
+            texCoord[1] = textureY;
+            texCoord[2] = textureDX;
+            texCoord[3] = textureY;
+            texCoord[4] = textureX;
+            texCoord[5] = textureDY;
+            texCoord[6] = textureDX;
+            texCoord[7] = textureDY;
+        }
+    }
+}
+
+void DynamicAtlasSystem::RemovePageRegion(PageRegion* region)
+{
+    for (PageFrame& frame : region->frames)
+    {
+        AtlasPage* page = frame.page;
+        if (page != nullptr)
+        {
+            auto frameIt = std::find(page->frames.begin(), page->frames.end(), &frame);
+            DVASSERT(frameIt != page->frames.end());
+            page->frames.erase(frameIt);
+            page->usedArea -= frame.GetArea();
+            frame.page = nullptr;
+        }
+    }
+    region->sprite = nullptr;
+
+    ReleaseEmptyPages();
+}
+
+void DynamicAtlasSystem::ReleaseEmptyPages()
+{
+    // Page with pending compositions will be released on next update
+    auto it = std::remove_if(pages.begin(), pages.end(), [](const std::shared_ptr<AtlasPage>& page) {
+        return page->frames.empty() && page->pendingCompositions.Get() == 0;
+    });
+    for (auto releasedIt = it; releasedIt != pages.end(); ++releasedIt)
+    {
+        if (releasedIt->get() == evacuatingPage)
+        {
+            evacuatingPage = nullptr;
+        }
+    }
+    pages.erase(it, pages.end());
+}
+
+void DynamicAtlasSystem::DefragmentPages(Vector<PageRegion*>& movedRegions)
+{
+    if (evacuatingPage == nullptr)
+    {
+        if (pages.size() < 2)
+        {
+            return;
+        }
+
+        // Select the most sparse page, space of removed frames can't be reused until page is released
+        float32 minFillRate = DynamicAtlas::NEED_REBUILD_PERCENT / 100.f;
+        for (std::shared_ptr<AtlasPage>& page : pages)
+        {
+            uint64 occupiedArea = page->packer.GetOccupiedArea();
+            if (occupiedArea > 0 && page->frames.empty() == false)
+            {
+                float32 fillRate = static_cast<float32>(page->usedArea) / static_cast<float32>(occupiedArea);
+                if (fillRate < minFillRate)
+                {
+                    minFillRate = fillRate;
+                    evacuatingPage = page.get();
+                }
+            }
+        }
+
+        if (evacuatingPage == nullptr)
+        {
+            return;
+        }
+    }
+
+    // Frames are copied from page images, so all compositions should be finished
+    for (std::shared_ptr<AtlasPage>& page : pages)
+    {
+        if (page->pendingCompositions.Get() != 0)
+        {
+            return;
+        }
+    }
+
+    const int32 margin = AtlasPage::MARGIN;
+    for (uint32 moved = 0; moved < defragmentationBudget && evacuatingPage->frames.empty() == false; ++moved)
+    {
+        PageFrame* frame = evacuatingPage->frames.back();
+
+        Rect2i rect;
+        std::shared_ptr<AtlasPage> page = AllocatePageRect(frame->rect.dx, frame->rect.dy, rect);
+        if (page == nullptr)
+        {
+            break;
+        }
+
+        page->image->InsertImage(evacuatingPage->image.Get(), rect.x - margin, rect.y - margin,
+                                 frame->rect.x - margin, frame->rect.y - margin, frame->rect.dx + 2 * margin, frame->rect.dy + 2 * margin);
+
+        evacuatingPage->frames.pop_back();
+        evacuatingPage->usedArea -= frame->GetArea();
+
+        frame->page = page.get();
+        frame->rect = rect;
+        page->frames.push_back(frame);
+        page->usedArea += frame->GetArea();
+        page->dirty = true;
+
+        if (std::find(movedRegions.begin(), movedRegions.end(), frame->region) == movedRegions.end())
+        {
+            movedRegions.push_back(frame->region);
+        }
+        pagesStatistics.movedFramesCount++;
+    }
+}
+
+void DynamicAtlasSystem::UploadPages()
+{
+    for (std::shared_ptr<AtlasPage>& page : pages)
+    {
+        if (page->dirty && page->pendingCompositions.Get() == 0)
+        {
+            Image* image = page->image.Get();
+            page->texture->TexImage(0, image->width, image->height, image->data, image->dataSize, 0);
+            page->dirty = false;
+            pagesStatistics.uploadsCount++;
+        }
+    }
+
+    ReleaseEmptyPages();
+}
+
+void DynamicAtlasSystem::Update()
+{
+    LockGuard<Mutex> lock(systemMutex);
+    if (pages.empty())
+    {
+        return;
+    }
+
+    Vector<PageRegion*> movedRegions;
+    DefragmentPages(movedRegions);
+    for (PageRegion* region : movedRegions)
+    {
+        UpdateRegionSprite(region);
+    }
+
+    UploadPages();
+}
+
+void DynamicAtlasSystem::Flush()
+{
+    LockGuard<Mutex> lock(systemMutex);
+    for (std::shared_ptr<AtlasPage>& page : pages)
+    {
+        while (page->pendingCompositions.Get() != 0)
+        {
+            Thread::Yield();
+        }
+    }
+
+    UploadPages();
+}
+
 std::shared_ptr<DynamicAtlasSystem::AtlasRegion> DynamicAtlasSystem::CreateRegionIfSpriteHasValidFormat(Sprite* sprite) const
 {
     // Check format and load descriptors
@@ -642,6 +1187,34 @@ Image* LoadBaseMipImageForTexture(std::shared_ptr<TextureDescriptor>& texDescrip
     return image;
 }
 
+Image* GetRGBA8888Image(Image* image)
+{
+    if (image->format == FORMAT_RGBA8888)
+    {
+        return SafeRetain(image);
+    }
+
+    Image* newImage = Image::Create(image->width, image->height, FORMAT_RGBA8888);
+    if (ImageConvert::ConvertImage(image, newImage) == false)
+    {
+        SafeRelease(newImage);
+    }
+    return newImage;
+}
+
+void RunComposition(const Function<void()>& fn)
+{
+    JobManager* jobManager = GetEngineContext()->jobManager;
+    if (jobManager != nullptr)
+    {
+        jobManager->CreateWorkerJob(fn);
+    }
+    else
+    {
+        fn();
+    }
+}
+
 #ifdef DEBUG_DUMP_DYNAMIC_ATLASES
 
 void DumpAtlasImage(Image* image)
@@ -4,6 +4,7 @@
 #include "Base/RefPtr.h"
 #include "Concurrency/Mutex.h"
 #include "Math/RectanglePacker/RectanglePacker.h"
+#include "Math/RectanglePacker/SkylinePacker.h"
 
 namespace DAVA
 {
@@ -25,6 +26,13 @@ struct SpritesheetLayout;
  * Attention!!! 
  * You must not render 'isDynamicAtals' sprites loaded between 'BeginAtlas' and 'EndAtlas' calls, because textures will be null.
  * Not recommended to using for sprites with shared textures.
+ *
+ * Incremental mode (see `SetIncrementalPackingEnabled`) packs sprites at any time into separate atlas pages:
+ * file sprites loaded outside of 'BeginAtlas'/'EndAtlas' and sprites created by 'Sprite::CreateFromImage'.
+ * Regions are placed into free space of existing pages by skyline allocator, region pixels are composed into
+ * page image copy on worker threads and page textures are updated in `Update` call, so newly added sprite
+ * may be drawn empty for a frame. Space of removed regions is reclaimed by moving live regions from sparse
+ * pages to other pages, no more than `SetDefragmentationBudget` frames per `Update` call.
  */
 class DynamicAtlasSystem final
 {
@@ -52,9 +60,47 @@ public:
     uint32 GetRegionsCount() const;
     uint32 GetAtlasesCount() const;
 
+    /** Enable packing of sprites outside of 'BeginAtlas'/'EndAtlas' into atlas pages. Disabled by default. */
+    void SetIncrementalPackingEnabled(bool enabled);
+    bool IsIncrementalPackingEnabled() const;
+
+    /** Set size of new atlas pages. Default is `RectanglePacker::DEFAULT_TEXTURE_SIZE`. */
+    void SetPageSize(uint32 size);
+    uint32 GetPageSize() const;
+
+    /** Set max count of sprite frames moved to another page by defragmentation in one `Update` call. */
+    void SetDefragmentationBudget(uint32 framesPerUpdate);
+    uint32 GetDefragmentationBudget() const;
+
+    /** 
+     * Upload composed regions to page textures and make a step of page defragmentation.
+     * Called by engine every frame before drawing.
+     */
+    void Update();
+    /** Wait for all pending compositions and upload pages. */
+    void Flush();
+
+    struct PagesStatistics
+    {
+        uint32 pagesCount = 0;
+        uint32 regionsCount = 0;
+        uint32 texturesMemory = 0;
+        uint32 insertsCount = 0;
+        uint64 insertsTimeUs = 0;
+        uint32 uploadsCount = 0;
+        uint32 movedFramesCount = 0;
+    };
+    PagesStatistics GetPagesStatistics() const;
+
+    /** Return CPU copy of content of atlas page with specified texture, or nullptr if texture is not an atlas page. */
+    RefPtr<Image> GetPageImage(const Texture* texture) const;
+
 private:
     struct AtlasRegion;
     struct DynamicAtlas;
+    struct AtlasPage;
+    struct PageFrame;
+    struct PageRegion;
 
     enum AtlasSystemState
     {
@@ -89,6 +135,30 @@ private:
     /** Remove region form related atlases and remove empty atlases. */
     void RemoveRegionFromAllAtlases(std::shared_ptr<AtlasRegion>& region);
 
+    /** Create sprite from image in atlas page if incremental mode is enabled. Returns nullptr if image can't be packed. */
+    Sprite* CreateSpriteFromImage(Image* image, bool contentScaleIncluded);
+
+    /** Add file sprite to atlas pages. Returns 'true' if success. */
+    bool AddSpriteToPages(Sprite* sprite);
+
+    /** Find page with free space for rect with specified size and allocate it. New page is created if required. */
+    std::shared_ptr<AtlasPage> AllocatePageRect(int32 width, int32 height, Rect2i& rect);
+
+    /** Set textures and frames geometry of region sprite according to its place in pages. */
+    void UpdateRegionSprite(PageRegion* region);
+
+    /** Remove region frames from pages and release empty pages. */
+    void RemovePageRegion(PageRegion* region);
+    void ReleaseEmptyPages();
+
+    /** Move frames from sparse page to other pages. Fills regions which sprites should be updated. */
+    void DefragmentPages(Vector<PageRegion*>& movedRegions);
+
+    /** Upload dirty pages and release empty ones. */
+    void UploadPages();
+
+    void RestoreResources();
+
     volatile AtlasSystemState state = AtlasSystemState::IDLE;
     Vector<std::shared_ptr<DynamicAtlas>> atlases;
     Vector<std::shared_ptr<AtlasRegion>> regions;
@@ -100,11 +170,19 @@ private:
     bool needRebuild = false;
 
     uint64 linkedThreadId = 0; // Identifier of thread that calls DynamicAtlasSystem::BeginAtlas() method
-    Mutex systemMutex;
+    mutable Mutex systemMutex;
     int32 atlasCounter = 0;
 
     RectanglePacker rectanglePacker;
 
+    Vector<std::shared_ptr<AtlasPage>> pages;
+    UnorderedMap<Sprite*, std::unique_ptr<PageRegion>> pageRegions;
+    AtlasPage* evacuatingPage = nullptr;
+    PagesStatistics pagesStatistics;
+    uint32 pageSize = RectanglePacker::DEFAULT_TEXTURE_SIZE;
+    uint32 defragmentationBudget = 4;
+    bool incrementalPacking = false;
+
     friend class Sprite;
 };
 }
@@ -0,0 +1,371 @@
+#include "UnitTests/UnitTests.h"
+
+#include "Base/RefPtr.h"
+#include "Base/ScopedPtr.h"
+#include "Engine/Engine.h"
+#include "Logger/Logger.h"
+#include "Math/RectanglePacker/RectanglePacker.h"
+#include "Render/2D/Sprite.h"
+#include "Render/2D/Systems/DynamicAtlasSystem.h"
+#include "Render/2D/Systems/RenderSystem2D.h"
+#include "Render/Image/Image.h"
+#include "Render/Renderer.h"
+#include "Render/Texture.h"
+#include "Render/TextureDescriptor.h"
+#include "Time/SystemTimer.h"
+#include "Utils/StringUtils.h"
+
+using namespace DAVA;
+
+namespace DynamicAtlasSystemPagesTestDetails
+{
+Image* CreateColorImage(uint32 width, uint32 height, uint32 color)
+{
+    Image* image = Image::Create(width, height, FORMAT_RGBA8888);
+    uint32* pixels = reinterpret_cast<uint32*>(image->data);
+    for (uint32 i = 0; i < width * height; ++i)
+    {
+        pixels[i] = color;
+    }
+    return image;
+}
+
+RefPtr<Sprite> CreateColorSprite(uint32 width, uint32 height, uint32 color)
+{
+    ScopedPtr<Image> image(CreateColorImage(width, height, color));
+    return RefPtr<Sprite>(Sprite::CreateFromImage(image, true));
+}
+
+uint32 GetPixel(const Image* image, int32 x, int32 y)
+{
+    return reinterpret_cast<const uint32*>(image->data)[y * image->width + x];
+}
+
+Rect2i GetSpritePageRect(const Sprite* sprite, const Image* page)
+{
+    const float32* uv = sprite->GetTextureCoordsForFrame(0);
+    int32 x = static_cast<int32>(std::round(uv[0] * page->width));
+    int32 y = static_cast<int32>(std::round(uv[1] * page->height));
+    int32 dx = static_cast<int32>(std::round(uv[6] * page->width)) - x;
+    int32 dy = static_cast<int32>(std::round(uv[7] * page->height)) - y;
+    return Rect2i(x, y, dx, dy);
+}
+
+// Check that sprite UVs point to sprite pixels in its page
+bool CheckSprite(Sprite* sprite, uint32 width, uint32 height, uint32 color)
+{
+    DynamicAtlasSystem* dynamicAtlasSystem = GetEngineContext()->dynamicAtlasSystem;
+    RefPtr<Image> page = dynamicAtlasSystem->GetPageImage(sprite->GetTexture(0));
+    if (page == nullptr)
+    {
+        return false;
+    }
+
+    Rect2i rect = GetSpritePageRect(sprite, page.Get());
+    if (rect.x < 0 || rect.y < 0 || rect.dx != static_cast<int32>(width) || rect.dy != static_cast<int32>(height) ||
+        rect.x + rect.dx > static_cast<int32>(page->width) || rect.y + rect.dy > static_cast<int32>(page->height))
+    {
+        return false;
+    }
+
+    return GetPixel(page.Get(), rect.x, rect.y) == color &&
+    GetPixel(page.Get(), rect.x + rect.dx - 1, rect.y + rect.dy - 1) == color &&
+    GetPixel(page.Get(), rect.x + rect.dx / 2, rect.y + rect.dy / 2) == color;
+}
+
+bool CheckNoOverlapping(const Vector<RefPtr<Sprite>>& sprites)
+{
+    DynamicAtlasSystem* dynamicAtlasSystem = GetEngineContext()->dynamicAtlasSystem;
+    for (size_t i = 0; i < sprites.size(); ++i)
+    {
+        for (size_t j = i + 1; j < sprites.size(); ++j)
+        {
+            if (sprites[i] == nullptr || sprites[j] == nullptr || sprites[i]->GetTexture(0) != sprites[j]->GetTexture(0))
+            {
+                continue;
+            }
+
+            RefPtr<Image> page = dynamicAtlasSystem->GetPageImage(sprites[i]->GetTexture(0));
+            Rect2i intersection = GetSpritePageRect(sprites[i].Get(), page.Get()).Intersection(GetSpritePageRect(sprites[j].Get(), page.Get()));
+            if (intersection.dx > 0 && intersection.dy > 0)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+uint32 GetColor(uint32 index)
+{
+    return 0xff000000 | (index * 2654435761u & 0x00ffffff);
+}
+
+struct DrawStatistics
+{
+    uint32 drawCalls = 0;
+    uint32 batches = 0;
+};
+
+// Draw sprites in one frame on current render backend (Null one in console mode) and return 2D render stats of the frame
+DrawStatistics DrawSprites(const Vector<RefPtr<Sprite>>& sprites)
+{
+    RenderSystem2D* renderSystem2D = RenderSystem2D::Instance();
+    Renderer::BeginFrame();
+    Renderer::GetRenderStats().Reset();
+    renderSystem2D->BeginFrame();
+
+    SpriteDrawState drawState;
+    for (size_t i = 0; i < sprites.size(); ++i)
+    {
+        drawState.SetPosition(static_cast<float32>(i % 32) * 64.f, static_cast<float32>(i / 32) * 64.f);
+        renderSystem2D->Draw(sprites[i].Get(), &drawState, Color::White);
+    }
+
+    renderSystem2D->EndFrame();
+    DrawStatistics result;
+    result.drawCalls = Renderer::GetRenderStats().packets2d;
+    result.batches = Renderer::GetRenderStats().batches2d;
+    Renderer::EndFrame();
+    return result;
+}
+}
+
+DAVA_TESTCLASS (DynamicAtlasSystemPagesTest)
+{
+    const String SPRITE_MULTIFRAME = "~res:/TestData/DynamicAtlasSystemTest/WhiteList/Inner/sprite45_multiframe.txt";
+    const String SPRITE_LARGE_512_RGB = "~res:/TestData/DynamicAtlasSystemTest/LargeSprites/large_512_rgb888.txt";
+
+    DynamicAtlasSystemPagesTest()
+    {
+        DynamicAtlasSystem* dynamicAtlasSystem = GetEngineContext()->dynamicAtlasSystem;
+        dynamicAtlasSystem->SetIncrementalPackingEnabled(true);
+    }
+
+    ~DynamicAtlasSystemPagesTest()
+    {
+        DynamicAtlasSystem* dynamicAtlasSystem = GetEngineContext()->dynamicAtlasSystem;
+        dynamicAtlasSystem->SetIncrementalPackingEnabled(false);
+        dynamicAtlasSystem->SetPageSize(RectanglePacker::DEFAULT_TEXTURE_SIZE);
+        dynamicAtlasSystem->SetDefragmentationBudget(4);
+    }
+
+    DAVA_TEST (AddRemoveTest)
+    {
+        using namespace DynamicAtlasSystemPagesTestDetails;
+
+        DynamicAtlasSystem* dynamicAtlasSystem = GetEngineContext()->dynamicAtlasSystem;
+        dynamicAtlasSystem->SetPageSize(256);
+
+        const uint32 spritesCount = 40;
+        Vector<RefPtr<Sprite>> sprites;
+        for (uint32 i = 0; i < spritesCount; ++i)
+        {
+            sprites.push_back(CreateColorSprite(20 + i % 17, 10 + i % 23, GetColor(i)));
+        }
+        dynamicAtlasSystem->Flush();
+
+        DynamicAtlasSystem::PagesStatistics statistics = dynamicAtlasSystem->GetPagesStatistics();
+        TEST_VERIFY(statistics.regionsCount == spritesCount);
+        TEST_VERIFY(statistics.pagesCount == 1);
+        TEST_VERIFY(dynamicAtlasSystem->GetRegionsCount() == 0);
+        TEST_VERIFY(dynamicAtlasSystem->GetAtlasesCount() == 0);
+
+        for (uint32 i = 0; i < spritesCount; ++i)
+        {
+            TEST_VERIFY(sprites[i]->GetTexture(0) == sprites[0]->GetTexture(0));
+            TEST_VERIFY(CheckSprite(sprites[i].Get(), 20 + i % 17, 10 + i % 23, GetColor(i)));
+        }
+        TEST_VERIFY(CheckNoOverlapping(sprites));
+
+        // removing doesn't touch other sprites
+        for (uint32 i = 0; i < spritesCount; i += 3)
+        {
+            sprites[i] = nullptr;
+        }
+        TEST_VERIFY(dynamicAtlasSystem->GetPagesStatistics().regionsCount == spritesCount - 14);
+        for (uint32 i = 0; i < spritesCount; ++i)
+        {
+            if (sprites[i] != nullptr)
+            {
+                TEST_VERIFY(CheckSprite(sprites[i].Get(), 20 + i % 17, 10 + i % 23, GetColor(i)));
+            }
+        }
+
+        // new page is created when there is no free space
+        for (uint32 i = spritesCount; i < spritesCount + 20; ++i)
+        {
+            sprites.push_back(CreateColorSprite(60, 60, GetColor(i)));
+        }
+        dynamicAtlasSystem->Flush();
+        TEST_VERIFY(dynamicAtlasSystem->GetPagesStatistics().pagesCount > 1);
+        for (uint32 i = spritesCount; i < spritesCount + 20; ++i)
+        {
+            TEST_VERIFY(CheckSprite(sprites[i].Get(), 60, 60, GetColor(i)));
+        }
+        TEST_VERIFY(CheckNoOverlapping(sprites));
+
+        // too large image keeps own texture
+        RefPtr<Sprite> largeSprite = CreateColorSprite(300, 20, GetColor(0));
+        TEST_VERIFY(dynamicAtlasSystem->GetPageImage(largeSprite->GetTexture(0)) == nullptr);
+
+        sprites.clear();
+        statistics = dynamicAtlasSystem->GetPagesStatistics();
+        TEST_VERIFY(statistics.regionsCount == 0);
+        TEST_VERIFY(statistics.pagesCount == 0);
+        TEST_VERIFY(statistics.texturesMemory == 0);
+    }
+
+    DAVA_TEST (FileSpritesTest)
+    {
+        DynamicAtlasSystem* dynamicAtlasSystem = GetEngineContext()->dynamicAtlasSystem;
+        dynamicAtlasSystem->SetPageSize(RectanglePacker::DEFAULT_TEXTURE_SIZE);
+
+        RefPtr<Sprite> multiframe(Sprite::Create(SPRITE_MULTIFRAME));
+        RefPtr<Sprite> large(Sprite::Create(SPRITE_LARGE_512_RGB));
+        dynamicAtlasSystem->Flush();
+
+        TEST_VERIFY(dynamicAtlasSystem->GetPagesStatistics().regionsCount == 2);
+        TEST_VERIFY(dynamicAtlasSystem->GetRegionsCount() == 0);
+        TEST_VERIFY(multiframe->GetFrameCount() == 2);
+        TEST_VERIFY(multiframe->GetTexture(0) != nullptr);
+        TEST_VERIFY(multiframe->GetTexture(0) == multiframe->GetTexture(1));
+        TEST_VERIFY(multiframe->GetTexture(0) == large->GetTexture(0));
+        TEST_VERIFY(StringUtils::StartsWith(large->GetTexture(0)->texDescriptor->pathname.GetStringValue(), "memoryfile_dynamic_atlas_"));
+
+        // reloaded sprite is packed again
+        large->Reload();
+        dynamicAtlasSystem->Flush();
+        TEST_VERIFY(dynamicAtlasSystem->GetPagesStatistics().regionsCount == 2);
+        TEST_VERIFY(dynamicAtlasSystem->GetPageImage(large->GetTexture(0)) != nullptr);
+
+        multiframe = nullptr;
+        large = nullptr;
+        TEST_VERIFY(dynamicAtlasSystem->GetPagesStatistics().pagesCount == 0);
+    }
+
+    DAVA_TEST (DefragmentationTest)
+    {
+        using namespace DynamicAtlasSystemPagesTestDetails;
+
+        DynamicAtlasSystem* dynamicAtlasSystem = GetEngineContext()->dynamicAtlasSystem;
+        dynamicAtlasSystem->SetPageSize(128);
+        dynamicAtlasSystem->SetDefragmentationBudget(2);
+
+        // 30x30 sprites with margins fill 128x128 page exactly by 16 sprites
+        Vector<RefPtr<Sprite>> sprites;
+        for (uint32 i = 0; i < 32; ++i)
+        {
+            sprites.push_back(CreateColorSprite(30, 30, GetColor(i)));
+        }
+        dynamicAtlasSystem->Flush();
+        TEST_VERIFY(dynamicAtlasSystem->GetPagesStatistics().pagesCount == 2);
+
+        Texture* sparsePage = sprites[0]->GetTexture(0);
+        for (uint32 i = 0; i < 12; ++i)
+        {
+            TEST_VERIFY(sprites[i]->GetTexture(0) == sparsePage);
+            sprites[i] = nullptr;
+        }
+        TEST_VERIFY(dynamicAtlasSystem->GetPagesStatistics().pagesCount == 2);
+
+        auto checkAll = [&sprites]() {
+            for (uint32 i = 0; i < sprites.size(); ++i)
+            {
+                if (sprites[i] != nullptr)
+                {
+                    TEST_VERIFY(CheckSprite(sprites[i].Get(), 30, 30, GetColor(i)));
+                }
+            }
+            TEST_VERIFY(CheckNoOverlapping(sprites));
+        };
+
+        // defragmentation moves no more than budget frames per update
+        uint32 movedFrames = dynamicAtlasSystem->GetPagesStatistics().movedFramesCount;
+        dynamicAtlasSystem->Update();
+        TEST_VERIFY(dynamicAtlasSystem->GetPagesStatistics().movedFramesCount == movedFrames + 2);
+        TEST_VERIFY(dynamicAtlasSystem->GetPagesStatistics().pagesCount == 3);
+        checkAll();
+
+        dynamicAtlasSystem->Update();
+        TEST_VERIFY(dynamicAtlasSystem->GetPagesStatistics().movedFramesCount == movedFrames + 4);
+        TEST_VERIFY(dynamicAtlasSystem->GetPagesStatistics().pagesCount == 2);
+        checkAll();
+        for (uint32 i = 12; i < 16; ++i)
+        {
+            TEST_VERIFY(sprites[i]->GetTexture(0) != sparsePage);
+        }
+
+        // nothing to do for dense pages
+        dynamicAtlasSystem->Update();
+        TEST_VERIFY(dynamicAtlasSystem->GetPagesStatistics().movedFramesCount == movedFrames + 4);
+        checkAll();
+
+        sprites.clear();
+        TEST_VERIFY(dynamicAtlasSystem->GetPagesStatistics().pagesCount == 0);
+    }
+
+    DAVA_TEST (RuntimeSpritesBenchmark)
+    {
+        using namespace DynamicAtlasSystemPagesTestDetails;
+
+        const uint32 spritesCount = 500;
+        DynamicAtlasSystem* dynamicAtlasSystem = GetEngineContext()->dynamicAtlasSystem;
+        dynamicAtlasSystem->SetPageSize(1024);
+
+        Vector<RefPtr<Image>> images;
+        for (uint32 i = 0; i < spritesCount; ++i)
+        {
+            images.emplace_back(CreateColorImage(32 + (i * 7) % 33, 32 + (i * 13) % 33, GetColor(i)));
+        }
+
+        auto createSprites = [&images](Vector<RefPtr<Sprite>>& sprites) {
+            int64 startTime = SystemTimer::GetUs();
+            for (RefPtr<Image>& image : images)
+            {
+                sprites.emplace_back(Sprite::CreateFromImage(image.Get(), true));
+            }
+            GetEngineContext()->dynamicAtlasSystem->Flush();
+            return SystemTimer::GetUs() - startTime;
+        };
+
+        dynamicAtlasSystem->SetIncrementalPackingEnabled(false);
+        Vector<RefPtr<Sprite>> ownTextureSprites;
+        int64 ownTextureTime = createSprites(ownTextureSprites);
+        uint32 ownTexturesMemory = 0;
+        for (RefPtr<Sprite>& sprite : ownTextureSprites)
+        {
+            ownTexturesMemory += sprite->GetTexture(0)->GetDataSize();
+        }
+
+        dynamicAtlasSystem->SetIncrementalPackingEnabled(true);
+        DynamicAtlasSystem::PagesStatistics before = dynamicAtlasSystem->GetPagesStatistics();
+        Vector<RefPtr<Sprite>> atlasSprites;
+        int64 atlasTime = createSprites(atlasSprites);
+        DynamicAtlasSystem::PagesStatistics after = dynamicAtlasSystem->GetPagesStatistics();
+
+        TEST_VERIFY(after.regionsCount == spritesCount);
+        for (uint32 i = 0; i < spritesCount; ++i)
+        {
+            TEST_VERIFY(CheckSprite(atlasSprites[i].Get(), images[i]->width, images[i]->height, GetColor(i)));
+        }
+
+        DrawStatistics ownTextureDraw = DrawSprites(ownTextureSprites);
+        DrawStatistics atlasDraw = DrawSprites(atlasSprites);
+
+        uint32 atlasInserts = after.insertsCount - before.insertsCount;
+        uint64 atlasInsertsTime = after.insertsTimeUs - before.insertsTimeUs;
+        Logger::Info("DynamicAtlasSystem benchmark (%u runtime sprites): own textures %u draw calls %u batches %u textures %u bytes %.2f us per sprite, "
+                     "atlas pages %u draw calls %u batches %u pages %u bytes %.2f us per insert (%.2f us per sprite with composition and upload)",
+                     spritesCount,
+                     ownTextureDraw.drawCalls, ownTextureDraw.batches, spritesCount, ownTexturesMemory, static_cast<float64>(ownTextureTime) / spritesCount,
+                     atlasDraw.drawCalls, atlasDraw.batches, after.pagesCount, after.texturesMemory,
+                     static_cast<float64>(atlasInsertsTime) / Max(atlasInserts, 1u), static_cast<float64>(atlasTime) / spritesCount);
+
+#if defined(__DAVAENGINE_RENDERSTATS__)
+        // same sprites are drawn, but batches with the same page texture are merged into one draw call
+        TEST_VERIFY(atlasDraw.batches == ownTextureDraw.batches);
+        TEST_VERIFY(atlasDraw.drawCalls < ownTextureDraw.drawCalls);
+#endif
+    }
+};
@@ -133,6 +133,12 @@ public:
         return needCalculateCacheParams;
     }
 
+    /**
+        Calculate text layout (BiDi reordering, line breaks, splitting and metrics) if it is outdated.
+        Different text blocks can be processed from several threads simultaneously.
+    */
+    void CalculateCacheParamsIfNeed();
+
 private:
     static void RegisterTextBlock(TextBlock* textBlock);
     static void UnregisterTextBlock(TextBlock* textBlock);
@@ -146,7 +152,6 @@ private:
     void PrepareInternal();
 
     void CalculateCacheParams();
-    void CalculateCacheParamsIfNeed();
 
     void SetFontInternal(Font* _font);
 
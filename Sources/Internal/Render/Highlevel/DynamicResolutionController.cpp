@@ -0,0 +1,105 @@
+#include "Render/Highlevel/DynamicResolutionController.h"
+
+#include "Debug/DVAssert.h"
+#include "Math/MathHelpers.h"
+
+namespace DAVA
+{
+DynamicResolutionController::DynamicResolutionController()
+{
+    SetSettings(Settings());
+}
+
+void DynamicResolutionController::SetSettings(const Settings& settings_)
+{
+    DVASSERT(settings_.minScale > 0.0f && settings_.minScale <= settings_.maxScale);
+    DVASSERT(settings_.upscaleThreshold <= settings_.downscaleThreshold);
+
+    settings = settings_;
+    settings.downscaleFrames = std::max(settings.downscaleFrames, 1u);
+    settings.upscaleFrames = std::max(settings.upscaleFrames, 1u);
+    history.assign(std::max(settings.downscaleFrames, settings.upscaleFrames), 0.0f);
+    historyHead = 0;
+    historyCount = 0;
+    scale = Clamp(scale, settings.minScale, settings.maxScale);
+}
+
+bool DynamicResolutionController::AddFrameTime(float32 frameTime, float32 gpuFrameTime)
+{
+    history[historyHead] = (gpuFrameTime > 0.0f) ? gpuFrameTime : frameTime;
+    historyHead = (historyHead + 1) % history.size();
+    historyCount = std::min(historyCount + 1, static_cast<uint32>(history.size()));
+
+    float32 oldScale = scale;
+    float32 aimTime = settings.targetFrameTime * (settings.downscaleThreshold + settings.upscaleThreshold) * 0.5f;
+
+    if (scale > settings.minScale && historyCount >= settings.downscaleFrames)
+    {
+        float32 averageTime = GetAverageTime(settings.downscaleFrames);
+        if (averageTime > settings.targetFrameTime * settings.downscaleThreshold)
+        {
+            float32 newScale = scale - settings.scaleStep;
+            if (settings.stepPolicy == StepPolicy::PROPORTIONAL)
+            {
+                newScale = Clamp(scale * std::sqrt(aimTime / averageTime), newScale, scale);
+            }
+            SetScale(newScale);
+        }
+    }
+
+    if (scale == oldScale && scale < settings.maxScale && historyCount >= settings.upscaleFrames)
+    {
+        float32 averageTime = GetAverageTime(settings.upscaleFrames);
+        if (averageTime < settings.targetFrameTime * settings.upscaleThreshold)
+        {
+            float32 newScale = scale + settings.scaleStep;
+            if (settings.stepPolicy == StepPolicy::PROPORTIONAL && averageTime > 0.0f)
+            {
+                newScale = Clamp(scale * std::sqrt(aimTime / averageTime), scale, newScale);
+            }
+            SetScale(newScale);
+        }
+    }
+
+    return scale != oldScale;
+}
+
+void DynamicResolutionController::Reset()
+{
+    scale = settings.maxScale;
+    historyHead = 0;
+    historyCount = 0;
+}
+
+Vector2 DynamicResolutionController::GetScaledSize(const Vector2& nativeSize) const
+{
+    return Vector2(std::max(std::round(nativeSize.dx * scale), 1.0f), std::max(std::round(nativeSize.dy * scale), 1.0f));
+}
+
+float32 DynamicResolutionController::GetAverageTime(uint32 framesCount) const
+{
+    DVASSERT(framesCount > 0 && framesCount <= historyCount);
+
+    uint32 size = static_cast<uint32>(history.size());
+    float32 sum = 0.0f;
+    for (uint32 i = 1; i <= framesCount; ++i)
+    {
+        sum += history[(historyHead + size - i) % size];
+    }
+    return sum / static_cast<float32>(framesCount);
+}
+
+void DynamicResolutionController::SetScale(float32 newScale)
+{
+    newScale = Clamp(newScale, settings.minScale, settings.maxScale);
+    if (newScale == scale)
+        return;
+
+    scale = newScale;
+    ++scaleChangesCount;
+
+    // frames rendered with previous scale should not affect next decision
+    historyHead = 0;
+    historyCount = 0;
+}
+}
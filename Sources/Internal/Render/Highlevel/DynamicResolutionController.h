@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Base/BaseTypes.h"
+#include "Math/Vector.h"
+
+namespace DAVA
+{
+/**
+    Chooses resolution scale of 3D rendering from frame time history.
+
+    Each frame `AddFrameTime` is called with frame duration. Scale goes down when average time of last
+    `downscaleFrames` frames exceeds `targetFrameTime * downscaleThreshold` and goes up when average of last
+    `upscaleFrames` frames is below `targetFrameTime * upscaleThreshold`. History is cleared after each change,
+    so result of previous change is always measured before next one. Rendering cost is assumed to be
+    proportional to pixels count, i.e. to squared scale.
+
+    Controller does no rendering itself, see `UI3DView::SetDynamicResolutionEnabled`.
+*/
+class DynamicResolutionController
+{
+public:
+    enum class StepPolicy : uint8
+    {
+        FIXED, ///< scale is changed by `scaleStep`
+        PROPORTIONAL ///< scale is changed to bring frame time to the middle of thresholds band, by `scaleStep` at most
+    };
+
+    struct Settings
+    {
+        float32 targetFrameTime = 1.0f / 60.0f;
+        float32 minScale = 0.6f;
+        float32 maxScale = 1.0f;
+        float32 scaleStep = 0.1f;
+        StepPolicy stepPolicy = StepPolicy::PROPORTIONAL;
+        float32 downscaleThreshold = 1.05f;
+        float32 upscaleThreshold = 0.8f;
+        uint32 downscaleFrames = 10;
+        uint32 upscaleFrames = 60;
+    };
+
+    DynamicResolutionController();
+
+    void SetSettings(const Settings& settings);
+    const Settings& GetSettings() const;
+
+    /**
+        Adds frame to history and updates scale. `gpuFrameTime` is GPU time of the frame if it is known
+        (e.g. from ProfilerGPU), it is preferred over `frameTime` as it does not include vsync and CPU waits.
+        Returns true if scale was changed.
+    */
+    bool AddFrameTime(float32 frameTime, float32 gpuFrameTime = 0.0f);
+
+    /** Sets scale to `maxScale` and clears history. */
+    void Reset();
+
+    float32 GetScale() const;
+    uint32 GetScaleChangesCount() const;
+
+    /** Returns `nativeSize` multiplied by current scale, rounded to whole pixels. */
+    Vector2 GetScaledSize(const Vector2& nativeSize) const;
+
+private:
+    float32 GetAverageTime(uint32 framesCount) const;
+    void SetScale(float32 newScale);
+
+    Settings settings;
+    float32 scale = 1.0f;
+    uint32 scaleChangesCount = 0;
+
+    Vector<float32> history; // ring buffer of max(downscaleFrames, upscaleFrames) frames
+    uint32 historyHead = 0;
+    uint32 historyCount = 0;
+};
+
+inline const DynamicResolutionController::Settings& DynamicResolutionController::GetSettings() const
+{
+    return settings;
+}
+
+inline float32 DynamicResolutionController::GetScale() const
+{
+    return scale;
+}
+
+inline uint32 DynamicResolutionController::GetScaleChangesCount() const
+{
+    return scaleChangesCount;
+}
+}
@@ -0,0 +1,193 @@
+#include "Render/Highlevel/MergedMeshRenderObject.h"
+#include "Render/Highlevel/RenderBatch.h"
+#include "Render/Highlevel/Camera.h"
+#include "Render/Highlevel/Frustum.h"
+#include "FileSystem/KeyedArchive.h"
+#include "Engine/Engine.h"
+
+#include <algorithm>
+
+namespace DAVA
+{
+namespace MergedMeshDetails
+{
+struct SerializedRange
+{
+    float32 bboxMin[3];
+    float32 bboxMax[3];
+    uint32 startIndex;
+    uint32 indexCount;
+    uint32 sourceEntityId;
+};
+}
+
+MergedMeshRenderObject::MergedMeshRenderObject()
+{
+    flags |= RenderObject::eFlags::CUSTOM_PREPARE_TO_RENDER;
+}
+
+void MergedMeshRenderObject::SetSubRanges(uint32 batchIndex, const Vector<SubRange>& ranges)
+{
+    if (subRanges.size() <= batchIndex)
+    {
+        subRanges.resize(batchIndex + 1);
+    }
+    subRanges[batchIndex] = ranges;
+}
+
+const Vector<MergedMeshRenderObject::SubRange>& MergedMeshRenderObject::GetSubRanges(uint32 batchIndex) const
+{
+    static const Vector<SubRange> emptyRanges;
+    return (batchIndex < subRanges.size()) ? subRanges[batchIndex] : emptyRanges;
+}
+
+const MergedMeshRenderObject::SubRange* MergedMeshRenderObject::FindSubRange(uint32 batchIndex, uint32 index) const
+{
+    const Vector<SubRange>& ranges = GetSubRanges(batchIndex);
+    auto it = std::upper_bound(ranges.begin(), ranges.end(), index, [](uint32 i, const SubRange& range) { return i < range.startIndex; });
+    if (it == ranges.begin())
+        return nullptr;
+
+    --it;
+    return (index < it->startIndex + it->indexCount) ? &(*it) : nullptr;
+}
+
+void MergedMeshRenderObject::PrepareToRender(Camera* camera)
+{
+    Frustum* frustum = camera->GetFrustum();
+    const Matrix4& transform = (worldTransform != nullptr) ? *worldTransform : Matrix4::IDENTITY;
+
+    // Draw range is stored in the shared batch, so ranges of all cameras rendering this frame are united.
+    uint32 frameIndex = Engine::Instance()->GetGlobalFrameIndex();
+    bool uniteWithPrepared = (preparedCamera != nullptr && preparedCamera != camera && preparedFrameIndex == frameIndex);
+    preparedCamera = camera;
+    preparedFrameIndex = frameIndex;
+
+    uint32 batchCount = Min(static_cast<uint32>(subRanges.size()), GetRenderBatchCount());
+    for (uint32 i = 0; i < batchCount; ++i)
+    {
+        const Vector<SubRange>& ranges = subRanges[i];
+        if (ranges.empty())
+            continue;
+
+        size_t first = ranges.size();
+        size_t last = 0;
+        for (size_t r = 0, count = ranges.size(); r < count; ++r)
+        {
+            AABBox3 worldBox;
+            ranges[r].bbox.GetTransformedBox(transform, worldBox);
+            if (frustum->IsInside(worldBox))
+            {
+                first = Min(first, r);
+                last = r;
+            }
+        }
+
+        // Batch passed coarse clipping, so at least something should be drawn.
+        if (first == ranges.size())
+        {
+            first = last = 0;
+        }
+
+        uint32 startIndex = ranges[first].startIndex;
+        uint32 endIndex = ranges[last].startIndex + ranges[last].indexCount;
+
+        RenderBatch* batch = renderBatchArray[i].renderBatch;
+        if (uniteWithPrepared && batch->drawIndexRange)
+        {
+            endIndex = Max(endIndex, batch->startIndex + batch->indexCount);
+            startIndex = Min(startIndex, batch->startIndex);
+        }
+
+        batch->drawIndexRange = true;
+        batch->startIndex = startIndex;
+        batch->indexCount = endIndex - startIndex;
+    }
+}
+
+RenderObject* MergedMeshRenderObject::Clone(RenderObject* newObject)
+{
+    if (newObject == nullptr)
+    {
+        DVASSERT(IsPointerToExactClass<MergedMeshRenderObject>(this), "Can clone only MergedMeshRenderObject");
+        newObject = new MergedMeshRenderObject();
+    }
+
+    Mesh::Clone(newObject);
+    static_cast<MergedMeshRenderObject*>(newObject)->subRanges = subRanges;
+
+    return newObject;
+}
+
+void MergedMeshRenderObject::Save(KeyedArchive* archive, SerializationContext* serializationContext)
+{
+    Mesh::Save(archive, serializationContext);
+
+    uint32 batchCount = static_cast<uint32>(subRanges.size());
+    archive->SetUInt32("mergedmesh.batchCount", batchCount);
+    for (uint32 i = 0; i < batchCount; ++i)
+    {
+        Vector<MergedMeshDetails::SerializedRange> data(subRanges[i].size());
+        for (size_t r = 0, count = data.size(); r < count; ++r)
+        {
+            const SubRange& range = subRanges[i][r];
+            MergedMeshDetails::SerializedRange& out = data[r];
+            Memcpy(out.bboxMin, range.bbox.min.data, sizeof(out.bboxMin));
+            Memcpy(out.bboxMax, range.bbox.max.data, sizeof(out.bboxMax));
+            out.startIndex = range.startIndex;
+            out.indexCount = range.indexCount;
+            out.sourceEntityId = range.sourceEntityId;
+        }
+
+        String key = Format("mergedmesh.rb%u.ranges", i);
+        archive->SetByteArray(key, reinterpret_cast<const uint8*>(data.data()), static_cast<int32>(data.size() * sizeof(MergedMeshDetails::SerializedRange)));
+    }
+}
+
+void MergedMeshRenderObject::Load(KeyedArchive* archive, SerializationContext* serializationContext)
+{
+    Mesh::Load(archive, serializationContext);
+
+    uint32 batchCount = archive->GetUInt32("mergedmesh.batchCount");
+    subRanges.clear();
+    subRanges.resize(batchCount);
+    for (uint32 i = 0; i < batchCount; ++i)
+    {
+        String key = Format("mergedmesh.rb%u.ranges", i);
+        int32 size = archive->GetByteArraySize(key);
+        const uint8* bytes = archive->GetByteArray(key);
+        if (bytes == nullptr || size <= 0)
+            continue;
+
+        uint32 count = static_cast<uint32>(size) / sizeof(MergedMeshDetails::SerializedRange);
+        Vector<MergedMeshDetails::SerializedRange> data(count);
+        Memcpy(data.data(), bytes, count * sizeof(MergedMeshDetails::SerializedRange));
+
+        Vector<SubRange>& ranges = subRanges[i];
+        ranges.resize(count);
+        for (uint32 r = 0; r < count; ++r)
+        {
+            ranges[r].bbox.min = Vector3(data[r].bboxMin);
+            ranges[r].bbox.max = Vector3(data[r].bboxMax);
+            ranges[r].startIndex = data[r].startIndex;
+            ranges[r].indexCount = data[r].indexCount;
+            ranges[r].sourceEntityId = data[r].sourceEntityId;
+        }
+    }
+}
+
+void MergedMeshRenderObject::BakeGeometry(const Matrix4& transform)
+{
+    Mesh::BakeGeometry(transform);
+
+    for (Vector<SubRange>& ranges : subRanges)
+    {
+        for (SubRange& range : ranges)
+        {
+            AABBox3 transformed;
+            range.bbox.GetTransformedBox(transform, transformed);
+            range.bbox = transformed;
+        }
+    }
+}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Render/Highlevel/Mesh.h"
+
+namespace DAVA
+{
+/**
+    Mesh built from several static meshes merged at export time (see StaticMeshMerger).
+    Each render batch keeps the list of index sub-ranges of its source meshes in order of
+    placement in the polygon group. Before rendering, sub-ranges are tested against the camera
+    frustum and the batch draws only the contiguous index span covering the visible ones.
+    Batches are shared by all cameras, so if several cameras prepare the object within one frame
+    the batch draws the span covering sub-ranges visible from any of them.
+*/
+class MergedMeshRenderObject : public Mesh
+{
+public:
+    struct SubRange
+    {
+        AABBox3 bbox;
+        uint32 startIndex = 0;
+        uint32 indexCount = 0;
+        uint32 sourceEntityId = 0; //!< Entity::GetID() of merged source entity
+    };
+
+    MergedMeshRenderObject();
+
+    void SetSubRanges(uint32 batchIndex, const Vector<SubRange>& ranges);
+    const Vector<SubRange>& GetSubRanges(uint32 batchIndex) const;
+
+    /** Return sub-range containing `index` of polygon group of batch `batchIndex`, e.g. to find source entity of picked triangle. */
+    const SubRange* FindSubRange(uint32 batchIndex, uint32 index) const;
+
+    void PrepareToRender(Camera* camera) override;
+
+    RenderObject* Clone(RenderObject* newObject) override;
+    void Save(KeyedArchive* archive, SerializationContext* serializationContext) override;
+    void Load(KeyedArchive* archive, SerializationContext* serializationContext) override;
+
+    void BakeGeometry(const Matrix4& transform) override;
+
+private:
+    Vector<Vector<SubRange>> subRanges;
+    Camera* preparedCamera = nullptr;
+    uint32 preparedFrameIndex = 0;
+};
+}
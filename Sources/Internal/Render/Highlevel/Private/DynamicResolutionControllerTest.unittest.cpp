@@ -0,0 +1,147 @@
+#include "UnitTests/UnitTests.h"
+
+#include "Base/BaseTypes.h"
+#include "Logger/Logger.h"
+#include "Render/Highlevel/DynamicResolutionController.h"
+
+using namespace DAVA;
+
+namespace DynamicResolutionControllerTestDetails
+{
+const float32 TARGET_FRAME_TIME = 1.f / 60.f;
+
+// Synthetic fill-rate limited load: fixed CPU part plus GPU part proportional to pixels count
+struct LoadModel
+{
+    float32 fixedTime = 0.004f;
+    float32 fullResolutionTime = 0.02f;
+
+    float32 GetFrameTime(float32 scale) const
+    {
+        return fixedTime + fullResolutionTime * scale * scale;
+    }
+};
+
+// Return number of scale changes made during last `tailFrames` frames
+uint32 RunFrames(DynamicResolutionController& controller, const LoadModel& load, uint32 framesCount, uint32 tailFrames)
+{
+    uint32 tailChanges = 0;
+    for (uint32 frame = 0; frame < framesCount; ++frame)
+    {
+        bool changed = controller.AddFrameTime(load.GetFrameTime(controller.GetScale()));
+        if (changed && frame + tailFrames >= framesCount)
+        {
+            ++tailChanges;
+        }
+    }
+    return tailChanges;
+}
+}
+
+DAVA_TESTCLASS (DynamicResolutionControllerTest)
+{
+    DAVA_TEST (ConvergenceTest)
+    {
+        using namespace DynamicResolutionControllerTestDetails;
+
+        DynamicResolutionController controller;
+        TEST_VERIFY(controller.GetScale() == 1.f);
+
+        // full resolution takes 24 ms, target band is [13.3, 17.5] ms which is reached at scale about 0.8
+        LoadModel load;
+        uint32 tailChanges = RunFrames(controller, load, 600, 300);
+
+        float32 frameTime = load.GetFrameTime(controller.GetScale());
+        TEST_VERIFY(frameTime <= TARGET_FRAME_TIME * controller.GetSettings().downscaleThreshold);
+        TEST_VERIFY(frameTime >= TARGET_FRAME_TIME * controller.GetSettings().upscaleThreshold);
+        TEST_VERIFY(controller.GetScale() > 0.7f && controller.GetScale() < 0.85f);
+
+        // stable: no oscillation once band is reached
+        TEST_VERIFY(tailChanges == 0);
+        TEST_VERIFY(controller.GetScaleChangesCount() <= 4);
+
+        Logger::Info("DynamicResolutionController converged to scale %.3f (%.2f ms) with %u changes",
+                     controller.GetScale(), frameTime * 1000.f, controller.GetScaleChangesCount());
+    }
+
+    DAVA_TEST (RecoveryTest)
+    {
+        using namespace DynamicResolutionControllerTestDetails;
+
+        DynamicResolutionController controller;
+        LoadModel heavyLoad;
+        RunFrames(controller, heavyLoad, 300, 0);
+        TEST_VERIFY(controller.GetScale() < 1.f);
+
+        // load is gone, scale should get back to maximum and stay there
+        LoadModel lightLoad;
+        lightLoad.fullResolutionTime = 0.006f;
+        uint32 tailChanges = RunFrames(controller, lightLoad, 600, 200);
+        TEST_VERIFY(controller.GetScale() == controller.GetSettings().maxScale);
+        TEST_VERIFY(tailChanges == 0);
+    }
+
+    DAVA_TEST (HysteresisTest)
+    {
+        using namespace DynamicResolutionControllerTestDetails;
+
+        DynamicResolutionController controller;
+
+        // single spikes are averaged out
+        for (uint32 frame = 0; frame < 300; ++frame)
+        {
+            controller.AddFrameTime((frame % 30 == 0) ? TARGET_FRAME_TIME * 2.f : TARGET_FRAME_TIME * 0.85f);
+        }
+        TEST_VERIFY(controller.GetScale() == 1.f);
+        TEST_VERIFY(controller.GetScaleChangesCount() == 0);
+
+        // frame time inside thresholds band does not change scale in any direction
+        DynamicResolutionController::Settings settings;
+        settings.minScale = 0.5f;
+        controller.SetSettings(settings);
+        LoadModel load;
+        load.fixedTime = 0.f;
+        load.fullResolutionTime = TARGET_FRAME_TIME * 0.9f / (0.7f * 0.7f);
+        RunFrames(controller, load, 300, 0);
+        uint32 changesCount = controller.GetScaleChangesCount();
+        float32 scale = controller.GetScale();
+        RunFrames(controller, load, 600, 0);
+        TEST_VERIFY(controller.GetScaleChangesCount() == changesCount);
+        TEST_VERIFY(controller.GetScale() == scale);
+    }
+
+    DAVA_TEST (BoundsAndStepPolicyTest)
+    {
+        using namespace DynamicResolutionControllerTestDetails;
+
+        DynamicResolutionController::Settings settings;
+        settings.minScale = 0.5f;
+        settings.scaleStep = 0.05f;
+        settings.stepPolicy = DynamicResolutionController::StepPolicy::FIXED;
+
+        DynamicResolutionController controller;
+        controller.SetSettings(settings);
+
+        // unreachable target: scale goes down by fixed steps and stops at minimum
+        LoadModel load;
+        load.fixedTime = TARGET_FRAME_TIME * 2.f;
+        float32 prevScale = controller.GetScale();
+        for (uint32 frame = 0; frame < 1000; ++frame)
+        {
+            if (controller.AddFrameTime(load.GetFrameTime(controller.GetScale())))
+            {
+                float32 step = prevScale - controller.GetScale();
+                TEST_VERIFY(step > 0.f && step <= settings.scaleStep + 1e-5f);
+                prevScale = controller.GetScale();
+            }
+        }
+        TEST_VERIFY(controller.GetScale() == settings.minScale);
+        TEST_VERIFY(controller.GetScaleChangesCount() >= 10);
+
+        Vector2 size = controller.GetScaledSize(Vector2(1920.f, 1080.f));
+        TEST_VERIFY(size == Vector2(960.f, 540.f));
+
+        controller.Reset();
+        TEST_VERIFY(controller.GetScale() == settings.maxScale);
+    }
+};
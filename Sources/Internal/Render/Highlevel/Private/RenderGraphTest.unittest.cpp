@@ -0,0 +1,200 @@
+#include "UnitTests/UnitTests.h"
+
+#include "Base/BaseTypes.h"
+#include "Logger/Logger.h"
+#include "Render/Highlevel/RenderGraph.h"
+#include "Render/RenderBase.h"
+
+using namespace DAVA;
+
+namespace RenderGraphTestDetails
+{
+const int32 BASE_PRIORITY = PRIORITY_MAIN_3D;
+
+struct ExecutionLog
+{
+    Vector<FastName> passes;
+    Vector<int32> priorities;
+    bool allTargetsValid = true;
+};
+
+void AddPass(RenderGraph& graph, ExecutionLog& log, const char* name, const Vector<FastName>& reads, const Vector<FastName>& writes, bool hasSideEffects = false)
+{
+    RenderGraph::PassDescriptor pass;
+    pass.name = FastName(name);
+    pass.reads = reads;
+    pass.writes = writes;
+    pass.hasSideEffects = hasSideEffects;
+    pass.execute = [&log, pass](const RenderGraph& graph, int32 priority) {
+        for (const Vector<FastName>* names : { &pass.reads, &pass.writes })
+        {
+            for (const FastName& target : *names)
+            {
+                log.allTargetsValid = log.allTargetsValid && graph.GetTexture(target).IsValid();
+            }
+        }
+        log.passes.push_back(pass.name);
+        log.priorities.push_back(priority);
+    };
+    graph.AddPass(pass);
+}
+
+bool PassesEqual(const Vector<FastName>& passes, const Vector<const char*>& expected)
+{
+    if (passes.size() != expected.size())
+        return false;
+
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        if (passes[i] != FastName(expected[i]))
+            return false;
+    }
+    return true;
+}
+
+// Forward frame with several optional passes: depth prepass, shadows, SSAO, bloom and minimap
+void BuildFrameGraph(RenderGraph& graph, ExecutionLog& log)
+{
+    const uint32 width = 1280;
+    const uint32 height = 720;
+
+    graph.DeclareTarget(FastName("sceneDepth"), RenderTargetDescriptor(width, height, rhi::TEXTURE_FORMAT_D24S8));
+    graph.DeclareTarget(FastName("shadowMap"), RenderTargetDescriptor(1024, 1024, rhi::TEXTURE_FORMAT_D24S8));
+    graph.DeclareTarget(FastName("ssao"), RenderTargetDescriptor(width, height, rhi::TEXTURE_FORMAT_R8G8B8A8));
+    graph.DeclareTarget(FastName("ssaoBlurred"), RenderTargetDescriptor(width, height, rhi::TEXTURE_FORMAT_R8G8B8A8));
+    graph.DeclareTarget(FastName("sceneColor"), RenderTargetDescriptor(width, height, rhi::TEXTURE_FORMAT_R8G8B8A8));
+    graph.DeclareTarget(FastName("bloomHalf"), RenderTargetDescriptor(width / 2, height / 2, rhi::TEXTURE_FORMAT_R8G8B8A8));
+    graph.DeclareTarget(FastName("bloomBlurred"), RenderTargetDescriptor(width / 2, height / 2, rhi::TEXTURE_FORMAT_R8G8B8A8));
+    graph.DeclareTarget(FastName("minimapColor"), RenderTargetDescriptor(256, 256, rhi::TEXTURE_FORMAT_R8G8B8A8));
+    graph.DeclareTarget(FastName("minimapDepth"), RenderTargetDescriptor(256, 256, rhi::TEXTURE_FORMAT_D24S8));
+
+    AddPass(graph, log, "depthPrepass", {}, { FastName("sceneDepth") });
+    AddPass(graph, log, "shadows", {}, { FastName("shadowMap") });
+    AddPass(graph, log, "ssao", { FastName("sceneDepth") }, { FastName("ssao") });
+    AddPass(graph, log, "ssaoBlur", { FastName("ssao") }, { FastName("ssaoBlurred") });
+    AddPass(graph, log, "scene", { FastName("sceneDepth"), FastName("shadowMap"), FastName("ssaoBlurred") }, { FastName("sceneColor") });
+    AddPass(graph, log, "bloomDown", { FastName("sceneColor") }, { FastName("bloomHalf") });
+    AddPass(graph, log, "bloomBlur", { FastName("bloomHalf") }, { FastName("bloomBlurred") });
+    AddPass(graph, log, "composite", { FastName("sceneColor"), FastName("bloomBlurred") }, {}, true);
+    AddPass(graph, log, "minimap", {}, { FastName("minimapColor"), FastName("minimapDepth") });
+}
+}
+
+DAVA_TESTCLASS (RenderGraphTest)
+{
+    DAVA_TEST (CullingTest)
+    {
+        using namespace RenderGraphTestDetails;
+
+        RenderGraph graph;
+        ExecutionLog log;
+        BuildFrameGraph(graph, log);
+
+        // minimap result is not consumed by anyone
+        TEST_VERIFY(graph.Compile());
+        TEST_VERIFY(graph.GetCulledPassesCount() == 1);
+        TEST_VERIFY(std::find(graph.GetCompiledPasses().begin(), graph.GetCompiledPasses().end(), FastName("minimap")) == graph.GetCompiledPasses().end());
+
+        // output target keeps its writer alive
+        graph.SetTargetOutput(FastName("minimapColor"), true);
+        TEST_VERIFY(graph.Compile());
+        TEST_VERIFY(graph.GetCulledPassesCount() == 0);
+        TEST_VERIFY(graph.GetCompiledPasses().size() == 9);
+
+        // without composite nothing consumes bloom and scene, whole chain is culled
+        graph.SetPassEnabled(FastName("composite"), false);
+        TEST_VERIFY(graph.Compile());
+        TEST_VERIFY(PassesEqual(graph.GetCompiledPasses(), { "minimap" }));
+        TEST_VERIFY(graph.GetCulledPassesCount() == 7);
+
+        // disabled optional passes are not executed, their consumers still are
+        graph.SetPassEnabled(FastName("composite"), true);
+        graph.SetPassEnabled(FastName("bloomDown"), false);
+        graph.SetPassEnabled(FastName("bloomBlur"), false);
+        graph.SetTargetOutput(FastName("minimapColor"), false);
+        TEST_VERIFY(graph.Execute(BASE_PRIORITY));
+        TEST_VERIFY(PassesEqual(log.passes, { "depthPrepass", "shadows", "ssao", "ssaoBlur", "scene", "composite" }));
+    }
+
+    DAVA_TEST (OrderingTest)
+    {
+        using namespace RenderGraphTestDetails;
+
+        RenderGraph graph;
+        ExecutionLog log;
+
+        graph.DeclareTarget(FastName("a"), RenderTargetDescriptor(64, 64, rhi::TEXTURE_FORMAT_R8G8B8A8));
+        graph.DeclareTarget(FastName("b"), RenderTargetDescriptor(64, 64, rhi::TEXTURE_FORMAT_R8G8B8A8));
+        graph.DeclareTarget(FastName("c"), RenderTargetDescriptor(64, 64, rhi::TEXTURE_FORMAT_R8G8B8A8));
+
+        // registered in reverse order of dependencies
+        AddPass(graph, log, "final", { FastName("b"), FastName("c") }, {}, true);
+        AddPass(graph, log, "makeB", { FastName("a") }, { FastName("b") });
+        AddPass(graph, log, "makeC", {}, { FastName("c") });
+        AddPass(graph, log, "makeA", {}, { FastName("a") });
+        AddPass(graph, log, "overlay", {}, {}, true);
+
+        TEST_VERIFY(graph.Execute(BASE_PRIORITY));
+        TEST_VERIFY(PassesEqual(log.passes, { "makeC", "makeA", "makeB", "final", "overlay" }));
+        TEST_VERIFY(log.allTargetsValid);
+
+        // service passes are executed by rhi before passes with side effects, in graph order
+        TEST_VERIFY(log.priorities[0] > log.priorities[1] && log.priorities[1] > log.priorities[2]);
+        TEST_VERIFY(log.priorities[2] >= BASE_PRIORITY + PRIORITY_SERVICE_3D);
+        TEST_VERIFY(log.priorities[3] == BASE_PRIORITY && log.priorities[4] == BASE_PRIORITY);
+
+        // several writers of one target keep registration order
+        AddPass(graph, log, "decalsOnA", { FastName("a") }, { FastName("a") });
+        TEST_VERIFY(graph.Compile());
+        TEST_VERIFY(PassesEqual(graph.GetCompiledPasses(), { "makeC", "makeA", "overlay", "decalsOnA", "makeB", "final" }));
+
+        // cycle and unknown target are reported
+        AddPass(graph, log, "makeAFromB", { FastName("b") }, { FastName("a") });
+        TEST_VERIFY(!graph.Compile());
+        graph.RemovePass(FastName("makeAFromB"));
+        TEST_VERIFY(graph.Compile());
+
+        AddPass(graph, log, "broken", { FastName("unknown") }, {}, true);
+        TEST_VERIFY(!graph.Compile());
+        graph.SetPassEnabled(FastName("broken"), false);
+        TEST_VERIFY(graph.Compile());
+    }
+
+    DAVA_TEST (AliasingMemoryTest)
+    {
+        using namespace RenderGraphTestDetails;
+
+        uint32 peakMemory[2] = {};
+        uint32 texturesCount[2] = {};
+        for (bool aliasing : { false, true })
+        {
+            RenderGraph graph;
+            ExecutionLog log;
+            BuildFrameGraph(graph, log);
+            graph.SetTargetOutput(FastName("minimapColor"), true);
+            graph.SetAliasingEnabled(aliasing);
+
+            for (uint32 frame = 0; frame < 10; ++frame)
+            {
+                TEST_VERIFY(graph.Execute(BASE_PRIORITY));
+            }
+            TEST_VERIFY(log.allTargetsValid);
+            TEST_VERIFY(log.passes.size() == 90);
+
+            // pool reaches steady state after first frame
+            const RenderTargetPool& pool = graph.GetTargetPool();
+            TEST_VERIFY(pool.GetAllocatedMemory() == pool.GetPeakAllocatedMemory());
+            TEST_VERIFY(pool.GetTexturesInUseCount() == 1); // minimap output is held until next frame
+
+            peakMemory[aliasing] = pool.GetPeakAllocatedMemory();
+            texturesCount[aliasing] = pool.GetTexturesCount();
+        }
+
+        TEST_VERIFY(texturesCount[false] == 9);
+        TEST_VERIFY(texturesCount[true] < texturesCount[false]);
+        TEST_VERIFY(peakMemory[true] < peakMemory[false]);
+
+        Logger::Info("RenderGraph peak render target memory (9 passes, 9 targets): aliasing off %u KB in %u textures, aliasing on %u KB in %u textures",
+                     peakMemory[false] / 1024, texturesCount[false], peakMemory[true] / 1024, texturesCount[true]);
+    }
+};
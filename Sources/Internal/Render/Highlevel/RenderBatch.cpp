@@ -134,6 +134,7 @@ RenderBatch* RenderBatch::Clone(RenderBatch* destination)
 
     rb->startIndex = startIndex;
     rb->indexCount = indexCount;
+    rb->drawIndexRange = drawIndexRange;
 
     rb->aabbox = aabbox;
     rb->sortingKey = sortingKey;
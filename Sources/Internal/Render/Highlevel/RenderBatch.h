@@ -71,6 +71,7 @@ public:
     uint32 startIndex = 0;
     uint32 indexCount = 0;
     uint32 instanceCount = 0;
+    bool drawIndexRange = false; // draw only [startIndex, startIndex + indexCount) indices of polygon group
     rhi::HPerfQuery perfQueryStart;
     rhi::HPerfQuery perfQueryEnd;
 
@@ -145,7 +146,7 @@ inline void RenderBatch::BindGeometryData(rhi::Packet& packet)
         packet.vertexCount = dataSource->vertexCount;
         packet.indexBuffer = dataSource->indexBuffer;
         packet.primitiveType = dataSource->primitiveType;
-        packet.primitiveCount = dataSource->primitiveCount;
+        packet.primitiveCount = drawIndexRange ? CalculatePrimitiveCount(indexCount, dataSource->primitiveType) : dataSource->primitiveCount;
         packet.vertexLayoutUID = dataSource->vertexLayoutId;
         packet.startIndex = startIndex;
     }
@@ -0,0 +1,380 @@
+#include "Render/Highlevel/RenderGraph.h"
+#include "Render/RenderBase.h"
+
+#include "Debug/DVAssert.h"
+#include "Logger/Logger.h"
+
+namespace DAVA
+{
+RenderGraph::~RenderGraph()
+{
+    ReleaseTargets(true);
+    ReleaseTargets(false);
+}
+
+void RenderGraph::DeclareTarget(const FastName& name, const RenderTargetDescriptor& descriptor)
+{
+    DVASSERT(FindTarget(name) == -1);
+
+    Target target;
+    target.name = name;
+    target.descriptor = descriptor;
+    targets.push_back(target);
+}
+
+void RenderGraph::ImportTarget(const FastName& name, rhi::HTexture texture, const RenderTargetDescriptor& descriptor)
+{
+    int32 index = FindTarget(name);
+    if (index == -1)
+    {
+        Target target;
+        target.name = name;
+        target.imported = true;
+        targets.push_back(target);
+        index = static_cast<int32>(targets.size()) - 1;
+    }
+
+    Target& target = targets[index];
+    DVASSERT(target.imported);
+    target.texture = texture;
+    target.descriptor = descriptor;
+}
+
+void RenderGraph::RemoveTarget(const FastName& name)
+{
+    int32 index = FindTarget(name);
+    if (index == -1)
+        return;
+
+    Target& target = targets[index];
+    if (!target.imported && target.texture.IsValid())
+    {
+        targetPool.Release(target.texture);
+    }
+    targets.erase(targets.begin() + index);
+}
+
+bool RenderGraph::HasTarget(const FastName& name) const
+{
+    return FindTarget(name) != -1;
+}
+
+void RenderGraph::SetTargetOutput(const FastName& name, bool output)
+{
+    int32 index = FindTarget(name);
+    DVASSERT(index != -1);
+    targets[index].output = output;
+}
+
+void RenderGraph::AddPass(const PassDescriptor& pass)
+{
+    DVASSERT(pass.name.IsValid());
+    DVASSERT(FindPass(pass.name) == -1);
+
+    Pass newPass;
+    newPass.descriptor = pass;
+    passes.push_back(newPass);
+}
+
+void RenderGraph::RemovePass(const FastName& name)
+{
+    int32 index = FindPass(name);
+    if (index != -1)
+    {
+        passes.erase(passes.begin() + index);
+    }
+}
+
+bool RenderGraph::HasPass(const FastName& name) const
+{
+    return FindPass(name) != -1;
+}
+
+void RenderGraph::SetPassEnabled(const FastName& name, bool enabled)
+{
+    int32 index = FindPass(name);
+    DVASSERT(index != -1);
+    passes[index].enabled = enabled;
+}
+
+bool RenderGraph::IsPassEnabled(const FastName& name) const
+{
+    int32 index = FindPass(name);
+    return index != -1 && passes[index].enabled;
+}
+
+bool RenderGraph::Compile()
+{
+    compiledPasses.clear();
+    compiledPassNames.clear();
+    culledPassesCount = 0;
+
+    uint32 passesCount = static_cast<uint32>(passes.size());
+    uint32 targetsCount = static_cast<uint32>(targets.size());
+
+    for (const Pass& pass : passes)
+    {
+        if (!pass.enabled)
+            continue;
+
+        for (const Vector<FastName>* names : { &pass.descriptor.reads, &pass.descriptor.writes })
+        {
+            for (const FastName& name : *names)
+            {
+                if (FindTarget(name) == -1)
+                {
+                    Logger::Error("[RenderGraph] Pass '%s' uses undeclared target '%s'", pass.descriptor.name.c_str(), name.c_str());
+                    return false;
+                }
+            }
+        }
+    }
+
+    // Culling: walk from passes with side effects and writers of outputs to writers of everything they read.
+    Vector<bool> alive(passesCount, false);
+    Vector<uint32> stack;
+    for (uint32 i = 0; i < passesCount; ++i)
+    {
+        const Pass& pass = passes[i];
+        if (!pass.enabled)
+            continue;
+
+        bool writesOutput = std::any_of(pass.descriptor.writes.begin(), pass.descriptor.writes.end(), [this](const FastName& name) {
+            return targets[FindTarget(name)].output;
+        });
+
+        if (pass.descriptor.hasSideEffects || writesOutput)
+        {
+            alive[i] = true;
+            stack.push_back(i);
+        }
+    }
+
+    while (!stack.empty())
+    {
+        uint32 reader = stack.back();
+        stack.pop_back();
+
+        for (const FastName& name : passes[reader].descriptor.reads)
+        {
+            uint32 targetIndex = static_cast<uint32>(FindTarget(name));
+            for (uint32 i = 0; i < passesCount; ++i)
+            {
+                if (!alive[i] && passes[i].enabled && WritesTarget(passes[i], targetIndex))
+                {
+                    alive[i] = true;
+                    stack.push_back(i);
+                }
+            }
+        }
+    }
+
+    uint32 aliveCount = static_cast<uint32>(std::count(alive.begin(), alive.end(), true));
+    for (uint32 i = 0; i < passesCount; ++i)
+    {
+        if (passes[i].enabled && !alive[i])
+            ++culledPassesCount;
+    }
+
+    // Ordering: writers of target go before its readers, several writers of target go in registration order.
+    Vector<Vector<uint32>> dependents(passesCount);
+    Vector<uint32> dependenciesCount(passesCount, 0);
+    auto addDependency = [&dependents, &dependenciesCount](uint32 from, uint32 to) {
+        dependents[from].push_back(to);
+        ++dependenciesCount[to];
+    };
+
+    for (uint32 targetIndex = 0; targetIndex < targetsCount; ++targetIndex)
+    {
+        int32 prevWriter = -1;
+        for (uint32 i = 0; i < passesCount; ++i)
+        {
+            if (!alive[i] || !WritesTarget(passes[i], targetIndex))
+                continue;
+
+            if (prevWriter != -1)
+                addDependency(static_cast<uint32>(prevWriter), i);
+            prevWriter = static_cast<int32>(i);
+
+            for (uint32 reader = 0; reader < passesCount; ++reader)
+            {
+                if (!alive[reader] || reader == i)
+                    continue;
+
+                const Vector<FastName>& reads = passes[reader].descriptor.reads;
+                if (std::find(reads.begin(), reads.end(), targets[targetIndex].name) != reads.end())
+                    addDependency(i, reader);
+            }
+        }
+    }
+
+    Vector<uint32> order;
+    order.reserve(aliveCount);
+    Vector<bool> scheduled(passesCount, false);
+    while (order.size() < aliveCount)
+    {
+        int32 next = -1;
+        for (uint32 i = 0; i < passesCount; ++i)
+        {
+            if (alive[i] && !scheduled[i] && dependenciesCount[i] == 0)
+            {
+                next = static_cast<int32>(i);
+                break;
+            }
+        }
+
+        if (next == -1)
+        {
+            Logger::Error("[RenderGraph] Passes have cyclic dependencies");
+            compiledPassNames.clear();
+            return false;
+        }
+
+        scheduled[next] = true;
+        order.push_back(static_cast<uint32>(next));
+        compiledPassNames.push_back(passes[next].descriptor.name);
+        for (uint32 dependent : dependents[next])
+        {
+            --dependenciesCount[dependent];
+        }
+    }
+
+    // Lifetimes of transient targets, in execution order.
+    compiledPasses.resize(order.size());
+    for (size_t k = 0; k < order.size(); ++k)
+    {
+        compiledPasses[k].passIndex = order[k];
+    }
+
+    for (uint32 targetIndex = 0; targetIndex < targetsCount; ++targetIndex)
+    {
+        const Target& target = targets[targetIndex];
+        if (target.imported)
+            continue;
+
+        int32 firstUse = -1;
+        int32 lastUse = -1;
+        for (size_t k = 0; k < order.size(); ++k)
+        {
+            const PassDescriptor& pass = passes[order[k]].descriptor;
+            bool reads = std::find(pass.reads.begin(), pass.reads.end(), target.name) != pass.reads.end();
+            if (reads || WritesTarget(passes[order[k]], targetIndex))
+            {
+                if (firstUse == -1)
+                    firstUse = static_cast<int32>(k);
+                lastUse = static_cast<int32>(k);
+            }
+        }
+
+        if (firstUse != -1)
+        {
+            compiledPasses[firstUse].acquiredTargets.push_back(targetIndex);
+            if (aliasingEnabled && !target.output)
+            {
+                compiledPasses[lastUse].releasedTargets.push_back(targetIndex);
+            }
+        }
+    }
+
+    return true;
+}
+
+bool RenderGraph::Execute(int32 basePriority)
+{
+    ReleaseTargets(true);
+
+    if (!Compile())
+    {
+        targetPool.EndFrame();
+        return false;
+    }
+
+    int32 servicePassesCount = static_cast<int32>(std::count_if(compiledPasses.begin(), compiledPasses.end(), [this](const CompiledPass& compiledPass) {
+        return !passes[compiledPass.passIndex].descriptor.hasSideEffects;
+    }));
+    int32 servicePriority = basePriority + PRIORITY_SERVICE_3D + servicePassesCount;
+
+    for (const CompiledPass& compiledPass : compiledPasses)
+    {
+        for (uint32 targetIndex : compiledPass.acquiredTargets)
+        {
+            Target& target = targets[targetIndex];
+            if (!target.texture.IsValid())
+            {
+                target.texture = targetPool.Acquire(target.descriptor);
+            }
+        }
+
+        const PassDescriptor& pass = passes[compiledPass.passIndex].descriptor;
+        int32 priority = pass.hasSideEffects ? basePriority : --servicePriority;
+        if (pass.execute)
+        {
+            pass.execute(*this, priority);
+        }
+
+        for (uint32 targetIndex : compiledPass.releasedTargets)
+        {
+            Target& target = targets[targetIndex];
+            targetPool.Release(target.texture);
+            target.texture = rhi::HTexture();
+        }
+    }
+
+    ReleaseTargets(false);
+    targetPool.EndFrame();
+
+    return true;
+}
+
+rhi::HTexture RenderGraph::GetTexture(const FastName& name) const
+{
+    int32 index = FindTarget(name);
+    DVASSERT(index != -1);
+    return targets[index].texture;
+}
+
+const RenderTargetDescriptor& RenderGraph::GetTargetDescriptor(const FastName& name) const
+{
+    int32 index = FindTarget(name);
+    DVASSERT(index != -1);
+    return targets[index].descriptor;
+}
+
+int32 RenderGraph::FindTarget(const FastName& name) const
+{
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        if (targets[i].name == name)
+            return static_cast<int32>(i);
+    }
+    return -1;
+}
+
+int32 RenderGraph::FindPass(const FastName& name) const
+{
+    for (size_t i = 0; i < passes.size(); ++i)
+    {
+        if (passes[i].descriptor.name == name)
+            return static_cast<int32>(i);
+    }
+    return -1;
+}
+
+bool RenderGraph::WritesTarget(const Pass& pass, uint32 targetIndex) const
+{
+    const Vector<FastName>& writes = pass.descriptor.writes;
+    return std::find(writes.begin(), writes.end(), targets[targetIndex].name) != writes.end();
+}
+
+void RenderGraph::ReleaseTargets(bool outputs)
+{
+    for (Target& target : targets)
+    {
+        if (!target.imported && target.output == outputs && target.texture.IsValid())
+        {
+            targetPool.Release(target.texture);
+            target.texture = rhi::HTexture();
+        }
+    }
+}
+}
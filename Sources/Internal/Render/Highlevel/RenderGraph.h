@@ -0,0 +1,136 @@
+#pragma once
+
+#include "Base/BaseTypes.h"
+#include "Base/FastName.h"
+#include "Functional/Function.h"
+#include "Render/RenderTargetPool.h"
+#include "Render/RHI/rhi_Public.h"
+
+namespace DAVA
+{
+/**
+    Frame graph of render passes.
+
+    Passes declare targets they read and write. Targets are either transient (`DeclareTarget`), allocated from
+    `RenderTargetPool` only for the frame part between first and last pass using them, or imported (`ImportTarget`),
+    owned by caller. Each `Execute`:
+    - culls passes whose results are not consumed: pass is kept if it has side effects (writes outside of graph,
+      e.g. to back buffer), writes output target (`SetTargetOutput`) or writes target read by another kept pass;
+    - orders kept passes so that writers of target go before its readers, passes registration order is kept otherwise;
+    - acquires transient targets before their first use and, if aliasing is enabled, returns them to pool after last
+      use, so passes with non-overlapping lifetimes share same textures.
+
+    Execute callback receives rhi priority for its pass: passes with side effects get `basePriority`, other passes
+    get higher priorities in execution order, starting from `basePriority + PRIORITY_SERVICE_3D`.
+*/
+class RenderGraph
+{
+public:
+    using ExecuteCallback = Function<void(const RenderGraph& graph, int32 priority)>;
+
+    struct PassDescriptor
+    {
+        FastName name;
+        Vector<FastName> reads;
+        Vector<FastName> writes;
+        bool hasSideEffects = false;
+        ExecuteCallback execute;
+    };
+
+    RenderGraph() = default;
+    ~RenderGraph();
+
+    void DeclareTarget(const FastName& name, const RenderTargetDescriptor& descriptor);
+    /** Adds or updates target owned by caller. `texture` may be invalid while passes using target are disabled. */
+    void ImportTarget(const FastName& name, rhi::HTexture texture, const RenderTargetDescriptor& descriptor);
+    void RemoveTarget(const FastName& name);
+    bool HasTarget(const FastName& name) const;
+
+    /** Output target is consumed outside of graph. Transient output keeps its texture until next `Execute`. */
+    void SetTargetOutput(const FastName& name, bool output);
+
+    void AddPass(const PassDescriptor& pass);
+    void RemovePass(const FastName& name);
+    bool HasPass(const FastName& name) const;
+    void SetPassEnabled(const FastName& name, bool enabled);
+    bool IsPassEnabled(const FastName& name) const;
+
+    void SetAliasingEnabled(bool enabled);
+    bool IsAliasingEnabled() const;
+
+    /** Culls and orders passes without executing them. Returns false if graph is invalid (unknown target or cycle). */
+    bool Compile();
+    bool Execute(int32 basePriority);
+
+    /** Returns texture of target, transient targets are valid only while their passes are executed. */
+    rhi::HTexture GetTexture(const FastName& name) const;
+    const RenderTargetDescriptor& GetTargetDescriptor(const FastName& name) const;
+
+    /** Names of passes in execution order, as of last `Compile`. */
+    const Vector<FastName>& GetCompiledPasses() const;
+    uint32 GetCulledPassesCount() const;
+
+    RenderTargetPool& GetTargetPool();
+
+private:
+    struct Target
+    {
+        FastName name;
+        RenderTargetDescriptor descriptor;
+        rhi::HTexture texture;
+        bool imported = false;
+        bool output = false;
+    };
+
+    struct Pass
+    {
+        PassDescriptor descriptor;
+        bool enabled = true;
+    };
+
+    struct CompiledPass
+    {
+        uint32 passIndex = 0;
+        Vector<uint32> acquiredTargets;
+        Vector<uint32> releasedTargets;
+    };
+
+    int32 FindTarget(const FastName& name) const;
+    int32 FindPass(const FastName& name) const;
+    bool WritesTarget(const Pass& pass, uint32 targetIndex) const;
+    void ReleaseTargets(bool outputs);
+
+    Vector<Target> targets;
+    Vector<Pass> passes;
+    Vector<CompiledPass> compiledPasses;
+    Vector<FastName> compiledPassNames;
+    uint32 culledPassesCount = 0;
+    bool aliasingEnabled = true;
+    RenderTargetPool targetPool;
+};
+
+inline void RenderGraph::SetAliasingEnabled(bool enabled)
+{
+    aliasingEnabled = enabled;
+}
+
+inline bool RenderGraph::IsAliasingEnabled() const
+{
+    return aliasingEnabled;
+}
+
+inline const Vector<FastName>& RenderGraph::GetCompiledPasses() const
+{
+    return compiledPassNames;
+}
+
+inline uint32 RenderGraph::GetCulledPassesCount() const
+{
+    return culledPassesCount;
+}
+
+inline RenderTargetPool& RenderGraph::GetTargetPool()
+{
+    return targetPool;
+}
+}
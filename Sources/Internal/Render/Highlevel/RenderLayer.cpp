@@ -3,6 +3,7 @@
 #include "Render/Highlevel/RenderBatchArray.h"
 #include "Render/Highlevel/Camera.h"
 #include "Render/VisibilityQueryResults.h"
+#include "Render/Renderer.h"
 #include "Base/Radix/Radix.h"
 #include "Debug/ProfilerGPU.h"
 #include "Debug/ProfilerMarkerNames.h"
@@ -101,9 +102,18 @@ void RenderLayer::Draw(Camera* camera, const RenderBatchArray& batchArray, rhi::
 #else
             packet.queryIndex = layerID;
 #endif
+            RenderStats& stats = Renderer::GetRenderStats();
+            ++stats.renderPackets3d;
+            if (packet.primitiveType == rhi::PRIMITIVE_TRIANGLELIST || packet.primitiveType == rhi::PRIMITIVE_TRIANGLESTRIP)
+                stats.triangles3d += packet.primitiveCount * Max(packet.instanceCount, 1U);
 #endif
             rhi::AddPacket(packetList, packet);
         }
     }
+
+#ifdef __DAVAENGINE_RENDERSTATS__
+    if (size > 0)
+        Renderer::GetRenderStats().layerBatches[LAYER_NAMES[layerID]] += size;
+#endif
 }
 };
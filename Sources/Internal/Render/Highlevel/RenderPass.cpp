@@ -127,7 +127,7 @@ void RenderPass::PrepareVisibilityArrays(Camera* camera, RenderSystem* renderSys
     PrepareLayersArrays(visibilityArray, camera);
 }
 
-void RenderPass::PrepareLayersArrays(const Vector<RenderObject*> objectsArray, Camera* camera)
+void RenderPass::PrepareLayersArrays(const Vector<RenderObject*>& objectsArray, Camera* camera)
 {
     size_t size = objectsArray.size();
     for (size_t ro = 0; ro < size; ++ro)
@@ -290,7 +290,6 @@ void MainForwardRenderPass::InitReflectionRefraction()
     reflectionPass->GetPassConfig().colorBuffer[0].texture = Renderer::GetRuntimeTextures().GetDynamicTexture(RuntimeTextures::TEXTURE_DYNAMIC_REFLECTION);
     reflectionPass->GetPassConfig().colorBuffer[0].loadAction = rhi::LOADACTION_CLEAR;
     reflectionPass->GetPassConfig().colorBuffer[0].storeAction = rhi::STOREACTION_STORE;
-    reflectionPass->GetPassConfig().depthStencilBuffer.texture = Renderer::GetRuntimeTextures().GetDynamicTexture(RuntimeTextures::TEXTURE_DYNAMIC_RR_DEPTHBUFFER);
     reflectionPass->GetPassConfig().depthStencilBuffer.loadAction = rhi::LOADACTION_CLEAR;
     reflectionPass->GetPassConfig().depthStencilBuffer.storeAction = rhi::STOREACTION_NONE;
     reflectionPass->SetViewport(Rect(0, 0, static_cast<float32>(RuntimeTextures::REFLECTION_TEX_SIZE), static_cast<float32>(RuntimeTextures::REFLECTION_TEX_SIZE)));
@@ -300,31 +299,29 @@ void MainForwardRenderPass::InitReflectionRefraction()
     refractionPass->GetPassConfig().colorBuffer[0].texture = Renderer::GetRuntimeTextures().GetDynamicTexture(RuntimeTextures::TEXTURE_DYNAMIC_REFRACTION);
     refractionPass->GetPassConfig().colorBuffer[0].loadAction = rhi::LOADACTION_CLEAR;
     refractionPass->GetPassConfig().colorBuffer[0].storeAction = rhi::STOREACTION_STORE;
-    refractionPass->GetPassConfig().depthStencilBuffer.texture = Renderer::GetRuntimeTextures().GetDynamicTexture(RuntimeTextures::TEXTURE_DYNAMIC_RR_DEPTHBUFFER);
     refractionPass->GetPassConfig().depthStencilBuffer.loadAction = rhi::LOADACTION_CLEAR;
     refractionPass->GetPassConfig().depthStencilBuffer.storeAction = rhi::STOREACTION_NONE;
     refractionPass->SetViewport(Rect(0, 0, static_cast<float32>(RuntimeTextures::REFRACTION_TEX_SIZE), static_cast<float32>(RuntimeTextures::REFRACTION_TEX_SIZE)));
     refractionPass->SetRenderTargetProperties(RuntimeTextures::REFRACTION_TEX_SIZE, RuntimeTextures::REFRACTION_TEX_SIZE, Renderer::GetRuntimeTextures().GetDynamicTextureFormat(RuntimeTextures::TEXTURE_DYNAMIC_REFRACTION));
 }
 
-void MainForwardRenderPass::PrepareReflectionRefractionTextures(RenderSystem* renderSystem)
+void MainForwardRenderPass::PrepareReflectionRefraction()
 {
-    if (!Renderer::GetOptions()->IsOptionEnabled(RenderOptions::WATER_REFLECTION_REFRACTION_DRAW))
+    waterReflectionRefractionRequired = false;
+
+    const RenderBatchArray& waterLayerBatches = layersBatchArrays[RenderLayer::RENDER_LAYER_WATER_ID];
+    uint32 waterBatchesCount = waterLayerBatches.GetRenderBatchCount();
+    if (waterBatchesCount == 0 || !Renderer::GetOptions()->IsOptionEnabled(RenderOptions::WATER_REFLECTION_REFRACTION_DRAW))
         return;
 
     if (!reflectionPass)
         InitReflectionRefraction();
 
-    const RenderBatchArray& waterLayerBatches = layersBatchArrays[RenderLayer::RENDER_LAYER_WATER_ID];
-    uint32 waterBatchesCount = waterLayerBatches.GetRenderBatchCount();
-    if (waterBatchesCount)
+    waterBox.Empty();
+    for (uint32 i = 0; i < waterBatchesCount; ++i)
     {
-        waterBox.Empty();
-        for (uint32 i = 0; i < waterBatchesCount; ++i)
-        {
-            RenderBatch* batch = waterLayerBatches.Get(i);
-            waterBox.AddAABBox(batch->GetRenderObject()->GetWorldBoundingBox());
-        }
+        RenderBatch* batch = waterLayerBatches.Get(i);
+        waterBox.AddAABBox(batch->GetRenderObject()->GetWorldBoundingBox());
     }
 
     const float32* clearColor = static_cast<const float32*>(Renderer::GetDynamicBindings().GetDynamicParam(DynamicBindings::PARAM_WATER_CLEAR_COLOR));
@@ -336,40 +333,70 @@ void MainForwardRenderPass::PrepareReflectionRefractionTextures(RenderSystem* re
     }
 
     reflectionPass->SetWaterLevel(waterBox.max.z);
-    reflectionPass->GetPassConfig().priority = passConfig.priority + PRIORITY_SERVICE_3D;
+    refractionPass->SetWaterLevel(waterBox.min.z);
+
+    waterReflectionRefractionRequired = true;
+}
+
+void MainForwardRenderPass::PrepareFrame(RenderSystem* renderSystem)
+{
+    Camera* mainCamera = renderSystem->GetMainCamera();
+    Camera* drawCamera = renderSystem->GetDrawCamera();
+    SetupCameraParams(mainCamera, drawCamera);
+
+    PrepareVisibilityArrays(mainCamera, renderSystem);
+    PrepareReflectionRefraction();
+}
+
+void MainForwardRenderPass::DrawWaterReflection(RenderSystem* renderSystem, rhi::HTexture depthStencil, int32 priority)
+{
+    DVASSERT(waterReflectionRefractionRequired);
+
+    reflectionPass->GetPassConfig().depthStencilBuffer.texture = depthStencil;
+    reflectionPass->GetPassConfig().priority = priority;
     reflectionPass->Draw(renderSystem);
+}
 
-    refractionPass->SetWaterLevel(waterBox.min.z);
-    refractionPass->GetPassConfig().priority = passConfig.priority + PRIORITY_SERVICE_3D;
+void MainForwardRenderPass::DrawWaterRefraction(RenderSystem* renderSystem, rhi::HTexture depthStencil, int32 priority)
+{
+    DVASSERT(waterReflectionRefractionRequired);
+
+    refractionPass->GetPassConfig().depthStencilBuffer.texture = depthStencil;
+    refractionPass->GetPassConfig().priority = priority;
     refractionPass->Draw(renderSystem);
 }
 
-void MainForwardRenderPass::Draw(RenderSystem* renderSystem)
+void MainForwardRenderPass::DrawMain(RenderSystem* renderSystem)
 {
     Camera* mainCamera = renderSystem->GetMainCamera();
     Camera* drawCamera = renderSystem->GetDrawCamera();
 
-    /*    drawCamera->SetPosition(Vector3(5, 5, 5));
-    drawCamera->SetTarget(Vector3(0, 0, 0));
-    Vector4 clip(0, 0, 1, -1);*/
+    // water passes may be drawn before and override camera bindings
     SetupCameraParams(mainCamera, drawCamera);
 
-    PrepareVisibilityArrays(mainCamera, renderSystem);
-
     DAVA_PROFILER_GPU_RENDER_PASS(passConfig, ProfilerGPUMarkerName::RENDER_PASS_MAIN_3D);
     if (BeginRenderPass())
     {
         DrawLayers(mainCamera);
-
-        if (layersBatchArrays[RenderLayer::RENDER_LAYER_WATER_ID].GetRenderBatchCount() != 0)
-            PrepareReflectionRefractionTextures(renderSystem);
-
         DrawDebug(drawCamera, renderSystem);
-
         EndRenderPass();
     }
 }
 
+void MainForwardRenderPass::Draw(RenderSystem* renderSystem)
+{
+    PrepareFrame(renderSystem);
+
+    if (waterReflectionRefractionRequired)
+    {
+        rhi::HTexture depthStencil = Renderer::GetRuntimeTextures().GetDynamicTexture(RuntimeTextures::TEXTURE_DYNAMIC_RR_DEPTHBUFFER);
+        DrawWaterReflection(renderSystem, depthStencil, passConfig.priority + PRIORITY_SERVICE_3D);
+        DrawWaterRefraction(renderSystem, depthStencil, passConfig.priority + PRIORITY_SERVICE_3D);
+    }
+
+    DrawMain(renderSystem);
+}
+
 MainForwardRenderPass::~MainForwardRenderPass()
 {
     SafeDelete(reflectionPass);
@@ -38,7 +38,7 @@ protected:
 
     /*convinience*/
     void PrepareVisibilityArrays(Camera* camera, RenderSystem* renderSystem);
-    void PrepareLayersArrays(const Vector<RenderObject*> objectsArray, Camera* camera);
+    void PrepareLayersArrays(const Vector<RenderObject*>& objectsArray, Camera* camera);
     void ClearLayersArrays();
 
     void SetupCameraParams(Camera* mainCamera, Camera* drawCamera, Vector4* externalClipPlane = NULL);
@@ -138,13 +138,29 @@ public:
     ~MainForwardRenderPass();
     virtual void Draw(RenderSystem* renderSystem);
 
+    /**
+        Split form of `Draw` used by `RenderGraph`: `PrepareFrame` collects visible objects and water bounds,
+        after that water passes (if required) and main pass may be drawn in any order.
+    */
+    void PrepareFrame(RenderSystem* renderSystem);
+    bool IsWaterReflectionRefractionRequired() const;
+    void DrawWaterReflection(RenderSystem* renderSystem, rhi::HTexture depthStencil, int32 priority);
+    void DrawWaterRefraction(RenderSystem* renderSystem, rhi::HTexture depthStencil, int32 priority);
+    void DrawMain(RenderSystem* renderSystem);
+
 private:
     WaterReflectionRenderPass* reflectionPass;
     WaterRefractionRenderPass* refractionPass;
 
     AABBox3 waterBox;
+    bool waterReflectionRefractionRequired = false;
 
     void InitReflectionRefraction();
-    void PrepareReflectionRefractionTextures(RenderSystem* renderSystem);
+    void PrepareReflectionRefraction();
 };
+
+inline bool MainForwardRenderPass::IsWaterReflectionRefractionRequired() const
+{
+    return waterReflectionRefractionRequired;
+}
 }
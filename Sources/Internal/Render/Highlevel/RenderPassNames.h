@@ -11,6 +11,16 @@ static const FastName PASS_FORWARD("ForwardPass");
 static const FastName PASS_REFLECTION_REFRACTION("ReflectionRefractionPass");
 static const FastName PASS_STATIC_OCCLUSION("StaticOcclusionPass");
 
+// RENDER GRAPH PASSES AND TARGETS
+static const FastName RENDER_GRAPH_PASS_MAIN("MainPass");
+static const FastName RENDER_GRAPH_PASS_WATER_REFLECTION("WaterReflectionPass");
+static const FastName RENDER_GRAPH_PASS_WATER_REFRACTION("WaterRefractionPass");
+
+static const FastName RENDER_GRAPH_TARGET_WATER_REFLECTION("WaterReflection");
+static const FastName RENDER_GRAPH_TARGET_WATER_REFRACTION("WaterRefraction");
+static const FastName RENDER_GRAPH_TARGET_WATER_REFLECTION_DEPTH("WaterReflectionDepth");
+static const FastName RENDER_GRAPH_TARGET_WATER_REFRACTION_DEPTH("WaterRefractionDepth");
+
 } // ns
 
 #endif /* __DAVAENGINE_RENDER_FASTNAMES_H__ */
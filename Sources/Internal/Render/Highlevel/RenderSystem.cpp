@@ -3,6 +3,7 @@
 #include "Render/Highlevel/RenderLayer.h"
 #include "Render/Highlevel/RenderBatchArray.h"
 #include "Render/Highlevel/RenderPass.h"
+#include "Render/Highlevel/RenderGraph.h"
 #include "Render/Highlevel/RenderBatch.h"
 #include "Scene3D/Components/RenderComponent.h"
 #include "Scene3D/Components/TransformComponent.h"
@@ -12,6 +13,8 @@
 #include "Render/Highlevel/Light.h"
 #include "Render/Highlevel/VisibilityQuadTree.h"
 #include "Render/ShaderCache.h"
+#include "Render/Renderer.h"
+#include "Render/PixelFormatDescriptor.h"
 
 #include "Utils/Utils.h"
 
@@ -20,6 +23,8 @@ namespace DAVA
 RenderSystem::RenderSystem()
 {
     mainRenderPass = new MainForwardRenderPass(PASS_FORWARD);
+    renderGraph = new RenderGraph();
+    RegisterRenderGraphPasses();
     renderHierarchy = new QuadTree(10);
     markedObjects.reserve(100);
     debugDrawer = new RenderHelper();
@@ -34,6 +39,7 @@ RenderSystem::~RenderSystem()
     SafeRelease(globalMaterial);
 
     SafeDelete(renderHierarchy);
+    SafeDelete(renderGraph);
     SafeDelete(mainRenderPass);
 
     SafeDelete(debugDrawer);
@@ -331,6 +337,8 @@ void RenderSystem::DebugDrawHierarchy(const Matrix4& cameraMatrix)
 
 void RenderSystem::Render()
 {
+    ++renderFrameIndex;
+
     rhi::RenderPassConfig& config = mainRenderPass->GetPassConfig();
 
     const FastName& currentMSAA = QualitySettingsSystem::Instance()->GetCurMSAAQuality();
@@ -341,7 +349,65 @@ void RenderSystem::Render()
     config.depthStencilBuffer.loadAction = rhi::LOADACTION_CLEAR;
     config.depthStencilBuffer.storeAction = rhi::STOREACTION_NONE;
 
-    mainRenderPass->Draw(this);
+    mainRenderPass->PrepareFrame(this);
+
+    bool drawWater = mainRenderPass->IsWaterReflectionRefractionRequired();
+    renderGraph->SetPassEnabled(RENDER_GRAPH_PASS_WATER_REFLECTION, drawWater);
+    renderGraph->SetPassEnabled(RENDER_GRAPH_PASS_WATER_REFRACTION, drawWater);
+    if (drawWater)
+    {
+        auto importWaterTarget = [this](const FastName& target, RuntimeTextures::eDynamicTextureSemantic semantic) {
+            RuntimeTextures& runtimeTextures = Renderer::GetRuntimeTextures();
+            rhi::HTexture texture = runtimeTextures.GetDynamicTexture(semantic);
+            RenderTargetDescriptor descriptor = renderGraph->GetTargetDescriptor(target);
+            descriptor.format = PixelFormatDescriptor::GetPixelFormatDescriptor(runtimeTextures.GetDynamicTextureFormat(semantic)).format;
+            renderGraph->ImportTarget(target, texture, descriptor);
+        };
+        importWaterTarget(RENDER_GRAPH_TARGET_WATER_REFLECTION, RuntimeTextures::TEXTURE_DYNAMIC_REFLECTION);
+        importWaterTarget(RENDER_GRAPH_TARGET_WATER_REFRACTION, RuntimeTextures::TEXTURE_DYNAMIC_REFRACTION);
+    }
+
+    renderGraph->Execute(config.priority);
+}
+
+void RenderSystem::RegisterRenderGraphPasses()
+{
+    // Water color targets are bound to materials by RuntimeTextures semantics, so they are imported,
+    // depth buffers are used only by water passes themselves and are allocated from graph pool.
+    RenderTargetDescriptor reflectionDescriptor(RuntimeTextures::REFLECTION_TEX_SIZE, RuntimeTextures::REFLECTION_TEX_SIZE, rhi::TEXTURE_FORMAT_R5G6B5);
+    RenderTargetDescriptor refractionDescriptor(RuntimeTextures::REFRACTION_TEX_SIZE, RuntimeTextures::REFRACTION_TEX_SIZE, rhi::TEXTURE_FORMAT_R5G6B5);
+    renderGraph->ImportTarget(RENDER_GRAPH_TARGET_WATER_REFLECTION, rhi::HTexture(), reflectionDescriptor);
+    renderGraph->ImportTarget(RENDER_GRAPH_TARGET_WATER_REFRACTION, rhi::HTexture(), refractionDescriptor);
+    renderGraph->DeclareTarget(RENDER_GRAPH_TARGET_WATER_REFLECTION_DEPTH, RenderTargetDescriptor(reflectionDescriptor.width, reflectionDescriptor.height, rhi::TEXTURE_FORMAT_D24S8));
+    renderGraph->DeclareTarget(RENDER_GRAPH_TARGET_WATER_REFRACTION_DEPTH, RenderTargetDescriptor(refractionDescriptor.width, refractionDescriptor.height, rhi::TEXTURE_FORMAT_D24S8));
+
+    RenderGraph::PassDescriptor reflectionPass;
+    reflectionPass.name = RENDER_GRAPH_PASS_WATER_REFLECTION;
+    reflectionPass.writes = { RENDER_GRAPH_TARGET_WATER_REFLECTION, RENDER_GRAPH_TARGET_WATER_REFLECTION_DEPTH };
+    reflectionPass.execute = [this](const RenderGraph& graph, int32 priority) {
+        mainRenderPass->DrawWaterReflection(this, graph.GetTexture(RENDER_GRAPH_TARGET_WATER_REFLECTION_DEPTH), priority);
+    };
+    renderGraph->AddPass(reflectionPass);
+    renderGraph->SetPassEnabled(RENDER_GRAPH_PASS_WATER_REFLECTION, false);
+
+    RenderGraph::PassDescriptor refractionPass;
+    refractionPass.name = RENDER_GRAPH_PASS_WATER_REFRACTION;
+    refractionPass.writes = { RENDER_GRAPH_TARGET_WATER_REFRACTION, RENDER_GRAPH_TARGET_WATER_REFRACTION_DEPTH };
+    refractionPass.execute = [this](const RenderGraph& graph, int32 priority) {
+        mainRenderPass->DrawWaterRefraction(this, graph.GetTexture(RENDER_GRAPH_TARGET_WATER_REFRACTION_DEPTH), priority);
+    };
+    renderGraph->AddPass(refractionPass);
+    renderGraph->SetPassEnabled(RENDER_GRAPH_PASS_WATER_REFRACTION, false);
+
+    RenderGraph::PassDescriptor mainPass;
+    mainPass.name = RENDER_GRAPH_PASS_MAIN;
+    mainPass.reads = { RENDER_GRAPH_TARGET_WATER_REFLECTION, RENDER_GRAPH_TARGET_WATER_REFRACTION };
+    mainPass.hasSideEffects = true;
+    mainPass.execute = [this](const RenderGraph& graph, int32 priority) {
+        mainRenderPass->GetPassConfig().priority = priority;
+        mainRenderPass->DrawMain(this);
+    };
+    renderGraph->AddPass(mainPass);
 }
 
 void RenderSystem::SetAntialiasingAllowed(bool allow)
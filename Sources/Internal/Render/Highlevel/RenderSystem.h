@@ -10,6 +10,8 @@
 namespace DAVA
 {
 class RenderPass;
+class MainForwardRenderPass;
+class RenderGraph;
 class RenderLayer;
 class RenderObject;
 class RenderBatch;
@@ -69,6 +71,11 @@ public:
     void Update(float32 timeElapsed);
     void Render();
 
+    /**
+        \brief Index of the last Render call. Objects prepared to render may remember it as visibility feedback.
+     */
+    inline uint32 GetRenderFrameIndex() const;
+
     void MarkForUpdate(RenderObject* renderObject);
     void MarkForUpdate(Light* lightNode);
 
@@ -111,6 +118,15 @@ public:
         return geoDecalManager;
     }
 
+    /**
+        \brief Render graph executed by `Render`. It contains main pass and water reflection/refraction passes,
+        applications may register their own passes and targets in it.
+     */
+    inline RenderGraph* GetRenderGraph() const
+    {
+        return renderGraph;
+    }
+
 public:
     DAVA_DEPRECATED(rhi::RenderPassConfig& GetMainPassConfig());
 
@@ -119,6 +135,7 @@ private:
     void AddRenderObject(RenderObject* renderObject);
     void RemoveRenderObject(RenderObject* renderObject);
     void PrebuildMaterial(NMaterial* material);
+    void RegisterRenderGraphPasses();
 
 private:
     friend class RenderPass;
@@ -130,7 +147,8 @@ private:
     Vector<RenderObject*> renderObjectArray;
     Vector<Light*> lights;
 
-    RenderPass* mainRenderPass = nullptr;
+    MainForwardRenderPass* mainRenderPass = nullptr;
+    RenderGraph* renderGraph = nullptr;
     RenderHierarchy* renderHierarchy = nullptr;
     Camera* mainCamera = nullptr;
     Camera* drawCamera = nullptr;
@@ -138,6 +156,8 @@ private:
     RenderHelper* debugDrawer = nullptr;
     GeoDecalManager* geoDecalManager = nullptr;
 
+    uint32 renderFrameIndex = 0;
+
     bool hierarchyInitialized = false;
     bool forceUpdateLights = false;
     bool allowAntialiasing = true;
@@ -160,6 +180,11 @@ inline void RenderSystem::SetDrawCamera(Camera* _camera)
     drawCamera = SafeRetain(_camera);
 }
 
+inline uint32 RenderSystem::GetRenderFrameIndex() const
+{
+    return renderFrameIndex;
+}
+
 inline Camera* RenderSystem::GetMainCamera() const
 {
     return mainCamera;
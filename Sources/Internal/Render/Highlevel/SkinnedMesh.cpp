@@ -93,6 +93,14 @@ void SkinnedMesh::BindDynamicParameters(Camera* camera, RenderBatch* batch)
     RenderObject::BindDynamicParameters(camera, batch);
 }
 
+void SkinnedMesh::PrepareToRender(Camera* camera)
+{
+    if (renderSystem != nullptr)
+    {
+        lastVisibleFrame = renderSystem->GetRenderFrameIndex();
+    }
+}
+
 void SkinnedMesh::UpdateJointTransforms(const Vector<JointTransform>& finalTransforms)
 {
     for (auto& jointsData : jointTargetsData)
@@ -39,6 +39,10 @@ public:
     void Load(KeyedArchive* archive, SerializationContext* serializationContext) override;
 
     void BindDynamicParameters(Camera* camera, RenderBatch* batch) override;
+    void PrepareToRender(Camera* camera) override;
+
+    /** Return RenderSystem frame index when mesh was prepared to render last time. */
+    uint32 GetLastVisibleFrame() const;
 
     void SetBoundingBox(const AABBox3& box);
     void UpdateJointTransforms(const Vector<JointTransform>& finalTransforms);
@@ -51,6 +55,7 @@ public:
 protected:
     UnorderedMap<RenderBatch*, uint32> jointTargetsDataMap; //RenderBatch -> targets-data index
     Vector<std::pair<JointTargets, JointTargetsData>> jointTargetsData;
+    uint32 lastVisibleFrame = 0;
 };
 
 inline void SkinnedMesh::SetBoundingBox(const AABBox3& box)
@@ -58,4 +63,9 @@ inline void SkinnedMesh::SetBoundingBox(const AABBox3& box)
     bbox = box;
 }
 
+inline uint32 SkinnedMesh::GetLastVisibleFrame() const
+{
+    return lastVisibleFrame;
+}
+
 } //ns
@@ -4,6 +4,7 @@
 #include "Render/Highlevel/RenderLayer.h"
 #include "Render/Highlevel/RenderPassNames.h"
 
+#include "Base/Hash.h"
 #include "Logger/Logger.h"
 #include "Utils/Utils.h"
 #include "FileSystem/YamlParser.h"
@@ -16,7 +17,16 @@ namespace DAVA
 {
 namespace FXCacheDetails
 {
-Map<Vector<size_t>, FXDescriptor> fxDescriptors;
+struct FXKeyHash
+{
+    size_t operator()(const Vector<size_t>& key) const
+    {
+        return BufferHash(reinterpret_cast<const uint8*>(key.data()), static_cast<uint32>(key.size() * sizeof(size_t)));
+    }
+};
+
+//descriptors are never erased, so references returned from cache stay valid on rehash
+UnorderedMap<Vector<size_t>, FXDescriptor, FXKeyHash> fxDescriptors;
 Map<std::pair<FastName, FastName>, FXDescriptor> oldTemplateMap;
 
 FXDescriptor defaultFX;
@@ -9,6 +9,7 @@
 #include "Render/Shader.h"
 #include "Render/Texture.h"
 
+#include "Base/Hash.h"
 #include "Utils/Utils.h"
 #include "Utils/StringFormat.h"
 #include "FileSystem/YamlParser.h"
@@ -33,6 +34,127 @@ V GetValuePtr(const UnorderedMap<K, V>& umap, const K& key)
 
     return nullptr;
 }
+
+struct StateKey
+{
+    Vector<size_t> data;
+    size_t hash = 0;
+
+    bool operator==(const StateKey& other) const
+    {
+        return (hash == other.hash) && (data == other.data);
+    }
+};
+
+struct StateKeyHash
+{
+    size_t operator()(const StateKey& key) const
+    {
+        return key.hash;
+    }
+};
+
+size_t GetNameKey(const FastName& name)
+{
+    return reinterpret_cast<size_t>(name.c_str());
+}
+
+// sort (key, value) pairs written to data starting from `first`
+void SortPairs(Vector<size_t>& data, size_t first)
+{
+    using SizeTPair = std::pair<size_t, size_t>;
+    SizeTPair* begin = reinterpret_cast<SizeTPair*>(data.data() + first);
+    std::sort(begin, begin + (data.size() - first) / 2, [](const SizeTPair& l, const SizeTPair& r) {
+        return l.first < r.first;
+    });
+}
+
+// Canonical form of local material state that affects its render variants: map entries are sorted by name
+// and property values are compared bitwise, so equal states always produce equal keys
+void BuildStateKey(const NMaterial* parent, const FastName& qualityGroup, const MaterialConfig& config, StateKey& key)
+{
+    Vector<size_t>& data = key.data;
+    data.clear();
+    data.push_back(reinterpret_cast<size_t>(parent));
+    data.push_back(GetNameKey(config.fxName));
+    data.push_back(GetNameKey(qualityGroup));
+
+    data.push_back(config.localFlags.size());
+    size_t first = data.size();
+    for (const auto& flag : config.localFlags)
+    {
+        data.push_back(GetNameKey(flag.first));
+        data.push_back(static_cast<size_t>(flag.second));
+    }
+    SortPairs(data, first);
+
+    data.push_back(config.localTextures.size());
+    first = data.size();
+    for (const auto& texture : config.localTextures)
+    {
+        data.push_back(GetNameKey(texture.first));
+        data.push_back(reinterpret_cast<size_t>(texture.second->texture));
+    }
+    SortPairs(data, first);
+
+    Vector<const NMaterialProperty*> properties;
+    properties.reserve(config.localProperties.size());
+    for (const auto& prop : config.localProperties)
+        properties.push_back(prop.second);
+    std::sort(properties.begin(), properties.end(), [](const NMaterialProperty* l, const NMaterialProperty* r) {
+        return GetNameKey(l->name) < GetNameKey(r->name);
+    });
+
+    data.push_back(properties.size());
+    for (const NMaterialProperty* prop : properties)
+    {
+        data.push_back(GetNameKey(prop->name));
+        data.push_back(prop->type);
+        data.push_back(prop->arraySize);
+        for (uint32 i = 0, sz = ShaderDescriptor::CalculateDataSize(prop->type, prop->arraySize); i < sz; ++i)
+        {
+            uint32 bits = 0;
+            Memcpy(&bits, prop->data.get() + i, sizeof(uint32));
+            data.push_back(bits);
+        }
+    }
+
+    key.hash = BufferHash(reinterpret_cast<const uint8*>(data.data()), static_cast<uint32>(data.size() * sizeof(size_t)));
+}
+
+bool stateSharingEnabled = true;
+NMaterial::RenderStateStats renderStateStats;
+UnorderedMap<uint32, uint32> textureSetRefs;
+
+void TrackTextureSet(rhi::HTextureSet textureSet)
+{
+    if (textureSet.IsValid())
+        ++textureSetRefs[static_cast<uint32>(textureSet)];
+}
+
+void UntrackTextureSet(rhi::HTextureSet textureSet)
+{
+    if (textureSet.IsValid())
+    {
+        auto it = textureSetRefs.find(static_cast<uint32>(textureSet));
+        DVASSERT(it != textureSetRefs.end());
+        if (--it->second == 0)
+            textureSetRefs.erase(it);
+    }
+}
+}
+
+struct NMaterialSharedState
+{
+    NMaterialDetail::StateKey key;
+    NMaterial* prototype = nullptr; //material that actually builds variants, it is not registered as child of its parent
+    uint32 usersCount = 0;
+    bool retired = false; //retired state is not shared with new materials, it is deleted when last user leaves
+};
+
+namespace NMaterialDetail
+{
+UnorderedMap<StateKey, NMaterialSharedState*, StateKeyHash> sharedStates;
 }
 
 const float32 NMaterial::DEFAULT_LIGHTMAP_SIZE = 16.0f;
@@ -63,8 +185,15 @@ struct MaterialBufferBinding
 
 uint32 NMaterialProperty::globalPropertyUpdateSemanticCounter = 0;
 
+RenderVariantInstance::RenderVariantInstance()
+{
+    ++NMaterialDetail::renderStateStats.renderVariants;
+}
+
 RenderVariantInstance::~RenderVariantInstance()
 {
+    --NMaterialDetail::renderStateStats.renderVariants;
+    NMaterialDetail::UntrackTextureSet(textureSet);
     rhi::ReleaseTextureSet(textureSet);
     rhi::ReleaseSamplerState(samplerState);
 }
@@ -140,16 +269,29 @@ NMaterial::~NMaterial()
 {
     DAVA_MEMORY_PROFILER_CLASS_ALLOC_SCOPE();
 
+    ReleaseSharedState(false);
     SetParent(nullptr);
     DVASSERT(children.empty()); //as children reference parent in our material scheme, this should not be released while it has children
 
-    for (auto& buffer : localConstBuffers)
-    {
-        rhi::DeleteConstBuffer(buffer.second->constBuffer);
-        SafeDelete(buffer.second);
-    }
-    for (auto& variant : renderVariants)
-        delete variant.second;
+    ClearLocalBuffers();
+    ClearRenderVariants();
+}
+
+void NMaterial::SetStateSharingEnabled(bool enabled)
+{
+    NMaterialDetail::stateSharingEnabled = enabled;
+}
+
+bool NMaterial::IsStateSharingEnabled()
+{
+    return NMaterialDetail::stateSharingEnabled;
+}
+
+NMaterial::RenderStateStats NMaterial::GetRenderStateStats()
+{
+    RenderStateStats stats = NMaterialDetail::renderStateStats;
+    stats.textureSets = static_cast<uint32>(NMaterialDetail::textureSetRefs.size());
+    return stats;
 }
 
 void NMaterial::BindParams(rhi::Packet& target)
@@ -226,6 +368,9 @@ void NMaterial::BindParams(rhi::Packet& target)
 
 uint32 NMaterial::GetRequiredVertexFormat()
 {
+    if (sharedState != nullptr)
+        return sharedState->prototype->GetRequiredVertexFormat();
+
     uint32 res = 0;
     for (auto& variant : renderVariants)
     {
@@ -394,6 +539,13 @@ void NMaterial::SetPropertyValue(const FastName& propName, const float32* propDa
 
     DVASSERT(prop != nullptr);
 
+    if (sharedState != nullptr)
+    {
+        //copy-on-write: material which properties are animated at runtime is not shared anymore
+        privateState = true;
+        ReleaseSharedState(false);
+    }
+
     prop->SetPropertyValue(propData);
 }
 
@@ -632,6 +784,7 @@ const Vector<NMaterial*>& NMaterial::GetChildren() const
 void NMaterial::AddChildMaterial(NMaterial* material)
 {
     DVASSERT(material);
+    ReleaseSharedState(false); //children need local buffers of their parent
     children.push_back(material);
 }
 
@@ -737,14 +890,103 @@ void NMaterial::ClearLocalBuffers()
     {
         rhi::DeleteConstBuffer(buffer.second->constBuffer);
         SafeDelete(buffer.second);
+        --NMaterialDetail::renderStateStats.constBuffers;
     }
     for (auto& variant : renderVariants)
         variant.second->materialBufferBindings.clear();
     localConstBuffers.clear();
 }
 
+void NMaterial::ClearRenderVariants()
+{
+    activeVariantInstance = nullptr;
+    activeVariantName = FastName();
+    for (auto& variant : renderVariants)
+    {
+        delete variant.second;
+    }
+    renderVariants.clear();
+}
+
+bool NMaterial::CanShareState() const
+{
+    return NMaterialDetail::stateSharingEnabled && (parent != nullptr) && children.empty() && !privateState;
+}
+
+void NMaterial::AcquireSharedState()
+{
+    DAVA_MEMORY_PROFILER_CLASS_ALLOC_SCOPE();
+    DVASSERT(sharedState == nullptr);
+
+    NMaterialDetail::StateKey key;
+    NMaterialDetail::BuildStateKey(parent, qualityGroup, GetCurrentConfig(), key);
+
+    NMaterialSharedState*& state = NMaterialDetail::sharedStates[key];
+    if (state == nullptr)
+    {
+        NMaterial* prototype = new NMaterial();
+        prototype->materialName = materialName;
+        prototype->qualityGroup = qualityGroup;
+        prototype->materialConfigs[0] = GetCurrentConfig();
+        prototype->parent = SafeRetain(parent);
+        prototype->sortingKey = sortingKey;
+        prototype->privateState = true;
+
+        state = new NMaterialSharedState();
+        state->key = key;
+        state->prototype = prototype;
+        ++NMaterialDetail::renderStateStats.sharedStates;
+    }
+
+    //drop variants built before material became a duplicate
+    ClearLocalBuffers();
+    ClearRenderVariants();
+
+    sharedState = state;
+    ++sharedState->usersCount;
+    ++NMaterialDetail::renderStateStats.sharingMaterials;
+
+    needRebuildVariants = false;
+    needRebuildBindings = false;
+    needRebuildTextures = false;
+}
+
+void NMaterial::ReleaseSharedState(bool retire)
+{
+    if (sharedState == nullptr)
+        return;
+
+    NMaterialSharedState* state = sharedState;
+    sharedState = nullptr;
+    activeVariantInstance = nullptr;
+    activeVariantName = FastName();
+    needRebuildVariants = true;
+    --NMaterialDetail::renderStateStats.sharingMaterials;
+
+    //invalidation can come from outside (e.g. shaders reload), so other users move to new state on their next build
+    if (retire && !state->retired)
+    {
+        NMaterialDetail::sharedStates.erase(state->key);
+        state->retired = true;
+    }
+
+    DVASSERT(state->usersCount > 0);
+    if (--state->usersCount == 0)
+    {
+        if (!state->retired)
+            NMaterialDetail::sharedStates.erase(state->key);
+
+        NMaterial* prototype = state->prototype;
+        SafeRelease(prototype->parent);
+        SafeRelease(prototype);
+        SafeDelete(state);
+        --NMaterialDetail::renderStateStats.sharedStates;
+    }
+}
+
 void NMaterial::InvalidateBufferBindings()
 {
+    ReleaseSharedState(true);
     ClearLocalBuffers(); //RHI_COMPLETE - as local buffers can have binding for this property now just clear them all, later rethink to erase just buffers containing this property
     needRebuildBindings = true;
     for (auto& child : children)
@@ -753,6 +995,7 @@ void NMaterial::InvalidateBufferBindings()
 
 void NMaterial::InvalidateTextureBindings()
 {
+    ReleaseSharedState(true);
     // reset existing handle?
     needRebuildTextures = true;
     for (auto& child : children)
@@ -761,6 +1004,7 @@ void NMaterial::InvalidateTextureBindings()
 
 void NMaterial::InvalidateRenderVariants()
 {
+    ReleaseSharedState(true);
     // release existing descriptor?
     ClearLocalBuffers(); // to avoid using incorrect buffers in certain situations (e.g chaning parent)
     needRebuildVariants = true;
@@ -831,13 +1075,7 @@ void NMaterial::RebuildRenderVariants()
     }
 
     /*at least in theory flag changes can lead to changes in number of render passes*/
-    activeVariantInstance = nullptr;
-    activeVariantName = FastName();
-    for (auto& variant : renderVariants)
-    {
-        delete variant.second;
-    }
-    renderVariants.clear();
+    ClearRenderVariants();
 
     for (auto& variantDescr : fxDescr.renderPassDescriptors)
     {
@@ -912,6 +1150,7 @@ void NMaterial::RebuildBindings()
                 {
                     //create buffer
                     bufferBinding = new MaterialBufferBinding();
+                    ++NMaterialDetail::renderStateStats.constBuffers;
 
                     //create handles
                     if (bufferDescr.type == ConstBufferDescriptor::Type::Vertex)
@@ -1003,8 +1242,11 @@ void NMaterial::RebuildTextureBindings()
         RenderVariantInstance* currRenderVariant = variant.second;
 
         //release existing
+        NMaterialDetail::UntrackTextureSet(currRenderVariant->textureSet);
         rhi::ReleaseTextureSet(currRenderVariant->textureSet);
         rhi::ReleaseSamplerState(currRenderVariant->samplerState);
+        currRenderVariant->textureSet = rhi::HTextureSet();
+        currRenderVariant->samplerState = rhi::HSamplerState();
 
         ShaderDescriptor* currShader = currRenderVariant->shader;
         if (!currShader->IsValid()) //cant build for empty shader
@@ -1063,6 +1305,7 @@ void NMaterial::RebuildTextureBindings()
 
         currRenderVariant->textureSet = rhi::AcquireTextureSet(textureDescr);
         currRenderVariant->samplerState = rhi::AcquireSamplerState(samplerDescr);
+        NMaterialDetail::TrackTextureSet(currRenderVariant->textureSet);
     }
 
     needRebuildTextures = false;
@@ -1071,6 +1314,22 @@ void NMaterial::RebuildTextureBindings()
 bool NMaterial::PreBuildMaterial(const FastName& passName)
 {
     DAVA_MEMORY_PROFILER_CLASS_ALLOC_SCOPE();
+
+    if ((sharedState != nullptr) && sharedState->retired)
+        ReleaseSharedState(false);
+    if (needRebuildVariants && CanShareState())
+        AcquireSharedState();
+
+    if (sharedState != nullptr)
+    {
+        //duplicate material - variants are built by prototype and only active one is taken from it
+        NMaterial* prototype = sharedState->prototype;
+        bool res = prototype->PreBuildMaterial(passName);
+        activeVariantName = prototype->activeVariantName;
+        activeVariantInstance = prototype->activeVariantInstance;
+        return res;
+    }
+
     //shader rebuild first - as it sets needRebuildBindings and needRebuildTextures
     if (needRebuildVariants)
         RebuildRenderVariants();
@@ -14,6 +14,7 @@
 namespace DAVA
 {
 struct MaterialBufferBinding;
+struct NMaterialSharedState;
 
 struct NMaterialProperty
 {
@@ -76,7 +77,7 @@ class RenderVariantInstance
     bool alphablend = false;
     bool alphatest = false;
 
-    RenderVariantInstance() = default;
+    RenderVariantInstance();
     RenderVariantInstance(const RenderVariantInstance&) = delete;
     ~RenderVariantInstance();
 };
@@ -188,6 +189,25 @@ public:
     void PreCacheFXWithFlags(const UnorderedMap<FastName, int32>& extraFlags, const FastName& extraFxName = FastName());
     void PreCacheFXVariations(const Vector<FastName>& fxNames, const Vector<FastName>& flags);
 
+    struct RenderStateStats
+    {
+        uint32 constBuffers = 0; //!< Material const buffers alive, including ones injected into parents
+        uint32 textureSets = 0; //!< Unique texture sets referenced by render variants
+        uint32 renderVariants = 0;
+        uint32 sharedStates = 0; //!< Interned state blocks alive
+        uint32 sharingMaterials = 0; //!< Materials rendered with interned state block instead of own variants
+    };
+
+    /**
+        Leaf materials with the same parent, fx name, quality group and equal local flags, property values and
+        textures are considered duplicates: they share render variants, const buffers and texture sets of single
+        interned state block instead of building their own. Material leaves the block as soon as its state changes
+        (copy-on-write); after runtime `SetPropertyValue` on shared material it keeps private state.
+    */
+    static void SetStateSharingEnabled(bool enabled);
+    static bool IsStateSharingEnabled();
+    static RenderStateStats GetRenderStateStats();
+
     static const float32 DEFAULT_LIGHTMAP_SIZE;
 
     enum eUserFlag
@@ -207,6 +227,11 @@ private:
 
     bool NeedLocalOverride(UniquePropertyLayout propertyLayout);
     void ClearLocalBuffers();
+    void ClearRenderVariants();
+
+    bool CanShareState() const;
+    void AcquireSharedState();
+    void ReleaseSharedState(bool retire);
     void InjectChildBuffer(UniquePropertyLayout propLayoutId, MaterialBufferBinding* buffer);
 
     // the following functions will collect data recursively
@@ -243,7 +268,10 @@ private:
     // this is for render passes - not used right now - only active variant instance
     UnorderedMap<FastName, RenderVariantInstance*> renderVariants;
 
+    NMaterialSharedState* sharedState = nullptr;
+
     uint32 sortingKey = 0;
+    bool privateState = false;
     bool needRebuildBindings = true;
     bool needRebuildTextures = true;
     bool needRebuildVariants = true;
@@ -0,0 +1,245 @@
+#include "UnitTests/UnitTests.h"
+
+#include "Base/ScopedPtr.h"
+#include "Engine/Engine.h"
+#include "FileSystem/FileSystem.h"
+#include "Logger/Logger.h"
+#include "Math/Color.h"
+#include "Render/3D/PolygonGroup.h"
+#include "Render/Highlevel/Camera.h"
+#include "Render/Highlevel/GeometryGenerator.h"
+#include "Render/Highlevel/Mesh.h"
+#include "Render/Highlevel/RenderBatch.h"
+#include "Render/Highlevel/RenderPassNames.h"
+#include "Render/Material/NMaterial.h"
+#include "Render/Material/NMaterialNames.h"
+#include "Render/Texture.h"
+#include "Scene3D/Components/ComponentHelpers.h"
+#include "Scene3D/Components/RenderComponent.h"
+#include "Scene3D/Components/TransformComponent.h"
+#include "Scene3D/Entity.h"
+#include "Scene3D/Scene.h"
+#include "Scene3D/SceneFileV2.h"
+#include "Time/SystemTimer.h"
+#include "Utils/StringFormat.h"
+
+using namespace DAVA;
+
+namespace NMaterialSharingTestDetails
+{
+const int32 MESH_COUNT = 2000;
+const int32 STATES_COUNT = 16;
+
+// Every mesh has its own instance material, but there are only STATES_COUNT distinct instance states
+void CreateScene(Scene* scene, const FilePath& folder)
+{
+    ScopedPtr<NMaterial> parentMaterial(new NMaterial());
+    parentMaterial->SetFXName(NMaterialName::TEXTURED_OPAQUE);
+    ScopedPtr<Texture> parentTexture(Texture::CreateFromFile(folder + "textures/parent.tex"));
+    parentMaterial->AddTexture(NMaterialTextureName::TEXTURE_ALBEDO, parentTexture);
+
+    Map<FastName, float32> options;
+    ScopedPtr<PolygonGroup> geometry(GeometryGenerator::GenerateBox(AABBox3(Vector3(-1.f, -1.f, 0.f), Vector3(1.f, 1.f, 2.f)), options));
+    for (int32 i = 0; i < MESH_COUNT; ++i)
+    {
+        int32 state = i % STATES_COUNT;
+
+        ScopedPtr<NMaterial> material(new NMaterial());
+        material->SetParent(parentMaterial);
+        material->AddFlag(NMaterialFlagName::FLAG_FLATCOLOR, 1);
+        Color color(state / float32(STATES_COUNT), 0.5f, 0.5f, 1.f);
+        material->AddProperty(NMaterialParamName::PARAM_FLAT_COLOR, color.color, rhi::ShaderProp::TYPE_FLOAT4);
+        ScopedPtr<Texture> texture(Texture::CreateFromFile(folder + Format("textures/mesh_%d.tex", state % 4)));
+        material->AddTexture(NMaterialTextureName::TEXTURE_ALBEDO, texture);
+
+        ScopedPtr<Mesh> mesh(new Mesh());
+        mesh->AddPolygonGroup(geometry, material);
+
+        ScopedPtr<Entity> entity(new Entity());
+        entity->AddComponent(new RenderComponent(mesh));
+        GetTransformComponent(entity)->SetLocalTranslation(Vector3((i % 50) * 4.f, (i / 50) * 4.f, 0.f));
+        scene->AddNode(entity);
+    }
+}
+
+void CollectMaterials(Entity* entity, Vector<NMaterial*>& materials)
+{
+    RenderObject* ro = GetRenderObject(entity);
+    if (ro != nullptr)
+    {
+        for (uint32 i = 0; i < ro->GetRenderBatchCount(); ++i)
+        {
+            materials.push_back(ro->GetRenderBatch(i)->GetMaterial());
+        }
+    }
+    for (int32 i = 0; i < entity->GetChildrenCount(); ++i)
+    {
+        CollectMaterials(entity->GetChild(i), materials);
+    }
+}
+
+struct LoadResult
+{
+    int64 loadTimeUs = 0;
+    NMaterial::RenderStateStats stats;
+    Vector<uint32> renderLayers;
+};
+
+NMaterial::RenderStateStats GetStatsDelta(const NMaterial::RenderStateStats& from, const NMaterial::RenderStateStats& to)
+{
+    NMaterial::RenderStateStats result;
+    result.constBuffers = to.constBuffers - from.constBuffers;
+    result.textureSets = to.textureSets - from.textureSets;
+    result.renderVariants = to.renderVariants - from.renderVariants;
+    result.sharedStates = to.sharedStates - from.sharedStates;
+    result.sharingMaterials = to.sharingMaterials - from.sharingMaterials;
+    return result;
+}
+
+// Loads scene and draws one frame, render variants are built during load
+LoadResult LoadScene(const FilePath& scenePath, bool stateSharing)
+{
+    NMaterial::SetStateSharingEnabled(stateSharing);
+    NMaterial::RenderStateStats initialStats = NMaterial::GetRenderStateStats();
+
+    LoadResult result;
+    ScopedPtr<Scene> scene(new Scene());
+    int64 startTime = SystemTimer::GetUs();
+    TEST_VERIFY(scene->LoadScene(scenePath) == SceneFileV2::ERROR_NO_ERROR);
+    result.loadTimeUs = SystemTimer::GetUs() - startTime;
+
+    Vector<NMaterial*> materials;
+    CollectMaterials(scene, materials);
+    TEST_VERIFY(materials.size() == MESH_COUNT);
+    for (NMaterial* material : materials)
+    {
+        TEST_VERIFY(material->PreBuildMaterial(PASS_FORWARD));
+        result.renderLayers.push_back(material->GetRenderLayerID());
+    }
+
+    ScopedPtr<Camera> camera(new Camera());
+    camera->SetupPerspective(70.f, 1.f, 1.f, 500.f);
+    camera->SetUp(Vector3(0.f, 0.f, 1.f));
+    camera->SetPosition(Vector3(-10.f, -10.f, 50.f));
+    camera->SetTarget(Vector3(100.f, 80.f, 0.f));
+    scene->AddCamera(camera);
+    scene->SetCurrentCamera(camera);
+    scene->Update(0.016f);
+    scene->Draw();
+
+    result.stats = GetStatsDelta(initialStats, NMaterial::GetRenderStateStats());
+    return result;
+}
+}
+
+DAVA_TESTCLASS (NMaterialSharingTest)
+{
+    FilePath testFolder;
+    bool stateSharingEnabled = true;
+
+    NMaterialSharingTest()
+    {
+        FileSystem* fs = GetEngineContext()->fileSystem;
+        testFolder = fs->GetTempDirectoryPath();
+        testFolder.MakeDirectoryPathname();
+        testFolder += "NMaterialSharingTest/";
+        fs->DeleteDirectory(testFolder, true);
+        fs->CreateDirectory(testFolder, true);
+
+        stateSharingEnabled = NMaterial::IsStateSharingEnabled();
+    }
+
+    ~NMaterialSharingTest()
+    {
+        NMaterial::SetStateSharingEnabled(stateSharingEnabled);
+        GetEngineContext()->fileSystem->DeleteDirectory(testFolder, true);
+    }
+
+    DAVA_TEST (CopyOnWriteTest)
+    {
+        NMaterial::SetStateSharingEnabled(true);
+        NMaterial::RenderStateStats initialStats = NMaterial::GetRenderStateStats();
+
+        ScopedPtr<NMaterial> parentMaterial(new NMaterial());
+        parentMaterial->SetFXName(NMaterialName::TEXTURED_OPAQUE);
+
+        Color red(1.f, 0.f, 0.f, 1.f);
+        Vector<ScopedPtr<NMaterial>> materials;
+        for (int32 i = 0; i < 3; ++i)
+        {
+            materials.emplace_back(new NMaterial());
+            materials.back()->SetParent(parentMaterial);
+            materials.back()->AddFlag(NMaterialFlagName::FLAG_FLATCOLOR, 1);
+            materials.back()->AddProperty(NMaterialParamName::PARAM_FLAT_COLOR, red.color, rhi::ShaderProp::TYPE_FLOAT4);
+            TEST_VERIFY(materials.back()->PreBuildMaterial(PASS_FORWARD));
+        }
+
+        NMaterial::RenderStateStats stats = NMaterial::GetRenderStateStats();
+        TEST_VERIFY(stats.sharedStates - initialStats.sharedStates == 1);
+        TEST_VERIFY(stats.sharingMaterials - initialStats.sharingMaterials == 3);
+        TEST_VERIFY(materials[0]->GetRenderLayerID() == materials[1]->GetRenderLayerID());
+
+        // runtime write detaches material, others keep sharing
+        Color green(0.f, 1.f, 0.f, 1.f);
+        materials[0]->SetPropertyValue(NMaterialParamName::PARAM_FLAT_COLOR, green.color);
+        TEST_VERIFY(materials[0]->PreBuildMaterial(PASS_FORWARD));
+        TEST_VERIFY(materials[1]->PreBuildMaterial(PASS_FORWARD));
+        stats = NMaterial::GetRenderStateStats();
+        TEST_VERIFY(stats.sharingMaterials - initialStats.sharingMaterials == 2);
+        TEST_VERIFY(Memcmp(materials[0]->GetEffectivePropValue(NMaterialParamName::PARAM_FLAT_COLOR), green.color, sizeof(green.color)) == 0);
+        TEST_VERIFY(Memcmp(materials[1]->GetEffectivePropValue(NMaterialParamName::PARAM_FLAT_COLOR), red.color, sizeof(red.color)) == 0);
+
+        // structural change moves material to another state block
+        materials[2]->AddFlag(NMaterialFlagName::FLAG_FLATALBEDO, 1);
+        TEST_VERIFY(materials[2]->PreBuildMaterial(PASS_FORWARD));
+        TEST_VERIFY(materials[1]->PreBuildMaterial(PASS_FORWARD));
+        stats = NMaterial::GetRenderStateStats();
+        TEST_VERIFY(stats.sharedStates - initialStats.sharedStates == 2);
+        TEST_VERIFY(stats.sharingMaterials - initialStats.sharingMaterials == 2);
+
+        // material with children can't be shared
+        ScopedPtr<NMaterial> child(new NMaterial());
+        child->SetParent(materials[1]);
+        TEST_VERIFY(materials[1]->PreBuildMaterial(PASS_FORWARD));
+        TEST_VERIFY(child->PreBuildMaterial(PASS_FORWARD));
+        stats = NMaterial::GetRenderStateStats();
+        TEST_VERIFY(stats.sharingMaterials - initialStats.sharingMaterials == 1);
+        child->SetParent(nullptr);
+
+        materials.clear();
+        stats = NMaterial::GetRenderStateStats();
+        TEST_VERIFY(stats.sharedStates == initialStats.sharedStates);
+        TEST_VERIFY(stats.sharingMaterials == initialStats.sharingMaterials);
+    }
+
+    DAVA_TEST (SceneLoadBenchmark)
+    {
+        using namespace NMaterialSharingTestDetails;
+
+        FilePath scenePath = testFolder + "instances.sc2";
+        {
+            ScopedPtr<Scene> scene(new Scene());
+            CreateScene(scene, testFolder);
+            TEST_VERIFY(scene->SaveScene(scenePath) == SceneFileV2::ERROR_NO_ERROR);
+        }
+
+        LoadScene(scenePath, true); // warm up shader and fx caches
+        LoadResult unique = LoadScene(scenePath, false);
+        LoadResult shared = LoadScene(scenePath, true);
+
+        TEST_VERIFY(unique.renderLayers == shared.renderLayers);
+        TEST_VERIFY(unique.stats.sharingMaterials == 0);
+        TEST_VERIFY(shared.stats.sharingMaterials == MESH_COUNT);
+        TEST_VERIFY(shared.stats.sharedStates == STATES_COUNT);
+        TEST_VERIFY(shared.stats.constBuffers < unique.stats.constBuffers);
+        TEST_VERIFY(shared.stats.renderVariants < unique.stats.renderVariants);
+        TEST_VERIFY(shared.stats.textureSets <= unique.stats.textureSets);
+
+        Logger::Info("NMaterial sharing benchmark (%d instances, %d states): "
+                     "unique %lld us, %u const buffers, %u texture sets, %u variants; "
+                     "shared %lld us, %u const buffers, %u texture sets, %u variants",
+                     MESH_COUNT, STATES_COUNT,
+                     unique.loadTimeUs, unique.stats.constBuffers, unique.stats.textureSets, unique.stats.renderVariants,
+                     shared.loadTimeUs, shared.stats.constBuffers, shared.stats.textureSets, shared.stats.renderVariants);
+    }
+};
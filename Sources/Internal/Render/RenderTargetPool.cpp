@@ -0,0 +1,99 @@
+#include "Render/RenderTargetPool.h"
+#include "Render/RHI/Common/rhi_Utils.h"
+
+#include "Debug/DVAssert.h"
+
+namespace DAVA
+{
+RenderTargetPool::~RenderTargetPool()
+{
+    Clear();
+}
+
+rhi::HTexture RenderTargetPool::Acquire(const RenderTargetDescriptor& descriptor)
+{
+    DVASSERT(descriptor.width > 0 && descriptor.height > 0);
+
+    for (Entry& entry : entries)
+    {
+        if (!entry.inUse && entry.descriptor == descriptor)
+        {
+            entry.inUse = true;
+            entry.lastUsedFrame = frameIndex;
+            return entry.texture;
+        }
+    }
+
+    rhi::Texture::Descriptor textureDescriptor;
+    textureDescriptor.width = descriptor.width;
+    textureDescriptor.height = descriptor.height;
+    textureDescriptor.format = descriptor.format;
+    textureDescriptor.type = rhi::TEXTURE_TYPE_2D;
+    textureDescriptor.autoGenMipmaps = false;
+    textureDescriptor.isRenderTarget = !descriptor.IsDepthStencil();
+    textureDescriptor.needRestore = false;
+
+    Entry entry;
+    entry.descriptor = descriptor;
+    entry.texture = rhi::CreateTexture(textureDescriptor);
+    entry.memory = rhi::TextureSize(descriptor.format, descriptor.width, descriptor.height);
+    entry.lastUsedFrame = frameIndex;
+    entry.inUse = true;
+    entries.push_back(entry);
+
+    allocatedMemory += entry.memory;
+    peakAllocatedMemory = Max(peakAllocatedMemory, allocatedMemory);
+
+    return entry.texture;
+}
+
+void RenderTargetPool::Release(rhi::HTexture texture)
+{
+    for (Entry& entry : entries)
+    {
+        if (entry.texture == texture)
+        {
+            DVASSERT(entry.inUse);
+            entry.inUse = false;
+            return;
+        }
+    }
+
+    DVASSERT(false, "Texture was not acquired from this pool");
+}
+
+void RenderTargetPool::EndFrame()
+{
+    ++frameIndex;
+
+    auto isExpired = [this](const Entry& entry) {
+        return !entry.inUse && frameIndex - entry.lastUsedFrame > framesToKeep;
+    };
+
+    for (const Entry& entry : entries)
+    {
+        if (isExpired(entry))
+        {
+            rhi::DeleteTexture(entry.texture);
+            allocatedMemory -= entry.memory;
+        }
+    }
+    entries.erase(std::remove_if(entries.begin(), entries.end(), isExpired), entries.end());
+}
+
+void RenderTargetPool::Clear()
+{
+    for (const Entry& entry : entries)
+    {
+        DVASSERT(!entry.inUse);
+        rhi::DeleteTexture(entry.texture);
+    }
+    entries.clear();
+    allocatedMemory = 0;
+}
+
+uint32 RenderTargetPool::GetTexturesInUseCount() const
+{
+    return static_cast<uint32>(std::count_if(entries.begin(), entries.end(), [](const Entry& entry) { return entry.inUse; }));
+}
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Base/BaseTypes.h"
+#include "Render/RHI/rhi_Public.h"
+
+namespace DAVA
+{
+struct RenderTargetDescriptor
+{
+    uint32 width = 0;
+    uint32 height = 0;
+    rhi::TextureFormat format = rhi::TEXTURE_FORMAT_R8G8B8A8;
+
+    RenderTargetDescriptor() = default;
+    RenderTargetDescriptor(uint32 width, uint32 height, rhi::TextureFormat format);
+
+    bool IsDepthStencil() const;
+    bool operator==(const RenderTargetDescriptor& other) const;
+};
+
+/**
+    Pool of render target textures reused between passes and frames.
+
+    `Acquire` returns free texture with exactly matching descriptor or creates new one, `Release` returns it
+    to the pool. Textures that were not acquired during `framesToKeep` frames are deleted in `EndFrame`.
+    Contents of acquired texture are undefined.
+*/
+class RenderTargetPool
+{
+public:
+    RenderTargetPool() = default;
+    ~RenderTargetPool();
+
+    rhi::HTexture Acquire(const RenderTargetDescriptor& descriptor);
+    void Release(rhi::HTexture texture);
+
+    void EndFrame();
+    void Clear();
+
+    void SetFramesToKeep(uint32 frames);
+
+    uint32 GetTexturesCount() const;
+    uint32 GetTexturesInUseCount() const;
+
+    /** Memory of all textures owned by pool, in bytes. */
+    uint32 GetAllocatedMemory() const;
+    uint32 GetPeakAllocatedMemory() const;
+    void ResetPeakAllocatedMemory();
+
+private:
+    struct Entry
+    {
+        RenderTargetDescriptor descriptor;
+        rhi::HTexture texture;
+        uint32 memory = 0;
+        uint32 lastUsedFrame = 0;
+        bool inUse = false;
+    };
+
+    Vector<Entry> entries;
+    uint32 frameIndex = 0;
+    uint32 framesToKeep = 30;
+    uint32 allocatedMemory = 0;
+    uint32 peakAllocatedMemory = 0;
+};
+
+inline RenderTargetDescriptor::RenderTargetDescriptor(uint32 width_, uint32 height_, rhi::TextureFormat format_)
+    : width(width_)
+    , height(height_)
+    , format(format_)
+{
+}
+
+inline bool RenderTargetDescriptor::IsDepthStencil() const
+{
+    return format == rhi::TEXTURE_FORMAT_D16 || format == rhi::TEXTURE_FORMAT_D24S8;
+}
+
+inline bool RenderTargetDescriptor::operator==(const RenderTargetDescriptor& other) const
+{
+    return width == other.width && height == other.height && format == other.format;
+}
+
+inline void RenderTargetPool::SetFramesToKeep(uint32 frames)
+{
+    framesToKeep = frames;
+}
+
+inline uint32 RenderTargetPool::GetTexturesCount() const
+{
+    return static_cast<uint32>(entries.size());
+}
+
+inline uint32 RenderTargetPool::GetAllocatedMemory() const
+{
+    return allocatedMemory;
+}
+
+inline uint32 RenderTargetPool::GetPeakAllocatedMemory() const
+{
+    return peakAllocatedMemory;
+}
+
+inline void RenderTargetPool::ResetPeakAllocatedMemory()
+{
+    peakAllocatedMemory = allocatedMemory;
+}
+}
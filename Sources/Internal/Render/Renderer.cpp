@@ -300,6 +300,10 @@ void RenderStats::Reset()
     batches2d = 0U;
     packets2d = 0U;
 
+    renderPackets3d = 0U;
+    triangles3d = 0U;
+    layerBatches.clear();
+
     visibleRenderObjects = 0U;
     occludedRenderObjects = 0U;
 
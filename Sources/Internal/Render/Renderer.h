@@ -91,6 +91,10 @@ struct RenderStats
     uint32 batches2d = 0U;
     uint32 packets2d = 0U;
 
+    uint32 renderPackets3d = 0U;
+    uint32 triangles3d = 0U;
+    UnorderedMap<FastName, uint32> layerBatches = UnorderedMap<FastName, uint32>(16);
+
     uint32 visibleRenderObjects = 0U;
     uint32 occludedRenderObjects = 0U;
 
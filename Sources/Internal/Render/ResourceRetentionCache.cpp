@@ -0,0 +1,150 @@
+#include "Render/ResourceRetentionCache.h"
+
+#include "Concurrency/LockGuard.h"
+#include "Debug/DVAssert.h"
+
+namespace DAVA
+{
+void ResourceRetentionCache::SetEnabled(bool enabled_)
+{
+    {
+        LockGuard<Mutex> guard(mutex);
+        enabled = enabled_;
+    }
+
+    if (!enabled_)
+    {
+        Clear();
+    }
+}
+
+void ResourceRetentionCache::SetBudget(uint32 bytes)
+{
+    {
+        LockGuard<Mutex> guard(mutex);
+        budget = bytes;
+    }
+    Trim();
+}
+
+bool ResourceRetentionCache::Put(const FilePath& pathname, BaseObject* resource, uint32 memory, eGPUFamily gpu, PixelFormat format)
+{
+    DVASSERT(resource != nullptr);
+
+    LockGuard<Mutex> guard(mutex);
+    if (!enabled || memory > budget || pathname.IsEmpty())
+    {
+        return false;
+    }
+
+    if (entriesMap.count(pathname) != 0)
+    {
+        DVASSERT(false, "Resource with the same path is already kept in retention cache");
+        return false;
+    }
+
+    Entry entry;
+    entry.pathname = pathname;
+    entry.resource = resource;
+    entry.memory = memory;
+    entry.gpu = gpu;
+    entry.format = format;
+    entries.push_front(entry);
+    entriesMap[pathname] = entries.begin();
+
+    stats.resourcesCount++;
+    stats.memory += memory;
+    if (memory > 0)
+    {
+        stats.memoryByFormat[std::make_pair(gpu, format)] += memory;
+    }
+    return true;
+}
+
+BaseObject* ResourceRetentionCache::Take(const FilePath& pathname)
+{
+    LockGuard<Mutex> guard(mutex);
+
+    auto found = entriesMap.find(pathname);
+    if (found == entriesMap.end())
+    {
+        stats.misses++;
+        return nullptr;
+    }
+
+    BaseObject* resource = found->second->resource;
+    RemoveEntry(found->second);
+    stats.hits++;
+    return resource;
+}
+
+void ResourceRetentionCache::Trim()
+{
+    uint32 budgetToFit = 0;
+    {
+        LockGuard<Mutex> guard(mutex);
+        budgetToFit = budget;
+    }
+    Evict(budgetToFit);
+}
+
+void ResourceRetentionCache::Clear()
+{
+    Evict(0);
+}
+
+void ResourceRetentionCache::Evict(uint32 budgetToFit)
+{
+    // Releasing resource may take owner's locks or put other resources (e.g. textures of sprite) to caches,
+    // so resources are released after cache is unlocked
+    Vector<BaseObject*> evicted;
+    {
+        LockGuard<Mutex> guard(mutex);
+        while (!entries.empty() && (stats.memory > budgetToFit || budgetToFit == 0))
+        {
+            auto last = std::prev(entries.end());
+            evicted.push_back(last->resource);
+            RemoveEntry(last);
+            stats.evictions++;
+        }
+    }
+
+    for (BaseObject* resource : evicted)
+    {
+        resource->Release();
+    }
+}
+
+void ResourceRetentionCache::RemoveEntry(EntryList::iterator it)
+{
+    if (it->memory > 0)
+    {
+        auto formatMemory = stats.memoryByFormat.find(std::make_pair(it->gpu, it->format));
+        DVASSERT(formatMemory != stats.memoryByFormat.end() && formatMemory->second >= it->memory);
+        formatMemory->second -= it->memory;
+        if (formatMemory->second == 0)
+        {
+            stats.memoryByFormat.erase(formatMemory);
+        }
+    }
+
+    stats.resourcesCount--;
+    stats.memory -= it->memory;
+    entriesMap.erase(it->pathname);
+    entries.erase(it);
+}
+
+ResourceRetentionCache::Stats ResourceRetentionCache::GetStats() const
+{
+    LockGuard<Mutex> guard(mutex);
+    return stats;
+}
+
+void ResourceRetentionCache::ResetStats()
+{
+    LockGuard<Mutex> guard(mutex);
+    stats.hits = 0;
+    stats.misses = 0;
+    stats.evictions = 0;
+}
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Base/BaseTypes.h"
+#include "Base/BaseObject.h"
+#include "Concurrency/Mutex.h"
+#include "FileSystem/FilePath.h"
+#include "Render/RenderBase.h"
+
+namespace DAVA
+{
+/**
+    LRU cache of file resources (textures, sprites) released by all their users, but kept alive
+    to be reused on next request of the same file instead of loading it again.
+
+    Cache is disabled by default. When enabled, owner of resources passes last reference of released
+    resource to `Put` and asks for it in `Take` before loading file. Memory of kept resources is limited
+    by budget: `Trim` releases least recently put resources until memory fits budget. `Put` never releases
+    resources itself, so it can be called under locks which resource destruction also takes.
+    Kept resources are not released in destructor, `Clear` should be called while renderer is alive.
+*/
+class ResourceRetentionCache
+{
+public:
+    struct Stats
+    {
+        uint32 hits = 0; //!< resources returned by `Take`
+        uint32 misses = 0; //!< `Take` calls for resources missing in cache, i.e. loads of files
+        uint32 evictions = 0; //!< resources released by cache
+        uint32 resourcesCount = 0;
+        uint32 memory = 0;
+        Map<std::pair<eGPUFamily, PixelFormat>, uint32> memoryByFormat;
+    };
+
+    /** Disabling cache releases all kept resources. */
+    void SetEnabled(bool enabled);
+    bool IsEnabled() const;
+
+    void SetBudget(uint32 bytes);
+    uint32 GetBudget() const;
+
+    /**
+        Takes ownership of `resource` reference if cache is enabled and resource fits budget.
+        Returns false if resource was not taken, caller should release it then.
+    */
+    bool Put(const FilePath& pathname, BaseObject* resource, uint32 memory, eGPUFamily gpu, PixelFormat format);
+
+    /** Returns resource with ownership of its reference or nullptr. */
+    BaseObject* Take(const FilePath& pathname);
+
+    /** Releases least recently put resources until their memory fits budget. */
+    void Trim();
+    /** Releases all kept resources. */
+    void Clear();
+
+    Stats GetStats() const;
+    void ResetStats();
+
+private:
+    struct Entry
+    {
+        FilePath pathname;
+        BaseObject* resource = nullptr;
+        uint32 memory = 0;
+        eGPUFamily gpu = GPU_ORIGIN;
+        PixelFormat format = FORMAT_INVALID;
+    };
+
+    using EntryList = List<Entry>;
+
+    void Evict(uint32 budgetToFit);
+    void RemoveEntry(EntryList::iterator it);
+
+    mutable Mutex mutex;
+    EntryList entries; // most recently put are at the front
+    Map<FilePath, EntryList::iterator> entriesMap;
+    Stats stats;
+    uint32 budget = 64 * 1024 * 1024;
+    bool enabled = false;
+};
+
+inline bool ResourceRetentionCache::IsEnabled() const
+{
+    return enabled;
+}
+
+inline uint32 ResourceRetentionCache::GetBudget() const
+{
+    return budget;
+}
+}
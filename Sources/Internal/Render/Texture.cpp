@@ -191,6 +191,7 @@ public:
 static TextureMemoryUsageInfo texMemoryUsageInfo;
 
 TexturesMap Texture::textureMap;
+ResourceRetentionCache Texture::retentionCache;
 Vector<eGPUFamily> Texture::gpuLoadingOrder;
 
 Mutex Texture::textureMapMutex;
@@ -214,6 +215,26 @@ Texture* Texture::Get(const FilePath& pathName)
     return texture;
 }
 
+Texture* Texture::TakeFromRetentionCache(const FilePath& pathName)
+{
+    LockGuard<Mutex> guard(textureMapMutex);
+
+    // texture could be loaded or taken by other thread after lookup in Get
+    TexturesMap::iterator it = textureMap.find(FILEPATH_MAP_KEY(pathName));
+    if (it != textureMap.end())
+    {
+        it->second->Retain();
+        return it->second;
+    }
+
+    Texture* texture = static_cast<Texture*>(retentionCache.Take(pathName));
+    if (texture != nullptr)
+    {
+        textureMap[FILEPATH_MAP_KEY(pathName)] = texture;
+    }
+    return texture;
+}
+
 void Texture::AddToMap(Texture* tex)
 {
     if (!tex->texDescriptor->pathname.IsEmpty())
@@ -759,6 +780,10 @@ Texture* Texture::PureCreate(const FilePath& pathName, const FastName& group)
     if (texture)
         return texture;
 
+    texture = TakeFromRetentionCache(descriptorPathname);
+    if (texture)
+        return texture;
+
     TextureDescriptor* descriptor(TextureDescriptor::CreateFromFile(descriptorPathname));
     if (nullptr == descriptor)
         return nullptr;
@@ -866,13 +891,38 @@ int32 Texture::Release()
 {
     if (GetRetainCount() == 1)
     {
+        bool retained = false;
+
         textureMapMutex.Lock();
-        textureMap.erase(FILEPATH_MAP_KEY(texDescriptor->pathname));
+        // map can already contain other texture with the same path, if this one was evicted from retention cache
+        TexturesMap::iterator it = textureMap.find(FILEPATH_MAP_KEY(texDescriptor->pathname));
+        if (it != textureMap.end() && it->second == this)
+        {
+            textureMap.erase(it);
+            retained = IsRetainable() && retentionCache.Put(texDescriptor->pathname, this, GetDataSize(), loadedAsFile, GetFormat());
+        }
         textureMapMutex.Unlock();
+
+        if (retained)
+        {
+            // last reference is owned by retention cache now
+            retentionCache.Trim();
+            return 0;
+        }
     }
     return BaseObject::Release();
 }
 
+bool Texture::IsRetainable() const
+{
+    return !isRenderTarget && !isPink && state == STATE_VALID && texDescriptor->pathname.GetType() != FilePath::PATH_IN_MEMORY;
+}
+
+ResourceRetentionCache& Texture::GetRetentionCache()
+{
+    return retentionCache;
+}
+
 Texture* Texture::CreateFBO(const Texture::FBODescriptor& fboDesc)
 {
     DAVA_MEMORY_PROFILER_CLASS_ALLOC_SCOPE();
@@ -1135,6 +1185,7 @@ bool Texture::IsPinkPlaceholder()
 void Texture::SetGPULoadingOrder(const Vector<eGPUFamily>& gpuLoadingOrder_)
 {
     gpuLoadingOrder = gpuLoadingOrder_;
+    retentionCache.Clear();
 }
 
 const Vector<eGPUFamily>& Texture::GetGPULoadingOrder()
@@ -1208,6 +1259,9 @@ void Texture::SetPixelization(bool value)
         texture->SetMinMagFilter(minFilter, magFilter, mipFilter);
     }
     textureMapMutex.Unlock();
+
+    // retained textures have filters of previous mode; cleared after unlock, as Texture::Release takes textureMapMutex
+    retentionCache.Clear();
     //RHI_COMPLETE
 }
 
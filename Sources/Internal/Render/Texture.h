@@ -9,6 +9,7 @@
 #include "Concurrency/Mutex.h"
 #include "Render/RHI/rhi_Public.h"
 #include "Render/RenderBase.h"
+#include "Render/ResourceRetentionCache.h"
 #include "Render/UniqueStateSet.h"
 
 #include "MemoryManager/MemoryProfiler.h"
@@ -169,6 +170,14 @@ public:
 
     static const TexturesMap& GetTextureMap();
 
+    /**
+        \brief Cache of released textures loaded from files, disabled by default.
+        When cache is enabled, texture released by all users is kept in it and is returned by next PureCreate
+        or CreateFromFile of the same file instead of loading. Cache is cleared when GPU loading order
+        or texture quality is changed and on low memory.
+     */
+    static ResourceRetentionCache& GetRetentionCache();
+
     uint32 GetDataSize() const;
 
     static void SetGPULoadingOrder(const Vector<eGPUFamily>& gpuLoadingOrder);
@@ -194,6 +203,9 @@ protected:
     void ReleaseTextureData();
 
     static void AddToMap(Texture* tex);
+    static Texture* TakeFromRetentionCache(const FilePath& pathName);
+
+    bool IsRetainable() const;
 
     static Texture* CreateFromImage(TextureDescriptor* descriptor, eGPUFamily gpu);
 
@@ -237,6 +249,7 @@ public: // properties for fast access
     static Mutex textureMapMutex;
 
     static TexturesMap textureMap;
+    static ResourceRetentionCache retentionCache;
     static Vector<eGPUFamily> gpuLoadingOrder;
 
     static bool pixelizationFlag;
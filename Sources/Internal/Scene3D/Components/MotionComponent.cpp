@@ -183,6 +183,11 @@ void MotionComponent::ReloadFromFile()
 }
 
 Vector<FilePath> MotionComponent::GetDependencies() const
+{
+    return GetDescriptorDependencies(descriptorPath);
+}
+
+Vector<FilePath> MotionComponent::GetDescriptorDependencies(const FilePath& descriptorPath)
 {
     Vector<FilePath> result;
 
@@ -207,7 +212,7 @@ Vector<FilePath> MotionComponent::GetDependencies() const
     return result;
 }
 
-void MotionComponent::GetDependenciesRecursive(const YamlNode* node, Set<FilePath>* dependencies) const
+void MotionComponent::GetDependenciesRecursive(const YamlNode* node, Set<FilePath>* dependencies)
 {
     if (node != nullptr)
     {
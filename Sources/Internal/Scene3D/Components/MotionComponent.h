@@ -42,10 +42,12 @@ public:
     const Vector3& GetRootOffsetDelta() const;
 
     Vector<FilePath> GetDependencies() const;
+    /** Return `descriptorPath` and animation clips it references, can be used without component instance. */
+    static Vector<FilePath> GetDescriptorDependencies(const FilePath& descriptorPath);
 
 protected:
     void ReloadFromFile();
-    void GetDependenciesRecursive(const YamlNode* node, Set<FilePath>* dependencies) const;
+    static void GetDependenciesRecursive(const YamlNode* node, Set<FilePath>* dependencies);
 
     FilePath descriptorPath;
     Vector<MotionLayer*> motionLayers;
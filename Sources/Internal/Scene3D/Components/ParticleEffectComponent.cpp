@@ -1,6 +1,6 @@
 #include "Scene3D/Components/ParticleEffectComponent.h"
 #include "Scene3D/Components/RenderComponent.h"
-#include "Scene3D/Components/TransformComponent.h"
+#include "Scene3D/Components/TransformComponent.h"
 #include "Scene3D/Entity.h"
 #include "Scene3D/Components/ComponentHelpers.h"
 #include "Scene3D/Lod/LodComponent.h"
@@ -24,6 +24,7 @@ DAVA_VIRTUAL_REFLECTION_IMPL(ParticleEffectComponent)
     .Field("effectDuration", &ParticleEffectComponent::effectDuration)[M::DisplayName("Duration")]
     .Field("clearOnRestart", &ParticleEffectComponent::clearOnRestart)[M::DisplayName("Clear On Restart")]
     .Field("startFromTime", &ParticleEffectComponent::GetStartFromTime, &ParticleEffectComponent::SetStartFromTime)[M::DisplayName("Start From Time")]
+    .Field("visibilityThrottling", &ParticleEffectComponent::IsVisibilityThrottlingEnabled, &ParticleEffectComponent::SetVisibilityThrottlingEnabled)[M::DisplayName("Throttle When Invisible")]
     .Field("visibleReflection", &ParticleEffectComponent::GetReflectionVisible, &ParticleEffectComponent::SetReflectionVisible)[M::DisplayName("Visible Reflection")]
     .Field("visibleRefraction", &ParticleEffectComponent::GetRefractionVisible, &ParticleEffectComponent::SetRefractionVisible)[M::DisplayName("Visible Refraction")]
     .Field("clippingVisible", &ParticleEffectComponent::GetClippingVisible, &ParticleEffectComponent::SetClippingVisible)[M::DisplayName("Clipping always visible")]
@@ -72,6 +73,7 @@ Component* ParticleEffectComponent::Clone(Entity* toEntity)
     newComponent->effectDuration = effectDuration;
     newComponent->clearOnRestart = clearOnRestart;
     newComponent->startFromTime = startFromTime;
+    newComponent->visibilityThrottling = visibilityThrottling;
 
     for (const auto& instance : emitterInstances)
     {
@@ -294,6 +296,7 @@ void ParticleEffectComponent::Serialize(KeyedArchive* archive, SerializationCont
     archive->SetBool("pe.clearOnRestart", clearOnRestart);
     archive->SetUInt32("pe.emittersCount", static_cast<uint32>(emitterInstances.size()));
     archive->SetFloat("pe.startFromTime", startFromTime);
+    archive->SetBool("pe.visibilityThrottling", visibilityThrottling);
     KeyedArchive* emittersArch = new KeyedArchive();
     for (uint32 i = 0; i < emitterInstances.size(); ++i)
     {
@@ -326,6 +329,7 @@ void ParticleEffectComponent::Deserialize(KeyedArchive* archive, SerializationCo
         clearOnRestart = archive->GetBool("pe.clearOnRestart");
         uint32 emittersCount = archive->GetUInt32("pe.emittersCount");
         startFromTime = archive->GetFloat("pe.startFromTime");
+        visibilityThrottling = archive->GetBool("pe.visibilityThrottling", true);
         KeyedArchive* emittersArch = archive->GetArchive("pe.emitters");
         emitterInstances.resize(emittersCount);
         for (uint32 i = 0; i < emittersCount; ++i)
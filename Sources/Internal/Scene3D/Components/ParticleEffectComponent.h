@@ -3,6 +3,7 @@
 #include "Entity/Component.h"
 #include "Scene3D/Entity.h"
 #include "Scene3D/SceneFile/SerializationContext.h"
+#include "Particles/ParticleCollisionHeightField.h"
 #include "Particles/ParticleGroup.h"
 #include "Particles/ParticleRenderObject.h"
 #include "Particles/ParticleEmitterInstance.h"
@@ -14,6 +15,15 @@
 namespace DAVA
 {
 class ModifiablePropertyLineBase;
+
+/** Impact of particle with landscape or static geometry, reported by layer SCENE_COLLISION forces. */
+struct ParticleCollisionEvent
+{
+    Vector3 position;
+    Vector3 normal;
+    float32 speed = 0.0f;
+    ParticleLayer* layer = nullptr;
+};
 class ParticleEffectComponent : public Component
 {
     friend class ParticleEffectSystem;
@@ -79,6 +89,13 @@ public:
     float32 GetStartFromTime() const;
     void SetStartFromTime(float32 time);
 
+    /*if enabled, looped effect is updated less often or suspended while it is not visible (see ParticleEffectSystem::VisibilitySettings)*/
+    bool IsVisibilityThrottlingEnabled() const;
+    void SetVisibilityThrottlingEnabled(bool enabled);
+
+    /*impacts of particles during last system update, up to ParticleEffectSystem::CollisionSettings::maxEventsPerEffect*/
+    inline const Vector<ParticleCollisionEvent>& GetCollisionEvents() const;
+
     inline eState GetAnimationState() const;
     inline ParticleRenderObject* GetRenderObject() const;
 
@@ -115,6 +132,15 @@ private:
     bool stopWhenEmpty = false; //if true effect is considered finished when no particles left, otherwise effect is considered finished if time>effectDuration
     bool clearOnRestart = true; // when effect is restarted repeatsCount
     bool isPaused = false;
+    bool visibilityThrottling = true;
+
+    float32 invisibleTime = 0.0f; // time since effect was rendered last time
+    float32 pendingTime = 0.0f; // simulation time skipped while effect was throttled or suspended
+
+    /*scene collision*/
+    Vector<ParticleCollisionEvent> collisionEvents;
+    RefPtr<ParticleCollisionHeightField> collisionHeightField; // built lazily around effect by ParticleEffectSystem
+    uint32 collisionCacheVersion = 0;
 
 public: //mostly editor commands
     uint32 GetEmittersCount() const;
@@ -157,6 +183,21 @@ inline void ParticleEffectComponent::SetStartFromTime(float32 time)
     startFromTime = Clamp(time, 0.0f, effectDuration);
 }
 
+inline bool ParticleEffectComponent::IsVisibilityThrottlingEnabled() const
+{
+    return visibilityThrottling;
+}
+
+inline void ParticleEffectComponent::SetVisibilityThrottlingEnabled(bool enabled)
+{
+    visibilityThrottling = enabled;
+}
+
+inline const Vector<ParticleCollisionEvent>& ParticleEffectComponent::GetCollisionEvents() const
+{
+    return collisionEvents;
+}
+
 ParticleEffectComponent::eState ParticleEffectComponent::GetAnimationState() const
 {
     return state;
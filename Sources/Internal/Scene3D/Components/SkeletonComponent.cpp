@@ -25,6 +25,7 @@ DAVA_VIRTUAL_REFLECTION_IMPL(SkeletonComponent)
     ReflectionRegistrator<SkeletonComponent>::Begin()[M::CantBeCreatedManualyComponent(), M::CantBeDeletedManualyComponent()]
     .Field("joints", &SkeletonComponent::jointsArray)[M::DisplayName("Joints")]
     .Field("drawSkeleton", &SkeletonComponent::drawSkeleton)[M::DisplayName("Draw Skeleton")]
+    .Field("animationLod", &SkeletonComponent::IsAnimationLodEnabled, &SkeletonComponent::SetAnimationLodEnabled)[M::DisplayName("Animation LOD")]
     .End();
 }
 
@@ -92,6 +93,7 @@ Component* SkeletonComponent::Clone(Entity* toEntity)
     SkeletonComponent* newComponent = new SkeletonComponent();
     newComponent->SetEntity(toEntity);
     newComponent->SetJoints(jointsArray);
+    newComponent->SetAnimationLodEnabled(animationLodEnabled);
     return newComponent;
 }
 
@@ -116,6 +118,7 @@ void SkeletonComponent::Serialize(KeyedArchive* archive, SerializationContext* s
     }
 
     archive->SetArchive("joints", jointsArch);
+    archive->SetBool("animationLod", animationLodEnabled);
 }
 
 void SkeletonComponent::Deserialize(KeyedArchive* archive, SerializationContext* serializationContext)
@@ -139,6 +142,8 @@ void SkeletonComponent::Deserialize(KeyedArchive* archive, SerializationContext*
         joint.bindTransformInv = jointArch->GetMatrix4("joint.invBindPose");
     }
 
+    animationLodEnabled = archive->GetBool("animationLod", false);
+
     UpdateJointsMap();
     UpdateDefaultPose();
 }
@@ -161,4 +166,4 @@ bool AnyCompare<SkeletonComponent::Joint>::IsEqual(const Any& v1, const Any& v2)
 {
     return v1.Get<SkeletonComponent::Joint>() == v2.Get<SkeletonComponent::Joint>();
 }
-}
\ No newline at end of file
+}
\ No newline at end of file
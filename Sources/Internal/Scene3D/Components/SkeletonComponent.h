@@ -59,6 +59,16 @@ public:
     void SetJointOrientation(uint32 jointIndex, const Quaternion& orientation);
     void SetJointScale(uint32 jointIndex, float32 scale);
 
+    /**
+        Opt-in to animation LOD (see SkeletonSystem::AnimationLodSettings). Disabled by default, then skeleton is updated
+        every frame regardless of its screen size and visibility. Joint transforms of skeleton with LOD may be stale between updates.
+    */
+    bool IsAnimationLodEnabled() const;
+    void SetAnimationLodEnabled(bool enabled);
+
+    /** Return true if pose should be evaluated and applied to skeleton this frame. */
+    bool IsPoseUpdateRequired() const;
+
     Component* Clone(Entity* toEntity) override;
     void Serialize(KeyedArchive* archive, SerializationContext* serializationContext) override;
     void Deserialize(KeyedArchive* archive, SerializationContext* serializationContext) override;
@@ -94,6 +104,22 @@ private:
     bool configUpdated = true;
     bool drawSkeleton = false;
 
+    /*animation lod*/
+    Vector<uint32> jointDepth; //number of ancestors
+    Vector<JointTransform> lodStartTransforms; //skinning transforms when last pose update happened, interpolated to finalTransforms
+    Vector<JointTransform> lodSkinningTransforms;
+
+    uint32 lodPhase = 0; //stagger updates of skeletons with the same interval
+    uint32 lodUpdateInterval = 1;
+    uint32 lodFramesSinceUpdate = 0;
+    uint32 lodMaxJointDepth = INVALID_JOINT_INDEX; //deeper joints are not evaluated and follow their parent
+    bool animationLodEnabled = false;
+    bool lodVisible = true;
+    bool lodStopped = false;
+    bool lodInterpolate = false;
+    bool lodSkinningInterpolated = false; //skinned mesh shows lodSkinningTransforms instead of finalTransforms
+    bool lodUpdatePose = true;
+
     DAVA_VIRTUAL_REFLECTION(SkeletonComponent, Component);
 
     friend class SkeletonSystem;
@@ -155,6 +181,21 @@ inline void SkeletonComponent::SetJointScale(uint32 jointIndex, float32 scale)
     localSpaceTransforms[jointIndex].SetScale(scale);
 }
 
+inline bool SkeletonComponent::IsAnimationLodEnabled() const
+{
+    return animationLodEnabled;
+}
+
+inline void SkeletonComponent::SetAnimationLodEnabled(bool enabled)
+{
+    animationLodEnabled = enabled;
+}
+
+inline bool SkeletonComponent::IsPoseUpdateRequired() const
+{
+    return lodUpdatePose;
+}
+
 inline void SkeletonComponent::SetJointUpdated(uint32 jointIndex)
 {
     DVASSERT(jointIndex < GetJointsCount());
@@ -0,0 +1,523 @@
+#include "Scene3D/Converters/StaticMeshMerger.h"
+#include "Base/RefPtr.h"
+#include "Logger/Logger.h"
+#include "Math/Transform.h"
+#include "Render/3D/PolygonGroup.h"
+#include "Render/Highlevel/MergedMeshRenderObject.h"
+#include "Render/Highlevel/RenderBatch.h"
+#include "Render/Material/NMaterial.h"
+#include "Render/Material/NMaterialNames.h"
+#include "Render/Texture.h"
+#include "Scene3D/Components/ActionComponent.h"
+#include "Scene3D/Components/AnimationComponent.h"
+#include "Scene3D/Components/ComponentHelpers.h"
+#include "Scene3D/Components/MotionComponent.h"
+#include "Scene3D/Components/ParticleEffectComponent.h"
+#include "Scene3D/Components/QualitySettingsComponent.h"
+#include "Scene3D/Components/RenderComponent.h"
+#include "Scene3D/Components/SkeletonComponent.h"
+#include "Scene3D/Components/SlotComponent.h"
+#include "Scene3D/Components/SwitchComponent.h"
+#include "Scene3D/Components/TransformComponent.h"
+#include "Scene3D/Entity.h"
+#include "Scene3D/Lod/LodComponent.h"
+#include "Utils/StringFormat.h"
+
+#include <algorithm>
+
+namespace DAVA
+{
+namespace StaticMeshMergerDetails
+{
+const int32 EXCLUDED_VERTEX_FORMAT = EVF_HARD_JOINTINDEX | EVF_PIVOT4 | EVF_PIVOT_DEPRECATED | EVF_FLEXIBILITY | EVF_ANGLE_SIN_COS |
+EVF_JOINTINDEX | EVF_JOINTWEIGHT | EVF_CUBETEXCOORD0 | EVF_CUBETEXCOORD1 | EVF_CUBETEXCOORD2 | EVF_CUBETEXCOORD3;
+
+struct BatchSource
+{
+    Entity* entity = nullptr;
+    PolygonGroup* geometry = nullptr;
+    Matrix4 transform;
+    Vector3 center;
+    Vector2 uvScale = Vector2(1.f, 1.f);
+    Vector2 uvOffset = Vector2(0.f, 0.f);
+    bool bakeLightmapTransform = false;
+    uint32 mortonCode = 0;
+};
+
+struct BatchGroup
+{
+    NMaterial* material = nullptr;
+    int32 vertexFormat = 0;
+    int32 lodIndex = -1;
+    bool bakeLightmapTransform = false;
+    Vector<BatchSource> sources;
+};
+
+struct EntityGroup
+{
+    Vector<Entity*> entities;
+    uint32 roFlags = 0;
+    AABBox3 bbox;
+    Map<String, BatchGroup> batchGroups;
+};
+
+uint32 GetPropertyFloatCount(const NMaterialProperty* prop)
+{
+    static const uint32 floatsPerType[] = { 1, 2, 3, 4, 16 };
+    return floatsPerType[prop->type] * prop->arraySize;
+}
+
+template <typename T>
+Vector<FastName> SortedKeys(const UnorderedMap<FastName, T>& map)
+{
+    Vector<FastName> keys;
+    keys.reserve(map.size());
+    for (const auto& entry : map)
+    {
+        keys.push_back(entry.first);
+    }
+    std::sort(keys.begin(), keys.end(), [](const FastName& l, const FastName& r) { return strcmp(l.c_str(), r.c_str()) < 0; });
+    return keys;
+}
+
+bool IsLightmapTransformProperty(const FastName& name)
+{
+    return name == NMaterialParamName::PARAM_UV_OFFSET || name == NMaterialParamName::PARAM_UV_SCALE;
+}
+
+const char* GetNameString(const FastName& name)
+{
+    return name.IsValid() ? name.c_str() : "";
+}
+
+/**
+    Append description of `material` and its parents to `signature`. Only names, values and texture paths are used,
+    so the same scene is always grouped in the same way. Return false if material has a texture which can't be
+    identified by path (e.g. generated at runtime).
+*/
+bool AppendMaterialSignature(NMaterial* material, bool excludeLightmapTransform, String& signature)
+{
+    signature += Format("m:%s|fx:%s|q:%s|", GetNameString(material->GetMaterialName()), GetNameString(material->GetLocalFXName()), GetNameString(material->GetQualityGroup()));
+    for (uint32 c = 0, configCount = material->GetConfigCount(); c < configCount; ++c)
+    {
+        const MaterialConfig& config = material->GetConfig(c);
+        signature += Format("cfg:%s:%s|", GetNameString(config.name), GetNameString(config.fxName));
+
+        for (const FastName& name : SortedKeys(config.localProperties))
+        {
+            if (excludeLightmapTransform && IsLightmapTransformProperty(name))
+                continue;
+
+            const NMaterialProperty* prop = config.localProperties.at(name);
+            signature += Format("p:%s:%u:%u:", name.c_str(), prop->type, prop->arraySize);
+            for (uint32 i = 0, count = GetPropertyFloatCount(prop); i < count; ++i)
+            {
+                signature += Format("%a,", prop->data[i]);
+            }
+        }
+        for (const FastName& name : SortedKeys(config.localTextures))
+        {
+            const MaterialTextureInfo* info = config.localTextures.at(name);
+            FilePath path = info->path;
+            if (path.IsEmpty() && info->texture != nullptr)
+            {
+                path = info->texture->GetPathname();
+            }
+            if (path.IsEmpty())
+                return false;
+
+            signature += Format("t:%s:%s|", name.c_str(), path.GetStringValue().c_str());
+        }
+        for (const FastName& name : SortedKeys(config.localFlags))
+        {
+            signature += Format("f:%s:%d|", name.c_str(), config.localFlags.at(name));
+        }
+    }
+
+    NMaterial* parent = material->GetParent();
+    if (parent != nullptr)
+    {
+        signature += "parent:";
+        return AppendMaterialSignature(parent, false, signature);
+    }
+    return true;
+}
+
+uint32 SpreadBits(uint32 v)
+{
+    v &= 0xFFFF;
+    v = (v | (v << 8)) & 0x00FF00FF;
+    v = (v | (v << 4)) & 0x0F0F0F0F;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+    return v;
+}
+
+uint32 MortonCode(const Vector3& point, const AABBox3& bounds)
+{
+    Vector3 size = bounds.GetSize();
+    float32 nx = (size.x > 0.f) ? (point.x - bounds.min.x) / size.x : 0.f;
+    float32 ny = (size.y > 0.f) ? (point.y - bounds.min.y) / size.y : 0.f;
+    uint32 x = static_cast<uint32>(Clamp(nx, 0.f, 1.f) * 1023.f);
+    uint32 y = static_cast<uint32>(Clamp(ny, 0.f, 1.f) * 1023.f);
+    return SpreadBits(x) | (SpreadBits(y) << 1);
+}
+
+float32 Determinant3x3(const Matrix4& m)
+{
+    return m._00 * (m._11 * m._22 - m._12 * m._21) - m._01 * (m._10 * m._22 - m._12 * m._20) + m._02 * (m._10 * m._21 - m._11 * m._20);
+}
+
+void AppendSource(PolygonGroup* target, int32 vertexBase, int32 indexBase, const BatchSource& source)
+{
+    PolygonGroup* geometry = source.geometry;
+    DVASSERT(geometry->vertexStride == target->vertexStride);
+
+    uint8* dst = target->meshData + vertexBase * target->vertexStride;
+    Memcpy(dst, geometry->meshData, geometry->vertexCount * geometry->vertexStride);
+
+    Matrix4 normalMatrix4;
+    source.transform.GetInverse(normalMatrix4);
+    normalMatrix4.Transpose();
+    Matrix3 normalMatrix = normalMatrix4;
+    Matrix3 tangentMatrix = source.transform;
+
+    for (int32 v = 0; v < geometry->vertexCount; ++v)
+    {
+        int32 dv = vertexBase + v;
+
+        Vector3 coord;
+        target->GetCoord(dv, coord);
+        target->SetCoord(dv, coord * source.transform);
+
+        if (target->normalArray != nullptr)
+        {
+            Vector3 normal;
+            target->GetNormal(dv, normal);
+            normal = normal * normalMatrix;
+            normal.Normalize();
+            target->SetNormal(dv, normal);
+        }
+        if (target->tangentArray != nullptr)
+        {
+            Vector3 tangent;
+            target->GetTangent(dv, tangent);
+            tangent = tangent * tangentMatrix;
+            tangent.Normalize();
+            target->SetTangent(dv, tangent);
+        }
+        if (target->binormalArray != nullptr)
+        {
+            Vector3 binormal;
+            target->GetBinormal(dv, binormal);
+            binormal = binormal * tangentMatrix;
+            binormal.Normalize();
+            target->SetBinormal(dv, binormal);
+        }
+        if (source.bakeLightmapTransform)
+        {
+            Vector2 uv;
+            target->GetTexcoord(1, dv, uv);
+            uv = uv * source.uvScale + source.uvOffset;
+            target->SetTexcoord(1, dv, uv);
+        }
+    }
+
+    // mirroring transform flips triangles winding
+    bool flipWinding = Determinant3x3(source.transform) < 0.f;
+    for (int32 i = 0; i < geometry->indexCount; i += 3)
+    {
+        int32 i0, i1, i2;
+        geometry->GetIndex(i + 0, i0);
+        geometry->GetIndex(i + 1, i1);
+        geometry->GetIndex(i + 2, i2);
+        if (flipWinding)
+        {
+            std::swap(i1, i2);
+        }
+        target->SetIndex(indexBase + i + 0, static_cast<int16>(vertexBase + i0));
+        target->SetIndex(indexBase + i + 1, static_cast<int16>(vertexBase + i1));
+        target->SetIndex(indexBase + i + 2, static_cast<int16>(vertexBase + i2));
+    }
+}
+}
+
+StaticMeshMerger::StaticMeshMerger(const Settings& settings_)
+    : settings(settings_)
+{
+    DVASSERT(settings.maxVertices <= 0xFFFF);
+    DVASSERT(settings.cellSize > 0.f);
+}
+
+bool StaticMeshMerger::IsMergeable(Entity* entity) const
+{
+    RenderObject* ro = GetRenderObject(entity);
+    if (ro == nullptr || !IsPointerToExactClass<Mesh>(ro))
+        return false;
+
+    if ((ro->GetFlags() & RenderObject::VISIBLE) == 0 || ro->GetStaticOcclusionIndex() != INVALID_STATIC_OCCLUSION_INDEX)
+        return false;
+
+    if (entity->GetComponentCount(Type::Instance<RenderComponent>()) != 1)
+        return false;
+
+    // LOD is switched by distance to the object, which can't be kept for geometry re-pivoted to the group center
+    if (GetLodComponent(entity) != nullptr)
+        return false;
+
+    for (uint32 i = 0, count = ro->GetRenderBatchCount(); i < count; ++i)
+    {
+        RenderBatch* batch = ro->GetRenderBatch(i);
+        PolygonGroup* geometry = batch->GetPolygonGroup();
+        if (geometry == nullptr || geometry->meshData == nullptr || geometry->indexArray == nullptr)
+            return false;
+
+        String signature;
+        if (batch->GetMaterial() == nullptr || !StaticMeshMergerDetails::AppendMaterialSignature(batch->GetMaterial(), false, signature))
+            return false;
+        if (geometry->GetPrimitiveType() != rhi::PRIMITIVE_TRIANGLELIST || (geometry->GetFormat() & StaticMeshMergerDetails::EXCLUDED_VERTEX_FORMAT) != 0)
+            return false;
+        if (static_cast<uint32>(geometry->GetVertexCount()) > settings.maxVertices || static_cast<uint32>(geometry->GetIndexCount()) > settings.maxIndices)
+            return false;
+    }
+
+    return true;
+}
+
+void StaticMeshMerger::CollectCandidates(Entity* entity, Vector<Entity*>& candidates)
+{
+    // anything that may move, switch or disappear at runtime excludes the whole hierarchy below it
+    bool isDynamic = GetAnimationComponent(entity) != nullptr || GetMotionComponent(entity) != nullptr ||
+    GetSkeletonComponent(entity) != nullptr || GetSwitchComponent(entity) != nullptr ||
+    GetParticleEffectComponent(entity) != nullptr || GetQualitySettingsComponent(entity) != nullptr ||
+    entity->GetComponent<ActionComponent>() != nullptr || entity->GetComponent<SlotComponent>() != nullptr ||
+    (GetLodComponent(entity) != nullptr && entity->GetChildrenCount() > 0);
+
+    RenderObject* ro = GetRenderObject(entity);
+    if (ro != nullptr)
+    {
+        if (!isDynamic && IsMergeable(entity))
+        {
+            candidates.push_back(entity);
+        }
+        else
+        {
+            ++statistics.excludedObjects;
+        }
+    }
+
+    if (isDynamic)
+    {
+        Vector<Entity*> children;
+        entity->GetChildEntitiesWithComponent(children, Type::Instance<RenderComponent>());
+        statistics.excludedObjects += static_cast<uint32>(children.size());
+        return;
+    }
+
+    for (int32 i = 0; i < entity->GetChildrenCount(); ++i)
+    {
+        CollectCandidates(entity->GetChild(i), candidates);
+    }
+}
+
+void StaticMeshMerger::MergeMeshes(Entity* root)
+{
+    using namespace StaticMeshMergerDetails;
+
+    statistics = Statistics();
+
+    Vector<Entity*> candidates;
+    for (int32 i = 0; i < root->GetChildrenCount(); ++i)
+    {
+        CollectCandidates(root->GetChild(i), candidates);
+    }
+
+    Map<String, EntityGroup> entityGroups;
+    for (Entity* entity : candidates)
+    {
+        RenderObject* ro = GetRenderObject(entity);
+        Matrix4 transform = entity->AccamulateTransformUptoFarParent(root);
+
+        AABBox3 worldBox;
+        ro->GetBoundingBox().GetTransformedBox(transform, worldBox);
+        Vector3 center = worldBox.GetCenter();
+        int32 cellX = static_cast<int32>(std::floor(center.x / settings.cellSize));
+        int32 cellY = static_cast<int32>(std::floor(center.y / settings.cellSize));
+        uint32 roFlags = ro->GetFlags() & RenderObject::SERIALIZATION_CRITERIA;
+
+        String entityKey = Format("%d|%d|%u", cellX, cellY, roFlags);
+        EntityGroup& entityGroup = entityGroups[entityKey];
+        entityGroup.entities.push_back(entity);
+        entityGroup.roFlags = roFlags;
+        entityGroup.bbox.AddAABBox(worldBox);
+
+        for (uint32 i = 0, count = ro->GetRenderBatchCount(); i < count; ++i)
+        {
+            int32 lodIndex = -1;
+            int32 switchIndex = -1;
+            RenderBatch* batch = ro->GetRenderBatch(i, lodIndex, switchIndex);
+            if (switchIndex != -1 && switchIndex != ro->GetSwitchIndex())
+                continue; // never visible without SwitchComponent
+
+            NMaterial* material = batch->GetMaterial();
+            PolygonGroup* geometry = batch->GetPolygonGroup();
+
+            BatchSource source;
+            source.entity = entity;
+            source.geometry = geometry;
+            source.transform = transform;
+            batch->GetBoundingBox().GetTransformedBox(transform, worldBox);
+            source.center = worldBox.GetCenter();
+
+            // lightmap placement is baked into geometry, so it shouldn't split groups
+            source.bakeLightmapTransform = (geometry->GetFormat() & EVF_TEXCOORD1) != 0 && material->GetConfigCount() == 1 &&
+            material->HasLocalProperty(NMaterialParamName::PARAM_UV_OFFSET) && material->HasLocalProperty(NMaterialParamName::PARAM_UV_SCALE);
+            if (source.bakeLightmapTransform)
+            {
+                source.uvOffset = Vector2(material->GetLocalPropValue(NMaterialParamName::PARAM_UV_OFFSET));
+                source.uvScale = Vector2(material->GetLocalPropValue(NMaterialParamName::PARAM_UV_SCALE));
+            }
+
+            String batchKey = Format("%d|%d|%d|", geometry->GetFormat(), lodIndex, source.bakeLightmapTransform ? 1 : 0);
+            AppendMaterialSignature(material, source.bakeLightmapTransform, batchKey);
+            BatchGroup& batchGroup = entityGroup.batchGroups[batchKey];
+            if (batchGroup.material == nullptr)
+            {
+                batchGroup.material = material;
+                batchGroup.vertexFormat = geometry->GetFormat();
+                batchGroup.lodIndex = lodIndex;
+                batchGroup.bakeLightmapTransform = source.bakeLightmapTransform;
+            }
+            batchGroup.sources.push_back(source);
+        }
+    }
+
+    uint32 mergedIndex = 0;
+    for (auto& entry : entityGroups)
+    {
+        EntityGroup& entityGroup = entry.second;
+        if (entityGroup.entities.size() < 2)
+            continue;
+
+        Vector3 pivot = entityGroup.bbox.GetCenter();
+        Matrix4 toPivot = Matrix4::MakeTranslation(-pivot);
+
+        ScopedPtr<MergedMeshRenderObject> mergedObject(new MergedMeshRenderObject());
+        for (auto& batchEntry : entityGroup.batchGroups)
+        {
+            BatchGroup& batchGroup = batchEntry.second;
+
+            // keep spatially close sources together, so visible sub-ranges are likely contiguous
+            AABBox3 groupBox;
+            for (const BatchSource& source : batchGroup.sources)
+            {
+                groupBox.AddPoint(source.center);
+            }
+            for (BatchSource& source : batchGroup.sources)
+            {
+                source.mortonCode = MortonCode(source.center, groupBox);
+            }
+            std::stable_sort(batchGroup.sources.begin(), batchGroup.sources.end(), [](const BatchSource& l, const BatchSource& r) {
+                return l.mortonCode < r.mortonCode;
+            });
+
+            size_t chunkBegin = 0;
+            while (chunkBegin < batchGroup.sources.size())
+            {
+                uint32 vertexCount = 0;
+                uint32 indexCount = 0;
+                size_t chunkEnd = chunkBegin;
+                while (chunkEnd < batchGroup.sources.size())
+                {
+                    PolygonGroup* geometry = batchGroup.sources[chunkEnd].geometry;
+                    uint32 vc = static_cast<uint32>(geometry->GetVertexCount());
+                    uint32 ic = static_cast<uint32>(geometry->GetIndexCount());
+                    if (chunkEnd > chunkBegin && (vertexCount + vc > settings.maxVertices || indexCount + ic > settings.maxIndices))
+                        break;
+
+                    vertexCount += vc;
+                    indexCount += ic;
+                    ++chunkEnd;
+                }
+
+                ScopedPtr<PolygonGroup> merged(new PolygonGroup());
+                merged->AllocateData(batchGroup.vertexFormat, vertexCount, indexCount);
+
+                Vector<MergedMeshRenderObject::SubRange> ranges;
+                int32 vertexBase = 0;
+                int32 indexBase = 0;
+                for (size_t s = chunkBegin; s < chunkEnd; ++s)
+                {
+                    BatchSource source = batchGroup.sources[s];
+                    source.transform = source.transform * toPivot;
+                    AppendSource(merged, vertexBase, indexBase, source);
+
+                    MergedMeshRenderObject::SubRange range;
+                    range.startIndex = static_cast<uint32>(indexBase);
+                    range.indexCount = static_cast<uint32>(source.geometry->GetIndexCount());
+                    range.sourceEntityId = source.entity->GetID();
+                    for (int32 v = 0; v < source.geometry->GetVertexCount(); ++v)
+                    {
+                        Vector3 coord;
+                        merged->GetCoord(vertexBase + v, coord);
+                        range.bbox.AddPoint(coord);
+                    }
+                    ranges.push_back(range);
+
+                    vertexBase += source.geometry->GetVertexCount();
+                    indexBase += source.geometry->GetIndexCount();
+                }
+
+                merged->RecalcAABBox();
+                merged->BuildBuffers();
+
+                ScopedPtr<NMaterial> material(batchGroup.material->Clone());
+                if (batchGroup.bakeLightmapTransform)
+                {
+                    const float32 identityOffset[] = { 0.f, 0.f };
+                    const float32 identityScale[] = { 1.f, 1.f };
+                    material->SetPropertyValue(NMaterialParamName::PARAM_UV_OFFSET, identityOffset);
+                    material->SetPropertyValue(NMaterialParamName::PARAM_UV_SCALE, identityScale);
+                }
+
+                ScopedPtr<RenderBatch> batch(new RenderBatch());
+                batch->SetPolygonGroup(merged);
+                batch->SetMaterial(material);
+                batch->SetStartIndex(0);
+                batch->SetIndexCount(indexCount);
+
+                mergedObject->AddRenderBatch(batch, batchGroup.lodIndex, -1);
+                mergedObject->SetSubRanges(mergedObject->GetRenderBatchCount() - 1, ranges);
+                ++statistics.mergedBatches;
+
+                chunkBegin = chunkEnd;
+            }
+        }
+
+        mergedObject->AddFlag(entityGroup.roFlags);
+        if ((entityGroup.roFlags & RenderObject::VISIBLE) == 0)
+        {
+            mergedObject->RemoveFlag(RenderObject::VISIBLE);
+        }
+
+        ScopedPtr<Entity> mergedEntity(new Entity());
+        mergedEntity->SetName(FastName(Format("MergedStaticMesh_%u", mergedIndex++)));
+        mergedEntity->AddComponent(new RenderComponent(mergedObject));
+        GetTransformComponent(mergedEntity)->SetLocalTransform(Transform(pivot));
+        root->AddNode(mergedEntity);
+        ++statistics.mergedObjects;
+
+        for (Entity* entity : entityGroup.entities)
+        {
+            ++statistics.sourceObjects;
+            statistics.sourceBatches += GetRenderObject(entity)->GetRenderBatchCount();
+
+            // source entity is kept with its name, id and transform, so it can still be found and selected
+            entity->RemoveComponent(Type::Instance<RenderComponent>());
+        }
+    }
+
+    Logger::Info("[StaticMeshMerger] %u objects (%u batches) merged into %u objects (%u batches), %u objects excluded",
+                 statistics.sourceObjects, statistics.sourceBatches, statistics.mergedObjects, statistics.mergedBatches, statistics.excludedObjects);
+}
+}
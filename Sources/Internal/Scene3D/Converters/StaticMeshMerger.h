@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Base/BaseTypes.h"
+#include "Base/BaseMath.h"
+
+namespace DAVA
+{
+class Entity;
+
+/**
+    Export-time merging of static meshes into MergedMeshRenderObject's.
+
+    Render batches of static meshes are grouped by material (lightmap UV transform is baked into
+    the second texture coordinate set, so objects differing only by lightmap placement share a group),
+    vertex format, LOD layer and spatial cell. Geometry of every group is baked relative to the group center and
+    packed into chunks limited by `maxVertices` and `maxIndices`. Each chunk keeps per-source index
+    sub-ranges with bounding boxes, so culling can still discard parts of the merged mesh.
+
+    Only entities that can't change at runtime are merged: render object must be plain Mesh, entity and its
+    parents should not have switch, animation, motion, skeleton, action, slot, particle or quality settings
+    components, object should not take part in static occlusion. Objects with LodComponent are not merged,
+    since LOD of merged geometry would be switched by distance to the group center instead of to each object.
+
+    Source entities stay in hierarchy without RenderComponent, and every sub-range keeps id of its source
+    entity, so a hit on merged geometry can be mapped back to the entity (see MergedMeshRenderObject::FindSubRange).
+*/
+class StaticMeshMerger
+{
+public:
+    struct Settings
+    {
+        float32 cellSize = 128.f;
+        uint32 maxVertices = 0xFFFF;
+        uint32 maxIndices = 0xFFFF * 3;
+    };
+
+    struct Statistics
+    {
+        uint32 sourceObjects = 0;
+        uint32 sourceBatches = 0;
+        uint32 excludedObjects = 0;
+        uint32 mergedObjects = 0;
+        uint32 mergedBatches = 0;
+    };
+
+    StaticMeshMerger() = default;
+    explicit StaticMeshMerger(const Settings& settings);
+
+    /** Merge static meshes in `root` hierarchy. Merged entities are added as children of `root`. */
+    void MergeMeshes(Entity* root);
+
+    const Statistics& GetStatistics() const;
+
+private:
+    void CollectCandidates(Entity* entity, Vector<Entity*>& candidates);
+    bool IsMergeable(Entity* entity) const;
+
+    Settings settings;
+    Statistics statistics;
+};
+
+inline const StaticMeshMerger::Statistics& StaticMeshMerger::GetStatistics() const
+{
+    return statistics;
+}
+}
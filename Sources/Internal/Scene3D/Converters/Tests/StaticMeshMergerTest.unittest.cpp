@@ -0,0 +1,258 @@
+#include "UnitTests/UnitTests.h"
+
+#include "Base/ScopedPtr.h"
+#include "Logger/Logger.h"
+#include "Math/Transform.h"
+#include "Render/3D/PolygonGroup.h"
+#include "Render/Highlevel/Camera.h"
+#include "Render/Highlevel/GeometryGenerator.h"
+#include "Render/Highlevel/MergedMeshRenderObject.h"
+#include "Render/Highlevel/Mesh.h"
+#include "Render/Highlevel/RenderBatch.h"
+#include "Render/Highlevel/RenderHierarchy.h"
+#include "Render/Highlevel/RenderSystem.h"
+#include "Render/Material/NMaterial.h"
+#include "Render/Material/NMaterialNames.h"
+#include "Scene3D/Components/ComponentHelpers.h"
+#include "Scene3D/Components/RenderComponent.h"
+#include "Scene3D/Components/SwitchComponent.h"
+#include "Scene3D/Components/TransformComponent.h"
+#include "Scene3D/Converters/StaticMeshMerger.h"
+#include "Scene3D/Entity.h"
+#include "Scene3D/Lod/LodComponent.h"
+#include "Scene3D/Scene.h"
+#include "Time/SystemTimer.h"
+
+using namespace DAVA;
+
+namespace StaticMeshMergerTestDetails
+{
+Entity* AddBox(Entity* parent, const Vector3& position, NMaterial* parentMaterial, PolygonGroup* geometry)
+{
+    ScopedPtr<NMaterial> material(new NMaterial());
+    material->SetMaterialName(FastName("box"));
+    material->SetParent(parentMaterial);
+
+    ScopedPtr<Mesh> mesh(new Mesh());
+    mesh->AddPolygonGroup(geometry, material);
+
+    ScopedPtr<Entity> entity(new Entity());
+    entity->AddComponent(new RenderComponent(mesh));
+    GetTransformComponent(entity)->SetLocalTransform(Transform(position));
+    parent->AddNode(entity);
+    return entity;
+}
+
+PolygonGroup* CreateBoxGeometry()
+{
+    Map<FastName, float32> options;
+    return GeometryGenerator::GenerateBox(AABBox3(Vector3(-1.f, -1.f, 0.f), Vector3(1.f, 1.f, 2.f)), options);
+}
+
+Camera* CreateTopCamera(const Vector3& target)
+{
+    Camera* camera = new Camera();
+    camera->SetupPerspective(10.f, 1.f, 1.f, 100.f);
+    camera->SetUp(Vector3(0.f, 1.f, 0.f));
+    camera->SetPosition(target + Vector3(0.f, 0.f, 30.f));
+    camera->SetTarget(target);
+    camera->PrepareDynamicParameters(false);
+    return camera;
+}
+
+struct FrameStatistics
+{
+    int64 clipTimeUs = 0;
+    uint32 visibleObjects = 0;
+    uint32 drawCalls = 0;
+    uint32 drawnIndices = 0;
+};
+
+FrameStatistics MeasureFrame(Scene* scene, Camera* camera, uint32 repeats)
+{
+    FrameStatistics result;
+    Vector<RenderObject*> visibilityArray;
+    RenderHierarchy* hierarchy = scene->renderSystem->GetRenderHierarchy();
+
+    int64 startTime = SystemTimer::GetUs();
+    for (uint32 i = 0; i < repeats; ++i)
+    {
+        visibilityArray.clear();
+        hierarchy->Clip(camera, visibilityArray, RenderObject::CLIPPING_VISIBILITY_CRITERIA & ~RenderObject::VISIBLE_STATIC_OCCLUSION);
+        for (RenderObject* ro : visibilityArray)
+        {
+            if (ro->GetFlags() & RenderObject::CUSTOM_PREPARE_TO_RENDER)
+            {
+                ro->PrepareToRender(camera);
+            }
+        }
+    }
+    result.clipTimeUs = (SystemTimer::GetUs() - startTime) / repeats;
+
+    result.visibleObjects = static_cast<uint32>(visibilityArray.size());
+    for (RenderObject* ro : visibilityArray)
+    {
+        for (uint32 b = 0, count = ro->GetActiveRenderBatchCount(); b < count; ++b)
+        {
+            RenderBatch* batch = ro->GetActiveRenderBatch(b);
+            ++result.drawCalls;
+            result.drawnIndices += batch->indexCount;
+        }
+    }
+    return result;
+}
+}
+
+DAVA_TESTCLASS (StaticMeshMergerTest)
+{
+    DAVA_TEST (MergeTest)
+    {
+        using namespace StaticMeshMergerTestDetails;
+
+        ScopedPtr<Scene> scene(new Scene());
+        ScopedPtr<NMaterial> parentMaterial(new NMaterial());
+        parentMaterial->SetFXName(NMaterialName::TEXTURED_OPAQUE);
+        ScopedPtr<PolygonGroup> geometry(CreateBoxGeometry());
+
+        Vector<Entity*> sources;
+        sources.push_back(AddBox(scene, Vector3(0.f, 0.f, 0.f), parentMaterial, geometry));
+        sources.push_back(AddBox(scene, Vector3(10.f, 0.f, 0.f), parentMaterial, geometry));
+        sources.push_back(AddBox(scene, Vector3(0.f, 10.f, 5.f), parentMaterial, geometry));
+        Entity* switchBox = AddBox(scene, Vector3(5.f, 5.f, 0.f), parentMaterial, geometry);
+        switchBox->AddComponent(new SwitchComponent());
+        Entity* lodBox = AddBox(scene, Vector3(5.f, 0.f, 0.f), parentMaterial, geometry);
+        lodBox->AddComponent(new LodComponent());
+
+        StaticMeshMerger::Settings settings;
+        settings.cellSize = 100.f;
+        StaticMeshMerger merger(settings);
+        merger.MergeMeshes(scene);
+
+        const StaticMeshMerger::Statistics& stats = merger.GetStatistics();
+        TEST_VERIFY(stats.sourceObjects == 3);
+        TEST_VERIFY(stats.excludedObjects == 2);
+        TEST_VERIFY(stats.mergedObjects == 1);
+        TEST_VERIFY(stats.mergedBatches == 1);
+
+        // sources are kept without render objects, switch and LOD boxes are untouched
+        TEST_VERIFY(scene->GetChildrenCount() == 6);
+        TEST_VERIFY(GetRenderObject(switchBox) != nullptr);
+        TEST_VERIFY(GetRenderObject(lodBox) != nullptr && GetLodComponent(lodBox) != nullptr);
+        for (Entity* source : sources)
+        {
+            TEST_VERIFY(source->GetParent() == scene && GetRenderObject(source) == nullptr);
+        }
+
+        Entity* mergedEntity = scene->GetChild(5);
+        MergedMeshRenderObject* merged = dynamic_cast<MergedMeshRenderObject*>(GetRenderObject(mergedEntity));
+        TEST_VERIFY(merged != nullptr);
+        if (merged == nullptr)
+            return;
+
+        const Vector<MergedMeshRenderObject::SubRange>& ranges = merged->GetSubRanges(0);
+        TEST_VERIFY(ranges.size() == 3);
+
+        PolygonGroup* mergedGeometry = merged->GetRenderBatch(0)->GetPolygonGroup();
+        TEST_VERIFY(mergedGeometry->GetIndexCount() == geometry->GetIndexCount() * 3);
+        TEST_VERIFY(mergedGeometry->GetVertexCount() == geometry->GetVertexCount() * 3);
+
+        // geometry is baked relative to merged entity position
+        Vector3 pivot = GetTransformComponent(mergedEntity)->GetLocalTransform().GetTranslation();
+        AABBox3 worldBox(mergedGeometry->GetBoundingBox().min + pivot, mergedGeometry->GetBoundingBox().max + pivot);
+        TEST_VERIFY(worldBox.min == Vector3(-1.f, -1.f, 0.f));
+        TEST_VERIFY(worldBox.max == Vector3(11.f, 11.f, 7.f));
+
+        uint32 indicesInRanges = 0;
+        for (const MergedMeshRenderObject::SubRange& range : ranges)
+        {
+            TEST_VERIFY(range.startIndex == indicesInRanges);
+            indicesInRanges += range.indexCount;
+
+            // picked index is mapped back to its source entity
+            const MergedMeshRenderObject::SubRange* found = merged->FindSubRange(0, range.startIndex + range.indexCount - 1);
+            TEST_VERIFY(found == &range);
+            Entity* source = scene->GetEntityByID(range.sourceEntityId);
+            TEST_VERIFY(source != nullptr && std::find(sources.begin(), sources.end(), source) != sources.end());
+        }
+        TEST_VERIFY(merged->FindSubRange(0, indicesInRanges) == nullptr);
+        TEST_VERIFY(indicesInRanges == static_cast<uint32>(mergedGeometry->GetIndexCount()));
+
+        // batch drawn by two cameras within one frame covers sub-ranges visible from both of them
+        scene->Update(0.016f);
+        auto findRange = [&](Entity* source) {
+            auto it = std::find_if(ranges.begin(), ranges.end(), [&](const MergedMeshRenderObject::SubRange& range) { return range.sourceEntityId == source->GetID(); });
+            return (it != ranges.end()) ? *it : MergedMeshRenderObject::SubRange();
+        };
+        auto isDrawn = [](RenderBatch* batch, const MergedMeshRenderObject::SubRange& range) {
+            return batch->startIndex <= range.startIndex && range.startIndex + range.indexCount <= batch->startIndex + batch->indexCount;
+        };
+        MergedMeshRenderObject::SubRange firstRange = findRange(sources[0]);
+        MergedMeshRenderObject::SubRange secondRange = findRange(sources[1]);
+        RenderBatch* mergedBatch = merged->GetRenderBatch(0);
+
+        ScopedPtr<Camera> firstCamera(CreateTopCamera(Vector3(0.f, 0.f, 0.f)));
+        merged->PrepareToRender(firstCamera);
+        TEST_VERIFY(isDrawn(mergedBatch, firstRange) && !isDrawn(mergedBatch, secondRange));
+        TEST_VERIFY(mergedBatch->indexCount == firstRange.indexCount);
+
+        ScopedPtr<Camera> secondCamera(CreateTopCamera(Vector3(10.f, 0.f, 0.f)));
+        merged->PrepareToRender(secondCamera);
+        TEST_VERIFY(isDrawn(mergedBatch, firstRange) && isDrawn(mergedBatch, secondRange));
+
+        ScopedPtr<MergedMeshRenderObject> clone(static_cast<MergedMeshRenderObject*>(merged->Clone(nullptr)));
+        TEST_VERIFY(clone->GetSubRanges(0).size() == ranges.size());
+    }
+
+    DAVA_TEST (CullingBenchmark)
+    {
+        using namespace StaticMeshMergerTestDetails;
+
+        const int32 gridSize = 64;
+        const float32 spacing = 8.f;
+        const uint32 materialsCount = 4;
+        const uint32 repeats = 20;
+
+        ScopedPtr<Scene> scene(new Scene());
+        ScopedPtr<PolygonGroup> geometry(CreateBoxGeometry());
+        Vector<ScopedPtr<NMaterial>> materials;
+        for (uint32 i = 0; i < materialsCount; ++i)
+        {
+            materials.emplace_back(new NMaterial());
+            materials.back()->SetMaterialName(FastName(Format("material_%u", i)));
+            materials.back()->SetFXName(NMaterialName::TEXTURED_OPAQUE);
+        }
+
+        for (int32 y = 0; y < gridSize; ++y)
+        {
+            for (int32 x = 0; x < gridSize; ++x)
+            {
+                AddBox(scene, Vector3(x * spacing, y * spacing, 0.f), materials[(x + y) % materialsCount], geometry);
+            }
+        }
+
+        ScopedPtr<Camera> camera(new Camera());
+        camera->SetupPerspective(70.f, 1.f, 1.f, 200.f);
+        camera->SetUp(Vector3(0.f, 0.f, 1.f));
+        camera->SetPosition(Vector3(-10.f, -10.f, 20.f));
+        camera->SetTarget(Vector3(gridSize * spacing * 0.25f, gridSize * spacing * 0.25f, 0.f));
+        camera->PrepareDynamicParameters(false);
+
+        scene->Update(0.016f);
+        FrameStatistics before = MeasureFrame(scene, camera, repeats);
+
+        StaticMeshMerger merger;
+        merger.MergeMeshes(scene);
+        scene->Update(0.016f);
+        FrameStatistics after = MeasureFrame(scene, camera, repeats);
+
+        TEST_VERIFY(merger.GetStatistics().sourceObjects == static_cast<uint32>(gridSize * gridSize));
+        TEST_VERIFY(after.drawCalls < before.drawCalls);
+        // sub-range culling keeps the amount of drawn geometry close to the original
+        TEST_VERIFY(after.drawnIndices < static_cast<uint32>(geometry->GetIndexCount()) * gridSize * gridSize);
+
+        Logger::Info("StaticMeshMerger benchmark (%d objects): before merge %u visible objects, %u draw calls, %u indices, clip %lld us; "
+                     "after merge %u visible objects, %u draw calls, %u indices, clip %lld us",
+                     gridSize * gridSize, before.visibleObjects, before.drawCalls, before.drawnIndices, before.clipTimeUs,
+                     after.visibleObjects, after.drawCalls, after.drawnIndices, after.clipTimeUs);
+    }
+};
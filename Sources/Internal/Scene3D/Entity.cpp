@@ -153,10 +153,25 @@ void Entity::SetScene(Scene* _scene)
 
 void Entity::SetParent(Entity* _parent)
 {
+    if (scene)
+    {
+        scene->entityIndex.ChangeParent(this, _parent);
+    }
+
     parent = _parent;
     GetComponent<TransformComponent>()->SetParent(parent);
 }
 
+EntityIndex* Entity::GetHierarchyIndex() const
+{
+    Scene* s = const_cast<Entity*>(this)->GetScene();
+    if (s != nullptr && s->entityIndex.IsInHierarchy(const_cast<Entity*>(this)))
+    {
+        return &s->entityIndex;
+    }
+    return nullptr;
+}
+
 void Entity::AddNode(Entity* node)
 {
     if (node)
@@ -275,6 +290,15 @@ Entity* Entity::FindByName(const FastName& searchName)
     if (name == searchName)
         return this;
 
+    if (searchName.IsValid())
+    {
+        EntityIndex* index = GetHierarchyIndex();
+        if (index != nullptr)
+        {
+            return index->FindByName(this, searchName);
+        }
+    }
+
     for (auto child : children)
     {
         Entity* res = child->FindByName(searchName);
@@ -330,7 +354,7 @@ Entity* Entity::Clone(Entity* dstNode)
         dstNode->AddComponent(component->Clone(dstNode));
     }
 
-    dstNode->name = name;
+    dstNode->SetName(name);
     dstNode->sceneId = sceneId;
     dstNode->id = 0;
 
@@ -392,12 +416,16 @@ uint32 Entity::GetDebugFlags() const
 
 void Entity::SetName(const FastName& _name)
 {
+    if (scene)
+    {
+        scene->entityIndex.RenameEntity(this, name, _name);
+    }
     name = _name;
 }
 
 void Entity::SetName(const char* _name)
 {
-    name = FastName(_name);
+    SetName(FastName(_name));
 }
 
 String Entity::GetFullName()
@@ -516,7 +544,7 @@ void Entity::Load(KeyedArchive* archive, SerializationContext* serializationCont
 {
     BaseObject::LoadObject(archive);
 
-    name = FastName(archive->GetString("name", "").c_str());
+    SetName(FastName(archive->GetString("name", "").c_str()));
     id = archive->GetUInt32("id", 0);
     if (nullptr != serializationContext->GetScene())
     {
@@ -694,6 +722,13 @@ void Entity::FindComponentsByTypeRecursive(const Type* type, List<DAVA::Entity*>
         components.push_back(this);
     }
 
+    EntityIndex* index = GetHierarchyIndex();
+    if (index != nullptr)
+    {
+        index->ForEachWithComponent(this, type, [&components](Entity* e) { components.push_back(e); });
+        return;
+    }
+
     uint32 childCount = GetChildrenCount();
     for (uint32 i = 0; i < childCount; ++i)
     {
@@ -703,6 +738,15 @@ void Entity::FindComponentsByTypeRecursive(const Type* type, List<DAVA::Entity*>
 
 uint32 Entity::CountChildEntitiesWithComponent(const Type* type, bool recursive /* = false */) const
 {
+    if (recursive)
+    {
+        EntityIndex* index = GetHierarchyIndex();
+        if (index != nullptr)
+        {
+            return index->CountWithComponent(const_cast<Entity*>(this), type);
+        }
+    }
+
     uint32 count = 0;
     for (auto childEntity : children)
     {
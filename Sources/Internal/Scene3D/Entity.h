@@ -10,6 +10,7 @@
 #include "FileSystem/KeyedArchive.h"
 #include "Scene3D/SceneFile/SerializationContext.h"
 #include "Scene3D/EntityFamily.h"
+#include "Scene3D/EntityIndex.h"
 
 #include "MemoryManager/MemoryProfiler.h"
 
@@ -303,6 +304,12 @@ protected:
 
     void SetParent(Entity* node);
 
+    /**
+    Return index of the scene if this entity is attached to the scene hierarchy, nullptr otherwise.
+    Queries over detached hierarchies should fall back to a tree walk.
+    */
+    EntityIndex* GetHierarchyIndex() const;
+
     Scene* scene = nullptr;
     Entity* parent = nullptr;
     FastName name;
@@ -320,11 +327,15 @@ protected:
 private:
     Vector<Component*> components;
     EntityFamily* family = nullptr;
+    uint64 indexOrder = 0;
+    uint64 indexOrderEnd = 0;
+    uint32 indexSize = 0;
     void DetachComponent(Vector<Component*>::iterator& it);
     void RemoveComponent(Vector<Component*>::iterator& it);
 
     friend class Scene;
     friend class SceneFileV2;
+    friend class EntityIndex;
 };
 
 inline uint32 Entity::GetID() const
@@ -414,6 +425,16 @@ void Entity::GetChildNodes(Container<T, A>& container)
 template <template <typename, typename> class Container, class A>
 void Entity::GetChildEntitiesWithComponent(Container<Entity*, A>& container, const Type* type, bool recursively)
 {
+    if (recursively)
+    {
+        EntityIndex* index = GetHierarchyIndex();
+        if (index != nullptr)
+        {
+            index->ForEachWithComponent(this, type, [&container](Entity* e) { container.push_back(e); });
+            return;
+        }
+    }
+
     for (auto& child : children)
     {
         if (child->GetComponentCount(type) > 0)
@@ -431,6 +452,16 @@ void Entity::GetChildEntitiesWithComponent(Container<Entity*, A>& container, con
 template <template <typename, typename> class Container, class A>
 void Entity::GetChildEntitiesWithComponent(Container<const Entity*, A>& container, const Type* type, bool recursively) const
 {
+    if (recursively)
+    {
+        EntityIndex* index = GetHierarchyIndex();
+        if (index != nullptr)
+        {
+            index->ForEachWithComponent(const_cast<Entity*>(this), type, [&container](const Entity* e) { container.push_back(e); });
+            return;
+        }
+    }
+
     for (auto& child : children)
     {
         if (child->GetComponentCount(type) > 0)
@@ -448,6 +479,18 @@ void Entity::GetChildEntitiesWithComponent(Container<const Entity*, A>& containe
 template <template <typename, typename> class Container, class A, class Pred>
 void Entity::GetChildEntitiesWithCondition(Container<Entity*, A>& container, Pred pred)
 {
+    EntityIndex* index = GetHierarchyIndex();
+    if (index != nullptr)
+    {
+        index->ForEachInSubtree(this, [&container, &pred](Entity* e) {
+            if (pred(e) == true)
+            {
+                container.push_back(e);
+            }
+        });
+        return;
+    }
+
     for (auto& child : children)
     {
         if (pred(child) == true)
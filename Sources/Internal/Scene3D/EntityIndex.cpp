@@ -0,0 +1,364 @@
+#include "Scene3D/EntityIndex.h"
+#include "Scene3D/Entity.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace DAVA
+{
+namespace EntityIndexDetails
+{
+// Attached subtree takes 1/INSERT_SPARSENESS of free keys between its neighbours, the rest is left for next insertions
+const uint64 INSERT_SPARSENESS = 32;
+// Subtree is relabeled only if it gets at least this distance between keys, otherwise its parent is relabeled
+const uint64 MIN_RELABEL_STEP = 1024;
+}
+
+void EntityIndex::AddEntity(Entity* entity)
+{
+    if (entity->GetName().IsValid())
+    {
+        entitiesByName[entity->GetName()].insert(entity);
+    }
+
+    for (Component* component : entity->components)
+    {
+        entitiesByComponent[component->GetType()].insert(entity);
+    }
+
+    // Descendants are registered after their parent and are already attached along with it
+    Entity* parent = entity->parent;
+    if (entity != root && entity->indexSize == 0 && parent != nullptr && parent->indexSize > 0)
+    {
+        Attach(entity, parent);
+    }
+}
+
+void EntityIndex::RemoveEntity(Entity* entity)
+{
+    if (entity->GetName().IsValid())
+    {
+        auto it = entitiesByName.find(entity->GetName());
+        if (it != entitiesByName.end())
+        {
+            it->second.erase(entity);
+            if (it->second.empty())
+            {
+                entitiesByName.erase(it);
+            }
+        }
+    }
+
+    for (Component* component : entity->components)
+    {
+        auto it = entitiesByComponent.find(component->GetType());
+        if (it != entitiesByComponent.end())
+        {
+            it->second.erase(entity);
+        }
+    }
+
+    if (entity != root && entity->indexSize > 0)
+    {
+        Detach(entity);
+    }
+}
+
+void EntityIndex::RenameEntity(Entity* entity, const FastName& oldName, const FastName& newName)
+{
+    if (oldName == newName)
+    {
+        return;
+    }
+
+    if (oldName.IsValid())
+    {
+        auto it = entitiesByName.find(oldName);
+        if (it != entitiesByName.end())
+        {
+            it->second.erase(entity);
+            if (it->second.empty())
+            {
+                entitiesByName.erase(it);
+            }
+        }
+    }
+
+    if (newName.IsValid())
+    {
+        entitiesByName[newName].insert(entity);
+    }
+}
+
+void EntityIndex::AddComponent(Entity* entity, const Type* type)
+{
+    entitiesByComponent[type].insert(entity);
+}
+
+void EntityIndex::RemoveComponent(Entity* entity, const Type* type)
+{
+    // Entity is still indexed while it has at least one more component of the same type.
+    if (entity->GetComponentCount(type) <= 1)
+    {
+        auto it = entitiesByComponent.find(type);
+        if (it != entitiesByComponent.end())
+        {
+            it->second.erase(entity);
+        }
+    }
+}
+
+void EntityIndex::ChangeParent(Entity* entity, Entity* newParent)
+{
+    if (entity == root)
+    {
+        return;
+    }
+
+    if (entity->indexSize > 0)
+    {
+        Detach(entity);
+    }
+
+    if (newParent != nullptr && newParent->indexSize > 0)
+    {
+        Attach(entity, newParent);
+    }
+}
+
+void EntityIndex::SetRoot(Entity* root_)
+{
+    if (root != nullptr)
+    {
+        ResetRecursive(root);
+    }
+
+    root = root_;
+
+    if (root != nullptr)
+    {
+        AssignSizeRecursive(root);
+        root->indexOrder = 0;
+        root->indexOrderEnd = std::numeric_limits<uint64>::max();
+        Relabel(root);
+    }
+}
+
+bool EntityIndex::IsInHierarchy(Entity* entity) const
+{
+    return entity->indexSize > 0;
+}
+
+Entity* EntityIndex::FindByName(Entity* subtreeRoot, const FastName& name)
+{
+    DVASSERT(subtreeRoot->indexSize > 0);
+
+    auto it = entitiesByName.find(name);
+    if (it == entitiesByName.end())
+    {
+        return nullptr;
+    }
+
+    Entity* found = nullptr;
+    for (Entity* e : it->second)
+    {
+        if (e->indexSize > 0 && e->indexOrder >= subtreeRoot->indexOrder && e->indexOrder < subtreeRoot->indexOrderEnd)
+        {
+            if (found == nullptr || e->indexOrder < found->indexOrder)
+            {
+                found = e;
+            }
+        }
+    }
+
+    return found;
+}
+
+uint32 EntityIndex::CountWithComponent(Entity* subtreeRoot, const Type* type)
+{
+    DVASSERT(subtreeRoot->indexSize > 0);
+
+    uint32 count = 0;
+    auto it = entitiesByComponent.find(type);
+    if (it != entitiesByComponent.end())
+    {
+        for (Entity* e : it->second)
+        {
+            if (e->indexSize > 0 && e->indexOrder > subtreeRoot->indexOrder && e->indexOrder < subtreeRoot->indexOrderEnd)
+            {
+                ++count;
+            }
+        }
+    }
+
+    return count;
+}
+
+void EntityIndex::GetDescendants(Entity* subtreeRoot, Vector<Entity*>& result)
+{
+    for (Entity* child : subtreeRoot->children)
+    {
+        result.push_back(child);
+        GetDescendants(child, result);
+    }
+}
+
+void EntityIndex::GetDescendantsWithComponent(Entity* subtreeRoot, const Type* type, Vector<Entity*>& result)
+{
+    DVASSERT(subtreeRoot->indexSize > 0);
+
+    auto it = entitiesByComponent.find(type);
+    if (it == entitiesByComponent.end())
+    {
+        return;
+    }
+
+    // For frequent components (e.g. `TransformComponent`) a walk over the
+    // subtree is cheaper than sorting candidates gathered from the index.
+    if (it->second.size() >= subtreeRoot->indexSize)
+    {
+        size_t offset = result.size();
+        GetDescendants(subtreeRoot, result);
+        result.erase(std::remove_if(result.begin() + offset, result.end(), [type](const Entity* e) {
+                         return e->GetComponentCount(type) == 0;
+                     }),
+                     result.end());
+        return;
+    }
+
+    size_t offset = result.size();
+    for (Entity* e : it->second)
+    {
+        if (e->indexSize > 0 && e->indexOrder > subtreeRoot->indexOrder && e->indexOrder < subtreeRoot->indexOrderEnd)
+        {
+            result.push_back(e);
+        }
+    }
+
+    std::sort(result.begin() + offset, result.end(), [](const Entity* l, const Entity* r) {
+        return l->indexOrder < r->indexOrder;
+    });
+}
+
+void EntityIndex::Attach(Entity* entity, Entity* parent)
+{
+    using namespace EntityIndexDetails;
+
+    uint32 size = AssignSizeRecursive(entity);
+    for (Entity* ancestor = parent; ancestor != nullptr; ancestor = ancestor->parent)
+    {
+        ancestor->indexSize += size;
+    }
+
+    // Find neighbours, entities are usually appended to the end of children
+    const Vector<Entity*>& siblings = parent->children;
+    auto position = std::find(siblings.rbegin(), siblings.rend(), entity);
+    DVASSERT(position != siblings.rend());
+
+    Entity* prev = nullptr;
+    for (auto it = std::next(position); it != siblings.rend() && prev == nullptr; ++it)
+    {
+        prev = ((*it)->indexSize > 0) ? *it : nullptr;
+    }
+
+    Entity* next = nullptr;
+    for (auto it = position.base(); it != siblings.end() && next == nullptr; ++it)
+    {
+        next = ((*it)->indexSize > 0) ? *it : nullptr;
+    }
+
+    // Subtree takes two keys per entity: opening one and closing one
+    uint64 lo = (prev != nullptr) ? prev->indexOrderEnd : parent->indexOrder;
+    uint64 hi = (next != nullptr) ? next->indexOrder : parent->indexOrderEnd;
+    uint64 ticks = 2 * static_cast<uint64>(size);
+
+    uint64 step = (hi - lo) / ((ticks + 1) * INSERT_SPARSENESS);
+    if (step == 0)
+    {
+        step = (hi - lo) / (ticks + 1);
+    }
+
+    if (step > 0)
+    {
+        // Appended subtree is placed next to previous sibling and inserted one next to following sibling,
+        // so series of appends or inserts before the same entity keep free keys together.
+        uint64 base = (next == nullptr) ? lo : hi - (ticks + 1) * step;
+        uint64 tick = 0;
+        AssignOrderRecursive(entity, base, step, tick);
+        return;
+    }
+
+    Entity* subtreeRoot = parent;
+    while (subtreeRoot != root)
+    {
+        uint64 width = subtreeRoot->indexOrderEnd - subtreeRoot->indexOrder;
+        if (width / (2 * static_cast<uint64>(subtreeRoot->indexSize)) >= MIN_RELABEL_STEP)
+        {
+            break;
+        }
+        subtreeRoot = subtreeRoot->parent;
+    }
+
+    Relabel(subtreeRoot);
+}
+
+void EntityIndex::Detach(Entity* entity)
+{
+    uint32 size = entity->indexSize;
+    for (Entity* ancestor = entity->parent; ancestor != nullptr; ancestor = ancestor->parent)
+    {
+        DVASSERT(ancestor->indexSize > size);
+        ancestor->indexSize -= size;
+    }
+
+    ResetRecursive(entity);
+}
+
+void EntityIndex::Relabel(Entity* subtreeRoot)
+{
+    // Keys of subtree root itself are kept, descendants are spread evenly between them
+    uint64 ticks = 2 * static_cast<uint64>(subtreeRoot->indexSize - 1);
+    uint64 step = (subtreeRoot->indexOrderEnd - subtreeRoot->indexOrder) / (ticks + 1);
+    DVASSERT(step > 0);
+
+    uint64 tick = 0;
+    for (Entity* child : subtreeRoot->children)
+    {
+        AssignOrderRecursive(child, subtreeRoot->indexOrder, step, tick);
+    }
+}
+
+uint32 EntityIndex::AssignSizeRecursive(Entity* entity)
+{
+    uint32 size = 1;
+    for (Entity* child : entity->children)
+    {
+        size += AssignSizeRecursive(child);
+    }
+
+    entity->indexSize = size;
+    return size;
+}
+
+void EntityIndex::AssignOrderRecursive(Entity* entity, uint64 base, uint64 step, uint64& tick)
+{
+    entity->indexOrder = base + (++tick) * step;
+
+    for (Entity* child : entity->children)
+    {
+        AssignOrderRecursive(child, base, step, tick);
+    }
+
+    entity->indexOrderEnd = base + (++tick) * step;
+}
+
+void EntityIndex::ResetRecursive(Entity* entity)
+{
+    entity->indexSize = 0;
+
+    for (Entity* child : entity->children)
+    {
+        ResetRecursive(child);
+    }
+}
+} // namespace DAVA
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Base/BaseTypes.h"
+#include "Base/FastName.h"
+
+namespace DAVA
+{
+class Entity;
+class Type;
+
+/**
+    \ingroup scene3d
+    \brief Incremental scene-wide index of entities by name and by component type.
+
+    Index is owned by `Scene` and is kept up to date through entity registration, renaming, reparenting and component registration.
+    Queries are scoped to a subtree: every entity of the scene hierarchy has an order key that grows in depth-first (pre-order)
+    order and a closing key that bounds keys of its descendants, so every subtree is an interval of keys.
+
+    Keys are spread with gaps, so attaching an entity only labels the attached subtree. When there is no gap left between
+    neighbours, only the closest ancestor subtree with enough free keys is relabeled. Detaching an entity only touches
+    the detached subtree and its ancestors.
+
+    Entities that are registered in the scene but are not (yet) attached to the scene hierarchy (e.g. during loading)
+    are not reachable through the index, `IsInHierarchy` returns false for them and callers should fall back to a tree walk.
+*/
+class EntityIndex
+{
+public:
+    void AddEntity(Entity* entity);
+    void RemoveEntity(Entity* entity);
+    void RenameEntity(Entity* entity, const FastName& oldName, const FastName& newName);
+    void AddComponent(Entity* entity, const Type* type);
+    void RemoveComponent(Entity* entity, const Type* type);
+
+    /**
+    Update hierarchy keys of `entity` that is about to be attached to `newParent` (or detached if `newParent` is nullptr).
+    `entity` should already be in children of `newParent`.
+    */
+    void ChangeParent(Entity* entity, Entity* newParent);
+
+    /** Set root of indexed hierarchy. Normally it is the scene itself. */
+    void SetRoot(Entity* root);
+
+    /** Return true if `entity` is reachable from the root, i.e. index queries can be scoped to its subtree. */
+    bool IsInHierarchy(Entity* entity) const;
+
+    /** Return first (in depth-first order) entity with `name` in subtree of `root` including `root` itself, or nullptr. */
+    Entity* FindByName(Entity* root, const FastName& name);
+
+    /** Call `fn` in depth-first order for every descendant of `root` that has at least one component of `type`. */
+    template <typename Fn>
+    void ForEachWithComponent(Entity* root, const Type* type, Fn fn);
+
+    /** Call `fn` in depth-first order for every descendant of `root`. `fn` should not modify scene hierarchy. */
+    template <typename Fn>
+    void ForEachInSubtree(Entity* root, Fn fn);
+
+    /** Return number of descendants of `root` that have at least one component of `type`. */
+    uint32 CountWithComponent(Entity* root, const Type* type);
+
+private:
+    void Attach(Entity* entity, Entity* parent);
+    void Detach(Entity* entity);
+    void Relabel(Entity* subtreeRoot);
+
+    uint32 AssignSizeRecursive(Entity* entity);
+    void AssignOrderRecursive(Entity* entity, uint64 base, uint64 step, uint64& tick);
+    void ResetRecursive(Entity* entity);
+
+    void GetDescendants(Entity* root, Vector<Entity*>& result);
+    void GetDescendantsWithComponent(Entity* root, const Type* type, Vector<Entity*>& result);
+
+    Entity* root = nullptr;
+    UnorderedMap<FastName, UnorderedSet<Entity*>> entitiesByName;
+    UnorderedMap<const Type*, UnorderedSet<Entity*>> entitiesByComponent;
+};
+
+template <typename Fn>
+void EntityIndex::ForEachWithComponent(Entity* root, const Type* type, Fn fn)
+{
+    Vector<Entity*> result;
+    GetDescendantsWithComponent(root, type, result);
+    for (Entity* e : result)
+    {
+        fn(e);
+    }
+}
+
+template <typename Fn>
+void EntityIndex::ForEachInSubtree(Entity* root, Fn fn)
+{
+    Vector<Entity*> result;
+    GetDescendants(root, result);
+    for (Entity* e : result)
+    {
+        fn(e);
+    }
+}
+} // namespace DAVA
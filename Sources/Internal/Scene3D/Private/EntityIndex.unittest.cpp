@@ -0,0 +1,424 @@
+#include "UnitTests/UnitTests.h"
+
+#include "Base/RefPtr.h"
+#include "Logger/Logger.h"
+#include "Scene3D/Components/UserComponent.h"
+#include "Scene3D/Components/CustomPropertiesComponent.h"
+#include "Scene3D/Entity.h"
+#include "Scene3D/Scene.h"
+#include "Time/SystemTimer.h"
+#include "Utils/StringFormat.h"
+
+using namespace DAVA;
+
+namespace EntityIndexTestDetails
+{
+Entity* CreateEntity(const char* name)
+{
+    Entity* e = new Entity();
+    e->SetName(name);
+    return e;
+}
+
+Entity* FindByNameSlow(Entity* root, const FastName& name)
+{
+    if (root->GetName() == name)
+    {
+        return root;
+    }
+
+    for (Entity* child : root->children)
+    {
+        Entity* res = FindByNameSlow(child, name);
+        if (res != nullptr)
+        {
+            return res;
+        }
+    }
+    return nullptr;
+}
+
+void CollectWithComponentSlow(Entity* root, const Type* type, Vector<Entity*>& result)
+{
+    for (Entity* child : root->children)
+    {
+        if (child->GetComponentCount(type) > 0)
+        {
+            result.push_back(child);
+        }
+        CollectWithComponentSlow(child, type, result);
+    }
+}
+
+void CollectSubtreeSlow(Entity* root, Vector<Entity*>& result)
+{
+    for (Entity* child : root->children)
+    {
+        result.push_back(child);
+        CollectSubtreeSlow(child, result);
+    }
+}
+
+Vector<Entity*> CollectSubtree(Entity* root)
+{
+    Vector<Entity*> result;
+    root->GetChildEntitiesWithCondition(result, [](Entity*) { return true; });
+    return result;
+}
+
+// 500 groups with 100 entities each, every 10th entity has `UserComponent`
+Vector<Entity*> CreateBenchmarkScene(Scene* scene, uint32 groupsCount, uint32 entitiesPerGroup)
+{
+    Vector<Entity*> groups;
+    for (uint32 g = 0; g < groupsCount; ++g)
+    {
+        ScopedPtr<Entity> group(CreateEntity(Format("group_%u", g).c_str()));
+        scene->AddNode(group);
+        groups.push_back(group);
+
+        Entity* parent = group;
+        for (uint32 i = 0; i < entitiesPerGroup; ++i)
+        {
+            ScopedPtr<Entity> e(CreateEntity(Format("entity_%u_%u", g, i).c_str()));
+            if ((i % 10) == 0)
+            {
+                e->AddComponent(new UserComponent());
+            }
+            parent->AddNode(e);
+            parent = (i % 4 == 0) ? e.get() : parent;
+        }
+    }
+    return groups;
+}
+}
+
+DAVA_TESTCLASS (EntityIndexTest)
+{
+    DAVA_TEST (FindByNameTest)
+    {
+        using namespace EntityIndexTestDetails;
+
+        ScopedPtr<Scene> scene(new Scene());
+        ScopedPtr<Entity> a(CreateEntity("a"));
+        ScopedPtr<Entity> b(CreateEntity("b"));
+        ScopedPtr<Entity> c(CreateEntity("c"));
+        ScopedPtr<Entity> c2(CreateEntity("c"));
+
+        scene->AddNode(a);
+        a->AddNode(b);
+        b->AddNode(c);
+        scene->AddNode(c2);
+
+        // first match in depth-first order
+        TEST_VERIFY(scene->FindByName("c") == c);
+        TEST_VERIFY(a->FindByName("c") == c);
+        TEST_VERIFY(b->FindByName("b") == b);
+        TEST_VERIFY(b->FindByName("a") == nullptr);
+        TEST_VERIFY(c2->FindByName("c") == c2);
+
+        // renaming
+        c->SetName("d");
+        TEST_VERIFY(scene->FindByName("c") == c2);
+        TEST_VERIFY(scene->FindByName("d") == c);
+        TEST_VERIFY(a->FindByName("c") == nullptr);
+
+        // reparenting
+        c2->AddNode(b);
+        TEST_VERIFY(a->FindByName("d") == nullptr);
+        TEST_VERIFY(c2->FindByName("d") == c);
+        TEST_VERIFY(scene->FindByName("b") == b);
+
+        // children order is respected
+        scene->InsertBeforeNode(c2, a);
+        c->SetName("a");
+        TEST_VERIFY(scene->FindByName("a") == c);
+
+        // detached hierarchy falls back to tree walk
+        scene->RemoveNode(c2);
+        TEST_VERIFY(c2->GetScene() == nullptr);
+        TEST_VERIFY(c2->FindByName("a") == c);
+        TEST_VERIFY(scene->FindByName("a") == a);
+        TEST_VERIFY(scene->FindByName("d") == nullptr);
+
+        // renamed while detached and attached back
+        c->SetName("e");
+        scene->AddNode(c2);
+        TEST_VERIFY(scene->FindByName("e") == c);
+        TEST_VERIFY(scene->FindByName("c") == c2);
+    }
+
+    DAVA_TEST (ComponentQueryTest)
+    {
+        using namespace EntityIndexTestDetails;
+
+        ScopedPtr<Scene> scene(new Scene());
+        ScopedPtr<Entity> a(CreateEntity("a"));
+        ScopedPtr<Entity> b(CreateEntity("b"));
+        ScopedPtr<Entity> c(CreateEntity("c"));
+        ScopedPtr<Entity> d(CreateEntity("d"));
+
+        scene->AddNode(a);
+        a->AddNode(b);
+        a->AddNode(c);
+        scene->AddNode(d);
+
+        const Type* userType = Type::Instance<UserComponent>();
+
+        c->AddComponent(new UserComponent());
+        b->AddComponent(new UserComponent());
+        b->AddComponent(new UserComponent());
+        d->AddComponent(new UserComponent());
+
+        Vector<Entity*> result;
+        scene->GetChildEntitiesWithComponent(result, userType);
+        TEST_VERIFY((result == Vector<Entity*>{ b, c, d }));
+        TEST_VERIFY(scene->CountChildEntitiesWithComponent(userType, true) == 3);
+
+        result.clear();
+        a->GetChildEntitiesWithComponent(result, userType);
+        TEST_VERIFY((result == Vector<Entity*>{ b, c }));
+
+        // one of two components removed, entity should stay in index
+        b->RemoveComponent(userType);
+        result.clear();
+        a->GetChildEntitiesWithComponent(result, userType);
+        TEST_VERIFY((result == Vector<Entity*>{ b, c }));
+
+        b->RemoveComponent(userType);
+        result.clear();
+        a->GetChildEntitiesWithComponent(result, userType);
+        TEST_VERIFY((result == Vector<Entity*>{ c }));
+
+        // reparenting
+        d->AddNode(a);
+        result.clear();
+        d->GetChildEntitiesWithComponent(result, userType);
+        TEST_VERIFY((result == Vector<Entity*>{ c }));
+
+        List<Entity*> found;
+        d->FindComponentsByTypeRecursive(userType, found);
+        TEST_VERIFY((found == List<Entity*>{ d, c }));
+
+        result.clear();
+        scene->GetChildEntitiesWithCondition(result, [](Entity* e) { return e->GetName() != FastName("b"); });
+        TEST_VERIFY((result == Vector<Entity*>{ d, a, c }));
+
+        // detached hierarchy
+        scene->RemoveNode(d);
+        result.clear();
+        d->GetChildEntitiesWithComponent(result, userType);
+        TEST_VERIFY((result == Vector<Entity*>{ c }));
+        result.clear();
+        scene->GetChildEntitiesWithComponent(result, userType);
+        TEST_VERIFY(result.empty());
+    }
+
+    DAVA_TEST (OrderMaintenanceTest)
+    {
+        using namespace EntityIndexTestDetails;
+
+        ScopedPtr<Scene> scene(new Scene());
+        ScopedPtr<Entity> a(CreateEntity("a"));
+        ScopedPtr<Entity> b(CreateEntity("b"));
+        scene->AddNode(a);
+        scene->AddNode(b);
+
+        const Type* userType = Type::Instance<UserComponent>();
+
+        // inserts before the same entity and appends to the deepest entity use up free keys
+        // between neighbours and force relabeling of enclosing subtrees
+        Entity* deepest = b;
+        for (uint32 i = 0; i < 300; ++i)
+        {
+            ScopedPtr<Entity> front(CreateEntity(Format("front_%u", i).c_str()));
+            if (a->GetChildrenCount() > 0)
+            {
+                a->InsertBeforeNode(front, a->GetChild(0));
+            }
+            else
+            {
+                a->AddNode(front);
+            }
+
+            ScopedPtr<Entity> chain(CreateEntity(Format("chain_%u", i).c_str()));
+            if ((i % 3) == 0)
+            {
+                chain->AddComponent(new UserComponent());
+            }
+            deepest->AddNode(chain);
+            deepest = chain;
+
+            // move some of inserted entities into the chain
+            if ((i % 10) == 5)
+            {
+                deepest->AddNode(a->GetChild(a->GetChildrenCount() / 2));
+            }
+        }
+
+        // spawn prebuilt hierarchy into the middle of the chain
+        ScopedPtr<Entity> spawned(CreateEntity("spawned"));
+        for (uint32 i = 0; i < 50; ++i)
+        {
+            ScopedPtr<Entity> child(CreateEntity(Format("spawned_%u", i).c_str()));
+            child->AddComponent(new UserComponent());
+            spawned->AddNode(child);
+        }
+        Entity* middle = b->FindByName("chain_150");
+        TEST_VERIFY(middle != nullptr);
+        middle->InsertBeforeNode(spawned, middle->GetChild(0));
+
+        // remove part of the chain
+        Entity* removed = b->FindByName("chain_250");
+        removed->GetParent()->RemoveNode(removed);
+
+        for (Entity* root : { static_cast<Entity*>(scene), a.get(), b.get(), middle, spawned.get() })
+        {
+            Vector<Entity*> expected;
+            CollectSubtreeSlow(root, expected);
+            TEST_VERIFY(CollectSubtree(root) == expected);
+
+            expected.clear();
+            CollectWithComponentSlow(root, userType, expected);
+            Vector<Entity*> result;
+            root->GetChildEntitiesWithComponent(result, userType);
+            TEST_VERIFY(result == expected);
+            TEST_VERIFY(root->CountChildEntitiesWithComponent(userType, true) == expected.size());
+        }
+
+        TEST_VERIFY(scene->FindByName("spawned_10") == spawned->GetChild(10));
+        TEST_VERIFY(scene->FindByName("chain_249") != nullptr);
+        TEST_VERIFY(scene->FindByName("chain_250") == nullptr);
+        TEST_VERIFY(scene->FindByName("chain_299") == nullptr);
+        TEST_VERIFY(a->FindByName("front_299") == a->GetChild(0));
+    }
+
+    DAVA_TEST (QueryBenchmark)
+    {
+        using namespace EntityIndexTestDetails;
+
+        const uint32 groupsCount = 500;
+        const uint32 entitiesPerGroup = 100;
+        const uint32 queriesCount = 1000;
+
+        ScopedPtr<Scene> scene(new Scene());
+        CreateBenchmarkScene(scene, groupsCount, entitiesPerGroup);
+
+        Vector<FastName> names;
+        for (uint32 q = 0; q < queriesCount; ++q)
+        {
+            names.emplace_back(Format("entity_%u_%u", (q * 7) % groupsCount, (q * 13) % entitiesPerGroup).c_str());
+        }
+
+        const Type* userType = Type::Instance<UserComponent>();
+
+        int64 slowStart = SystemTimer::GetUs();
+        size_t slowFound = 0;
+        for (const FastName& name : names)
+        {
+            slowFound += FindByNameSlow(scene, name) != nullptr ? 1 : 0;
+        }
+        Vector<Entity*> slowEntities;
+        for (uint32 q = 0; q < 10; ++q)
+        {
+            slowEntities.clear();
+            CollectWithComponentSlow(scene, userType, slowEntities);
+        }
+        int64 slowTime = SystemTimer::GetUs() - slowStart;
+
+        int64 indexStart = SystemTimer::GetUs();
+        size_t indexFound = 0;
+        for (const FastName& name : names)
+        {
+            indexFound += scene->FindByName(name) != nullptr ? 1 : 0;
+        }
+        Vector<Entity*> indexEntities;
+        for (uint32 q = 0; q < 10; ++q)
+        {
+            indexEntities.clear();
+            scene->GetChildEntitiesWithComponent(indexEntities, userType);
+        }
+        int64 indexTime = SystemTimer::GetUs() - indexStart;
+
+        TEST_VERIFY(slowFound == indexFound);
+        TEST_VERIFY(slowEntities == indexEntities);
+
+        Logger::Info("EntityIndex benchmark (%u entities, %u name queries, 10 component queries): tree walk %lld us, index %lld us",
+                     groupsCount * (entitiesPerGroup + 1), queriesCount, slowTime, indexTime);
+    }
+
+    DAVA_TEST (MutationBenchmark)
+    {
+        using namespace EntityIndexTestDetails;
+
+        const uint32 groupsCount = 500;
+        const uint32 entitiesPerGroup = 100;
+        const uint32 framesCount = 1000;
+
+        ScopedPtr<Scene> scene(new Scene());
+        Vector<Entity*> groups = CreateBenchmarkScene(scene, groupsCount, entitiesPerGroup);
+
+        const Type* userType = Type::Instance<UserComponent>();
+
+        int64 mutationTime = 0;
+        int64 slowTime = 0;
+        int64 indexTime = 0;
+        bool resultsMatch = true;
+
+        Vector<Entity*> slowEntities;
+        Vector<Entity*> indexEntities;
+        for (uint32 f = 0; f < framesCount; ++f)
+        {
+            // every frame spawns, reparents and removes entities
+            int64 mutationStart = SystemTimer::GetUs();
+
+            ScopedPtr<Entity> spawned(CreateEntity(Format("spawned_%u", f).c_str()));
+            spawned->AddComponent(new UserComponent());
+            groups[(f * 7) % groupsCount]->AddNode(spawned);
+
+            Entity* from = groups[(f * 13) % groupsCount];
+            Entity* to = groups[(f * 17) % groupsCount];
+            if (from != to && from->GetChildrenCount() > 1)
+            {
+                to->AddNode(from->GetChild(from->GetChildrenCount() - 1));
+            }
+
+            Entity* removeFrom = groups[(f * 19) % groupsCount];
+            if (removeFrom->GetChildrenCount() > 1)
+            {
+                removeFrom->RemoveNode(removeFrom->GetChild(0));
+            }
+
+            mutationTime += SystemTimer::GetUs() - mutationStart;
+
+            // and queries both the scene and a few subtrees
+            FastName spawnedName(Format("spawned_%u", (f * 3) / 4).c_str());
+            FastName entityName(Format("entity_%u_%u", (f * 11) % groupsCount, (f * 13) % entitiesPerGroup).c_str());
+            Entity* group = groups[(f * 23) % groupsCount];
+
+            int64 slowStart = SystemTimer::GetUs();
+            Entity* slowSpawned = FindByNameSlow(scene, spawnedName);
+            Entity* slowEntity = FindByNameSlow(group, entityName);
+            slowEntities.clear();
+            CollectWithComponentSlow(group, userType, slowEntities);
+            slowTime += SystemTimer::GetUs() - slowStart;
+
+            int64 indexStart = SystemTimer::GetUs();
+            Entity* indexSpawned = scene->FindByName(spawnedName);
+            Entity* indexEntity = group->FindByName(entityName);
+            indexEntities.clear();
+            group->GetChildEntitiesWithComponent(indexEntities, userType);
+            indexTime += SystemTimer::GetUs() - indexStart;
+
+            resultsMatch = resultsMatch && slowSpawned == indexSpawned && slowEntity == indexEntity && slowEntities == indexEntities;
+        }
+
+        TEST_VERIFY(resultsMatch);
+
+        Vector<Entity*> expected;
+        CollectSubtreeSlow(scene, expected);
+        TEST_VERIFY(CollectSubtree(scene) == expected);
+
+        Logger::Info("EntityIndex mutation benchmark (%u entities, %u frames with spawn, reparent, removal and 3 queries): mutations %lld us, queries with tree walk %lld us, queries with index %lld us",
+                     groupsCount * (entitiesPerGroup + 1), framesCount, mutationTime, slowTime, indexTime);
+    }
+};
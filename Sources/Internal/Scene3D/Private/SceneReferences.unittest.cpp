@@ -0,0 +1,373 @@
+#include "UnitTests/UnitTests.h"
+
+#include "Base/RefPtr.h"
+#include "Base/ScopedPtr.h"
+#include "Concurrency/Thread.h"
+#include "Engine/Engine.h"
+#include "FileSystem/File.h"
+#include "FileSystem/FileSystem.h"
+#include "Logger/Logger.h"
+#include "Math/Transform.h"
+#include "Particles/ParticleEmitter.h"
+#include "Particles/ParticleEmitterInstance.h"
+#include "Particles/ParticleLayer.h"
+#include "Render/3D/PolygonGroup.h"
+#include "Render/Highlevel/GeometryGenerator.h"
+#include "Render/Highlevel/Mesh.h"
+#include "Render/Highlevel/RenderBatch.h"
+#include "Render/Material/NMaterial.h"
+#include "Render/Material/NMaterialNames.h"
+#include "Render/Texture.h"
+#include "Scene3D/Components/ComponentHelpers.h"
+#include "Scene3D/Components/MotionComponent.h"
+#include "Scene3D/Components/ParticleEffectComponent.h"
+#include "Scene3D/Components/RenderComponent.h"
+#include "Scene3D/Components/SlotComponent.h"
+#include "Scene3D/Components/TransformComponent.h"
+#include "Scene3D/Entity.h"
+#include "Scene3D/Scene.h"
+#include "Scene3D/SceneFile/SceneReferences.h"
+#include "Scene3D/SceneFileV2.h"
+#include "Time/SystemTimer.h"
+#include "Utils/StringFormat.h"
+
+using namespace DAVA;
+
+namespace SceneReferencesTestDetails
+{
+void WriteTextFile(const FilePath& path, const String& text)
+{
+    ScopedPtr<File> file(File::Create(path, File::CREATE | File::WRITE));
+    TEST_VERIFY(file && file->WriteNonTerminatedString(text));
+}
+
+// Creates emitter with superemitter layer spawning emitter saved to separate config
+void CreateEmitterConfigs(const FilePath& folder)
+{
+    FilePath innerPath = folder + "effects/inner.yaml";
+    ScopedPtr<ParticleEmitter> innerEmitter(new ParticleEmitter());
+    ScopedPtr<ParticleLayer> innerLayer(new ParticleLayer());
+    innerEmitter->AddLayer(innerLayer);
+    innerEmitter->SaveToYaml(innerPath);
+
+    ScopedPtr<ParticleLayer> superLayer(new ParticleLayer());
+    superLayer->type = ParticleLayer::TYPE_SUPEREMITTER_PARTICLES;
+    superLayer->innerEmitter = new ParticleEmitterInstance(nullptr, innerEmitter);
+    superLayer->innerEmitterPath = innerPath;
+
+    ScopedPtr<ParticleEmitter> superEmitter(new ParticleEmitter());
+    superEmitter->AddLayer(superLayer);
+    superEmitter->SaveToYaml(folder + "effects/super.yaml");
+}
+
+void CreateMotionConfig(const FilePath& folder)
+{
+    WriteTextFile(folder + "motions/character.yaml",
+                  Format("clips:\n  - clip: \"%s\"\n  - clip: \"%s\"\n",
+                         (folder + "motions/idle.anim").GetStringValue().c_str(),
+                         (folder + "motions/walk.anim").GetStringValue().c_str()));
+}
+
+void AddMesh(Scene* scene, PolygonGroup* geometry, NMaterial* material, const Vector3& position)
+{
+    ScopedPtr<Mesh> mesh(new Mesh());
+    mesh->AddPolygonGroup(geometry, material);
+
+    ScopedPtr<Entity> entity(new Entity());
+    entity->AddComponent(new RenderComponent(mesh));
+    GetTransformComponent(entity)->SetLocalTranslation(position);
+    scene->AddNode(entity);
+}
+
+// Scene referencing textures through material hierarchy, effect with inner emitter, motion and slot configs
+void CreateScene(Scene* scene, const FilePath& folder, int32 meshCount)
+{
+    ScopedPtr<NMaterial> globalMaterial(new NMaterial());
+    ScopedPtr<Texture> globalTexture(Texture::CreateFromFile(folder + "textures/global.tex"));
+    globalMaterial->AddTexture(NMaterialTextureName::TEXTURE_DETAIL, globalTexture);
+    scene->SetGlobalMaterial(globalMaterial);
+
+    ScopedPtr<NMaterial> parentMaterial(new NMaterial());
+    parentMaterial->SetFXName(NMaterialName::TEXTURED_OPAQUE);
+    ScopedPtr<Texture> parentTexture(Texture::CreateFromFile(folder + "textures/parent.tex"));
+    parentMaterial->AddTexture(NMaterialTextureName::TEXTURE_ALBEDO, parentTexture);
+
+    Map<FastName, float32> options;
+    ScopedPtr<PolygonGroup> geometry(GeometryGenerator::GenerateBox(AABBox3(Vector3(-1.f, -1.f, 0.f), Vector3(1.f, 1.f, 2.f)), options));
+    for (int32 i = 0; i < meshCount; ++i)
+    {
+        ScopedPtr<NMaterial> material(new NMaterial());
+        material->SetParent(parentMaterial);
+        ScopedPtr<Texture> texture(Texture::CreateFromFile(folder + Format("textures/mesh_%d.tex", i % 8)));
+        material->AddTexture(NMaterialTextureName::TEXTURE_NORMAL, texture);
+        AddMesh(scene, geometry, material, Vector3(i * 4.f, 0.f, 0.f));
+    }
+
+    ScopedPtr<Entity> effectEntity(new Entity());
+    FilePath effectPath = folder + "effects/super.yaml";
+    ScopedPtr<ParticleEmitter> emitter(ParticleEmitter::LoadEmitter(effectPath));
+    ScopedPtr<ParticleEmitterInstance> emitterInstance(new ParticleEmitterInstance(nullptr, emitter));
+    emitterInstance->SetFilePath(effectPath);
+    ParticleEffectComponent* effect = new ParticleEffectComponent();
+    effect->AddEmitterInstance(emitterInstance);
+    effectEntity->AddComponent(effect);
+    scene->AddNode(effectEntity);
+
+    ScopedPtr<Entity> characterEntity(new Entity());
+    MotionComponent* motion = new MotionComponent();
+    motion->SetDescriptorPath(folder + "motions/character.yaml");
+    characterEntity->AddComponent(motion);
+    SlotComponent* slot = new SlotComponent();
+    slot->SetSlotName(FastName("weapon"));
+    slot->SetConfigFilePath(folder + "slots/weapons.yaml");
+    characterEntity->AddComponent(slot);
+    scene->AddNode(characterEntity);
+}
+
+void EnumerateEntity(Entity* entity, Set<FilePath>& dependencies)
+{
+    for (int32 i = 0; i < entity->GetChildrenCount(); ++i)
+    {
+        EnumerateEntity(entity->GetChild(i), dependencies);
+    }
+
+    for (uint32 i = 0; i < entity->GetComponentCount<MotionComponent>(); ++i)
+    {
+        Vector<FilePath> motionDependencies = entity->GetComponent<MotionComponent>(i)->GetDependencies();
+        dependencies.insert(motionDependencies.begin(), motionDependencies.end());
+    }
+
+    for (uint32 i = 0; i < entity->GetComponentCount<SlotComponent>(); ++i)
+    {
+        dependencies.insert(entity->GetComponent<SlotComponent>(i)->GetConfigFilePath());
+    }
+
+    Function<void(ParticleEmitterInstance*)> enumerateEmitter = [&](ParticleEmitterInstance* instance) {
+        ParticleEmitter* emitter = instance->GetEmitter();
+        dependencies.insert(emitter->configPath);
+        for (ParticleLayer* layer : emitter->layers)
+        {
+            if (layer->type == ParticleLayer::TYPE_SUPEREMITTER_PARTICLES)
+            {
+                enumerateEmitter(layer->innerEmitter);
+            }
+        }
+    };
+    for (uint32 i = 0; i < entity->GetComponentCount<ParticleEffectComponent>(); ++i)
+    {
+        ParticleEffectComponent* effect = entity->GetComponent<ParticleEffectComponent>(i);
+        for (uint32 e = 0; e < effect->GetEmittersCount(); ++e)
+        {
+            enumerateEmitter(effect->GetEmitterInstance(e));
+        }
+    }
+
+    for (uint32 i = 0; i < entity->GetComponentCount<RenderComponent>(); ++i)
+    {
+        RenderObject* ro = entity->GetComponent<RenderComponent>(i)->GetRenderObject();
+        for (uint32 b = 0; b < ro->GetRenderBatchCount(); ++b)
+        {
+            Set<MaterialTextureInfo*> textures;
+            for (NMaterial* material = ro->GetRenderBatch(b)->GetMaterial(); material != nullptr; material = material->GetParent())
+            {
+                material->CollectLocalTextures(textures);
+            }
+            for (const MaterialTextureInfo* texture : textures)
+            {
+                dependencies.insert(texture->path);
+            }
+        }
+    }
+}
+
+// Reference result made the way SceneDependency did it before scanner: load scene and enumerate its objects
+Set<FilePath> GetLoadedSceneReferences(const FilePath& scenePath)
+{
+    Set<FilePath> dependencies;
+    ScopedPtr<Scene> scene(new Scene());
+    if (scene->LoadScene(scenePath) == SceneFileV2::ERROR_NO_ERROR)
+    {
+        EnumerateEntity(scene, dependencies);
+    }
+    dependencies.erase(FilePath());
+    return dependencies;
+}
+
+Set<FilePath> GetScannedSceneReferences(const FilePath& scenePath)
+{
+    SceneReferences references;
+    ScopedPtr<SceneFileV2> sceneFile(new SceneFileV2());
+    TEST_VERIFY(sceneFile->ScanReferences(scenePath, references));
+
+    Set<FilePath> dependencies;
+    references.GetAll(dependencies);
+    return dependencies;
+}
+}
+
+DAVA_TESTCLASS (SceneReferencesTest)
+{
+    FilePath testFolder;
+
+    SceneReferencesTest()
+    {
+        FileSystem* fs = GetEngineContext()->fileSystem;
+        testFolder = fs->GetTempDirectoryPath();
+        testFolder.MakeDirectoryPathname();
+        testFolder += "SceneReferencesTest/";
+        fs->DeleteDirectory(testFolder, true);
+        fs->CreateDirectory(testFolder + "effects/", true);
+        fs->CreateDirectory(testFolder + "motions/", true);
+        fs->CreateDirectory(testFolder + "scenes/", true);
+
+        SceneReferencesTestDetails::CreateEmitterConfigs(testFolder);
+        SceneReferencesTestDetails::CreateMotionConfig(testFolder);
+    }
+
+    ~SceneReferencesTest()
+    {
+        GetEngineContext()->fileSystem->DeleteDirectory(testFolder, true);
+    }
+
+    DAVA_TEST (ScanMatchesFullLoadTest)
+    {
+        using namespace SceneReferencesTestDetails;
+
+        FilePath scenePath = testFolder + "scenes/scene.sc2";
+        {
+            ScopedPtr<Scene> scene(new Scene());
+            CreateScene(scene, testFolder, 10);
+            TEST_VERIFY(scene->SaveScene(scenePath) == SceneFileV2::ERROR_NO_ERROR);
+        }
+
+        SceneReferences references;
+        ScopedPtr<SceneFileV2> sceneFile(new SceneFileV2());
+        TEST_VERIFY(sceneFile->ScanReferences(scenePath, references));
+        TEST_VERIFY(references.textures.count(testFolder + "textures/global.tex") == 1);
+        TEST_VERIFY(references.textures.count(testFolder + "textures/parent.tex") == 1);
+        TEST_VERIFY(references.textures.size() == 2 + 8);
+        TEST_VERIFY(references.particleEmitters.count(testFolder + "effects/inner.yaml") == 1);
+        TEST_VERIFY(references.motions.count(testFolder + "motions/walk.anim") == 1);
+        TEST_VERIFY(references.slotConfigs.count(testFolder + "slots/weapons.yaml") == 1);
+
+        Set<FilePath> scanned;
+        references.GetAll(scanned);
+        TEST_VERIFY(scanned == GetLoadedSceneReferences(scenePath));
+    }
+
+    DAVA_TEST (CacheTest)
+    {
+        using namespace SceneReferencesTestDetails;
+
+        FilePath scenePath = testFolder + "scenes/cached.sc2";
+        FilePath cachePath = testFolder + "references.cache";
+        {
+            ScopedPtr<Scene> scene(new Scene());
+            CreateScene(scene, testFolder, 2);
+            TEST_VERIFY(scene->SaveScene(scenePath) == SceneFileV2::ERROR_NO_ERROR);
+        }
+
+        SceneReferences references;
+        {
+            SceneReferencesCache cache;
+            TEST_VERIFY(cache.GetReferences(scenePath, references));
+            TEST_VERIFY(cache.Save(cachePath));
+            TEST_VERIFY(cache.GetStatistics().misses == 1);
+        }
+
+        SceneReferencesCache cache;
+        TEST_VERIFY(cache.Load(cachePath));
+
+        SceneReferences cachedReferences;
+        TEST_VERIFY(cache.GetReferences(scenePath, cachedReferences));
+        TEST_VERIFY(cache.GetStatistics().hits == 1);
+        TEST_VERIFY(cachedReferences.textures == references.textures);
+        TEST_VERIFY(cachedReferences.particleEmitters == references.particleEmitters);
+        TEST_VERIFY(cachedReferences.motions == references.motions);
+        TEST_VERIFY(cachedReferences.slotConfigs == references.slotConfigs);
+
+        // changed motion descriptor invalidates entry
+        WriteTextFile(testFolder + "motions/character.yaml", Format("clips:\n  - clip: \"%s\"\n", (testFolder + "motions/run.anim").GetStringValue().c_str()));
+        TEST_VERIFY(cache.GetReferences(scenePath, cachedReferences));
+        TEST_VERIFY(cache.GetStatistics().misses == 1);
+        TEST_VERIFY(cachedReferences.motions.count(testFolder + "motions/run.anim") == 1);
+        CreateMotionConfig(testFolder);
+    }
+
+    DAVA_TEST (ScanBenchmark)
+    {
+        using namespace SceneReferencesTestDetails;
+
+        const uint32 sceneCount = 300;
+        const uint32 threadCount = 4;
+
+        Vector<FilePath> scenePaths;
+        for (uint32 i = 0; i < sceneCount; ++i)
+        {
+            FilePath scenePath = testFolder + Format("scenes/benchmark_%03u.sc2", i);
+            ScopedPtr<Scene> scene(new Scene());
+            CreateScene(scene, testFolder, 20);
+            TEST_VERIFY(scene->SaveScene(scenePath) == SceneFileV2::ERROR_NO_ERROR);
+            scenePaths.push_back(scenePath);
+        }
+
+        int64 startTime = SystemTimer::GetUs();
+        Vector<Set<FilePath>> loadedReferences(sceneCount);
+        for (uint32 i = 0; i < sceneCount; ++i)
+        {
+            loadedReferences[i] = GetLoadedSceneReferences(scenePaths[i]);
+        }
+        int64 loadTime = SystemTimer::GetUs() - startTime;
+
+        startTime = SystemTimer::GetUs();
+        Vector<Set<FilePath>> scannedReferences(sceneCount);
+        for (uint32 i = 0; i < sceneCount; ++i)
+        {
+            scannedReferences[i] = GetScannedSceneReferences(scenePaths[i]);
+        }
+        int64 scanTime = SystemTimer::GetUs() - startTime;
+        TEST_VERIFY(scannedReferences == loadedReferences);
+
+        // each thread scans every `threadCount`-th scene
+        startTime = SystemTimer::GetUs();
+        Vector<Set<FilePath>> parallelReferences(sceneCount);
+        Vector<RefPtr<Thread>> threads;
+        for (uint32 t = 0; t < threadCount; ++t)
+        {
+            threads.emplace_back(Thread::Create([&, t]() {
+                for (uint32 i = t; i < sceneCount; i += threadCount)
+                {
+                    SceneReferences references;
+                    ScopedPtr<SceneFileV2> sceneFile(new SceneFileV2());
+                    sceneFile->ScanReferences(scenePaths[i], references);
+                    references.GetAll(parallelReferences[i]);
+                }
+            }));
+            threads.back()->Start();
+        }
+        for (RefPtr<Thread>& thread : threads)
+        {
+            thread->Join();
+        }
+        int64 parallelScanTime = SystemTimer::GetUs() - startTime;
+        TEST_VERIFY(parallelReferences == loadedReferences);
+
+        SceneReferencesCache cache;
+        for (const FilePath& scenePath : scenePaths)
+        {
+            SceneReferences references;
+            cache.GetReferences(scenePath, references);
+        }
+        startTime = SystemTimer::GetUs();
+        for (const FilePath& scenePath : scenePaths)
+        {
+            SceneReferences references;
+            cache.GetReferences(scenePath, references);
+        }
+        int64 cachedTime = SystemTimer::GetUs() - startTime;
+        TEST_VERIFY(cache.GetStatistics().hits == sceneCount);
+
+        Logger::Info("Scene references benchmark (%u scenes): full load %lld ms, scan %lld ms, scan in %u threads %lld ms, cached %lld ms",
+                     sceneCount, loadTime / 1000, scanTime / 1000, threadCount, parallelScanTime / 1000, cachedTime / 1000);
+    }
+};
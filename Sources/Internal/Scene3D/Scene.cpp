@@ -198,6 +198,8 @@ Scene::Scene(uint32 _systemsMask /* = SCENE_SYSTEM_ALL_MASK */)
     static uint32 idCounter = 0;
     sceneId = ++idCounter;
 
+    entityIndex.SetRoot(this);
+
     CreateComponents();
     CreateSystems();
 
@@ -489,6 +491,9 @@ void Scene::RegisterEntity(Entity* entity)
         entity->SetSceneID(sceneId);
     }
 
+    entityIndex.AddEntity(entity);
+    ++visualChangesCounter;
+
     for (auto& system : systems)
     {
         system->RegisterEntity(entity);
@@ -497,6 +502,9 @@ void Scene::RegisterEntity(Entity* entity)
 
 void Scene::UnregisterEntity(Entity* entity)
 {
+    entityIndex.RemoveEntity(entity);
+    ++visualChangesCounter;
+
     if (transformSingleComponent)
     {
         transformSingleComponent->EraseEntity(entity);
@@ -529,6 +537,9 @@ void Scene::RegisterEntitiesInSystemRecursively(SceneSystem* system, Entity* ent
 void Scene::RegisterComponent(Entity* entity, Component* component)
 {
     DVASSERT(entity && component);
+    entityIndex.AddComponent(entity, component->GetType());
+    ++visualChangesCounter;
+
     uint32 systemsCount = static_cast<uint32>(systems.size());
     for (uint32 k = 0; k < systemsCount; ++k)
     {
@@ -539,6 +550,9 @@ void Scene::RegisterComponent(Entity* entity, Component* component)
 void Scene::UnregisterComponent(Entity* entity, Component* component)
 {
     DVASSERT(entity && component);
+    entityIndex.RemoveComponent(entity, component->GetType());
+    ++visualChangesCounter;
+
     uint32 systemsCount = static_cast<uint32>(systems.size());
     for (uint32 k = 0; k < systemsCount; ++k)
     {
@@ -713,9 +727,22 @@ void Scene::Update(float32 timeElapsed)
 
     if (transformSingleComponent)
     {
+        if (!transformSingleComponent->localTransformChanged.empty() ||
+            !transformSingleComponent->transformParentChanged.empty() ||
+            !transformSingleComponent->worldTransformChanged.map.empty() ||
+            !transformSingleComponent->animationTransformChanged.empty())
+        {
+            ++visualChangesCounter;
+        }
         transformSingleComponent->Clear();
     }
 
+    if ((particleEffectSystem != nullptr && particleEffectSystem->HasActiveEffects()) ||
+        (motionSystem != nullptr && motionSystem->HasActiveMotions()))
+    {
+        ++visualChangesCounter;
+    }
+
 #if defined(__DAVAENGINE_PHYSICS_ENABLED__)
     if (collisionSingleComponent)
     {
@@ -726,6 +753,16 @@ void Scene::Update(float32 timeElapsed)
     sceneGlobalTime += timeElapsed;
 }
 
+uint32 Scene::GetVisualChangesCounter() const
+{
+    return visualChangesCounter;
+}
+
+void Scene::InvalidateVisualState()
+{
+    ++visualChangesCounter;
+}
+
 void Scene::Draw()
 {
     DAVA_PROFILER_CPU_SCOPE(ProfilerCPUMarkerName::SCENE_DRAW)
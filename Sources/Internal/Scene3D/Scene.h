@@ -10,6 +10,7 @@
 #include "Reflection/Reflection.h"
 #include "Render/RenderBase.h"
 #include "Scene3D/Entity.h"
+#include "Scene3D/EntityIndex.h"
 #include "Scene3D/SceneFile/SerializationContext.h"
 #include "Scene3D/SceneFile/VersionInfo.h"
 #include "Scene3D/SceneFileV2.h"
@@ -206,6 +207,17 @@ public:
 
     virtual void Update(float32 timeElapsed);
     virtual void Draw();
+
+    /**
+        Return counter that is increased every time scene content may look different than before:
+        entities or components were added or removed, transforms changed during `Update`, or particle effects
+        or motions are playing. Changes that are not tracked (e.g. material properties) should be reported with `InvalidateVisualState`.
+        Counter is used by clients that want to skip redrawing of unchanged scene (e.g. `UI3DView`).
+     */
+    uint32 GetVisualChangesCounter() const;
+
+    /** Increase visual changes counter to notify clients that scene should be redrawn. */
+    void InvalidateVisualState();
     void SceneDidLoaded() override;
 
     Camera* GetCamera(int32 n);
@@ -275,6 +287,9 @@ protected:
     Camera* mainCamera;
     Camera* drawCamera;
 
+    EntityIndex entityIndex;
+    uint32 visualChangesCounter = 0;
+
     struct FixedUpdate
     {
         float32 constantTime = 0.016f;
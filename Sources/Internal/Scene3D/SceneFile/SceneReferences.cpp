@@ -0,0 +1,240 @@
+#include "Scene3D/SceneFile/SceneReferences.h"
+#include "Base/ScopedPtr.h"
+#include "Concurrency/LockGuard.h"
+#include "FileSystem/KeyedArchive.h"
+#include "Scene3D/SceneFileV2.h"
+#include "Utils/MD5.h"
+#include "Utils/StringFormat.h"
+
+namespace DAVA
+{
+namespace SceneReferencesDetail
+{
+const uint32 CACHE_VERSION = 1;
+
+String GetFileHash(const FilePath& path)
+{
+    MD5::MD5Digest digest;
+    MD5::ForFile(path, digest);
+    return MD5::HashToString(digest);
+}
+
+// Configs which were parsed by scanner, result of scan depends on their content
+Vector<FilePath> GetParsedConfigs(const SceneReferences& references)
+{
+    Vector<FilePath> configs(references.particleEmitters.begin(), references.particleEmitters.end());
+    for (const FilePath& path : references.motions)
+    {
+        if (path.IsEqualToExtension(".yaml"))
+        {
+            configs.push_back(path);
+        }
+    }
+    return configs;
+}
+
+void SavePaths(KeyedArchive* archive, const String& key, const Set<FilePath>& paths)
+{
+    ScopedPtr<KeyedArchive> pathsArchive(new KeyedArchive());
+    uint32 index = 0;
+    for (const FilePath& path : paths)
+    {
+        pathsArchive->SetString(Format("%04u", index++), path.GetStringValue());
+    }
+    archive->SetArchive(key, pathsArchive);
+}
+
+void LoadPaths(const KeyedArchive* archive, const String& key, Set<FilePath>& paths)
+{
+    const KeyedArchive* pathsArchive = archive->GetArchive(key);
+    if (pathsArchive != nullptr)
+    {
+        for (const auto& it : pathsArchive->GetArchieveData())
+        {
+            paths.insert(FilePath(it.second->AsString()));
+        }
+    }
+}
+}
+
+void SceneReferences::GetAll(Set<FilePath>& paths) const
+{
+    paths.insert(textures.begin(), textures.end());
+    paths.insert(particleEmitters.begin(), particleEmitters.end());
+    paths.insert(motions.begin(), motions.end());
+    paths.insert(slotConfigs.begin(), slotConfigs.end());
+    paths.insert(heightmaps.begin(), heightmaps.end());
+    paths.insert(vegetationGeometry.begin(), vegetationGeometry.end());
+}
+
+void SceneReferences::Clear()
+{
+    textures.clear();
+    particleEmitters.clear();
+    motions.clear();
+    slotConfigs.clear();
+    heightmaps.clear();
+    vegetationGeometry.clear();
+}
+
+bool SceneReferencesCache::Load(const FilePath& cachePath)
+{
+    using namespace SceneReferencesDetail;
+
+    ScopedPtr<KeyedArchive> archive(new KeyedArchive());
+    if (archive->Load(cachePath) == false || archive->GetUInt32("version") != CACHE_VERSION)
+    {
+        return false;
+    }
+
+    const KeyedArchive* entriesArchive = archive->GetArchive("entries");
+    if (entriesArchive == nullptr)
+    {
+        return false;
+    }
+
+    LockGuard<Mutex> lock(mutex);
+    for (const auto& it : entriesArchive->GetArchieveData())
+    {
+        const KeyedArchive* entryArchive = it.second->AsKeyedArchive();
+        if (entryArchive == nullptr)
+            continue;
+
+        Entry entry;
+        entry.sceneHash = entryArchive->GetString("hash");
+
+        const KeyedArchive* configsArchive = entryArchive->GetArchive("configs");
+        if (configsArchive != nullptr)
+        {
+            for (const auto& config : configsArchive->GetArchieveData())
+            {
+                entry.configHashes.emplace_back(FilePath(config.first), config.second->AsString());
+            }
+        }
+
+        LoadPaths(entryArchive, "textures", entry.references.textures);
+        LoadPaths(entryArchive, "particleEmitters", entry.references.particleEmitters);
+        LoadPaths(entryArchive, "motions", entry.references.motions);
+        LoadPaths(entryArchive, "slotConfigs", entry.references.slotConfigs);
+        LoadPaths(entryArchive, "heightmaps", entry.references.heightmaps);
+        LoadPaths(entryArchive, "vegetationGeometry", entry.references.vegetationGeometry);
+
+        entries[entryArchive->GetString("scene")] = std::move(entry);
+    }
+    return true;
+}
+
+bool SceneReferencesCache::Save(const FilePath& cachePath) const
+{
+    using namespace SceneReferencesDetail;
+
+    ScopedPtr<KeyedArchive> archive(new KeyedArchive());
+    archive->SetUInt32("version", CACHE_VERSION);
+
+    ScopedPtr<KeyedArchive> entriesArchive(new KeyedArchive());
+    {
+        LockGuard<Mutex> lock(mutex);
+
+        uint32 index = 0;
+        for (const auto& it : entries)
+        {
+            const Entry& entry = it.second;
+
+            ScopedPtr<KeyedArchive> entryArchive(new KeyedArchive());
+            entryArchive->SetString("scene", it.first);
+            entryArchive->SetString("hash", entry.sceneHash);
+
+            ScopedPtr<KeyedArchive> configsArchive(new KeyedArchive());
+            for (const auto& config : entry.configHashes)
+            {
+                configsArchive->SetString(config.first.GetStringValue(), config.second);
+            }
+            entryArchive->SetArchive("configs", configsArchive);
+
+            SavePaths(entryArchive, "textures", entry.references.textures);
+            SavePaths(entryArchive, "particleEmitters", entry.references.particleEmitters);
+            SavePaths(entryArchive, "motions", entry.references.motions);
+            SavePaths(entryArchive, "slotConfigs", entry.references.slotConfigs);
+            SavePaths(entryArchive, "heightmaps", entry.references.heightmaps);
+            SavePaths(entryArchive, "vegetationGeometry", entry.references.vegetationGeometry);
+
+            entriesArchive->SetArchive(Format("%04u", index++), entryArchive);
+        }
+    }
+    archive->SetArchive("entries", entriesArchive);
+
+    return archive->Save(cachePath);
+}
+
+bool SceneReferencesCache::GetReferences(const FilePath& scenePath, SceneReferences& references)
+{
+    using namespace SceneReferencesDetail;
+
+    const String key = scenePath.GetAbsolutePathname();
+    const String sceneHash = GetFileHash(scenePath);
+
+    // entry is copied to hash its configs without lock
+    Entry cachedEntry;
+    bool hasCachedEntry = false;
+    {
+        LockGuard<Mutex> lock(mutex);
+        auto found = entries.find(key);
+        if (found != entries.end())
+        {
+            cachedEntry = found->second;
+            hasCachedEntry = true;
+        }
+    }
+
+    if (hasCachedEntry && IsEntryValid(cachedEntry, sceneHash))
+    {
+        references = std::move(cachedEntry.references);
+
+        LockGuard<Mutex> lock(mutex);
+        statistics.hits += 1;
+        return true;
+    }
+
+    ScopedPtr<SceneFileV2> sceneFile(new SceneFileV2());
+    Entry entry;
+    if (sceneFile->ScanReferences(scenePath, entry.references) == false)
+    {
+        return false;
+    }
+
+    entry.sceneHash = sceneHash;
+    for (const FilePath& config : GetParsedConfigs(entry.references))
+    {
+        entry.configHashes.emplace_back(config, GetFileHash(config));
+    }
+    references = entry.references;
+
+    LockGuard<Mutex> lock(mutex);
+    statistics.misses += 1;
+    entries[key] = std::move(entry);
+    return true;
+}
+
+SceneReferencesCache::Statistics SceneReferencesCache::GetStatistics() const
+{
+    LockGuard<Mutex> lock(mutex);
+    return statistics;
+}
+
+bool SceneReferencesCache::IsEntryValid(const Entry& entry, const String& sceneHash) const
+{
+    if (entry.sceneHash != sceneHash)
+    {
+        return false;
+    }
+
+    for (const auto& config : entry.configHashes)
+    {
+        if (SceneReferencesDetail::GetFileHash(config.first) != config.second)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+}
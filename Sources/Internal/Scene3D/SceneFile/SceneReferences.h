@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Base/BaseTypes.h"
+#include "Concurrency/Mutex.h"
+#include "FileSystem/FilePath.h"
+
+namespace DAVA
+{
+/**
+    \brief Files referenced by scene, see SceneFileV2::ScanReferences.
+*/
+struct SceneReferences
+{
+    Set<FilePath> textures; // material textures and vegetation lightmaps
+    Set<FilePath> particleEmitters; // emitter configs, including inner emitters of superemitter layers
+    Set<FilePath> motions; // motion descriptors and animation clips referenced by them
+    Set<FilePath> slotConfigs;
+    Set<FilePath> heightmaps;
+    Set<FilePath> vegetationGeometry;
+
+    void GetAll(Set<FilePath>& paths) const;
+    void Clear();
+};
+
+/**
+    \brief Persistent cache of SceneFileV2::ScanReferences results.
+
+    Entries are keyed by scene path and MD5 of scene content. Emitter and motion configs parsed during scan are
+    hashed as well, so scene is rescanned if any of them has changed. Cache can be used from several threads.
+*/
+class SceneReferencesCache final
+{
+public:
+    struct Statistics
+    {
+        uint32 hits = 0;
+        uint32 misses = 0;
+    };
+
+    bool Load(const FilePath& cachePath);
+    bool Save(const FilePath& cachePath) const;
+
+    /** Get references of `scenePath` from cache or scan scene if entry is missing or outdated. */
+    bool GetReferences(const FilePath& scenePath, SceneReferences& references);
+
+    Statistics GetStatistics() const;
+
+private:
+    struct Entry
+    {
+        String sceneHash;
+        Vector<std::pair<FilePath, String>> configHashes;
+        SceneReferences references;
+    };
+
+    bool IsEntryValid(const Entry& entry, const String& sceneHash) const;
+
+    mutable Mutex mutex;
+    UnorderedMap<String, Entry> entries;
+    Statistics statistics;
+};
+}
@@ -34,7 +34,11 @@
 #include "Scene3D/Components/ComponentHelpers.h"
 
 #include "Scene3D/Scene.h"
+#include "Scene3D/SceneFile/SceneReferences.h"
 #include "Scene3D/Systems/QualitySettingsSystem.h"
+#include "Scene3D/Components/MotionComponent.h"
+#include "FileSystem/YamlNode.h"
+#include "FileSystem/YamlParser.h"
 
 #include "Scene3D/Converters/SpeedTreeConverter.h"
 
@@ -715,6 +719,250 @@ SceneArchive* SceneFileV2::LoadSceneArchive(const FilePath& filename)
     return res;
 }
 
+namespace SceneFileV2Detail
+{
+struct ReferencesScanContext
+{
+    FilePath scenePath;
+    Map<uint64, KeyedArchive*> materials;
+    uint64 globalMaterialId = 0;
+    Set<uint64> usedMaterials;
+    SceneReferences* references = nullptr;
+};
+
+// KeyedArchive::GenKeyFromIndex uses static buffer and can't be called from several threads
+String GetIndexKey(uint32 index)
+{
+    return Format("%04u", index);
+}
+
+void AddReference(Set<FilePath>& paths, const FilePath& directory, const String& relativePath)
+{
+    if (relativePath.empty() == false)
+    {
+        paths.insert(directory + relativePath);
+    }
+}
+
+void CollectMaterialTextures(const KeyedArchive* archive, ReferencesScanContext& context)
+{
+    if (archive == nullptr)
+        return;
+
+    const KeyedArchive* texturesArchive = archive->GetArchive("textures");
+    if (texturesArchive != nullptr)
+    {
+        for (const auto& it : texturesArchive->GetArchieveData())
+        {
+            AddReference(context.references->textures, context.scenePath, it.second->AsString());
+        }
+    }
+}
+
+// Textures of material and all its parents, as NMaterial::CollectLocalTextures does for every config
+void CollectMaterialChainTextures(uint64 materialId, ReferencesScanContext& context)
+{
+    Set<uint64> visited;
+    while (materialId != 0 && visited.insert(materialId).second)
+    {
+        auto found = context.materials.find(materialId);
+        if (found == context.materials.end())
+            break;
+
+        const KeyedArchive* archive = found->second;
+        uint32 configCount = archive->GetUInt32(NMaterialSerializationKey::ConfigCount, 1);
+        if (configCount == 1)
+        {
+            CollectMaterialTextures(archive, context);
+        }
+        else
+        {
+            for (uint32 i = 0; i < configCount; ++i)
+            {
+                CollectMaterialTextures(archive->GetArchive(Format(NMaterialSerializationKey::ConfigArchive.c_str(), i)), context);
+            }
+        }
+
+        // material without parent key is bound to global material, see SerializationContext::ResolveMaterialBindings
+        materialId = archive->GetUInt64(NMaterialSerializationKey::ParentMaterialKey, 0);
+        if (materialId == 0)
+        {
+            materialId = context.globalMaterialId;
+        }
+    }
+}
+
+void CollectEmitterReferences(const FilePath& configPath, ReferencesScanContext& context)
+{
+    if (context.references->particleEmitters.insert(configPath).second == false)
+        return;
+
+    RefPtr<YamlParser> parser(YamlParser::Create(configPath));
+    const YamlNode* rootNode = (parser != nullptr) ? parser->GetRootNode() : nullptr;
+    if (rootNode == nullptr)
+        return;
+
+    for (uint32 k = 0, count = rootNode->GetCount(); k < count; ++k)
+    {
+        const YamlNode* node = rootNode->Get(k);
+        const YamlNode* typeNode = node->Get("type");
+        const YamlNode* layerTypeNode = node->Get("layerType");
+        const YamlNode* innerEmitterPathNode = node->Get("innerEmitterPath");
+        if (typeNode != nullptr && typeNode->AsString() == "layer" &&
+            layerTypeNode != nullptr && layerTypeNode->AsString() == "superEmitter" &&
+            innerEmitterPathNode != nullptr && innerEmitterPathNode->AsString().empty() == false)
+        {
+            CollectEmitterReferences(configPath.GetDirectory() + innerEmitterPathNode->AsString(), context);
+        }
+    }
+}
+
+void CollectRenderObjectReferences(const KeyedArchive* archive, ReferencesScanContext& context)
+{
+    SceneReferences* references = context.references;
+
+    // landscape
+    AddReference(references->heightmaps, context.scenePath, archive->GetString("hmap"));
+    if (archive->IsKeyExists("matname"))
+    {
+        context.usedMaterials.insert(archive->GetUInt64("matname"));
+    }
+
+    // vegetation, its heightmap is taken from landscape
+    AddReference(references->textures, context.scenePath, archive->GetString("vro.lightmap"));
+    AddReference(references->vegetationGeometry, context.scenePath, archive->GetString("vro.customGeometry"));
+    const KeyedArchive* geometryArchive = archive->GetArchive("vro.geometryData");
+    if (geometryArchive != nullptr)
+    {
+        for (uint32 i = 0, count = geometryArchive->GetUInt32("cgsd.layerCount"); i < count; ++i)
+        {
+            const KeyedArchive* layerArchive = geometryArchive->GetArchive(Format("cgsd.layer.%d", i));
+            if (layerArchive != nullptr)
+            {
+                context.usedMaterials.insert(layerArchive->GetUInt64("cgsd.layer.materialId"));
+            }
+        }
+    }
+
+    const KeyedArchive* batchesArchive = archive->GetArchive("ro.batches");
+    if (batchesArchive != nullptr)
+    {
+        for (uint32 i = 0, count = archive->GetUInt32("ro.batchCount"); i < count; ++i)
+        {
+            const KeyedArchive* batchArchive = batchesArchive->GetArchive(GetIndexKey(i));
+            if (batchArchive != nullptr)
+            {
+                context.usedMaterials.insert(batchArchive->GetUInt64("rb.nmatname"));
+            }
+        }
+    }
+}
+
+void CollectComponentReferences(const KeyedArchive* archive, ReferencesScanContext& context)
+{
+    SceneReferences* references = context.references;
+
+    const KeyedArchive* renderObjectArchive = archive->GetArchive("rc.renderObj");
+    if (renderObjectArchive != nullptr)
+    {
+        CollectRenderObjectReferences(renderObjectArchive, context);
+    }
+
+    const KeyedArchive* emittersArchive = archive->GetArchive("pe.emitters");
+    if (emittersArchive != nullptr)
+    {
+        for (uint32 i = 0, count = archive->GetUInt32("pe.emittersCount"); i < count; ++i)
+        {
+            const KeyedArchive* emitterArchive = emittersArchive->GetArchive(GetIndexKey(i));
+            String filename = (emitterArchive != nullptr) ? emitterArchive->GetString("emitter.filename") : String();
+            if (filename.empty() == false)
+            {
+                CollectEmitterReferences(context.scenePath + filename, context);
+            }
+        }
+    }
+
+    // keys are checked in the same order as MotionComponent::Deserialize does
+    for (const char* key : { "motion.filepath", "motion.configPath", "simpleMotion.animationPath" })
+    {
+        String motionPath = archive->GetString(key);
+        if (motionPath.empty() == false)
+        {
+            Vector<FilePath> dependencies = MotionComponent::GetDescriptorDependencies(context.scenePath + motionPath);
+            references->motions.insert(dependencies.begin(), dependencies.end());
+            break;
+        }
+    }
+
+    AddReference(references->slotConfigs, context.scenePath, archive->GetString("sc.configFilePath"));
+}
+
+void CollectEntityReferences(const SceneArchive::SceneArchiveHierarchyNode* node, ReferencesScanContext& context)
+{
+    const KeyedArchive* archive = node->archive;
+    if (archive->GetString("##name") == "GlobalMaterial")
+    {
+        context.globalMaterialId = archive->GetUInt64("globalMaterialId");
+        return;
+    }
+
+    const KeyedArchive* componentsArchive = archive->GetArchive("components");
+    if (componentsArchive != nullptr)
+    {
+        for (uint32 i = 0, count = componentsArchive->GetUInt32("count"); i < count; ++i)
+        {
+            const KeyedArchive* componentArchive = componentsArchive->GetArchive(GetIndexKey(i));
+            if (componentArchive != nullptr)
+            {
+                CollectComponentReferences(componentArchive, context);
+            }
+        }
+    }
+
+    for (const SceneArchive::SceneArchiveHierarchyNode* child : node->children)
+    {
+        CollectEntityReferences(child, context);
+    }
+}
+}
+
+bool SceneFileV2::ScanReferences(const FilePath& filename, SceneReferences& references)
+{
+    using namespace SceneFileV2Detail;
+
+    ScopedPtr<SceneArchive> archive(LoadSceneArchive(filename));
+    if (!archive)
+    {
+        return false;
+    }
+
+    ReferencesScanContext context;
+    context.scenePath = filename.GetDirectory();
+    context.references = &references;
+
+    for (KeyedArchive* dataNode : archive->dataNodes)
+    {
+        if (dataNode->GetString("##name") == "NMaterial")
+        {
+            uint64 id = dataNode->GetByteArrayAsType<uint64>("#id", 0);
+            id = dataNode->GetUInt64(NMaterialSerializationKey::MaterialKey, id);
+            context.materials[id] = dataNode;
+        }
+    }
+
+    for (const SceneArchive::SceneArchiveHierarchyNode* child : archive->children)
+    {
+        CollectEntityReferences(child, context);
+    }
+
+    for (uint64 materialId : context.usedMaterials)
+    {
+        CollectMaterialChainTextures(materialId, context);
+    }
+
+    return true;
+}
+
 bool SceneFileV2::WriteDescriptor(File* file, const Descriptor& descriptor)
 {
     if (sizeof(descriptor.size) != file->Write(&descriptor.size, sizeof(descriptor.size)))
@@ -64,6 +64,7 @@ namespace DAVA
 
 class NMaterial;
 class Scene;
+struct SceneReferences;
 
 class SceneArchive : public BaseObject
 {
@@ -150,6 +151,14 @@ public:
     void UpdatePolygonGroupRequestedFormatRecursively(Entity* entity);
     SceneArchive* LoadSceneArchive(const FilePath& filename); //purely load data
 
+    /**
+        Collect files referenced by scene `filename` without loading it. Only keyed archives of data nodes and entities
+        are read, no entities, components, materials or render objects are created, so scan doesn't need rendering context.
+        Emitter configs are parsed to find inner emitters, motion descriptors are parsed to find animation clips.
+        Different files can be scanned in parallel by separate SceneFileV2 instances.
+    */
+    bool ScanReferences(const FilePath& filename, SceneReferences& references);
+
 private:
     static bool ReadHeader(Header& header, File* file);
     static bool ReadVersionTags(VersionInfo::SceneVersion& version, File* file);
@@ -32,7 +32,7 @@ void MotionLayer::TriggerEvent(const FastName& trigger)
     }
 }
 
-void MotionLayer::Update(float32 dTime)
+void MotionLayer::Update(float32 dTime, bool evaluatePose)
 {
     if (pendingMotion != nullptr)
     {
@@ -99,14 +99,19 @@ void MotionLayer::Update(float32 dTime)
 
     //////////////////////////////////////////////////////////////////////////
 
-    currentPose.Reset();
     if (nextMotion != nullptr) //transition is active
     {
+        currentPose.Reset();
         motionTransition.Evaluate(&currentPose, &currentRootOffsetDelta);
+        evaluatePose = true;
     }
     else
     {
-        currentMotion->EvaluatePose(&currentPose);
+        if (evaluatePose)
+        {
+            currentPose.Reset();
+            currentMotion->EvaluatePose(&currentPose);
+        }
         currentMotion->GetRootOffsetDelta(&currentRootOffsetDelta);
     }
 
@@ -125,7 +130,7 @@ void MotionLayer::Update(float32 dTime)
 
     currentRootOffsetDelta *= rootExtractionMask;
 
-    if (rootNodeJointIndex != SkeletonComponent::INVALID_JOINT_INDEX)
+    if (evaluatePose && rootNodeJointIndex != SkeletonComponent::INVALID_JOINT_INDEX)
     {
         Vector3 rootPosition = currentPose.GetJointTransform(rootNodeJointIndex).GetPosition();
         rootPosition *= rootResetMask;
@@ -42,7 +42,12 @@ public:
 
     void TriggerEvent(const FastName& trigger); //TODO: *Skinning* make adequate naming
 
-    void Update(float32 dTime);
+    /**
+        Advance motions and collect reached markers and ended motions.
+        If `evaluatePose` is false, current pose is not updated (unless transition is active),
+        markers and root offset are still calculated.
+    */
+    void Update(float32 dTime, bool evaluatePose = true);
 
     void BindSkeleton(const SkeletonComponent* skeleton);
 
@@ -0,0 +1,159 @@
+#include "Scene3D/Streaming/SectorsManifest.h"
+
+#include "Base/ScopedPtr.h"
+#include "Debug/DVAssert.h"
+#include "FileSystem/KeyedArchive.h"
+#include "Logger/Logger.h"
+#include "Utils/StringFormat.h"
+
+#include <algorithm>
+
+namespace DAVA
+{
+namespace SectorsManifestDetails
+{
+const uint32 CURRENT_VERSION = 1;
+}
+
+bool SectorsManifest::Load(const FilePath& manifestPath)
+{
+    ScopedPtr<KeyedArchive> archive(new KeyedArchive());
+    if (!archive->Load(manifestPath))
+    {
+        Logger::Error("[SectorsManifest] Can't load %s", manifestPath.GetStringValue().c_str());
+        return false;
+    }
+
+    uint32 version = archive->GetUInt32("version");
+    if (version != SectorsManifestDetails::CURRENT_VERSION)
+    {
+        Logger::Error("[SectorsManifest] %s has unsupported version %u", manifestPath.GetStringValue().c_str(), version);
+        return false;
+    }
+
+    folder = manifestPath.GetDirectory();
+    origin = archive->GetVector2("origin");
+    sectorSize = archive->GetFloat("sectorSize");
+    columns = archive->GetInt32("columns");
+    rows = archive->GetInt32("rows");
+    baseSceneName = archive->GetString("baseScene");
+
+    sectors.clear();
+    uint32 sectorsCount = archive->GetUInt32("sectorsCount");
+    sectors.reserve(sectorsCount);
+    for (uint32 i = 0; i < sectorsCount; ++i)
+    {
+        KeyedArchive* sectorArchive = archive->GetArchive(Format("sector_%u", i));
+        if (sectorArchive == nullptr)
+        {
+            Logger::Error("[SectorsManifest] %s has no description for sector %u", manifestPath.GetStringValue().c_str(), i);
+            return false;
+        }
+
+        Sector sector;
+        sector.x = sectorArchive->GetInt32("x");
+        sector.y = sectorArchive->GetInt32("y");
+        sector.sceneName = sectorArchive->GetString("scene");
+        sector.bbox = AABBox3(sectorArchive->GetVector3("bboxMin"), sectorArchive->GetVector3("bboxMax"));
+        sector.fileSize = sectorArchive->GetUInt64("fileSize");
+        sector.entitiesCount = sectorArchive->GetUInt32("entitiesCount");
+        sectors.push_back(sector);
+    }
+
+    if (sectorSize <= 0.0f || columns < 0 || rows < 0)
+    {
+        Logger::Error("[SectorsManifest] %s has invalid grid", manifestPath.GetStringValue().c_str());
+        return false;
+    }
+
+    BuildLookup();
+    return true;
+}
+
+bool SectorsManifest::Save(const FilePath& manifestPath) const
+{
+    ScopedPtr<KeyedArchive> archive(new KeyedArchive());
+    archive->SetUInt32("version", SectorsManifestDetails::CURRENT_VERSION);
+    archive->SetVector2("origin", origin);
+    archive->SetFloat("sectorSize", sectorSize);
+    archive->SetInt32("columns", columns);
+    archive->SetInt32("rows", rows);
+    archive->SetString("baseScene", baseSceneName);
+    archive->SetUInt32("sectorsCount", static_cast<uint32>(sectors.size()));
+
+    for (size_t i = 0; i < sectors.size(); ++i)
+    {
+        const Sector& sector = sectors[i];
+        ScopedPtr<KeyedArchive> sectorArchive(new KeyedArchive());
+        sectorArchive->SetInt32("x", sector.x);
+        sectorArchive->SetInt32("y", sector.y);
+        sectorArchive->SetString("scene", sector.sceneName);
+        sectorArchive->SetVector3("bboxMin", sector.bbox.min);
+        sectorArchive->SetVector3("bboxMax", sector.bbox.max);
+        sectorArchive->SetUInt64("fileSize", sector.fileSize);
+        sectorArchive->SetUInt32("entitiesCount", sector.entitiesCount);
+        archive->SetArchive(Format("sector_%u", static_cast<uint32>(i)), sectorArchive);
+    }
+
+    if (!archive->Save(manifestPath))
+    {
+        Logger::Error("[SectorsManifest] Can't save %s", manifestPath.GetStringValue().c_str());
+        return false;
+    }
+
+    return true;
+}
+
+const SectorsManifest::Sector* SectorsManifest::GetSector(int32 x, int32 y) const
+{
+    int32 index = GetSectorIndex(x, y);
+    return (index >= 0) ? &sectors[index] : nullptr;
+}
+
+int32 SectorsManifest::GetSectorIndex(int32 x, int32 y) const
+{
+    if (x < 0 || y < 0 || x >= columns || y >= rows)
+    {
+        return -1;
+    }
+
+    if (cellToSector.size() != static_cast<size_t>(columns * rows))
+    {
+        DVASSERT(false, "BuildLookup wasn't called after grid modification");
+        return -1;
+    }
+    return cellToSector[y * columns + x];
+}
+
+void SectorsManifest::GetCellAt(const Vector2& point, int32& x, int32& y) const
+{
+    x = static_cast<int32>(std::floor((point.x - origin.x) / sectorSize));
+    y = static_cast<int32>(std::floor((point.y - origin.y) / sectorSize));
+}
+
+Rect SectorsManifest::GetCellRect(int32 x, int32 y) const
+{
+    return Rect(origin.x + x * sectorSize, origin.y + y * sectorSize, sectorSize, sectorSize);
+}
+
+FilePath SectorsManifest::GetScenePath(const Sector& sector) const
+{
+    return folder + sector.sceneName;
+}
+
+FilePath SectorsManifest::GetBaseScenePath() const
+{
+    return baseSceneName.empty() ? FilePath() : folder + baseSceneName;
+}
+
+void SectorsManifest::BuildLookup()
+{
+    cellToSector.assign(static_cast<size_t>(std::max(columns * rows, 0)), -1);
+    for (size_t i = 0; i < sectors.size(); ++i)
+    {
+        const Sector& sector = sectors[i];
+        DVASSERT(sector.x >= 0 && sector.y >= 0 && sector.x < columns && sector.y < rows);
+        cellToSector[sector.y * columns + sector.x] = static_cast<int32>(i);
+    }
+}
+} // namespace DAVA
@@ -0,0 +1,170 @@
+#include "Scene3D/Streaming/SectorsPartitioner.h"
+#include "Scene3D/Streaming/SectorsManifest.h"
+
+#include "Base/RefPtr.h"
+#include "Engine/Engine.h"
+#include "FileSystem/FileSystem.h"
+#include "Logger/Logger.h"
+#include "Math/Transform.h"
+#include "Render/Highlevel/Light.h"
+#include "Scene3D/Components/ComponentHelpers.h"
+#include "Scene3D/Components/TransformComponent.h"
+#include "Scene3D/Entity.h"
+#include "Scene3D/Scene.h"
+#include "Scene3D/Systems/TransformSystem.h"
+#include "Utils/StringFormat.h"
+
+#include <algorithm>
+
+namespace DAVA
+{
+namespace SectorsPartitionerDetails
+{
+bool IsGlobalEntity(Entity* entity)
+{
+    if (GetCamera(entity) != nullptr || GetLandscape(entity) != nullptr || GetVegetation(entity) != nullptr)
+    {
+        return true;
+    }
+
+    Light* light = GetLight(entity);
+    return (light != nullptr && light->GetType() != Light::TYPE_POINT && light->GetType() != Light::TYPE_SPOT);
+}
+
+struct Placement
+{
+    RefPtr<Entity> entity;
+    AABBox3 bbox;
+    Vector2 point;
+};
+}
+
+bool SectorsPartitioner::Partition(Scene* scene, const FilePath& manifestPath, const Settings& settings, SectorsManifest* manifest)
+{
+    using namespace SectorsPartitionerDetails;
+
+    DVASSERT(scene != nullptr);
+    DVASSERT(settings.sectorSize > 0.0f);
+
+    // world transforms are used for bounding boxes
+    scene->transformSystem->Process(0.0f);
+
+    Vector<Placement> placements;
+    Vector2 gridMin(std::numeric_limits<float32>::max(), std::numeric_limits<float32>::max());
+    Vector2 gridMax(-std::numeric_limits<float32>::max(), -std::numeric_limits<float32>::max());
+
+    for (int32 i = 0; i < scene->GetChildrenCount(); ++i)
+    {
+        Entity* entity = scene->GetChild(i);
+        if (IsGlobalEntity(entity))
+        {
+            continue;
+        }
+
+        Placement placement;
+        placement.entity = entity;
+        placement.bbox = entity->GetWTMaximumBoundingBoxSlow();
+        if (placement.bbox.IsEmpty())
+        {
+            const Vector3& translation = GetTransformComponent(entity)->GetWorldTransform().GetTranslation();
+            placement.bbox = AABBox3(translation, translation);
+        }
+        else
+        {
+            Vector3 size = placement.bbox.GetSize();
+            if (size.x > settings.maxEntitySize || size.y > settings.maxEntitySize)
+            {
+                continue;
+            }
+        }
+
+        Vector3 center = placement.bbox.GetCenter();
+        placement.point = Vector2(center.x, center.y);
+        gridMin.x = std::min(gridMin.x, placement.point.x);
+        gridMin.y = std::min(gridMin.y, placement.point.y);
+        gridMax.x = std::max(gridMax.x, placement.point.x);
+        gridMax.y = std::max(gridMax.y, placement.point.y);
+        placements.push_back(placement);
+    }
+
+    SectorsManifest result;
+    result.sectorSize = settings.sectorSize;
+    result.folder = manifestPath.GetDirectory();
+    if (!placements.empty())
+    {
+        result.origin.x = std::floor(gridMin.x / settings.sectorSize) * settings.sectorSize;
+        result.origin.y = std::floor(gridMin.y / settings.sectorSize) * settings.sectorSize;
+        result.columns = static_cast<int32>(std::floor((gridMax.x - result.origin.x) / settings.sectorSize)) + 1;
+        result.rows = static_cast<int32>(std::floor((gridMax.y - result.origin.y) / settings.sectorSize)) + 1;
+    }
+
+    Vector<Vector<Placement*>> cells(static_cast<size_t>(result.columns * result.rows));
+    for (Placement& placement : placements)
+    {
+        int32 x = 0;
+        int32 y = 0;
+        result.GetCellAt(placement.point, x, y);
+        x = Clamp(x, 0, result.columns - 1);
+        y = Clamp(y, 0, result.rows - 1);
+        cells[y * result.columns + x].push_back(&placement);
+    }
+
+    FileSystem* fs = GetEngineContext()->fileSystem;
+    fs->CreateDirectory(result.folder, true);
+
+    bool success = true;
+    for (int32 y = 0; y < result.rows; ++y)
+    {
+        for (int32 x = 0; x < result.columns; ++x)
+        {
+            const Vector<Placement*>& cell = cells[y * result.columns + x];
+            if (cell.empty())
+            {
+                continue;
+            }
+
+            SectorsManifest::Sector sector;
+            sector.x = x;
+            sector.y = y;
+            sector.sceneName = Format("%s_%d_%d.sc2", settings.sectorFilePrefix.c_str(), x, y);
+            sector.entitiesCount = static_cast<uint32>(cell.size());
+
+            RefPtr<Scene> sectorScene(new Scene());
+            for (Placement* placement : cell)
+            {
+                sector.bbox.AddAABBox(placement->bbox);
+                sectorScene->AddNode(placement->entity.Get());
+            }
+
+            FilePath scenePath = result.folder + sector.sceneName;
+            if (sectorScene->SaveScene(scenePath, settings.saveForGame) != SceneFileV2::ERROR_NO_ERROR)
+            {
+                Logger::Error("[SectorsPartitioner] Can't save sector %s", scenePath.GetStringValue().c_str());
+                success = false;
+            }
+            fs->GetFileSize(scenePath, sector.fileSize);
+            result.sectors.push_back(sector);
+        }
+    }
+
+    if (scene->GetChildrenCount() > 0)
+    {
+        result.baseSceneName = settings.baseSceneName;
+        FilePath basePath = result.GetBaseScenePath();
+        if (scene->SaveScene(basePath, settings.saveForGame) != SceneFileV2::ERROR_NO_ERROR)
+        {
+            Logger::Error("[SectorsPartitioner] Can't save base scene %s", basePath.GetStringValue().c_str());
+            success = false;
+        }
+    }
+
+    result.BuildLookup();
+    success = result.Save(manifestPath) && success;
+
+    if (manifest != nullptr)
+    {
+        *manifest = std::move(result);
+    }
+    return success;
+}
+} // namespace DAVA
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Base/BaseTypes.h"
+#include "FileSystem/FilePath.h"
+#include "Math/AABBox3.h"
+#include "Math/Rect.h"
+
+namespace DAVA
+{
+/**
+    Description of map, which was split into regular grid of sector scenes by SectorsPartitioner.
+    Sector scenes and base scene (entities that don't belong to any sector) are stored next to manifest file.
+    Grid lies in XY plane, sector (x, y) covers rectangle [origin + (x, y) * sectorSize, origin + (x + 1, y + 1) * sectorSize).
+*/
+class SectorsManifest
+{
+public:
+    struct Sector
+    {
+        int32 x = 0;
+        int32 y = 0;
+        String sceneName; //!< scene file name relative to manifest folder
+        AABBox3 bbox; //!< bounding box of sector content
+        uint64 fileSize = 0; //!< size of sector scene, used as estimation of memory sector takes when loaded
+        uint32 entitiesCount = 0; //!< count of top-level entities in sector
+    };
+
+    bool Load(const FilePath& manifestPath);
+    bool Save(const FilePath& manifestPath) const;
+
+    /** Returns sector at grid position or nullptr if sector is empty or position is out of grid. */
+    const Sector* GetSector(int32 x, int32 y) const;
+    /** Returns index of sector in `sectors` or -1. */
+    int32 GetSectorIndex(int32 x, int32 y) const;
+    /** Returns grid cell containing specified point, result may be out of grid. */
+    void GetCellAt(const Vector2& point, int32& x, int32& y) const;
+    Rect GetCellRect(int32 x, int32 y) const;
+
+    /** Rebuilds grid lookup, should be called after `sectors` or grid size were modified. */
+    void BuildLookup();
+
+    FilePath GetScenePath(const Sector& sector) const;
+    FilePath GetBaseScenePath() const;
+
+    Vector2 origin;
+    float32 sectorSize = 0.0f;
+    int32 columns = 0;
+    int32 rows = 0;
+    String baseSceneName; //!< empty if all entities were placed into sectors
+    Vector<Sector> sectors; //!< only non-empty sectors, sorted by (y, x)
+
+    FilePath folder; //!< folder with sector scenes
+
+private:
+    Vector<int32> cellToSector;
+};
+} // namespace DAVA
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Base/BaseTypes.h"
+#include "FileSystem/FilePath.h"
+
+namespace DAVA
+{
+class Scene;
+class SectorsManifest;
+
+/**
+    Splits map into regular grid of sector scenes, which can be streamed by SectorStreamingSystem.
+
+    Every top-level entity of scene is placed into sector containing center of its world bounding box
+    (or its translation, if entity has no geometry). Entities that are larger than `maxEntitySize` and global
+    entities (cameras, landscape, vegetation, directional and ambient lights) are left in base scene, which
+    should be loaded with usual `Scene::LoadScene` and stays resident.
+*/
+class SectorsPartitioner
+{
+public:
+    struct Settings
+    {
+        float32 sectorSize = 256.0f;
+        float32 maxEntitySize = 256.0f; //!< entities with larger horizontal extent stay in base scene
+        String sectorFilePrefix = "sector";
+        String baseSceneName = "base.sc2";
+        bool saveForGame = false;
+    };
+
+    /**
+        Moves top-level entities of `scene` into sector scenes and saves them next to `manifestPath` with manifest itself.
+        Entities left in `scene` are saved as base scene. Returns false if any file can't be written.
+    */
+    static bool Partition(Scene* scene, const FilePath& manifestPath, const Settings& settings, SectorsManifest* manifest = nullptr);
+};
+} // namespace DAVA
@@ -1,4 +1,5 @@
 #include "Scene3D/Systems/FoliageSystem.h"
+#include "Base/FrameAllocator.h"
 
 #include "Render/Highlevel/Landscape.h"
 #include "Render/Highlevel/Vegetation/VegetationRenderObject.h"
@@ -101,23 +102,19 @@ void FoliageSystem::ProcessVegetationRenderObject(VegetationRenderObject* vegeta
     Vector<AbstractQuadTreeNode<VegetationSpatialData>*>& visibleCells = vegetationRO->BuildVisibleCellList(camera);
     uint32 cellsCount = static_cast<uint32>(visibleCells.size());
 
-    Set<AbstractQuadTreeNode<VegetationSpatialData>*> updatableCells;
+    FrameVector<AbstractQuadTreeNode<VegetationSpatialData>*> updatableCells;
+    updatableCells.reserve(cellsCount);
     for (uint32 i = 0; i < cellsCount; ++i)
     {
         AbstractQuadTreeNode<VegetationSpatialData>* cell = visibleCells[i];
         if (cell->data.width <= MAX_ANIMATED_CELL_WIDTH)
         {
             bool isMinAnimatedLod = (MIN_ANIMATED_CELL_WIDTH == cell->data.width);
-            if (isMinAnimatedLod)
-            {
-                updatableCells.insert(cell->parent);
-            }
-            else
-            {
-                updatableCells.insert(cell);
-            }
+            updatableCells.push_back(isMinAnimatedLod ? cell->parent : cell);
         }
     }
+    std::sort(updatableCells.begin(), updatableCells.end());
+    updatableCells.erase(std::unique(updatableCells.begin(), updatableCells.end()), updatableCells.end());
 
     Vector4 layersAnimationSpring = vegetationRO->GetLayersAnimationSpring();
     const Vector4& layerAnimationDrag = vegetationRO->GetLayerAnimationDragCoefficient();
@@ -9,6 +9,7 @@
 #include "Scene3D/Components/SingleComponents/MotionSingleComponent.h"
 #include "Scene3D/Systems/EventSystem.h"
 #include "Scene3D/Systems/GlobalEventSystem.h"
+#include "Scene3D/Systems/SkeletonSystem.h"
 #include "Scene3D/SkeletonAnimation/MotionLayer.h"
 #include "Scene3D/SkeletonAnimation/SimpleMotion.h"
 
@@ -118,6 +119,10 @@ void MotionSystem::Process(float32 timeElapsed)
 
     motionSingleComponent->Clear();
 
+    SkeletonSystem* skeletonSystem = GetScene()->skeletonSystem;
+    if (skeletonSystem != nullptr)
+        skeletonSystem->UpdateAnimationLod();
+
     for (MotionComponent* component : activeComponents)
     {
         UpdateMotionLayers(component, timeElapsed);
@@ -132,14 +137,19 @@ void MotionSystem::UpdateMotionLayers(MotionComponent* motionComponent, float32
     if (skeleton != nullptr && (motionComponent->GetMotionLayersCount() != 0 || (motionComponent->simpleMotion != nullptr && motionComponent->simpleMotion->IsPlaying())))
     {
         dTime *= motionComponent->playbackRate;
-        SkeletonPose resultPose = skeleton->GetDefaultPose();
+
+        //motions are advanced every frame to keep markers and root motion, pose is evaluated only when skeleton is going to be updated
+        bool evaluatePose = skeleton->IsPoseUpdateRequired();
+        SkeletonPose resultPose;
+        if (evaluatePose)
+            resultPose = skeleton->GetDefaultPose();
 
         uint32 motionLayersCount = motionComponent->GetMotionLayersCount();
         for (uint32 l = 0; l < motionLayersCount; ++l)
         {
             MotionLayer* motionLayer = motionComponent->GetMotionLayer(l);
 
-            motionLayer->Update(dTime);
+            motionLayer->Update(dTime, evaluatePose);
 
             for (const auto& motionEnd : motionLayer->GetEndedMotions())
                 motionSingleComponent->animationEnd.insert(MotionSingleComponent::AnimationInfo(motionComponent, motionLayer->GetName(), motionEnd));
@@ -147,13 +157,18 @@ void MotionSystem::UpdateMotionLayers(MotionComponent* motionComponent, float32
             for (const auto& motionMarker : motionLayer->GetReachedMarkers())
                 motionSingleComponent->animationMarkerReached.insert(MotionSingleComponent::AnimationInfo(motionComponent, motionLayer->GetName(), motionMarker.first, motionMarker.second));
 
-            const SkeletonPose& pose = motionLayer->GetCurrentSkeletonPose();
             MotionLayer::eMotionBlend blendMode = motionLayer->GetBlendMode();
+            if (blendMode == MotionLayer::BLEND_OVERRIDE)
+                motionComponent->rootOffsetDelta = motionLayer->GetCurrentRootOffsetDelta();
+
+            if (!evaluatePose)
+                continue;
+
+            const SkeletonPose& pose = motionLayer->GetCurrentSkeletonPose();
             switch (blendMode)
             {
             case MotionLayer::BLEND_OVERRIDE:
                 resultPose.Override(pose);
-                motionComponent->rootOffsetDelta = motionLayer->GetCurrentRootOffsetDelta();
                 break;
             case MotionLayer::BLEND_ADD:
                 resultPose.Add(pose);
@@ -173,10 +188,12 @@ void MotionSystem::UpdateMotionLayers(MotionComponent* motionComponent, float32
             if (!simpleMotion->IsPlaying())
                 motionSingleComponent->simpleMotionFinished.emplace_back(motionComponent);
 
-            simpleMotion->EvaluatePose(&resultPose);
+            if (evaluatePose)
+                simpleMotion->EvaluatePose(&resultPose);
         }
 
-        skeleton->ApplyPose(resultPose);
+        if (evaluatePose)
+            skeleton->ApplyPose(resultPose);
     }
 }
 }
\ No newline at end of file
@@ -26,6 +26,9 @@ public:
     void ImmediateEvent(Component* component, uint32 event) override;
     void Process(float32 timeElapsed) override;
 
+    /** Return true if there are playing motions. */
+    bool HasActiveMotions() const;
+
 protected:
     void SetScene(Scene* scene) override;
 
@@ -36,4 +39,9 @@ private:
     MotionSingleComponent* motionSingleComponent = nullptr;
 };
 
+inline bool MotionSystem::HasActiveMotions() const
+{
+    return !activeComponents.empty();
+}
+
 } //ns
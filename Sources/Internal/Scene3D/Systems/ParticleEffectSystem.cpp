@@ -5,6 +5,7 @@
 #include "Math/MathConstants.h"
 #include "Scene3D/Components/ParticleEffectComponent.h"
 #include "Scene3D/Components/TransformComponent.h"
+#include "Particles/ParticleCollisionHeightField.h"
 #include "Particles/ParticleEmitter.h"
 #include "Particles/ParticlesRandom.h"
 #include "Particles/ParticleForces.h"
@@ -21,7 +22,11 @@
 #include "Debug/ProfilerCPU.h"
 #include "Debug/ProfilerMarkerNames.h"
 #include "Render/Renderer.h"
+#include "Render/Highlevel/Landscape.h"
+#include "Render/Highlevel/RenderBatch.h"
+#include "Render/Highlevel/RenderHierarchy.h"
 #include "Render/Highlevel/RenderPassNames.h"
+#include "Scene3D/Systems/LandscapeSystem.h"
 #include "Scene3D/Systems/QualitySettingsSystem.h"
 #include "Engine/Engine.h"
 #include "Engine/EngineContext.h"
@@ -375,6 +380,8 @@ void ParticleEffectSystem::ImmediateEvent(Component* component, uint32 event)
             AddToActive(effect);
         effect->state = ParticleEffectComponent::STATE_STARTING;
         effect->currRepeatsCont = 0;
+        effect->invisibleTime = 0.0f;
+        effect->pendingTime = 0.0f;
 
         ExtractGlobalForces(effect);
     }
@@ -405,10 +412,30 @@ void ParticleEffectSystem::Process(float32 timeElapsed)
     float32 speedMult = 1.0f + (perfSettings->GetPsPerformanceSpeedMult() - 1.0f) * (1 - currPSValue);
     float32 shortEffectTime = timeElapsed * speedMult;
 
+    // Visibility feedback is available only when scene was rendered since previous update.
+    visibilityStatistics = VisibilityStatistics();
+    bool hasVisibilityFeedback = false;
+    Scene* scene = GetScene();
+    if (visibilitySettings.enabled && !is2DMode && (scene != nullptr))
+    {
+        uint32 renderFrameIndex = scene->GetRenderSystem()->GetRenderFrameIndex();
+        hasVisibilityFeedback = (renderFrameIndex != 0) && (renderFrameIndex != lastRenderFrameIndex);
+        lastRenderFrameIndex = renderFrameIndex;
+    }
+
+    collisionLandscape = nullptr;
+    if (collisionSettings.enabled && !is2DMode && (scene != nullptr) && (scene->landscapeSystem != nullptr))
+    {
+        Vector<Landscape*> landscapes = scene->landscapeSystem->GetLandscapeObjects();
+        if (!landscapes.empty())
+            collisionLandscape = landscapes.front();
+    }
+
     size_t componentsCount = activeComponents.size();
     for (size_t i = 0; i < componentsCount; i++)
     {
         ParticleEffectComponent* effect = activeComponents[i];
+        effect->collisionEvents.clear();
         if (effect->activeLodLevel != effect->desiredLodLevel)
             UpdateActiveLod(effect);
         if (effect->state == ParticleEffectComponent::STATE_STARTING)
@@ -418,7 +445,12 @@ void ParticleEffectSystem::Process(float32 timeElapsed)
 
         if (effect->isPaused)
             continue;
-        UpdateEffect(effect, timeElapsed * effect->playbackSpeed, shortEffectTime * effect->playbackSpeed);
+
+        float32 deltaTime = timeElapsed * effect->playbackSpeed;
+        if (ThrottleInvisibleEffect(effect, timeElapsed, deltaTime, hasVisibilityFeedback))
+            continue;
+        UpdateEffect(effect, deltaTime, shortEffectTime * effect->playbackSpeed);
+        visibilityStatistics.updatedEffects++;
 
         bool effectEnded = effect->stopWhenEmpty ? effect->effectData.groups.empty() : (effect->time > effect->effectDuration);
         if (effectEnded)
@@ -449,13 +481,98 @@ void ParticleEffectSystem::Process(float32 timeElapsed)
         }
         else
         {
-            Scene* scene = GetScene();
             if (scene)
                 scene->GetRenderSystem()->MarkForUpdate(effect->effectRenderObject);
         }
     }
 }
 
+bool ParticleEffectSystem::IsVisibilityThrottlingAllowed(ParticleEffectComponent* effect) const
+{
+    if (!visibilitySettings.enabled || !effect->visibilityThrottling || (effect->state != ParticleEffectComponent::STATE_PLAYING))
+        return false;
+
+    // only infinitely looped effects, one-shot effects should keep exact timing
+    if ((effect->repeatsCount != 0) && (effect->repeatsCount != static_cast<uint32>(-1)))
+        return false;
+
+    for (const auto& instance : effect->emitterInstances)
+    {
+        if (instance->GetEmitter()->shortEffect)
+            return false;
+    }
+    return true;
+}
+
+bool ParticleEffectSystem::ThrottleInvisibleEffect(ParticleEffectComponent* effect, float32 timeElapsed, float32& deltaTime, bool hasVisibilityFeedback)
+{
+    if (!IsVisibilityThrottlingAllowed(effect))
+    {
+        effect->invisibleTime = 0.0f;
+    }
+    else if (hasVisibilityFeedback)
+    {
+        bool visible = (effect->effectRenderObject->GetLastVisibleFrame() == lastRenderFrameIndex);
+        effect->invisibleTime = visible ? 0.0f : effect->invisibleTime + timeElapsed;
+    }
+
+    if (effect->invisibleTime <= visibilitySettings.invisibleDelay)
+    {
+        if (effect->pendingTime > 0.0f)
+        {
+            CatchUpEffect(effect);
+        }
+        return false;
+    }
+
+    effect->pendingTime += deltaTime;
+    if (effect->invisibleTime > visibilitySettings.suspendDelay)
+    {
+        visibilityStatistics.suspendedEffects++;
+        return true;
+    }
+
+    visibilityStatistics.throttledEffects++;
+    if (effect->pendingTime < visibilitySettings.throttledUpdateInterval)
+        return true;
+
+    deltaTime = effect->pendingTime;
+    effect->pendingTime = 0.0f;
+    return false;
+}
+
+void ParticleEffectSystem::CatchUpEffect(ParticleEffectComponent* effect)
+{
+    float32 catchUpTime = effect->pendingTime;
+    effect->pendingTime = 0.0f;
+    visibilityStatistics.caughtUpEffects++;
+
+    if (catchUpTime > visibilitySettings.maxCatchUpTime)
+    {
+        // replaying the whole skipped time is too expensive, start loop again and warm it up instead
+        effect->ClearCurrentGroups();
+        RunEffect(effect);
+        catchUpTime = visibilitySettings.maxCatchUpTime;
+    }
+
+    float32 step = Max(visibilitySettings.catchUpStep, 0.01f);
+    while (catchUpTime > 0.0f)
+    {
+        float32 dt = Min(step, catchUpTime);
+        catchUpTime -= dt;
+        UpdateEffect(effect, dt, dt);
+
+        bool effectEnded = effect->stopWhenEmpty ? effect->effectData.groups.empty() : (effect->time > effect->effectDuration);
+        if (effectEnded)
+        {
+            effect->currRepeatsCont++;
+            if (effect->clearOnRestart)
+                effect->ClearCurrentGroups();
+            RunEffect(effect);
+        }
+    }
+}
+
 void ParticleEffectSystem::UpdateActiveLod(ParticleEffectComponent* effect)
 {
     DVASSERT(effect->activeLodLevel != effect->desiredLodLevel);
@@ -581,7 +698,7 @@ void ParticleEffectSystem::UpdateEffect(ParticleEffectComponent* effect, float32
                 for (uint32 i = 0; i < allForcesCount; ++i)
                 {
                     DAVA::ParticleForce* currForce = group.layer->GetParticleForces()[i];
-                    if (currForce->isGlobal)
+                    if (currForce->isGlobal || currForce->type == ParticleForce::eType::SCENE_COLLISION)
                         continue;
 
                     if (currForce->worldAlign)
@@ -604,6 +721,22 @@ void ParticleEffectSystem::UpdateEffect(ParticleEffectComponent* effect, float32
             }
         }
 
+        static Vector<ParticleForce*> sceneCollisionForces;
+        uint32 sceneCollisionForcesCount = 0;
+        const ParticleCollisionHeightField* collision = nullptr;
+        if (group.head && group.layer->GetSceneCollisionForcesCount() > 0 && collisionSettings.enabled && GetScene() != nullptr)
+        {
+            sceneCollisionForces.resize(group.layer->GetParticleForces().size());
+            for (ParticleForce* force : group.layer->GetParticleForces())
+            {
+                if (force->type == ParticleForce::eType::SCENE_COLLISION && force->isActive)
+                {
+                    sceneCollisionForces[sceneCollisionForcesCount++] = force;
+                    collision = PrepareCollisionHeightField(effect, force, worldTransformPtr->GetTranslationVector());
+                }
+            }
+        }
+
         Particle* current = group.head;
         Particle* prev = nullptr;
 
@@ -627,7 +760,10 @@ void ParticleEffectSystem::UpdateEffect(ParticleEffectComponent* effect, float32
 
             if (group.layer->type != ParticleLayer::TYPE_PARTICLE_STRIPE)
             {
+                Vector3 prevPosition = current->position;
                 UpdateRegularParticleData(effect, current, group, overLifeTime, simplifiedForcesCount, currSimplifiedForceValues, dt, bbox, effectAlignCurrForces, effectAlignForcesCount, worldAlignCurrForces, forcesCountWorldAlign, *worldTransformPtr, invWorld, currLoopTimeNormalized);
+                if (sceneCollisionForcesCount > 0)
+                    ResolveSceneCollisions(effect, group, current, prevPosition, sceneCollisionForces, sceneCollisionForcesCount, collision);
             }
 
             if (group.layer->type == ParticleLayer::TYPE_SUPEREMITTER_PARTICLES)
@@ -1038,6 +1174,93 @@ void ParticleEffectSystem::UpdateRegularParticleData(ParticleEffectComponent* ef
     }
 }
 
+const ParticleCollisionHeightField* ParticleEffectSystem::PrepareCollisionHeightField(ParticleEffectComponent* effect, const ParticleForce* force, const Vector3& effectPosition)
+{
+    if (effect->collisionHeightField.Get() == nullptr || effect->collisionCacheVersion != collisionCacheVersion)
+    {
+        effect->collisionHeightField = RefPtr<ParticleCollisionHeightField>(new ParticleCollisionHeightField());
+        effect->collisionCacheVersion = collisionCacheVersion;
+    }
+
+    ParticleCollisionHeightField* field = effect->collisionHeightField.Get();
+    if (force->collideWithLandscape)
+    {
+        if (collisionLandscape != nullptr)
+            field->SetLandscape(collisionLandscape->GetHeightmap(), collisionLandscape->GetBoundingBox());
+        else
+            field->SetLandscape(nullptr, AABBox3());
+    }
+
+    if (force->collideWithStaticGeometry)
+    {
+        // Grid is rebuilt when effect leaves its central part, so particles near effect always have geometry around.
+        const AABBox3& area = field->GetStaticArea();
+        float32 margin = force->collisionAreaSize * 0.25f;
+        bool isInsideArea = field->HasStaticArea()
+        && (effectPosition.x - area.min.x > margin) && (area.max.x - effectPosition.x > margin)
+        && (effectPosition.y - area.min.y > margin) && (area.max.y - effectPosition.y > margin);
+
+        if (!isInsideArea)
+        {
+            RenderHierarchy* hierarchy = GetScene()->GetRenderSystem()->GetRenderHierarchy();
+            const AABBox3& sceneBox = hierarchy->GetWorldBoundingBox();
+            float32 halfSize = Max(force->collisionAreaSize * 0.5f, force->collisionCellSize);
+            AABBox3 newArea(Vector3(effectPosition.x - halfSize, effectPosition.y - halfSize, sceneBox.min.z), Vector3(effectPosition.x + halfSize, effectPosition.y + halfSize, sceneBox.max.z));
+            field->ResetStaticGeometry(newArea, force->collisionCellSize);
+
+            static Vector<RenderObject*> objects;
+            objects.clear();
+            hierarchy->GetAllObjectsInBBox(newArea, objects);
+            for (RenderObject* object : objects)
+            {
+                if (object->GetType() != RenderObject::TYPE_MESH || object->GetWorldMatrixPtr() == nullptr)
+                    continue;
+
+                for (uint32 i = 0, count = object->GetRenderBatchCount(); i < count; ++i)
+                {
+                    int32 lodIndex, switchIndex;
+                    RenderBatch* batch = object->GetRenderBatch(i, lodIndex, switchIndex);
+                    if (lodIndex > 0 || switchIndex > 0 || batch->GetPolygonGroup() == nullptr)
+                        continue;
+                    field->AddStaticGeometry(batch->GetPolygonGroup(), *object->GetWorldMatrixPtr());
+                }
+            }
+        }
+    }
+
+    return field;
+}
+
+void ParticleEffectSystem::ResolveSceneCollisions(ParticleEffectComponent* effect, const ParticleGroup& group, Particle* particle, const Vector3& prevPosition, const Vector<ParticleForce*>& forces, uint32 forcesCount, const ParticleCollisionHeightField* collision)
+{
+    Vector3 offset = group.layer->GetInheritPosition() ? effect->effectData.infoSources[group.positionSource].position : Vector3::Zero;
+    Vector3 position = particle->position + offset;
+    Vector3 prevWorldPosition = prevPosition + offset;
+
+    for (uint32 i = 0; i < forcesCount; ++i)
+    {
+        float32 speed = particle->speed.Length();
+        Vector3 normal;
+        bool isImpact = ParticleForces::ApplySceneCollision(forces[i], collision, particle->speed, position, prevWorldPosition, particle, normal);
+        if (isImpact && effect->collisionEvents.size() < collisionSettings.maxEventsPerEffect)
+        {
+            ParticleCollisionEvent collisionEvent;
+            collisionEvent.position = position;
+            collisionEvent.normal = normal;
+            collisionEvent.speed = speed;
+            collisionEvent.layer = group.layer;
+            effect->collisionEvents.push_back(collisionEvent);
+        }
+    }
+
+    particle->position = position - offset;
+}
+
+void ParticleEffectSystem::InvalidateCollisionCache()
+{
+    ++collisionCacheVersion;
+}
+
 void ParticleEffectSystem::ApplyGlobalForces(Particle* particle, float32 dt, float32 overLife, float32 layerOverLife, Vector3 prevParticlePosition)
 {
     for (auto& forcePair : globalForces)
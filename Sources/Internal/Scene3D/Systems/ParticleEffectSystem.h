@@ -7,6 +7,7 @@
 namespace DAVA
 {
 class Component;
+class Landscape;
 class ParticleForce;
 
 class ParticleEffectSystem : public SceneSystem
@@ -58,6 +59,42 @@ public:
         }
     };
 
+    /**
+        Simulation of looped effects which were not rendered recently is throttled and later suspended.
+        When such effect becomes visible again, skipped time is simulated in `catchUpStep` steps or,
+        if more than `maxCatchUpTime` was skipped, effect loop is restarted and warmed up for `maxCatchUpTime`.
+        Effects with finite repeats count or short emitters are always simulated with exact timing.
+    */
+    struct VisibilitySettings
+    {
+        bool enabled = true;
+        float32 invisibleDelay = 0.5f; // invisible effects are updated each frame during this time
+        float32 throttledUpdateInterval = 0.25f;
+        float32 suspendDelay = 5.0f; // invisible effects aren't updated at all after this time
+        float32 maxCatchUpTime = 2.0f;
+        float32 catchUpStep = 0.1f;
+    };
+
+    /** Number of effects processed in each way during last Process call. */
+    struct VisibilityStatistics
+    {
+        uint32 updatedEffects = 0;
+        uint32 throttledEffects = 0;
+        uint32 suspendedEffects = 0;
+        uint32 caughtUpEffects = 0;
+    };
+
+    /**
+        Layer forces of SCENE_COLLISION type collide particles with scene landscape and, optionally, with coarse
+        height grid of static meshes around effect. The grid is built on first use and rebuilt when effect leaves
+        its central part or after InvalidateCollisionCache call.
+    */
+    struct CollisionSettings
+    {
+        bool enabled = true;
+        uint32 maxEventsPerEffect = 64;
+    };
+
     ParticleEffectSystem(Scene* scene, bool is2DMode = false);
 
     ~ParticleEffectSystem();
@@ -81,6 +118,18 @@ public:
 
     inline const Vector<std::pair<MaterialData, NMaterial*>>& GetMaterialInstances() const;
 
+    /** Return true if there are running effects. */
+    inline bool HasActiveEffects() const;
+
+    inline void SetVisibilitySettings(const VisibilitySettings& settings);
+    inline const VisibilitySettings& GetVisibilitySettings() const;
+    inline const VisibilityStatistics& GetVisibilityStatistics() const;
+
+    inline void SetCollisionSettings(const CollisionSettings& settings);
+    inline const CollisionSettings& GetCollisionSettings() const;
+    /** Drops static geometry collision grids of all effects, should be called when static geometry was changed. */
+    void InvalidateCollisionCache();
+
     void PrebuildMaterials(ParticleEffectComponent* component);
 
 protected:
@@ -102,7 +151,12 @@ private:
     void ApplyGlobalForces(Particle* particle, float32 dt, float32 overLife, float32 layerOverLife, Vector3 prevParticlePosition);
     void UpdateStripe(Particle* particle, ParticleEffectData& effectData, ParticleGroup& group, float32 dt, AABBox3& bbox, const Vector<Vector3>& currForceValues, int32 forcesCount, bool isActive);
     void SimulateEffect(ParticleEffectComponent* effect);
+    bool IsVisibilityThrottlingAllowed(ParticleEffectComponent* effect) const;
+    bool ThrottleInvisibleEffect(ParticleEffectComponent* effect, float32 timeElapsed, float32& deltaTime, bool hasVisibilityFeedback);
+    void CatchUpEffect(ParticleEffectComponent* effect);
     void FillEmitterRadiuses(const ParticleGroup& group, float32& radius, float32& innerRadius);
+    const ParticleCollisionHeightField* PrepareCollisionHeightField(ParticleEffectComponent* effect, const ParticleForce* force, const Vector3& effectPosition);
+    void ResolveSceneCollisions(ParticleEffectComponent* effect, const ParticleGroup& group, Particle* particle, const Vector3& prevPosition, const Vector<ParticleForce*>& forces, uint32 forcesCount, const ParticleCollisionHeightField* collision);
 
     Map<String, float32> globalExternalValues;
     Vector<ParticleEffectComponent*> activeComponents;
@@ -123,6 +177,14 @@ private: //materials stuff
 
     bool allowLodDegrade;
     bool is2DMode;
+
+    VisibilitySettings visibilitySettings;
+    VisibilityStatistics visibilityStatistics;
+    uint32 lastRenderFrameIndex = 0;
+
+    CollisionSettings collisionSettings;
+    Landscape* collisionLandscape = nullptr;
+    uint32 collisionCacheVersion = 1;
 };
 
 inline const Vector<std::pair<ParticleEffectSystem::MaterialData, NMaterial*>>& ParticleEffectSystem::GetMaterialInstances() const
@@ -139,4 +201,34 @@ inline bool ParticleEffectSystem::GetAllowLodDegrade() const
 {
     return allowLodDegrade;
 }
+
+inline bool ParticleEffectSystem::HasActiveEffects() const
+{
+    return !activeComponents.empty();
+}
+
+inline void ParticleEffectSystem::SetVisibilitySettings(const VisibilitySettings& settings)
+{
+    visibilitySettings = settings;
+}
+
+inline const ParticleEffectSystem::VisibilitySettings& ParticleEffectSystem::GetVisibilitySettings() const
+{
+    return visibilitySettings;
+}
+
+inline const ParticleEffectSystem::VisibilityStatistics& ParticleEffectSystem::GetVisibilityStatistics() const
+{
+    return visibilityStatistics;
+}
+
+inline void ParticleEffectSystem::SetCollisionSettings(const CollisionSettings& settings)
+{
+    collisionSettings = settings;
+}
+
+inline const ParticleEffectSystem::CollisionSettings& ParticleEffectSystem::GetCollisionSettings() const
+{
+    return collisionSettings;
+}
 };
\ No newline at end of file
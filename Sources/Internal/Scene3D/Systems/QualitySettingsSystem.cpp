@@ -7,6 +7,7 @@
 #include "FileSystem/YamlParser.h"
 #include "FileSystem/YamlNode.h"
 #include "Render/Highlevel/RenderObject.h"
+#include "Render/Texture.h"
 #include "Logger/Logger.h"
 #include "Engine/Engine.h"
 #include "Engine/EngineContext.h"
@@ -366,6 +367,11 @@ void QualitySettingsSystem::SetCurTextureQuality(const FastName& name)
     {
         if (textureQualities[i].name == name)
         {
+            if (curTextureQuality != static_cast<int32>(i))
+            {
+                // retained textures were loaded with previous quality
+                Texture::GetRetentionCache().Clear();
+            }
             curTextureQuality = static_cast<int32>(i);
             return;
         }
@@ -0,0 +1,495 @@
+#include "Scene3D/Systems/SectorStreamingSystem.h"
+
+#include "Concurrency/Atomic.h"
+#include "Concurrency/Thread.h"
+#include "Engine/Engine.h"
+#include "Job/JobManager.h"
+#include "Logger/Logger.h"
+#include "Render/Highlevel/Camera.h"
+#include "Scene3D/Entity.h"
+#include "Scene3D/Scene.h"
+#include "Time/SystemTimer.h"
+#include "Utils/StringFormat.h"
+
+#include <algorithm>
+
+namespace DAVA
+{
+struct SectorStreamingSystem::LoadRequest
+{
+    FilePath path;
+    RefPtr<Scene> scene;
+    bool success = false;
+    Atomic<bool> finished;
+};
+
+namespace SectorStreamingSystemDetails
+{
+float32 DistanceToRect(const Vector2& point, const Rect& rect)
+{
+    float32 dx = std::max(std::max(rect.x - point.x, point.x - (rect.x + rect.dx)), 0.0f);
+    float32 dy = std::max(std::max(rect.y - point.y, point.y - (rect.y + rect.dy)), 0.0f);
+    return std::sqrt(dx * dx + dy * dy);
+}
+}
+
+SectorStreamingSystem::SectorStreamingSystem(Scene* scene)
+    : SceneSystem(scene)
+{
+}
+
+SectorStreamingSystem::~SectorStreamingSystem()
+{
+    UnloadAll();
+
+    // Let worker jobs finish, so sector scenes are released on main thread
+    while (!cancelledRequests.empty())
+    {
+        Thread::Yield();
+        ReleaseCancelledRequests();
+    }
+}
+
+bool SectorStreamingSystem::SetManifest(const FilePath& manifestPath)
+{
+    UnloadAll();
+
+    slots.clear();
+    if (!manifest.Load(manifestPath))
+    {
+        manifest = SectorsManifest();
+        return false;
+    }
+
+    slots.resize(manifest.sectors.size());
+    return true;
+}
+
+void SectorStreamingSystem::SetSettings(const Settings& settings_)
+{
+    settings = settings_;
+    DVASSERT(settings.unloadRadius >= settings.loadRadius);
+}
+
+void SectorStreamingSystem::SetPointsOfInterest(const Vector<PointOfInterest>& points)
+{
+    pointsOfInterest = points;
+}
+
+SectorStreamingSystem::eSectorState SectorStreamingSystem::GetSectorState(int32 x, int32 y) const
+{
+    int32 index = manifest.GetSectorIndex(x, y);
+    return (index >= 0) ? slots[index].state : eSectorState::UNLOADED;
+}
+
+Entity* SectorStreamingSystem::GetSectorEntity(int32 x, int32 y) const
+{
+    int32 index = manifest.GetSectorIndex(x, y);
+    return (index >= 0) ? slots[index].root.Get() : nullptr;
+}
+
+bool SectorStreamingSystem::IsIdle() const
+{
+    if (!cancelledRequests.empty())
+    {
+        return false;
+    }
+
+    return std::all_of(activeSectors.begin(), activeSectors.end(), [this](int32 index) {
+        return slots[index].state == eSectorState::RESIDENT;
+    });
+}
+
+void SectorStreamingSystem::UnloadAll()
+{
+    for (int32 index : activeSectors)
+    {
+        SectorSlot& slot = slots[index];
+        if (slot.root && slot.root->GetParent() != nullptr)
+        {
+            slot.root->GetParent()->RemoveNode(slot.root.Get());
+        }
+        DropSector(index);
+    }
+    activeSectors.clear();
+    UpdateStatistics();
+}
+
+void SectorStreamingSystem::ResetPeakStatistics()
+{
+    statistics.peakResidentSectors = statistics.residentSectors;
+    statistics.peakResidentMemory = statistics.residentMemory;
+    statistics.maxFrameTimeUs = 0;
+}
+
+void SectorStreamingSystem::PrepareForRemove()
+{
+    UnloadAll();
+}
+
+void SectorStreamingSystem::Process(float32 timeElapsed)
+{
+    if (manifest.sectors.empty())
+    {
+        return;
+    }
+
+    int64 startTime = SystemTimer::GetUs();
+
+    ReleaseCancelledRequests();
+    UpdatePointsOfInterest();
+    CompleteLoads();
+    UnloadFarSectors();
+    StartLoads();
+    DoTimeSlicedWork(startTime + settings.frameBudgetUs);
+
+    activeSectors.erase(std::remove_if(activeSectors.begin(), activeSectors.end(), [this](int32 index) {
+                            return slots[index].state == eSectorState::UNLOADED;
+                        }),
+                        activeSectors.end());
+
+    statistics.lastFrameTimeUs = static_cast<uint32>(SystemTimer::GetUs() - startTime);
+    statistics.maxFrameTimeUs = std::max(statistics.maxFrameTimeUs, statistics.lastFrameTimeUs);
+    UpdateStatistics();
+}
+
+void SectorStreamingSystem::UpdatePointsOfInterest()
+{
+    currentPoints = pointsOfInterest;
+    if (currentPoints.empty())
+    {
+        Camera* camera = GetScene()->GetCurrentCamera();
+        if (camera != nullptr)
+        {
+            currentPoints.push_back({ camera->GetPosition(), camera->GetDirection() });
+        }
+    }
+}
+
+float32 SectorStreamingSystem::GetPriority(int32 sectorIndex, float32& distance) const
+{
+    const SectorsManifest::Sector& sector = manifest.sectors[sectorIndex];
+    Rect rect = manifest.GetCellRect(sector.x, sector.y);
+    Vector2 center = rect.GetCenter();
+
+    distance = std::numeric_limits<float32>::max();
+    float32 priority = std::numeric_limits<float32>::max();
+    for (const PointOfInterest& point : currentPoints)
+    {
+        Vector2 position(point.position.x, point.position.y);
+        float32 pointDistance = SectorStreamingSystemDetails::DistanceToRect(position, rect);
+        distance = std::min(distance, pointDistance);
+
+        // distance is scaled down for sectors in front of point and up for sectors behind it
+        float32 scale = 1.0f;
+        Vector2 direction(point.direction.x, point.direction.y);
+        Vector2 toSector = center - position;
+        if (pointDistance > 0.0f && direction.SquareLength() > EPSILON && toSector.SquareLength() > EPSILON)
+        {
+            direction.Normalize();
+            toSector.Normalize();
+            scale -= settings.viewDirectionWeight * direction.DotProduct(toSector);
+        }
+        priority = std::min(priority, pointDistance * scale);
+    }
+    return priority;
+}
+
+void SectorStreamingSystem::CompleteLoads()
+{
+    for (int32 index : activeSectors)
+    {
+        SectorSlot& slot = slots[index];
+        if (slot.state != eSectorState::LOADING || !slot.request->finished.Get())
+        {
+            continue;
+        }
+
+        if (slot.request->success)
+        {
+            slot.loadedScene = std::move(slot.request->scene);
+            slot.state = eSectorState::LOADED;
+        }
+        else
+        {
+            Logger::Error("[SectorStreamingSystem] Can't load sector %s", slot.request->path.GetStringValue().c_str());
+            slot.failed = true;
+            slot.state = eSectorState::UNLOADED;
+        }
+        slot.request.reset();
+    }
+}
+
+void SectorStreamingSystem::UnloadFarSectors()
+{
+    for (int32 index : activeSectors)
+    {
+        SectorSlot& slot = slots[index];
+        if (slot.state == eSectorState::UNLOADED || slot.state == eSectorState::UNLOADING)
+        {
+            continue;
+        }
+
+        float32 distance = 0.0f;
+        slot.priority = GetPriority(index, distance);
+        if (distance <= settings.unloadRadius)
+        {
+            continue;
+        }
+
+        if (slot.root)
+        {
+            // entities that were already moved into scene are removed in time-sliced steps
+            slot.request.reset();
+            slot.loadedScene = nullptr;
+            slot.state = eSectorState::UNLOADING;
+        }
+        else
+        {
+            DropSector(index);
+        }
+    }
+}
+
+void SectorStreamingSystem::StartLoads()
+{
+    uint32 loadsInProgress = static_cast<uint32>(cancelledRequests.size());
+    uint64 memory = 0;
+    for (int32 index : activeSectors)
+    {
+        loadsInProgress += (slots[index].state == eSectorState::LOADING) ? 1 : 0;
+        memory += (slots[index].state != eSectorState::UNLOADED) ? manifest.sectors[index].fileSize : 0;
+    }
+
+    if (loadsInProgress >= settings.maxConcurrentLoads)
+    {
+        return;
+    }
+
+    // only cells within load radius of points of interest are checked
+    candidates.clear();
+    for (const PointOfInterest& point : currentPoints)
+    {
+        int32 x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+        manifest.GetCellAt(Vector2(point.position.x - settings.loadRadius, point.position.y - settings.loadRadius), x0, y0);
+        manifest.GetCellAt(Vector2(point.position.x + settings.loadRadius, point.position.y + settings.loadRadius), x1, y1);
+        x0 = std::max(x0, 0);
+        y0 = std::max(y0, 0);
+        x1 = std::min(x1, manifest.columns - 1);
+        y1 = std::min(y1, manifest.rows - 1);
+
+        for (int32 y = y0; y <= y1; ++y)
+        {
+            for (int32 x = x0; x <= x1; ++x)
+            {
+                int32 index = manifest.GetSectorIndex(x, y);
+                if (index < 0 || slots[index].state != eSectorState::UNLOADED || slots[index].failed)
+                {
+                    continue;
+                }
+
+                float32 distance = 0.0f;
+                float32 priority = GetPriority(index, distance);
+                if (distance <= settings.loadRadius)
+                {
+                    candidates.emplace_back(priority, index);
+                }
+            }
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    for (const std::pair<float32, int32>& candidate : candidates)
+    {
+        if (loadsInProgress >= settings.maxConcurrentLoads)
+        {
+            break;
+        }
+
+        uint64 sectorMemory = manifest.sectors[candidate.second].fileSize;
+        if (settings.memoryBudget > 0 && memory + sectorMemory > settings.memoryBudget)
+        {
+            break;
+        }
+
+        slots[candidate.second].priority = candidate.first;
+        StartLoad(candidate.second);
+        memory += sectorMemory;
+        ++loadsInProgress;
+    }
+}
+
+void SectorStreamingSystem::StartLoad(int32 sectorIndex)
+{
+    SectorSlot& slot = slots[sectorIndex];
+    DVASSERT(slot.state == eSectorState::UNLOADED);
+
+    std::shared_ptr<LoadRequest> request = std::make_shared<LoadRequest>();
+    request->path = manifest.GetScenePath(manifest.sectors[sectorIndex]);
+
+    slot.request = request;
+    slot.state = eSectorState::LOADING;
+    if (std::find(activeSectors.begin(), activeSectors.end(), sectorIndex) == activeSectors.end())
+    {
+        activeSectors.push_back(sectorIndex);
+    }
+
+    auto load = [request]() {
+        {
+            RefPtr<Scene> scene(new Scene());
+            request->success = (scene->LoadScene(request->path) == SceneFileV2::ERROR_NO_ERROR);
+            request->scene = scene;
+        }
+        request->finished = true;
+    };
+
+    JobManager* jobManager = GetEngineContext()->jobManager;
+    if (jobManager != nullptr)
+    {
+        jobManager->CreateWorkerJob(load);
+    }
+    else
+    {
+        load();
+    }
+}
+
+void SectorStreamingSystem::DoTimeSlicedWork(int64 deadlineUs)
+{
+    // unloading goes first to free memory, then integration of nearest sectors
+    Vector<int32>& queue = workQueue;
+    queue.clear();
+    for (int32 index : activeSectors)
+    {
+        eSectorState state = slots[index].state;
+        if (state == eSectorState::UNLOADING || state == eSectorState::LOADED || state == eSectorState::INTEGRATING)
+        {
+            queue.push_back(index);
+        }
+    }
+
+    std::sort(queue.begin(), queue.end(), [this](int32 l, int32 r) {
+        bool lUnloading = (slots[l].state == eSectorState::UNLOADING);
+        bool rUnloading = (slots[r].state == eSectorState::UNLOADING);
+        if (lUnloading != rUnloading)
+        {
+            return lUnloading;
+        }
+        return slots[l].priority < slots[r].priority;
+    });
+
+    Scene* scene = GetScene();
+    for (int32 index : queue)
+    {
+        SectorSlot& slot = slots[index];
+        // each step moves single entity, at least one step is done every frame
+        while (slot.state != eSectorState::RESIDENT && slot.state != eSectorState::UNLOADED)
+        {
+            if (slot.state == eSectorState::UNLOADING)
+            {
+                int32 childrenCount = slot.root->GetChildrenCount();
+                if (childrenCount > 0)
+                {
+                    slot.root->RemoveNode(slot.root->GetChild(childrenCount - 1));
+                }
+                else
+                {
+                    scene->RemoveNode(slot.root.Get());
+                    DropSector(index);
+                    ++statistics.unloadsCount;
+                }
+            }
+            else if (slot.state == eSectorState::LOADED)
+            {
+                const SectorsManifest::Sector& sector = manifest.sectors[index];
+                slot.root.ConstructInplace();
+                slot.root->SetName(FastName(Format("sector_%d_%d", sector.x, sector.y)));
+                scene->AddNode(slot.root.Get());
+                slot.state = eSectorState::INTEGRATING;
+            }
+            else
+            {
+                int32 childrenCount = slot.loadedScene->GetChildrenCount();
+                if (childrenCount > 0)
+                {
+                    slot.root->AddNode(slot.loadedScene->GetChild(childrenCount - 1));
+                }
+                else
+                {
+                    slot.loadedScene = nullptr;
+                    slot.state = eSectorState::RESIDENT;
+                    ++statistics.loadsCount;
+                }
+            }
+
+            if (SystemTimer::GetUs() >= deadlineUs)
+            {
+                return;
+            }
+        }
+    }
+}
+
+void SectorStreamingSystem::DropSector(int32 sectorIndex)
+{
+    SectorSlot& slot = slots[sectorIndex];
+    if (slot.request)
+    {
+        cancelledRequests.push_back(slot.request);
+        slot.request.reset();
+    }
+
+    slot.loadedScene = nullptr;
+    slot.root = nullptr;
+    slot.state = eSectorState::UNLOADED;
+}
+
+void SectorStreamingSystem::ReleaseCancelledRequests()
+{
+    // scene is taken from request on main thread, as worker job may be the last owner of request
+    cancelledRequests.erase(std::remove_if(cancelledRequests.begin(), cancelledRequests.end(), [](const std::shared_ptr<LoadRequest>& request) {
+                                if (request->finished.Get())
+                                {
+                                    request->scene = nullptr;
+                                    return true;
+                                }
+                                return false;
+                            }),
+                            cancelledRequests.end());
+}
+
+void SectorStreamingSystem::UpdateStatistics()
+{
+    statistics.residentSectors = 0;
+    statistics.loadingSectors = static_cast<uint32>(cancelledRequests.size());
+    statistics.pendingSectors = 0;
+    statistics.residentMemory = 0;
+    for (int32 index : activeSectors)
+    {
+        eSectorState state = slots[index].state;
+        if (state == eSectorState::UNLOADED)
+        {
+            continue;
+        }
+
+        statistics.residentMemory += manifest.sectors[index].fileSize;
+        if (state == eSectorState::RESIDENT)
+        {
+            ++statistics.residentSectors;
+        }
+        else if (state == eSectorState::LOADING)
+        {
+            ++statistics.loadingSectors;
+        }
+        else
+        {
+            ++statistics.pendingSectors;
+        }
+    }
+
+    statistics.peakResidentSectors = std::max(statistics.peakResidentSectors, statistics.residentSectors);
+    statistics.peakResidentMemory = std::max(statistics.peakResidentMemory, statistics.residentMemory);
+}
+} // namespace DAVA
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "Base/BaseTypes.h"
+#include "Base/RefPtr.h"
+#include "Entity/SceneSystem.h"
+#include "FileSystem/FilePath.h"
+#include "Math/Vector.h"
+#include "Scene3D/Streaming/SectorsManifest.h"
+
+#include <memory>
+
+namespace DAVA
+{
+class Entity;
+class Scene;
+
+/**
+    \ingroup systems
+    \brief SectorStreamingSystem keeps loaded only sectors of map (see SectorsPartitioner) around points of interest.
+
+    Sectors closer than `loadRadius` to any point of interest are loaded asynchronously in worker jobs, nearest sectors
+    and sectors in front of point of interest go first. Loaded sectors are moved into live scene in time-sliced steps,
+    so main thread spends no more than `frameBudgetUs` per frame on it. Sectors farther than `unloadRadius` are removed
+    from scene the same way. Difference between radii prevents load/unload thrashing on sector borders.
+
+    System is optional, game adds it to scene with `Scene::SCENE_SYSTEM_REQUIRE_PROCESS` flag and empty component mask.
+    If no points of interest were set, current camera of scene is used.
+*/
+class SectorStreamingSystem final : public SceneSystem
+{
+public:
+    enum class eSectorState : uint8
+    {
+        UNLOADED,
+        LOADING, //!< sector scene is being loaded by worker job
+        LOADED, //!< sector scene is loaded and waits to be moved into scene
+        INTEGRATING, //!< sector entities are being moved into scene
+        RESIDENT, //!< all sector entities are in scene
+        UNLOADING //!< sector entities are being removed from scene
+    };
+
+    struct Settings
+    {
+        float32 loadRadius = 600.0f;
+        float32 unloadRadius = 800.0f;
+        float32 viewDirectionWeight = 0.5f; //!< [0..1], how much sectors behind point of interest are deprioritized
+        uint32 maxConcurrentLoads = 1; //!< scenes are loaded through shared resource caches, concurrent LoadScene calls are not guaranteed to be safe
+        uint64 memoryBudget = 0; //!< estimated memory of resident and loading sectors, 0 for unlimited
+        uint32 frameBudgetUs = 2000; //!< time spent on moving entities into/out of scene per frame
+    };
+
+    struct PointOfInterest
+    {
+        Vector3 position;
+        Vector3 direction; //!< zero vector if point has no preferred direction
+    };
+
+    struct Statistics
+    {
+        uint32 residentSectors = 0;
+        uint32 loadingSectors = 0;
+        uint32 pendingSectors = 0; //!< loaded, but not fully integrated or unloaded
+        uint32 peakResidentSectors = 0;
+        uint64 residentMemory = 0;
+        uint64 peakResidentMemory = 0;
+        uint32 lastFrameTimeUs = 0;
+        uint32 maxFrameTimeUs = 0;
+        uint32 loadsCount = 0;
+        uint32 unloadsCount = 0;
+    };
+
+    SectorStreamingSystem(Scene* scene);
+    ~SectorStreamingSystem() override;
+
+    /**
+        Unloads current sectors and starts streaming of map described by manifest.
+        Base scene is not loaded by system, it should be loaded by game.
+    */
+    bool SetManifest(const FilePath& manifestPath);
+    const SectorsManifest& GetManifest() const;
+
+    void SetSettings(const Settings& settings);
+    const Settings& GetSettings() const;
+
+    void SetPointsOfInterest(const Vector<PointOfInterest>& points);
+    const Vector<PointOfInterest>& GetPointsOfInterest() const;
+
+    eSectorState GetSectorState(int32 x, int32 y) const;
+    /** Returns entity sector content is attached to, or nullptr if sector isn't in scene. */
+    Entity* GetSectorEntity(int32 x, int32 y) const;
+
+    /** Returns true if there are no loads, integrations or unloads in progress. */
+    bool IsIdle() const;
+
+    /** Removes all sectors from scene immediately. */
+    void UnloadAll();
+
+    const Statistics& GetStatistics() const;
+    void ResetPeakStatistics();
+
+    void Process(float32 timeElapsed) override;
+    void PrepareForRemove() override;
+
+private:
+    struct LoadRequest;
+
+    struct SectorSlot
+    {
+        eSectorState state = eSectorState::UNLOADED;
+        RefPtr<Entity> root;
+        std::shared_ptr<LoadRequest> request;
+        RefPtr<Scene> loadedScene;
+        float32 priority = 0.0f;
+        bool failed = false;
+    };
+
+    void UpdatePointsOfInterest();
+    float32 GetPriority(int32 sectorIndex, float32& distance) const;
+    void CompleteLoads();
+    void UnloadFarSectors();
+    void StartLoads();
+    void StartLoad(int32 sectorIndex);
+    void DoTimeSlicedWork(int64 deadlineUs);
+    void DropSector(int32 sectorIndex);
+    void ReleaseCancelledRequests();
+    void UpdateStatistics();
+
+    Settings settings;
+    SectorsManifest manifest;
+    Vector<SectorSlot> slots;
+    Vector<int32> activeSectors; //!< sectors in any state except UNLOADED
+    Vector<std::shared_ptr<LoadRequest>> cancelledRequests; //!< loads of sectors that became unneeded before load finished
+    Vector<std::pair<float32, int32>> candidates;
+    Vector<int32> workQueue;
+    Vector<PointOfInterest> pointsOfInterest;
+    Vector<PointOfInterest> currentPoints;
+    Statistics statistics;
+};
+
+inline const SectorsManifest& SectorStreamingSystem::GetManifest() const
+{
+    return manifest;
+}
+
+inline const SectorStreamingSystem::Settings& SectorStreamingSystem::GetSettings() const
+{
+    return settings;
+}
+
+inline const Vector<SectorStreamingSystem::PointOfInterest>& SectorStreamingSystem::GetPointsOfInterest() const
+{
+    return pointsOfInterest;
+}
+
+inline const SectorStreamingSystem::Statistics& SectorStreamingSystem::GetStatistics() const
+{
+    return statistics;
+}
+} // namespace DAVA
@@ -3,6 +3,7 @@
 #include "Animation/AnimationTrack.h"
 #include "Debug/ProfilerCPU.h"
 #include "Debug/ProfilerMarkerNames.h"
+#include "Render/Highlevel/Camera.h"
 #include "Render/Highlevel/SkinnedMesh.h"
 #include "Scene3D/Entity.h"
 #include "Scene3D/Components/ComponentHelpers.h"
@@ -16,6 +17,23 @@
 
 namespace DAVA
 {
+namespace SkeletonSystemDetails
+{
+// Bounding sphere radius relative to the half of viewport width
+float32 GetScreenSize(const AABBox3& worldBox, Camera* camera)
+{
+    if (worldBox.IsEmpty() || camera->GetIsOrtho())
+        return 1.f;
+
+    float32 radius = (worldBox.max - worldBox.min).Length() * 0.5f;
+    float32 distance = (worldBox.GetCenter() - camera->GetPosition()).Length();
+    if (distance <= radius)
+        return 1.f;
+
+    return radius / (distance * camera->GetZoomFactor());
+}
+}
+
 SkeletonSystem::SkeletonSystem(Scene* scene)
     : SceneSystem(scene)
 {
@@ -34,6 +52,8 @@ void SkeletonSystem::AddEntity(Entity* entity)
     SkeletonComponent* component = GetSkeletonComponent(entity);
     DVASSERT(component);
 
+    component->lodPhase = lodNextPhase++;
+
     if (component->configUpdated)
         RebuildSkeleton(component);
 }
@@ -72,6 +92,8 @@ void SkeletonSystem::Process(float32 timeElapsed)
     UpdateTestSkeletons();
 #endif
 
+    UpdateAnimationLod();
+
     for (int32 i = 0, sz = static_cast<int32>(entities.size()); i < sz; ++i)
     {
         SkeletonComponent* component = GetSkeletonComponent(entities[i]);
@@ -83,18 +105,56 @@ void SkeletonSystem::Process(float32 timeElapsed)
                 RebuildSkeleton(GetSkeletonComponent(entities[i]));
             }
 
-            if (component->startJoint != SkeletonComponent::INVALID_JOINT_INDEX)
+            RenderObject* ro = GetRenderObject(entities[i]);
+            SkinnedMesh* skinnedMesh = (ro != nullptr && (RenderObject::TYPE_SKINNED_MESH == ro->GetType())) ? static_cast<SkinnedMesh*>(ro) : nullptr;
+
+            if (component->lodStopped)
+            {
+                ++animationLodStatistics.stoppedSkeletons;
+            }
+            else if (component->lodUpdatePose)
             {
-                UpdateJointTransforms(component);
-                RenderObject* ro = GetRenderObject(entities[i]);
-                if (ro != nullptr && (RenderObject::TYPE_SKINNED_MESH == ro->GetType()))
+                ++animationLodStatistics.updatedSkeletons;
+                if (component->startJoint != SkeletonComponent::INVALID_JOINT_INDEX)
                 {
-                    UpdateSkinnedMesh(component, static_cast<SkinnedMesh*>(ro));
+                    bool interpolate = component->lodInterpolate && (skinnedMesh != nullptr);
+                    if (interpolate)
+                    {
+                        //interpolation starts from the skinning shown now
+                        if (component->lodSkinningInterpolated)
+                            component->lodStartTransforms.swap(component->lodSkinningTransforms);
+                        else
+                            component->lodStartTransforms = component->finalTransforms;
+                    }
+
+                    UpdateJointTransforms(component);
+
+                    component->lodSkinningInterpolated = false;
+                    if (skinnedMesh != nullptr)
+                    {
+                        if (interpolate)
+                        {
+                            InterpolateSkinning(component);
+                        }
+                        UpdateSkinnedMesh(component, skinnedMesh);
+                    }
                 }
             }
+            else if (component->lodSkinningInterpolated && (skinnedMesh != nullptr))
+            {
+                ++animationLodStatistics.interpolatedSkeletons;
+                InterpolateSkinning(component);
+                skinnedMesh->UpdateJointTransforms(component->lodSkinningInterpolated ? component->lodSkinningTransforms : component->finalTransforms);
+            }
+            else
+            {
+                ++animationLodStatistics.skippedSkeletons;
+            }
         }
     }
 
+    animationLodUpdated = false;
+
     DrawSkeletons(GetScene()->renderSystem->GetDebugDrawer());
 }
 
@@ -142,11 +202,25 @@ void SkeletonSystem::UpdateJointTransforms(SkeletonComponent* skeleton)
     DVASSERT(!skeleton->configUpdated);
 
     uint32 count = skeleton->GetJointsCount();
+    uint32 maxJointDepth = skeleton->lodMaxJointDepth;
     for (uint32 currJoint = skeleton->startJoint; currJoint < count; ++currJoint)
     {
         uint32 parentJoint = skeleton->jointInfo[currJoint] & SkeletonComponent::INFO_PARENT_MASK;
         if ((skeleton->jointInfo[currJoint] & SkeletonComponent::FLAG_MARKED_FOR_UPDATED) || ((parentJoint != SkeletonComponent::INVALID_JOINT_INDEX) && (skeleton->jointInfo[parentJoint] & SkeletonComponent::FLAG_UPDATED_THIS_FRAME)))
         {
+            if (skeleton->jointDepth[currJoint] > maxJointDepth)
+            {
+                //reduced joint keeps bind pose relatively to its parent, so it has the same skinning transform
+                //object space transform and box are not updated until joint is evaluated again
+                skeleton->finalTransforms[currJoint] = skeleton->finalTransforms[parentJoint];
+
+                skeleton->jointInfo[currJoint] &= ~SkeletonComponent::FLAG_MARKED_FOR_UPDATED;
+                skeleton->jointInfo[currJoint] |= SkeletonComponent::FLAG_UPDATED_THIS_FRAME;
+                continue;
+            }
+
+            ++animationLodStatistics.updatedJoints;
+
             //calculate object space transforms
             if (parentJoint == SkeletonComponent::INVALID_JOINT_INDEX) //root
             {
@@ -197,12 +271,119 @@ void SkeletonSystem::UpdateSkinnedMesh(SkeletonComponent* skeleton, SkinnedMesh*
         }
     }
 
-    skinnedMeshObject->UpdateJointTransforms(skeleton->finalTransforms);
+    skinnedMeshObject->UpdateJointTransforms(skeleton->lodSkinningInterpolated ? skeleton->lodSkinningTransforms : skeleton->finalTransforms);
     skinnedMeshObject->SetBoundingBox(resBox); //TODO: *Skinning* decide on bbox calculation
 
     GetScene()->GetRenderSystem()->MarkForUpdate(skinnedMeshObject);
 }
 
+void SkeletonSystem::UpdateAnimationLod()
+{
+    if (animationLodUpdated)
+        return;
+
+    animationLodUpdated = true;
+    animationLodStatistics = AnimationLodStatistics();
+    ++lodFrameIndex;
+
+    // Visibility feedback is available only when scene was rendered since previous update.
+    Scene* scene = GetScene();
+    Camera* camera = scene->GetCurrentCamera();
+    uint32 renderFrameIndex = scene->GetRenderSystem()->GetRenderFrameIndex();
+    bool hasVisibilityFeedback = (renderFrameIndex != 0) && (renderFrameIndex != lastRenderFrameIndex);
+    lastRenderFrameIndex = renderFrameIndex;
+
+    for (Entity* entity : entities)
+    {
+        SkeletonComponent* component = GetSkeletonComponent(entity);
+        if (component != nullptr)
+        {
+            RenderObject* ro = GetRenderObject(entity);
+            SkinnedMesh* skinnedMesh = (ro != nullptr && (RenderObject::TYPE_SKINNED_MESH == ro->GetType())) ? static_cast<SkinnedMesh*>(ro) : nullptr;
+            UpdateSkeletonLod(component, skinnedMesh, camera, hasVisibilityFeedback);
+        }
+    }
+}
+
+void SkeletonSystem::UpdateSkeletonLod(SkeletonComponent* skeleton, SkinnedMesh* skinnedMesh, Camera* camera, bool hasVisibilityFeedback)
+{
+    uint32 updateInterval = 1;
+    uint32 maxJointDepth = SkeletonComponent::INVALID_JOINT_INDEX;
+    bool interpolate = false;
+    bool stop = false;
+
+    //skeletons without skinned mesh may drive attachments, so they are always updated
+    bool lodAllowed = animationLodSettings.enabled && skeleton->animationLodEnabled && !skeleton->configUpdated && (skinnedMesh != nullptr) && (camera != nullptr);
+    if (lodAllowed)
+    {
+        if (hasVisibilityFeedback)
+            skeleton->lodVisible = (skinnedMesh->GetLastVisibleFrame() == lastRenderFrameIndex);
+
+        stop = animationLodSettings.stopInvisible && !skeleton->lodVisible;
+
+        float32 screenSize = SkeletonSystemDetails::GetScreenSize(skinnedMesh->GetWorldBoundingBox(), camera);
+        while (updateInterval < animationLodSettings.maxUpdateInterval && screenSize * updateInterval < animationLodSettings.fullRateScreenSize)
+            updateInterval = Min(updateInterval * 2, animationLodSettings.maxUpdateInterval);
+
+        interpolate = animationLodSettings.interpolation && (updateInterval > 1) && (screenSize >= animationLodSettings.interpolationScreenSize);
+
+        if (screenSize < animationLodSettings.jointReductionScreenSize)
+            maxJointDepth = animationLodSettings.reducedJointDepth;
+    }
+    else
+    {
+        skeleton->lodVisible = true;
+    }
+
+    if (!skeleton->configUpdated && maxJointDepth > skeleton->lodMaxJointDepth)
+    {
+        //reduced joints should be evaluated again
+        for (uint32 j = 0, count = skeleton->GetJointsCount(); j < count; ++j)
+        {
+            if (skeleton->jointDepth[j] > skeleton->lodMaxJointDepth)
+                skeleton->SetJointUpdated(j);
+        }
+    }
+    skeleton->lodMaxJointDepth = maxJointDepth;
+
+    bool wasStopped = skeleton->lodStopped;
+    skeleton->lodStopped = stop;
+    if (stop)
+    {
+        skeleton->lodUpdatePose = false;
+        return;
+    }
+
+    //updates of skeletons with the same interval are spread over frames by phase,
+    //skeleton that was stopped or got closer is caught up immediately and without interpolation
+    bool scheduled = ((lodFrameIndex + skeleton->lodPhase) % updateInterval) == 0;
+    bool update = scheduled || wasStopped || (updateInterval < skeleton->lodUpdateInterval) || (skeleton->lodFramesSinceUpdate + 1 >= updateInterval);
+
+    skeleton->lodUpdateInterval = updateInterval;
+    skeleton->lodInterpolate = interpolate && !wasStopped;
+    skeleton->lodUpdatePose = update;
+    skeleton->lodFramesSinceUpdate = update ? 0 : skeleton->lodFramesSinceUpdate + 1;
+}
+
+void SkeletonSystem::InterpolateSkinning(SkeletonComponent* skeleton)
+{
+    uint32 frame = skeleton->lodFramesSinceUpdate + 1;
+    uint32 count = skeleton->GetJointsCount();
+    if (frame >= skeleton->lodUpdateInterval || uint32(skeleton->lodStartTransforms.size()) != count)
+    {
+        skeleton->lodSkinningInterpolated = false;
+        return;
+    }
+
+    float32 factor = float32(frame) / float32(skeleton->lodUpdateInterval);
+    skeleton->lodSkinningTransforms.resize(count);
+    for (uint32 j = 0; j < count; ++j)
+    {
+        skeleton->lodSkinningTransforms[j] = JointTransform::Lerp(skeleton->lodStartTransforms[j], skeleton->finalTransforms[j], factor);
+    }
+    skeleton->lodSkinningInterpolated = true;
+}
+
 void SkeletonSystem::RebuildSkeleton(SkeletonComponent* skeleton)
 {
     skeleton->configUpdated = false;
@@ -214,6 +395,10 @@ void SkeletonSystem::RebuildSkeleton(SkeletonComponent* skeleton)
     skeleton->finalTransforms.resize(jointsCount);
     skeleton->inverseBindTransforms.resize(jointsCount);
     skeleton->objectSpaceBoxes.resize(jointsCount);
+    skeleton->jointDepth.resize(jointsCount);
+    skeleton->lodStartTransforms.clear();
+    skeleton->lodSkinningInterpolated = false;
+    skeleton->lodMaxJointDepth = SkeletonComponent::INVALID_JOINT_INDEX;
 
     DVASSERT(skeleton->jointsArray.size() < SkeletonComponent::INFO_PARENT_MASK);
     for (uint32 i = 0, sz = static_cast<int32>(skeleton->jointsArray.size()); i < sz; ++i)
@@ -230,10 +415,12 @@ void SkeletonSystem::RebuildSkeleton(SkeletonComponent* skeleton)
         if (skeleton->jointsArray[i].parentIndex == SkeletonComponent::INVALID_JOINT_INDEX)
         {
             skeleton->objectSpaceTransforms[i] = localTransform;
+            skeleton->jointDepth[i] = 0;
         }
         else
         {
             skeleton->objectSpaceTransforms[i] = skeleton->objectSpaceTransforms[skeleton->jointsArray[i].parentIndex].AppendTransform(localTransform);
+            skeleton->jointDepth[i] = skeleton->jointDepth[skeleton->jointsArray[i].parentIndex] + 1;
         }
 
         skeleton->inverseBindTransforms[i].Construct(skeleton->jointsArray[i].bindTransformInv);
@@ -6,6 +6,7 @@
 
 namespace DAVA
 {
+class Camera;
 class Component;
 class SkeletonComponent;
 class SkinnedMesh;
@@ -14,6 +15,34 @@ class RenderHelper;
 class SkeletonSystem : public SceneSystem
 {
 public:
+    /**
+        Animation LOD: skinned skeletons are updated less often as their screen size decreases
+        and are not updated at all while not visible. Screen size is bounding sphere radius
+        relative to the half of viewport width.
+        Disabled by default, applied only to skeletons that opted in with `SkeletonComponent::SetAnimationLodEnabled`.
+    */
+    struct AnimationLodSettings
+    {
+        bool enabled = false;
+        bool stopInvisible = true; // skeletons not rendered last frame are not updated, caught up as soon as rendered again
+        bool interpolation = true; // interpolate skinning between pose updates
+        float32 fullRateScreenSize = 0.25f; // bigger skeletons are updated every frame
+        uint32 maxUpdateInterval = 8; // update interval is doubled every time screen size is halved, up to this value
+        float32 interpolationScreenSize = 0.06f; // smaller skeletons are not interpolated
+        float32 jointReductionScreenSize = 0.03f; // for smaller skeletons joints deeper than reducedJointDepth follow their parent
+        uint32 reducedJointDepth = 3;
+    };
+
+    /** Counters of the last frame. */
+    struct AnimationLodStatistics
+    {
+        uint32 updatedSkeletons = 0;
+        uint32 interpolatedSkeletons = 0;
+        uint32 skippedSkeletons = 0;
+        uint32 stoppedSkeletons = 0;
+        uint32 updatedJoints = 0;
+    };
+
     SkeletonSystem(Scene* scene);
     ~SkeletonSystem();
 
@@ -27,16 +56,50 @@ public:
     void UpdateSkinnedMesh(SkeletonComponent* skeleton, SkinnedMesh* skinnedMeshObject);
     void DrawSkeletons(RenderHelper* drawer);
 
+    /**
+        Decide which skeletons should be updated this frame. Done once per frame,
+        MotionSystem calls it before evaluating motions, Process calls it otherwise.
+    */
+    void UpdateAnimationLod();
+
+    void SetAnimationLodSettings(const AnimationLodSettings& settings);
+    const AnimationLodSettings& GetAnimationLodSettings() const;
+    const AnimationLodStatistics& GetAnimationLodStatistics() const;
+
 private:
     void UpdateJointTransforms(SkeletonComponent* skeleton);
+    void UpdateSkeletonLod(SkeletonComponent* skeleton, SkinnedMesh* skinnedMesh, Camera* camera, bool hasVisibilityFeedback);
+    void InterpolateSkinning(SkeletonComponent* skeleton);
 
     void RebuildSkeleton(SkeletonComponent* skeleton);
 
     void UpdateTestSkeletons(float32 timeElapsed);
 
     Vector<Entity*> entities;
+
+    AnimationLodSettings animationLodSettings;
+    AnimationLodStatistics animationLodStatistics;
+    uint32 lodFrameIndex = 0;
+    uint32 lodNextPhase = 0;
+    uint32 lastRenderFrameIndex = 0;
+    bool animationLodUpdated = false;
 };
 
+inline void SkeletonSystem::SetAnimationLodSettings(const AnimationLodSettings& settings)
+{
+    animationLodSettings = settings;
+}
+
+inline const SkeletonSystem::AnimationLodSettings& SkeletonSystem::GetAnimationLodSettings() const
+{
+    return animationLodSettings;
+}
+
+inline const SkeletonSystem::AnimationLodStatistics& SkeletonSystem::GetAnimationLodStatistics() const
+{
+    return animationLodStatistics;
+}
+
 } //ns
 
 #endif
@@ -0,0 +1,260 @@
+#include "UnitTests/UnitTests.h"
+
+#include "Base/Message.h"
+#include "Base/RefPtr.h"
+#include "Base/ScopedPtr.h"
+#include "Logger/Logger.h"
+#include "Math/MathConstants.h"
+#include "Particles/ParticleEmitter.h"
+#include "Particles/ParticleLayer.h"
+#include "Particles/ParticlePropertyLine.h"
+#include "Particles/ParticleRenderObject.h"
+#include "Render/Highlevel/Camera.h"
+#include "Render/Highlevel/RenderSystem.h"
+#include "Scene3D/Components/ComponentHelpers.h"
+#include "Scene3D/Components/ParticleEffectComponent.h"
+#include "Scene3D/Components/TransformComponent.h"
+#include "Scene3D/Entity.h"
+#include "Scene3D/Scene.h"
+#include "Scene3D/Systems/ParticleEffectSystem.h"
+#include "Time/SystemTimer.h"
+
+using namespace DAVA;
+
+namespace ParticleEffectVisibilityTestDetails
+{
+const float32 frameTime = 1.0f / 60.0f;
+
+ParticleEmitter* CreateEmitter(float32 layerDuration)
+{
+    ScopedPtr<ParticleLayer> layer(new ParticleLayer());
+    layer->startTime = 0.0f;
+    layer->endTime = layerDuration;
+    layer->life = RefPtr<PropertyLine<float32>>(new PropertyLineValue<float32>(0.5f));
+    layer->number = RefPtr<PropertyLine<float32>>(new PropertyLineValue<float32>(40.0f));
+
+    ParticleEmitter* emitter = new ParticleEmitter();
+    emitter->AddLayer(layer);
+    return emitter;
+}
+
+ParticleEffectComponent* AddEffect(Scene* scene, ParticleEmitter* emitter, const Vector3& position)
+{
+    ScopedPtr<Entity> entity(new Entity());
+    GetTransformComponent(entity)->SetLocalTranslation(position);
+
+    ParticleEffectComponent* effect = new ParticleEffectComponent();
+    effect->AddEmitterInstance(emitter);
+    entity->AddComponent(effect);
+    scene->AddNode(entity);
+    effect->Start();
+    return effect;
+}
+
+Camera* CreateCamera(Scene* scene, const Vector3& target)
+{
+    Camera* camera = new Camera();
+    camera->SetupPerspective(70.0f, 1.0f, 1.0f, 500.0f);
+    camera->SetUp(Vector3(0.0f, 0.0f, 1.0f));
+    camera->SetPosition(Vector3(0.0f, 0.0f, 0.0f));
+    camera->SetTarget(target);
+    scene->AddCamera(camera);
+    scene->SetCurrentCamera(camera);
+    return camera;
+}
+
+// Returns time spent in scene update, us
+int64 RunFrames(Scene* scene, uint32 framesCount)
+{
+    int64 updateTime = 0;
+    for (uint32 i = 0; i < framesCount; ++i)
+    {
+        int64 startTime = SystemTimer::GetUs();
+        scene->Update(frameTime);
+        updateTime += SystemTimer::GetUs() - startTime;
+        scene->Draw();
+    }
+    return updateTime;
+}
+
+struct EffectEvent
+{
+    enum eType
+    {
+        STARTED,
+        REPEATED,
+        STOPPED,
+        COMPLETED // playback complete message
+    };
+
+    uint32 frame;
+    eType type;
+
+    bool operator==(const EffectEvent& other) const
+    {
+        return frame == other.frame && type == other.type;
+    }
+};
+
+void OnPlaybackComplete(BaseObject* caller, void* userData, void* callerData)
+{
+    ++(*static_cast<uint32*>(userData));
+}
+
+// Returns events of one-shot effect played next to throttled looped effect, in order of occurrence
+Vector<EffectEvent> PlayOneShotEffect(bool throttlingEnabled, int32 repeatsCount)
+{
+    ScopedPtr<Scene> scene(new Scene());
+    ParticleEffectSystem::VisibilitySettings settings;
+    settings.enabled = throttlingEnabled;
+    scene->particleEffectSystem->SetVisibilitySettings(settings);
+    ScopedPtr<Camera> camera(CreateCamera(scene, Vector3(1.0f, 0.0f, 0.0f)));
+
+    uint32 completeMessages = 0;
+
+    ScopedPtr<ParticleEmitter> emitter(CreateEmitter(1.5f));
+    // one-shot effect behind the camera
+    ParticleEffectComponent* effect = AddEffect(scene, emitter, Vector3(-50.0f, 0.0f, 0.0f));
+    effect->StopWhenEmpty(true);
+    effect->StopAfterNRepeats(repeatsCount);
+    effect->SetPlaybackCompleteMessage(Message(&OnPlaybackComplete, &completeMessages));
+
+    // looped effect behind the camera should be throttled meanwhile
+    ScopedPtr<ParticleEmitter> loopedEmitter(CreateEmitter(100.0f));
+    AddEffect(scene, loopedEmitter, Vector3(-50.0f, 10.0f, 0.0f));
+
+    const uint32 maxFrames = 60 * 20;
+    uint32 throttledFrames = 0;
+    Vector<EffectEvent> events;
+    ParticleEffectComponent::eState state = effect->GetAnimationState();
+    float32 time = effect->GetCurrTime();
+    for (uint32 frame = 0; frame < maxFrames && state != ParticleEffectComponent::STATE_STOPPED; ++frame)
+    {
+        uint32 prevCompleteMessages = completeMessages;
+        RunFrames(scene, 1);
+        const ParticleEffectSystem::VisibilityStatistics& stats = scene->particleEffectSystem->GetVisibilityStatistics();
+        throttledFrames += stats.throttledEffects + stats.suspendedEffects;
+
+        ParticleEffectComponent::eState newState = effect->GetAnimationState();
+        float32 newTime = effect->GetCurrTime();
+        if (state == ParticleEffectComponent::STATE_STARTING && newState != ParticleEffectComponent::STATE_STARTING)
+        {
+            events.push_back({ frame, EffectEvent::STARTED });
+        }
+        else if (state == ParticleEffectComponent::STATE_PLAYING && newState == ParticleEffectComponent::STATE_PLAYING && newTime < time)
+        {
+            // restart resets effect time
+            events.push_back({ frame, EffectEvent::REPEATED });
+        }
+
+        if (newState == ParticleEffectComponent::STATE_STOPPED)
+        {
+            events.push_back({ frame, EffectEvent::STOPPED });
+        }
+
+        for (uint32 i = prevCompleteMessages; i < completeMessages; ++i)
+        {
+            events.push_back({ frame, EffectEvent::COMPLETED });
+        }
+
+        state = newState;
+        time = newTime;
+    }
+
+    TEST_VERIFY(effect->IsStopped());
+    TEST_VERIFY(throttlingEnabled == (throttledFrames > 0));
+    return events;
+}
+}
+
+DAVA_TESTCLASS (ParticleEffectVisibilityTest)
+{
+    DAVA_TEST (OneShotTimingTest)
+    {
+        using namespace ParticleEffectVisibilityTestDetails;
+
+        // single shot and several repeats, effect ends when its particles are gone
+        for (int32 repeatsCount : { 1, 3 })
+        {
+            Vector<EffectEvent> eventsThrottled = PlayOneShotEffect(true, repeatsCount);
+            Vector<EffectEvent> eventsExact = PlayOneShotEffect(false, repeatsCount);
+
+            // events happen in the same frames and order with and without throttling
+            TEST_VERIFY(eventsThrottled == eventsExact);
+
+            TEST_VERIFY(eventsExact.size() == static_cast<size_t>(repeatsCount) + 2);
+            if (eventsExact.size() == static_cast<size_t>(repeatsCount) + 2)
+            {
+                TEST_VERIFY(eventsExact.front().type == EffectEvent::STARTED);
+                for (int32 i = 1; i < repeatsCount; ++i)
+                {
+                    TEST_VERIFY(eventsExact[i].type == EffectEvent::REPEATED);
+                }
+                TEST_VERIFY(eventsExact[repeatsCount].type == EffectEvent::STOPPED);
+                TEST_VERIFY(eventsExact.back().type == EffectEvent::COMPLETED);
+            }
+        }
+    }
+
+    DAVA_TEST (CatchUpTest)
+    {
+        using namespace ParticleEffectVisibilityTestDetails;
+
+        ScopedPtr<Scene> scene(new Scene());
+        ScopedPtr<Camera> camera(CreateCamera(scene, Vector3(1.0f, 0.0f, 0.0f)));
+        ScopedPtr<ParticleEmitter> emitter(CreateEmitter(100.0f));
+        ParticleEffectComponent* effect = AddEffect(scene, emitter, Vector3(-50.0f, 0.0f, 0.0f));
+
+        const ParticleEffectSystem::VisibilitySettings& settings = scene->particleEffectSystem->GetVisibilitySettings();
+        RunFrames(scene, static_cast<uint32>((settings.suspendDelay + 1.0f) / frameTime));
+        TEST_VERIFY(scene->particleEffectSystem->GetVisibilityStatistics().suspendedEffects == 1);
+        float32 suspendedTime = effect->GetCurrTime();
+
+        // turn to the effect: next update should simulate skipped time
+        camera->SetTarget(Vector3(-1.0f, 0.0f, 0.0f));
+        RunFrames(scene, 2);
+        const ParticleEffectSystem::VisibilityStatistics& stats = scene->particleEffectSystem->GetVisibilityStatistics();
+        TEST_VERIFY(stats.suspendedEffects == 0 && stats.throttledEffects == 0);
+        TEST_VERIFY(effect->GetCurrTime() > suspendedTime);
+        TEST_VERIFY(effect->GetActiveParticlesCount() > 0);
+    }
+
+    DAVA_TEST (InvisibleEffectsBenchmark)
+    {
+        using namespace ParticleEffectVisibilityTestDetails;
+
+        const uint32 effectsCount = 300;
+        const uint32 framesCount = 60 * 10;
+        const float32 radius = 100.0f;
+
+        int64 updateTime[2] = {};
+        uint32 updatedEffects[2] = {};
+        for (uint32 pass = 0; pass < 2; ++pass)
+        {
+            bool throttlingEnabled = (pass == 1);
+            ScopedPtr<Scene> scene(new Scene());
+            ParticleEffectSystem::VisibilitySettings settings;
+            settings.enabled = throttlingEnabled;
+            scene->particleEffectSystem->SetVisibilitySettings(settings);
+            // 70 degrees of horizontal field of view, so about 20% of effects placed around camera are visible
+            ScopedPtr<Camera> camera(CreateCamera(scene, Vector3(1.0f, 0.0f, 0.0f)));
+
+            ScopedPtr<ParticleEmitter> emitter(CreateEmitter(100.0f));
+            for (uint32 i = 0; i < effectsCount; ++i)
+            {
+                float32 angle = PI_2 * i / effectsCount;
+                AddEffect(scene, emitter, Vector3(std::cos(angle) * radius, std::sin(angle) * radius, 0.0f));
+            }
+
+            updateTime[pass] = RunFrames(scene, framesCount);
+            updatedEffects[pass] = scene->particleEffectSystem->GetVisibilityStatistics().updatedEffects;
+        }
+
+        TEST_VERIFY(updatedEffects[0] == effectsCount);
+        TEST_VERIFY(updatedEffects[1] < effectsCount / 4);
+
+        Logger::Info("Particle visibility benchmark (%u effects, %u frames): scene update %lld us without throttling, %lld us with throttling; "
+                     "%u effects updated per frame with throttling",
+                     effectsCount, framesCount, updateTime[0], updateTime[1], updatedEffects[1]);
+    }
+};
@@ -0,0 +1,325 @@
+#include "UnitTests/UnitTests.h"
+
+#include "Base/RefPtr.h"
+#include "Base/ScopedPtr.h"
+#include "Logger/Logger.h"
+#include "Particles/Particle.h"
+#include "Particles/ParticleCollisionHeightField.h"
+#include "Particles/ParticleForce.h"
+#include "Particles/ParticleForces.h"
+#include "Render/Highlevel/Heightmap.h"
+#include "Time/SystemTimer.h"
+
+#include <random>
+
+using namespace DAVA;
+
+namespace ParticleSceneCollisionTestDetails
+{
+const float32 frameTime = 1.0f / 60.0f;
+const Vector3 gravity(0.0f, 0.0f, -9.8f);
+
+// Hills of up to 10 units over 200x200 area centered at origin
+Heightmap* CreateHills(int32 size)
+{
+    Heightmap* heightmap = new Heightmap(size);
+    uint16* data = heightmap->Data();
+    for (int32 y = 0; y < size; ++y)
+    {
+        for (int32 x = 0; x < size; ++x)
+        {
+            float32 h = 0.5f + 0.25f * std::sin(x * 0.1f) + 0.25f * std::cos(y * 0.07f);
+            data[x + y * size] = static_cast<uint16>(h * Heightmap::MAX_VALUE);
+        }
+    }
+    return heightmap;
+}
+
+Heightmap* CreateFlat(int32 size, float32 level)
+{
+    Heightmap* heightmap = new Heightmap(size);
+    uint16* data = heightmap->Data();
+    std::fill(data, data + size * size, static_cast<uint16>(level * Heightmap::MAX_VALUE));
+    return heightmap;
+}
+
+ParticleForce* CreateCollisionForce(ParticleForce::eCollisionResponse response)
+{
+    ParticleForce* force = new ParticleForce(nullptr);
+    force->type = ParticleForce::eType::SCENE_COLLISION;
+    force->collisionResponse = response;
+    force->collisionBounciness = 0.5f;
+    force->collisionFriction = 0.0f;
+    return force;
+}
+
+// Integrates particle the same way as ParticleEffectSystem: move, apply gravity, resolve collision.
+bool Step(Particle& particle, const ParticleForce* force, const ParticleCollisionHeightField* field, Vector3& hitNormal)
+{
+    Vector3 prevPosition = particle.position;
+    particle.position += particle.speed * frameTime;
+    particle.speed += gravity * frameTime;
+    particle.life += frameTime;
+    return ParticleForces::ApplySceneCollision(force, field, particle.speed, particle.position, prevPosition, &particle, hitNormal);
+}
+}
+
+DAVA_TESTCLASS (ParticleSceneCollisionTest)
+{
+    DAVA_TEST (LandscapeSamplingTest)
+    {
+        using namespace ParticleSceneCollisionTestDetails;
+
+        // heights grow along x from 0 to 255/256 * 100 over 100 units, so slope is about 1
+        const int32 size = 256;
+        ScopedPtr<Heightmap> heightmap(new Heightmap(size));
+        for (int32 y = 0; y < size; ++y)
+        {
+            for (int32 x = 0; x < size; ++x)
+            {
+                heightmap->Data()[x + y * size] = static_cast<uint16>(x * 256);
+            }
+        }
+
+        ScopedPtr<ParticleCollisionHeightField> field(new ParticleCollisionHeightField());
+        AABBox3 bbox(Vector3(0.0f, 0.0f, 0.0f), Vector3(100.0f, 100.0f, 100.0f * 65535.0f / 65536.0f));
+        field->SetLandscape(heightmap, bbox);
+
+        float32 height = 0.0f;
+        Vector3 normal;
+        TEST_VERIFY(field->GetLandscapeHeight(50.2f, 30.0f, height, &normal));
+        TEST_VERIFY(FLOAT_EQUAL_EPS(height, 50.2f, 0.05f));
+        TEST_VERIFY(FLOAT_EQUAL_EPS(normal.x, -std::sqrt(0.5f), 0.01f));
+        TEST_VERIFY(FLOAT_EQUAL_EPS(normal.y, 0.0f, 0.01f));
+        TEST_VERIFY(!field->GetLandscapeHeight(-1.0f, 30.0f, height));
+    }
+
+    DAVA_TEST (BounceTest)
+    {
+        using namespace ParticleSceneCollisionTestDetails;
+
+        ScopedPtr<Heightmap> heightmap(CreateFlat(64, 0.0f));
+        ScopedPtr<ParticleCollisionHeightField> field(new ParticleCollisionHeightField());
+        field->SetLandscape(heightmap, AABBox3(Vector3(-50.0f, -50.0f, 0.0f), Vector3(50.0f, 50.0f, 10.0f)));
+        ScopedPtr<ParticleForce> force(CreateCollisionForce(ParticleForce::eCollisionResponse::BOUNCE));
+
+        Particle particle;
+        particle.lifeTime = 100.0f;
+        particle.position = Vector3(0.0f, 0.0f, 5.0f);
+        particle.speed = Vector3(2.0f, 0.0f, 0.0f);
+
+        uint32 impacts = 0;
+        float32 maxHeightAfterBounce = 0.0f;
+        for (uint32 frame = 0; frame < 180; ++frame)
+        {
+            Vector3 normal;
+            float32 incomingSpeed = -particle.speed.z - gravity.z * frameTime;
+            if (Step(particle, force, field, normal))
+            {
+                ++impacts;
+                TEST_VERIFY(FLOAT_EQUAL_EPS(normal.z, 1.0f, 0.001f));
+                if (impacts == 1)
+                {
+                    // normal speed is halved and reverted, tangential speed is kept without friction
+                    TEST_VERIFY(FLOAT_EQUAL_EPS(particle.speed.z, incomingSpeed * 0.5f, 0.5f));
+                    TEST_VERIFY(FLOAT_EQUAL_EPS(particle.speed.x, 2.0f, 0.001f));
+                }
+            }
+            TEST_VERIFY(particle.position.z >= 0.0f);
+            if (impacts == 1)
+                maxHeightAfterBounce = std::max(maxHeightAfterBounce, particle.position.z);
+        }
+
+        // energy is lost on each bounce: particle rises to about quarter of initial height
+        TEST_VERIFY(impacts >= 2);
+        TEST_VERIFY(maxHeightAfterBounce > 0.5f && maxHeightAfterBounce < 2.5f);
+        TEST_VERIFY(particle.life < particle.lifeTime);
+    }
+
+    DAVA_TEST (KillAndStickTest)
+    {
+        using namespace ParticleSceneCollisionTestDetails;
+
+        ScopedPtr<Heightmap> heightmap(CreateFlat(64, 0.5f));
+        ScopedPtr<ParticleCollisionHeightField> field(new ParticleCollisionHeightField());
+        field->SetLandscape(heightmap, AABBox3(Vector3(-50.0f, -50.0f, 0.0f), Vector3(50.0f, 50.0f, 10.0f)));
+
+        for (ParticleForce::eCollisionResponse response : { ParticleForce::eCollisionResponse::KILL, ParticleForce::eCollisionResponse::STICK })
+        {
+            ScopedPtr<ParticleForce> force(CreateCollisionForce(response));
+
+            Particle particle;
+            particle.lifeTime = 100.0f;
+            particle.position = Vector3(10.0f, -10.0f, 8.0f);
+
+            uint32 impacts = 0;
+            for (uint32 frame = 0; frame < 120 && particle.life < particle.lifeTime; ++frame)
+            {
+                Vector3 normal;
+                impacts += Step(particle, force, field, normal) ? 1 : 0;
+            }
+
+            TEST_VERIFY(impacts == 1);
+            TEST_VERIFY(FLOAT_EQUAL_EPS(particle.position.z, 5.0f, 0.01f));
+            if (response == ParticleForce::eCollisionResponse::KILL)
+            {
+                TEST_VERIFY(particle.life > particle.lifeTime);
+            }
+            else
+            {
+                TEST_VERIFY(particle.life < particle.lifeTime);
+            }
+        }
+    }
+
+    DAVA_TEST (StaticGeometryTest)
+    {
+        using namespace ParticleSceneCollisionTestDetails;
+
+        ScopedPtr<Heightmap> heightmap(CreateFlat(64, 0.0f));
+        ScopedPtr<ParticleCollisionHeightField> field(new ParticleCollisionHeightField());
+        field->SetLandscape(heightmap, AABBox3(Vector3(-50.0f, -50.0f, 0.0f), Vector3(50.0f, 50.0f, 10.0f)));
+        field->ResetStaticGeometry(AABBox3(Vector3(-10.0f, -10.0f, 0.0f), Vector3(10.0f, 10.0f, 10.0f)), 0.5f);
+        field->AddStaticBox(AABBox3(Vector3(2.0f, -2.0f, 0.0f), Vector3(4.0f, 2.0f, 3.0f)));
+        TEST_VERIFY(field->HasStaticGeometry());
+
+        ScopedPtr<ParticleForce> force(CreateCollisionForce(ParticleForce::eCollisionResponse::BOUNCE));
+        force->collideWithStaticGeometry = true;
+
+        // falls onto the roof
+        Particle particle;
+        particle.lifeTime = 100.0f;
+        particle.position = Vector3(3.0f, 0.0f, 6.0f);
+        bool hitRoof = false;
+        for (uint32 frame = 0; frame < 60 && !hitRoof; ++frame)
+        {
+            Vector3 normal;
+            hitRoof = Step(particle, force, field, normal);
+        }
+        TEST_VERIFY(hitRoof);
+        TEST_VERIFY(FLOAT_EQUAL_EPS(particle.position.z, 3.0f, 0.01f));
+
+        // flies into the wall and is reflected back
+        particle = Particle();
+        particle.lifeTime = 100.0f;
+        particle.position = Vector3(0.0f, 0.0f, 1.5f);
+        particle.speed = Vector3(10.0f, 0.0f, 2.0f);
+        bool hitWall = false;
+        for (uint32 frame = 0; frame < 30 && !hitWall; ++frame)
+        {
+            Vector3 normal;
+            hitWall = Step(particle, force, field, normal);
+            if (hitWall)
+            {
+                TEST_VERIFY(FLOAT_EQUAL_EPS(normal.x, -1.0f, 0.001f));
+            }
+        }
+        TEST_VERIFY(hitWall);
+        TEST_VERIFY(particle.speed.x < 0.0f);
+        TEST_VERIFY(particle.position.x < 2.0f);
+
+        // landscape-only force ignores static geometry
+        force->collideWithStaticGeometry = false;
+        particle = Particle();
+        particle.lifeTime = 100.0f;
+        particle.position = Vector3(3.0f, 0.0f, 2.0f);
+        Vector3 normal;
+        TEST_VERIFY(!Step(particle, force, field, normal));
+    }
+
+    DAVA_TEST (OverhangTest)
+    {
+        using namespace ParticleSceneCollisionTestDetails;
+
+        ScopedPtr<Heightmap> heightmap(CreateFlat(64, 0.0f));
+        ScopedPtr<ParticleCollisionHeightField> field(new ParticleCollisionHeightField());
+        field->SetLandscape(heightmap, AABBox3(Vector3(-50.0f, -50.0f, 0.0f), Vector3(50.0f, 50.0f, 10.0f)));
+        field->ResetStaticGeometry(AABBox3(Vector3(-10.0f, -10.0f, 0.0f), Vector3(10.0f, 10.0f, 10.0f)), 0.5f);
+        // bridge deck from 4 to 5 units over the ground
+        field->AddStaticBox(AABBox3(Vector3(2.0f, -2.0f, 4.0f), Vector3(6.0f, 2.0f, 5.0f)));
+
+        ScopedPtr<ParticleForce> force(CreateCollisionForce(ParticleForce::eCollisionResponse::BOUNCE));
+        force->collideWithStaticGeometry = true;
+
+        // flies under the bridge without being pushed on top of it
+        Particle particle;
+        particle.lifeTime = 100.0f;
+        particle.position = Vector3(0.0f, 0.0f, 1.0f);
+        particle.speed = Vector3(10.0f, 0.0f, 3.0f);
+        for (uint32 frame = 0; frame < 60; ++frame)
+        {
+            Vector3 normal;
+            if (Step(particle, force, field, normal))
+            {
+                TEST_VERIFY(FLOAT_EQUAL_EPS(normal.z, 1.0f, 0.001f));
+            }
+            TEST_VERIFY(particle.position.z < 4.0f);
+        }
+        TEST_VERIFY(particle.position.x > 6.0f);
+
+        // still lands on the deck from above
+        particle = Particle();
+        particle.lifeTime = 100.0f;
+        particle.position = Vector3(4.0f, 0.0f, 8.0f);
+        bool hitDeck = false;
+        for (uint32 frame = 0; frame < 60 && !hitDeck; ++frame)
+        {
+            Vector3 normal;
+            hitDeck = Step(particle, force, field, normal);
+        }
+        TEST_VERIFY(hitDeck);
+        TEST_VERIFY(FLOAT_EQUAL_EPS(particle.position.z, 5.0f, 0.01f));
+    }
+
+    DAVA_TEST (CollidingParticlesBenchmark)
+    {
+        using namespace ParticleSceneCollisionTestDetails;
+
+        const uint32 particlesCount = 20000;
+        const uint32 framesCount = 300;
+
+        ScopedPtr<Heightmap> heightmap(CreateHills(512));
+        ScopedPtr<ParticleCollisionHeightField> field(new ParticleCollisionHeightField());
+        AABBox3 bbox(Vector3(-100.0f, -100.0f, 0.0f), Vector3(100.0f, 100.0f, 10.0f));
+        field->SetLandscape(heightmap, bbox);
+        ScopedPtr<ParticleForce> force(CreateCollisionForce(ParticleForce::eCollisionResponse::BOUNCE));
+        force->collisionFriction = 0.3f;
+
+        std::mt19937 generator(17);
+        std::uniform_real_distribution<float32> position(-90.0f, 90.0f);
+        std::uniform_real_distribution<float32> speed(-5.0f, 5.0f);
+        Vector<Particle> particles(particlesCount);
+        for (Particle& particle : particles)
+        {
+            particle.lifeTime = 100.0f;
+            particle.position = Vector3(position(generator), position(generator), 15.0f);
+            particle.speed = Vector3(speed(generator), speed(generator), speed(generator));
+        }
+
+        uint32 impacts = 0;
+        int64 startTime = SystemTimer::GetUs();
+        for (uint32 frame = 0; frame < framesCount; ++frame)
+        {
+            for (Particle& particle : particles)
+            {
+                Vector3 normal;
+                impacts += Step(particle, force, field, normal) ? 1 : 0;
+            }
+        }
+        int64 totalTime = SystemTimer::GetUs() - startTime;
+
+        uint32 belowSurface = 0;
+        for (const Particle& particle : particles)
+        {
+            float32 height = 0.0f;
+            if (field->GetLandscapeHeight(particle.position.x, particle.position.y, height) && particle.position.z < height - 0.01f)
+                ++belowSurface;
+        }
+
+        TEST_VERIFY(impacts >= particlesCount);
+        TEST_VERIFY(belowSurface == 0);
+
+        Logger::Info("Particle scene collision benchmark (%u particles, %u frames): %lld us total, %.2f us per frame, %u impacts",
+                     particlesCount, framesCount, totalTime, static_cast<float64>(totalTime) / framesCount, impacts);
+    }
+};
@@ -0,0 +1,298 @@
+#include "UnitTests/UnitTests.h"
+
+#include "Base/RefPtr.h"
+#include "Base/ScopedPtr.h"
+#include "Concurrency/Thread.h"
+#include "Engine/Engine.h"
+#include "FileSystem/FileSystem.h"
+#include "FileSystem/KeyedArchive.h"
+#include "Logger/Logger.h"
+#include "Render/Highlevel/Camera.h"
+#include "Scene3D/Components/CameraComponent.h"
+#include "Scene3D/Components/ComponentHelpers.h"
+#include "Scene3D/Components/CustomPropertiesComponent.h"
+#include "Scene3D/Components/TransformComponent.h"
+#include "Scene3D/Entity.h"
+#include "Scene3D/Scene.h"
+#include "Scene3D/Streaming/SectorsManifest.h"
+#include "Scene3D/Streaming/SectorsPartitioner.h"
+#include "Scene3D/Systems/SectorStreamingSystem.h"
+#include "Time/SystemTimer.h"
+#include "Utils/StringFormat.h"
+
+using namespace DAVA;
+
+namespace SectorStreamingSystemTestDetails
+{
+void AddEntity(Scene* scene, const Vector3& position, uint32 payloadSize = 0)
+{
+    ScopedPtr<Entity> entity(new Entity());
+    entity->SetName(FastName(Format("entity_%d_%d", static_cast<int32>(position.x), static_cast<int32>(position.y))));
+    GetTransformComponent(entity)->SetLocalTranslation(position);
+    if (payloadSize > 0)
+    {
+        GetOrCreateCustomProperties(entity)->GetArchive()->SetString("payload", String(payloadSize, 'x'));
+    }
+    scene->AddNode(entity);
+}
+
+// Creates grid of `size` x `size` cells with `perCell` entities in every cell
+void CreateMap(Scene* scene, int32 size, float32 cellSize, int32 perCell, uint32 payloadSize = 0)
+{
+    for (int32 y = 0; y < size; ++y)
+    {
+        for (int32 x = 0; x < size; ++x)
+        {
+            for (int32 i = 0; i < perCell; ++i)
+            {
+                float32 offset = (i + 0.5f) * cellSize / perCell;
+                AddEntity(scene, Vector3(x * cellSize + offset, y * cellSize + cellSize - offset, 0.0f), payloadSize);
+            }
+        }
+    }
+}
+
+SectorStreamingSystem* AddStreamingSystem(Scene* scene)
+{
+    SectorStreamingSystem* system = new SectorStreamingSystem(scene);
+    scene->AddSystem(system, ComponentMask(), Scene::SCENE_SYSTEM_REQUIRE_PROCESS);
+    return system;
+}
+
+bool WaitIdle(Scene* scene, SectorStreamingSystem* system)
+{
+    int64 deadline = SystemTimer::GetMs() + 10000;
+    do
+    {
+        scene->Update(0.016f);
+        if (system->IsIdle())
+        {
+            return true;
+        }
+        Thread::Sleep(1);
+    } while (SystemTimer::GetMs() < deadline);
+    return false;
+}
+}
+
+DAVA_TESTCLASS (SectorStreamingSystemTest)
+{
+    FilePath testFolder;
+
+    SectorStreamingSystemTest()
+    {
+        FileSystem* fs = GetEngineContext()->fileSystem;
+        testFolder = fs->GetTempDirectoryPath();
+        testFolder.MakeDirectoryPathname();
+        testFolder += "SectorStreamingSystemTest/";
+        fs->DeleteDirectory(testFolder, true);
+    }
+
+    ~SectorStreamingSystemTest()
+    {
+        GetEngineContext()->fileSystem->DeleteDirectory(testFolder, true);
+    }
+
+    DAVA_TEST (PartitionTest)
+    {
+        using namespace SectorStreamingSystemTestDetails;
+
+        RefPtr<Scene> scene(new Scene());
+        CreateMap(scene.Get(), 3, 100.0f, 2);
+        AddEntity(scene.Get(), Vector3(-250.0f, 50.0f, 0.0f));
+
+        ScopedPtr<Entity> cameraEntity(new Entity());
+        ScopedPtr<Camera> camera(new Camera());
+        cameraEntity->AddComponent(new CameraComponent(camera));
+        scene->AddNode(cameraEntity);
+
+        SectorsPartitioner::Settings settings;
+        settings.sectorSize = 100.0f;
+        FilePath manifestPath = testFolder + "partition/map.sectors";
+        SectorsManifest manifest;
+        TEST_VERIFY(SectorsPartitioner::Partition(scene.Get(), manifestPath, settings, &manifest));
+
+        // camera stays in base scene
+        TEST_VERIFY(scene->GetChildrenCount() == 1);
+        TEST_VERIFY(GetCamera(scene->GetChild(0)) != nullptr);
+
+        TEST_VERIFY(manifest.origin == Vector2(-300.0f, 0.0f));
+        TEST_VERIFY(manifest.columns == 6);
+        TEST_VERIFY(manifest.rows == 3);
+        TEST_VERIFY(manifest.sectors.size() == 10);
+        TEST_VERIFY(manifest.GetSector(1, 0) == nullptr);
+        TEST_VERIFY(manifest.GetSector(0, 0) != nullptr && manifest.GetSector(0, 0)->entitiesCount == 1);
+        TEST_VERIFY(manifest.GetSector(5, 2) != nullptr && manifest.GetSector(5, 2)->entitiesCount == 2);
+
+        SectorsManifest loaded;
+        TEST_VERIFY(loaded.Load(manifestPath));
+        TEST_VERIFY(loaded.sectors.size() == manifest.sectors.size());
+        TEST_VERIFY(loaded.GetBaseScenePath() == manifest.GetBaseScenePath());
+
+        FileSystem* fs = GetEngineContext()->fileSystem;
+        TEST_VERIFY(fs->Exists(loaded.GetBaseScenePath()));
+        for (const SectorsManifest::Sector& sector : loaded.sectors)
+        {
+            TEST_VERIFY(fs->Exists(loaded.GetScenePath(sector)));
+            TEST_VERIFY(sector.fileSize > 0);
+
+            int32 x = 0;
+            int32 y = 0;
+            Vector3 center = sector.bbox.GetCenter();
+            loaded.GetCellAt(Vector2(center.x, center.y), x, y);
+            TEST_VERIFY(x == sector.x && y == sector.y);
+        }
+    }
+
+    DAVA_TEST (StreamingTest)
+    {
+        using namespace SectorStreamingSystemTestDetails;
+
+        FilePath manifestPath = testFolder + "streaming/map.sectors";
+        {
+            RefPtr<Scene> map(new Scene());
+            CreateMap(map.Get(), 5, 100.0f, 2);
+            SectorsPartitioner::Settings partitionSettings;
+            partitionSettings.sectorSize = 100.0f;
+            TEST_VERIFY(SectorsPartitioner::Partition(map.Get(), manifestPath, partitionSettings));
+        }
+
+        RefPtr<Scene> scene(new Scene());
+        SectorStreamingSystem* system = AddStreamingSystem(scene.Get());
+        TEST_VERIFY(system->SetManifest(manifestPath));
+
+        SectorStreamingSystem::Settings settings;
+        settings.loadRadius = 120.0f;
+        settings.unloadRadius = 200.0f;
+        system->SetSettings(settings);
+        system->SetPointsOfInterest({ { Vector3(50.0f, 50.0f, 0.0f), Vector3(1.0f, 0.0f, 0.0f) } });
+
+        TEST_VERIFY(WaitIdle(scene.Get(), system));
+        TEST_VERIFY(system->GetSectorState(0, 0) == SectorStreamingSystem::eSectorState::RESIDENT);
+        TEST_VERIFY(system->GetSectorState(1, 1) == SectorStreamingSystem::eSectorState::RESIDENT);
+        TEST_VERIFY(system->GetSectorState(2, 0) == SectorStreamingSystem::eSectorState::UNLOADED);
+        TEST_VERIFY(system->GetStatistics().residentSectors == 4);
+        TEST_VERIFY(scene->GetChildrenCount() == 4);
+        TEST_VERIFY(system->GetSectorEntity(1, 0) != nullptr && system->GetSectorEntity(1, 0)->GetChildrenCount() == 2);
+
+        // sectors between load and unload radius are kept
+        system->SetPointsOfInterest({ { Vector3(260.0f, 50.0f, 0.0f), Vector3() } });
+        TEST_VERIFY(WaitIdle(scene.Get(), system));
+        TEST_VERIFY(system->GetSectorState(0, 0) == SectorStreamingSystem::eSectorState::RESIDENT);
+        TEST_VERIFY(system->GetSectorState(3, 1) == SectorStreamingSystem::eSectorState::RESIDENT);
+
+        system->SetPointsOfInterest({ { Vector3(450.0f, 450.0f, 0.0f), Vector3() } });
+        TEST_VERIFY(WaitIdle(scene.Get(), system));
+        TEST_VERIFY(system->GetSectorState(0, 0) == SectorStreamingSystem::eSectorState::UNLOADED);
+        TEST_VERIFY(system->GetSectorEntity(0, 0) == nullptr);
+        TEST_VERIFY(system->GetSectorState(4, 4) == SectorStreamingSystem::eSectorState::RESIDENT);
+        TEST_VERIFY(system->GetStatistics().residentSectors == 4);
+        TEST_VERIFY(scene->GetChildrenCount() == 4);
+
+        // memory budget limits count of sectors in memory
+        system->UnloadAll();
+        TEST_VERIFY(scene->GetChildrenCount() == 0);
+        uint64 maxFileSize = 0;
+        for (const SectorsManifest::Sector& sector : system->GetManifest().sectors)
+        {
+            maxFileSize = std::max(maxFileSize, sector.fileSize);
+        }
+        settings.memoryBudget = maxFileSize * 2 + maxFileSize / 2;
+        system->SetSettings(settings);
+        TEST_VERIFY(WaitIdle(scene.Get(), system));
+        TEST_VERIFY(system->GetStatistics().residentSectors == 2);
+
+        scene->RemoveSystem(system);
+        SafeDelete(system);
+    }
+
+    DAVA_TEST (FlyThroughBenchmark)
+    {
+        using namespace SectorStreamingSystemTestDetails;
+
+        // 4km x 4km map split into 250m sectors
+        const int32 mapCells = 16;
+        const float32 sectorSize = 250.0f;
+        const int32 entitiesPerSector = 40;
+        const uint32 payloadSize = 1024;
+        const uint32 hitchThresholdUs = 16000;
+        FileSystem* fs = GetEngineContext()->fileSystem;
+
+        FilePath fullMapPath = testFolder + "benchmark/full.sc2";
+        FilePath manifestPath = testFolder + "benchmark/sectors/map.sectors";
+        {
+            RefPtr<Scene> map(new Scene());
+            CreateMap(map.Get(), mapCells, sectorSize, entitiesPerSector, payloadSize);
+            fs->CreateDirectory(fullMapPath.GetDirectory(), true);
+            TEST_VERIFY(map->SaveScene(fullMapPath) == SceneFileV2::ERROR_NO_ERROR);
+
+            SectorsPartitioner::Settings partitionSettings;
+            partitionSettings.sectorSize = sectorSize;
+            TEST_VERIFY(SectorsPartitioner::Partition(map.Get(), manifestPath, partitionSettings));
+        }
+
+        uint64 fullMapSize = 0;
+        fs->GetFileSize(fullMapPath, fullMapSize);
+        int64 fullLoadTime = 0;
+        {
+            RefPtr<Scene> full(new Scene());
+            int64 startTime = SystemTimer::GetUs();
+            TEST_VERIFY(full->LoadScene(fullMapPath) == SceneFileV2::ERROR_NO_ERROR);
+            fullLoadTime = SystemTimer::GetUs() - startTime;
+        }
+
+        RefPtr<Scene> scene(new Scene());
+        SectorStreamingSystem* system = AddStreamingSystem(scene.Get());
+        TEST_VERIFY(system->SetManifest(manifestPath));
+
+        SectorStreamingSystem::Settings settings;
+        settings.loadRadius = 500.0f;
+        settings.unloadRadius = 700.0f;
+        settings.maxConcurrentLoads = 1;
+        settings.frameBudgetUs = 2000;
+        system->SetSettings(settings);
+
+        Vector3 from(100.0f, 100.0f, 50.0f);
+        Vector3 to(mapCells * sectorSize - 100.0f, mapCells * sectorSize - 100.0f, 50.0f);
+        Vector3 direction = Normalize(to - from);
+        const float32 speed = 30.0f; // meters per frame
+        const uint32 framesCount = static_cast<uint32>((to - from).Length() / speed);
+
+        uint32 maxFrameTime = 0;
+        uint32 hitchesCount = 0;
+        int64 totalFrameTime = 0;
+        uint32 maxLoadedSectors = 0;
+        for (uint32 frame = 0; frame <= framesCount; ++frame)
+        {
+            system->SetPointsOfInterest({ { from + direction * (speed * frame), direction } });
+
+            int64 startTime = SystemTimer::GetUs();
+            scene->Update(0.016f);
+            uint32 frameTime = static_cast<uint32>(SystemTimer::GetUs() - startTime);
+
+            totalFrameTime += frameTime;
+            maxFrameTime = std::max(maxFrameTime, frameTime);
+            hitchesCount += (frameTime > hitchThresholdUs) ? 1 : 0;
+            maxLoadedSectors = std::max(maxLoadedSectors, system->GetStatistics().residentSectors + system->GetStatistics().pendingSectors);
+
+            // rest of frame, so worker jobs have time to load sectors
+            Thread::Sleep(8);
+        }
+        TEST_VERIFY(WaitIdle(scene.Get(), system));
+
+        const SectorStreamingSystem::Statistics& stats = system->GetStatistics();
+        TEST_VERIFY(system->GetSectorState(mapCells - 1, mapCells - 1) == SectorStreamingSystem::eSectorState::RESIDENT);
+        TEST_VERIFY(system->GetSectorState(0, 0) == SectorStreamingSystem::eSectorState::UNLOADED);
+        TEST_VERIFY(stats.peakResidentMemory < fullMapSize);
+
+        Logger::Info("SectorStreaming benchmark (%dx%d sectors, %d entities): full map load %lld us, %llu bytes; "
+                     "streaming %u frames avg %lld us, max %u us, %u hitches > %u us, max %u sectors in memory, "
+                     "peak %u resident sectors, peak memory estimate %llu bytes, %u loads, %u unloads",
+                     mapCells, mapCells, mapCells * mapCells * entitiesPerSector, fullLoadTime, fullMapSize,
+                     framesCount + 1, totalFrameTime / (framesCount + 1), maxFrameTime, hitchesCount, hitchThresholdUs, maxLoadedSectors,
+                     stats.peakResidentSectors, stats.peakResidentMemory, stats.loadsCount, stats.unloadsCount);
+
+        scene->RemoveSystem(system);
+        SafeDelete(system);
+    }
+};
@@ -0,0 +1,475 @@
+#include "UnitTests/UnitTests.h"
+
+#include "Animation/AnimationChannel.h"
+#include "Animation/AnimationClip.h"
+#include "Animation/AnimationTrack.h"
+#include "Base/ScopedPtr.h"
+#include "Engine/Engine.h"
+#include "FileSystem/File.h"
+#include "FileSystem/FileSystem.h"
+#include "Logger/Logger.h"
+#include "Render/3D/PolygonGroup.h"
+#include "Render/Highlevel/Camera.h"
+#include "Render/Highlevel/GeometryGenerator.h"
+#include "Render/Highlevel/RenderBatch.h"
+#include "Render/Highlevel/SkinnedMesh.h"
+#include "Render/Material/NMaterial.h"
+#include "Render/Material/NMaterialNames.h"
+#include "Scene3D/Components/ComponentHelpers.h"
+#include "Scene3D/Components/MotionComponent.h"
+#include "Scene3D/Components/RenderComponent.h"
+#include "Scene3D/Components/SingleComponents/MotionSingleComponent.h"
+#include "Scene3D/Components/SkeletonComponent.h"
+#include "Scene3D/Components/TransformComponent.h"
+#include "Scene3D/Entity.h"
+#include "Scene3D/Scene.h"
+#include "Scene3D/SkeletonAnimation/JointTransform.h"
+#include "Scene3D/Systems/SkeletonSystem.h"
+#include "Time/SystemTimer.h"
+#include "Utils/CRC32.h"
+
+using namespace DAVA;
+
+namespace SkeletonAnimationLodTestDetails
+{
+const float32 frameTime = 1.0f / 60.0f;
+const uint32 LIMBS_COUNT = 4;
+const uint32 LIMB_LENGTH = 6;
+const uint32 SPINE_LENGTH = 3;
+
+template <typename T>
+void Write(Vector<uint8>& data, T value)
+{
+    const uint8* bytes = reinterpret_cast<const uint8*>(&value);
+    data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+void WriteAlignedString(Vector<uint8>& data, const String& str)
+{
+    size_t size = str.size() + 1;
+    data.insert(data.end(), str.c_str(), str.c_str() + size);
+    data.resize(data.size() + (((size + 3) & ~size_t(3)) - size), 0);
+}
+
+// Root, spine and limbs attached to the last spine joint
+Vector<SkeletonComponent::Joint> CreateJoints()
+{
+    Vector<SkeletonComponent::Joint> joints;
+    Vector<JointTransform> objectSpace;
+
+    auto addJoint = [&](uint32 parentIndex, const Vector3& offset) {
+        SkeletonComponent::Joint joint;
+        joint.parentIndex = parentIndex;
+        joint.uid = FastName(Format("joint%u", uint32(joints.size())));
+        joint.name = joint.uid;
+        joint.bbox = AABBox3(Vector3(-0.1f, -0.1f, -0.1f), Vector3(0.1f, 0.1f, 0.1f));
+        joint.bindTransform = Matrix4::MakeTranslation(offset);
+
+        JointTransform local(joint.bindTransform);
+        objectSpace.push_back(parentIndex == SkeletonComponent::INVALID_JOINT_INDEX ? local : objectSpace[parentIndex].AppendTransform(local));
+        joint.bindTransformInv = objectSpace.back().GetInverse().GetMatrix();
+
+        joints.push_back(joint);
+        return uint32(joints.size() - 1);
+    };
+
+    uint32 parent = addJoint(SkeletonComponent::INVALID_JOINT_INDEX, Vector3(0.f, 0.f, 1.f));
+    for (uint32 i = 0; i < SPINE_LENGTH; ++i)
+    {
+        parent = addJoint(parent, Vector3(0.f, 0.f, 0.2f));
+    }
+
+    uint32 spineEnd = parent;
+    for (uint32 limb = 0; limb < LIMBS_COUNT; ++limb)
+    {
+        Vector3 direction(limb % 2 ? 0.15f : -0.15f, 0.f, limb < 2 ? 0.f : -0.2f);
+        parent = spineEnd;
+        for (uint32 i = 0; i < LIMB_LENGTH; ++i)
+        {
+            parent = addJoint(parent, direction);
+        }
+    }
+
+    DVASSERT(joints.size() <= SkinnedMesh::MAX_TARGET_JOINTS);
+    return joints;
+}
+
+// Every joint swings back and forth during one second
+void WriteAnimationClip(const FilePath& path, const Vector<SkeletonComponent::Joint>& joints)
+{
+    Vector<uint8> data;
+    Write<float32>(data, 1.f);
+    Write<uint32>(data, uint32(joints.size()));
+    for (const SkeletonComponent::Joint& joint : joints)
+    {
+        WriteAlignedString(data, joint.uid.c_str());
+        WriteAlignedString(data, joint.name.c_str());
+
+        Write<uint32>(data, AnimationTrack::ANIMATION_TRACK_DATA_SIGNATURE);
+        Write<uint32>(data, 1);
+        Write<uint8>(data, AnimationTrack::CHANNEL_TARGET_POSITION);
+        data.resize(data.size() + 3, 0);
+
+        Write<uint32>(data, AnimationChannel::ANIMATION_CHANNEL_DATA_SIGNATURE);
+        Write<uint8>(data, 3);
+        Write<uint8>(data, AnimationChannel::INTERPOLATION_LINEAR);
+        Write<uint16>(data, 0);
+        Write<uint32>(data, 3);
+
+        Vector3 position = joint.bindTransform.GetTranslationVector();
+        float32 keys[3][4] = {
+            { 0.f, position.x, position.y, position.z },
+            { 0.5f, position.x, position.y + 0.1f, position.z + 0.05f },
+            { 1.f, position.x, position.y, position.z }
+        };
+        for (const auto& key : keys)
+        {
+            for (float32 value : key)
+            {
+                Write<float32>(data, value);
+            }
+        }
+    }
+    Write<uint32>(data, 0); //markers are set in motion descriptor
+
+    AnimationClip::FileHeader header;
+    header.signature = AnimationClip::ANIMATION_CLIP_FILE_SIGNATURE;
+    header.version = 1;
+    header.crc32 = CRC32::ForBuffer(data.data(), data.size());
+    header.dataSize = uint32(data.size());
+
+    ScopedPtr<File> file(File::Create(path, File::CREATE | File::WRITE));
+    file->Write(&header, sizeof(header));
+    file->Write(data.data(), uint32(data.size()));
+}
+
+void WriteMotionDescriptor(const FilePath& path, const FilePath& clipPath)
+{
+    String descriptor = Format("motion-layers:\n"
+                               "    -   layer-id: \"base\"\n"
+                               "        blend-mode: \"Override\"\n"
+                               "        motions:\n"
+                               "            -   motion-id: \"walk\"\n"
+                               "                blend-tree:\n"
+                               "                    clip: \"%s\"\n"
+                               "                    markers:\n"
+                               "                        step-left: \"0.3\"\n"
+                               "                        step-right: \"0.8\"\n",
+                               clipPath.GetAbsolutePathname().c_str());
+
+    ScopedPtr<File> file(File::Create(path, File::CREATE | File::WRITE));
+    file->WriteString(descriptor, false);
+}
+
+struct Crowd
+{
+    Vector<SkeletonComponent::Joint> joints;
+    ScopedPtr<PolygonGroup> geometry;
+    ScopedPtr<NMaterial> material;
+    FilePath motionPath;
+
+    Crowd(const FilePath& folder)
+        : joints(CreateJoints())
+        , geometry(nullptr)
+        , material(new NMaterial())
+    {
+        Map<FastName, float32> options;
+        geometry = GeometryGenerator::GenerateBox(AABBox3(Vector3(-0.5f, -0.5f, 0.f), Vector3(0.5f, 0.5f, 2.f)), options);
+        material->SetFXName(NMaterialName::TEXTURED_OPAQUE);
+
+        FilePath clipPath = folder + "walk.anim";
+        motionPath = folder + "walk.yaml";
+        WriteAnimationClip(clipPath, joints);
+        WriteMotionDescriptor(motionPath, clipPath);
+    }
+
+    // Characters opt in to animation LOD unless `animationLod` is false
+    MotionComponent* AddCharacter(Scene* scene, const Vector3& position, bool animationLod = true)
+    {
+        ScopedPtr<Entity> entity(new Entity());
+
+        ScopedPtr<SkinnedMesh> mesh(new SkinnedMesh());
+        ScopedPtr<RenderBatch> batch(new RenderBatch());
+        batch->SetPolygonGroup(geometry);
+        batch->SetMaterial(material);
+        mesh->AddRenderBatch(batch);
+
+        SkinnedMesh::JointTargets targets(joints.size());
+        for (uint32 j = 0; j < uint32(targets.size()); ++j)
+        {
+            targets[j] = int32(j);
+        }
+        mesh->SetJointTargets(batch, targets);
+        entity->AddComponent(new RenderComponent(mesh));
+
+        SkeletonComponent* skeleton = new SkeletonComponent();
+        skeleton->SetJoints(joints);
+        skeleton->SetAnimationLodEnabled(animationLod);
+        entity->AddComponent(skeleton);
+
+        MotionComponent* motion = new MotionComponent();
+        motion->SetDescriptorPath(motionPath);
+        entity->AddComponent(motion);
+
+        GetTransformComponent(entity)->SetLocalTranslation(position);
+        scene->AddNode(entity);
+        return motion;
+    }
+
+    // Rows of characters go away from the camera, starting at `distance`
+    Vector<MotionComponent*> Populate(Scene* scene, uint32 count, float32 distance)
+    {
+        const uint32 columns = 15;
+        Vector<MotionComponent*> motions;
+        for (uint32 i = 0; i < count; ++i)
+        {
+            float32 x = distance + 1.5f * (i / columns);
+            float32 y = 1.5f * (float32(i % columns) - columns / 2);
+            motions.push_back(AddCharacter(scene, Vector3(x, y, 0.f)));
+        }
+        return motions;
+    }
+};
+
+Camera* CreateCamera(Scene* scene, const Vector3& target)
+{
+    Camera* camera = new Camera();
+    camera->SetupPerspective(70.0f, 1.0f, 0.5f, 1000.0f);
+    camera->SetUp(Vector3(0.0f, 0.0f, 1.0f));
+    camera->SetPosition(Vector3(0.0f, 0.0f, 1.5f));
+    camera->SetTarget(target);
+    scene->AddCamera(camera);
+    scene->SetCurrentCamera(camera);
+    return camera;
+}
+
+void SetAnimationLodEnabled(Scene* scene, bool enabled)
+{
+    SkeletonSystem::AnimationLodSettings settings;
+    settings.enabled = enabled;
+    scene->skeletonSystem->SetAnimationLodSettings(settings);
+}
+
+// Markers reached this frame as [character index, marker]
+Vector<std::pair<size_t, FastName>> GetReachedMarkers(Scene* scene, const Vector<MotionComponent*>& motions)
+{
+    Vector<std::pair<size_t, FastName>> markers;
+    for (const MotionSingleComponent::AnimationInfo& info : scene->motionSingleComponent->animationMarkerReached)
+    {
+        size_t index = std::distance(motions.begin(), std::find(motions.begin(), motions.end(), info.motionComponent));
+        markers.emplace_back(index, info.markerID);
+    }
+    std::sort(markers.begin(), markers.end(), [](const std::pair<size_t, FastName>& l, const std::pair<size_t, FastName>& r) {
+        return l.first < r.first || (l.first == r.first && strcmp(l.second.c_str(), r.second.c_str()) < 0);
+    });
+    return markers;
+}
+}
+
+DAVA_TESTCLASS (SkeletonAnimationLodTest)
+{
+    FilePath testFolder;
+
+    SkeletonAnimationLodTest()
+    {
+        FileSystem* fs = GetEngineContext()->fileSystem;
+        testFolder = fs->GetTempDirectoryPath();
+        testFolder.MakeDirectoryPathname();
+        testFolder += "SkeletonAnimationLodTest/";
+        fs->DeleteDirectory(testFolder, true);
+        fs->CreateDirectory(testFolder, true);
+    }
+
+    ~SkeletonAnimationLodTest()
+    {
+        GetEngineContext()->fileSystem->DeleteDirectory(testFolder, true);
+    }
+
+    DAVA_TEST (MarkersPreservedTest)
+    {
+        using namespace SkeletonAnimationLodTestDetails;
+
+        Crowd crowd(testFolder);
+
+        // far visible characters are updated rarely, characters behind the camera are stopped
+        ScopedPtr<Scene> scenes[2] = { ScopedPtr<Scene>(new Scene()), ScopedPtr<Scene>(new Scene()) };
+        Vector<MotionComponent*> motions[2];
+        for (uint32 s = 0; s < 2; ++s)
+        {
+            SetAnimationLodEnabled(scenes[s], s == 1);
+            ScopedPtr<Camera> camera(CreateCamera(scenes[s], Vector3(1.f, 0.f, 1.5f)));
+            motions[s] = crowd.Populate(scenes[s], 30, 80.f);
+            for (MotionComponent* motion : crowd.Populate(scenes[s], 15, -20.f))
+            {
+                motions[s].push_back(motion);
+            }
+        }
+
+        uint32 markersCount = 0;
+        uint32 notUpdatedCount = 0;
+        for (uint32 frame = 0; frame < 150; ++frame)
+        {
+            Vector<std::pair<size_t, FastName>> markers[2];
+            for (uint32 s = 0; s < 2; ++s)
+            {
+                scenes[s]->Update(frameTime);
+                markers[s] = GetReachedMarkers(scenes[s], motions[s]);
+                scenes[s]->Draw();
+            }
+
+            TEST_VERIFY(markers[0] == markers[1]);
+            markersCount += uint32(markers[0].size());
+
+            const SkeletonSystem::AnimationLodStatistics& stats = scenes[1]->skeletonSystem->GetAnimationLodStatistics();
+            notUpdatedCount += stats.skippedSkeletons + stats.interpolatedSkeletons + stats.stoppedSkeletons;
+        }
+
+        TEST_VERIFY(markersCount > 0);
+        TEST_VERIFY(notUpdatedCount > 0);
+    }
+
+    DAVA_TEST (CatchUpTest)
+    {
+        using namespace SkeletonAnimationLodTestDetails;
+
+        Crowd crowd(testFolder);
+
+        ScopedPtr<Scene> scenes[2] = { ScopedPtr<Scene>(new Scene()), ScopedPtr<Scene>(new Scene()) };
+        ScopedPtr<Camera> cameras[2] = { ScopedPtr<Camera>(nullptr), ScopedPtr<Camera>(nullptr) };
+        SkeletonComponent* skeletons[2] = {};
+        for (uint32 s = 0; s < 2; ++s)
+        {
+            SetAnimationLodEnabled(scenes[s], s == 1);
+            cameras[s] = CreateCamera(scenes[s], Vector3(-1.f, 0.f, 1.5f));
+            MotionComponent* motion = crowd.AddCharacter(scenes[s], Vector3(5.f, 0.f, 0.f));
+            skeletons[s] = GetSkeletonComponent(motion->GetEntity());
+        }
+
+        for (uint32 frame = 0; frame < 60; ++frame)
+        {
+            for (uint32 s = 0; s < 2; ++s)
+            {
+                scenes[s]->Update(frameTime);
+                scenes[s]->Draw();
+            }
+        }
+        TEST_VERIFY(scenes[1]->skeletonSystem->GetAnimationLodStatistics().stoppedSkeletons == 1);
+
+        // turn to the character: it is rendered with old pose once and caught up on the next update
+        for (uint32 s = 0; s < 2; ++s)
+        {
+            cameras[s]->SetTarget(Vector3(1.f, 0.f, 1.5f));
+            scenes[s]->Update(frameTime);
+            scenes[s]->Draw();
+            scenes[s]->Update(frameTime);
+        }
+
+        const SkeletonSystem::AnimationLodStatistics& stats = scenes[1]->skeletonSystem->GetAnimationLodStatistics();
+        TEST_VERIFY(stats.stoppedSkeletons == 0 && stats.updatedSkeletons == 1);
+
+        uint32 lastJoint = skeletons[0]->GetJointsCount() - 1;
+        Vector3 expected = skeletons[0]->GetJointObjectSpaceTransform(lastJoint).GetPosition();
+        Vector3 actual = skeletons[1]->GetJointObjectSpaceTransform(lastJoint).GetPosition();
+        TEST_VERIFY((expected - actual).Length() < 1e-4f);
+    }
+
+    DAVA_TEST (OptInTest)
+    {
+        using namespace SkeletonAnimationLodTestDetails;
+
+        Crowd crowd(testFolder);
+
+        // LOD is disabled by default both in settings and in components
+        TEST_VERIFY(!SkeletonSystem::AnimationLodSettings().enabled);
+        TEST_VERIFY(!SkeletonComponent().IsAnimationLodEnabled());
+
+        ScopedPtr<Scene> scene(new Scene());
+        ScopedPtr<Camera> camera(CreateCamera(scene, Vector3(-1.f, 0.f, 1.5f)));
+        MotionComponent* motion = crowd.AddCharacter(scene, Vector3(50.f, 0.f, 0.f), false);
+        SkeletonComponent* skeleton = GetSkeletonComponent(motion->GetEntity());
+
+        auto countUpdates = [&scene]() {
+            uint32 updates = 0;
+            for (uint32 frame = 0; frame < 30; ++frame)
+            {
+                scene->Update(frameTime);
+                scene->Draw();
+                updates += scene->skeletonSystem->GetAnimationLodStatistics().updatedSkeletons;
+            }
+            return updates;
+        };
+
+        // neither settings nor skeleton opted in
+        TEST_VERIFY(countUpdates() == 30);
+
+        // only skeleton opted in
+        skeleton->SetAnimationLodEnabled(true);
+        TEST_VERIFY(countUpdates() == 30);
+
+        // only settings opted in
+        skeleton->SetAnimationLodEnabled(false);
+        SetAnimationLodEnabled(scene, true);
+        TEST_VERIFY(countUpdates() == 30);
+
+        // both opted in, far skeleton is updated less often
+        skeleton->SetAnimationLodEnabled(true);
+        TEST_VERIFY(countUpdates() < 30);
+    }
+
+    DAVA_TEST (CrowdBenchmark)
+    {
+        using namespace SkeletonAnimationLodTestDetails;
+
+        const uint32 charactersCount = 300;
+        const uint32 framesCount = 120;
+        const float32 distances[] = { 3.f, 25.f, 80.f, 250.f, -20.f }; // the last crowd is behind the camera
+
+        Crowd crowd(testFolder);
+
+        for (float32 distance : distances)
+        {
+            int64 updateTime[2] = {};
+            uint32 updatedSkeletons[2] = {};
+            uint32 updatedJoints[2] = {};
+            for (uint32 pass = 0; pass < 2; ++pass)
+            {
+                ScopedPtr<Scene> scene(new Scene());
+                SetAnimationLodEnabled(scene, pass == 1);
+                ScopedPtr<Camera> camera(CreateCamera(scene, Vector3(1.f, 0.f, 1.5f)));
+                crowd.Populate(scene, charactersCount, distance);
+
+                // warm up: load motions, build materials and get visibility feedback
+                for (uint32 frame = 0; frame < 10; ++frame)
+                {
+                    scene->Update(frameTime);
+                    scene->Draw();
+                }
+
+                for (uint32 frame = 0; frame < framesCount; ++frame)
+                {
+                    int64 startTime = SystemTimer::GetUs();
+                    scene->Update(frameTime);
+                    updateTime[pass] += SystemTimer::GetUs() - startTime;
+                    scene->Draw();
+
+                    const SkeletonSystem::AnimationLodStatistics& stats = scene->skeletonSystem->GetAnimationLodStatistics();
+                    updatedSkeletons[pass] += stats.updatedSkeletons;
+                    updatedJoints[pass] += stats.updatedJoints;
+                }
+            }
+
+            TEST_VERIFY(updatedSkeletons[0] == charactersCount * framesCount);
+            TEST_VERIFY(updatedSkeletons[1] <= updatedSkeletons[0]);
+            if (distance > 50.f || distance < 0.f)
+            {
+                TEST_VERIFY(updatedSkeletons[1] < updatedSkeletons[0] / 2);
+            }
+
+            Logger::Info("Animation LOD benchmark (%u characters at %.0f, %u frames): scene update %lld us without LOD, %lld us with LOD; "
+                         "skeleton updates per frame %.1f / %.1f, joint updates per frame %.1f / %.1f",
+                         charactersCount, distance, framesCount, updateTime[0], updateTime[1],
+                         float32(updatedSkeletons[0]) / framesCount, float32(updatedSkeletons[1]) / framesCount,
+                         float32(updatedJoints[0]) / framesCount, float32(updatedJoints[1]) / framesCount);
+        }
+    }
+};
@@ -0,0 +1,494 @@
+#include "Scene3D/Waypoint/WaypointGraph.h"
+
+#include "Base/ScopedPtr.h"
+#include "Debug/DVAssert.h"
+#include "FileSystem/File.h"
+#include "FileSystem/KeyedArchive.h"
+#include "Logger/Logger.h"
+#include "Scene3D/Components/Waypoint/PathComponent.h"
+#include "Scene3D/Entity.h"
+#include "Scene3D/Waypoint/WaypointPathFinder.h"
+
+#include <algorithm>
+
+namespace DAVA
+{
+namespace WaypointGraphDetails
+{
+const uint32 FILE_SIGNATURE = DAVA_MAKEFOURCC('D', 'V', 'W', 'G');
+const uint32 CURRENT_VERSION = 1;
+
+struct FileHeader
+{
+    uint32 signature = 0;
+    uint32 version = 0;
+    uint32 waypointsCount = 0;
+    uint32 edgesCount = 0;
+    uint32 propertySetsCount = 0;
+    uint32 pathsCount = 0;
+    float32 minCostPerDistance = 1.f;
+};
+
+void CollectPaths(Entity* entity, Vector<PathComponent*>& paths)
+{
+    for (uint32 i = 0, count = entity->GetComponentCount<PathComponent>(); i < count; ++i)
+    {
+        paths.push_back(entity->GetComponent<PathComponent>(i));
+    }
+
+    for (int32 i = 0; i < entity->GetChildrenCount(); ++i)
+    {
+        CollectPaths(entity->GetChild(i), paths);
+    }
+}
+
+template <typename T>
+bool WriteVector(File* file, const Vector<T>& v)
+{
+    uint32 size = static_cast<uint32>(v.size() * sizeof(T));
+    return size == 0 || file->Write(v.data(), size) == size;
+}
+
+template <typename T>
+bool ReadVector(File* file, Vector<T>& v, uint32 count)
+{
+    v.resize(count);
+    uint32 size = static_cast<uint32>(count * sizeof(T));
+    return size == 0 || file->Read(v.data(), size) == size;
+}
+
+bool WriteString(File* file, const char* str)
+{
+    uint32 length = static_cast<uint32>(strlen(str));
+    return file->Write(&length) == sizeof(length) && (length == 0 || file->Write(str, length) == length);
+}
+
+bool ReadString(File* file, String& str)
+{
+    uint32 length = 0;
+    if (file->Read(&length) != sizeof(length) || length > file->GetSize())
+        return false;
+
+    str.resize(length);
+    return length == 0 || file->Read(&str[0], length) == length;
+}
+}
+
+WaypointGraph::WaypointGraph()
+{
+    Build(Vector<PathComponent*>());
+}
+
+void WaypointGraph::Build(Entity* root, const BuildParams& params)
+{
+    Vector<PathComponent*> paths;
+    WaypointGraphDetails::CollectPaths(root, paths);
+    Build(paths, params);
+}
+
+void WaypointGraph::Build(const Vector<PathComponent*>& paths, const BuildParams& params)
+{
+    positions.clear();
+    waypointPropertySets.clear();
+    waypointPaths.clear();
+    propertySets.clear();
+    pathNames.clear();
+    pathOffsets.assign(1, 0);
+
+    // archives are often shared between waypoints and edges, so they are serialized for interning only once
+    UnorderedMap<String, uint32> internedSets;
+    UnorderedMap<const KeyedArchive*, uint32> archiveSets;
+    auto intern = [&](const KeyedArchive* properties) {
+        auto found = archiveSets.find(properties);
+        if (found != archiveSets.end())
+            return found->second;
+
+        uint32 propertySet = InternPropertySet(properties, internedSets);
+        archiveSets.emplace(properties, propertySet);
+        return propertySet;
+    };
+    intern(nullptr);
+
+    UnorderedMap<const PathComponent::Waypoint*, uint32> waypointIndices;
+    for (uint32 p = 0; p < static_cast<uint32>(paths.size()); ++p)
+    {
+        for (const PathComponent::Waypoint* waypoint : paths[p]->GetPoints())
+        {
+            waypointIndices[waypoint] = static_cast<uint32>(positions.size());
+            positions.push_back(waypoint->position);
+            waypointPropertySets.push_back(intern(waypoint->GetProperties()));
+            waypointPaths.push_back(p);
+        }
+
+        pathNames.push_back(paths[p]->GetName());
+        pathOffsets.push_back(static_cast<uint32>(positions.size()));
+    }
+
+    Vector<BuildEdge> edges;
+    for (const PathComponent* path : paths)
+    {
+        for (const PathComponent::Waypoint* waypoint : path->GetPoints())
+        {
+            uint32 from = waypointIndices[waypoint];
+            for (const PathComponent::Edge* edge : waypoint->edges)
+            {
+                auto destination = waypointIndices.find(edge->destination);
+                if (destination == waypointIndices.end())
+                {
+                    DVASSERT(false, "Edge destination doesn't belong to any path");
+                    continue;
+                }
+
+                const KeyedArchive* properties = edge->GetProperties();
+                float32 costScale = 1.f;
+                if (params.costProperty.IsValid() && properties != nullptr && properties->IsKeyExists(params.costProperty.c_str()))
+                {
+                    costScale = properties->GetFloat(params.costProperty.c_str());
+                    DVASSERT(costScale >= 0.f);
+                }
+
+                float32 length = Distance(positions[from], positions[destination->second]);
+                edges.push_back({ from, destination->second, length * costScale, intern(properties) });
+            }
+        }
+    }
+
+    BuildSpatialIndex();
+
+    if (params.linkDistance > 0.f && !positions.empty())
+    {
+        // link waypoints of different paths, every pair is found once from the waypoint with lower index
+        float32 linkDistanceSquare = params.linkDistance * params.linkDistance;
+        int32 cellRadius = static_cast<int32>(std::ceil(params.linkDistance / cellSize));
+        for (uint32 w = 0; w < static_cast<uint32>(positions.size()); ++w)
+        {
+            int32 cx, cy;
+            GetCell(positions[w], cx, cy);
+            for (int32 y = std::max(0, cy - cellRadius); y <= std::min(rows - 1, cy + cellRadius); ++y)
+            {
+                for (int32 x = std::max(0, cx - cellRadius); x <= std::min(columns - 1, cx + cellRadius); ++x)
+                {
+                    int32 cell = y * columns + x;
+                    for (uint32 i = cellOffsets[cell]; i < cellOffsets[cell + 1]; ++i)
+                    {
+                        uint32 other = cellWaypoints[i];
+                        if (other > w && waypointPaths[other] != waypointPaths[w])
+                        {
+                            float32 distanceSquare = (positions[w] - positions[other]).SquareLength();
+                            if (distanceSquare <= linkDistanceSquare)
+                            {
+                                float32 distance = std::sqrt(distanceSquare);
+                                edges.push_back({ w, other, distance, EMPTY_PROPERTY_SET });
+                                edges.push_back({ other, w, distance, EMPTY_PROPERTY_SET });
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    BuildEdges(edges);
+}
+
+uint32 WaypointGraph::InternPropertySet(const KeyedArchive* properties, UnorderedMap<String, uint32>& internedSets)
+{
+    String key;
+    if (properties != nullptr && properties->Count() > 0)
+    {
+        key.resize(properties->Save(nullptr, 0));
+        properties->Save(reinterpret_cast<uint8*>(&key[0]), static_cast<uint32>(key.size()));
+    }
+
+    auto found = internedSets.find(key);
+    if (found != internedSets.end())
+        return found->second;
+
+    uint32 propertySet = static_cast<uint32>(propertySets.size());
+    propertySets.emplace_back(key.empty() ? new KeyedArchive() : new KeyedArchive(*properties));
+    internedSets.emplace(std::move(key), propertySet);
+    return propertySet;
+}
+
+void WaypointGraph::BuildEdges(Vector<BuildEdge>& edges)
+{
+    uint32 waypointsCount = static_cast<uint32>(positions.size());
+    uint32 edgesCount = static_cast<uint32>(edges.size());
+
+    edgeOffsets.assign(waypointsCount + 1, 0);
+    for (const BuildEdge& edge : edges)
+    {
+        ++edgeOffsets[edge.from + 1];
+    }
+    for (uint32 w = 0; w < waypointsCount; ++w)
+    {
+        edgeOffsets[w + 1] += edgeOffsets[w];
+    }
+
+    edgeDestinations.resize(edgesCount);
+    edgeCosts.resize(edgesCount);
+    edgePropertySets.resize(edgesCount);
+    minCostPerDistance = std::numeric_limits<float32>::max();
+
+    Vector<uint32> fill(edgeOffsets.begin(), edgeOffsets.end() - 1);
+    for (const BuildEdge& edge : edges)
+    {
+        uint32 index = fill[edge.from]++;
+        edgeDestinations[index] = edge.to;
+        edgeCosts[index] = edge.cost;
+        edgePropertySets[index] = edge.propertySet;
+
+        float32 distance = Distance(positions[edge.from], positions[edge.to]);
+        if (distance > std::numeric_limits<float32>::epsilon())
+        {
+            minCostPerDistance = std::min(minCostPerDistance, edge.cost / distance);
+        }
+    }
+
+    if (minCostPerDistance == std::numeric_limits<float32>::max())
+    {
+        minCostPerDistance = 1.f;
+    }
+}
+
+void WaypointGraph::BuildSpatialIndex()
+{
+    bbox.Empty();
+    for (const Vector3& position : positions)
+    {
+        bbox.AddPoint(position);
+    }
+
+    uint32 waypointsCount = static_cast<uint32>(positions.size());
+    if (waypointsCount == 0)
+    {
+        columns = rows = 0;
+        cellOffsets.assign(1, 0);
+        cellWaypoints.clear();
+        return;
+    }
+
+    // about 4 waypoints per cell for uniformly distributed waypoints
+    Vector3 size = bbox.GetSize();
+    float32 area = std::max(size.x, 1.f) * std::max(size.y, 1.f);
+    cellSize = std::max(2.f * std::sqrt(area / waypointsCount), 0.01f);
+    while (true)
+    {
+        columns = static_cast<int32>(size.x / cellSize) + 1;
+        rows = static_cast<int32>(size.y / cellSize) + 1;
+        if (static_cast<uint32>(columns) * static_cast<uint32>(rows) <= 2 * waypointsCount + 16)
+            break;
+        cellSize *= 2.f;
+    }
+
+    cellOffsets.assign(columns * rows + 1, 0);
+    Vector<uint32> waypointCells(waypointsCount);
+    for (uint32 w = 0; w < waypointsCount; ++w)
+    {
+        int32 x, y;
+        GetCell(positions[w], x, y);
+        waypointCells[w] = y * columns + x;
+        ++cellOffsets[waypointCells[w] + 1];
+    }
+    for (int32 cell = 0; cell < columns * rows; ++cell)
+    {
+        cellOffsets[cell + 1] += cellOffsets[cell];
+    }
+
+    cellWaypoints.resize(waypointsCount);
+    Vector<uint32> fill(cellOffsets.begin(), cellOffsets.end() - 1);
+    for (uint32 w = 0; w < waypointsCount; ++w)
+    {
+        cellWaypoints[fill[waypointCells[w]]++] = w;
+    }
+}
+
+void WaypointGraph::GetCell(const Vector3& position, int32& x, int32& y) const
+{
+    float32 fx = (position.x - bbox.min.x) / cellSize;
+    float32 fy = (position.y - bbox.min.y) / cellSize;
+    x = fx <= 0.f ? 0 : std::min(static_cast<int32>(fx), columns - 1);
+    y = fy <= 0.f ? 0 : std::min(static_cast<int32>(fy), rows - 1);
+}
+
+uint32 WaypointGraph::GetWaypoint(uint32 path, uint32 pathWaypoint) const
+{
+    if (path >= GetPathCount() || pathOffsets[path] + pathWaypoint >= pathOffsets[path + 1])
+        return INVALID_WAYPOINT;
+
+    return pathOffsets[path] + pathWaypoint;
+}
+
+uint32 WaypointGraph::FindNearestWaypoint(const Vector3& position, float32 maxDistance, const WaypointCostFilter* filter) const
+{
+    if (positions.empty())
+        return INVALID_WAYPOINT;
+
+    int32 cx, cy;
+    GetCell(position, cx, cy);
+
+    uint32 nearest = INVALID_WAYPOINT;
+    float32 nearestDistanceSquare = (maxDistance < std::sqrt(std::numeric_limits<float32>::max())) ? maxDistance * maxDistance : std::numeric_limits<float32>::max();
+
+    auto visitCell = [&](int32 x, int32 y) {
+        int32 cell = y * columns + x;
+        for (uint32 i = cellOffsets[cell]; i < cellOffsets[cell + 1]; ++i)
+        {
+            uint32 w = cellWaypoints[i];
+            float32 distanceSquare = (position - positions[w]).SquareLength();
+            if (distanceSquare <= nearestDistanceSquare && (filter == nullptr || filter->IsWaypointAllowed(waypointPropertySets[w])))
+            {
+                nearest = w;
+                nearestDistanceSquare = distanceSquare;
+            }
+        }
+    };
+
+    // Visit rings of cells around the start cell until the nearest not visited cell is further than found waypoint
+    for (int32 r = 0;; ++r)
+    {
+        int32 x0 = cx - r, x1 = cx + r, y0 = cy - r, y1 = cy + r;
+        for (int32 x = std::max(0, x0); x <= std::min(columns - 1, x1); ++x)
+        {
+            if (y0 >= 0)
+                visitCell(x, y0);
+            if (y1 < rows && y1 != y0)
+                visitCell(x, y1);
+        }
+        for (int32 y = std::max(0, y0 + 1); y <= std::min(rows - 1, y1 - 1); ++y)
+        {
+            if (x0 >= 0)
+                visitCell(x0, y);
+            if (x1 < columns && x1 != x0)
+                visitCell(x1, y);
+        }
+
+        float32 bound = std::numeric_limits<float32>::max();
+        if (x0 > 0)
+            bound = std::min(bound, position.x - (bbox.min.x + x0 * cellSize));
+        if (x1 < columns - 1)
+            bound = std::min(bound, bbox.min.x + (x1 + 1) * cellSize - position.x);
+        if (y0 > 0)
+            bound = std::min(bound, position.y - (bbox.min.y + y0 * cellSize));
+        if (y1 < rows - 1)
+            bound = std::min(bound, bbox.min.y + (y1 + 1) * cellSize - position.y);
+
+        if (bound == std::numeric_limits<float32>::max() || (bound > 0.f && bound * bound > nearestDistanceSquare))
+            break;
+    }
+
+    return nearest;
+}
+
+bool WaypointGraph::Save(const FilePath& filePath) const
+{
+    using namespace WaypointGraphDetails;
+
+    ScopedPtr<File> file(File::Create(filePath, File::CREATE | File::WRITE));
+    if (!file)
+    {
+        Logger::Error("[WaypointGraph] Can't create %s", filePath.GetStringValue().c_str());
+        return false;
+    }
+
+    FileHeader header;
+    header.signature = FILE_SIGNATURE;
+    header.version = CURRENT_VERSION;
+    header.waypointsCount = GetWaypointCount();
+    header.edgesCount = GetEdgeCount();
+    header.propertySetsCount = GetPropertySetCount();
+    header.pathsCount = GetPathCount();
+    header.minCostPerDistance = minCostPerDistance;
+
+    bool written = file->Write(&header) == sizeof(header)
+    && WriteVector(file, positions) && WriteVector(file, waypointPropertySets) && WriteVector(file, waypointPaths)
+    && WriteVector(file, edgeOffsets) && WriteVector(file, edgeDestinations) && WriteVector(file, edgeCosts) && WriteVector(file, edgePropertySets)
+    && WriteVector(file, pathOffsets);
+
+    for (uint32 p = 0; written && p < header.pathsCount; ++p)
+    {
+        written = WriteString(file, pathNames[p].IsValid() ? pathNames[p].c_str() : "");
+    }
+
+    for (uint32 s = 0; written && s < header.propertySetsCount; ++s)
+    {
+        Vector<uint8> data(propertySets[s]->Save(nullptr, 0));
+        propertySets[s]->Save(data.data(), static_cast<uint32>(data.size()));
+        uint32 size = static_cast<uint32>(data.size());
+        written = file->Write(&size) == sizeof(size) && WriteVector(file, data);
+    }
+
+    if (!written)
+    {
+        Logger::Error("[WaypointGraph] Can't write %s", filePath.GetStringValue().c_str());
+    }
+    return written;
+}
+
+bool WaypointGraph::Load(const FilePath& filePath)
+{
+    using namespace WaypointGraphDetails;
+
+    Build(Vector<PathComponent*>());
+
+    ScopedPtr<File> file(File::Create(filePath, File::OPEN | File::READ));
+    if (!file)
+    {
+        Logger::Error("[WaypointGraph] Can't open %s", filePath.GetStringValue().c_str());
+        return false;
+    }
+
+    FileHeader header;
+    if (file->Read(&header) != sizeof(header) || header.signature != FILE_SIGNATURE || header.version != CURRENT_VERSION)
+    {
+        Logger::Error("[WaypointGraph] %s has unsupported format", filePath.GetStringValue().c_str());
+        return false;
+    }
+
+    bool valid = ReadVector(file, positions, header.waypointsCount) && ReadVector(file, waypointPropertySets, header.waypointsCount)
+    && ReadVector(file, waypointPaths, header.waypointsCount) && ReadVector(file, edgeOffsets, header.waypointsCount + 1)
+    && ReadVector(file, edgeDestinations, header.edgesCount) && ReadVector(file, edgeCosts, header.edgesCount)
+    && ReadVector(file, edgePropertySets, header.edgesCount) && ReadVector(file, pathOffsets, header.pathsCount + 1);
+
+    pathNames.resize(header.pathsCount);
+    for (uint32 p = 0; valid && p < header.pathsCount; ++p)
+    {
+        String name;
+        valid = ReadString(file, name);
+        pathNames[p] = name.empty() ? FastName() : FastName(name);
+    }
+
+    propertySets.clear();
+    for (uint32 s = 0; valid && s < header.propertySetsCount; ++s)
+    {
+        uint32 size = 0;
+        Vector<uint8> data;
+        RefPtr<KeyedArchive> properties(new KeyedArchive());
+        valid = file->Read(&size) == sizeof(size) && size <= file->GetSize() && ReadVector(file, data, size) && properties->Load(data.data(), size);
+        propertySets.push_back(properties);
+    }
+
+    // validate indices, so queries don't need to check them
+    valid = valid && header.propertySetsCount > 0 && edgeOffsets.front() == 0 && edgeOffsets.back() == header.edgesCount;
+    valid = valid && pathOffsets.front() == 0 && pathOffsets.back() == header.waypointsCount;
+    for (uint32 w = 0; valid && w < header.waypointsCount; ++w)
+    {
+        valid = edgeOffsets[w] <= edgeOffsets[w + 1] && waypointPropertySets[w] < header.propertySetsCount && waypointPaths[w] < header.pathsCount;
+    }
+    for (uint32 e = 0; valid && e < header.edgesCount; ++e)
+    {
+        valid = edgeDestinations[e] < header.waypointsCount && edgePropertySets[e] < header.propertySetsCount && edgeCosts[e] >= 0.f;
+    }
+
+    if (!valid)
+    {
+        Logger::Error("[WaypointGraph] %s is corrupted", filePath.GetStringValue().c_str());
+        Build(Vector<PathComponent*>());
+        return false;
+    }
+
+    minCostPerDistance = header.minCostPerDistance;
+    BuildSpatialIndex();
+    return true;
+}
+} // namespace DAVA
@@ -0,0 +1,497 @@
+#include "UnitTests/UnitTests.h"
+
+#include "Base/RefPtr.h"
+#include "Base/ScopedPtr.h"
+#include "Concurrency/Thread.h"
+#include "Engine/Engine.h"
+#include "FileSystem/FileSystem.h"
+#include "FileSystem/KeyedArchive.h"
+#include "Job/JobManager.h"
+#include "Logger/Logger.h"
+#include "Scene3D/Components/Waypoint/PathComponent.h"
+#include "Scene3D/Waypoint/WaypointGraph.h"
+#include "Scene3D/Waypoint/WaypointPathFinder.h"
+#include "Scene3D/Waypoint/WaypointPathScheduler.h"
+#include "Time/SystemTimer.h"
+
+#include <random>
+
+using namespace DAVA;
+
+namespace WaypointGraphTestDetails
+{
+const FastName COST_PROPERTY("cost");
+const String TYPE_PROPERTY("type");
+
+// Jittered grid of waypoints with two-way edges between neighbours, some edges are missing.
+// Edge properties are shared between edges, so graph has only a few property sets.
+std::unique_ptr<PathComponent> CreateGridPath(uint32 columns, uint32 rows, uint32 seed, const FastName& name = FastName("grid"))
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float32> jitter(-0.3f, 0.3f);
+    std::uniform_int_distribution<uint32> percent(0, 99);
+
+    ScopedPtr<KeyedArchive> road(new KeyedArchive());
+    road->SetString(TYPE_PROPERTY, "road");
+    road->SetFloat(COST_PROPERTY.c_str(), 1.f);
+    ScopedPtr<KeyedArchive> dirt(new KeyedArchive());
+    dirt->SetString(TYPE_PROPERTY, "dirt");
+    dirt->SetFloat(COST_PROPERTY.c_str(), 2.5f);
+    ScopedPtr<KeyedArchive> rail(new KeyedArchive());
+    rail->SetString(TYPE_PROPERTY, "rail");
+    rail->SetFloat(COST_PROPERTY.c_str(), 0.5f);
+    ScopedPtr<KeyedArchive> closed(new KeyedArchive());
+    closed->SetBool("closed", true);
+
+    std::unique_ptr<PathComponent> path(new PathComponent());
+    path->SetName(name);
+    for (uint32 y = 0; y < rows; ++y)
+    {
+        for (uint32 x = 0; x < columns; ++x)
+        {
+            PathComponent::Waypoint* waypoint = new PathComponent::Waypoint();
+            waypoint->name = name;
+            waypoint->position = Vector3(x * 2.f + jitter(random), y * 2.f + jitter(random), 0.f);
+            if (percent(random) < 3)
+            {
+                waypoint->SetProperties(closed);
+            }
+            path->AddPoint(waypoint);
+        }
+    }
+
+    const Vector<PathComponent::Waypoint*>& points = path->GetPoints();
+    auto connect = [&](uint32 from, uint32 to) {
+        uint32 kind = percent(random);
+        if (kind < 10)
+            return; // missing edge
+
+        KeyedArchive* properties = (kind < 60) ? road.get() : (kind < 85 ? dirt.get() : rail.get());
+        for (int32 i = 0; i < 2; ++i)
+        {
+            PathComponent::Edge* edge = new PathComponent::Edge();
+            edge->SetProperties(properties);
+            edge->destination = points[i == 0 ? to : from];
+            points[i == 0 ? from : to]->AddEdge(edge);
+        }
+    };
+
+    for (uint32 y = 0; y < rows; ++y)
+    {
+        for (uint32 x = 0; x < columns; ++x)
+        {
+            uint32 w = y * columns + x;
+            if (x + 1 < columns)
+                connect(w, w + 1);
+            if (y + 1 < rows)
+                connect(w, w + columns);
+        }
+    }
+
+    return path;
+}
+
+RefPtr<WaypointGraph> BuildGraph(const Vector<PathComponent*>& paths, float32 linkDistance = 0.f)
+{
+    WaypointGraph::BuildParams params;
+    params.costProperty = COST_PROPERTY;
+    params.linkDistance = linkDistance;
+
+    RefPtr<WaypointGraph> graph(new WaypointGraph());
+    graph->Build(paths, params);
+    return graph;
+}
+
+RefPtr<WaypointCostFilter> CreateNoRailFilter(const WaypointGraph* graph)
+{
+    return RefPtr<WaypointCostFilter>(new WaypointCostFilter(graph,
+                                                             [](const KeyedArchive* properties) { return properties->GetString(TYPE_PROPERTY) == "rail" ? -1.f : 1.f; },
+                                                             [](const KeyedArchive* properties) { return !properties->GetBool("closed"); }));
+}
+
+// Checks that path follows graph edges allowed by filter and its cost is the sum of edge costs
+bool IsValidPath(const WaypointGraph* graph, const WaypointPathFinder::Query& query, const WaypointPathFinder::Result& result)
+{
+    if (!result.found || result.waypoints.empty() || result.waypoints.front() != query.from || result.waypoints.back() != query.to)
+        return false;
+
+    const WaypointCostFilter* filter = query.filter.Get();
+    float32 cost = 0.f;
+    for (size_t i = 1; i < result.waypoints.size(); ++i)
+    {
+        uint32 from = result.waypoints[i - 1];
+        uint32 to = result.waypoints[i];
+        if (filter != nullptr && !filter->IsWaypointAllowed(graph->GetWaypointPropertySet(to)))
+            return false;
+
+        float32 bestEdgeCost = std::numeric_limits<float32>::infinity();
+        for (uint32 e = graph->GetEdgesBegin(from); e < graph->GetEdgesEnd(from); ++e)
+        {
+            if (graph->GetEdgeDestination(e) == to)
+            {
+                float32 scale = filter != nullptr ? filter->GetEdgeCostScale(graph->GetEdgePropertySet(e)) : 1.f;
+                if (scale >= 0.f)
+                    bestEdgeCost = std::min(bestEdgeCost, graph->GetEdgeCost(e) * scale);
+            }
+        }
+        if (bestEdgeCost == std::numeric_limits<float32>::infinity())
+            return false;
+
+        cost += bestEdgeCost;
+    }
+
+    return std::abs(cost - result.cost) <= 1e-3f * std::max(1.f, cost);
+}
+
+Vector<WaypointPathFinder::Query> CreateQueries(const WaypointGraph* graph, uint32 count, uint32 seed, const RefPtr<WaypointCostFilter>& filter)
+{
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<uint32> waypoint(0, graph->GetWaypointCount() - 1);
+
+    Vector<WaypointPathFinder::Query> queries(count);
+    for (WaypointPathFinder::Query& query : queries)
+    {
+        query.from = waypoint(random);
+        query.to = waypoint(random);
+        query.filter = filter;
+    }
+    return queries;
+}
+
+template <typename Predicate>
+bool WaitFor(Predicate predicate)
+{
+    JobManager* jobManager = GetEngineContext()->jobManager;
+    for (int32 i = 0; i < 60000 && !predicate(); ++i)
+    {
+        jobManager->Update();
+        Thread::Sleep(1);
+    }
+    return predicate();
+}
+}
+
+DAVA_TESTCLASS (WaypointGraphTest)
+{
+    DAVA_TEST (CompiledGraphTest)
+    {
+        using namespace WaypointGraphTestDetails;
+
+        std::unique_ptr<PathComponent> path = CreateGridPath(20, 10, 1);
+        RefPtr<WaypointGraph> graph = BuildGraph({ path.get() });
+
+        TEST_VERIFY(graph->GetWaypointCount() == 200);
+        TEST_VERIFY(graph->GetPathCount() == 1 && graph->GetPathName(0) == FastName("grid"));
+        TEST_VERIFY(graph->GetPropertySetCount() == 5); // empty, closed, road, dirt, rail
+
+        const Vector<PathComponent::Waypoint*>& points = path->GetPoints();
+        uint32 edgesCount = 0;
+        for (uint32 w = 0; w < static_cast<uint32>(points.size()); ++w)
+        {
+            TEST_VERIFY(graph->GetWaypoint(0, w) == w);
+            TEST_VERIFY(graph->GetWaypointPosition(w) == points[w]->position);
+            TEST_VERIFY(graph->GetEdgesEnd(w) - graph->GetEdgesBegin(w) == points[w]->edges.size());
+            for (uint32 e = 0; e < static_cast<uint32>(points[w]->edges.size()); ++e)
+            {
+                uint32 edge = graph->GetEdgesBegin(w) + e;
+                TEST_VERIFY(graph->GetWaypointPosition(graph->GetEdgeDestination(edge)) == points[w]->edges[e]->destination->position);
+
+                float32 length = Distance(points[w]->position, points[w]->edges[e]->destination->position);
+                float32 expectedCost = length * points[w]->edges[e]->GetProperties()->GetFloat(COST_PROPERTY.c_str());
+                TEST_VERIFY(std::abs(graph->GetEdgeCost(edge) - expectedCost) < 1e-4f);
+            }
+            edgesCount += static_cast<uint32>(points[w]->edges.size());
+        }
+        TEST_VERIFY(graph->GetEdgeCount() == edgesCount);
+
+        // nearest waypoint matches brute force search, including points outside of the graph
+        std::mt19937 random(2);
+        std::uniform_real_distribution<float32> coordinate(-10.f, 50.f);
+        RefPtr<WaypointCostFilter> filter = CreateNoRailFilter(graph.Get());
+        for (int32 i = 0; i < 500; ++i)
+        {
+            Vector3 position(coordinate(random), coordinate(random), coordinate(random) * 0.1f);
+            for (const WaypointCostFilter* f : Vector<const WaypointCostFilter*>{ nullptr, filter.Get() })
+            {
+                uint32 expected = WaypointGraph::INVALID_WAYPOINT;
+                float32 expectedDistance = std::numeric_limits<float32>::max();
+                float32 secondDistance = std::numeric_limits<float32>::max();
+                for (uint32 w = 0; w < graph->GetWaypointCount(); ++w)
+                {
+                    if (f != nullptr && !f->IsWaypointAllowed(graph->GetWaypointPropertySet(w)))
+                    {
+                        continue;
+                    }
+
+                    float32 distance = Distance(position, graph->GetWaypointPosition(w));
+                    if (distance < expectedDistance)
+                    {
+                        expected = w;
+                        secondDistance = expectedDistance;
+                        expectedDistance = distance;
+                    }
+                    else if (distance < secondDistance)
+                    {
+                        secondDistance = distance;
+                    }
+                }
+
+                uint32 nearest = graph->FindNearestWaypoint(position, std::numeric_limits<float32>::max(), f);
+                TEST_VERIFY(nearest != WaypointGraph::INVALID_WAYPOINT);
+                TEST_VERIFY(std::abs(Distance(position, graph->GetWaypointPosition(nearest)) - expectedDistance) < 1e-4f);
+                if (secondDistance - expectedDistance > 1e-4f)
+                {
+                    // not tied with other waypoint
+                    TEST_VERIFY(nearest == expected);
+                }
+                TEST_VERIFY(graph->FindNearestWaypoint(position, expectedDistance * 0.9f, f) == WaypointGraph::INVALID_WAYPOINT);
+            }
+        }
+    }
+
+    DAVA_TEST (PathCorrectnessTest)
+    {
+        using namespace WaypointGraphTestDetails;
+
+        std::unique_ptr<PathComponent> path = CreateGridPath(40, 30, 3);
+        RefPtr<WaypointGraph> graph = BuildGraph({ path.get() });
+        RefPtr<WaypointCostFilter> filter = CreateNoRailFilter(graph.Get());
+
+        WaypointPathFinder finder(graph.Get());
+        uint32 foundCount = 0;
+        uint32 astarExpanded = 0;
+        uint32 dijkstraExpanded = 0;
+        for (const RefPtr<WaypointCostFilter>& f : { RefPtr<WaypointCostFilter>(), filter })
+        {
+            for (WaypointPathFinder::Query query : CreateQueries(graph.Get(), 200, 4, f))
+            {
+                Vector<float32> costs;
+                finder.FindCosts(query.from, f.Get(), costs);
+
+                WaypointPathFinder::Result astar, dijkstra;
+                query.algorithm = WaypointPathFinder::ASTAR;
+                bool astarFound = finder.FindPath(query, astar);
+                TEST_VERIFY(!astarFound || IsValidPath(graph.Get(), query, astar));
+
+                query.algorithm = WaypointPathFinder::DIJKSTRA;
+                bool dijkstraFound = finder.FindPath(query, dijkstra);
+                TEST_VERIFY(!dijkstraFound || IsValidPath(graph.Get(), query, dijkstra));
+
+                // both algorithms find optimal path
+                TEST_VERIFY(astarFound == dijkstraFound);
+                TEST_VERIFY(astarFound == (costs[query.to] != std::numeric_limits<float32>::infinity()));
+                if (astarFound)
+                {
+                    TEST_VERIFY(std::abs(astar.cost - costs[query.to]) <= 1e-3f * std::max(1.f, costs[query.to]));
+                    TEST_VERIFY(std::abs(dijkstra.cost - costs[query.to]) <= 1e-3f * std::max(1.f, costs[query.to]));
+                    ++foundCount;
+                    astarExpanded += astar.expandedCount;
+                    dijkstraExpanded += dijkstra.expandedCount;
+                }
+
+                // filtered paths never use rail edges or closed waypoints
+                if (f.Get() != nullptr && astarFound)
+                {
+                    for (size_t i = 1; i < astar.waypoints.size(); ++i)
+                    {
+                        TEST_VERIFY(!graph->GetPropertySet(graph->GetWaypointPropertySet(astar.waypoints[i]))->GetBool("closed"));
+                    }
+                }
+            }
+        }
+
+        TEST_VERIFY(foundCount > 200);
+        TEST_VERIFY(astarExpanded < dijkstraExpanded);
+
+        // unreachable target and invalid waypoints
+        WaypointPathFinder::Query query;
+        query.from = 0;
+        query.to = graph->GetWaypointCount();
+        WaypointPathFinder::Result result;
+        TEST_VERIFY(!finder.FindPath(query, result) && !result.found);
+
+        RefPtr<WaypointCostFilter> blockAll(new WaypointCostFilter(graph.Get(), [](const KeyedArchive*) { return -1.f; }));
+        query.to = 1;
+        query.filter = blockAll;
+        TEST_VERIFY(!finder.FindPath(query, result));
+        query.to = 0;
+        TEST_VERIFY(finder.FindPath(query, result) && result.waypoints.size() == 1 && result.cost == 0.f);
+    }
+
+    DAVA_TEST (LinkedPathsTest)
+    {
+        using namespace WaypointGraphTestDetails;
+
+        // second grid starts next to the end of the first one
+        std::unique_ptr<PathComponent> first = CreateGridPath(10, 10, 5, FastName("first"));
+        std::unique_ptr<PathComponent> second = CreateGridPath(10, 10, 6, FastName("second"));
+        for (PathComponent::Waypoint* waypoint : second->GetPoints())
+        {
+            waypoint->position.x += 20.f;
+        }
+
+        RefPtr<WaypointGraph> separate = BuildGraph({ first.get(), second.get() });
+        RefPtr<WaypointGraph> linked = BuildGraph({ first.get(), second.get() }, 2.5f);
+        TEST_VERIFY(linked->GetEdgeCount() > separate->GetEdgeCount());
+
+        WaypointPathFinder::Query query;
+        query.from = linked->GetWaypoint(0, 0);
+        query.to = linked->GetWaypoint(1, 99);
+        TEST_VERIFY(linked->GetWaypointPath(query.to) == 1);
+
+        WaypointPathFinder::Result result;
+        TEST_VERIFY(!WaypointPathFinder(separate.Get()).FindPath(query, result));
+        TEST_VERIFY(WaypointPathFinder(linked.Get()).FindPath(query, result));
+        TEST_VERIFY(IsValidPath(linked.Get(), query, result));
+    }
+
+    DAVA_TEST (SaveLoadTest)
+    {
+        using namespace WaypointGraphTestDetails;
+
+        FileSystem* fs = GetEngineContext()->fileSystem;
+        FilePath graphPath = fs->GetTempDirectoryPath();
+        graphPath.MakeDirectoryPathname();
+        graphPath += "WaypointGraphTest.wpg";
+
+        std::unique_ptr<PathComponent> path = CreateGridPath(30, 20, 7);
+        RefPtr<WaypointGraph> graph = BuildGraph({ path.get() });
+        TEST_VERIFY(graph->Save(graphPath));
+
+        RefPtr<WaypointGraph> loaded(new WaypointGraph());
+        TEST_VERIFY(loaded->Load(graphPath));
+        fs->DeleteFile(graphPath);
+
+        TEST_VERIFY(loaded->GetWaypointCount() == graph->GetWaypointCount());
+        TEST_VERIFY(loaded->GetEdgeCount() == graph->GetEdgeCount());
+        TEST_VERIFY(loaded->GetPropertySetCount() == graph->GetPropertySetCount());
+        TEST_VERIFY(loaded->GetPathName(0) == graph->GetPathName(0));
+        for (uint32 s = 0; s < graph->GetPropertySetCount(); ++s)
+        {
+            TEST_VERIFY(loaded->GetPropertySet(s)->GetString(TYPE_PROPERTY) == graph->GetPropertySet(s)->GetString(TYPE_PROPERTY));
+        }
+
+        // filters are evaluated per graph, results must be the same
+        WaypointPathFinder finder(graph.Get());
+        WaypointPathFinder loadedFinder(loaded.Get());
+        Vector<WaypointPathFinder::Query> queries = CreateQueries(graph.Get(), 50, 8, CreateNoRailFilter(graph.Get()));
+        Vector<WaypointPathFinder::Query> loadedQueries = CreateQueries(loaded.Get(), 50, 8, CreateNoRailFilter(loaded.Get()));
+        for (size_t i = 0; i < queries.size(); ++i)
+        {
+            WaypointPathFinder::Result result, loadedResult;
+            finder.FindPath(queries[i], result);
+            loadedFinder.FindPath(loadedQueries[i], loadedResult);
+            TEST_VERIFY(result.found == loadedResult.found && result.waypoints == loadedResult.waypoints);
+        }
+
+        TEST_VERIFY(!loaded->Load(graphPath));
+        TEST_VERIFY(loaded->GetWaypointCount() == 0);
+    }
+
+    DAVA_TEST (BatchedQueriesTest)
+    {
+        using namespace WaypointGraphTestDetails;
+
+        std::unique_ptr<PathComponent> path = CreateGridPath(30, 30, 9);
+        RefPtr<WaypointGraph> graph = BuildGraph({ path.get() });
+        Vector<WaypointPathFinder::Query> queries = CreateQueries(graph.Get(), 500, 10, CreateNoRailFilter(graph.Get()));
+
+        WaypointPathScheduler scheduler(graph.Get(), 16);
+
+        bool delivered = false;
+        bool deliveredOnMainThread = false;
+        Vector<WaypointPathFinder::Result> results;
+        uint32 batch = scheduler.Submit(queries, [&](Vector<WaypointPathFinder::Result>& r) {
+            delivered = true;
+            deliveredOnMainThread = Thread::IsMainThread();
+            results.swap(r);
+        });
+        TEST_VERIFY(scheduler.IsPending(batch));
+
+        bool cancelledDelivered = false;
+        uint32 cancelled = scheduler.Submit(queries, [&](Vector<WaypointPathFinder::Result>&) { cancelledDelivered = true; });
+        scheduler.Cancel(cancelled);
+
+        TEST_VERIFY(WaitFor([&]() { return delivered; }));
+        TEST_VERIFY(deliveredOnMainThread);
+        TEST_VERIFY(!scheduler.IsPending(batch));
+        TEST_VERIFY(results.size() == queries.size());
+
+        WaypointPathFinder finder(graph.Get());
+        for (size_t i = 0; i < queries.size(); ++i)
+        {
+            WaypointPathFinder::Result expected;
+            finder.FindPath(queries[i], expected);
+            TEST_VERIFY(results[i].found == expected.found && results[i].waypoints == expected.waypoints);
+        }
+
+        GetEngineContext()->jobManager->WaitWorkerJobs();
+        GetEngineContext()->jobManager->Update();
+        TEST_VERIFY(!cancelledDelivered);
+        TEST_VERIFY(scheduler.GetPendingCount() == 0);
+    }
+
+    DAVA_TEST (QueriesBenchmark)
+    {
+        using namespace WaypointGraphTestDetails;
+
+        const uint32 queriesCount = 10000;
+
+        int64 startTime = SystemTimer::GetUs();
+        std::unique_ptr<PathComponent> path = CreateGridPath(250, 200, 11);
+        int64 createTime = SystemTimer::GetUs() - startTime;
+
+        startTime = SystemTimer::GetUs();
+        RefPtr<WaypointGraph> graph = BuildGraph({ path.get() });
+        int64 buildTime = SystemTimer::GetUs() - startTime;
+        TEST_VERIFY(graph->GetWaypointCount() == 50000);
+
+        // short and medium range queries, like bots looking for a way to the nearby goal
+        std::mt19937 random(12);
+        std::uniform_int_distribution<int32> offset(-40, 40);
+        RefPtr<WaypointCostFilter> filter = CreateNoRailFilter(graph.Get());
+        Vector<WaypointPathFinder::Query> queries(queriesCount);
+        for (WaypointPathFinder::Query& query : queries)
+        {
+            int32 x = offset(random) + 125, y = offset(random) + 100;
+            query.from = static_cast<uint32>(y * 250 + x);
+            query.to = graph->FindNearestWaypoint(graph->GetWaypointPosition(query.from) + Vector3(offset(random) * 2.f, offset(random) * 2.f, 0.f));
+            query.filter = filter;
+        }
+
+        startTime = SystemTimer::GetUs();
+        WaypointPathFinder finder(graph.Get());
+        Vector<WaypointPathFinder::Result> expected(queriesCount);
+        uint32 foundCount = 0;
+        uint64 expandedCount = 0;
+        for (uint32 i = 0; i < queriesCount; ++i)
+        {
+            foundCount += finder.FindPath(queries[i], expected[i]) ? 1 : 0;
+            expandedCount += expected[i].expandedCount;
+        }
+        int64 syncTime = SystemTimer::GetUs() - startTime;
+
+        WaypointPathScheduler scheduler(graph.Get());
+        Vector<WaypointPathFinder::Result> results;
+        bool delivered = false;
+        startTime = SystemTimer::GetUs();
+        scheduler.Submit(queries, [&](Vector<WaypointPathFinder::Result>& r) {
+            results.swap(r);
+            delivered = true;
+        });
+        TEST_VERIFY(WaitFor([&]() { return delivered; }));
+        int64 asyncTime = SystemTimer::GetUs() - startTime;
+
+        TEST_VERIFY(foundCount > queriesCount / 2);
+        TEST_VERIFY(results.size() == queriesCount);
+        for (uint32 i = 0; i < queriesCount && i < results.size(); ++i)
+        {
+            TEST_VERIFY(results[i].waypoints == expected[i].waypoints);
+        }
+
+        Logger::Info("Waypoint graph benchmark (%u waypoints, %u edges, %u property sets): creating paths %lld us, compiling %lld us",
+                     graph->GetWaypointCount(), graph->GetEdgeCount(), graph->GetPropertySetCount(), createTime, buildTime);
+        Logger::Info("Waypoint path queries benchmark (%u queries, %u found, %.1f expanded per query): one thread %lld us, batched on %u workers %lld us",
+                     queriesCount, foundCount, float32(expandedCount) / queriesCount, syncTime, GetEngineContext()->jobManager->GetWorkersCount(), asyncTime);
+    }
+};
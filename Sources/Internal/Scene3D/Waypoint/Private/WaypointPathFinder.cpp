@@ -0,0 +1,201 @@
+#include "Scene3D/Waypoint/WaypointPathFinder.h"
+
+#include "Debug/DVAssert.h"
+
+#include <algorithm>
+
+namespace DAVA
+{
+namespace WaypointPathFinderDetails
+{
+// std heap is max-heap, so entry with lower priority is "greater". Ties are resolved in favour of deeper entries.
+bool OpenEntryLess(float32 lPriority, float32 lCost, float32 rPriority, float32 rCost)
+{
+    return lPriority > rPriority || (lPriority == rPriority && lCost < rCost);
+}
+}
+
+WaypointCostFilter::WaypointCostFilter(const WaypointGraph* graph, const EdgeCostScale& edgeCostScale, const WaypointPredicate& waypointPredicate)
+{
+    uint32 count = graph->GetPropertySetCount();
+    edgeCostScales.resize(count, 1.f);
+    allowedWaypoints.resize(count, 1);
+    for (uint32 s = 0; s < count; ++s)
+    {
+        const KeyedArchive* properties = graph->GetPropertySet(s);
+        if (edgeCostScale)
+        {
+            edgeCostScales[s] = edgeCostScale(properties);
+        }
+        if (waypointPredicate)
+        {
+            allowedWaypoints[s] = waypointPredicate(properties) ? 1 : 0;
+        }
+    }
+
+    minEdgeCostScale = std::numeric_limits<float32>::max();
+    for (float32 scale : edgeCostScales)
+    {
+        if (scale >= 0.f)
+        {
+            minEdgeCostScale = std::min(minEdgeCostScale, scale);
+        }
+    }
+    if (minEdgeCostScale == std::numeric_limits<float32>::max())
+    {
+        minEdgeCostScale = 1.f;
+    }
+}
+
+WaypointPathFinder::WaypointPathFinder(const WaypointGraph* graph_)
+    : graph(graph_)
+{
+    DVASSERT(graph != nullptr);
+}
+
+bool WaypointPathFinder::FindPath(const Query& query, Result& result)
+{
+    result.found = false;
+    result.cost = 0.f;
+    result.waypoints.clear();
+    result.expandedCount = 0;
+
+    uint32 waypointsCount = graph->GetWaypointCount();
+    if (query.from >= waypointsCount || query.to >= waypointsCount)
+        return false;
+
+    const WaypointCostFilter* filter = query.filter.Get();
+    float32 heuristicScale = 0.f;
+    if (query.algorithm == ASTAR)
+    {
+        heuristicScale = graph->GetMinCostPerDistance() * (filter != nullptr ? filter->GetMinEdgeCostScale() : 1.f);
+    }
+
+    uint32 reached = Search(query.from, query.to, heuristicScale, filter, std::numeric_limits<float32>::infinity());
+    result.expandedCount = expandedCount;
+    if (reached == WaypointGraph::INVALID_WAYPOINT)
+        return false;
+
+    for (uint32 w = reached; w != WaypointGraph::INVALID_WAYPOINT; w = parents[w])
+    {
+        result.waypoints.push_back(w);
+    }
+    std::reverse(result.waypoints.begin(), result.waypoints.end());
+
+    result.found = true;
+    result.cost = costs[reached];
+    return true;
+}
+
+void WaypointPathFinder::FindCosts(uint32 from, const WaypointCostFilter* filter, Vector<float32>& result, float32 maxCost)
+{
+    uint32 waypointsCount = graph->GetWaypointCount();
+    result.assign(waypointsCount, std::numeric_limits<float32>::infinity());
+    if (from >= waypointsCount)
+        return;
+
+    Search(from, WaypointGraph::INVALID_WAYPOINT, 0.f, filter, maxCost);
+    for (uint32 w = 0; w < waypointsCount; ++w)
+    {
+        if (stamps[w] == searchStamp)
+        {
+            result[w] = costs[w];
+        }
+    }
+}
+
+void WaypointPathFinder::NextSearch()
+{
+    uint32 waypointsCount = graph->GetWaypointCount();
+    if (stamps.size() != waypointsCount)
+    {
+        stamps.assign(waypointsCount, 0);
+        closedStamps.assign(waypointsCount, 0);
+        costs.resize(waypointsCount);
+        parents.resize(waypointsCount);
+        searchStamp = 0;
+    }
+
+    ++searchStamp;
+    if (searchStamp == 0)
+    {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        std::fill(closedStamps.begin(), closedStamps.end(), 0);
+        searchStamp = 1;
+    }
+
+    open.clear();
+    expandedCount = 0;
+}
+
+uint32 WaypointPathFinder::Search(uint32 from, uint32 to, float32 heuristicScale, const WaypointCostFilter* filter, float32 maxCost)
+{
+    using namespace WaypointPathFinderDetails;
+
+    NextSearch();
+
+    auto less = [](const OpenEntry& l, const OpenEntry& r) {
+        return OpenEntryLess(l.priority, l.cost, r.priority, r.cost);
+    };
+
+    const Vector3& target = (to != WaypointGraph::INVALID_WAYPOINT) ? graph->GetWaypointPosition(to) : Vector3::Zero;
+
+    stamps[from] = searchStamp;
+    costs[from] = 0.f;
+    parents[from] = WaypointGraph::INVALID_WAYPOINT;
+    open.push_back({ heuristicScale * Distance(graph->GetWaypointPosition(from), target), 0.f, from });
+
+    while (!open.empty())
+    {
+        std::pop_heap(open.begin(), open.end(), less);
+        OpenEntry entry = open.back();
+        open.pop_back();
+
+        uint32 w = entry.waypoint;
+        if (closedStamps[w] == searchStamp || entry.cost > costs[w])
+            continue; // outdated entry, waypoint was reached cheaper
+
+        closedStamps[w] = searchStamp;
+        ++expandedCount;
+
+        if (w == to)
+            return w;
+
+        for (uint32 e = graph->GetEdgesBegin(w), end = graph->GetEdgesEnd(w); e < end; ++e)
+        {
+            uint32 next = graph->GetEdgeDestination(e);
+            if (closedStamps[next] == searchStamp)
+                continue;
+
+            float32 edgeCost = graph->GetEdgeCost(e);
+            if (filter != nullptr)
+            {
+                float32 scale = filter->GetEdgeCostScale(graph->GetEdgePropertySet(e));
+                if (scale < 0.f || !filter->IsWaypointAllowed(graph->GetWaypointPropertySet(next)))
+                    continue;
+
+                edgeCost *= scale;
+            }
+
+            float32 cost = entry.cost + edgeCost;
+            if (cost > maxCost || (stamps[next] == searchStamp && cost >= costs[next]))
+                continue;
+
+            stamps[next] = searchStamp;
+            costs[next] = cost;
+            parents[next] = w;
+
+            float32 priority = cost;
+            if (heuristicScale > 0.f)
+            {
+                priority += heuristicScale * Distance(graph->GetWaypointPosition(next), target);
+            }
+
+            open.push_back({ priority, cost, next });
+            std::push_heap(open.begin(), open.end(), less);
+        }
+    }
+
+    return WaypointGraph::INVALID_WAYPOINT;
+}
+} // namespace DAVA
@@ -0,0 +1,149 @@
+#include "Scene3D/Waypoint/WaypointPathScheduler.h"
+
+#include "Concurrency/LockGuard.h"
+#include "Concurrency/Mutex.h"
+#include "Concurrency/Thread.h"
+#include "Debug/DVAssert.h"
+#include "Engine/Engine.h"
+#include "Job/JobManager.h"
+
+#include <atomic>
+
+namespace DAVA
+{
+struct WaypointPathScheduler::Batch
+{
+    uint32 id = 0;
+    Vector<WaypointPathFinder::Query> queries;
+    Vector<WaypointPathFinder::Result> results;
+    Callback callback;
+    std::atomic<uint32> remainingJobs{ 0 };
+    std::atomic<bool> cancelled{ false };
+};
+
+struct WaypointPathScheduler::SharedState
+{
+    RefPtr<WaypointGraph> graph;
+    JobManager* jobManager = nullptr;
+
+    // accessed only from the main thread
+    bool alive = true;
+    UnorderedMap<uint32, std::shared_ptr<Batch>> pendingBatches;
+
+    Mutex findersMutex;
+    Vector<std::unique_ptr<WaypointPathFinder>> finders;
+
+    std::unique_ptr<WaypointPathFinder> AcquireFinder()
+    {
+        LockGuard<Mutex> lock(findersMutex);
+        if (finders.empty())
+        {
+            return std::unique_ptr<WaypointPathFinder>(new WaypointPathFinder(graph.Get()));
+        }
+
+        std::unique_ptr<WaypointPathFinder> finder = std::move(finders.back());
+        finders.pop_back();
+        return finder;
+    }
+
+    void ReleaseFinder(std::unique_ptr<WaypointPathFinder> finder)
+    {
+        LockGuard<Mutex> lock(findersMutex);
+        finders.push_back(std::move(finder));
+    }
+
+    static void Deliver(const std::shared_ptr<SharedState>& state, const std::shared_ptr<Batch>& batch)
+    {
+        if (state->alive && state->pendingBatches.erase(batch->id) > 0 && !batch->cancelled)
+        {
+            batch->callback(batch->results);
+        }
+    }
+};
+
+WaypointPathScheduler::WaypointPathScheduler(WaypointGraph* graph, uint32 queriesPerJob_)
+    : state(std::make_shared<SharedState>())
+    , queriesPerJob(std::max(queriesPerJob_, 1u))
+{
+    DVASSERT(graph != nullptr);
+    state->graph = RefPtr<WaypointGraph>::ConstructWithRetain(graph);
+    state->jobManager = GetEngineContext()->jobManager;
+}
+
+WaypointPathScheduler::~WaypointPathScheduler()
+{
+    // running jobs keep shared state and graph alive, their results are dropped
+    for (auto& pending : state->pendingBatches)
+    {
+        pending.second->cancelled = true;
+    }
+    state->pendingBatches.clear();
+    state->alive = false;
+}
+
+uint32 WaypointPathScheduler::Submit(Vector<WaypointPathFinder::Query> queries, const Callback& callback)
+{
+    DVASSERT(Thread::IsMainThread());
+
+    std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+    batch->id = nextBatchId++;
+    batch->queries = std::move(queries);
+    batch->results.resize(batch->queries.size());
+    batch->callback = callback;
+
+    uint32 queriesCount = static_cast<uint32>(batch->queries.size());
+    uint32 jobsCount = (queriesCount + queriesPerJob - 1) / queriesPerJob;
+    batch->remainingJobs = jobsCount;
+    state->pendingBatches.emplace(batch->id, batch);
+
+    std::shared_ptr<SharedState> sharedState = state;
+    if (jobsCount == 0)
+    {
+        state->jobManager->CreateMainJob([sharedState, batch]() { SharedState::Deliver(sharedState, batch); }, JobManager::JOB_MAINLAZY);
+        return batch->id;
+    }
+
+    for (uint32 job = 0; job < jobsCount; ++job)
+    {
+        uint32 begin = job * queriesPerJob;
+        uint32 end = std::min(begin + queriesPerJob, queriesCount);
+        state->jobManager->CreateWorkerJob([sharedState, batch, begin, end]() {
+            std::unique_ptr<WaypointPathFinder> finder = sharedState->AcquireFinder();
+            for (uint32 i = begin; i < end && !batch->cancelled; ++i)
+            {
+                finder->FindPath(batch->queries[i], batch->results[i]);
+            }
+            sharedState->ReleaseFinder(std::move(finder));
+
+            if (--batch->remainingJobs == 0)
+            {
+                sharedState->jobManager->CreateMainJob([sharedState, batch]() { SharedState::Deliver(sharedState, batch); }, JobManager::JOB_MAINLAZY);
+            }
+        });
+    }
+
+    return batch->id;
+}
+
+void WaypointPathScheduler::Cancel(uint32 batchId)
+{
+    DVASSERT(Thread::IsMainThread());
+
+    auto found = state->pendingBatches.find(batchId);
+    if (found != state->pendingBatches.end())
+    {
+        found->second->cancelled = true;
+        state->pendingBatches.erase(found);
+    }
+}
+
+bool WaypointPathScheduler::IsPending(uint32 batchId) const
+{
+    return state->pendingBatches.count(batchId) > 0;
+}
+
+uint32 WaypointPathScheduler::GetPendingCount() const
+{
+    return static_cast<uint32>(state->pendingBatches.size());
+}
+} // namespace DAVA
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "Base/BaseObject.h"
+#include "Base/BaseTypes.h"
+#include "Base/FastName.h"
+#include "Base/RefPtr.h"
+#include "FileSystem/FilePath.h"
+#include "Math/AABBox3.h"
+#include "Math/Vector.h"
+
+namespace DAVA
+{
+class Entity;
+class KeyedArchive;
+class PathComponent;
+class WaypointCostFilter;
+
+struct WaypointGraphBuildParams
+{
+    /** Edge property which multiplies edge length into its cost. Edge cost is its length if property is missing. */
+    FastName costProperty;
+    /** Waypoints of different paths closer than this distance are connected with two-way edges. */
+    float32 linkDistance = 0.f;
+};
+
+/**
+    Compiled read-only representation of waypoint graphs of PathComponents, used for path queries.
+
+    Waypoints of all paths are numbered continuously in order of paths and their waypoints.
+    Outgoing edges of waypoint `w` are [GetEdgesBegin(w), GetEdgesEnd(w)), edge data is stored in flat arrays.
+    Waypoint and edge properties are interned: equal archives share one property set, set 0 is always empty.
+    Graph is immutable after Build or Load, so it can be queried from any number of threads.
+*/
+class WaypointGraph : public BaseObject
+{
+public:
+    static const uint32 INVALID_WAYPOINT = static_cast<uint32>(-1);
+    static const uint32 EMPTY_PROPERTY_SET = 0;
+
+    using BuildParams = WaypointGraphBuildParams;
+
+    WaypointGraph();
+
+    void Build(const Vector<PathComponent*>& paths, const BuildParams& params = BuildParams());
+    /** Builds graph from PathComponents of `root` and all its children. */
+    void Build(Entity* root, const BuildParams& params = BuildParams());
+
+    /** Compiled graph may be stored at export time and loaded instead of building it from scene. */
+    bool Save(const FilePath& filePath) const;
+    bool Load(const FilePath& filePath);
+
+    uint32 GetWaypointCount() const;
+    const Vector3& GetWaypointPosition(uint32 waypoint) const;
+    uint32 GetWaypointPropertySet(uint32 waypoint) const;
+    uint32 GetWaypointPath(uint32 waypoint) const;
+
+    uint32 GetEdgeCount() const;
+    uint32 GetEdgesBegin(uint32 waypoint) const;
+    uint32 GetEdgesEnd(uint32 waypoint) const;
+    uint32 GetEdgeDestination(uint32 edge) const;
+    float32 GetEdgeCost(uint32 edge) const;
+    uint32 GetEdgePropertySet(uint32 edge) const;
+
+    /** Minimal ratio of edge cost to distance between its waypoints, used to keep A* heuristic admissible. */
+    float32 GetMinCostPerDistance() const;
+
+    uint32 GetPropertySetCount() const;
+    const KeyedArchive* GetPropertySet(uint32 propertySet) const;
+
+    uint32 GetPathCount() const;
+    const FastName& GetPathName(uint32 path) const;
+    /** Returns graph waypoint for waypoint with index `pathWaypoint` in PathComponent::GetPoints() of path `path`. */
+    uint32 GetWaypoint(uint32 path, uint32 pathWaypoint) const;
+
+    const AABBox3& GetBoundingBox() const;
+
+    /**
+        Returns waypoint nearest to `position` or INVALID_WAYPOINT if there are no waypoints within `maxDistance`.
+        If `filter` is set, only waypoints allowed by it are considered.
+    */
+    uint32 FindNearestWaypoint(const Vector3& position, float32 maxDistance = std::numeric_limits<float32>::max(), const WaypointCostFilter* filter = nullptr) const;
+
+private:
+    struct BuildEdge
+    {
+        uint32 from;
+        uint32 to;
+        float32 cost;
+        uint32 propertySet;
+    };
+
+    uint32 InternPropertySet(const KeyedArchive* properties, UnorderedMap<String, uint32>& internedSets);
+    void BuildEdges(Vector<BuildEdge>& edges);
+    void BuildSpatialIndex();
+    void GetCell(const Vector3& position, int32& x, int32& y) const;
+
+    Vector<Vector3> positions;
+    Vector<uint32> waypointPropertySets;
+    Vector<uint32> waypointPaths;
+
+    Vector<uint32> edgeOffsets; // waypointsCount + 1 elements
+    Vector<uint32> edgeDestinations;
+    Vector<float32> edgeCosts;
+    Vector<uint32> edgePropertySets;
+    float32 minCostPerDistance = 1.f;
+
+    Vector<RefPtr<KeyedArchive>> propertySets;
+
+    Vector<FastName> pathNames;
+    Vector<uint32> pathOffsets; // pathsCount + 1 elements
+
+    // Uniform grid in XY plane, waypoints of cell (x, y) are cellWaypoints[cellOffsets[y * columns + x], cellOffsets[y * columns + x + 1])
+    AABBox3 bbox;
+    float32 cellSize = 1.f;
+    int32 columns = 0;
+    int32 rows = 0;
+    Vector<uint32> cellOffsets;
+    Vector<uint32> cellWaypoints;
+};
+
+inline uint32 WaypointGraph::GetWaypointCount() const
+{
+    return static_cast<uint32>(positions.size());
+}
+
+inline const Vector3& WaypointGraph::GetWaypointPosition(uint32 waypoint) const
+{
+    return positions[waypoint];
+}
+
+inline uint32 WaypointGraph::GetWaypointPropertySet(uint32 waypoint) const
+{
+    return waypointPropertySets[waypoint];
+}
+
+inline uint32 WaypointGraph::GetWaypointPath(uint32 waypoint) const
+{
+    return waypointPaths[waypoint];
+}
+
+inline uint32 WaypointGraph::GetEdgeCount() const
+{
+    return static_cast<uint32>(edgeDestinations.size());
+}
+
+inline uint32 WaypointGraph::GetEdgesBegin(uint32 waypoint) const
+{
+    return edgeOffsets[waypoint];
+}
+
+inline uint32 WaypointGraph::GetEdgesEnd(uint32 waypoint) const
+{
+    return edgeOffsets[waypoint + 1];
+}
+
+inline uint32 WaypointGraph::GetEdgeDestination(uint32 edge) const
+{
+    return edgeDestinations[edge];
+}
+
+inline float32 WaypointGraph::GetEdgeCost(uint32 edge) const
+{
+    return edgeCosts[edge];
+}
+
+inline uint32 WaypointGraph::GetEdgePropertySet(uint32 edge) const
+{
+    return edgePropertySets[edge];
+}
+
+inline float32 WaypointGraph::GetMinCostPerDistance() const
+{
+    return minCostPerDistance;
+}
+
+inline uint32 WaypointGraph::GetPropertySetCount() const
+{
+    return static_cast<uint32>(propertySets.size());
+}
+
+inline const KeyedArchive* WaypointGraph::GetPropertySet(uint32 propertySet) const
+{
+    return propertySets[propertySet].Get();
+}
+
+inline uint32 WaypointGraph::GetPathCount() const
+{
+    return static_cast<uint32>(pathNames.size());
+}
+
+inline const FastName& WaypointGraph::GetPathName(uint32 path) const
+{
+    return pathNames[path];
+}
+
+inline const AABBox3& WaypointGraph::GetBoundingBox() const
+{
+    return bbox;
+}
+} // namespace DAVA
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Base/BaseObject.h"
+#include "Base/BaseTypes.h"
+#include "Base/RefPtr.h"
+#include "Functional/Function.h"
+#include "Scene3D/Waypoint/WaypointGraph.h"
+
+namespace DAVA
+{
+class KeyedArchive;
+
+/**
+    Rules applied to edges and waypoints of WaypointGraph during path search.
+    Rules are evaluated once per interned property set when filter is created, so filter is cheap to use
+    and can be shared between threads. Filter is valid only for the graph it was created for.
+*/
+class WaypointCostFilter : public BaseObject
+{
+public:
+    /** Returns multiplier for cost of edge with given properties, negative value makes edge impassable. */
+    using EdgeCostScale = Function<float32(const KeyedArchive* edgeProperties)>;
+    /** Returns false for waypoints which can't be entered. */
+    using WaypointPredicate = Function<bool(const KeyedArchive* waypointProperties)>;
+
+    WaypointCostFilter(const WaypointGraph* graph, const EdgeCostScale& edgeCostScale, const WaypointPredicate& waypointPredicate = nullptr);
+
+    bool IsEdgeAllowed(uint32 propertySet) const;
+    float32 GetEdgeCostScale(uint32 propertySet) const;
+    bool IsWaypointAllowed(uint32 propertySet) const;
+
+    /** Minimal cost scale of allowed edges. */
+    float32 GetMinEdgeCostScale() const;
+
+private:
+    Vector<float32> edgeCostScales;
+    Vector<uint8> allowedWaypoints;
+    float32 minEdgeCostScale = 1.f;
+};
+
+/**
+    Path search over WaypointGraph.
+    Search buffers are kept between queries, so finder should be reused, but it can't be used from several threads at once.
+    Waypoints rejected by filter are never entered, query start waypoint is always allowed.
+*/
+class WaypointPathFinder
+{
+public:
+    enum eAlgorithm : uint8
+    {
+        ASTAR, //!< goal-directed search with distance heuristic
+        DIJKSTRA //!< uniform cost search, expands more waypoints but doesn't rely on waypoint positions
+    };
+
+    struct Query
+    {
+        uint32 from = WaypointGraph::INVALID_WAYPOINT;
+        uint32 to = WaypointGraph::INVALID_WAYPOINT;
+        eAlgorithm algorithm = ASTAR;
+        RefPtr<WaypointCostFilter> filter; //!< optional
+    };
+
+    struct Result
+    {
+        bool found = false;
+        float32 cost = 0.f;
+        Vector<uint32> waypoints; //!< path from `from` to `to` inclusive
+        uint32 expandedCount = 0; //!< waypoints taken from open list, for profiling
+    };
+
+    explicit WaypointPathFinder(const WaypointGraph* graph);
+
+    bool FindPath(const Query& query, Result& result);
+
+    /** Fills `costs` with path costs from `from` to all waypoints, unreachable waypoints or ones further than `maxCost` get infinity. */
+    void FindCosts(uint32 from, const WaypointCostFilter* filter, Vector<float32>& costs, float32 maxCost = std::numeric_limits<float32>::infinity());
+
+private:
+    struct OpenEntry
+    {
+        float32 priority;
+        float32 cost;
+        uint32 waypoint;
+    };
+
+    uint32 Search(uint32 from, uint32 to, float32 heuristicScale, const WaypointCostFilter* filter, float32 maxCost);
+    void NextSearch();
+
+    const WaypointGraph* graph = nullptr;
+
+    // Waypoint data is valid only if its stamp equals current searchStamp, so buffers aren't cleared between searches
+    Vector<uint32> stamps;
+    Vector<uint32> closedStamps;
+    Vector<float32> costs;
+    Vector<uint32> parents;
+    Vector<OpenEntry> open;
+    uint32 searchStamp = 0;
+    uint32 expandedCount = 0;
+};
+
+inline bool WaypointCostFilter::IsEdgeAllowed(uint32 propertySet) const
+{
+    return edgeCostScales[propertySet] >= 0.f;
+}
+
+inline float32 WaypointCostFilter::GetEdgeCostScale(uint32 propertySet) const
+{
+    return edgeCostScales[propertySet];
+}
+
+inline bool WaypointCostFilter::IsWaypointAllowed(uint32 propertySet) const
+{
+    return allowedWaypoints[propertySet] != 0;
+}
+
+inline float32 WaypointCostFilter::GetMinEdgeCostScale() const
+{
+    return minEdgeCostScale;
+}
+} // namespace DAVA
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Base/BaseTypes.h"
+#include "Functional/Function.h"
+#include "Scene3D/Waypoint/WaypointPathFinder.h"
+
+#include <memory>
+
+namespace DAVA
+{
+class WaypointGraph;
+
+/**
+    Runs batches of path queries on JobManager worker threads and delivers results on the main thread.
+
+    Batch is split into worker jobs of `queriesPerJob` queries, each job takes WaypointPathFinder from scheduler pool,
+    so search buffers are allocated only once per worker. Results are passed to batch callback from JobManager::Update.
+    Scheduler keeps the graph alive until all its jobs are finished. Callbacks of cancelled batches and batches
+    still running when scheduler is destroyed are not called.
+*/
+class WaypointPathScheduler
+{
+public:
+    using Callback = Function<void(Vector<WaypointPathFinder::Result>& results)>;
+
+    explicit WaypointPathScheduler(WaypointGraph* graph, uint32 queriesPerJob = 32);
+    ~WaypointPathScheduler();
+
+    /** Submits batch from the main thread, results are in order of `queries`. Returns batch id. */
+    uint32 Submit(Vector<WaypointPathFinder::Query> queries, const Callback& callback);
+    void Cancel(uint32 batchId);
+
+    bool IsPending(uint32 batchId) const;
+    uint32 GetPendingCount() const;
+
+private:
+    struct Batch;
+    struct SharedState;
+
+    std::shared_ptr<SharedState> state;
+    uint32 queriesPerJob = 32;
+    uint32 nextBatchId = 1;
+};
+} // namespace DAVA
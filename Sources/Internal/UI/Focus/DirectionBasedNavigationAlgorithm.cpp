@@ -87,9 +87,6 @@ UIControl* DirectionBasedNavigationAlgorithm::FindNextSpecifiedControl(UIControl
 
 UIControl* DirectionBasedNavigationAlgorithm::FindNearestControl(UIControl* focusedControl, UIControl* control, UINavigationComponent::Direction dir) const
 {
-    UIControl* bestControl = nullptr;
-    float32 bestDistSq = 0;
-
     Rect rect = GetRect(focusedControl);
     Vector2 pos = rect.GetCenter();
 
@@ -116,33 +113,85 @@ UIControl* DirectionBasedNavigationAlgorithm::FindNearestControl(UIControl* focu
         break;
     }
 
-    if (CanNavigateToControl(focusedControl, control, dir))
+    if (CanNavigateToControl(focusedControl, rect, control, dir))
     {
         return control;
     }
 
+    UIControl* bestControl = nullptr;
+    float32 bestDistSq = 0;
+    FindNearestControlImpl(focusedControl, rect, pos, control, dir, bestControl, bestDistSq);
+    return bestControl;
+}
+
+void DirectionBasedNavigationAlgorithm::FindNearestControlImpl(UIControl* focusedControl, const Rect& focusedRect, const Vector2& pos, UIControl* control, UINavigationComponent::Direction dir, UIControl*& bestControl, float32& bestDistSq) const
+{
+    // Candidates are the first focusable controls on each branch, the first nearest one in hierarchy order wins
     for (const auto& c : control->GetChildren())
     {
-        UIControl* res = FindNearestControl(focusedControl, c.Get(), dir);
+        if (!CanContainNearerControl(c->GetHierarchyBounds(), focusedRect, pos, dir, bestControl, bestDistSq))
+        {
+            continue;
+        }
 
-        if (res != nullptr)
+        if (CanNavigateToControl(focusedControl, focusedRect, c.Get(), dir))
         {
-            Vector2 p = CalcNearestPos(pos, res, dir);
+            Vector2 p = CalcNearestPos(pos, GetRect(c.Get()), dir);
             float32 distSq = (p - pos).SquareLength();
             if (bestControl == nullptr || distSq < bestDistSq)
             {
-                bestControl = res;
+                bestControl = c.Get();
                 bestDistSq = distSq;
             }
         }
+        else
+        {
+            FindNearestControlImpl(focusedControl, focusedRect, pos, c.Get(), dir, bestControl, bestDistSq);
+        }
     }
+}
 
-    return bestControl;
+bool DirectionBasedNavigationAlgorithm::CanContainNearerControl(const Rect& bounds, const Rect& focusedRect, const Vector2& pos, UINavigationComponent::Direction dir, UIControl* bestControl, float32 bestDistSq) const
+{
+    // Rects of all controls in hierarchy are inside of bounds, so nearest position of bounds is not farther than theirs
+    Vector2 center = focusedRect.GetCenter();
+    switch (dir)
+    {
+    case UINavigationComponent::Direction::UP:
+        if (bounds.y >= center.y)
+            return false;
+        break;
+
+    case UINavigationComponent::Direction::DOWN:
+        if (bounds.y + bounds.dy <= center.y)
+            return false;
+        break;
+
+    case UINavigationComponent::Direction::LEFT:
+        if (bounds.x >= center.x)
+            return false;
+        break;
+
+    case UINavigationComponent::Direction::RIGHT:
+        if (bounds.x + bounds.dx <= center.x)
+            return false;
+        break;
+
+    default:
+        DVASSERT(false);
+        break;
+    }
+
+    if (bestControl != nullptr)
+    {
+        Vector2 p = CalcNearestPos(pos, bounds, dir);
+        return (p - pos).SquareLength() < bestDistSq;
+    }
+    return true;
 }
 
-Vector2 DirectionBasedNavigationAlgorithm::CalcNearestPos(const Vector2& pos, UIControl* testControl, UINavigationComponent::Direction dir) const
+Vector2 DirectionBasedNavigationAlgorithm::CalcNearestPos(const Vector2& pos, const Rect& r, UINavigationComponent::Direction dir) const
 {
-    Rect r = GetRect(testControl);
     Vector2 res = r.GetCenter();
     if (dir == UINavigationComponent::Direction::UP || dir == UINavigationComponent::Direction::DOWN)
     {
@@ -195,17 +244,16 @@ Vector2 DirectionBasedNavigationAlgorithm::CalcNearestPos(const Vector2& pos, UI
     return res;
 }
 
-bool DirectionBasedNavigationAlgorithm::CanNavigateToControl(UIControl* focusedControl, UIControl* control, UINavigationComponent::Direction dir) const
+bool DirectionBasedNavigationAlgorithm::CanNavigateToControl(UIControl* focusedControl, const Rect& focusedRect, UIControl* control, UINavigationComponent::Direction dir) const
 {
     if (control == focusedControl || !FocusHelpers::CanFocusControl(control))
     {
         return false;
     }
-    Rect rect = GetRect(focusedControl);
-    Vector2 pos = rect.GetCenter();
-    Vector2 srcPos = rect.GetCenter();
+    Vector2 pos = focusedRect.GetCenter();
+    Vector2 srcPos = focusedRect.GetCenter();
 
-    Vector2 cPos = CalcNearestPos(pos, control, dir);
+    Vector2 cPos = CalcNearestPos(pos, GetRect(control), dir);
 
     float32 dx = cPos.x - srcPos.x;
     float32 dy = cPos.y - srcPos.y;
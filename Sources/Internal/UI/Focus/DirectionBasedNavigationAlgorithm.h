@@ -26,9 +26,11 @@ private:
     UIControl* FindNextControl(UIControl* focusedControl, UINavigationComponent::Direction dir) const;
     UIControl* FindNextSpecifiedControl(UIControl* focusedControl, UINavigationComponent::Direction dir) const;
     UIControl* FindNearestControl(UIControl* focusedControl, UIControl* control, UINavigationComponent::Direction dir) const;
-    Vector2 CalcNearestPos(const Vector2& pos, UIControl* testControl, UINavigationComponent::Direction dir) const;
+    void FindNearestControlImpl(UIControl* focusedControl, const Rect& focusedRect, const Vector2& pos, UIControl* control, UINavigationComponent::Direction dir, UIControl*& bestControl, float32& bestDistSq) const;
+    bool CanContainNearerControl(const Rect& bounds, const Rect& focusedRect, const Vector2& pos, UINavigationComponent::Direction dir, UIControl* bestControl, float32 bestDistSq) const;
+    Vector2 CalcNearestPos(const Vector2& pos, const Rect& r, UINavigationComponent::Direction dir) const;
 
-    bool CanNavigateToControl(UIControl* focusedControl, UIControl* control, UINavigationComponent::Direction dir) const;
+    bool CanNavigateToControl(UIControl* focusedControl, const Rect& focusedRect, UIControl* control, UINavigationComponent::Direction dir) const;
     UIControl* FindFirstControlImpl(UIControl* control, UIControl* candidate) const;
 
     Rect GetRect(UIControl* control) const;
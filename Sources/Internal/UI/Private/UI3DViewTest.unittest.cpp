@@ -0,0 +1,283 @@
+#include "UnitTests/UnitTests.h"
+
+#include "Base/BaseTypes.h"
+#include "Base/RefPtr.h"
+#include "Logger/Logger.h"
+#include "Render/Highlevel/Camera.h"
+#include "Render/Highlevel/DynamicResolutionController.h"
+#include "Render/Highlevel/RenderSystem.h"
+#include "Render/Texture.h"
+#include "Scene3D/Components/CameraComponent.h"
+#include "Scene3D/Components/TransformComponent.h"
+#include "Scene3D/Entity.h"
+#include "Scene3D/Scene.h"
+#include "Time/SystemTimer.h"
+#include "UI/UI3DView.h"
+
+using namespace DAVA;
+
+namespace UI3DViewTestDetails
+{
+const float32 FRAME_DELTA = 1.f / 60.f;
+
+struct TestView
+{
+    RefPtr<UI3DView> view;
+    RefPtr<Camera> camera;
+    RefPtr<Entity> animatedEntity;
+    float32 animationTime = 0.f;
+};
+
+TestView CreateView(bool animated, bool redrawOnDemand)
+{
+    TestView result;
+
+    RefPtr<Scene> scene(new Scene());
+    for (uint32 i = 0; i < 10; ++i)
+    {
+        RefPtr<Entity> entity(new Entity());
+        entity->GetComponent<TransformComponent>()->SetLocalTranslation(Vector3(static_cast<float32>(i), 0.f, 0.f));
+        scene->AddNode(entity.Get());
+    }
+
+    result.camera.Set(new Camera());
+    result.camera->SetupPerspective(70.f, 1.f, 0.5f, 2500.f);
+    result.camera->SetUp(Vector3(0.f, 0.f, 1.f));
+    result.camera->SetTarget(Vector3(0.f, 0.f, 0.f));
+    result.camera->SetPosition(Vector3(0.f, -10.f, 0.f));
+
+    RefPtr<Entity> cameraEntity(new Entity());
+    cameraEntity->AddComponent(new CameraComponent(result.camera.Get()));
+    scene->AddNode(cameraEntity.Get());
+    scene->AddCamera(result.camera.Get());
+    scene->SetCurrentCamera(result.camera.Get());
+
+    if (animated)
+    {
+        result.animatedEntity.Set(new Entity());
+        scene->AddNode(result.animatedEntity.Get());
+    }
+
+    result.view.Set(new UI3DView(Rect(0.f, 0.f, 256.f, 256.f)));
+    result.view->SetDrawToFrameBuffer(true);
+    result.view->SetRedrawOnDemand(redrawOnDemand);
+    result.view->SetScene(scene.Get());
+
+    return result;
+}
+
+void RunFrames(Vector<TestView>& views, uint32 framesCount)
+{
+    for (uint32 frame = 0; frame < framesCount; ++frame)
+    {
+        for (TestView& v : views)
+        {
+            if (v.animatedEntity)
+            {
+                v.animationTime += FRAME_DELTA;
+                v.animatedEntity->GetComponent<TransformComponent>()->SetLocalTranslation(Vector3(std::cos(v.animationTime), std::sin(v.animationTime), 0.f));
+            }
+
+            v.view->Update(FRAME_DELTA);
+            v.view->RenderToFrameBuffer(v.view->GetGeometricData());
+        }
+    }
+}
+
+Vector<TestView> CreateScreen(bool redrawOnDemand)
+{
+    Vector<TestView> views;
+    for (uint32 i = 0; i < 4; ++i)
+    {
+        views.push_back(CreateView(false, redrawOnDemand));
+    }
+    views.push_back(CreateView(true, redrawOnDemand));
+    return views;
+}
+}
+
+DAVA_TESTCLASS (UI3DViewTest)
+{
+    DAVA_TEST (RedrawOnDemandTest)
+    {
+        using namespace UI3DViewTestDetails;
+
+        const uint32 framesCount = 60;
+
+        Vector<TestView> views = CreateScreen(true);
+        RunFrames(views, framesCount);
+
+        for (uint32 i = 0; i < 4; ++i)
+        {
+            TEST_VERIFY(views[i].view->GetSceneDrawsCount() == 1);
+        }
+        TEST_VERIFY(views[4].view->GetSceneDrawsCount() == framesCount);
+
+        TestView& staticView = views[0];
+        uint32 drawsCount = staticView.view->GetSceneDrawsCount();
+
+        // explicit invalidate
+        staticView.view->InvalidateFrameBuffer();
+        RunFrames(views, 2);
+        TEST_VERIFY(staticView.view->GetSceneDrawsCount() == ++drawsCount);
+
+        // camera moved
+        staticView.camera->SetPosition(Vector3(0.f, -20.f, 0.f));
+        RunFrames(views, 2);
+        TEST_VERIFY(staticView.view->GetSceneDrawsCount() == ++drawsCount);
+
+        // view resized
+        staticView.view->SetSize(Vector2(128.f, 128.f));
+        RunFrames(views, 2);
+        TEST_VERIFY(staticView.view->GetSceneDrawsCount() == ++drawsCount);
+
+        // frame buffer scale changed
+        staticView.view->SetFrameBufferScaleFactor(0.5f);
+        RunFrames(views, 2);
+        TEST_VERIFY(staticView.view->GetSceneDrawsCount() == ++drawsCount);
+
+        // scene content changed
+        RefPtr<Entity> entity(new Entity());
+        staticView.view->GetScene()->AddNode(entity.Get());
+        RunFrames(views, 2);
+        TEST_VERIFY(staticView.view->GetSceneDrawsCount() == ++drawsCount);
+
+        // transform changed
+        entity->GetComponent<TransformComponent>()->SetLocalTranslation(Vector3(1.f, 2.f, 3.f));
+        RunFrames(views, 2);
+        TEST_VERIFY(staticView.view->GetSceneDrawsCount() == ++drawsCount);
+
+        // redraw every frame when on demand mode is disabled
+        staticView.view->SetRedrawOnDemand(false);
+        RunFrames(views, 10);
+        TEST_VERIFY(staticView.view->GetSceneDrawsCount() == drawsCount + 10);
+    }
+
+    DAVA_TEST (MaxRefreshRateTest)
+    {
+        using namespace UI3DViewTestDetails;
+
+        Vector<TestView> views;
+        views.push_back(CreateView(true, true));
+        views.back().view->SetMaxRefreshRate(10.f);
+
+        // one second of animation at 60 FPS should be rendered about 10 times
+        RunFrames(views, 60);
+        uint32 drawsCount = views.back().view->GetSceneDrawsCount();
+        TEST_VERIFY(drawsCount >= 8 && drawsCount <= 11);
+
+        // invalidation is not limited by refresh rate
+        RunFrames(views, 1);
+        drawsCount = views.back().view->GetSceneDrawsCount();
+        views.back().view->InvalidateFrameBuffer();
+        RunFrames(views, 1);
+        TEST_VERIFY(views.back().view->GetSceneDrawsCount() == drawsCount + 1);
+    }
+
+    DAVA_TEST (DynamicResolutionTest)
+    {
+        using namespace UI3DViewTestDetails;
+
+        Vector<TestView> views;
+        views.push_back(CreateView(true, false));
+        UI3DView* view = views.back().view.Get();
+
+        RunFrames(views, 1);
+        Vector2 nativeSize = view->GetFrameBufferRenderSize();
+        TEST_VERIFY(view->GetLastViewportRect().GetSize() == nativeSize);
+
+        view->SetDynamicResolutionEnabled(true);
+        DynamicResolutionController* controller = view->GetDynamicResolutionController();
+        TEST_VERIFY(controller != nullptr);
+
+        // frames within target time keep native resolution
+        RunFrames(views, 120);
+        TEST_VERIFY(controller->GetScale() == 1.f);
+        TEST_VERIFY(view->GetFrameBufferRenderSize() == nativeSize);
+
+        // slow frames reduce render size and viewport, aspect ratio is kept
+        for (uint32 i = 0; i < controller->GetSettings().downscaleFrames; ++i)
+        {
+            controller->AddFrameTime(FRAME_DELTA * 1.5f);
+        }
+        TEST_VERIFY(controller->GetScale() < 1.f);
+
+        uint32 drawsCount = view->GetSceneDrawsCount();
+        RunFrames(views, 1);
+        TEST_VERIFY(view->GetSceneDrawsCount() == drawsCount + 1);
+
+        Vector2 scaledSize = controller->GetScaledSize(nativeSize);
+        TEST_VERIFY(scaledSize.dx < nativeSize.dx && scaledSize.dy < nativeSize.dy);
+        TEST_VERIFY(view->GetFrameBufferRenderSize() == scaledSize);
+        TEST_VERIFY(view->GetLastViewportRect() == Rect(Vector2(), scaledSize));
+
+        // scene is rendered to native size frame buffer with reduced viewport
+        Texture* frameBuffer = view->GetFrameBuffer();
+        TEST_VERIFY(frameBuffer != nullptr);
+        TEST_VERIFY(frameBuffer->GetWidth() == static_cast<int32>(nativeSize.dx) && frameBuffer->GetHeight() == static_cast<int32>(nativeSize.dy));
+        const rhi::RenderPassConfig& passConfig = view->GetScene()->renderSystem->GetMainPassConfig();
+        TEST_VERIFY(passConfig.colorBuffer[0].texture == frameBuffer->handle);
+        TEST_VERIFY(passConfig.viewport.x == 0 && passConfig.viewport.y == 0);
+        TEST_VERIFY(passConfig.viewport.width == static_cast<uint32>(scaledSize.dx) && passConfig.viewport.height == static_cast<uint32>(scaledSize.dy));
+
+        // disabling restores native size and previous drawing mode
+        view->SetDynamicResolutionEnabled(false);
+        RunFrames(views, 1);
+        TEST_VERIFY(view->GetDrawToFrameBuffer());
+        TEST_VERIFY(view->GetFrameBufferRenderSize() == nativeSize);
+    }
+
+    DAVA_TEST (DynamicResolutionDirectDrawTest)
+    {
+        using namespace UI3DViewTestDetails;
+
+        Vector<TestView> views;
+        views.push_back(CreateView(true, false));
+        UI3DView* view = views.back().view.Get();
+
+        // switching to direct drawing disables dynamic resolution
+        view->SetDynamicResolutionEnabled(true);
+        view->SetDrawToFrameBuffer(false);
+        TEST_VERIFY(!view->IsDynamicResolutionEnabled());
+        TEST_VERIFY(!view->GetDrawToFrameBuffer());
+        TEST_VERIFY(view->GetFrameBuffer() == nullptr);
+
+        // frame buffer enabled while dynamic resolution is on stays enabled after it is turned off
+        view->SetDynamicResolutionEnabled(true);
+        TEST_VERIFY(view->GetDrawToFrameBuffer());
+        view->SetDrawToFrameBuffer(true);
+        view->SetDynamicResolutionEnabled(false);
+        TEST_VERIFY(view->GetDrawToFrameBuffer());
+    }
+
+    DAVA_TEST (RedrawBenchmark)
+    {
+        using namespace UI3DViewTestDetails;
+
+        const uint32 framesCount = 300;
+
+        Vector<TestView> alwaysViews = CreateScreen(false);
+        int64 alwaysStart = SystemTimer::GetUs();
+        RunFrames(alwaysViews, framesCount);
+        int64 alwaysTime = SystemTimer::GetUs() - alwaysStart;
+
+        Vector<TestView> onDemandViews = CreateScreen(true);
+        int64 onDemandStart = SystemTimer::GetUs();
+        RunFrames(onDemandViews, framesCount);
+        int64 onDemandTime = SystemTimer::GetUs() - onDemandStart;
+
+        uint32 alwaysDraws = 0;
+        uint32 onDemandDraws = 0;
+        for (size_t i = 0; i < alwaysViews.size(); ++i)
+        {
+            alwaysDraws += alwaysViews[i].view->GetSceneDrawsCount();
+            onDemandDraws += onDemandViews[i].view->GetSceneDrawsCount();
+        }
+
+        TEST_VERIFY(alwaysDraws == framesCount * 5);
+        TEST_VERIFY(onDemandDraws == framesCount + 4);
+
+        Logger::Info("UI3DView benchmark (4 static and 1 animated view, %u frames): always %u draws %lld us, on demand %u draws %lld us",
+                     framesCount, alwaysDraws, alwaysTime, onDemandDraws, onDemandTime);
+    }
+};
@@ -0,0 +1,328 @@
+#include "UnitTests/UnitTests.h"
+
+#include "Base/BaseTypes.h"
+#include "Base/RefPtr.h"
+#include "Engine/Engine.h"
+#include "Logger/Logger.h"
+#include "Time/SystemTimer.h"
+#include "UI/Focus/DirectionBasedNavigationAlgorithm.h"
+#include "UI/Focus/FocusHelpers.h"
+#include "UI/Focus/UIFocusComponent.h"
+#include "UI/Focus/UIFocusGroupComponent.h"
+#include "UI/Input/UIInputSystem.h"
+#include "UI/Render/UIClipContentComponent.h"
+#include "UI/UIControl.h"
+#include "UI/UIControlSystem.h"
+#include "UI/UIEvent.h"
+#include "UI/UIScreen.h"
+
+using namespace DAVA;
+
+namespace UIHitTestTestDetails
+{
+const uint32 PANELS_COUNT = 10;
+const uint32 ROWS_COUNT = 20;
+const uint32 BUTTONS_IN_ROW = 25;
+const Vector2 BUTTON_SIZE(16.f, 12.f);
+
+// Inventory-like screen: panels with rows of focusable buttons, some panels are clipped, rotated or hidden
+void BuildScreen(UIControl* screen, Vector<UIControl*>& buttons)
+{
+    for (uint32 p = 0; p < PANELS_COUNT; ++p)
+    {
+        RefPtr<UIControl> panel(new UIControl(Rect(10.f + (p % 2) * 420.f, 10.f + (p / 2) * 250.f, BUTTONS_IN_ROW * BUTTON_SIZE.dx, ROWS_COUNT * BUTTON_SIZE.dy)));
+        panel->SetInputEnabled(false, false);
+        panel->GetOrCreateComponent<UIFocusGroupComponent>();
+        screen->AddControl(panel.Get());
+
+        RefPtr<UIControl> content(new UIControl(panel->GetRect()));
+        content->SetPosition(Vector2());
+        content->SetInputEnabled(false, false);
+        panel->AddControl(content.Get());
+
+        if (p == 3)
+        {
+            // Scrolled content: part of buttons is outside of panel and can't be hit
+            panel->GetOrCreateComponent<UIClipContentComponent>();
+            content->SetPosition(Vector2(-100.f, -50.f));
+        }
+        else if (p == 6)
+        {
+            panel->SetPivot(Vector2(0.5f, 0.5f));
+            panel->SetAngleInDegrees(10.f);
+        }
+        else if (p == 9)
+        {
+            panel->SetVisibilityFlag(false);
+        }
+
+        for (uint32 r = 0; r < ROWS_COUNT; ++r)
+        {
+            RefPtr<UIControl> row(new UIControl(Rect(0.f, r * BUTTON_SIZE.dy, BUTTONS_IN_ROW * BUTTON_SIZE.dx, BUTTON_SIZE.dy)));
+            row->SetInputEnabled(false, false);
+            content->AddControl(row.Get());
+
+            for (uint32 b = 0; b < BUTTONS_IN_ROW; ++b)
+            {
+                // Buttons are a bit smaller than cells to have gaps between them
+                RefPtr<UIControl> button(new UIControl(Rect(b * BUTTON_SIZE.dx, 0.f, BUTTON_SIZE.dx - 2.f, BUTTON_SIZE.dy - 2.f)));
+                button->GetOrCreateComponent<UIFocusComponent>();
+                row->AddControl(button.Get());
+                buttons.push_back(button.Get());
+            }
+        }
+    }
+}
+
+void SetInputCulling(UIControl* control, bool enabled)
+{
+    control->SetInputCulling(enabled);
+    for (const auto& c : control->GetChildren())
+    {
+        SetInputCulling(c.Get(), enabled);
+    }
+}
+
+Vector<Vector2> GetTestPoints()
+{
+    Vector<Vector2> points;
+    for (float32 y = 0.f; y < 1270.f; y += 7.f)
+    {
+        for (float32 x = 0.f; x < 860.f; x += 11.f)
+        {
+            points.push_back(Vector2(x, y));
+        }
+    }
+    return points;
+}
+
+Vector<UIControl*> HoverPoints(const Vector<Vector2>& points, int64& timeUs)
+{
+    UIInputSystem* inputSystem = GetEngineContext()->uiControlSystem->GetInputSystem();
+
+    Vector<UIControl*> result;
+    result.reserve(points.size());
+
+    int64 startTime = SystemTimer::GetUs();
+    for (const Vector2& point : points)
+    {
+        UIEvent event;
+        event.phase = UIEvent::Phase::MOVE;
+        event.device = eInputDevices::MOUSE;
+        event.point = point;
+        event.physPoint = point;
+        inputSystem->HandleEvent(&event);
+        result.push_back(inputSystem->GetHoveredControl());
+    }
+    timeUs = SystemTimer::GetUs() - startTime;
+
+    inputSystem->SetHoveredControl(nullptr);
+    return result;
+}
+
+// Exhaustive search which DirectionBasedNavigationAlgorithm did before hierarchy bounds
+class ReferenceNavigation
+{
+public:
+    ReferenceNavigation(UIControl* root_)
+        : root(root_)
+    {
+    }
+
+    UIControl* GetNextControl(UIControl* focusedControl, UINavigationComponent::Direction dir) const
+    {
+        UIControl* next = nullptr;
+        for (UIControl* parent = focusedControl; parent != nullptr && parent != root && next == nullptr; parent = parent->GetParent())
+        {
+            if (parent->GetComponent<UIFocusGroupComponent>() != nullptr)
+            {
+                next = FindNearestControl(focusedControl, parent, dir);
+            }
+        }
+        if (next == nullptr)
+        {
+            next = FindNearestControl(focusedControl, root, dir);
+        }
+        return next != focusedControl ? next : nullptr;
+    }
+
+private:
+    UIControl* FindNearestControl(UIControl* focusedControl, UIControl* control, UINavigationComponent::Direction dir) const
+    {
+        Rect rect = GetRect(focusedControl);
+        Vector2 pos = rect.GetCenter();
+        if (dir == UINavigationComponent::Direction::UP)
+            pos.y = rect.y;
+        else if (dir == UINavigationComponent::Direction::DOWN)
+            pos.y = rect.y + rect.dy;
+        else if (dir == UINavigationComponent::Direction::LEFT)
+            pos.x = rect.x;
+        else
+            pos.x = rect.x + rect.dx;
+
+        if (CanNavigateToControl(focusedControl, control, dir))
+        {
+            return control;
+        }
+
+        UIControl* bestControl = nullptr;
+        float32 bestDistSq = 0;
+        for (const auto& c : control->GetChildren())
+        {
+            UIControl* res = FindNearestControl(focusedControl, c.Get(), dir);
+            if (res != nullptr)
+            {
+                float32 distSq = (CalcNearestPos(pos, res, dir) - pos).SquareLength();
+                if (bestControl == nullptr || distSq < bestDistSq)
+                {
+                    bestControl = res;
+                    bestDistSq = distSq;
+                }
+            }
+        }
+        return bestControl;
+    }
+
+    Vector2 CalcNearestPos(const Vector2& pos, UIControl* testControl, UINavigationComponent::Direction dir) const
+    {
+        Rect r = GetRect(testControl);
+        Vector2 res = r.GetCenter();
+        if (dir == UINavigationComponent::Direction::UP || dir == UINavigationComponent::Direction::DOWN)
+        {
+            res.x = (pos.x > r.x + r.dx) ? r.x + r.dx : ((pos.x < r.x) ? r.x : pos.x);
+        }
+        else
+        {
+            res.y = (pos.y > r.y + r.dy) ? r.y + r.dy : ((pos.y < r.y) ? r.y : pos.y);
+        }
+
+        if (dir == UINavigationComponent::Direction::UP)
+            res.y = Min(r.y + r.dy, pos.y);
+        else if (dir == UINavigationComponent::Direction::DOWN)
+            res.y = Max(r.y, pos.y);
+        else if (dir == UINavigationComponent::Direction::LEFT)
+            res.x = Min(r.x + r.dx, pos.x);
+        else
+            res.x = Max(r.x, pos.x);
+        return res;
+    }
+
+    bool CanNavigateToControl(UIControl* focusedControl, UIControl* control, UINavigationComponent::Direction dir) const
+    {
+        if (control == focusedControl || !FocusHelpers::CanFocusControl(control))
+        {
+            return false;
+        }
+        Vector2 srcPos = GetRect(focusedControl).GetCenter();
+        Vector2 cPos = CalcNearestPos(srcPos, control, dir);
+        float32 dx = cPos.x - srcPos.x;
+        float32 dy = cPos.y - srcPos.y;
+        if (dir == UINavigationComponent::Direction::UP)
+            return dy < 0 && Abs(dy) > Abs(dx);
+        else if (dir == UINavigationComponent::Direction::DOWN)
+            return dy > 0 && Abs(dy) > Abs(dx);
+        else if (dir == UINavigationComponent::Direction::LEFT)
+            return dx < 0 && Abs(dx) > Abs(dy);
+        return dx > 0 && Abs(dx) > Abs(dy);
+    }
+
+    Rect GetRect(UIControl* control) const
+    {
+        return control->GetGeometricData().GetUnrotatedRect();
+    }
+
+    UIControl* root = nullptr;
+};
+}
+
+DAVA_TESTCLASS (UIHitTestTest)
+{
+    RefPtr<UIScreen> screen;
+    Vector<UIControl*> buttons;
+
+    UIHitTestTest()
+    {
+        screen.Set(new UIScreen());
+        GetEngineContext()->uiControlSystem->SetScreen(screen.Get());
+        GetEngineContext()->uiControlSystem->Update();
+
+        UIHitTestTestDetails::BuildScreen(screen.Get(), buttons);
+    }
+
+    ~UIHitTestTest()
+    {
+        GetEngineContext()->uiControlSystem->Reset();
+    }
+
+    DAVA_TEST (HoverTest)
+    {
+        using namespace UIHitTestTestDetails;
+
+        Vector<Vector2> points = GetTestPoints();
+        int64 culledTime = 0;
+        int64 fullTime = 0;
+
+        Vector<UIControl*> culled = HoverPoints(points, culledTime);
+        SetInputCulling(screen.Get(), false);
+        Vector<UIControl*> full = HoverPoints(points, fullTime);
+        SetInputCulling(screen.Get(), true);
+        TEST_VERIFY(culled == full);
+        TEST_VERIFY(std::count(culled.begin(), culled.end(), nullptr) < static_cast<ptrdiff_t>(culled.size()));
+
+        Logger::Info("UI hover dispatch, %u controls: %.2f us per event with culling, %.2f us per event without",
+                     static_cast<uint32>(buttons.size()), culledTime / static_cast<float64>(points.size()), fullTime / static_cast<float64>(points.size()));
+
+        // Bounds follow changes of transform and hierarchy
+        UIControl* panel = screen->GetChildren().front().Get();
+        panel->SetPosition(panel->GetPosition() + Vector2(200.f, 30.f));
+        screen->GetChildren().back()->SetVisibilityFlag(true);
+        buttons[BUTTONS_IN_ROW * 3]->SetScale(Vector2(3.f, 3.f));
+        RefPtr<UIControl> movedButton(SafeRetain(buttons[BUTTONS_IN_ROW * 5]));
+        movedButton->GetParent()->RemoveControl(movedButton.Get());
+        buttons[BUTTONS_IN_ROW * 40]->GetParent()->AddControl(movedButton.Get());
+
+        culled = HoverPoints(points, culledTime);
+        SetInputCulling(screen.Get(), false);
+        full = HoverPoints(points, fullTime);
+        SetInputCulling(screen.Get(), true);
+        TEST_VERIFY(culled == full);
+    }
+
+    DAVA_TEST (NavigationTest)
+    {
+        using namespace UIHitTestTestDetails;
+
+        const UINavigationComponent::Direction directions[] = {
+            UINavigationComponent::Direction::LEFT,
+            UINavigationComponent::Direction::RIGHT,
+            UINavigationComponent::Direction::UP,
+            UINavigationComponent::Direction::DOWN
+        };
+
+        DirectionBasedNavigationAlgorithm algorithm(screen.Get());
+        ReferenceNavigation reference(screen.Get());
+
+        int64 indexedTime = 0;
+        int64 referenceTime = 0;
+        uint32 movesCount = 0;
+        for (size_t i = 0; i < buttons.size(); i += 37)
+        {
+            for (UINavigationComponent::Direction dir : directions)
+            {
+                int64 startTime = SystemTimer::GetUs();
+                UIControl* next = algorithm.GetNextControl(buttons[i], dir);
+                indexedTime += SystemTimer::GetUs() - startTime;
+
+                startTime = SystemTimer::GetUs();
+                UIControl* expected = reference.GetNextControl(buttons[i], dir);
+                referenceTime += SystemTimer::GetUs() - startTime;
+
+                TEST_VERIFY(next == expected);
+                movesCount += 1;
+            }
+        }
+
+        Logger::Info("UI directional navigation, %u controls: %.2f us per move with bounds, %.2f us per move with full scan",
+                     static_cast<uint32>(buttons.size()), indexedTime / static_cast<float64>(movesCount), referenceTime / static_cast<float64>(movesCount));
+    }
+};
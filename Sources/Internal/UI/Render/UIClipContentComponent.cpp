@@ -2,6 +2,7 @@
 #include "Engine/Engine.h"
 #include "Entity/ComponentManager.h"
 #include "Reflection/ReflectionRegistrator.h"
+#include "UI/UIControl.h"
 
 namespace DAVA
 {
@@ -33,6 +34,10 @@ UIClipContentComponent* UIClipContentComponent::Clone() const
 void UIClipContentComponent::SetEnabled(bool _enabled)
 {
     enabled = _enabled;
+    if (GetControl() != nullptr)
+    {
+        GetControl()->SetHierarchyBoundsDirty();
+    }
 }
 
 bool UIClipContentComponent::IsEnabled() const
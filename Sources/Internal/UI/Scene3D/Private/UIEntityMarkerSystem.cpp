@@ -1,8 +1,10 @@
 #include "UI/Scene3D/UIEntityMarkerSystem.h"
 #include "Debug/DVAssert.h"
 #include "Render/Highlevel/Camera.h"
+#include "Render/Highlevel/RenderObject.h"
 #include "Scene3D/Entity.h"
 #include "Scene3D/Scene.h"
+#include "Scene3D/Components/ComponentHelpers.h"
 #include "Scene3D/Components/TransformComponent.h"
 #include "UI/Scene3D/UIEntityMarkerComponent.h"
 #include "UI/Scene3D/UIEntityMarkersContainerComponent.h"
@@ -10,8 +12,49 @@
 
 #include <Math/Transform.h>
 
+#include <cmath>
+#include <limits>
+
 namespace DAVA
 {
+namespace UIEntityMarkerSystemDetails
+{
+bool IsOccluded(Entity* entity)
+{
+    // Static occlusion is coarse, but it is already calculated for current camera position
+    RenderObject* renderObject = GetRenderObject(entity);
+    return renderObject != nullptr
+    && renderObject->GetStaticOcclusionIndex() != INVALID_STATIC_OCCLUSION_INDEX
+    && (renderObject->GetFlags() & RenderObject::VISIBLE_STATIC_OCCLUSION) == 0;
+}
+
+Vector2 ClampToRect(const Rect& rect, const Vector2& position, bool behindCamera)
+{
+    if (!behindCamera)
+    {
+        return Vector2(Clamp(position.x, rect.x, rect.x + rect.dx), Clamp(position.y, rect.y, rect.y + rect.dy));
+    }
+
+    // Projection of point behind camera is mirrored relative to screen center,
+    // so marker is moved to the edge in opposite direction
+    const Vector2 center = rect.GetCenter();
+    Vector2 direction = center - position;
+    if (!std::isfinite(direction.x) || !std::isfinite(direction.y) || (direction.x == 0.f && direction.y == 0.f))
+    {
+        direction = Vector2(0.f, 1.f);
+    }
+
+    const float32 tx = (direction.x != 0.f) ? rect.dx * 0.5f / std::abs(direction.x) : std::numeric_limits<float32>::max();
+    const float32 ty = (direction.y != 0.f) ? rect.dy * 0.5f / std::abs(direction.y) : std::numeric_limits<float32>::max();
+    return center + direction * Min(tx, ty);
+}
+
+bool IsOverlapped(const Rect& a, const Rect& b, float32 spacing)
+{
+    return a.x < b.x + b.dx && b.x < a.x + a.dx && a.y < b.y + b.dy + spacing && b.y < a.y + a.dy + spacing;
+}
+}
+
 UIEntityMarkerSystem::UIEntityMarkerSystem() = default;
 
 UIEntityMarkerSystem::~UIEntityMarkerSystem() = default;
@@ -31,17 +74,7 @@ void UIEntityMarkerSystem::RegisterControl(UIControl* control)
     UIEntityMarkerComponent* marker = control->GetComponent<UIEntityMarkerComponent>();
     if (marker && control->GetParent())
     {
-        UIEntityMarkersContainerComponent* container = control->GetParent()->GetComponent<UIEntityMarkersContainerComponent>();
-        if (container)
-        {
-            auto it = std::find_if(links.begin(), links.end(), [container](const Link& l) {
-                return l.container == container;
-            });
-            if (it != links.end())
-            {
-                it->children.push_back(marker);
-            }
-        }
+        AddMarker(control->GetParent(), marker);
     }
 }
 
@@ -53,24 +86,16 @@ void UIEntityMarkerSystem::UnregisterControl(UIControl* control)
         auto it = std::find_if(links.begin(), links.end(), [container](const Link& l) {
             return l.container == container;
         });
-        links.erase(it, links.end());
+        if (it != links.end())
+        {
+            links.erase(it);
+        }
     }
 
     UIEntityMarkerComponent* marker = control->GetComponent<UIEntityMarkerComponent>();
     if (marker && control->GetParent())
     {
-        UIEntityMarkersContainerComponent* container = control->GetParent()->GetComponent<UIEntityMarkersContainerComponent>();
-        if (container)
-        {
-            auto it = std::find_if(links.begin(), links.end(), [container](const Link& l) {
-                return l.container == container;
-            });
-            if (it != links.end())
-            {
-                it->children.erase(std::find(it->children.begin(), it->children.end(), marker), it->children.end());
-                it->orderMap.erase(marker->GetControl());
-            }
-        }
+        RemoveMarker(control->GetParent(), marker);
     }
 }
 
@@ -80,7 +105,6 @@ void UIEntityMarkerSystem::RegisterComponent(UIControl* control, UIComponent* co
     {
         Link l;
         l.container = static_cast<UIEntityMarkersContainerComponent*>(component);
-        links.push_back(l);
 
         // Check children and add their markers manually
         for (const auto& child : control->GetChildren())
@@ -88,24 +112,18 @@ void UIEntityMarkerSystem::RegisterComponent(UIControl* control, UIComponent* co
             UIEntityMarkerComponent* marker = child->GetComponent<UIEntityMarkerComponent>();
             if (marker)
             {
-                l.children.push_back(marker);
+                Marker m;
+                m.component = marker;
+                l.markers.push_back(m);
             }
         }
+
+        links.push_back(l);
     }
 
     if (component->GetType() == Type::Instance<UIEntityMarkerComponent>() && control->GetParent())
     {
-        UIEntityMarkersContainerComponent* container = control->GetParent()->GetComponent<UIEntityMarkersContainerComponent>();
-        if (container)
-        {
-            auto it = std::find_if(links.begin(), links.end(), [container](const Link& l) {
-                return l.container == container;
-            });
-            if (it != links.end())
-            {
-                it->children.push_back(static_cast<UIEntityMarkerComponent*>(component));
-            }
-        }
+        AddMarker(control->GetParent(), static_cast<UIEntityMarkerComponent*>(component));
     }
 }
 
@@ -116,23 +134,50 @@ void UIEntityMarkerSystem::UnregisterComponent(UIControl* control, UIComponent*
         auto it = std::find_if(links.begin(), links.end(), [component](const Link& l) {
             return l.container == static_cast<UIEntityMarkersContainerComponent*>(component);
         });
-        links.erase(it, links.end());
+        if (it != links.end())
+        {
+            links.erase(it);
+        }
     }
 
     if (component->GetType() == Type::Instance<UIEntityMarkerComponent>() && control->GetParent())
     {
-        UIEntityMarkersContainerComponent* container = control->GetParent()->GetComponent<UIEntityMarkersContainerComponent>();
-        if (container)
+        RemoveMarker(control->GetParent(), static_cast<UIEntityMarkerComponent*>(component));
+    }
+}
+
+void UIEntityMarkerSystem::AddMarker(UIControl* containerControl, UIEntityMarkerComponent* marker)
+{
+    UIEntityMarkersContainerComponent* container = containerControl->GetComponent<UIEntityMarkersContainerComponent>();
+    if (container)
+    {
+        auto it = std::find_if(links.begin(), links.end(), [container](const Link& l) {
+            return l.container == container;
+        });
+        if (it != links.end())
+        {
+            Marker m;
+            m.component = marker;
+            it->markers.push_back(m);
+        }
+    }
+}
+
+void UIEntityMarkerSystem::RemoveMarker(UIControl* containerControl, UIEntityMarkerComponent* marker)
+{
+    UIEntityMarkersContainerComponent* container = containerControl->GetComponent<UIEntityMarkersContainerComponent>();
+    if (container)
+    {
+        auto it = std::find_if(links.begin(), links.end(), [container](const Link& l) {
+            return l.container == container;
+        });
+        if (it != links.end())
         {
-            auto it = std::find_if(links.begin(), links.end(), [container](const Link& l) {
-                return l.container == container;
-            });
-            if (it != links.end())
-            {
-                UIEntityMarkerComponent* marker = static_cast<UIEntityMarkerComponent*>(component);
-                it->children.erase(std::find(it->children.begin(), it->children.end(), marker), it->children.end());
-                it->orderMap.erase(marker->GetControl());
-            }
+            Vector<Marker>& markers = it->markers;
+            markers.erase(std::remove_if(markers.begin(), markers.end(), [marker](const Marker& m) {
+                              return m.component == marker;
+                          }),
+                          markers.end());
         }
     }
 }
@@ -141,101 +186,327 @@ void UIEntityMarkerSystem::Process(float32 elapsedTime)
 {
     for (Link& l : links)
     {
-        UnorderedMap<UIControl*, float32>& orderMap = l.orderMap;
-        UIEntityMarkersContainerComponent* container = l.container;
-        UIControl* containerControl = container->GetControl();
+        if (l.container->IsEnabled())
+        {
+            ProcessLink(l);
+        }
+    }
+}
 
-        if (!container->IsEnabled())
+void UIEntityMarkerSystem::ProcessLink(Link& link)
+{
+    using namespace UIEntityMarkerSystemDetails;
+
+    UIEntityMarkersContainerComponent* container = link.container;
+    const Rect viewport = container->GetControl()->GetAbsoluteRect();
+
+    const bool syncVisibility = container->IsSyncVisibilityEnabled();
+    const bool syncPosition = container->IsSyncPositionEnabled();
+    const bool syncScale = container->IsSyncScaleEnabled();
+    const bool syncOrder = container->IsSyncOrderEnabled();
+    const bool edgeClamp = syncPosition && container->IsEdgeClampEnabled();
+
+    // Gather world positions of targets
+    batch.clear();
+    for (uint32 i = 0, count = static_cast<uint32>(link.markers.size()); i < count; ++i)
+    {
+        Entity* target = link.markers[i].component->GetTargetEntity();
+        if (target == nullptr || target->GetScene() == nullptr)
         {
             continue;
         }
 
-        for (UIEntityMarkerComponent* marker : l.children)
+        Camera* camera = target->GetScene()->GetCurrentCamera();
+        if (camera == nullptr)
         {
-            UIControl* markerControl = marker->GetControl();
+            continue;
+        }
+
+        BatchItem item;
+        item.markerIndex = i;
+        item.target = target;
+        item.camera = camera;
+        item.worldPosition = target->GetComponent<TransformComponent>()->GetWorldTransform().GetTranslation();
+        batch.push_back(item);
+    }
+
+    // Project all positions, matrices are requested from camera only when it changes
+    Camera* camera = nullptr;
+    Matrix4 viewProjMatrix;
+    Vector3 cameraPosition;
+    Vector3 cameraDirection;
+    for (BatchItem& item : batch)
+    {
+        if (item.camera != camera)
+        {
+            camera = item.camera;
+            viewProjMatrix = camera->GetViewProjMatrix();
+            cameraPosition = camera->GetPosition();
+            cameraDirection = camera->GetDirection();
+        }
+
+        // Same as Camera::GetOnScreenPositionAndDepth
+        Vector4 pv(item.worldPosition);
+        pv = pv * viewProjMatrix;
+        item.position = Vector2(((pv.x / pv.w) * 0.5f + 0.5f) * viewport.dx + viewport.x,
+                                (1.0f - ((pv.y / pv.w) * 0.5f + 0.5f)) * viewport.dy + viewport.y);
+        item.distance = item.worldPosition - cameraPosition;
+        item.behindCamera = !(item.distance.DotProduct(cameraDirection) > 0.f);
+    }
+
+    // Visibility, position and scale
+    const Vector2& cullingMargin = container->GetCullingMargin();
+    const Rect cullingRect(viewport.x - cullingMargin.x, viewport.y - cullingMargin.y, viewport.dx + 2.f * cullingMargin.x, viewport.dy + 2.f * cullingMargin.y);
+    const Vector2& clampMargin = container->GetEdgeClampMargin();
+    const Rect clampRect(viewport.x + clampMargin.x, viewport.y + clampMargin.y, Max(viewport.dx - 2.f * clampMargin.x, 0.f), Max(viewport.dy - 2.f * clampMargin.y, 0.f));
+    const float32 maxDistance = container->GetMaxVisibleDistance();
 
-            Entity* target = marker->GetTargetEntity();
-            if (target == nullptr || target->GetScene() == nullptr)
+    for (BatchItem& item : batch)
+    {
+        if (syncVisibility)
+        {
+            if (edgeClamp)
             {
-                continue;
+                item.visible = true;
+            }
+            else if (container->IsFrustumCullingEnabled())
+            {
+                item.visible = !item.behindCamera && cullingRect.PointInside(item.position);
+            }
+            else
+            {
+                item.visible = !item.behindCamera;
             }
 
-            Camera* camera = target->GetScene()->GetCurrentCamera();
-            if (camera == nullptr)
+            if (item.visible && maxDistance > 0.f && item.distance.SquareLength() > maxDistance * maxDistance)
             {
-                continue;
+                item.visible = false;
+            }
+
+            if (item.visible && container->IsOcclusionCullingEnabled() && IsOccluded(item.target))
+            {
+                item.visible = false;
             }
+        }
 
-            TransformComponent* targetTransform = target->GetComponent<TransformComponent>();
-            Vector3 worldPosition = targetTransform->GetWorldTransform().GetTranslation();
-            Vector3 positionAndDepth = camera->GetOnScreenPositionAndDepth(worldPosition, containerControl->GetAbsoluteRect());
-            Vector3 distance = worldPosition - camera->GetPosition();
+        if (edgeClamp && (item.behindCamera || !clampRect.PointInside(item.position)))
+        {
+            item.position = ClampToRect(clampRect, item.position, item.behindCamera);
+        }
 
-            if (container->IsSyncVisibilityEnabled())
+        if (syncScale)
+        {
+            if (item.distance.SquareLength() > 0.f)
             {
-                const bool visible = distance.DotProduct(camera->GetDirection()) > 0.f;
-                markerControl->SetVisibilityFlag(visible);
+                const Vector2& factor = container->GetScaleFactor();
+                const Vector2& maxScale = container->GetMaxScale();
+                const Vector2& minScale = container->GetMinScale();
+                const float32 dis = item.distance.Length();
 
-                if (!visible)
-                {
-                    // Skip next steps for invisible controls
-                    continue;
-                }
+                item.scale = Vector2(Clamp(factor.x / dis, minScale.x, maxScale.x),
+                                     Clamp(factor.y / dis, minScale.y, maxScale.y));
             }
-
-            if (container->IsSyncPositionEnabled())
+            else
             {
-                markerControl->SetPosition(Vector2(positionAndDepth.x, positionAndDepth.y));
+                item.scale = container->GetMaxScale();
             }
+        }
+    }
+
+    if (syncPosition && container->IsDeclutterEnabled())
+    {
+        Declutter(link);
+    }
 
-            if (container->IsSyncScaleEnabled())
+    // Apply calculated values
+    for (const BatchItem& item : batch)
+    {
+        Marker& marker = link.markers[item.markerIndex];
+        UIControl* markerControl = marker.component->GetControl();
+
+        if (syncVisibility)
+        {
+            markerControl->SetVisibilityFlag(item.visible);
+
+            if (!item.visible)
             {
-                if (distance.SquareLength() > 0.f)
-                {
-                    const Vector2& factor = container->GetScaleFactor();
-                    const Vector2& maxScale = container->GetMaxScale();
-                    const Vector2& minScale = container->GetMinScale();
-                    const float32 dis = distance.Length();
+                // Skip next steps for invisible controls
+                continue;
+            }
+        }
 
-                    Vector2 scale(Clamp(factor.x / dis, minScale.x, maxScale.x),
-                                  Clamp(factor.y / dis, minScale.y, maxScale.y));
+        if (syncPosition)
+        {
+            markerControl->SetPosition(item.position);
+        }
 
-                    markerControl->SetScale(scale);
-                }
-                else
-                {
-                    markerControl->SetScale(container->GetMaxScale());
-                }
+        if (syncScale && markerControl->GetScale() != item.scale)
+        {
+            markerControl->SetScale(item.scale);
+        }
+
+        if (syncOrder)
+        {
+            switch (container->GetOrderMode())
+            {
+            case UIEntityMarkersContainerComponent::OrderMode::NearFront:
+                marker.orderKey = -item.distance.SquareLength();
+                break;
+            case UIEntityMarkersContainerComponent::OrderMode::NearBack:
+                marker.orderKey = item.distance.SquareLength();
+                break;
             }
+        }
+
+        if (container->IsUseCustomStrategy() && container->GetCustomStrategy())
+        {
+            container->GetCustomStrategy()(markerControl, container, marker.component);
+        }
+    }
+
+    if (syncOrder)
+    {
+        SyncOrder(link);
+    }
+}
+
+void UIEntityMarkerSystem::Declutter(const Link& link)
+{
+    using namespace UIEntityMarkerSystemDetails;
+
+    const UIEntityMarkersContainerComponent* container = link.container;
+    const float32 spacing = container->GetDeclutterSpacing();
+
+    // Markers of near entities are placed first and keep their positions
+    declutterOrder.clear();
+    for (uint32 i = 0, count = static_cast<uint32>(batch.size()); i < count; ++i)
+    {
+        if (batch[i].visible)
+        {
+            declutterOrder.push_back(i);
+        }
+    }
+    std::stable_sort(declutterOrder.begin(), declutterOrder.end(), [this](uint32 a, uint32 b) {
+        return batch[a].distance.SquareLength() < batch[b].distance.SquareLength();
+    });
+
+    declutterRects.clear();
+    for (uint32 index : declutterOrder)
+    {
+        BatchItem& item = batch[index];
+        const UIControl* markerControl = link.markers[item.markerIndex].component->GetControl();
+        const Vector2 scale = container->IsSyncScaleEnabled() ? item.scale : markerControl->GetScale();
+        const Vector2 pivot = markerControl->GetPivotPoint() * scale;
+        Rect rect(item.position - pivot, markerControl->GetSize() * scale);
 
-            if (container->IsSyncOrderEnabled())
+        // Stack marker above overlapped ones until it overlaps nothing, passes are limited by count of placed markers
+        bool moved = true;
+        for (size_t attempt = 0; moved && attempt <= declutterRects.size(); ++attempt)
+        {
+            moved = false;
+            for (const Rect& placed : declutterRects)
             {
-                switch (container->GetOrderMode())
+                if (IsOverlapped(rect, placed, spacing))
                 {
-                case UIEntityMarkersContainerComponent::OrderMode::NearFront:
-                    orderMap[markerControl] = -distance.SquareLength();
-                    break;
-                case UIEntityMarkersContainerComponent::OrderMode::NearBack:
-                    orderMap[markerControl] = distance.SquareLength();
-                    break;
+                    rect.y = placed.y - rect.dy - spacing;
+                    moved = true;
                 }
             }
+        }
 
-            if (container->IsUseCustomStrategy() && container->GetCustomStrategy())
-            {
-                container->GetCustomStrategy()(markerControl, container, marker);
-            }
+        declutterRects.push_back(rect);
+        item.position = rect.GetPosition() + pivot;
+    }
+}
+
+void UIEntityMarkerSystem::SyncOrder(const Link& link)
+{
+    UIControl* containerControl = link.container->GetControl();
+
+    // Order keys sorted by control for lookup while walking children, other children have zero key
+    orderKeys.clear();
+    for (const Marker& m : link.markers)
+    {
+        orderKeys.emplace_back(m.component->GetControl(), m.orderKey);
+    }
+    std::sort(orderKeys.begin(), orderKeys.end());
+
+    childrenOrder.clear();
+    bool isSorted = true;
+    for (const RefPtr<UIControl>& child : containerControl->GetChildren())
+    {
+        ChildOrder order;
+        order.control = child.Get();
+        order.index = static_cast<uint32>(childrenOrder.size());
+
+        auto it = std::lower_bound(orderKeys.begin(), orderKeys.end(), std::make_pair(order.control, std::numeric_limits<float32>::lowest()));
+        if (it != orderKeys.end() && it->first == order.control)
+        {
+            order.key = it->second;
         }
 
-        if (container->IsSyncOrderEnabled() && !orderMap.empty())
+        isSorted = isSorted && (childrenOrder.empty() || !(order.key < childrenOrder.back().key));
+        childrenOrder.push_back(order);
+    }
+
+    if (isSorted)
+    {
+        return;
+    }
+
+    // Stable sort gives the same order as sorting of children list
+    const uint32 count = static_cast<uint32>(childrenOrder.size());
+    sortedChildren.resize(count);
+    for (uint32 i = 0; i < count; ++i)
+    {
+        sortedChildren[i] = i;
+    }
+    std::stable_sort(sortedChildren.begin(), sortedChildren.end(), [this](uint32 a, uint32 b) {
+        return childrenOrder[a].key < childrenOrder[b].key;
+    });
+
+    // Children forming the longest increasing subsequence of current indices keep their places,
+    // others are moved right after their predecessors in sorted order
+    Vector<uint32> tails; // indices in sortedChildren of last elements of subsequences of each length
+    Vector<int32> previous(count, -1);
+    for (uint32 i = 0; i < count; ++i)
+    {
+        auto it = std::lower_bound(tails.begin(), tails.end(), sortedChildren[i], [this](uint32 tail, uint32 index) {
+            return sortedChildren[tail] < index;
+        });
+        if (it != tails.begin())
+        {
+            previous[i] = static_cast<int32>(*std::prev(it));
+        }
+        if (it == tails.end())
+        {
+            tails.push_back(i);
+        }
+        else
+        {
+            *it = i;
+        }
+    }
+
+    Vector<bool> keepsPlace(count, false);
+    for (int32 i = tails.empty() ? -1 : static_cast<int32>(tails.back()); i >= 0; i = previous[i])
+    {
+        keepsPlace[i] = true;
+    }
+
+    for (uint32 i = 0; i < count; ++i)
+    {
+        if (!keepsPlace[i])
         {
-            containerControl->SortChildren([&orderMap](const RefPtr<UIControl>& a, const RefPtr<UIControl>& b) {
-                auto itA = orderMap.find(a.Get());
-                auto itB = orderMap.find(b.Get());
-                float32 valA = itA != orderMap.end() ? itA->second : 0.f;
-                float32 valB = itB != orderMap.end() ? itB->second : 0.f;
-                return valA < valB;
-            });
+            UIControl* control = childrenOrder[sortedChildren[i]].control;
+            if (i == 0)
+            {
+                containerControl->BringChildBack(control);
+            }
+            else
+            {
+                containerControl->SendChildAbove(control, childrenOrder[sortedChildren[i - 1]].control);
+            }
         }
     }
 }
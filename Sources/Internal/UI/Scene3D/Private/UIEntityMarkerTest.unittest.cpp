@@ -4,10 +4,14 @@
 #include "Base/RefPtr.h"
 #include "Base/ScopedPtr.h"
 #include "Engine/Engine.h"
+#include "Logger/Logger.h"
 #include "Render/Highlevel/Camera.h"
+#include "Render/Highlevel/RenderObject.h"
 #include "Scene3D/Components/CameraComponent.h"
+#include "Scene3D/Components/RenderComponent.h"
 #include "Scene3D/Components/TransformComponent.h"
 #include "Scene3D/Scene.h"
+#include "Time/SystemTimer.h"
 #include "UI/Scene3D/UIEntityMarkerComponent.h"
 #include "UI/Scene3D/UIEntityMarkersContainerComponent.h"
 #include "UI/Scene3D/UIEntityMarkerSystem.h"
@@ -15,6 +19,65 @@
 #include "UI/UIControl.h"
 #include "UI/UIControlSystem.h"
 #include "UI/UIScreen.h"
+#include "Utils/StringFormat.h"
+
+#include <cmath>
+
+namespace UIEntityMarkerTestDetails
+{
+using namespace DAVA;
+
+const uint32 BENCHMARK_MARKERS_COUNT = 200;
+const uint32 BENCHMARK_FRAMES = 100;
+
+struct ReferenceState
+{
+    bool visible = true;
+    Vector2 position;
+    Vector2 scale;
+};
+
+// Per-marker processing of UIEntityMarkerSystem with default container settings, before markers were batched
+void CalculateReference(UIControl* container, Camera* camera, Map<UIControl*, float32>& orderMap, Map<UIControl*, ReferenceState>& states, List<UIControl*>& order)
+{
+    UIEntityMarkersContainerComponent* emcc = container->GetComponent<UIEntityMarkersContainerComponent>();
+    for (const RefPtr<UIControl>& child : container->GetChildren())
+    {
+        Entity* target = child->GetComponent<UIEntityMarkerComponent>()->GetTargetEntity();
+        Vector3 worldPosition = target->GetComponent<TransformComponent>()->GetWorldTransform().GetTranslation();
+        Vector3 positionAndDepth = camera->GetOnScreenPositionAndDepth(worldPosition, container->GetAbsoluteRect());
+        Vector3 distance = worldPosition - camera->GetPosition();
+
+        ReferenceState& state = states[child.Get()];
+        state.visible = distance.DotProduct(camera->GetDirection()) > 0.f;
+        if (!state.visible)
+        {
+            continue;
+        }
+
+        state.position = Vector2(positionAndDepth.x, positionAndDepth.y);
+
+        const float32 dis = distance.Length();
+        state.scale = Vector2(Clamp(emcc->GetScaleFactor().x / dis, emcc->GetMinScale().x, emcc->GetMaxScale().x),
+                              Clamp(emcc->GetScaleFactor().y / dis, emcc->GetMinScale().y, emcc->GetMaxScale().y));
+
+        orderMap[child.Get()] = -distance.SquareLength();
+    }
+
+    order.clear();
+    for (const RefPtr<UIControl>& child : container->GetChildren())
+    {
+        order.push_back(child.Get());
+    }
+    order.sort([&orderMap](UIControl* a, UIControl* b) {
+        auto itA = orderMap.find(a);
+        auto itB = orderMap.find(b);
+        float32 valA = itA != orderMap.end() ? itA->second : 0.f;
+        float32 valB = itB != orderMap.end() ? itB->second : 0.f;
+        return valA < valB;
+    });
+}
+}
 
 DAVA_TESTCLASS (UIEntityMarkerTest)
 {
@@ -57,6 +120,34 @@ DAVA_TESTCLASS (UIEntityMarkerTest)
         return control;
     }
 
+    // Markers of entities scattered around origin, positions are the same in every run
+    DAVA::Vector<DAVA::RefPtr<DAVA::UIControl>> CreateMarkers(DAVA::uint32 count)
+    {
+        using namespace DAVA;
+
+        uint32 seed = 1;
+        auto random = [&seed]() {
+            seed = seed * 1664525u + 1013904223u;
+            return static_cast<float32>(seed >> 8) / static_cast<float32>(1 << 24);
+        };
+
+        Vector<RefPtr<UIControl>> result;
+        for (uint32 i = 0; i < count; ++i)
+        {
+            Vector3 position(random() * 40.f - 20.f, random() * 40.f - 20.f, random() * 4.f - 2.f);
+            RefPtr<Entity> entity = CreateEntity(FastName(Format("MARKER_%u", i)), position);
+            scene->AddNode(entity.Get());
+
+            RefPtr<UIControl> control = CreateControl(entity.Get());
+            control->SetSize(Vector2(60.f, 16.f));
+            markers->AddControl(control.Get());
+            result.push_back(control);
+        }
+
+        SystemsUpdate(0.f);
+        return result;
+    }
+
     void SetUp(const DAVA::String& testName) override
     {
         using namespace DAVA;
@@ -246,6 +337,217 @@ DAVA_TESTCLASS (UIEntityMarkerTest)
         }
     }
 
+    DAVA_TEST (ReferenceSemanticsTest)
+    {
+        using namespace DAVA;
+        using namespace UIEntityMarkerTestDetails;
+
+        CreateMarkers(BENCHMARK_MARKERS_COUNT);
+
+        emcc->SetSyncVisibilityEnabled(true);
+        emcc->SetSyncPositionEnabled(true);
+        emcc->SetSyncScaleEnabled(true);
+        emcc->SetSyncOrderEnabled(true);
+        emcc->SetOrderMode(UIEntityMarkersContainerComponent::OrderMode::NearFront);
+
+        const struct
+        {
+            Vector3 camPos;
+            Vector3 camTarget;
+        } testData[] = {
+            { { 0.f, -25.f, 0.f }, { 0.f, 0.f, 0.f } },
+            { { 0.f, 0.f, 0.f }, { 1.f, 0.f, 0.f } },
+            { { 10.f, 10.f, 1.f }, { 0.f, 0.f, 0.f } },
+            { { -30.f, 5.f, 2.f }, { 0.f, 0.f, 0.f } },
+            { { 0.f, -25.f, 0.f }, { 0.f, 0.f, 0.f } }
+        };
+
+        // Reference keeps order keys of hidden markers between frames, as system does
+        Map<UIControl*, float32> orderMap;
+        for (const auto& test : testData)
+        {
+            camera->SetPosition(test.camPos);
+            camera->SetTarget(test.camTarget);
+
+            Map<UIControl*, ReferenceState> states;
+            List<UIControl*> order;
+            CalculateReference(markers.Get(), camera.Get(), orderMap, states, order);
+
+            SystemsUpdate(0.f);
+
+            for (const auto& pair : states)
+            {
+                UIControl* c = pair.first;
+                const ReferenceState& state = pair.second;
+                TEST_VERIFY(c->GetVisibilityFlag() == state.visible);
+                if (state.visible)
+                {
+                    TEST_VERIFY(FLOAT_EQUAL_EPS(c->GetPosition().x, state.position.x, 0.01f));
+                    TEST_VERIFY(FLOAT_EQUAL_EPS(c->GetPosition().y, state.position.y, 0.01f));
+                    TEST_VERIFY(FLOAT_EQUAL_EPS(c->GetScale().x, state.scale.x, 0.001f));
+                    TEST_VERIFY(FLOAT_EQUAL_EPS(c->GetScale().y, state.scale.y, 0.001f));
+                }
+            }
+
+            const List<RefPtr<UIControl>>& children = markers->GetChildren();
+            TEST_VERIFY(children.size() == order.size());
+            TEST_VERIFY(std::equal(order.begin(), order.end(), children.begin(), [](UIControl* a, const RefPtr<UIControl>& b) {
+                return a == b.Get();
+            }));
+        }
+    }
+
+    DAVA_TEST (CullingTest)
+    {
+        using namespace DAVA;
+
+        // c1 is projected outside of container rect, c2 is inside
+        emcc->SetSyncVisibilityEnabled(true);
+        SystemsUpdate(0.f);
+        TEST_VERIFY(c1->GetVisibilityFlag() && c2->GetVisibilityFlag());
+
+        emcc->SetFrustumCullingEnabled(true);
+        SystemsUpdate(0.f);
+        TEST_VERIFY(!c1->GetVisibilityFlag() && c2->GetVisibilityFlag());
+
+        emcc->SetCullingMargin(Vector2(150.f, 150.f));
+        SystemsUpdate(0.f);
+        TEST_VERIFY(c1->GetVisibilityFlag() && c2->GetVisibilityFlag());
+
+        // c1 is 1.73 units far from camera, c2 is 3.32 units far
+        emcc->SetFrustumCullingEnabled(false);
+        emcc->SetMaxVisibleDistance(2.f);
+        SystemsUpdate(0.f);
+        TEST_VERIFY(c1->GetVisibilityFlag() && !c2->GetVisibilityFlag());
+
+        emcc->SetMaxVisibleDistance(0.f);
+        SystemsUpdate(0.f);
+        TEST_VERIFY(c1->GetVisibilityFlag() && c2->GetVisibilityFlag());
+    }
+
+    DAVA_TEST (OcclusionCullingTest)
+    {
+        using namespace DAVA;
+
+        Entity* target = c2->GetComponent<UIEntityMarkerComponent>()->GetTargetEntity();
+        ScopedPtr<RenderObject> renderObject(new RenderObject());
+        target->AddComponent(new RenderComponent(renderObject));
+        renderObject->SetStaticOcclusionIndex(0);
+        renderObject->RemoveFlag(RenderObject::VISIBLE_STATIC_OCCLUSION);
+
+        emcc->SetSyncVisibilityEnabled(true);
+        SystemsUpdate(0.f);
+        TEST_VERIFY(c1->GetVisibilityFlag() && c2->GetVisibilityFlag());
+
+        emcc->SetOcclusionCullingEnabled(true);
+        SystemsUpdate(0.f);
+        TEST_VERIFY(c1->GetVisibilityFlag() && !c2->GetVisibilityFlag());
+
+        renderObject->AddFlag(RenderObject::VISIBLE_STATIC_OCCLUSION);
+        SystemsUpdate(0.f);
+        TEST_VERIFY(c1->GetVisibilityFlag() && c2->GetVisibilityFlag());
+    }
+
+    DAVA_TEST (EdgeClampTest)
+    {
+        using namespace DAVA;
+
+        emcc->SetSyncVisibilityEnabled(true);
+        emcc->SetSyncPositionEnabled(true);
+        emcc->SetFrustumCullingEnabled(true);
+        emcc->SetEdgeClampEnabled(true);
+        emcc->SetEdgeClampMargin(Vector2(10.f, 10.f));
+        SystemsUpdate(0.f);
+
+        // c1 is projected to (-107, 607) and is clamped to the corner, c2 is inside container
+        TEST_VERIFY(c1->GetVisibilityFlag());
+        TEST_VERIFY(FLOAT_EQUAL_EPS(c1->GetPosition().x, 10.f, 0.1f));
+        TEST_VERIFY(FLOAT_EQUAL_EPS(c1->GetPosition().y, 490.f, 0.1f));
+        TEST_VERIFY(FLOAT_EQUAL_EPS(c2->GetPosition().x, 369.f, 0.1f));
+        TEST_VERIFY(FLOAT_EQUAL_EPS(c2->GetPosition().y, 131.f, 0.1f));
+
+        // Entity behind camera stays visible on container edge
+        camera->SetPosition(Vector3(0.f, .5f, 0.f));
+        SystemsUpdate(0.f);
+        const Vector2& pos = c2->GetPosition();
+        TEST_VERIFY(c2->GetVisibilityFlag());
+        TEST_VERIFY(pos.x >= 9.9f && pos.x <= 490.1f && pos.y >= 9.9f && pos.y <= 490.1f);
+        TEST_VERIFY(FLOAT_EQUAL_EPS(pos.x, 10.f, 0.1f) || FLOAT_EQUAL_EPS(pos.x, 490.f, 0.1f) || FLOAT_EQUAL_EPS(pos.y, 10.f, 0.1f) || FLOAT_EQUAL_EPS(pos.y, 490.f, 0.1f));
+    }
+
+    DAVA_TEST (DeclutterTest)
+    {
+        using namespace DAVA;
+
+        // Both entities are projected to the same point near container center
+        const struct
+        {
+            RefPtr<UIControl> c;
+            Vector3 position;
+        } targets[] = {
+            { c1, { 0.f, 0.f, 0.f } },
+            { c2, { 0.f, 2.f, 0.f } }
+        };
+        for (const auto& t : targets)
+        {
+            Entity* entity = t.c->GetComponent<UIEntityMarkerComponent>()->GetTargetEntity();
+            entity->GetComponent<TransformComponent>()->SetLocalTransform(Matrix4::MakeTranslation(t.position));
+        }
+        c1->SetSize(Vector2(100.f, 20.f));
+        c2->SetSize(Vector2(100.f, 20.f));
+
+        emcc->SetSyncPositionEnabled(true);
+        SystemsUpdate(0.f);
+        SystemsUpdate(0.f);
+        TEST_VERIFY(FLOAT_EQUAL_EPS(c1->GetPosition().y, c2->GetPosition().y, 0.1f));
+
+        emcc->SetDeclutterEnabled(true);
+        emcc->SetDeclutterSpacing(2.f);
+        SystemsUpdate(0.f);
+
+        // Marker of near entity keeps its place, marker of far one is stacked above it
+        TEST_VERIFY(FLOAT_EQUAL_EPS(c1->GetPosition().x, 250.f, 0.1f));
+        TEST_VERIFY(FLOAT_EQUAL_EPS(c1->GetPosition().y, 250.f, 0.1f));
+        TEST_VERIFY(FLOAT_EQUAL_EPS(c2->GetPosition().x, 250.f, 0.1f));
+        TEST_VERIFY(FLOAT_EQUAL_EPS(c2->GetPosition().y, 250.f - 22.f, 0.1f));
+    }
+
+    DAVA_TEST (BenchmarkTest)
+    {
+        using namespace DAVA;
+        using namespace UIEntityMarkerTestDetails;
+
+        CreateMarkers(BENCHMARK_MARKERS_COUNT);
+
+        emcc->SetSyncVisibilityEnabled(true);
+        emcc->SetSyncPositionEnabled(true);
+        emcc->SetSyncScaleEnabled(true);
+        emcc->SetSyncOrderEnabled(true);
+
+        auto measure = [this]() {
+            int64 startTime = SystemTimer::GetUs();
+            for (uint32 frame = 0; frame < BENCHMARK_FRAMES; ++frame)
+            {
+                float32 angle = frame * 0.05f;
+                camera->SetPosition(Vector3(std::cos(angle) * 25.f, std::sin(angle) * 25.f, 3.f));
+                camera->SetTarget(Vector3(0.f, 0.f, 0.f));
+                SystemsUpdate(1.f / 60.f);
+            }
+            return SystemTimer::GetUs() - startTime;
+        };
+
+        int64 syncTime = measure();
+
+        emcc->SetFrustumCullingEnabled(true);
+        emcc->SetMaxVisibleDistance(40.f);
+        emcc->SetDeclutterEnabled(true);
+        int64 declutterTime = measure();
+
+        Logger::Info("[UIEntityMarkerTest] %u markers, %u frames of UI update: %lld us with synchronization, %lld us with culling and declutter",
+                     BENCHMARK_MARKERS_COUNT, BENCHMARK_FRAMES, syncTime, declutterTime);
+        TEST_VERIFY(markers->GetChildren().size() == BENCHMARK_MARKERS_COUNT + 2);
+    }
+
     DAVA_TEST (CustomStrategyTest)
     {
         using namespace DAVA;
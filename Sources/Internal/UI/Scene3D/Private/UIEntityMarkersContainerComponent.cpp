@@ -26,6 +26,14 @@ DAVA_VIRTUAL_REFLECTION_IMPL(UIEntityMarkersContainerComponent)
     .Field("minScale", &UIEntityMarkersContainerComponent::GetMinScale, &UIEntityMarkersContainerComponent::SetMinScale)
     .Field("syncOrderEnabled", &UIEntityMarkersContainerComponent::IsSyncOrderEnabled, &UIEntityMarkersContainerComponent::SetSyncOrderEnabled)
     .Field("orderMode", &UIEntityMarkersContainerComponent::GetOrderMode, &UIEntityMarkersContainerComponent::SetOrderMode)[M::EnumT<OrderMode>()]
+    .Field("frustumCullingEnabled", &UIEntityMarkersContainerComponent::IsFrustumCullingEnabled, &UIEntityMarkersContainerComponent::SetFrustumCullingEnabled)
+    .Field("cullingMargin", &UIEntityMarkersContainerComponent::GetCullingMargin, &UIEntityMarkersContainerComponent::SetCullingMargin)
+    .Field("maxVisibleDistance", &UIEntityMarkersContainerComponent::GetMaxVisibleDistance, &UIEntityMarkersContainerComponent::SetMaxVisibleDistance)
+    .Field("occlusionCullingEnabled", &UIEntityMarkersContainerComponent::IsOcclusionCullingEnabled, &UIEntityMarkersContainerComponent::SetOcclusionCullingEnabled)
+    .Field("declutterEnabled", &UIEntityMarkersContainerComponent::IsDeclutterEnabled, &UIEntityMarkersContainerComponent::SetDeclutterEnabled)
+    .Field("declutterSpacing", &UIEntityMarkersContainerComponent::GetDeclutterSpacing, &UIEntityMarkersContainerComponent::SetDeclutterSpacing)
+    .Field("edgeClampEnabled", &UIEntityMarkersContainerComponent::IsEdgeClampEnabled, &UIEntityMarkersContainerComponent::SetEdgeClampEnabled)
+    .Field("edgeClampMargin", &UIEntityMarkersContainerComponent::GetEdgeClampMargin, &UIEntityMarkersContainerComponent::SetEdgeClampMargin)
     .Field("useCustomStrategy", &UIEntityMarkersContainerComponent::IsUseCustomStrategy, &UIEntityMarkersContainerComponent::SetUseCustomStrategy)
     .Field("customStrategy", &UIEntityMarkersContainerComponent::GetCustomStrategy, &UIEntityMarkersContainerComponent::SetCustomStrategy)[M::HiddenField()]
     .End();
@@ -47,6 +55,14 @@ UIEntityMarkersContainerComponent::UIEntityMarkersContainerComponent(const UIEnt
     , maxScale(src.maxScale)
     , syncOrderEnabled(src.syncOrderEnabled)
     , orderMode(src.orderMode)
+    , frustumCullingEnabled(src.frustumCullingEnabled)
+    , cullingMargin(src.cullingMargin)
+    , maxVisibleDistance(src.maxVisibleDistance)
+    , occlusionCullingEnabled(src.occlusionCullingEnabled)
+    , declutterEnabled(src.declutterEnabled)
+    , declutterSpacing(src.declutterSpacing)
+    , edgeClampEnabled(src.edgeClampEnabled)
+    , edgeClampMargin(src.edgeClampMargin)
     , useCustomStrategy(src.useCustomStrategy)
     , customStrategy(src.customStrategy)
 {
@@ -102,6 +118,46 @@ void UIEntityMarkersContainerComponent::SetOrderMode(OrderMode mode)
     orderMode = mode;
 }
 
+void UIEntityMarkersContainerComponent::SetFrustumCullingEnabled(bool enable)
+{
+    frustumCullingEnabled = enable;
+}
+
+void UIEntityMarkersContainerComponent::SetCullingMargin(const Vector2& margin)
+{
+    cullingMargin = margin;
+}
+
+void UIEntityMarkersContainerComponent::SetMaxVisibleDistance(float32 distance)
+{
+    maxVisibleDistance = distance;
+}
+
+void UIEntityMarkersContainerComponent::SetOcclusionCullingEnabled(bool enable)
+{
+    occlusionCullingEnabled = enable;
+}
+
+void UIEntityMarkersContainerComponent::SetDeclutterEnabled(bool enable)
+{
+    declutterEnabled = enable;
+}
+
+void UIEntityMarkersContainerComponent::SetDeclutterSpacing(float32 spacing)
+{
+    declutterSpacing = spacing;
+}
+
+void UIEntityMarkersContainerComponent::SetEdgeClampEnabled(bool enable)
+{
+    edgeClampEnabled = enable;
+}
+
+void UIEntityMarkersContainerComponent::SetEdgeClampMargin(const Vector2& margin)
+{
+    edgeClampMargin = margin;
+}
+
 void UIEntityMarkersContainerComponent::SetUseCustomStrategy(bool enable)
 {
     useCustomStrategy = enable;
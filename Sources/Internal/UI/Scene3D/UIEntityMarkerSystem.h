@@ -2,16 +2,27 @@
 
 #include "Base/BaseTypes.h"
 #include "Base/Vector.h"
+#include "Math/Rect.h"
+#include "Math/Vector.h"
 #include "UI/UISystem.h"
 
 namespace DAVA
 {
+class Camera;
+class Entity;
 class UIComponent;
 class UIControl;
 class UIEntityMarkerComponent;
 class UIEntityMarkersContainerComponent;
 
-/** System for synchronization params between UIControl and Entity. */
+/**
+    System for synchronization params between UIControl and Entity.
+
+    Markers of every container are processed as a batch: target positions are gathered and projected
+    in one pass, then visibility, position, scale and order are calculated, and controls are changed
+    only when calculated values differ from current ones. Children of container are reordered
+    incrementally, only markers whose order has changed are moved.
+*/
 class UIEntityMarkerSystem : public UISystem
 {
 public:
@@ -27,13 +38,53 @@ protected:
     void Process(float32 elapsedTime) override;
 
 private:
+    struct Marker
+    {
+        UIEntityMarkerComponent* component = nullptr;
+        float32 orderKey = 0.f;
+    };
+
     struct Link
     {
         UIEntityMarkersContainerComponent* container = nullptr;
-        Vector<UIEntityMarkerComponent*> children;
-        UnorderedMap<UIControl*, float32> orderMap;
+        Vector<Marker> markers;
+    };
+
+    struct BatchItem
+    {
+        uint32 markerIndex = 0;
+        Entity* target = nullptr;
+        Camera* camera = nullptr;
+        Vector3 worldPosition;
+        Vector3 distance;
+        Vector2 position;
+        Vector2 scale;
+        bool behindCamera = false;
+        bool visible = true;
     };
 
+    struct ChildOrder
+    {
+        UIControl* control = nullptr;
+        float32 key = 0.f;
+        uint32 index = 0;
+    };
+
+    void AddMarker(UIControl* containerControl, UIEntityMarkerComponent* marker);
+    void RemoveMarker(UIControl* containerControl, UIEntityMarkerComponent* marker);
+
+    void ProcessLink(Link& link);
+    void Declutter(const Link& link);
+    void SyncOrder(const Link& link);
+
     Vector<Link> links;
+
+    // Buffers reused between frames
+    Vector<BatchItem> batch;
+    Vector<uint32> declutterOrder;
+    Vector<Rect> declutterRects;
+    Vector<std::pair<UIControl*, float32>> orderKeys;
+    Vector<ChildOrder> childrenOrder;
+    Vector<uint32> sortedChildren;
 };
-}
\ No newline at end of file
+}
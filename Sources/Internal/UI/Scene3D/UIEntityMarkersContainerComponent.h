@@ -76,6 +76,41 @@ public:
     /** Setup ordering mode. */
     void SetOrderMode(OrderMode mode);
 
+    /** Return frustum culling flag. */
+    bool IsFrustumCullingEnabled() const;
+    /** Setup frustum culling flag. Markers outside of container rect expanded by culling margin will be hidden. Works with visibility synchronization. */
+    void SetFrustumCullingEnabled(bool enable);
+    /** Return culling margin value. */
+    const Vector2& GetCullingMargin() const;
+    /** Setup culling margin value in pixels. */
+    void SetCullingMargin(const Vector2& margin);
+    /** Return maximum visible distance value. */
+    float32 GetMaxVisibleDistance() const;
+    /** Setup maximum visible distance value. Markers of farther Entities will be hidden, zero disables distance culling. Works with visibility synchronization. */
+    void SetMaxVisibleDistance(float32 distance);
+    /** Return occlusion culling flag. */
+    bool IsOcclusionCullingEnabled() const;
+    /** Setup occlusion culling flag. Markers of Entities occluded by static occlusion will be hidden. Works with visibility synchronization. */
+    void SetOcclusionCullingEnabled(bool enable);
+
+    /** Return declutter flag. */
+    bool IsDeclutterEnabled() const;
+    /** Setup declutter flag. Overlapped markers will be stacked up, markers for near Entities stay in place. Works with position synchronization. */
+    void SetDeclutterEnabled(bool enable);
+    /** Return declutter spacing value. */
+    float32 GetDeclutterSpacing() const;
+    /** Setup vertical spacing between stacked markers in pixels. */
+    void SetDeclutterSpacing(float32 spacing);
+
+    /** Return screen edge clamping flag. */
+    bool IsEdgeClampEnabled() const;
+    /** Setup screen edge clamping flag. Markers outside of container rect or behind camera will be clamped to rect edges and stay visible. Works with position synchronization. */
+    void SetEdgeClampEnabled(bool enable);
+    /** Return edge clamp margin value. */
+    const Vector2& GetEdgeClampMargin() const;
+    /** Setup edge clamp margin value, distance in pixels between clamped markers and container rect edges. */
+    void SetEdgeClampMargin(const Vector2& margin);
+
     /** Return using custom strategy flag. */
     bool IsUseCustomStrategy() const;
     /** Setup using custom strategy flag. */
@@ -102,6 +137,16 @@ private:
     // Order
     bool syncOrderEnabled = false;
     OrderMode orderMode = OrderMode::NearFront;
+    // Culling
+    bool frustumCullingEnabled = false;
+    Vector2 cullingMargin;
+    float32 maxVisibleDistance = 0.f;
+    bool occlusionCullingEnabled = false;
+    // Declutter
+    bool declutterEnabled = false;
+    float32 declutterSpacing = 2.f;
+    bool edgeClampEnabled = false;
+    Vector2 edgeClampMargin;
     // Custom strategy
     bool useCustomStrategy = false;
     CustomStrategy customStrategy;
@@ -152,6 +197,46 @@ inline UIEntityMarkersContainerComponent::OrderMode UIEntityMarkersContainerComp
     return orderMode;
 }
 
+inline bool UIEntityMarkersContainerComponent::IsFrustumCullingEnabled() const
+{
+    return frustumCullingEnabled;
+}
+
+inline const Vector2& UIEntityMarkersContainerComponent::GetCullingMargin() const
+{
+    return cullingMargin;
+}
+
+inline float32 UIEntityMarkersContainerComponent::GetMaxVisibleDistance() const
+{
+    return maxVisibleDistance;
+}
+
+inline bool UIEntityMarkersContainerComponent::IsOcclusionCullingEnabled() const
+{
+    return occlusionCullingEnabled;
+}
+
+inline bool UIEntityMarkersContainerComponent::IsDeclutterEnabled() const
+{
+    return declutterEnabled;
+}
+
+inline float32 UIEntityMarkersContainerComponent::GetDeclutterSpacing() const
+{
+    return declutterSpacing;
+}
+
+inline bool UIEntityMarkersContainerComponent::IsEdgeClampEnabled() const
+{
+    return edgeClampEnabled;
+}
+
+inline const Vector2& UIEntityMarkersContainerComponent::GetEdgeClampMargin() const
+{
+    return edgeClampMargin;
+}
+
 inline bool UIEntityMarkersContainerComponent::IsUseCustomStrategy() const
 {
     return useCustomStrategy;
@@ -1,11 +1,14 @@
 #include "UI/Text/UITextSystem.h"
 
+#include "Concurrency/Atomic.h"
 #include "Concurrency/Thread.h"
 #include "Debug/ProfilerCPU.h"
 #include "Debug/ProfilerMarkerNames.h"
 #include "Engine/Engine.h"
 #include "Entity/Component.h"
+#include "Job/JobManager.h"
 #include "Render/2D/FontManager.h"
+#include "Render/2D/TextBlock.h"
 #include "UI/Text/UITextComponent.h"
 #include "UI/UIControl.h"
 #include "UITextSystemLink.h"
@@ -13,6 +16,30 @@
 
 namespace DAVA
 {
+namespace UITextSystemDetails
+{
+// Smaller batches are laid out on the main thread, it is cheaper than jobs scheduling
+const size_t MIN_BLOCKS_FOR_PARALLEL_LAYOUT = 16;
+const size_t MIN_BLOCKS_PER_JOB = 8;
+
+struct LayoutBatch
+{
+    Vector<TextBlock*> blocks;
+    Atomic<uint32> nextBlock;
+    Atomic<uint32> finishedBlocks;
+
+    void Process()
+    {
+        const uint32 count = static_cast<uint32>(blocks.size());
+        for (uint32 index = nextBlock++; index < count; index = nextBlock++)
+        {
+            blocks[index]->CalculateCacheParamsIfNeed();
+            finishedBlocks++;
+        }
+    }
+};
+}
+
 UITextSystem::~UITextSystem()
 {
     for (UITextComponent* component : components)
@@ -40,6 +67,66 @@ void UITextSystem::Process(float32 elapsedTime)
             ApplyData(component);
         }
     }
+
+    if (parallelLayoutEnabled)
+    {
+        CalculateLayouts();
+    }
+}
+
+void UITextSystem::CalculateLayouts()
+{
+    using namespace UITextSystemDetails;
+
+    layoutQueue.clear();
+    for (UITextComponent* component : components)
+    {
+        if (component != nullptr)
+        {
+            TextBlock* textBlock = component->GetLink()->GetTextBlock();
+            if (textBlock->NeedCalculateCacheParams())
+            {
+                layoutQueue.push_back(textBlock);
+            }
+        }
+    }
+
+    if (layoutQueue.empty())
+    {
+        return;
+    }
+
+    DAVA_PROFILER_CPU_SCOPE(ProfilerCPUMarkerName::UI_TEXTBLOCK_BATCH_LAYOUT);
+
+    JobManager* jobManager = GetEngineContext()->jobManager;
+    uint32 workersCount = jobManager != nullptr ? jobManager->GetWorkersCount() : 0;
+    if (layoutQueue.size() < MIN_BLOCKS_FOR_PARALLEL_LAYOUT || workersCount == 0)
+    {
+        for (TextBlock* textBlock : layoutQueue)
+        {
+            textBlock->CalculateCacheParamsIfNeed();
+        }
+        return;
+    }
+
+    // Batch is shared with jobs, so jobs started after the batch is complete just find nothing to do.
+    // Main thread takes part in processing and then waits only for blocks already taken by workers.
+    std::shared_ptr<LayoutBatch> batch = std::make_shared<LayoutBatch>();
+    batch->blocks = layoutQueue;
+
+    size_t jobsCount = Min(static_cast<size_t>(workersCount), batch->blocks.size() / MIN_BLOCKS_PER_JOB);
+    for (size_t i = 0; i < jobsCount; ++i)
+    {
+        jobManager->CreateWorkerJob([batch]() { batch->Process(); });
+    }
+
+    batch->Process();
+
+    const uint32 count = static_cast<uint32>(batch->blocks.size());
+    while (batch->finishedBlocks.Get() < count)
+    {
+        Thread::Yield();
+    }
 }
 
 void UITextSystem::ApplyData(UITextComponent* component)
@@ -220,6 +307,11 @@ void UITextSystem::RemoveLink(UITextComponent* component)
     }
 }
 
+void UITextSystem::SetParallelLayoutEnabled(bool enabled)
+{
+    parallelLayoutEnabled = enabled;
+}
+
 void UITextSystem::InvalidateAll()
 {
     for (UITextComponent* component : components)
@@ -9,6 +9,7 @@ namespace DAVA
 {
 class UIControl;
 class UITextComponent;
+class TextBlock;
 
 /** 
     Text component support system. 
@@ -35,10 +36,25 @@ public:
     /** Mark all components as modified, for forced refresh. */
     void InvalidateAll();
 
+    /**
+        Enable layout of modified text blocks on worker threads before UILayoutSystem.
+        Result is the same as with serial (lazy) layout. Enabled by default.
+    */
+    void SetParallelLayoutEnabled(bool enabled);
+    bool IsParallelLayoutEnabled() const;
+
 private:
     void AddLink(UITextComponent* component);
     void RemoveLink(UITextComponent* component);
+    void CalculateLayouts();
 
     Vector<UITextComponent*> components;
+    Vector<TextBlock*> layoutQueue;
+    bool parallelLayoutEnabled = true;
 };
+
+inline bool UITextSystem::IsParallelLayoutEnabled() const
+{
+    return parallelLayoutEnabled;
+}
 }
@@ -1,5 +1,8 @@
 #include <Base/BaseTypes.h>
 #include <Base/RefPtr.h>
+#include <Logger/Logger.h>
+#include <Render/2D/FTFont.h>
+#include <Time/SystemTimer.h>
 #include <UI/DefaultUIPackageBuilder.h>
 #include <UI/Text/UITextComponent.h>
 #include <UI/Text/UITextSystem.h>
@@ -7,6 +10,7 @@
 #include <UI/UIControlSystem.h>
 #include <UI/UIPackageLoader.h>
 #include <UI/UIScreen.h>
+#include "Utils/StringFormat.h"
 #include "Utils/UTF8Utils.h"
 
 #include "UnitTests/UnitTests.h"
@@ -56,6 +60,76 @@ DAVA_TESTCLASS (UITextSystemTest)
         return (FLOAT_EQUAL(a.x, b.x) && FLOAT_EQUAL(a.y, b.y));
     }
 
+    // Labels with multiline text in two "locales" for layout tests
+    String GetLabelText(uint32 index, bool secondLocale)
+    {
+        if (secondLocale)
+        {
+            return Format("%u. \xD0\xA1\xD1\x8A\xD0\xB5\xD1\x88\xD1\x8C \xD0\xB6\xD0\xB5 \xD0\xB5\xD1\x89\xD1\x91 \xD1\x8D\xD1\x82\xD0\xB8\xD1\x85 "
+                          "\xD0\xBC\xD1\x8F\xD0\xB3\xD0\xBA\xD0\xB8\xD1\x85 \xD1\x84\xD1\x80\xD0\xB0\xD0\xBD\xD1\x86\xD1\x83\xD0\xB7\xD1\x81\xD0\xBA\xD0\xB8\xD1\x85 "
+                          "\xD0\xB1\xD1\x83\xD0\xBB\xD0\xBE\xD0\xBA, \xD0\xB4\xD0\xB0 \xD0\xB2\xD1\x8B\xD0\xBF\xD0\xB5\xD0\xB9 \xD1\x87\xD0\xB0\xD1\x8E. "
+                          "%u \xD0\xBE\xD1\x87\xD0\xBA\xD0\xBE\xD0\xB2 \xD0\xBE\xD0\xBF\xD1\x8B\xD1\x82\xD0\xB0",
+                          index, index * 7);
+        }
+        return Format("%u. Lorem ipsum dolor sit amet, consectetur adipiscing elit. Nunc elementum lectus quis mauris molestie, "
+                      "sed consectetur risus dictum. %u experience points",
+                      index, index * 7);
+    }
+
+    Vector<RefPtr<UIControl>> CreateLabels(uint32 count, const RefPtr<Font>& font)
+    {
+        Vector<RefPtr<UIControl>> labels;
+        for (uint32 i = 0; i < count; ++i)
+        {
+            RefPtr<UIControl> label(new UIControl(Rect(0.f, 0.f, 150.f + (i % 5) * 20.f, 80.f)));
+            UITextComponent* text = label->GetOrCreateComponent<UITextComponent>();
+            text->SetFont(font);
+            text->SetFontSize(14.f);
+            text->SetMultiline(UITextComponent::eTextMultiline::MULTILINE_ENABLED);
+            text->SetAlign((i % 2) == 0 ? ALIGN_LEFT | ALIGN_TOP : ALIGN_HCENTER | ALIGN_VCENTER);
+            text->SetFitting((i % 3) == 0 ? UITextComponent::eTextFitting::FITTING_POINTS : UITextComponent::eTextFitting::FITTING_NONE);
+            text->SetText(GetLabelText(i, false));
+
+            newControl->AddControl(label.Get());
+            labels.push_back(label);
+        }
+        return labels;
+    }
+
+    void SetLabelsLocale(const Vector<RefPtr<UIControl>>& labels, bool secondLocale)
+    {
+        for (uint32 i = 0; i < labels.size(); ++i)
+        {
+            labels[i]->GetComponent<UITextComponent>()->SetText(GetLabelText(i, secondLocale));
+        }
+    }
+
+    // Layout results used by UILayoutSystem and text renderers
+    bool IsLayoutEqual(TextBlock* a, TextBlock* b)
+    {
+        return a->GetMultilineStrings() == b->GetMultilineStrings() &&
+        a->GetStringSizes() == b->GetStringSizes() &&
+        a->GetVisualText() == b->GetVisualText() &&
+        a->GetTextSize() == b->GetTextSize() &&
+        a->GetSpriteOffset() == b->GetSpriteOffset() &&
+        a->GetVisualAlign() == b->GetVisualAlign() &&
+        a->GetFittingOptionUsed() == b->GetFittingOptionUsed() &&
+        a->IsVisualTextCroped() == b->IsVisualTextCroped();
+    }
+
+    // Process text system and calculate layout of all labels, return main thread time in microseconds
+    int64 ProcessLabels(const Vector<RefPtr<UIControl>>& labels)
+    {
+        int64 startTime = SystemTimer::GetUs();
+        UpdateSystem();
+        for (const RefPtr<UIControl>& label : labels)
+        {
+            // Lazy layout for serial mode, no-op if layout was already done in parallel
+            label->GetComponent<UITextComponent>()->GetLink()->GetTextBlock()->GetTextSize();
+        }
+        return SystemTimer::GetUs() - startTime;
+    }
+
     DAVA_TEST (LoadYamlTest)
     {
         DefaultUIPackageBuilder pkgBuilder;
@@ -205,4 +279,71 @@ DAVA_TESTCLASS (UITextSystemTest)
         UpdateSystem();
         TEST_VERIFY(copy->GetLink()->GetTextBlock()->GetText() == UTF8Utils::EncodeToWideString(str2));
     }
+
+    DAVA_TEST (ParallelLayoutTest)
+    {
+        UITextSystem* sys = GetEngineContext()->uiControlSystem->GetSystem<UITextSystem>();
+        RefPtr<Font> font(FTFont::Create("~res:/Fonts/korinna.ttf"));
+
+        Vector<RefPtr<UIControl>> labels = CreateLabels(200, font);
+
+        sys->SetParallelLayoutEnabled(false);
+        UpdateSystem();
+        Vector<RefPtr<TextBlock>> serialBlocks;
+        for (const RefPtr<UIControl>& label : labels)
+        {
+            TextBlock* textBlock = label->GetComponent<UITextComponent>()->GetLink()->GetTextBlock();
+            TEST_VERIFY(textBlock->NeedCalculateCacheParams());
+            RefPtr<TextBlock> serialBlock(textBlock->Clone());
+            serialBlock->SetFontSize(textBlock->GetFontSize());
+            serialBlocks.push_back(serialBlock);
+        }
+
+        // Blocks are still waiting for lazy layout, they are laid out on worker threads now
+        sys->SetParallelLayoutEnabled(true);
+        UpdateSystem();
+
+        for (size_t i = 0; i < labels.size(); ++i)
+        {
+            TextBlock* textBlock = labels[i]->GetComponent<UITextComponent>()->GetLink()->GetTextBlock();
+            TEST_VERIFY(!textBlock->NeedCalculateCacheParams());
+            TEST_VERIFY(IsLayoutEqual(textBlock, serialBlocks[i].Get()));
+        }
+
+        for (const RefPtr<UIControl>& label : labels)
+        {
+            newControl->RemoveControl(label.Get());
+        }
+    }
+
+    DAVA_TEST (LayoutBenchmark)
+    {
+        const uint32 labelsCount = 2000;
+
+        UITextSystem* sys = GetEngineContext()->uiControlSystem->GetSystem<UITextSystem>();
+        RefPtr<Font> font(FTFont::Create("~res:/Fonts/korinna.ttf"));
+
+        Vector<RefPtr<UIControl>> labels = CreateLabels(labelsCount, font);
+
+        int64 times[2][2] = {};
+        for (uint32 parallel = 0; parallel < 2; ++parallel)
+        {
+            sys->SetParallelLayoutEnabled(parallel != 0);
+
+            SetLabelsLocale(labels, false);
+            times[parallel][0] = ProcessLabels(labels);
+
+            SetLabelsLocale(labels, true);
+            times[parallel][1] = ProcessLabels(labels);
+        }
+
+        Logger::Info("UITextSystem benchmark (%u multiline labels), main thread time: open screen serial %lld us, parallel %lld us; switch locale serial %lld us, parallel %lld us",
+                     labelsCount, times[0][0], times[1][0], times[0][1], times[1][1]);
+
+        for (const RefPtr<UIControl>& label : labels)
+        {
+            newControl->RemoveControl(label.Get());
+        }
+        sys->SetParallelLayoutEnabled(true);
+    }
 };
@@ -1,10 +1,14 @@
 #include "UI/UI3DView.h"
+#include "Debug/ProfilerGPU.h"
 #include "Engine/Engine.h"
 #include "Scene3D/Scene.h"
 #include "UI/UIControlSystem.h"
 #include "Render/2D/Systems/VirtualCoordinatesSystem.h"
 #include "Render/RenderHelper.h"
+#include "Render/Highlevel/Camera.h"
+#include "Render/Highlevel/DynamicResolutionController.h"
 #include "Render/Highlevel/RenderPass.h"
+#include "Render/RHI/rhi_Public.h"
 #include "Render/2D/Systems/RenderSystem2D.h"
 #include "Scene3D/Systems/QualitySettingsSystem.h"
 #include "Scene3D/Systems/Controller/RotationControllerSystem.h"
@@ -23,6 +27,9 @@ DAVA_VIRTUAL_REFLECTION_IMPL(UI3DView)
     .DestructorByPointer([](UI3DView* o) { o->Release(); })
     .Field("drawToFrameBuffer", &UI3DView::GetDrawToFrameBuffer, &UI3DView::SetDrawToFrameBuffer)[M::DisplayName("Draw To Frame Buffer")]
     .Field("frameBufferScaleFactor", &UI3DView::GetFrameBufferScaleFactor, &UI3DView::SetFrameBufferScaleFactor)[M::DisplayName("Frame Buffer Scale Factor")]
+    .Field("redrawOnDemand", &UI3DView::IsRedrawOnDemand, &UI3DView::SetRedrawOnDemand)[M::DisplayName("Redraw On Demand")]
+    .Field("maxRefreshRate", &UI3DView::GetMaxRefreshRate, &UI3DView::SetMaxRefreshRate)[M::DisplayName("Max Refresh Rate")]
+    .Field("dynamicResolution", &UI3DView::IsDynamicResolutionEnabled, &UI3DView::SetDynamicResolutionEnabled)[M::DisplayName("Dynamic Resolution")]
     .End();
 }
 
@@ -48,6 +55,7 @@ void UI3DView::SetScene(Scene* _scene)
     SafeRelease(scene);
 
     scene = SafeRetain(_scene);
+    fbInvalidated = true;
 
     if (scene)
     {
@@ -71,6 +79,24 @@ void UI3DView::AddControl(UIControl* control)
 
 void UI3DView::Update(float32 timeElapsed)
 {
+    timeSinceRedraw += timeElapsed;
+
+    if (dynamicResolutionEnabled)
+    {
+        float32 gpuFrameTime = 0.f;
+        ProfilerGPU* profiler = ProfilerGPU::globalProfiler;
+        if (profiler != nullptr && profiler->IsStarted() && profiler->GetFramesCount() > 0)
+        {
+            const ProfilerGPU::FrameInfo& frame = profiler->GetFrame();
+            if (frame.frameIndex != lastGpuFrameIndex && frame.endTime > frame.startTime)
+            {
+                gpuFrameTime = static_cast<float32>(frame.endTime - frame.startTime) / 1e6f;
+                lastGpuFrameIndex = frame.frameIndex;
+            }
+        }
+        dynamicResolution->AddFrameTime(timeElapsed, gpuFrameTime);
+    }
+
     if (scene)
     {
         scene->Update(timeElapsed);
@@ -84,6 +110,13 @@ void UI3DView::Draw(const UIGeometricData& geometricData)
 
     RenderSystem2D::Instance()->Flush();
 
+    if (drawToFrameBuffer)
+    {
+        RenderToFrameBuffer(geometricData);
+        RenderSystem2D::Instance()->DrawTexture(frameBuffer, RenderSystem2D::DEFAULT_2D_TEXTURE_NOBLEND_MATERIAL, Color::White, geometricData.GetUnrotatedRect(), Rect(Vector2(), fbTexSize));
+        return;
+    }
+
     const RenderSystem2D::RenderTargetPassDescriptor& currentTarget = RenderSystem2D::Instance()->GetActiveTargetDescriptor();
 
     Rect viewportRect = geometricData.GetUnrotatedRect();
@@ -99,64 +132,111 @@ void UI3DView::Draw(const UIGeometricData& geometricData)
     uint32 targetHeight = 0;
     PixelFormat targetFormat = PixelFormat::FORMAT_INVALID;
 
-    rhi::HTexture colorTexture;
-    rhi::HTexture depthStencilTexture;
-    rhi::LoadAction loadAction = rhi::LOADACTION_CLEAR;
+    if (currentTarget.transformVirtualToPhysical)
+    {
+        viewportRc += GetEngineContext()->uiControlSystem->vcs->GetPhysicalDrawOffset();
+    }
+
+    priority += basePriority;
+    rhi::HTexture colorTexture = currentTarget.colorAttachment;
+    rhi::HTexture depthStencilTexture = currentTarget.depthAttachment.IsValid() ? currentTarget.depthAttachment : rhi::HTexture(rhi::DefaultDepthBuffer);
 
-    if (drawToFrameBuffer)
+    if (currentTarget.colorAttachment == rhi::InvalidHandle)
     {
-        viewportRc.x = 0.0f;
-        viewportRc.y = 0.0f;
-        viewportRc.dx *= fbScaleFactor;
-        viewportRc.dy *= fbScaleFactor;
-
-        PrepareFrameBuffer();
-
-        priority += PRIORITY_SERVICE_3D;
-        colorTexture = frameBuffer->handle;
-        depthStencilTexture = frameBuffer->handleDepthStencil;
-        targetFormat = frameBuffer->GetFormat();
-        targetWidth = frameBuffer->GetWidth();
-        targetHeight = frameBuffer->GetHeight();
+        targetFormat = PixelFormat::FORMAT_RGBA8888;
+        targetWidth = Renderer::GetFramebufferWidth();
+        targetHeight = Renderer::GetFramebufferHeight();
     }
     else
     {
-        if (currentTarget.transformVirtualToPhysical)
-        {
-            viewportRc += GetEngineContext()->uiControlSystem->vcs->GetPhysicalDrawOffset();
-        }
-
-        priority += basePriority;
-        colorTexture = currentTarget.colorAttachment;
-        depthStencilTexture = currentTarget.depthAttachment.IsValid() ? currentTarget.depthAttachment : rhi::HTexture(rhi::DefaultDepthBuffer);
-        loadAction = colorLoadAction;
-
-        if (currentTarget.colorAttachment == rhi::InvalidHandle)
-        {
-            targetFormat = PixelFormat::FORMAT_RGBA8888;
-            targetWidth = Renderer::GetFramebufferWidth();
-            targetHeight = Renderer::GetFramebufferHeight();
-        }
-        else
-        {
-            targetFormat = currentTarget.format;
-            targetWidth = currentTarget.width;
-            targetHeight = currentTarget.height;
-        }
+        targetFormat = currentTarget.format;
+        targetWidth = currentTarget.width;
+        targetHeight = currentTarget.height;
     }
 
     DVASSERT(targetWidth > 0);
     DVASSERT(targetHeight > 0);
     DVASSERT(targetFormat != PixelFormat::FORMAT_INVALID);
 
-    scene->SetMainRenderTarget(colorTexture, depthStencilTexture, loadAction, currentTarget.clearColor);
+    scene->SetMainRenderTarget(colorTexture, depthStencilTexture, colorLoadAction, currentTarget.clearColor);
     scene->SetMainPassProperties(priority, viewportRc, targetWidth, targetHeight, targetFormat);
     scene->Draw();
+    ++sceneDrawsCount;
+}
 
-    if (drawToFrameBuffer)
+bool UI3DView::RenderToFrameBuffer(const UIGeometricData& geometricData)
+{
+    DVASSERT(scene != nullptr);
+    DVASSERT(drawToFrameBuffer);
+
+    bool frameBufferRecreated = PrepareFrameBuffer();
+
+    Camera* camera = scene->GetDrawCamera();
+    if (!frameBufferRecreated && !IsFrameBufferRedrawRequired(camera))
     {
-        RenderSystem2D::Instance()->DrawTexture(frameBuffer, RenderSystem2D::DEFAULT_2D_TEXTURE_NOBLEND_MATERIAL, Color::White, geometricData.GetUnrotatedRect(), Rect(Vector2(), fbTexSize));
+        return false;
+    }
+
+    const RenderSystem2D::RenderTargetPassDescriptor& currentTarget = RenderSystem2D::Instance()->GetActiveTargetDescriptor();
+
+    Rect viewportRect = geometricData.GetUnrotatedRect();
+    if (currentTarget.transformVirtualToPhysical)
+        viewportRc = GetEngineContext()->uiControlSystem->vcs->ConvertVirtualToPhysical(viewportRect);
+    else
+        viewportRc = viewportRect;
+
+    viewportRc.x = 0.0f;
+    viewportRc.y = 0.0f;
+    viewportRc.dx *= fbScaleFactor;
+    viewportRc.dy *= fbScaleFactor;
+    if (dynamicResolutionEnabled)
+    {
+        viewportRc.SetSize(dynamicResolution->GetScaledSize(viewportRc.GetSize()));
+    }
+
+    uint32 priority = currentTarget.priority + PRIORITY_SERVICE_3D;
+
+    scene->SetMainRenderTarget(frameBuffer->handle, frameBuffer->handleDepthStencil, rhi::LOADACTION_CLEAR, currentTarget.clearColor);
+    scene->SetMainPassProperties(priority, viewportRc, frameBuffer->GetWidth(), frameBuffer->GetHeight(), frameBuffer->GetFormat());
+    scene->Draw();
+    ++sceneDrawsCount;
+
+    fbInvalidated = false;
+    lastVisualChangesCounter = scene->GetVisualChangesCounter();
+    lastCamera = camera;
+    if (camera != nullptr)
+    {
+        lastViewProjMatrix = camera->GetViewProjMatrix();
+    }
+    lastFbRenderSize = fbRenderSize;
+    timeSinceRedraw = 0.f;
+
+    return true;
+}
+
+bool UI3DView::IsFrameBufferRedrawRequired(Camera* camera) const
+{
+    if (fbInvalidated || lastFbRenderSize != fbRenderSize || rhi::NeedRestoreTexture(frameBuffer->handle))
+    {
+        return true;
+    }
+
+    if (maxRefreshRate > 0.f && timeSinceRedraw < 1.f / maxRefreshRate)
+    {
+        return false;
+    }
+
+    if (!redrawOnDemand)
+    {
+        return true;
+    }
+
+    if (lastVisualChangesCounter != scene->GetVisualChangesCounter() || lastCamera != camera)
+    {
+        return true;
     }
+
+    return camera != nullptr && camera->GetViewProjMatrix() != lastViewProjMatrix;
 }
 
 bool UI3DView::IsClearRequested() const
@@ -206,6 +286,16 @@ void UI3DView::CopyDataFrom(UIControl* srcControl)
     fbScaleFactor = srcView->fbScaleFactor;
     fbRenderSize = srcView->fbRenderSize;
     fbTexSize = srcView->fbTexSize;
+    redrawOnDemand = srcView->redrawOnDemand;
+    maxRefreshRate = srcView->maxRefreshRate;
+
+    if (srcView->dynamicResolution)
+    {
+        dynamicResolution.reset(new DynamicResolutionController());
+        dynamicResolution->SetSettings(srcView->dynamicResolution->GetSettings());
+    }
+    dynamicResolutionEnabled = srcView->dynamicResolutionEnabled;
+    drawToFrameBufferBeforeDynamicResolution = srcView->drawToFrameBufferBeforeDynamicResolution;
 }
 
 void UI3DView::Input(UIEvent* currentInput)
@@ -230,7 +320,22 @@ void UI3DView::InputCancelled(UIEvent* currentInput)
 
 void UI3DView::SetDrawToFrameBuffer(bool enable)
 {
+    if (dynamicResolutionEnabled)
+    {
+        // Dynamic resolution works only with frame buffer, so explicit switch to direct drawing turns it off
+        // and explicit switch to frame buffer is kept after dynamic resolution is disabled
+        if (enable)
+        {
+            drawToFrameBufferBeforeDynamicResolution = true;
+        }
+        else
+        {
+            dynamicResolutionEnabled = false;
+        }
+    }
+
     drawToFrameBuffer = enable;
+    fbInvalidated = true;
 
     if (enable)
     {
@@ -243,27 +348,77 @@ void UI3DView::SetDrawToFrameBuffer(bool enable)
     }
 }
 
+void UI3DView::SetDynamicResolutionEnabled(bool enable)
+{
+    if (dynamicResolutionEnabled == enable)
+        return;
+
+    if (enable)
+    {
+        if (!dynamicResolution)
+        {
+            dynamicResolution.reset(new DynamicResolutionController());
+        }
+        dynamicResolution->Reset();
+
+        drawToFrameBufferBeforeDynamicResolution = drawToFrameBuffer;
+        if (!drawToFrameBuffer)
+        {
+            SetDrawToFrameBuffer(true);
+        }
+        dynamicResolutionEnabled = true;
+    }
+    else
+    {
+        dynamicResolutionEnabled = false;
+        SetDrawToFrameBuffer(drawToFrameBufferBeforeDynamicResolution);
+    }
+}
+
 void UI3DView::SetFrameBufferScaleFactor(float32 scale)
 {
     fbScaleFactor = scale;
 }
 
-void UI3DView::PrepareFrameBuffer()
+void UI3DView::SetRedrawOnDemand(bool enable)
+{
+    redrawOnDemand = enable;
+    fbInvalidated = true;
+}
+
+void UI3DView::SetMaxRefreshRate(float32 rate)
+{
+    DVASSERT(rate >= 0.f);
+    maxRefreshRate = rate;
+}
+
+void UI3DView::InvalidateFrameBuffer()
+{
+    fbInvalidated = true;
+}
+
+bool UI3DView::PrepareFrameBuffer()
 {
     DVASSERT(scene);
 
-    fbRenderSize = GetEngineContext()->uiControlSystem->vcs->ConvertVirtualToPhysical(GetSize()) * fbScaleFactor;
+    Vector2 nativeSize = GetEngineContext()->uiControlSystem->vcs->ConvertVirtualToPhysical(GetSize()) * fbScaleFactor;
+    fbRenderSize = dynamicResolutionEnabled ? dynamicResolution->GetScaledSize(nativeSize) : nativeSize;
 
-    if (frameBuffer == nullptr || frameBuffer->GetWidth() < fbRenderSize.dx || frameBuffer->GetHeight() < fbRenderSize.dy)
+    // Frame buffer is allocated for native size, so dynamic resolution changes only viewport and never recreate it
+    bool recreated = false;
+    if (frameBuffer == nullptr || frameBuffer->GetWidth() < nativeSize.dx || frameBuffer->GetHeight() < nativeSize.dy)
     {
         SafeRelease(frameBuffer);
-        int32 dx = static_cast<int32>(fbRenderSize.dx);
-        int32 dy = static_cast<int32>(fbRenderSize.dy);
+        int32 dx = static_cast<int32>(nativeSize.dx);
+        int32 dy = static_cast<int32>(nativeSize.dy);
         frameBuffer = Texture::CreateFBO(dx, dy, FORMAT_RGBA8888, true);
+        recreated = true;
     }
 
     Vector2 fbSize = Vector2(static_cast<float32>(frameBuffer->GetWidth()), static_cast<float32>(frameBuffer->GetHeight()));
 
     fbTexSize = fbRenderSize / fbSize;
+
+    return recreated;
 }
 }
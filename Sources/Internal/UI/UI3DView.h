@@ -5,14 +5,23 @@
 #include "UI/UIControl.h"
 #include "Render/RenderBase.h"
 #include "Render/RHI/rhi_Type.h"
+#include "Math/Matrix4.h"
+
+#include <memory>
 
 namespace DAVA
 {
 /**
     \ingroup controlsystem
     \brief This control allow to put 3D View into any place of 2D hierarchy
+
+    When drawing to frame buffer is enabled, scene can be rendered on demand (see `SetRedrawOnDemand`):
+    frame buffer is re-rendered only if scene content, scene camera, view size or frame buffer scale changed,
+    or `InvalidateFrameBuffer` was called. Otherwise previously rendered frame buffer texture is drawn.
  */
 
+class Camera;
+class DynamicResolutionController;
 class Scene;
 class Texture;
 class UI3DView : public UIControl
@@ -50,6 +59,8 @@ public:
     void SetFrameBufferScaleFactor(float32 scale);
     float32 GetFrameBufferScaleFactor() const;
     const Vector2& GetFrameBufferRenderSize() const;
+    /** Return texture scene is rendered to when drawing to frame buffer is enabled, or nullptr. */
+    Texture* GetFrameBuffer() const;
 
     int32 GetBasePriority();
     void SetBasePriority(int32 priority);
@@ -57,12 +68,53 @@ public:
     bool IsClearRequested() const;
     void SetClearRequested(bool requested);
 
+    /**
+        Enable or disable re-rendering of frame buffer only when scene visually changed.
+        Works only when drawing to frame buffer is enabled. Changes that scene can not track
+        (e.g. material properties) should be reported with `InvalidateFrameBuffer` or `Scene::InvalidateVisualState`.
+     */
+    void SetRedrawOnDemand(bool enable);
+    bool IsRedrawOnDemand() const;
+
+    /**
+        Set maximum number of frame buffer re-renders per second, 0 means no limit.
+        Limit is not applied to re-renders caused by view resizing or `InvalidateFrameBuffer`.
+     */
+    void SetMaxRefreshRate(float32 rate);
+    float32 GetMaxRefreshRate() const;
+
+    /** Force re-rendering of frame buffer in next `Draw`. */
+    void InvalidateFrameBuffer();
+
+    /**
+        Render scene into frame buffer if it is required. Return true if scene was rendered.
+        Normally is called from `Draw`, frame buffer texture is drawn by caller.
+     */
+    bool RenderToFrameBuffer(const UIGeometricData& geometricData);
+
+    /** Return number of scene renders performed by view. */
+    uint32 GetSceneDrawsCount() const;
+
+    /**
+        Enable or disable dynamic resolution of 3D rendering. When enabled, scene is drawn to frame buffer
+        (see `SetDrawToFrameBuffer`) at part of its size chosen by `DynamicResolutionController` from frame times
+        (GPU times from `ProfilerGPU` if it is started), and stretched to view rect with bilinear filtering.
+        UI is drawn at native resolution; input, picking and camera aspect are not affected.
+        Disabling drawing to frame buffer with `SetDrawToFrameBuffer(false)` also disables dynamic resolution.
+     */
+    void SetDynamicResolutionEnabled(bool enable);
+    bool IsDynamicResolutionEnabled() const;
+
+    /** Return dynamic resolution controller or nullptr if dynamic resolution was never enabled. */
+    DynamicResolutionController* GetDynamicResolutionController() const;
+
 protected:
     Scene* scene;
     Rect viewportRc;
 
 private:
-    void PrepareFrameBuffer();
+    bool PrepareFrameBuffer();
+    bool IsFrameBufferRedrawRequired(Camera* camera) const;
 
     bool drawToFrameBuffer;
 
@@ -74,6 +126,22 @@ private:
     int32 basePriority = PRIORITY_MAIN_3D;
 
     rhi::LoadAction colorLoadAction = rhi::LOADACTION_CLEAR;
+
+    bool redrawOnDemand = false;
+    float32 maxRefreshRate = 0.f;
+
+    bool fbInvalidated = true;
+    uint32 lastVisualChangesCounter = 0;
+    Camera* lastCamera = nullptr;
+    Matrix4 lastViewProjMatrix;
+    Vector2 lastFbRenderSize;
+    float32 timeSinceRedraw = 0.f;
+    uint32 sceneDrawsCount = 0;
+
+    std::unique_ptr<DynamicResolutionController> dynamicResolution;
+    bool dynamicResolutionEnabled = false;
+    bool drawToFrameBufferBeforeDynamicResolution = false;
+    uint32 lastGpuFrameIndex = 0;
 };
 
 inline bool UI3DView::GetDrawToFrameBuffer() const
@@ -91,6 +159,36 @@ inline const Vector2& UI3DView::GetFrameBufferRenderSize() const
     return fbRenderSize;
 }
 
+inline Texture* UI3DView::GetFrameBuffer() const
+{
+    return frameBuffer;
+}
+
+inline bool UI3DView::IsRedrawOnDemand() const
+{
+    return redrawOnDemand;
+}
+
+inline float32 UI3DView::GetMaxRefreshRate() const
+{
+    return maxRefreshRate;
+}
+
+inline uint32 UI3DView::GetSceneDrawsCount() const
+{
+    return sceneDrawsCount;
+}
+
+inline bool UI3DView::IsDynamicResolutionEnabled() const
+{
+    return dynamicResolutionEnabled;
+}
+
+inline DynamicResolutionController* UI3DView::GetDynamicResolutionController() const
+{
+    return dynamicResolution.get();
+}
+
 inline int32 UI3DView::GetBasePriority()
 {
     return basePriority;
@@ -78,6 +78,49 @@ static void StopControlTracking(const UIControl* control)
 #endif
 }
 
+namespace UIControlDetails
+{
+// Transform animations change fields of control directly
+template <typename T>
+class TransformAnimation : public T
+{
+public:
+    template <typename... Args>
+    TransformAnimation(UIControl* control_, Args&&... args)
+        : T(control_, std::forward<Args>(args)...)
+        , control(control_)
+    {
+    }
+
+    void Update(float32 timeElapsed) override
+    {
+        T::Update(timeElapsed);
+        control->SetHierarchyBoundsDirty();
+    }
+
+private:
+    UIControl* control = nullptr;
+};
+
+// Hierarchy bounds are expanded a bit to not miss points on the edge because of rounding errors
+const float32 HIERARCHY_BOUNDS_MARGIN = 1.0f;
+
+Vector2 GetHitTestPoint(const Vector2& point)
+{
+    if (GetPrimaryWindow()->GetCursorCapture() == eCursorCapture::PINNING)
+    {
+        Size2f sz = GetPrimaryWindow()->GetVirtualSize();
+        return Vector2(sz.dx / 2.f, sz.dy / 2.f);
+    }
+    return point;
+}
+
+bool IsPointPhase(UIEvent::Phase phase)
+{
+    return phase == UIEvent::Phase::BEGAN || phase == UIEvent::Phase::MOVE || phase == UIEvent::Phase::WHEEL;
+}
+}
+
 UIControl::UIControl(const Rect& rect)
     : exclusiveInput(false)
     , isInputProcessed(false)
@@ -137,8 +180,10 @@ void UIControl::SetParent(UIControl* newParent)
     if (parent)
     {
         parent->UnregisterInputProcessors(inputProcessorsCount);
+        parent->SetHierarchyBoundsDirty();
     }
     parent = newParent;
+    SetHierarchyBoundsDirty();
     if (parent)
     {
         PropagateParentWithContext(newParent->packageContext ? newParent : newParent->parentWithContext);
@@ -380,6 +425,7 @@ void UIControl::SetPosition(const Vector2& position)
 
     relativePosition = position;
     SetLayoutPositionDirty();
+    SetHierarchyBoundsDirty();
 }
 
 void UIControl::SetAbsolutePosition(const Vector2& position)
@@ -405,6 +451,7 @@ void UIControl::SetSize(const Vector2& newSize)
     SetPivot(oldPivot);
 
     SetLayoutDirty();
+    SetHierarchyBoundsDirty();
 }
 
 void UIControl::SetPivotPoint(const Vector2& newPivotPoint)
@@ -418,6 +465,7 @@ void UIControl::SetPivotPoint(const Vector2& newPivotPoint)
     pivot = newPivot;
 
     SetLayoutPositionDirty();
+    SetHierarchyBoundsDirty();
 }
 
 void UIControl::SetPivot(const Vector2& newPivot)
@@ -428,11 +476,13 @@ void UIControl::SetPivot(const Vector2& newPivot)
     pivot = newPivot;
 
     SetLayoutPositionDirty();
+    SetHierarchyBoundsDirty();
 }
 
 void UIControl::SetAngle(float32 angleInRad)
 {
     angle = angleInRad;
+    SetHierarchyBoundsDirty();
 }
 
 void UIControl::SetAngleInDegrees(float32 angleInDeg)
@@ -471,6 +521,7 @@ void UIControl::SetScaledRect(const Rect& rect, bool rectInAbsoluteCoordinates /
     {
         scale.x = rect.dx / size.x;
         scale.y = rect.dy / size.y;
+        SetHierarchyBoundsDirty();
         SetPosition(Vector2(rect.x + GetPivotPoint().x * scale.x, rect.y + GetPivotPoint().y * scale.y));
     }
     else
@@ -478,6 +529,7 @@ void UIControl::SetScaledRect(const Rect& rect, bool rectInAbsoluteCoordinates /
         const UIGeometricData& gd = parent->GetGeometricData();
         scale.x = rect.dx / (size.x * gd.scale.x);
         scale.y = rect.dy / (size.y * gd.scale.y);
+        SetHierarchyBoundsDirty();
         SetAbsolutePosition(Vector2(rect.x + GetPivotPoint().x * scale.x, rect.y + GetPivotPoint().y * scale.y));
     }
 }
@@ -520,6 +572,7 @@ void UIControl::SetVisibilityFlag(bool isVisible)
     }
 
     SetLayoutDirty();
+    SetHierarchyBoundsDirty();
 }
 
 void UIControl::SetInputEnabled(bool isEnabled, bool hierarchic /* = true*/)
@@ -880,6 +933,8 @@ void UIControl::CopyDataFrom(UIControl* srcControl)
     exclusiveInput = srcControl->exclusiveInput;
     visible = srcControl->visible;
     inputEnabled = srcControl->inputEnabled;
+    hierarchyBounds.inputCulling = srcControl->hierarchyBounds.inputCulling;
+    SetHierarchyBoundsDirty();
 
     hiddenForDebug = srcControl->hiddenForDebug;
     classes = srcControl->classes;
@@ -943,13 +998,7 @@ void UIControl::SetParentColor(const Color& parentColor)
 
 bool UIControl::IsPointInside(const Vector2& point_, bool expandWithFocus /* = false*/) const
 {
-    Vector2 point = point_;
-    if (GetPrimaryWindow()->GetCursorCapture() == eCursorCapture::PINNING)
-    {
-        Size2f sz = GetPrimaryWindow()->GetVirtualSize();
-        point.x = sz.dx / 2.f;
-        point.y = sz.dy / 2.f;
-    }
+    Vector2 point = UIControlDetails::GetHitTestPoint(point_);
     const UIGeometricData& gd = GetGeometricData();
     Rect rect = gd.GetUnrotatedRect();
     if (expandWithFocus)
@@ -970,6 +1019,134 @@ bool UIControl::IsPointInside(const Vector2& point_, bool expandWithFocus /* = f
     return rect.PointInside(point);
 }
 
+void UIControl::SetInputCulling(bool enabled)
+{
+    if (hierarchyBounds.inputCulling != enabled)
+    {
+        hierarchyBounds.inputCulling = enabled;
+        SetHierarchyBoundsDirty();
+    }
+}
+
+bool UIControl::GetInputCulling() const
+{
+    return hierarchyBounds.inputCulling;
+}
+
+const Rect& UIControl::GetHierarchyBounds() const
+{
+    UpdateHierarchyBounds(nullptr);
+    return hierarchyBounds.full;
+}
+
+bool UIControl::IsInputCulled(const Vector2& point) const
+{
+    UpdateHierarchyBounds(nullptr);
+    return !hierarchyBounds.inputUnlimited && !hierarchyBounds.input.PointInside(point);
+}
+
+void UIControl::SetHierarchyBoundsDirty()
+{
+    // World transform of the whole hierarchy is changed, parents have to combine bounds again
+    hierarchyBounds.transformDirty = true;
+    for (UIControl* c = this; c != nullptr; c = c->parent)
+    {
+        c->hierarchyBounds.dirty = true;
+    }
+}
+
+void UIControl::UpdateHierarchyBounds(const UIGeometricData* geometricData) const
+{
+    using namespace UIControlDetails;
+
+    if (!hierarchyBounds.dirty)
+    {
+        return;
+    }
+
+    UIGeometricData gd;
+    bool transformChanged = hierarchyBounds.transformDirty;
+    if (transformChanged)
+    {
+        gd = (geometricData != nullptr) ? *geometricData : GetGeometricData();
+
+        Rect own = gd.GetUnrotatedRect();
+        if (own.dx < 0.f)
+        {
+            own.x += own.dx;
+            own.dx = -own.dx;
+        }
+        if (own.dy < 0.f)
+        {
+            own.y += own.dy;
+            own.dy = -own.dy;
+        }
+        if (gd.angle != 0.f)
+        {
+            own = own.Combine(gd.GetAABBox());
+        }
+        own.x -= HIERARCHY_BOUNDS_MARGIN;
+        own.y -= HIERARCHY_BOUNDS_MARGIN;
+        own.dx += HIERARCHY_BOUNDS_MARGIN * 2.f;
+        own.dy += HIERARCHY_BOUNDS_MARGIN * 2.f;
+        hierarchyBounds.own = own;
+    }
+
+    UIClipContentComponent* clipContent = GetComponent<UIClipContentComponent>();
+    bool clipContents = (clipContent != nullptr && clipContent->IsEnabled());
+    bool ownInputUnlimited = !hierarchyBounds.inputCulling || customSystemProcessInput != nullptr;
+
+    Rect full = hierarchyBounds.own;
+    Rect input = hierarchyBounds.own;
+    bool inputUnlimited = ownInputUnlimited;
+    for (const auto& child : children)
+    {
+        if (transformChanged)
+        {
+            child->hierarchyBounds.transformDirty = true;
+            child->hierarchyBounds.dirty = true;
+        }
+
+        // Hidden children don't receive input and can't be focused, they are marked dirty again when shown
+        if (!child->visible)
+        {
+            continue;
+        }
+
+        if (transformChanged)
+        {
+            UIGeometricData childGD = child->GetLocalGeometricData();
+            childGD.AddGeometricData(gd);
+            child->UpdateHierarchyBounds(&childGD);
+        }
+        else
+        {
+            child->UpdateHierarchyBounds(nullptr);
+        }
+
+        const HierarchyBounds& childBounds = child->hierarchyBounds;
+        full = full.Combine(childBounds.full);
+        if (child->inputProcessorsCount > 0)
+        {
+            input = input.Combine(childBounds.input);
+            inputUnlimited = inputUnlimited || childBounds.inputUnlimited;
+        }
+    }
+
+    // Clipped control doesn't pass pointer input outside of its rect to children
+    if (clipContents)
+    {
+        input = hierarchyBounds.own;
+        inputUnlimited = ownInputUnlimited;
+    }
+
+    hierarchyBounds.full = full;
+    hierarchyBounds.input = input;
+    hierarchyBounds.inputUnlimited = inputUnlimited;
+    hierarchyBounds.transformDirty = false;
+    hierarchyBounds.dirty = false;
+}
+
 bool UIControl::SystemProcessInput(UIEvent* currentInput)
 {
     if (!inputEnabled || !GetVisibilityFlag() || controlState & STATE_DISABLED)
@@ -1238,6 +1415,10 @@ bool UIControl::SystemInput(UIEvent* currentInput)
             child->isInputProcessed = false;
         };
 
+        // Children which can't be hit by pointer are skipped without visiting their hierarchy
+        bool canCullChildren = UIControlDetails::IsPointPhase(currentInput->phase);
+        Vector2 hitTestPoint = canCullChildren ? UIControlDetails::GetHitTestPoint(currentInput->point) : Vector2();
+
         auto it = children.rbegin();
         auto itEnd = children.rend();
         while (it != itEnd)
@@ -1246,7 +1427,7 @@ bool UIControl::SystemInput(UIEvent* currentInput)
             RefPtr<UIControl> current = *it;
             if (!current->isInputProcessed)
             {
-                if (current->inputProcessorsCount > 0)
+                if (current->inputProcessorsCount > 0 && !(canCullChildren && current->IsInputCulled(hitTestPoint)))
                 {
                     if (current->SystemInput(currentInput))
                     {
@@ -1681,35 +1862,35 @@ Animation* UIControl::WaitAnimation(float32 time, int32 track)
 
 Animation* UIControl::PositionAnimation(const Vector2& position_, float32 time, Interpolation::FuncType interpolationFunc, int32 track)
 {
-    LinearAnimation<Vector2>* animation = new LinearAnimation<Vector2>(this, &relativePosition, position_, time, interpolationFunc);
+    LinearAnimation<Vector2>* animation = new UIControlDetails::TransformAnimation<LinearAnimation<Vector2>>(this, &relativePosition, position_, time, interpolationFunc);
     animation->Start(track);
     return animation;
 }
 
 Animation* UIControl::SizeAnimation(const Vector2& size_, float32 time, Interpolation::FuncType interpolationFunc, int32 track)
 {
-    LinearAnimation<Vector2>* animation = new LinearAnimation<Vector2>(this, &size, size_, time, interpolationFunc);
+    LinearAnimation<Vector2>* animation = new UIControlDetails::TransformAnimation<LinearAnimation<Vector2>>(this, &size, size_, time, interpolationFunc);
     animation->Start(track);
     return animation;
 }
 
 Animation* UIControl::ScaleAnimation(const Vector2& newScale, float32 time, Interpolation::FuncType interpolationFunc, int32 track)
 {
-    LinearAnimation<Vector2>* animation = new LinearAnimation<Vector2>(this, &scale, newScale, time, interpolationFunc);
+    LinearAnimation<Vector2>* animation = new UIControlDetails::TransformAnimation<LinearAnimation<Vector2>>(this, &scale, newScale, time, interpolationFunc);
     animation->Start(track);
     return animation;
 }
 
 Animation* UIControl::AngleAnimation(float32 newAngle, float32 time, Interpolation::FuncType interpolationFunc /*= Interpolation::LINEAR*/, int32 track /*= 0*/)
 {
-    LinearAnimation<float32>* animation = new LinearAnimation<float32>(this, &angle, newAngle, time, interpolationFunc);
+    LinearAnimation<float32>* animation = new UIControlDetails::TransformAnimation<LinearAnimation<float32>>(this, &angle, newAngle, time, interpolationFunc);
     animation->Start(track);
     return animation;
 }
 
 Animation* UIControl::MoveAnimation(const Rect& rect, float time, Interpolation::FuncType interpolationFunc, int32 track)
 {
-    TwoVector2LinearAnimation* animation = new TwoVector2LinearAnimation(this, &relativePosition, Vector2(rect.x + GetPivotPoint().x, rect.y + GetPivotPoint().y), &size, Vector2(rect.dx, rect.dy), time, interpolationFunc);
+    TwoVector2LinearAnimation* animation = new UIControlDetails::TransformAnimation<TwoVector2LinearAnimation>(this, &relativePosition, Vector2(rect.x + GetPivotPoint().x, rect.y + GetPivotPoint().y), &size, Vector2(rect.dx, rect.dy), time, interpolationFunc);
     animation->Start(track);
     return animation;
 }
@@ -1718,7 +1899,7 @@ Animation* UIControl::ScaledRectAnimation(const Rect& rect, float32 time, Interp
 {
     Vector2 finalScale(rect.dx / size.x, rect.dy / size.y);
 
-    TwoVector2LinearAnimation* animation = new TwoVector2LinearAnimation(this, &relativePosition, Vector2(rect.x + GetPivotPoint().x * finalScale.x, rect.y + GetPivotPoint().y * finalScale.y), &scale, finalScale, time, interpolationFunc);
+    TwoVector2LinearAnimation* animation = new UIControlDetails::TransformAnimation<TwoVector2LinearAnimation>(this, &relativePosition, Vector2(rect.x + GetPivotPoint().x * finalScale.x, rect.y + GetPivotPoint().y * finalScale.y), &scale, finalScale, time, interpolationFunc);
     animation->Start(track);
     return animation;
 }
@@ -1726,7 +1907,7 @@ Animation* UIControl::ScaledRectAnimation(const Rect& rect, float32 time, Interp
 Animation* UIControl::ScaledSizeAnimation(const Vector2& newSize, float32 time, Interpolation::FuncType interpolationFunc, int32 track)
 {
     Vector2 finalScale(newSize.x / size.x, newSize.y / size.y);
-    LinearAnimation<Vector2>* animation = new LinearAnimation<Vector2>(this, &scale, finalScale, time, interpolationFunc);
+    LinearAnimation<Vector2>* animation = new UIControlDetails::TransformAnimation<LinearAnimation<Vector2>>(this, &scale, finalScale, time, interpolationFunc);
     animation->Start(track);
     return animation;
 }
@@ -1861,6 +2042,10 @@ void UIControl::SetSizeFromBg(bool pivotToCenter)
 
 void UIControl::RegisterInputProcessor()
 {
+    if (inputProcessorsCount == 0)
+    {
+        SetHierarchyBoundsDirty();
+    }
     inputProcessorsCount++;
     if (parent)
     {
@@ -1870,6 +2055,10 @@ void UIControl::RegisterInputProcessor()
 
 void UIControl::RegisterInputProcessors(int32 processorsCount)
 {
+    if (inputProcessorsCount == 0 && processorsCount > 0)
+    {
+        SetHierarchyBoundsDirty();
+    }
     inputProcessorsCount += processorsCount;
     if (parent)
     {
@@ -1881,6 +2070,10 @@ void UIControl::UnregisterInputProcessor()
 {
     inputProcessorsCount--;
     DVASSERT(inputProcessorsCount >= 0);
+    if (inputProcessorsCount == 0)
+    {
+        SetHierarchyBoundsDirty();
+    }
     if (parent)
     {
         parent->UnregisterInputProcessor();
@@ -1890,6 +2083,10 @@ void UIControl::UnregisterInputProcessors(int32 processorsCount)
 {
     inputProcessorsCount -= processorsCount;
     DVASSERT(inputProcessorsCount >= 0);
+    if (inputProcessorsCount == 0 && processorsCount > 0)
+    {
+        SetHierarchyBoundsDirty();
+    }
     if (parent)
     {
         parent->UnregisterInputProcessors(processorsCount);
@@ -1991,6 +2188,7 @@ void UIControl::AddComponent(UIComponent* component)
     }
     SetStyleSheetDirty();
     SetLayoutDirty();
+    SetHierarchyBoundsDirty();
 }
 
 void UIControl::InsertComponentAt(UIComponent* component, uint32 index)
@@ -2143,6 +2341,7 @@ void UIControl::RemoveComponent(const Vector<UIComponent*>::iterator& it)
 
         SetStyleSheetDirty();
         SetLayoutDirty();
+        SetHierarchyBoundsDirty();
     }
 }
 
@@ -720,6 +720,7 @@ public:
      */
     virtual bool SystemProcessInput(UIEvent* currentInput); // Internal method used by ControlSystem
 
+    /** Control with custom input handler is never culled, call SetHierarchyBoundsDirty() if handler is set to visible control. */
     Function<bool(UIControl*, UIEvent*)> customSystemProcessInput;
 
     /**
@@ -848,6 +849,33 @@ public:
      */
     virtual bool IsPointInside(const Vector2& point, bool expandWithFocus = false) const;
 
+    /**
+     \brief Enables skipping of pointer input dispatch to the control and its children when pointer is outside
+        of their rects. Enabled by default. Should be disabled by controls which handle pointer input outside
+        of own rect, e.g. with overridden IsPointInside() or SystemInput().
+     \param[in] enabled Is culling enabled.
+     */
+    void SetInputCulling(bool enabled);
+    bool GetInputCulling() const;
+
+    /**
+     \brief Returns world-space bounding box of the control and all its visible children.
+        Bounds are cached and recalculated only after changes of transform or hierarchy.
+     */
+    const Rect& GetHierarchyBounds() const;
+
+    /**
+     \brief Returns true if pointer input at the point can't be processed by the control or its children.
+        Used by SystemInput() to skip whole subtrees for BEGAN, MOVE and WHEEL events.
+     */
+    bool IsInputCulled(const Vector2& point) const;
+
+    /**
+     \brief Invalidates cached bounds of the control and its parents.
+        Called by transform setters, should be called after direct change of relativePosition, size, scale or angle.
+     */
+    void SetHierarchyBoundsDirty();
+
     virtual void SystemOnFocusLost();
 
     virtual void SystemOnFocused();
@@ -934,6 +962,19 @@ private:
 
     bool inputEnabled : 1;
 
+    struct HierarchyBounds
+    {
+        Rect own; //!< Bounds of unrotated and rotated rect of the control.
+        Rect full; //!< Bounds of the control and its visible children, for focus navigation.
+        Rect input; //!< Bounds of the control and its visible children with input processors, cut by content clipping.
+        bool inputUnlimited = false; //!< Some control in hierarchy can process pointer input outside of its rect.
+        bool inputCulling = true;
+        bool transformDirty = true;
+        bool dirty = true;
+    };
+    mutable HierarchyBounds hierarchyBounds;
+    void UpdateHierarchyBounds(const UIGeometricData* geometricData) const;
+
 public:
     //@{
     /** @name Components */
@@ -1128,6 +1169,7 @@ inline const Vector2& UIControl::GetScale() const
 inline void UIControl::SetScale(const Vector2& newScale)
 {
     scale = newScale;
+    SetHierarchyBoundsDirty();
 }
 
 inline const Vector2& UIControl::GetSize() const
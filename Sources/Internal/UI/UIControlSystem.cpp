@@ -3,7 +3,6 @@
 #include "Debug/ProfilerCPU.h"
 #include "Debug/ProfilerMarkerNames.h"
 #include "Debug/ProfilerOverlay.h"
-#include "Debug/Replay.h"
 #include "DeviceManager/DeviceManager.h"
 #include "Engine/Engine.h"
 #include "Input/InputEvent.h"
@@ -406,11 +405,6 @@ void UIControlSystem::OnInput(UIEvent* newEvent)
     newEvent->point = GetEngineContext()->uiControlSystem->vcs->ConvertInputToVirtual(newEvent->physPoint);
     newEvent->tapCount = CalculatedTapCount(newEvent);
 
-    if (Replay::IsPlayback())
-    {
-        return;
-    }
-
     if (lockInputCounter > 0)
     {
         return;
@@ -421,10 +415,6 @@ void UIControlSystem::OnInput(UIEvent* newEvent)
 
     if (frameSkip <= 0)
     {
-        if (Replay::IsRecord())
-        {
-            Replay::Instance()->RecordEvent(newEvent);
-        }
         inputSystem->HandleEvent(newEvent);
         // Store last 'touchLocker' reference.
         if (newEvent->touchLocker)
@@ -545,19 +535,6 @@ void UIControlSystem::ProcessControlEvent(int32 eventType, const UIEvent* uiEven
     eventsSystem->ProcessControlEvent(eventType, uiEvent, control);
 }
 
-void UIControlSystem::ReplayEvents()
-{
-    while (Replay::Instance()->IsEvent())
-    {
-        int32 activeCount = Replay::Instance()->PlayEventsCount();
-        while (activeCount--)
-        {
-            UIEvent ev = Replay::Instance()->PlayEvent();
-            OnInput(&ev);
-        }
-    }
-}
-
 int32 UIControlSystem::LockSwitch()
 {
     screenLockCount++;
@@ -888,7 +865,7 @@ UIEvent UIControlSystem::MakeUIEvent(const InputEvent& inputEvent) const
     {
         uie.device = eInputDevices::KEYBOARD;
         uie.key = inputEvent.elementId;
-        uie.modifiers = GetKeyboardModifierKeys();
+        uie.modifiers = GetKeyboardModifierKeys(inputEvent);
 
         if (inputEvent.keyboardEvent.charCode > 0)
         {
@@ -919,11 +896,12 @@ UIEvent UIControlSystem::MakeUIEvent(const InputEvent& inputEvent) const
         uie.device = eInputDevices::MOUSE;
         uie.mouseButton = eMouseButtons::NONE;
         uie.isRelative = inputEvent.mouseEvent.isRelative;
-        uie.modifiers = GetKeyboardModifierKeys();
+        uie.modifiers = GetKeyboardModifierKeys(inputEvent);
 
-        Mouse* mouse = GetEngineContext()->deviceManager->GetMouse();
-        AnalogElementState mousePosition = mouse->GetPosition();
-        AnalogElementState mouseWheelDelta = mouse->GetWheelDelta();
+        // State is taken from event's device rather than from `DeviceManager::GetMouse`, since it can be driven by `Replay`
+        InputDevice* mouse = inputEvent.device;
+        AnalogElementState mousePosition = mouse->GetAnalogElementState(eInputElements::MOUSE_POSITION);
+        AnalogElementState mouseWheelDelta = mouse->GetAnalogElementState(eInputElements::MOUSE_WHEEL);
 
         switch (inputEvent.elementId)
         {
@@ -943,7 +921,7 @@ UIEvent UIControlSystem::MakeUIEvent(const InputEvent& inputEvent) const
             break;
         case eInputElements::MOUSE_POSITION:
             // TODO: Holy shit, how to make multiple DRAG UIEvents from single inputEvent
-            uie.mouseButton = TranslateMouseElementToButtons(mouse->GetFirstPressedButton());
+            uie.mouseButton = TranslateMouseElementToButtons(GetFirstPressedMouseButton(mouse));
             uie.phase = uie.mouseButton == eMouseButtons::NONE ? UIEvent::Phase::MOVE : UIEvent::Phase::DRAG;
             uie.physPoint = { mousePosition.x, mousePosition.y };
             break;
@@ -955,7 +933,7 @@ UIEvent UIControlSystem::MakeUIEvent(const InputEvent& inputEvent) const
     else if (IsTouchInputElement(inputEvent.elementId))
     {
         uie.device = eInputDevices::TOUCH_SURFACE;
-        uie.modifiers = GetKeyboardModifierKeys();
+        uie.modifiers = GetKeyboardModifierKeys(inputEvent);
 
         const bool isDigitalEvent = IsTouchClickInputElement(inputEvent.elementId);
 
@@ -981,35 +959,48 @@ UIEvent UIControlSystem::MakeUIEvent(const InputEvent& inputEvent) const
     return uie;
 }
 
-eModifierKeys UIControlSystem::GetKeyboardModifierKeys() const
+eModifierKeys UIControlSystem::GetKeyboardModifierKeys(const InputEvent& inputEvent) const
 {
     eModifierKeys modifierKeys = eModifierKeys::NONE;
-    Keyboard* keyboard = GetEngineContext()->deviceManager->GetKeyboard();
+
+    // Keyboard is requested by id, so that device driven by `Replay` is used during playback
+    InputDevice* keyboard = nullptr;
+    if (inputEvent.deviceType == eInputDeviceTypes::KEYBOARD)
+    {
+        keyboard = inputEvent.device;
+    }
+    else
+    {
+        DeviceManager* deviceManager = GetEngineContext()->deviceManager;
+        Keyboard* liveKeyboard = deviceManager->GetKeyboard();
+        keyboard = (liveKeyboard != nullptr) ? deviceManager->GetInputDevice(liveKeyboard->GetId()) : nullptr;
+    }
+
     if (keyboard != nullptr)
     {
-        DigitalElementState lctrl = keyboard->GetKeyState(eInputElements::KB_LCTRL);
-        DigitalElementState rctrl = keyboard->GetKeyState(eInputElements::KB_RCTRL);
+        DigitalElementState lctrl = keyboard->GetDigitalElementState(eInputElements::KB_LCTRL);
+        DigitalElementState rctrl = keyboard->GetDigitalElementState(eInputElements::KB_RCTRL);
         if (lctrl.IsPressed() || rctrl.IsPressed())
         {
             modifierKeys |= eModifierKeys::CONTROL;
         }
 
-        DigitalElementState lshift = keyboard->GetKeyState(eInputElements::KB_LSHIFT);
-        DigitalElementState rshift = keyboard->GetKeyState(eInputElements::KB_RSHIFT);
+        DigitalElementState lshift = keyboard->GetDigitalElementState(eInputElements::KB_LSHIFT);
+        DigitalElementState rshift = keyboard->GetDigitalElementState(eInputElements::KB_RSHIFT);
         if (lshift.IsPressed() || rshift.IsPressed())
         {
             modifierKeys |= eModifierKeys::SHIFT;
         }
 
-        DigitalElementState lalt = keyboard->GetKeyState(eInputElements::KB_LALT);
-        DigitalElementState ralt = keyboard->GetKeyState(eInputElements::KB_RALT);
+        DigitalElementState lalt = keyboard->GetDigitalElementState(eInputElements::KB_LALT);
+        DigitalElementState ralt = keyboard->GetDigitalElementState(eInputElements::KB_RALT);
         if (lalt.IsPressed() || ralt.IsPressed())
         {
             modifierKeys |= eModifierKeys::ALT;
         }
 
-        DigitalElementState lcmd = keyboard->GetKeyState(eInputElements::KB_LCMD);
-        DigitalElementState rcmd = keyboard->GetKeyState(eInputElements::KB_RCMD);
+        DigitalElementState lcmd = keyboard->GetDigitalElementState(eInputElements::KB_LCMD);
+        DigitalElementState rcmd = keyboard->GetDigitalElementState(eInputElements::KB_RCMD);
         if (lcmd.IsPressed() || rcmd.IsPressed())
         {
             modifierKeys |= eModifierKeys::COMMAND;
@@ -1018,6 +1009,19 @@ eModifierKeys UIControlSystem::GetKeyboardModifierKeys() const
     return modifierKeys;
 }
 
+eInputElements UIControlSystem::GetFirstPressedMouseButton(InputDevice* mouse)
+{
+    for (uint32 i = eInputElements::MOUSE_FIRST_BUTTON; i <= eInputElements::MOUSE_LAST_BUTTON; ++i)
+    {
+        eInputElements button = static_cast<eInputElements>(i);
+        if (mouse->GetDigitalElementState(button).IsPressed())
+        {
+            return button;
+        }
+    }
+    return eInputElements::NONE;
+}
+
 eMouseButtons UIControlSystem::TranslateMouseElementToButtons(eInputElements element)
 {
     switch (element)
@@ -16,6 +16,7 @@
 */
 namespace DAVA
 {
+class InputDevice;
 class Mouse;
 class ScreenSwitchListener;
 class UIComponent;
@@ -194,11 +195,6 @@ public:
 	 */
     void SwitchInputToControl(uint32 eventID, UIControl* targetControl);
 
-    /**
-	 \brief Used internally by Replay class
-	 */
-    void ReplayEvents();
-
     /**
 	 \brief Called by the core when screen size is changed
 	 */
@@ -329,7 +325,8 @@ private:
     int32 CalculatedTapCount(UIEvent* newEvent);
 
     UIEvent MakeUIEvent(const InputEvent& inputEvent) const;
-    eModifierKeys GetKeyboardModifierKeys() const;
+    eModifierKeys GetKeyboardModifierKeys(const InputEvent& inputEvent) const;
+    static eInputElements GetFirstPressedMouseButton(InputDevice* mouse);
     static eMouseButtons TranslateMouseElementToButtons(eInputElements element);
 
     friend class Private::EngineBackend;
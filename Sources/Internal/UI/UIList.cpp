@@ -38,6 +38,7 @@ UIList::UIList(const Rect& rect /* = Rect()*/, eListOrientation requiredOrientat
     , scroll(NULL)
 {
     InitAfterYaml();
+    SetInputCulling(false);
     GetOrCreateComponent<UIUpdateComponent>();
     GetOrCreateComponent<UIClipContentComponent>();
 }
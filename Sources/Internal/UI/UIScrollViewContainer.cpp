@@ -33,6 +33,8 @@ UIScrollViewContainer::UIScrollViewContainer(const Rect& rect)
 {
     this->SetInputEnabled(true);
     this->SetMultiInput(true);
+    // Scroll tracks touches which began outside of container
+    SetInputCulling(false);
     GetOrCreateComponent<UIScrollComponent>();
 }
 
@@ -174,6 +174,8 @@ void UISpinner::Input(UIEvent* currentInput)
                 }
                 content->relativePosition.x = contentNewX;
                 nextContent->relativePosition.x = contentNewX; //for this to work we adjust pivotPoint above
+                content->SetHierarchyBoundsDirty();
+                nextContent->SetHierarchyBoundsDirty();
 
                 if (Abs(content->relativePosition.x) > content->size.dx / 2)
                 {
@@ -363,6 +365,7 @@ void UISpinner::SetupInternalControls()
     contentViewport->SetPivotPoint(content->GetPivotPoint());
     nextContent->CopyDataFrom(content.Get());
     nextContent->relativePosition = Vector2();
+    nextContent->SetHierarchyBoundsDirty();
     Vector2 newPivotPoint = nextContent->GetPivotPoint();
     newPivotPoint.x = content->size.dx;
     nextContent->SetPivotPoint(newPivotPoint);
@@ -236,12 +236,17 @@ inline void Random::reload()
 
 inline void Random::Seed(const uint32 oneSeed)
 {
-    if (Replay::IsRecord())
+    uint32 seed = oneSeed;
+    if (Replay::IsPlayback())
+    {
+        seed = Replay::Instance()->PlaySeed(oneSeed);
+    }
+    else if (Replay::IsRecord())
     {
         Replay::Instance()->RecordSeed(oneSeed);
     }
     // Seed the generator with a simple uint32
-    initialize(oneSeed);
+    initialize(seed);
     reload();
 }
 